@@ -0,0 +1,27 @@
+#include <iostream>
+#include <string>
+#include "klstream/window/financial_tick_source.hpp"
+#include "klstream/window/replay_file.hpp"
+
+using namespace klstream;
+
+// Converts an existing replay CSV into the mmap-able ReplayFile format, for
+// days preprocessed before preprocess_lobster.py grew --binary-out.
+//   convert_replay <replay.csv> <replay.klsr> [index_stride_ms=1000]
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "usage: " << argv[0] << " <replay.csv> <replay.klsr> [index_stride_ms]\n";
+        return 1;
+    }
+    const std::uint64_t stride_ms = argc > 3 ? std::stoull(argv[3]) : 1000;
+    try {
+        const auto rows = load_replay_csv(argv[1]);
+        write_replay_file(rows, argv[2], stride_ms * 1'000'000ULL);
+        const ReplayFile check(argv[2]);   // re-open: validates what was written
+        std::cout << "Wrote " << check.size() << " events to " << argv[2] << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -1,13 +1,64 @@
+// adaptive_window/harness.cpp
+//
+// Default: the experiment sweep — adaptive_window_main once per run, as a
+// subprocess, on the wall clock.
+//
+// --virtual: the in-process mode. Every configuration (architecture x
+// offered rate) runs the pipeline single-threaded under the virtual clock
+// (core/virtual_time.hpp) for a fixed event budget, so a run's numbers
+// depend on the data, the forest and the cost model below, never on the
+// machine or its load: rerunning gives the same CSV, and a baseline CSV
+// (--baseline=) turns the sweep into a regression gate. Configurations run
+// in parallel, one thread per core of the Performance set, pinned.
+//
+// Work is priced, not timed (VirtualTimeRunner):
+//   source     --source-ns= per event, one run per value (the offered load)
+//   window     --window-ns= per event
+//   inference  --walk-ns= per tree walk + --score-ns= per window
+//   sink       --sink-ns= per result
+// Max-rate replay only, and no slo architecture: its controller prices
+// windows by timing them, which the virtual clock reads as free.
+#include "klstream/core/virtual_time.hpp"
+#include "klstream/core/histogram.hpp"
+#include "klstream/core/metrics.hpp"
+#include "klstream/core/pinning.hpp"
+#include "klstream/operators/sink.hpp"
+#include "klstream/operators/source.hpp"
+#include "klstream/window/types.hpp"
+#include "klstream/window/batch_pool.hpp"
+#include "klstream/window/adaptive_window_op.hpp"
+#include "klstream/window/data_driven_window_op.hpp"
+#include "klstream/window/inference_op.hpp"
+#include "klstream/window/financial_tick_source.hpp"
+#include "klstream/model/isolation_forest.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
-#include <cstdlib>
 
-int main() {
+using namespace klstream;
+
+using Forest = IsolationForest<FeatureVector::kDim>;
+
+// ── Sweep (default) ──────────────────────────────────────────────────────
+
+int run_sweep() {
     std::vector<std::string> architectures = {"fixed", "datadriven", "adaptive"};
     int warmup_runs = 5;
     int measurement_runs = 30;
-    
+
     // Create output directories
     system("mkdir -p results/raw");
 
@@ -22,22 +73,22 @@ int main() {
     std::cout << "--- Running Experiments 2, 3, 5 (Comparison) ---\n";
     for (const auto& arch : architectures) {
         std::cout << "Architecture: " << arch << "\n";
-        
+
         // Warmup
         for (int i = 0; i < warmup_runs; ++i) {
             std::cout << "  Warmup " << (i+1) << "/" << warmup_runs << "\n";
-            std::string cmd = "./build/adaptive_window/adaptive_window_main --architecture=" + arch + 
+            std::string cmd = "./build/adaptive_window/adaptive_window_main --architecture=" + arch +
                               " --out=results/raw/warmup_" + arch + "_" + std::to_string(i) + ".csv --duration=5 > /dev/null";
             if (system(cmd.c_str()) != 0) {
                 std::cerr << "Aborted by user.\n";
                 return 1;
             }
         }
-        
+
         // Measurement
         for (int i = 0; i < measurement_runs; ++i) {
             std::cout << "  Measurement " << (i+1) << "/" << measurement_runs << "\n";
-            std::string cmd = "./build/adaptive_window/adaptive_window_main --architecture=" + arch + 
+            std::string cmd = "./build/adaptive_window/adaptive_window_main --architecture=" + arch +
                               " --out=results/raw/run_" + arch + "_" + std::to_string(i) + ".csv --duration=5 > /dev/null";
             if (system(cmd.c_str()) != 0) {
                 std::cerr << "Aborted by user.\n";
@@ -45,7 +96,328 @@ int main() {
             }
         }
     }
-    
+
     std::cout << "Harness complete.\n";
     return 0;
 }
+
+// ── Virtual runs (--virtual) ─────────────────────────────────────────────
+
+struct CostModel {
+    std::uint64_t window_ns = 40;
+    std::uint64_t walk_ns   = 15;
+    std::uint64_t score_ns  = 500;
+    std::uint64_t sink_ns   = 200;
+};
+
+struct RunConfig {
+    std::string   architecture;   // fixed | datadriven | adaptive
+    std::uint64_t source_ns;
+    std::string name() const { return architecture + "@" + std::to_string(source_ns); }
+};
+
+struct RunResult {
+    std::string   config;
+    std::uint64_t events = 0, windows = 0, virtual_ns = 0;
+    double        throughput_eps = 0;
+    double        p50_us = 0, p95_us = 0, p99_us = 0, max_us = 0;
+    double        precision = 0, recall = 0, f1 = 0, pa20_f1 = 0;
+    double        wall_ms = 0;   // not reproducible; never compared
+};
+
+struct Scored {
+    double precision = 0, recall = 0, f1 = 0;
+};
+
+Scored score(const std::vector<bool>& pred, const std::vector<std::uint8_t>& label) {
+    std::uint64_t tp = 0, fp = 0, fn = 0;
+    for (std::size_t i = 0; i < label.size(); ++i) {
+        const bool truth = label[i] != 0;
+        tp += pred[i] && truth;
+        fp += pred[i] && !truth;
+        fn += !pred[i] && truth;
+    }
+    Scored s;
+    s.precision = tp + fp ? static_cast<double>(tp) / static_cast<double>(tp + fp) : 0.0;
+    s.recall    = tp + fn ? static_cast<double>(tp) / static_cast<double>(tp + fn) : 0.0;
+    s.f1 = s.precision + s.recall > 0 ? 2 * s.precision * s.recall / (s.precision + s.recall) : 0.0;
+    return s;
+}
+
+// Tick-level and PA%K scores as analysis/compute_metrics.py computes them:
+// the threshold is the 95th percentile of max_score (linear interpolation,
+// as pandas), a tick is flagged when a window over it reaches it, and
+// PA%20 credits a whole anomaly segment (a run of labelled ticks) once a
+// fifth of its ticks are flagged.
+void score_run(const std::vector<DetectionResult>& results, const std::vector<std::uint8_t>& label,
+               std::uint64_t seq0, RunResult& out) {
+    if (results.empty() || label.empty()) return;
+    std::vector<double> s;
+    s.reserve(results.size());
+    for (const auto& r : results) s.push_back(r.max_score);
+    std::sort(s.begin(), s.end());
+    const double at = 0.95 * static_cast<double>(s.size() - 1);
+    const auto lo = static_cast<std::size_t>(at);
+    const double threshold = lo + 1 < s.size() ? s[lo] + (at - lo) * (s[lo + 1] - s[lo]) : s[lo];
+
+    std::vector<bool> pred(label.size(), false);
+    for (const auto& r : results) {
+        if (r.max_score < threshold || r.last_seq < seq0) continue;
+        const std::size_t a = r.first_seq < seq0 ? 0 : r.first_seq - seq0;
+        const std::size_t b = std::min<std::size_t>(r.last_seq - seq0 + 1, pred.size());
+        for (std::size_t i = a; i < b; ++i) pred[i] = true;
+    }
+    const Scored tick = score(pred, label);
+
+    std::vector<bool> adjusted = pred;
+    for (std::size_t i = 0; i < label.size();) {
+        if (label[i] == 0) { ++i; continue; }
+        std::size_t j = i, hits = 0;
+        for (; j < label.size() && label[j] != 0; ++j) hits += pred[j];
+        if (static_cast<double>(hits) >= 0.2 * static_cast<double>(j - i))
+            std::fill(adjusted.begin() + static_cast<std::ptrdiff_t>(i), adjusted.begin() + static_cast<std::ptrdiff_t>(j), true);
+        i = j;
+    }
+    out.precision = tick.precision;
+    out.recall    = tick.recall;
+    out.f1        = tick.f1;
+    out.pa20_f1   = score(adjusted, label).f1;
+}
+
+// One configuration, on the calling thread: source -> window stage ->
+// inference -> sink, the queues and pool sized as in main.cpp.
+RunResult run_virtual(const RunConfig& cfg, const std::shared_ptr<const ReplayFile>& replay,
+                      const std::vector<TickRow>* rows, const Forest& forest, std::uint64_t budget,
+                      const CostModel& cost) {
+    const auto wall0 = std::chrono::steady_clock::now();
+    std::unique_ptr<FinancialTickSource> ticks = replay
+        ? std::make_unique<FinancialTickSource>(replay, ReplayMode::MaxRate)
+        : std::make_unique<FinancialTickSource>(*rows, ReplayMode::MaxRate);
+
+    SPSCQueue<Event<FeatureVector>>   q_src(4096);
+    SPSCQueue<Event<WindowHandle>>    q_win(64);
+    SPSCQueue<Event<DetectionResult>> q_res(4096);
+    WindowBatchPool pool(q_win.capacity() + 2);
+    OperatorMetrics m_src("tick_source"), m_win("window_op"), m_inf("inference"), m_snk("result_sink");
+
+    std::vector<std::uint8_t> label;
+    label.reserve(budget);
+    std::uint64_t seq0 = 0;
+    SourceOperator<FeatureVector> source("tick_source", &q_src,
+        [&](Event<FeatureVector>& out, std::uint64_t seq) {
+            if (label.size() >= budget || !(*ticks)(out, seq)) return false;
+            if (label.empty()) seq0 = out.seq;
+            label.push_back(ticks->last_label());
+            return true;
+        });
+    source.attach_metrics(&m_src);
+
+    std::unique_ptr<IOperator> window_op;
+    if (cfg.architecture == "fixed") {
+        auto* op = new PooledDataDrivenWindowOp("fixed_window", &q_src, &q_win, 128, 128);
+        op->attach_pool(&pool);
+        window_op.reset(op);
+    } else if (cfg.architecture == "datadriven") {
+        auto* op = new PooledDataDrivenWindowOp("data_driven_window", &q_src, &q_win);
+        op->attach_pool(&pool);
+        window_op.reset(op);
+    } else {
+        auto* op = new PooledAdaptiveWindowOp("adaptive_window", &q_src, &q_win);
+        op->attach_pool(&pool);
+        window_op.reset(op);
+    }
+    window_op->attach_metrics(&m_win);
+
+    PooledInferenceOp inference("inference", &q_win, &q_res, &forest);
+    inference.attach_pool(&pool);
+    inference.attach_metrics(&m_inf);
+
+    std::vector<DetectionResult> results;
+    LatencyHistogram latency;
+    std::uint64_t max_latency = 0;
+    SinkOperator<DetectionResult> sink("result_sink", &q_res, [&](const Event<DetectionResult>& ev) {
+        const std::uint64_t ns = ev.latency_ns();
+        latency.record(ns);
+        max_latency = std::max(max_latency, ns);
+        results.push_back(ev.data);
+    });
+    sink.attach_metrics(&m_snk);
+
+    VirtualTimeRunner vt;
+    const auto s = vt.add(&source, [&] { return cfg.source_ns * m_src.events_processed.load(); });
+    const auto w = vt.add(window_op.get(), [&] { return cost.window_ns * m_win.events_processed.load(); });
+    const auto i = vt.add(&inference, [&] {
+        return cost.walk_ns * inference.trees_evaluated() + cost.score_ns * m_inf.events_processed.load();
+    });
+    const auto k = vt.add(&sink, [&] { return cost.sink_ns * m_snk.events_processed.load(); });
+    vt.feeds(s, w);
+    vt.feeds(w, i);
+    vt.feeds(i, k);
+    const std::uint64_t elapsed = vt.run();
+
+    RunResult r;
+    r.config     = cfg.name();
+    r.events     = label.size();
+    r.windows    = results.size();
+    r.virtual_ns = elapsed;
+    r.throughput_eps = elapsed ? static_cast<double>(r.events) * 1e9 / static_cast<double>(elapsed) : 0.0;
+    r.p50_us = latency.percentile(0.50);
+    r.p95_us = latency.percentile(0.95);
+    r.p99_us = latency.percentile(0.99);
+    r.max_us = static_cast<double>(max_latency) / 1000.0;
+    score_run(results, label, seq0, r);
+    r.wall_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - wall0).count();
+    return r;
+}
+
+// Comma-separated list.
+std::vector<std::string> split_list(const std::string& list) {
+    std::vector<std::string> out;
+    std::stringstream in(list);
+    for (std::string item; std::getline(in, item, ',');) if (!item.empty()) out.push_back(item);
+    return out;
+}
+
+const char* const SUMMARY_HEADER =
+    "config,events,windows,virtual_ns,throughput_eps,lat_p50_us,lat_p95_us,lat_p99_us,lat_max_us,"
+    "precision,recall,f1,pa20_f1,wall_ms";
+
+void write_summary(const std::string& path, const std::vector<RunResult>& runs) {
+    const auto dir = std::filesystem::path(path).parent_path();
+    if (!dir.empty()) std::filesystem::create_directories(dir);
+    std::ofstream out(path);
+    if (!out) throw std::runtime_error("cannot write " + path);
+    out << SUMMARY_HEADER << "\n" << std::setprecision(10);
+    for (const auto& r : runs) {
+        out << r.config << "," << r.events << "," << r.windows << "," << r.virtual_ns << ","
+            << r.throughput_eps << "," << r.p50_us << "," << r.p95_us << "," << r.p99_us << ","
+            << r.max_us << "," << r.precision << "," << r.recall << "," << r.f1 << "," << r.pa20_f1
+            << "," << r.wall_ms << "\n";
+    }
+}
+
+std::map<std::string, RunResult> read_summary(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) throw std::runtime_error("cannot read baseline " + path);
+    std::map<std::string, RunResult> runs;
+    std::string line;
+    std::getline(in, line);
+    while (std::getline(in, line)) {
+        std::stringstream row(line);
+        std::vector<std::string> f;
+        for (std::string cell; std::getline(row, cell, ',');) f.push_back(cell);
+        if (f.size() < 13) continue;
+        RunResult r;
+        r.config         = f[0];
+        r.throughput_eps = std::stod(f[4]);
+        r.p99_us         = std::stod(f[7]);
+        r.f1             = std::stod(f[11]);
+        r.pa20_f1        = std::stod(f[12]);
+        runs[r.config] = r;
+    }
+    return runs;
+}
+
+// A run regresses when its throughput or detection scores fall, or its p99
+// latency rises, by more than `tolerance` of the baseline's value.
+// Configurations missing from either side are reported, not failed.
+bool check_baseline(const std::vector<RunResult>& runs, const std::string& path, double tolerance) {
+    const auto base = read_summary(path);
+    bool ok = true;
+    auto worse = [&](const std::string& config, const char* metric, double now, double was, bool higher_is_better) {
+        const double slack = tolerance * std::abs(was);
+        if (higher_is_better ? now >= was - slack : now <= was + slack) return;
+        std::cerr << "REGRESSION " << config << " " << metric << ": " << now << " (baseline " << was << ")\n";
+        ok = false;
+    };
+    for (const auto& r : runs) {
+        auto it = base.find(r.config);
+        if (it == base.end()) { std::cout << "No baseline for " << r.config << "\n"; continue; }
+        const RunResult& b = it->second;
+        worse(r.config, "throughput_eps", r.throughput_eps, b.throughput_eps, true);
+        worse(r.config, "lat_p99_us", r.p99_us, b.p99_us, false);
+        worse(r.config, "f1", r.f1, b.f1, true);
+        worse(r.config, "pa20_f1", r.pa20_f1, b.pa20_f1, true);
+    }
+    return ok;
+}
+
+int run_virtual_sweep(int argc, char** argv) {
+    std::string replay_path  = "data/replay/replay_AAPL_20120621.csv";
+    std::string forest_path  = "data/forest.bin";
+    std::string out_csv      = "results/virtual/summary.csv";
+    std::string baseline;
+    double      tolerance    = 0.02;
+    std::uint64_t budget     = 200000;
+    std::vector<std::string> architectures = {"fixed", "datadriven", "adaptive"};
+    std::vector<std::string> source_ns     = {"1000", "2000", "4000"};
+    CostModel cost;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        auto val = [&](const char* flag){ return a.rfind(flag, 0) == 0; };
+        if (val("--replay=")) replay_path = a.substr(9);
+        else if (val("--forest=")) forest_path = a.substr(9);
+        else if (val("--out=")) out_csv = a.substr(6);
+        else if (val("--baseline=")) baseline = a.substr(11);
+        else if (val("--tolerance=")) tolerance = std::stod(a.substr(12));
+        else if (val("--events=")) budget = std::stoull(a.substr(9));
+        else if (val("--architectures=")) architectures = split_list(a.substr(16));
+        else if (val("--source-ns=")) source_ns = split_list(a.substr(12));
+        else if (val("--window-ns=")) cost.window_ns = std::stoull(a.substr(12));
+        else if (val("--walk-ns=")) cost.walk_ns = std::stoull(a.substr(10));
+        else if (val("--score-ns=")) cost.score_ns = std::stoull(a.substr(11));
+        else if (val("--sink-ns=")) cost.sink_ns = std::stoull(a.substr(10));
+    }
+
+    std::vector<RunConfig> configs;
+    for (const auto& arch : architectures) {
+        if (arch != "fixed" && arch != "datadriven" && arch != "adaptive") {
+            std::cerr << "--virtual runs fixed, datadriven and adaptive only, not " << arch << "\n";
+            return 1;
+        }
+        for (const auto& ns : source_ns) configs.push_back(RunConfig{ arch, std::stoull(ns) });
+    }
+
+    // Loaded once; every run reads the same replay and forest.
+    std::shared_ptr<const ReplayFile> replay;
+    std::vector<TickRow> rows;
+    if (is_replay_file(replay_path)) replay = std::make_shared<const ReplayFile>(replay_path);
+    else rows = load_replay_csv(replay_path);
+    Forest forest(0, 0);
+    forest.load_file(forest_path);
+
+    const std::vector<int> cpus = CpuTopology::system().cpus_for(CoreAffinity::Performance);
+    const std::size_t n_threads = std::min(configs.size(), cpus.size());
+    std::cout << "Virtual sweep: " << configs.size() << " runs of " << budget << " events on "
+              << n_threads << " cores\n";
+
+    std::vector<RunResult> runs(configs.size());
+    std::atomic<std::size_t> next{0};
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < n_threads; ++t) {
+        threads.emplace_back([&, cpu = cpus[t]] {
+            pin_current_thread({ cpu });
+            for (std::size_t c; (c = next.fetch_add(1)) < configs.size();)
+                runs[c] = run_virtual(configs[c], replay, &rows, forest, budget, cost);
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    for (const auto& r : runs) {
+        std::cout << "  " << std::left << std::setw(16) << r.config << std::right
+                  << " " << static_cast<std::uint64_t>(r.throughput_eps) << " ev/s, p99 " << r.p99_us
+                  << " us, F1 " << r.f1 << ", PA%20 F1 " << r.pa20_f1 << " (" << r.wall_ms << " ms)\n";
+    }
+    write_summary(out_csv, runs);
+    std::cout << "Summary: " << out_csv << "\n";
+    if (!baseline.empty() && !check_baseline(runs, baseline, tolerance)) return 1;
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "--virtual") return run_virtual_sweep(argc, argv);
+    }
+    return run_sweep();
+}
@@ -1,17 +1,28 @@
 // adaptive_window/main.cpp
 #include "klstream/core/runtime.hpp"
+#include "klstream/core/checkpoint.hpp"
 #include "klstream/core/metrics.hpp"
+#include "klstream/core/page_alloc.hpp"
+#include "klstream/core/rcu.hpp"
+#include "klstream/operators/fan_out.hpp"
+#include "klstream/operators/partition.hpp"
 #include "klstream/operators/source.hpp"
-#include "klstream/operators/window.hpp"
 #include "klstream/window/types.hpp"
+#include "klstream/window/batch_pool.hpp"
 #include "klstream/window/adaptive_window_op.hpp"
 #include "klstream/window/data_driven_window_op.hpp"
+#include "klstream/window/keyed_window_op.hpp"
 #include "klstream/window/inference_op.hpp"
 #include "klstream/window/financial_tick_source.hpp"
+#include "klstream/window/streaming_replay_source.hpp"
 #include "klstream/window/result_sink.hpp"
 #include "klstream/model/isolation_forest.hpp"
 
 #include <chrono>
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <string>
@@ -21,18 +32,189 @@
 
 using namespace klstream;
 
-// Loads a pretrained forest written by train_forest.cpp (Section 26) as a
-// flat binary blob — see that section for the (de)serialisation format.
+// Loads a pretrained forest written by train_forest.cpp (Section 26), in
+// either format (IsolationForest::load_file).
 IsolationForest<FeatureVector::kDim> load_forest(const std::string& path) {
     IsolationForest<FeatureVector::kDim> forest(0, 0);
-    std::ifstream in(path, std::ios::binary);
-    if (!in) throw std::runtime_error("failed to open forest path: " + path);
-    forest.load(in);
+    forest.load_file(path);
     return forest;
 }
 
+using Forests = RcuCell<IsolationForest<FeatureVector::kDim>>;
+
+// Comma-separated --replay= list.
+std::vector<std::string> split_paths(const std::string& list) {
+    std::vector<std::string> paths;
+    for (std::size_t at = 0; at <= list.size();) {
+        const std::size_t comma = std::min(list.find(',', at), list.size());
+        paths.push_back(list.substr(at, comma - at));
+        at = comma + 1;
+    }
+    return paths;
+}
+
+// "data/replay/replay_AAPL_20120621.csv" -> "AAPL"; otherwise the file stem.
+std::string symbol_of_path(const std::string& path) {
+    std::string stem = std::filesystem::path(path).stem().string();
+    if (stem.rfind("replay_", 0) == 0) stem = stem.substr(7, stem.find('_', 7) - 7);
+    return stem;
+}
+
+// --out=*.klres: binary result log written off the sink's thread
+// (BinaryResultSink; results_to_csv converts it). Anything else: the CSV.
+std::unique_ptr<IOperator> make_result_sink(SPSCQueue<Event<DetectionResult>>* in, const std::string& path,
+                                            LatencyHistogram* latency = nullptr) {
+    const std::string ext = ".klres";
+    if (path.size() >= ext.size() && path.compare(path.size() - ext.size(), ext.size(), ext) == 0) {
+        auto sink = std::make_unique<BinaryResultSink>("result_sink", in, path);
+        sink->set_batch_size(64);
+        if (latency) sink->attach_latency(latency);
+        return sink;
+    }
+    auto sink = std::make_unique<ResultSink>("result_sink", in, path);
+    if (latency) sink->attach_latency(latency);
+    return sink;
+}
+
+struct ShardedRun {
+    std::size_t  shards;
+    std::vector<std::string> replays;
+    ReplayMode   mode;
+    double       speed_factor;
+    double       occ_low, occ_high, shrink_factor, grow_factor;
+    bool         early_exit;
+    double       alert_threshold;
+    std::string  out_csv;
+    int          duration_sec;
+    int          numa_node;
+    SchedulingPolicy scheduling;
+    IdleStrategy idle_strategy;
+    bool         rebalance;
+};
+
+// --hugepages / --prefault / --mlock: how the policy allocations went.
+void report_memory() {
+    if (default_memory_policy().is_default()) return;
+    const auto st = PageAllocator::instance().stats();
+    std::cout << "Pipeline memory: " << (st.mapped_bytes >> 10) << " KB in " << st.chunks << " chunks ("
+              << (st.hugetlb_bytes >> 10) << " KB hugetlb, " << (st.thp_bytes >> 10) << " KB THP), "
+              << (st.prefaulted_bytes >> 10) << " KB pre-faulted, " << (st.locked_bytes >> 10) << " KB locked";
+    if (st.hugetlb_fallbacks) std::cout << ", " << st.hugetlb_fallbacks << " hugetlb fallbacks";
+    if (st.lock_failures) std::cout << ", " << st.lock_failures << " mlock failures (RLIMIT_MEMLOCK)";
+    std::cout << "\n";
+}
+
+// --shards=K: one replay per symbol, merged by timestamp, partitioned by
+// symbol over K shards. Each shard is a PooledKeyedAdaptiveWindowOp (one
+// window per symbol it owns) and its own InferenceOp on its own worker;
+// every shard scores against the same read-only forest. A MergeOperator
+// collects the shards' results for the sink (per-symbol order is kept,
+// symbols interleave).
+int run_sharded(const ShardedRun& cfg, Forests& models) {
+    std::vector<FinancialTickSource> per_symbol;
+    for (const auto& path : cfg.replays) {
+        if (is_replay_file(path)) {
+            per_symbol.emplace_back(std::make_shared<const ReplayFile>(path), ReplayMode::MaxRate);
+        } else {
+            per_symbol.emplace_back(load_replay_csv(path), ReplayMode::MaxRate);
+        }
+        per_symbol.back().set_symbol(symbol_key(symbol_of_path(path)));
+    }
+    MultiSymbolTickSource ticks(std::move(per_symbol), cfg.mode, cfg.speed_factor);
+    const std::size_t k = cfg.shards;
+
+    // ── Queues ────────────────────────────────────────────────────────────
+    constexpr std::size_t SHARD_QUEUE = 1024;
+    SPSCQueue<Event<FeatureVector>>   q_src(4096);
+    SPSCQueue<Event<DetectionResult>> q_snk(4096);
+    std::vector<std::unique_ptr<SPSCQueue<Event<FeatureVector>>>>   q_shard;
+    std::vector<std::unique_ptr<SPSCQueue<Event<WindowHandle>>>>    q_win;
+    std::vector<std::unique_ptr<SPSCQueue<Event<DetectionResult>>>> q_res;
+    std::vector<std::unique_ptr<WindowBatchPool>>                   pools;
+    for (std::size_t s = 0; s < k; ++s) {
+        q_shard.push_back(std::make_unique<SPSCQueue<Event<FeatureVector>>>(SHARD_QUEUE));
+        q_win.push_back(std::make_unique<SPSCQueue<Event<WindowHandle>>>(64));
+        q_res.push_back(std::make_unique<SPSCQueue<Event<DetectionResult>>>(SHARD_QUEUE));
+        pools.push_back(std::make_unique<WindowBatchPool>(q_win.back()->capacity() + 2));
+    }
+
+    // ── Operators ─────────────────────────────────────────────────────────
+    std::deque<OperatorMetrics> metrics;
+    SourceOperator<FeatureVector> source("tick_source", &q_src,
+        [&ticks](Event<FeatureVector>& out, std::uint64_t seq) { return ticks(out, seq); });
+    source.attach_metrics(&metrics.emplace_back("tick_source"));
+
+    std::vector<SPSCQueue<Event<FeatureVector>>*>   shard_in;
+    std::vector<SPSCQueue<Event<DetectionResult>>*> shard_out;
+    for (std::size_t s = 0; s < k; ++s) {
+        shard_in.push_back(q_shard[s].get());
+        shard_out.push_back(q_res[s].get());
+    }
+    PartitionOperator<FeatureVector> partition("partition", &q_src, shard_in);
+    partition.set_batch_size(32);
+    partition.attach_metrics(&metrics.emplace_back("partition"));
+
+    std::vector<std::unique_ptr<PooledKeyedAdaptiveWindowOp>> windows;
+    std::vector<std::unique_ptr<PooledInferenceOp>>           inference;
+    const std::size_t symbols_per_shard = cfg.replays.size() / k + 1;
+    for (std::size_t s = 0; s < k; ++s) {
+        const std::string id = std::to_string(s);
+        windows.push_back(std::make_unique<PooledKeyedAdaptiveWindowOp>(
+            "window_" + id, q_shard[s].get(), q_win[s].get(), 16, MAX_WINDOW_SIZE,
+            cfg.occ_low, cfg.occ_high, cfg.shrink_factor, cfg.grow_factor, symbols_per_shard));
+        windows.back()->attach_pool(pools[s].get());
+        windows.back()->attach_metrics(&metrics.emplace_back("window_" + id));
+        inference.push_back(std::make_unique<PooledInferenceOp>(
+            "inference_" + id, q_win[s].get(), q_res[s].get(), &models));
+        inference.back()->attach_pool(pools[s].get());
+        inference.back()->set_early_exit(cfg.early_exit, cfg.alert_threshold);
+        inference.back()->attach_metrics(&metrics.emplace_back("inference_" + id));
+    }
+    MergeOperator<DetectionResult> merge("merge", shard_out, &q_snk);
+    merge.set_batch_size(32);
+    merge.attach_metrics(&metrics.emplace_back("merge"));
+    auto sink = make_result_sink(&q_snk, cfg.out_csv);
+    sink->attach_metrics(&metrics.emplace_back("result_sink"));
+
+    // ── Runtime ───────────────────────────────────────────────────────────
+    Runtime rt;
+    rt.set_scheduling_policy(cfg.scheduling);
+    rt.set_idle_strategy(cfg.idle_strategy);
+    if (cfg.rebalance) rt.set_rebalancing();
+    auto place = [&cfg](CoreAffinity a) { return WorkerPlacement{ a, {}, cfg.numa_node }; };
+    rt.add_worker(place(CoreAffinity::Performance));   // 0: source
+    rt.add_worker(place(CoreAffinity::Performance));   // 1: partition
+    rt.add_worker(place(CoreAffinity::Efficiency));    // 2: merge + sink
+    for (std::size_t s = 0; s < k; ++s)
+        rt.add_worker(place(CoreAffinity::Performance));   // 3..: one per shard
+    rt.register_op(&source, 0);
+    rt.register_op(&partition, 1);
+    for (std::size_t s = 0; s < k; ++s) {
+        rt.register_op(windows[s].get(), 3 + s);
+        rt.register_op(inference[s].get(), 3 + s);
+    }
+    rt.register_op(&merge, 2);
+    rt.register_op(sink.get(), 2);
+    for (auto& m : metrics) rt.metrics().add(&m);
+
+    std::cout << "Running sharded: " << ticks.symbols() << " symbols over " << k
+              << " shards for " << cfg.duration_sec << "s, output=" << cfg.out_csv << "\n";
+    rt.start();
+    rt.wait_for(std::chrono::seconds(cfg.duration_sec));
+    rt.stop();
+    if (cfg.rebalance) std::cout << "Operator migrations: " << rt.migrations() << "\n";
+
+    for (std::size_t s = 0; s < k; ++s) {
+        std::cout << "Shard " << s << ": " << windows[s]->symbols() << " symbols, "
+                  << windows[s]->windows_emitted() << " windows, window-size direction changes "
+                  << windows[s]->controller().direction_changes() << "\n";
+    }
+    report_memory();
+    return 0;
+}
+
 int main(int argc, char** argv) {
-    std::string architecture = "adaptive";   // fixed | datadriven | adaptive
+    std::string architecture = "adaptive";   // fixed | datadriven | adaptive | slo
     std::string replay_csv   = "data/replay/replay_AAPL_20120621.csv";
     std::string forest_path  = "data/forest.bin";
     std::string out_csv      = "results/raw/run.csv";
@@ -46,6 +228,51 @@ int main(int argc, char** argv) {
     double shrink_factor = 0.70;
     double grow_factor = 1.15;
 
+    // --architecture=slo: largest window meeting this p99 end-to-end bound
+    double slo_p99_us = 5000.0;
+
+    // Early-exit inference (0 threshold = exact max, just faster)
+    bool   early_exit = false;
+    double alert_threshold = 0.0;
+
+    // Re-publish the forest whenever --forest= changes on disk
+    bool   watch_forest = false;
+
+    // Data-parallel inference: N replicas behind a fan-out + ordered merge
+    int inference_replicas = 1;
+    FanOutPolicy fan_policy = FanOutPolicy::RoundRobin;
+
+    // Stream --replay= (comma-separated replay files, looped) through a
+    // bounded prefetch ring instead of holding it in memory
+    bool   replay_stream = false;
+
+    // Pin workers to one NUMA node's CPUs and memory (-1 = no NUMA placement)
+    int    numa_node = -1;
+
+    // Let idle workers steal runnable operators (bursty feeds)
+    SchedulingPolicy scheduling = SchedulingPolicy::RoundRobin;
+
+    // Sleep idle workers until input arrives instead of polling
+    IdleStrategy idle_strategy = IdleStrategy::Backoff;
+
+    // Move operators off overloaded workers while running (round-robin only)
+    bool rebalance = false;
+
+    // Multi-symbol run: --replay= lists one replay per symbol, partitioned
+    // by symbol over this many shards (0 = the single-chain pipeline)
+    int shards = 0;
+
+    // Back queue rings, pool slabs and the forest image with huge pages
+    // (=hugetlb: the reserved pool, else THP), touch them up front, lock them
+    MemoryPolicy memory;
+
+    // Checkpoint the replay position and window state into this directory
+    // every --checkpoint-every= seconds; --restore resumes from the newest
+    // one there (single-chain pipeline, in-memory or mapped replay)
+    std::string checkpoint_dir;
+    int    checkpoint_every_sec = 10;
+    bool   restore = false;
+
     for (int i = 1; i < argc; ++i) {
         std::string a = argv[i];
         auto val = [&](const char* flag){ return a.rfind(flag, 0) == 0; };
@@ -59,72 +286,226 @@ int main(int argc, char** argv) {
         else if (val("--occ_high=")) occ_high = std::stod(a.substr(11));
         else if (val("--shrink=")) shrink_factor = std::stod(a.substr(9));
         else if (val("--grow=")) grow_factor = std::stod(a.substr(7));
+        else if (val("--slo-p99-us=")) slo_p99_us = std::stod(a.substr(13));
         else if (val("--preserve-timing")) mode = ReplayMode::PreserveTiming;
+        else if (val("--early-exit")) early_exit = true;
+        else if (val("--alert-threshold=")) alert_threshold = std::stod(a.substr(18));
+        else if (val("--watch-forest")) watch_forest = true;
+        else if (val("--inference-replicas=")) inference_replicas = std::max(1, std::stoi(a.substr(21)));
+        else if (val("--fan-out=least-loaded")) fan_policy = FanOutPolicy::LeastLoaded;
+        else if (val("--replay-stream")) replay_stream = true;
+        else if (val("--numa-node=")) numa_node = std::stoi(a.substr(12));
+        else if (val("--scheduler=work-stealing")) scheduling = SchedulingPolicy::WorkStealing;
+        else if (val("--idle=park")) idle_strategy = IdleStrategy::Park;
+        else if (val("--rebalance")) rebalance = true;
+        else if (val("--shards=")) shards = std::max(0, std::stoi(a.substr(9)));
+        else if (val("--hugepages=hugetlb")) memory.pages = MemoryPolicy::Pages::Huge;
+        else if (val("--hugepages")) memory.pages = MemoryPolicy::Pages::Transparent;
+        else if (val("--prefault")) memory.prefault = true;
+        else if (val("--mlock")) memory.lock = true;
+        else if (val("--checkpoint-dir=")) checkpoint_dir = a.substr(17);
+        else if (val("--checkpoint-every=")) checkpoint_every_sec = std::max(1, std::stoi(a.substr(19)));
+        else if (val("--restore")) restore = true;
     }
+    // Before anything is allocated, so every ring and slab follows it;
+    // --numa-node= places the pages before they are faulted.
+    if (!memory.is_default()) memory.numa_node = numa_node;
+    default_memory_policy() = memory;
 
-    auto forest = load_forest(forest_path);
-    auto rows   = load_replay_csv(replay_csv);
+    // Inference reads the forest through an RcuCell so the watcher below
+    // can roll in a retrained model without stopping the pipeline.
+    Forests models(
+        std::make_unique<const IsolationForest<FeatureVector::kDim>>(load_forest(forest_path)));
+    if (shards > 0) {
+        // Adaptive windows only; --inference-replicas, --replay-stream and
+        // --watch-forest apply to the single-chain pipeline.
+        ShardedRun cfg{ static_cast<std::size_t>(shards), split_paths(replay_csv), mode, speed_factor,
+                        occ_low, occ_high, shrink_factor, grow_factor, early_exit, alert_threshold,
+                        out_csv, duration_sec, numa_node, scheduling, idle_strategy, rebalance };
+        return run_sharded(cfg, models);
+    }
+
+    // Binary replay files (ReplayFileHeader) are mapped as-is; a CSV is
+    // parsed once and held in memory. --replay-stream takes binary files
+    // only and never holds more than its ring.
+    std::unique_ptr<FinancialTickSource>   tick_src;
+    std::unique_ptr<StreamingReplaySource> stream_src;
+    if (replay_stream) {
+        stream_src = std::make_unique<StreamingReplaySource>(split_paths(replay_csv), mode, speed_factor);
+    } else if (is_replay_file(replay_csv)) {
+        tick_src = std::make_unique<FinancialTickSource>(
+            std::make_shared<const ReplayFile>(replay_csv), mode, speed_factor);
+    } else {
+        tick_src = std::make_unique<FinancialTickSource>(
+            load_replay_csv(replay_csv), mode, speed_factor);
+    }
 
     // ── Queues ────────────────────────────────────────────────────────────
     SPSCQueue<Event<FeatureVector>> q_src_feat(4096);   // source -> feature extract (identity here: TickSource already emits FeatureVector)
-    SPSCQueue<Event<WindowBatch>>   q_win_inf(64);       // window stage -> InferenceOp
+    SPSCQueue<Event<WindowHandle>>  q_win_inf(64);       // window stage -> InferenceOp
                                                             // SMALL capacity — see Section 7.3
+    // With replicas, q_win_inf feeds a FanOutOperator instead, which deals
+    // windows onto one small queue per replica; an OrderedMergeOperator puts
+    // the results back in window order before the sink.
+    const std::size_t n_rep = static_cast<std::size_t>(inference_replicas);
+    constexpr std::size_t REPLICA_QUEUE = 16;
+    std::vector<std::unique_ptr<SPSCQueue<Event<WindowHandle>>>>    q_rep_in;
+    std::vector<std::unique_ptr<SPSCQueue<Event<DetectionResult>>>> q_rep_out;
+    for (std::size_t r = 0; n_rep > 1 && r < n_rep; ++r) {
+        q_rep_in.push_back(std::make_unique<SPSCQueue<Event<WindowHandle>>>(REPLICA_QUEUE));
+        q_rep_out.push_back(std::make_unique<SPSCQueue<Event<DetectionResult>>>(REPLICA_QUEUE));
+    }
+    RouteQueue q_route(1024);   // >= every replica's queue + in-flight, up to dozens of replicas
+
+    // Points live in the pool; only 24-byte handles cross q_win_inf.
+    // capacity + 2: one window filling, one pending, one being scored —
+    // plus, per replica, its queue and one pending + one in hand, and the
+    // fan-out's one pending.
+    WindowBatchPool win_pool(q_win_inf.capacity() + 2 +
+                             (n_rep > 1 ? n_rep * (REPLICA_QUEUE + 2) + 1 : 0));
     SPSCQueue<Event<DetectionResult>> q_inf_snk(4096);
 
     OperatorMetrics m_src("tick_source"), m_win("window_op"),
-                    m_inf("inference"),   m_snk("result_sink");
+                    m_fan("fan_out"),     m_mrg("ordered_merge"),
+                    m_snk("result_sink");
+    std::deque<OperatorMetrics> m_inf;
 
     // ── Source ────────────────────────────────────────────────────────────
-    FinancialTickSource tick_src(std::move(rows), mode, speed_factor);
     SourceOperator<FeatureVector> source("tick_source", &q_src_feat,
-        [&tick_src](Event<FeatureVector>& out, std::uint64_t seq) {
-            return tick_src(out, seq);
+        [&tick_src, &stream_src](Event<FeatureVector>& out, std::uint64_t seq) {
+            return stream_src ? (*stream_src)(out, seq) : (*tick_src)(out, seq);
         });
     source.attach_metrics(&m_src);
 
     // ── Window stage (the variable under test) ──────────────────────────
     std::unique_ptr<IOperator> window_op;
-    AdaptiveWindowOp*    adaptive_ptr = nullptr;   // kept for occupancy logging below
+    PooledAdaptiveWindowOp*   adaptive_ptr = nullptr;   // kept for occupancy logging below
+    PooledDataDrivenWindowOp* dd_ptr       = nullptr;
 
     if (architecture == "fixed") {
-        auto* op = new TumblingCountWindow<FeatureVector, WindowBatch>(
-            "fixed_window", &q_src_feat, &q_win_inf, 128,
-            [](const std::vector<Event<FeatureVector>>& buf) {
-                WindowBatch wb;
-                for (const auto& ev : buf) wb.push_back(ev.data, ev.seq);
-                return wb;
-            });
+        // w_min == w_max pins the data-driven interpolation to a constant
+        // 128 — a fixed tumbling count window that fills pool slots in place.
+        auto* op = new PooledDataDrivenWindowOp(
+            "fixed_window", &q_src_feat, &q_win_inf, 128, 128);
+        op->attach_pool(&win_pool);
         window_op.reset(op);
     } else if (architecture == "datadriven") {
-        window_op = std::make_unique<DataDrivenWindowOp>(
+        auto* op = new PooledDataDrivenWindowOp(
             "data_driven_window", &q_src_feat, &q_win_inf);
-    } else { // adaptive
-        auto* op = new AdaptiveWindowOp("adaptive_window", &q_src_feat, &q_win_inf, 16, MAX_WINDOW_SIZE, occ_low, occ_high, shrink_factor, grow_factor);
+        op->attach_pool(&win_pool);
+        dd_ptr = op;
+        window_op.reset(op);
+    } else { // adaptive, slo
+        auto* op = new PooledAdaptiveWindowOp(architecture == "slo" ? "slo_window" : "adaptive_window",
+                                              &q_src_feat, &q_win_inf, 16, MAX_WINDOW_SIZE, occ_low, occ_high, shrink_factor, grow_factor);
+        op->attach_pool(&win_pool);
         adaptive_ptr = op;
         window_op.reset(op);
     }
     window_op->attach_metrics(&m_win);
 
     // ── Inference + Sink ─────────────────────────────────────────────────
-    InferenceOp inference("inference", &q_win_inf, &q_inf_snk, &forest);
-    inference.attach_metrics(&m_inf);
+    std::vector<std::unique_ptr<PooledInferenceOp>> inference;
+    std::unique_ptr<FanOutOperator<WindowHandle>>          fan_out;
+    std::unique_ptr<OrderedMergeOperator<DetectionResult>> merge;
+    if (n_rep == 1) {
+        inference.push_back(std::make_unique<PooledInferenceOp>(
+            "inference", &q_win_inf, &q_inf_snk, &models));
+    } else {
+        std::vector<SPSCQueue<Event<WindowHandle>>*>    rep_in;
+        std::vector<SPSCQueue<Event<DetectionResult>>*> rep_out;
+        for (std::size_t r = 0; r < n_rep; ++r) {
+            rep_in.push_back(q_rep_in[r].get());
+            rep_out.push_back(q_rep_out[r].get());
+            inference.push_back(std::make_unique<PooledInferenceOp>(
+                "inference_" + std::to_string(r), q_rep_in[r].get(), q_rep_out[r].get(), &models));
+        }
+        fan_out = std::make_unique<FanOutOperator<WindowHandle>>(
+            "fan_out", &q_win_inf, std::move(rep_in), &q_route, fan_policy);
+        merge = std::make_unique<OrderedMergeOperator<DetectionResult>>(
+            "ordered_merge", std::move(rep_out), &q_route, &q_inf_snk);
+        fan_out->attach_metrics(&m_fan);
+        merge->attach_metrics(&m_mrg);
+    }
+    for (auto& op : inference) {
+        op->attach_pool(&win_pool);
+        op->attach_metrics(&m_inf.emplace_back(op->name()));
+        op->set_early_exit(early_exit, alert_threshold);
+    }
+
+    // SLO mode: sink latency and inference cost feed the window controller,
+    // each replica timing its windows into its own cost model.
+    LatencyHistogram             sink_latency;
+    std::vector<WindowCostModel> inference_cost(n_rep);
+    auto sink = make_result_sink(&q_inf_snk, out_csv, architecture == "slo" ? &sink_latency : nullptr);
+    sink->attach_metrics(&m_snk);
+    if (architecture == "slo") {
+        std::vector<const WindowCostModel*> costs;
+        for (std::size_t r = 0; r < n_rep; ++r) {
+            inference[r]->attach_cost_model(&inference_cost[r]);
+            costs.push_back(&inference_cost[r]);
+        }
+        adaptive_ptr->enable_latency_slo(
+            SloWindowController(16, MAX_WINDOW_SIZE, static_cast<std::uint64_t>(slo_p99_us * 1000.0)),
+            &sink_latency, std::move(costs));
+    }
 
-    ResultSink sink("result_sink", &q_inf_snk, out_csv);
-    sink.attach_metrics(&m_snk);
+    // ── Checkpoints ───────────────────────────────────────────────────────
+    // The source's replay position and the window stage's state; inference
+    // and the sink hold none worth keeping. Restored before the runtime
+    // starts, so the source resumes right after the checkpoint's barrier.
+    std::unique_ptr<Checkpointer> checkpoints;
+    if (!checkpoint_dir.empty()) {
+        if (!tick_src) {
+            std::cerr << "--checkpoint-dir needs an in-memory or mapped replay, not --replay-stream\n";
+            return 1;
+        }
+        checkpoints = std::make_unique<Checkpointer>(checkpoint_dir);
+        source.checkpoint_generator([&tick_src](StateWriter& out) { tick_src->snapshot(out); },
+                                    [&tick_src](StateReader& in) { tick_src->restore(in); });
+        checkpoints->add(&source);
+        checkpoints->add(window_op.get());
+        if (restore) {
+            if (auto c = Checkpointer::load_latest(checkpoint_dir)) {
+                checkpoints->restore(*c);
+                std::cout << "Restored checkpoint " << c->epoch << " at seq " << c->barrier_seq << "\n";
+            } else {
+                std::cout << "No checkpoint in " << checkpoint_dir << ", starting from the beginning\n";
+            }
+        }
+    }
 
     // ── Runtime ───────────────────────────────────────────────────────────
     Runtime rt;
-    rt.add_worker(CoreAffinity::Performance);   // 0: source
-    rt.add_worker(CoreAffinity::Performance);   // 1: window stage
-    rt.add_worker(CoreAffinity::Performance);   // 2: inference (heaviest compute)
-    rt.add_worker(CoreAffinity::Efficiency);    // 3: sink
+    rt.set_scheduling_policy(scheduling);
+    rt.set_idle_strategy(idle_strategy);
+    if (rebalance) rt.set_rebalancing();
+    // --numa-node= keeps every worker's CPUs, pages and queue rings on one
+    // node; otherwise the affinity hints alone decide.
+    auto place = [numa_node](CoreAffinity a) { return WorkerPlacement{ a, {}, numa_node }; };
+    rt.add_worker(place(CoreAffinity::Performance));   // 0: source
+    rt.add_worker(place(CoreAffinity::Performance));   // 1: window stage (+ fan-out)
+    rt.add_worker(place(CoreAffinity::Efficiency));    // 2: sink (+ ordered merge)
+    for (std::size_t r = 0; r < n_rep; ++r)
+        rt.add_worker(place(CoreAffinity::Performance));   // 3..: inference (heaviest compute)
+    if (numa_node >= 0) {
+        q_src_feat.bind_to_numa_node(numa_node);
+        q_win_inf.bind_to_numa_node(numa_node);
+        q_inf_snk.bind_to_numa_node(numa_node);
+        for (auto& q : q_rep_in)  q->bind_to_numa_node(numa_node);
+        for (auto& q : q_rep_out) q->bind_to_numa_node(numa_node);
+    }
 
     rt.register_op(&source, 0);
     rt.register_op(window_op.get(), 1);
-    rt.register_op(&inference, 2);
-    rt.register_op(&sink, 3);
+    if (fan_out) rt.register_op(fan_out.get(), 1);
+    for (std::size_t r = 0; r < n_rep; ++r) rt.register_op(inference[r].get(), 3 + r);
+    if (merge) rt.register_op(merge.get(), 2);
+    rt.register_op(sink.get(), 2);
 
-    for (auto* m : {&m_src, &m_win, &m_inf, &m_snk}) rt.metrics().add(m);
+    for (auto* m : {&m_src, &m_win, &m_snk}) rt.metrics().add(m);
+    if (fan_out) for (auto* m : {&m_fan, &m_mrg}) rt.metrics().add(m);
+    for (auto& m : m_inf) rt.metrics().add(&m);
 
     std::cout << "Running architecture=" << architecture
               << " for " << duration_sec << "s, output=" << out_csv << "\n";
@@ -141,26 +522,97 @@ int main(int argc, char** argv) {
             auto now = std::chrono::steady_clock::now();
             auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now - start).count();
             log << ms << "," 
-                << adaptive_ptr->controller().current() << ","
+                << adaptive_ptr->window_size() << ","
                 << q_win_inf.occupancy() << ","
                 << q_win_inf.occupancy() * q_win_inf.capacity() << "\n";
         }
     });
 
+    // Model watcher: polls the forest file's mtime once a second. Replace
+    // the file by rename (as train_forest does), never rewrite it in place:
+    // the live model is mmap'd from the old inode. Loading
+    // happens entirely on this thread; inference only ever sees a pointer
+    // swap. Old forests are freed on later polls once inference is past them.
+    std::thread forest_watcher([&]() {
+        if (!watch_forest) return;
+        std::error_code ec;
+        auto stamp = std::filesystem::last_write_time(forest_path, ec);
+        while (running) {
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+            models.reclaim();
+            auto now = std::filesystem::last_write_time(forest_path, ec);
+            if (ec || now == stamp) continue;
+            stamp = now;
+            try {
+                auto v = models.publish(std::make_unique<const IsolationForest<FeatureVector::kDim>>(
+                    load_forest(forest_path)));
+                std::cout << "Published forest version " << v << " from " << forest_path << "\n";
+            } catch (const std::exception& e) {
+                // Half-written file: keep the current model, retry on next change.
+                std::cerr << "Forest reload failed, keeping current model: " << e.what() << "\n";
+            }
+        }
+    });
+
+    // Checkpoint timer: only asks; the operators snapshot themselves at the
+    // barrier and the Checkpointer's own thread writes the file.
+    std::thread checkpoint_timer([&]() {
+        if (!checkpoints) return;
+        auto next = std::chrono::steady_clock::now() + std::chrono::seconds(checkpoint_every_sec);
+        while (running) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            if (std::chrono::steady_clock::now() < next) continue;
+            next += std::chrono::seconds(checkpoint_every_sec);
+            checkpoints->request();
+        }
+    });
+
     rt.start();
     rt.wait_for(std::chrono::seconds(duration_sec));
     rt.stop();
     
     running = false;
     occ_logger.join();
+    forest_watcher.join();
+    checkpoint_timer.join();
+    if (checkpoints) {
+        const auto st = checkpoints->stats();
+        std::cout << "Checkpoints written: " << st.written << " of " << st.requested << " requested (" << st.refused << " refused), last "
+                  << st.last_bytes << " bytes, aligned in " << st.last_align_ns / 1000 << " us, written in "
+                  << st.last_write_ns / 1000 << " us\n";
+        if (!checkpoints->error().empty()) std::cerr << "Checkpoint error: " << checkpoints->error() << "\n";
+    }
+    if (rebalance) std::cout << "Operator migrations: " << rt.migrations() << "\n";
 
-    if (adaptive_ptr) {
+    if (early_exit) {
+        std::uint64_t evaluated = 0, skipped = 0;
+        for (const auto& op : inference) {
+            evaluated += op->trees_evaluated();
+            skipped   += op->trees_skipped();
+        }
+        const auto total = evaluated + skipped;
+        std::cout << "Tree walks skipped by early exit: " << skipped << " / " << total
+                  << " (" << (total ? 100.0 * skipped / total : 0.0) << "%)\n";
+    }
+    if (stream_src) {
+        std::cout << "Replay blocks read: " << stream_src->blocks_read()
+                  << ", source stalls: " << stream_src->stalls() << "\n";
+        if (!stream_src->error().empty()) std::cerr << "Replay error: " << stream_src->error() << "\n";
+    }
+    if (adaptive_ptr && adaptive_ptr->slo_controller()) {
+        const auto* slo = adaptive_ptr->slo_controller();
+        std::cout << "Window-size direction changes: " << slo->direction_changes() << "\n";
+        std::cout << "SLO decisions: " << slo->decisions() << ", over SLO: " << slo->violations()
+                  << ", final window: " << slo->current() << "\n";
+        std::cout << "Sink p99 latency: " << sink_latency.percentile(0.99) << " us (SLO " << slo_p99_us << " us)\n";
+        std::cout << "Mean Controller Overhead: " << adaptive_ptr->mean_overhead_ns() << " ns/call\n";
+    } else if (adaptive_ptr) {
         std::cout << "Window-size direction changes: "
                   << adaptive_ptr->controller().direction_changes() << "\n";
         std::cout << "Mean Controller Overhead: " << adaptive_ptr->mean_overhead_ns() << " ns/call\n";
-    } else if (architecture == "datadriven" && window_op) {
-        auto* dd_ptr = static_cast<DataDrivenWindowOp*>(window_op.get());
+    } else if (dd_ptr) {
         std::cout << "Mean Controller Overhead: " << dd_ptr->mean_overhead_ns() << " ns/call\n";
     }
+    report_memory();
     return 0;
 }
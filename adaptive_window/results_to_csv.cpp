@@ -0,0 +1,28 @@
+#include <fstream>
+#include <iostream>
+#include <string>
+#include "klstream/window/result_log.hpp"
+
+using namespace klstream;
+
+// Converts a binary result log (BinaryResultSink, --out=*.klres) into the
+// CSV ResultSink writes, for the analysis scripts.
+//   results_to_csv <run.klres> <run.csv>
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "usage: " << argv[0] << " <run.klres> <run.csv>\n";
+        return 1;
+    }
+    try {
+        const auto records = read_result_log(argv[1]);
+        std::ofstream out(argv[2]);
+        if (!out) throw std::runtime_error(std::string("cannot open ") + argv[2]);
+        write_result_csv_header(out);
+        for (const auto& r : records) write_result_csv_row(out, r);
+        std::cout << "Wrote " << records.size() << " results to " << argv[2] << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -1,7 +1,10 @@
 #include <iostream>
+#include <filesystem>
 #include <fstream>
 #include <vector>
 #include <string>
+#include <thread>
+#include <algorithm>
 #include <sstream>
 #include "klstream/model/isolation_forest.hpp"
 
@@ -32,15 +35,24 @@ int main() {
     }
 
     std::cout << "Loaded " << train_data.size() << " samples for training." << std::endl;
-    std::cout << "Training Isolation Forest..." << std::endl;
+    const unsigned n_threads = std::max(1u, std::thread::hardware_concurrency());
+    std::cout << "Training Isolation Forest on " << n_threads << " threads..." << std::endl;
 
+    // Seed-deterministic: the same forest.bin for any thread count.
     IsolationForest<5> forest(100, 256); // n_estimators=100, psi=256
-    forest.fit(train_data);
+    forest.fit(train_data, n_threads);
 
+    // Flat format (FlatForestHeader): main.cpp maps it in place at startup.
+    // Written to a temp file and renamed over the old one, so a running
+    // main --watch-forest (which has the old file mapped) never sees a
+    // truncated or half-written model — it keeps the old inode until it
+    // switches.
     std::cout << "Training complete. Saving to data/forest.bin..." << std::endl;
-    std::ofstream out("data/forest.bin", std::ios::binary);
-    forest.save(out);
-    out.close();
+    {
+        std::ofstream out("data/forest.bin.tmp", std::ios::binary);
+        forest.save_flat(out);
+    }
+    std::filesystem::rename("data/forest.bin.tmp", "data/forest.bin");
 
     std::cout << "Loading holdout data for validation..." << std::endl;
     std::ifstream f_test("data/replay/isoforest_validation_holdout.csv");
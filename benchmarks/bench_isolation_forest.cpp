@@ -0,0 +1,85 @@
+// benchmarks/bench_isolation_forest.cpp
+#include <benchmark/benchmark.h>
+#include "klstream/model/isolation_forest.hpp"
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using namespace klstream;
+
+namespace {
+
+constexpr std::size_t D = 5;   // FeatureVector::kDim
+using Forest = IsolationForest<D>;
+
+std::vector<Forest::Point> gaussian_points(std::size_t n, std::uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> g(0.0f, 1.0f);
+    std::vector<Forest::Point> pts(n);
+    for (auto& p : pts) for (auto& v : p) v = g(rng);
+    return pts;
+}
+
+// Forest of `trees` trees over sub-samples of `psi` points: tree depth is
+// capped at ceil(log2 psi), so psi 64 / 256 / 1024 -> depth 6 / 8 / 10.
+Forest trained(int trees, int psi) {
+    Forest f(trees, psi, 42);
+    f.fit(gaussian_points(20000, 1), 1);
+    return f;
+}
+
+} // namespace
+
+// ── anomaly_score: ns per point vs tree count and depth ──────────────────
+// One point at a time, cycling through 4096 queries so the forest, not
+// the query, is what misses in cache. Expect ~linear in trees and in
+// depth; the jump between psi 256 and 1024 is the forest leaving L2.
+static void BM_IForest_ScorePoint(benchmark::State& state) {
+    const Forest f = trained(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    const auto queries = gaussian_points(4096, 2);
+    std::size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(f.anomaly_score(queries[i]));
+        i = (i + 1) & (queries.size() - 1);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_IForest_ScorePoint)
+    ->ArgNames({ "trees", "psi" })
+    ->ArgsProduct({ { 25, 50, 100, 200 }, { 64, 256, 1024 } });
+
+// ── score_batch: the InferenceOp path, one window at a time ──────────────
+// A window of state.range(1) points pushed through every tree together;
+// items are points, so ns/item compares directly with BM_IForest_ScorePoint.
+static void BM_IForest_ScoreBatch(benchmark::State& state) {
+    const Forest f = trained(static_cast<int>(state.range(0)), 256);
+    const std::size_t window = static_cast<std::size_t>(state.range(1));
+    const auto queries = gaussian_points(window, 2);
+    std::vector<double> out(window);
+    for (auto _ : state) {
+        f.score_batch(queries.data(), window, out.data());
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(window));
+}
+BENCHMARK(BM_IForest_ScoreBatch)
+    ->ArgNames({ "trees", "window" })
+    ->ArgsProduct({ { 50, 100, 200 }, { 16, 64, 256 } });
+
+// ── score_max: early exit against a threshold ────────────────────────────
+// Calm data against a high threshold: most points are cut after the first
+// bound check, so this approaches the cost of the first few trees.
+static void BM_IForest_ScoreMaxEarlyExit(benchmark::State& state) {
+    const Forest f = trained(100, 256);
+    const std::size_t window = static_cast<std::size_t>(state.range(0));
+    const auto queries = gaussian_points(window, 2);
+    std::vector<double>        sums(window);
+    std::vector<std::uint32_t> live(window);
+    for (auto _ : state) {
+        auto r = f.score_max(queries.data(), window, 0.75, sums.data(), live.data());
+        benchmark::DoNotOptimize(r);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(window));
+}
+BENCHMARK(BM_IForest_ScoreMaxEarlyExit)->ArgName("window")->Arg(64)->Arg(256);
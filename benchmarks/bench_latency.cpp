@@ -0,0 +1,179 @@
+// Open-loop latency benchmarks: throughput-vs-latency sweeps, free of
+// coordinated omission.
+//
+// Each run offers a fixed rate for DURATION from an OpenLoopSource (constant,
+// Poisson or bursty arrivals) and records, at the sink, latency from each
+// event's *intended* send time into a LatencyHistogram; the first WARMUP is
+// not recorded. The sweep raises the rate past saturation: beyond it
+// achieved_eps stops following offered_eps, lag_ms grows and the tail
+// latency runs away — which a closed-loop source (bench_pipeline_throughput,
+// bench_ysb) cannot show, since it slows down with the pipeline.
+//
+// Counters for every run, all with fixed names (stable for regression
+// tracking and diffs across commits):
+//   offered_eps   rate the schedule asked for
+//   achieved_eps  events reaching the sink per second, measured window
+//   p50_us p90_us p99_us p999_us max_us   latency from intended send time
+//   lag_ms        how far behind its schedule the source ended
+//   saturated     1 if achieved < 95% of offered or lag_ms > 10
+//
+// Run names are BM_<Pipeline>/profile:<0 constant|1 poisson|2 bursty>/keps:<rate>.
+// For a machine-readable file:
+//   ./bench_latency --benchmark_format=json --benchmark_out=latency.json
+#include <benchmark/benchmark.h>
+#include "klstream/core/runtime.hpp"
+#include "klstream/core/histogram.hpp"
+#include "klstream/operators/open_loop_source.hpp"
+#include "klstream/operators/map.hpp"
+#include "klstream/operators/filter.hpp"
+#include "klstream/operators/sink.hpp"
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+
+using namespace klstream;
+using namespace std::chrono;
+
+static constexpr auto WARMUP   = milliseconds(200);
+static constexpr auto DURATION = milliseconds(1000);
+
+namespace {
+
+// Sink side of a run: latency after warm-up, and the events counted.
+struct Recorder {
+    LatencyHistogram      hist;
+    std::atomic<uint64_t> measured{0};
+    uint64_t              from_ns = 0;   // intended send time where recording starts
+
+    void on(const Event<uint64_t>& ev) {
+        if (ev.timestamp_ns < from_ns) return;
+        hist.record(ev.latency_ns());
+        measured.store(measured.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+};
+
+void report(benchmark::State& state, double offered, const Recorder& r,
+            uint64_t lag_ns, double measured_sec) {
+    const double achieved = static_cast<double>(r.measured.load()) / measured_sec;
+    const double lag_ms   = static_cast<double>(lag_ns) / 1e6;
+    state.counters["offered_eps"]  = offered;
+    state.counters["achieved_eps"] = achieved;
+    state.counters["p50_us"]       = r.hist.percentile(0.50);
+    state.counters["p90_us"]       = r.hist.percentile(0.90);
+    state.counters["p99_us"]       = r.hist.percentile(0.99);
+    state.counters["p999_us"]      = r.hist.percentile(0.999);
+    state.counters["max_us"]       = r.hist.percentile(1.0);
+    state.counters["lag_ms"]       = lag_ms;
+    state.counters["saturated"]    = (achieved < 0.95 * offered || lag_ms > 10.0) ? 1 : 0;
+    state.SetItemsProcessed(static_cast<int64_t>(r.measured.load()));
+}
+
+// One run per iteration on a fresh Runtime: p.reset() rebuilds the
+// pipeline around a new Recorder, the source feeds p.input(), and
+// p.register_ops() adds the workers and everything but the source,
+// which runs alone on worker 0.
+template <typename Pipeline>
+void run(benchmark::State& state, Pipeline& p) {
+    const auto   profile = static_cast<ArrivalProfile>(state.range(0));
+    const double offered = static_cast<double>(state.range(1)) * 1000.0;
+    for (auto _ : state) {
+        Recorder rec;
+        p.reset(rec);
+        OpenLoopSource<uint64_t> src("src", p.input(), ArrivalSchedule(profile, offered),
+                                     [](uint64_t seq) { return seq; });
+        src.set_batch_size(DEFAULT_BATCH_SIZE);
+
+        Runtime rt;
+        p.register_ops(rt);
+        rt.register_op(&src, 0);
+        const uint64_t t0 = Clock::now_ns();
+        rec.from_ns = t0 + static_cast<uint64_t>(duration_cast<nanoseconds>(WARMUP).count());
+        rt.start();
+        std::this_thread::sleep_for(WARMUP + DURATION);
+        const uint64_t lag = src.lag_ns();
+        const double measured_sec =
+            static_cast<double>(Clock::now_ns() - rec.from_ns) / 1e9;
+        rt.stop();
+        report(state, offered, rec, lag, measured_sec);
+        state.SetIterationTime(measured_sec);
+    }
+}
+
+// src -> map -> filter -> sink, one worker per stage (the
+// bench_pipeline_throughput chain; the filter keeps every event so each
+// one is measured).
+struct Chain {
+    std::unique_ptr<SPSCQueue<Event<uint64_t>>> q1, q2, q3;
+    std::unique_ptr<MapOperator<uint64_t, uint64_t>> map;
+    std::unique_ptr<FilterOperator<uint64_t>>        flt;
+    std::unique_ptr<SinkOperator<uint64_t>>          snk;
+
+    void reset(Recorder& rec) {
+        q1  = std::make_unique<SPSCQueue<Event<uint64_t>>>(4096);
+        q2  = std::make_unique<SPSCQueue<Event<uint64_t>>>(4096);
+        q3  = std::make_unique<SPSCQueue<Event<uint64_t>>>(4096);
+        map = std::make_unique<MapOperator<uint64_t, uint64_t>>("map", q1.get(), q2.get(),
+                                                                [](uint64_t x) { return x * x; });
+        flt = std::make_unique<FilterOperator<uint64_t>>("flt", q2.get(), q3.get(),
+                                                         [](uint64_t x) { return x != 1; });
+        snk = std::make_unique<SinkOperator<uint64_t>>("snk", q3.get(),
+                                                       [&rec](const Event<uint64_t>& ev) { rec.on(ev); });
+        map->set_batch_size(DEFAULT_BATCH_SIZE);
+        flt->set_batch_size(DEFAULT_BATCH_SIZE);
+        snk->set_batch_size(DEFAULT_BATCH_SIZE);
+    }
+    SPSCQueue<Event<uint64_t>>* input() { return q1.get(); }
+    void register_ops(Runtime& rt) {
+        for (int i = 0; i < 4; ++i) rt.add_worker();
+        rt.register_op(map.get(), 1);
+        rt.register_op(flt.get(), 2);
+        rt.register_op(snk.get(), 3);
+    }
+};
+
+// src -> map (1000 x sin, ~10 µs) -> sink: a CPU-bound stage that
+// saturates in the 100k events/s range (BM_ExpensiveCompute).
+struct Compute {
+    std::unique_ptr<SPSCQueue<Event<uint64_t>>> q1, q2;
+    std::unique_ptr<MapOperator<uint64_t, uint64_t>> map;
+    std::unique_ptr<SinkOperator<uint64_t>>          snk;
+
+    void reset(Recorder& rec) {
+        q1  = std::make_unique<SPSCQueue<Event<uint64_t>>>(4096);
+        q2  = std::make_unique<SPSCQueue<Event<uint64_t>>>(4096);
+        map = std::make_unique<MapOperator<uint64_t, uint64_t>>("map", q1.get(), q2.get(), [](uint64_t x) {
+            double v = static_cast<double>(x);
+            for (int i = 0; i < 1000; ++i) v = std::sin(v);
+            return x + (v > 2.0 ? 1 : 0);
+        });
+        snk = std::make_unique<SinkOperator<uint64_t>>("snk", q2.get(),
+                                                       [&rec](const Event<uint64_t>& ev) { rec.on(ev); });
+    }
+    SPSCQueue<Event<uint64_t>>* input() { return q1.get(); }
+    void register_ops(Runtime& rt) {
+        for (int i = 0; i < 3; ++i) rt.add_worker();
+        rt.register_op(map.get(), 1);
+        rt.register_op(snk.get(), 2);
+    }
+};
+
+} // namespace
+
+static void BM_LatencyChain(benchmark::State& state) {
+    Chain p;
+    run(state, p);
+}
+BENCHMARK(BM_LatencyChain)
+    ->ArgNames({ "profile", "keps" })
+    ->ArgsProduct({ { 0, 1, 2 }, { 100, 500, 1000, 2000, 4000, 8000, 16000 } })
+    ->Iterations(1)->UseManualTime()->Unit(benchmark::kMillisecond);
+
+static void BM_LatencyCompute(benchmark::State& state) {
+    Compute p;
+    run(state, p);
+}
+BENCHMARK(BM_LatencyCompute)
+    ->ArgNames({ "profile", "keps" })
+    ->ArgsProduct({ { 0, 1, 2 }, { 10, 25, 50, 100, 200, 400 } })
+    ->Iterations(1)->UseManualTime()->Unit(benchmark::kMillisecond);
@@ -0,0 +1,86 @@
+// benchmarks/bench_metrics.cpp
+#include <benchmark/benchmark.h>
+#include "klstream/core/histogram.hpp"
+#include "klstream/core/metrics.hpp"
+#include "klstream/core/clock.hpp"
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using namespace klstream;
+
+namespace {
+
+// Latencies spread log-uniformly over 100 ns .. 10 ms, so record() walks
+// many buckets instead of hitting one hot line.
+std::vector<std::uint64_t> latencies() {
+    std::mt19937_64 rng(7);
+    std::uniform_real_distribution<double> e(2.0, 7.0);
+    std::vector<std::uint64_t> v(4096);
+    for (auto& x : v) x = static_cast<std::uint64_t>(std::pow(10.0, e(rng)));
+    return v;
+}
+
+} // namespace
+
+// ── LatencyHistogram::record: the per-event sink cost ────────────────────
+// state.range(0) is the precision in bits (6 = the default, 1.6% error).
+static void BM_Histogram_Record(benchmark::State& state) {
+    LatencyHistogram h(static_cast<unsigned>(state.range(0)));
+    const auto v = latencies();
+    std::size_t i = 0;
+    for (auto _ : state) {
+        h.record(v[i]);
+        i = (i + 1) & (v.size() - 1);
+    }
+    benchmark::DoNotOptimize(h.count());
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Histogram_Record)->ArgName("precision_bits")->Arg(3)->Arg(6)->Arg(10);
+
+// record(ev.latency_ns()) as a sink does it: a clock read plus the record.
+static void BM_Histogram_RecordNow(benchmark::State& state) {
+    LatencyHistogram h;
+    const std::uint64_t t0 = Clock::now_ns();
+    for (auto _ : state) h.record(Clock::now_ns() - t0);
+    benchmark::DoNotOptimize(h.count());
+    state.SetItemsProcessed(state.iterations());
+    state.SetLabel(Clock::source());
+}
+BENCHMARK(BM_Histogram_RecordNow);
+
+// Reader side: one p99 query and one full snapshot, as a MetricsReporter
+// tick pays per histogram.
+static void BM_Histogram_ValueAt(benchmark::State& state) {
+    LatencyHistogram h;
+    for (auto x : latencies()) h.record(x);
+    for (auto _ : state) benchmark::DoNotOptimize(h.value_at(0.99));
+}
+BENCHMARK(BM_Histogram_ValueAt);
+
+static void BM_Histogram_Snapshot(benchmark::State& state) {
+    LatencyHistogram h;
+    for (auto x : latencies()) h.record(x);
+    for (auto _ : state) benchmark::DoNotOptimize(h.snapshot().count());
+}
+BENCHMARK(BM_Histogram_Snapshot);
+
+// ── Counters: single-writer LocalCounter vs shared Counter ───────────────
+// What one events_processed.increment() costs an operator: a plain
+// load/add/store against a locked fetch_add.
+static void BM_LocalCounter_Increment(benchmark::State& state) {
+    OperatorMetrics m("op");
+    for (auto _ : state) m.events_processed.increment();
+    benchmark::DoNotOptimize(m.events_processed.load());
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LocalCounter_Increment);
+
+static void BM_Counter_Increment(benchmark::State& state) {
+    Counter c;
+    for (auto _ : state) c.increment();
+    benchmark::DoNotOptimize(c.load());
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Counter_Increment);
@@ -0,0 +1,151 @@
+// benchmarks/bench_mpmc_queue.cpp
+#include <benchmark/benchmark.h>
+#include "klstream/core/mpmc_queue.hpp"
+#include "klstream/core/event.hpp"
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using namespace klstream;
+
+// Events moved per iteration, split evenly across the producers.
+static constexpr std::int64_t ITEMS = 1 << 20;
+
+// ── Contended throughput: P producers, C consumers on one queue ──────────
+// state.range(0) producers and state.range(1) consumers, each on its own
+// thread, move ITEMS events through a 4096-slot queue per iteration. 1/1 is
+// the uncontended baseline to hold against BM_SPSC_Throughput; the cost of
+// each extra thread is the CAS retries on the shared head / tail and the
+// slot cache lines bouncing between cores.
+static void BM_MPMC_Contended(benchmark::State& state) {
+    const int producers = static_cast<int>(state.range(0));
+    const int consumers = static_cast<int>(state.range(1));
+    MPMCQueue<Event<int>> q(4096);
+    const Event<int> ev = Event<int>::make(42);
+
+    for (auto _ : state) {
+        std::atomic<std::int64_t> left{ITEMS};
+        std::vector<std::thread> threads;
+        for (int p = 0; p < producers; ++p) {
+            threads.emplace_back([&, p] {
+                const std::int64_t n = ITEMS / producers + (p < ITEMS % producers ? 1 : 0);
+                for (std::int64_t i = 0; i < n; ++i) {
+                    while (!q.try_push(ev)) std::this_thread::yield();
+                }
+            });
+        }
+        for (int c = 0; c < consumers; ++c) {
+            threads.emplace_back([&] {
+                Event<int> out;
+                while (left.load(std::memory_order_relaxed) > 0) {
+                    if (q.try_pop(&out)) left.fetch_sub(1, std::memory_order_relaxed);
+                    else std::this_thread::yield();
+                }
+            });
+        }
+        for (auto& t : threads) t.join();
+    }
+    state.SetItemsProcessed(state.iterations() * ITEMS);
+}
+BENCHMARK(BM_MPMC_Contended)
+    ->ArgNames({ "producers", "consumers" })
+    ->Args({ 1, 1 })->Args({ 2, 1 })->Args({ 1, 2 })->Args({ 2, 2 })
+    ->Args({ 4, 1 })->Args({ 1, 4 })->Args({ 4, 4 })
+    ->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// ── Batched: try_push_n / try_pop_n under the same contention ────────────
+// Each claim takes a run of up to `batch` slots with one CAS, so the
+// contended counters are touched batch times less often.
+static void BM_MPMC_ContendedBatch(benchmark::State& state) {
+    const int         threads_per_side = static_cast<int>(state.range(0));
+    const std::size_t batch            = static_cast<std::size_t>(state.range(1));
+    MPMCQueue<Event<int>> q(4096);
+    const std::vector<Event<int>> in(batch, Event<int>::make(42));
+
+    for (auto _ : state) {
+        std::atomic<std::int64_t> to_push{ITEMS}, left{ITEMS};
+        std::vector<std::thread> threads;
+        for (int p = 0; p < threads_per_side; ++p) {
+            threads.emplace_back([&] {
+                while (to_push.load(std::memory_order_relaxed) > 0) {
+                    const std::int64_t claim = to_push.fetch_sub(static_cast<std::int64_t>(batch));
+                    if (claim <= 0) break;
+                    std::size_t n = static_cast<std::size_t>(std::min<std::int64_t>(claim, batch));
+                    for (std::size_t done = 0; done < n;) {
+                        const std::size_t k = q.try_push_n(in.data(), n - done);
+                        if (k == 0) std::this_thread::yield();
+                        done += k;
+                    }
+                }
+            });
+        }
+        for (int c = 0; c < threads_per_side; ++c) {
+            threads.emplace_back([&] {
+                std::vector<Event<int>> out(batch);
+                while (left.load(std::memory_order_relaxed) > 0) {
+                    const std::size_t k = q.try_pop_n(out.data(), batch);
+                    if (k) left.fetch_sub(static_cast<std::int64_t>(k), std::memory_order_relaxed);
+                    else std::this_thread::yield();
+                }
+            });
+        }
+        for (auto& t : threads) t.join();
+    }
+    state.SetItemsProcessed(state.iterations() * ITEMS);
+}
+BENCHMARK(BM_MPMC_ContendedBatch)
+    ->ArgNames({ "threads", "batch" })
+    ->ArgsProduct({ { 1, 2, 4 }, { 1, 8, 32 } })
+    ->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// ── Uncontended cost of one push + pop on one thread ─────────────────────
+static void BM_MPMC_PushPopSingleThread(benchmark::State& state) {
+    MPMCQueue<Event<int>> q(1024);
+    const Event<int> ev = Event<int>::make(42);
+    Event<int> out;
+    for (auto _ : state) {
+        (void)q.try_push(ev);
+        (void)q.try_pop(&out);
+        benchmark::DoNotOptimize(out);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MPMC_PushPopSingleThread);
+
+// ── Fan-in of small payloads: Padded vs Compact slots ────────────────────
+// state.range(0) producers into one consumer, 8-byte payloads, 4096 slots:
+// 256 KB of ring padded, 64 KB compact. The compact ring is more likely to
+// stay in cache, at the price of neighbouring lines being a lap apart
+// rather than a slot apart.
+template <MPMCSlotLayout L>
+static void BM_MPMC_FanInSmallPayload(benchmark::State& state) {
+    const int producers = static_cast<int>(state.range(0));
+    MPMCQueue<std::uint64_t, L> q(4096);
+
+    for (auto _ : state) {
+        std::vector<std::thread> threads;
+        for (int p = 0; p < producers; ++p) {
+            threads.emplace_back([&, p] {
+                const std::int64_t n = ITEMS / producers + (p < ITEMS % producers ? 1 : 0);
+                for (std::int64_t i = 0; i < n; ++i) {
+                    while (!q.try_push(static_cast<std::uint64_t>(i))) std::this_thread::yield();
+                }
+            });
+        }
+        std::uint64_t out = 0;
+        for (std::int64_t left = ITEMS; left > 0;) {
+            if (q.try_pop(&out)) --left;
+            else std::this_thread::yield();
+        }
+        benchmark::DoNotOptimize(out);
+        for (auto& t : threads) t.join();
+    }
+    state.SetItemsProcessed(state.iterations() * ITEMS);
+}
+BENCHMARK_TEMPLATE(BM_MPMC_FanInSmallPayload, MPMCSlotLayout::Padded)
+    ->ArgName("producers")->Arg(1)->Arg(2)->Arg(4)
+    ->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_MPMC_FanInSmallPayload, MPMCSlotLayout::Compact)
+    ->ArgName("producers")->Arg(1)->Arg(2)->Arg(4)
+    ->UseRealTime()->Unit(benchmark::kMillisecond);
@@ -2,7 +2,9 @@
 #include <benchmark/benchmark.h>
 #include "klstream/core/spsc_queue.hpp"
 #include "klstream/core/event.hpp"
+#include <atomic>
 #include <thread>
+#include <vector>
 
 using namespace klstream;
 
@@ -28,6 +30,35 @@ BENCHMARK(BM_SPSC_Throughput)
     ->Arg(64)->Arg(256)->Arg(1024)->Arg(4096)->Arg(16384)
     ->UseRealTime()->ThreadRange(1, 1);
 
+// ── Batched throughput: try_push_n / try_pop_n ───────────────────────────
+// Same paired test as above, but each side moves `batch` events per index
+// publication. Compare items/sec against BM_SPSC_Throughput/4096 to see how
+// much of the per-event cost is the release-store + cache-line handoff.
+static void BM_SPSC_BatchThroughput(benchmark::State& state) {
+    const std::size_t batch = static_cast<std::size_t>(state.range(0));
+    SPSCQueue<Event<int>> q(4096);
+    std::vector<Event<int>> in(batch, Event<int>::make(42));
+    std::vector<Event<int>> out(batch);
+    std::atomic<bool> done{false};
+    auto producer = std::thread([&]{
+        while (!done.load(std::memory_order_relaxed)) {
+            (void)q.try_push_n(in.data(), batch);
+        }
+    });
+    std::int64_t items = 0;
+    for (auto _ : state) {
+        std::size_t n;
+        while ((n = q.try_pop_n(out.data(), batch)) == 0) {}
+        items += static_cast<std::int64_t>(n);
+    }
+    done.store(true);
+    producer.join();
+    state.SetItemsProcessed(items);
+}
+BENCHMARK(BM_SPSC_BatchThroughput)
+    ->Arg(1)->Arg(8)->Arg(32)->Arg(128)
+    ->UseRealTime();
+
 // ── Latency: round-trip time for one event through a SPSC queue ──────────
 // (ping-pong between two threads)
 static void BM_SPSC_RTT_Latency(benchmark::State& state) {
@@ -0,0 +1,157 @@
+// benchmarks/bench_window_ops.cpp
+#include <benchmark/benchmark.h>
+#include "klstream/window/adaptive_window_op.hpp"
+#include "klstream/window/data_driven_window_op.hpp"
+#include "klstream/window/batch_pool.hpp"
+#include "klstream/window/feature_extract_op.hpp"
+#include "klstream/operators/window.hpp"
+#include "klstream/core/spsc_queue.hpp"
+#include <chrono>
+#include <cstdint>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+
+using namespace klstream;
+
+// Events per iteration. One thread plays producer, operator and consumer,
+// so these are the operator's own per-event costs: pop, buffer, the
+// window-start decision, and the window copy out.
+static constexpr std::size_t BLOCK = 1024;
+
+namespace {
+
+std::vector<Event<FeatureVector>> feature_events() {
+    std::vector<Event<FeatureVector>> evs(BLOCK);
+    for (std::size_t i = 0; i < BLOCK; ++i) {
+        const float x = static_cast<float>(i % 97) * 1e-3f;
+        evs[i] = Event<FeatureVector>::make(FeatureVector{ x, 1e-8f + x * 1e-8f, x, 1.0f, x }, 0, i);
+    }
+    return evs;
+}
+
+// Feeds BLOCK events through `op` per iteration, draining its output (and
+// returning pooled slots) as it goes.
+template <typename Op, typename Out>
+void feed(benchmark::State& state, Op& op, SPSCQueue<Event<FeatureVector>>& in,
+          SPSCQueue<Event<Out>>& out, WindowBatchPool* pool) {
+    const auto evs = feature_events();
+    Event<Out> w;
+    std::int64_t windows = 0;
+    for (auto _ : state) {
+        std::size_t pushed = 0;
+        while (pushed < BLOCK || !in.empty()) {
+            if (pushed < BLOCK) pushed += in.try_push_n(evs.data() + pushed, BLOCK - pushed);
+            (void)op.tick();
+            while (out.try_pop(&w)) {
+                if constexpr (std::is_same_v<Out, WindowHandle>) pool->release(w.data.slot);
+                benchmark::DoNotOptimize(w);
+                ++windows;
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(BLOCK));
+    state.counters["windows"] = benchmark::Counter(static_cast<double>(windows), benchmark::Counter::kIsRate);
+}
+
+} // namespace
+
+// ── AdaptiveWindowOp: fixed window size, by value vs pooled ──────────────
+// w_min = w_max = state.range(0) pins the window size; the EMA update and
+// controller still run at every window start. state.range(1): 0 queues
+// the whole WindowBatch (~5 KB) by value, 1 queues a WindowHandle into a
+// WindowBatchPool — the difference is the cost of the big copy.
+static void BM_AdaptiveWindowOp(benchmark::State& state) {
+    const auto w = static_cast<std::uint32_t>(state.range(0));
+    SPSCQueue<Event<FeatureVector>> in(2048);
+    if (state.range(1) == 0) {
+        SPSCQueue<Event<WindowBatch>> out(64);
+        AdaptiveWindowOp op("win", &in, &out, w, w);
+        feed(state, op, in, out, nullptr);
+    } else {
+        SPSCQueue<Event<WindowHandle>> out(64);
+        WindowBatchPool pool(out.capacity() + 2);
+        PooledAdaptiveWindowOp op("win", &in, &out, w, w);
+        op.attach_pool(&pool);
+        feed(state, op, in, out, &pool);
+    }
+}
+BENCHMARK(BM_AdaptiveWindowOp)
+    ->ArgNames({ "window", "pooled" })
+    ->ArgsProduct({ { 16, 64, 256 }, { 0, 1 } });
+
+// ── DataDrivenWindowOp: same sizes, volatility-driven controller ────────
+static void BM_DataDrivenWindowOp(benchmark::State& state) {
+    const auto w = static_cast<std::uint32_t>(state.range(0));
+    SPSCQueue<Event<FeatureVector>> in(2048);
+    if (state.range(1) == 0) {
+        SPSCQueue<Event<WindowBatch>> out(64);
+        DataDrivenWindowOp op("win", &in, &out, w, w);
+        feed(state, op, in, out, nullptr);
+    } else {
+        SPSCQueue<Event<WindowHandle>> out(64);
+        WindowBatchPool pool(out.capacity() + 2);
+        PooledDataDrivenWindowOp op("win", &in, &out, w, w);
+        op.attach_pool(&pool);
+        feed(state, op, in, out, &pool);
+    }
+}
+BENCHMARK(BM_DataDrivenWindowOp)
+    ->ArgNames({ "window", "pooled" })
+    ->ArgsProduct({ { 16, 64, 256 }, { 0, 1 } });
+
+// ── TumblingTimeWindow: window duration x batch size ─────────────────────
+// state.range(0) is the window duration in µs; events arrive as fast as
+// one thread can push them, so a longer window buffers more per firing.
+// state.range(1) is set_batch_size(): 1 pays the clock read and pop per
+// event, 32 once per tick.
+static void BM_TumblingTimeWindow(benchmark::State& state) {
+    SPSCQueue<Event<std::uint64_t>> in(2048), out(64);
+    TumblingTimeWindow<std::uint64_t, std::uint64_t> op(
+        "win", &in, &out, std::chrono::microseconds(state.range(0)),
+        [](const std::vector<std::uint64_t>& v) { return std::accumulate(v.begin(), v.end(), std::uint64_t{0}); });
+    op.set_batch_size(static_cast<std::size_t>(state.range(1)));
+
+    std::vector<Event<std::uint64_t>> evs(BLOCK);
+    for (std::size_t i = 0; i < BLOCK; ++i) evs[i] = Event<std::uint64_t>::make(i);
+    Event<std::uint64_t> r;
+    std::int64_t windows = 0;
+    for (auto _ : state) {
+        std::size_t pushed = 0;
+        while (pushed < BLOCK || !in.empty()) {
+            if (pushed < BLOCK) pushed += in.try_push_n(evs.data() + pushed, BLOCK - pushed);
+            (void)op.tick();
+            while (out.try_pop(&r)) ++windows;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(BLOCK));
+    state.counters["windows"] = benchmark::Counter(static_cast<double>(windows), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_TumblingTimeWindow)
+    ->ArgNames({ "window_us", "batch" })
+    ->ArgsProduct({ { 10, 100, 1000 }, { 1, 32 } });
+
+// ── FeatureExtractor: ticks per extract() call ───────────────────────────
+// state.range(0) is the batch: 1 is the per-event path, larger batches let
+// the stateless pass run as one loop. state.range(1): 0 = EMA volatility
+// (the offline feature), 1 = rolling variance over 64 ticks.
+static void BM_FeatureExtract(benchmark::State& state) {
+    const auto batch = static_cast<std::size_t>(state.range(0));
+    std::vector<BookTop> ticks(BLOCK);
+    for (std::size_t i = 0; i < BLOCK; ++i) {
+        const double bid = 1'000'000.0 + 100.0 * static_cast<double>(i % 13);
+        ticks[i] = BookTop{ bid, bid + 100.0 * static_cast<double>(1 + i % 3),
+                            static_cast<std::uint32_t>(i % 500), static_cast<std::uint32_t>((i * 7) % 500) };
+    }
+    std::vector<FeatureVector> out(BLOCK);
+    FeatureExtractor fx = state.range(1) == 0 ? FeatureExtractor{} : FeatureExtractor::rolling(64);
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < BLOCK; i += batch) fx.extract(ticks.data() + i, batch, out.data() + i);
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(BLOCK));
+}
+BENCHMARK(BM_FeatureExtract)
+    ->ArgNames({ "batch", "rolling" })
+    ->ArgsProduct({ { 1, 16, 256 }, { 0, 1 } });
@@ -4,9 +4,14 @@
 #include "klstream/operators/map.hpp"
 #include "klstream/operators/filter.hpp"
 #include "klstream/operators/window.hpp"
+#include "klstream/operators/sketch_window.hpp"
 #include "klstream/operators/sink.hpp"
+#include "klstream/operators/pipeline.hpp"
+#include "klstream/core/keyed_state.hpp"
+#include <algorithm>
 #include <atomic>
 #include <random>
+#include <vector>
 
 using namespace klstream;
 using namespace std::chrono;
@@ -33,7 +38,21 @@ static void build_campaign_table() {
     }
 }
 
+// Per-window aggregation: views per campaign, return the top campaign.
+// `counts` is reused across windows, so steady state allocates nothing.
+static CampaignResult top_campaign(KeyedStateStore<uint64_t>& counts,
+                                   const std::vector<Event<CampaignResult>>& buf) {
+    counts.clear();
+    for (const auto& r : buf) counts[r.data.campaign_id] += r.data.view_count;
+    auto it = std::max_element(counts.begin(), counts.end(), [](const auto& a, const auto& b){ return a.value < b.value; });
+    return { static_cast<uint32_t>(it->key), it->value };
+}
+
+// state.range(0): per-operator batch size (1 = one event per tick()).
+// state.range(1): 1 = fuse source and filter on worker 0 (no q1 hop).
 static void BM_YSBThroughput(benchmark::State& state) {
+    const std::size_t batch = static_cast<std::size_t>(state.range(0));
+    const bool        fuse  = state.range(1) != 0;
     build_campaign_table();
     std::mt19937 rng(42);
     std::uniform_int_distribution<uint32_t> ad_dist(0, N_ADS - 1);
@@ -52,16 +71,20 @@ static void BM_YSBThroughput(benchmark::State& state) {
         MapOperator<AdEvent, CampaignResult> map("map", &q2, &q3, [](const AdEvent& e) -> CampaignResult {
             return { campaign_table[e.ad_id], 1 };
         });
-        TumblingCountWindow<CampaignResult, CampaignResult> win("win", &q3, &q4, 1000, [](const std::vector<Event<CampaignResult>>& buf) -> CampaignResult {
-            std::unordered_map<uint32_t, uint64_t> counts;
-            for (const auto& r : buf) counts[r.data.campaign_id] += r.data.view_count;
-            auto it = std::max_element(counts.begin(), counts.end(), [](const auto& a, const auto& b){ return a.second < b.second; });
-            return { it->first, it->second };
+        KeyedStateStore<uint64_t> counts(N_CAMPAIGNS);
+        TumblingCountWindow<CampaignResult, CampaignResult> win("win", &q3, &q4, 1000, [&counts](const std::vector<Event<CampaignResult>>& buf) {
+            return top_campaign(counts, buf);
         });
         std::atomic<uint64_t> count{0};
         SinkOperator<CampaignResult> sink("snk", &q4, [&count](const Event<CampaignResult>&){ count++; });
+        source.set_batch_size(batch);
+        filter.set_batch_size(batch);
+        map.set_batch_size(batch);
+        win.set_batch_size(batch);
+        sink.set_batch_size(batch);
         
         Runtime rt;
+        rt.set_operator_fusion(fuse);
         for(int i=0; i<4; ++i) rt.add_worker();
         rt.register_op(&source, 0);
         rt.register_op(&filter, 0);
@@ -79,4 +102,101 @@ static void BM_YSBThroughput(benchmark::State& state) {
         state.SetIterationTime(duration_cast<duration<double>>(end - start).count());
     }
 }
-BENCHMARK(BM_YSBThroughput)->UseManualTime();
+BENCHMARK(BM_YSBThroughput)
+    ->Args({1, 0})->Args({DEFAULT_BATCH_SIZE, 0})
+    ->Args({1, 1})->Args({DEFAULT_BATCH_SIZE, 1})
+    ->UseManualTime();
+
+// The same chain with the exact per-window map replaced by a Space-Saving
+// summary (sketch_window.hpp): the top campaign estimated in 16 counters,
+// whatever the campaign count. state.range(0): per-operator batch size.
+static void BM_YSBThroughputSketch(benchmark::State& state) {
+    const std::size_t batch = static_cast<std::size_t>(state.range(0));
+    build_campaign_table();
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<uint32_t> ad_dist(0, N_ADS - 1);
+    std::uniform_int_distribution<uint8_t>  type_dist(0, 2);
+
+    for (auto _ : state) {
+        SPSCQueue<Event<AdEvent>>         q1(16384);
+        SPSCQueue<Event<AdEvent>>         q2(16384);
+        SPSCQueue<Event<CampaignResult>>  q3(16384);
+        SPSCQueue<Event<CampaignResult>>  q4(16384);
+
+        SourceOperator<AdEvent> source("src", &q1, [&](Event<AdEvent>& out, uint64_t seq) {
+            out = Event<AdEvent>::make(AdEvent{ ad_dist(rng), 0, type_dist(rng) }, 0, seq); return true;
+        });
+        FilterOperator<AdEvent> filter("flt", &q1, &q2, [](const AdEvent& e){ return e.event_type == 0; });
+        MapOperator<AdEvent, CampaignResult> map("map", &q2, &q3, [](const AdEvent& e) -> CampaignResult {
+            return { campaign_table[e.ad_id], 1 };
+        });
+        SketchCountWindow<CampaignResult, SpaceSaving, CampaignResult> win("win", &q3, &q4, 1000, SpaceSaving(16),
+            [](const SpaceSaving& s) {
+                const auto top = s.top(1).front();
+                return CampaignResult{ static_cast<uint32_t>(top.key), top.count };
+            },
+            [](const Event<CampaignResult>& e) -> uint64_t { return e.data.campaign_id; });
+        std::atomic<uint64_t> count{0};
+        SinkOperator<CampaignResult> sink("snk", &q4, [&count](const Event<CampaignResult>&){ count++; });
+        source.set_batch_size(batch);
+        filter.set_batch_size(batch);
+        map.set_batch_size(batch);
+        win.set_batch_size(batch);
+        sink.set_batch_size(batch);
+
+        Runtime rt;
+        for(int i=0; i<4; ++i) rt.add_worker();
+        rt.register_op(&source, 0);
+        rt.register_op(&filter, 0);
+        rt.register_op(&map, 1);
+        rt.register_op(&win, 2);
+        rt.register_op(&sink, 3);
+
+        auto start = high_resolution_clock::now();
+        rt.start();
+        rt.wait_for(seconds(2));
+        rt.stop();
+        auto end = high_resolution_clock::now();
+
+        state.SetItemsProcessed(count.load() * 1000);
+        state.SetIterationTime(duration_cast<duration<double>>(end - start).count());
+    }
+}
+BENCHMARK(BM_YSBThroughputSketch)->Arg(1)->Arg(DEFAULT_BATCH_SIZE)->UseManualTime();
+
+// The same chain built with the compile-time DSL: one operator on one
+// worker, every stage inlined, DEFAULT_BATCH_SIZE events per tick().
+static void BM_YSBThroughputStatic(benchmark::State& state) {
+    build_campaign_table();
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<uint32_t> ad_dist(0, N_ADS - 1);
+    std::uniform_int_distribution<uint8_t>  type_dist(0, 2);
+
+    for (auto _ : state) {
+        std::atomic<uint64_t> count{0};
+        KeyedStateStore<uint64_t> counts(N_CAMPAIGNS);
+        auto ysb = dsl::source<AdEvent>("ysb", [&](Event<AdEvent>& out, uint64_t seq) {
+                       out = Event<AdEvent>::make(AdEvent{ ad_dist(rng), 0, type_dist(rng) }, 0, seq); return true;
+                   })
+                 | dsl::filter([](const AdEvent& e) { return e.event_type == 0; })
+                 | dsl::map([](const AdEvent& e) { return CampaignResult{ campaign_table[e.ad_id], 1 }; })
+                 | dsl::window<1000>([&counts](const std::vector<Event<CampaignResult>>& buf) {
+                       return top_campaign(counts, buf);
+                   })
+                 | dsl::sink([&count](const Event<CampaignResult>&) { count++; });
+
+        Runtime rt;
+        rt.add_worker();
+        rt.register_op(&ysb, 0);
+
+        auto start = high_resolution_clock::now();
+        rt.start();
+        rt.wait_for(seconds(2));
+        rt.stop();
+        auto end = high_resolution_clock::now();
+
+        state.SetItemsProcessed(count.load() * 1000);
+        state.SetIterationTime(duration_cast<duration<double>>(end - start).count());
+    }
+}
+BENCHMARK(BM_YSBThroughputStatic)->UseManualTime();
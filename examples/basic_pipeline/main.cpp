@@ -101,6 +101,13 @@ int main() {
     rt.metrics().add(&m_flt);
     rt.metrics().add(&m_agg);
     rt.metrics().add(&m_snk);
+    rt.metrics().add_queue("source->square_map", &q_src_map);
+    rt.metrics().add_queue("square_map->even_filter", &q_map_flt);
+    rt.metrics().add_queue("even_filter->running_sum", &q_flt_agg);
+    rt.metrics().add_queue("running_sum->sink", &q_agg_snk);
+    rt.metrics().add_histogram("sink", &latency_hist);
+    // Scrape instead of printing (core/metrics_export.hpp):
+    // rt.metrics().add_exporter(std::make_unique<PrometheusExporter>(9464));
 
     // ── Run for 10 seconds ────────────────────────────────────────────────
     std::cout << "KLStream basic_pipeline running for 10 seconds...\n";
@@ -4,19 +4,17 @@
 #include "klstream/core/spsc_queue.hpp"
 #include "klstream/core/metrics.hpp"
 #include "klstream/core/runtime.hpp"
-#include "klstream/operators/source.hpp"
-#include "klstream/operators/filter.hpp"
-#include "klstream/operators/map.hpp"
-#include "klstream/operators/window.hpp"
-#include "klstream/operators/sink.hpp"
+#include "klstream/core/keyed_state.hpp"
+#include "klstream/operators/graph.hpp"
 
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <chrono>
 #include <cstdint>
 #include <iostream>
 #include <random>
 #include <string>
-#include <unordered_map>
 
 namespace ysb {
 
@@ -62,86 +60,66 @@ int main() {
     std::uniform_int_distribution<uint32_t> ad_dist(0, N_ADS - 1);
     std::uniform_int_distribution<uint8_t>  type_dist(0, 2);
 
-    // ── Queues ────────────────────────────────────────────────────────────
+    // ── Graph ─────────────────────────────────────────────────────────────
     // YSB pipeline:
     //   Source<AdEvent> -> Filter<AdEvent> -> Map<AdEvent,CampaignResult>
     //     -> TumblingCountWindow<CampaignResult,CampaignResult>
     //     -> Sink<CampaignResult>
-    SPSCQueue<Event<AdEvent>>         q_src_flt(4096);
-    SPSCQueue<Event<AdEvent>>         q_flt_map(4096);
-    SPSCQueue<Event<CampaignResult>>  q_map_win(4096);
-    SPSCQueue<Event<CampaignResult>>  q_win_snk(4096);
-
-    OperatorMetrics m_src("ysb_source");
-    OperatorMetrics m_flt("view_filter");
-    OperatorMetrics m_map("campaign_join");
-    OperatorMetrics m_win("10sec_window");
-    OperatorMetrics m_snk("ysb_sink");
+    // Queue capacities and worker placement come from the builder's plan.
     LatencyHistogram latency;
     std::atomic<uint64_t> total_out{0};
 
-    // Source: generates random AdEvents
-    SourceOperator<AdEvent> source(
-        "ysb_source", &q_src_flt,
-        [&rng, &ad_dist, &type_dist]
-        (Event<AdEvent>& out, uint64_t seq) -> bool {
-            out = Event<AdEvent>::make(
-                AdEvent{ ad_dist(rng), 0, type_dist(rng) }, 0, seq);
-            return true;
-        });
-    source.attach_metrics(&m_src);
-
-    // Filter: keep only event_type == 0 (view events)
-    FilterOperator<AdEvent> view_filter(
-        "view_filter", &q_src_flt, &q_flt_map,
-        [](const AdEvent& e) { return e.event_type == 0; });
-    view_filter.attach_metrics(&m_flt);
-
-    // Map (replaces the distributed join): look up campaign_id
-    MapOperator<AdEvent, CampaignResult> join(
-        "campaign_join", &q_flt_map, &q_map_win,
-        [](const AdEvent& e) -> CampaignResult {
-            return { campaign_table[e.ad_id], 1 };
-        });
-    join.attach_metrics(&m_map);
-
-    // Window: count views per campaign over every 1000 events
-    // (replaces the original 10-second tumbling window for benchmark clarity)
-    TumblingCountWindow<CampaignResult, CampaignResult> win(
-        "1k_window", &q_map_win, &q_win_snk, 1000,
-        [](const std::vector<Event<CampaignResult>>& buf) -> CampaignResult {
-            std::unordered_map<uint32_t, uint64_t> counts;
-            for (const auto& r : buf) counts[r.data.campaign_id] += r.data.view_count;
-            // Return the campaign with most views in this window.
-            auto it = std::max_element(counts.begin(), counts.end(),
-                [](const auto& a, const auto& b){ return a.second < b.second; });
-            return { it->first, it->second };
-        });
-    win.attach_metrics(&m_win);
-
-    // Sink
-    SinkOperator<CampaignResult> sink(
-        "ysb_sink", &q_win_snk,
-        [&latency, &total_out](const Event<CampaignResult>& ev) {
-            latency.record(ev.latency_ns());
-            total_out.fetch_add(1, std::memory_order_relaxed);
-        });
-    sink.attach_metrics(&m_snk);
+    StreamGraphBuilder graph;
+    graph
+        // Source: generates random AdEvents
+        .source<AdEvent>("ysb_source",
+            [&rng, &ad_dist, &type_dist]
+            (Event<AdEvent>& out, uint64_t seq) -> bool {
+                out = Event<AdEvent>::make(
+                    AdEvent{ ad_dist(rng), 0, type_dist(rng) }, 0, seq);
+                return true;
+            })
+        // Filter: keep only event_type == 0 (view events)
+        .filter("view_filter", [](const AdEvent& e) { return e.event_type == 0; })
+        .hint(5, 1.0 / 3)
+        // Map (replaces the distributed join): look up campaign_id
+        .map<CampaignResult>("campaign_join",
+            [](const AdEvent& e) -> CampaignResult {
+                return { campaign_table[e.ad_id], 1 };
+            })
+        .hint(10)
+        // Window: count views per campaign over every 1000 events
+        // (replaces the original 10-second tumbling window for benchmark clarity).
+        // The per-campaign table is reused across windows: no allocation
+        // once it has seen every campaign.
+        .count_window<CampaignResult>("1k_window", 1000,
+            [counts = KeyedStateStore<uint64_t>(N_CAMPAIGNS)]
+            (const std::vector<Event<CampaignResult>>& buf) mutable -> CampaignResult {
+                counts.clear();
+                for (const auto& r : buf) counts[r.data.campaign_id] += r.data.view_count;
+                // Return the campaign with most views in this window.
+                auto it = std::max_element(counts.begin(), counts.end(),
+                    [](const auto& a, const auto& b){ return a.value < b.value; });
+                return { static_cast<uint32_t>(it->key), it->value };
+            })
+        // Sink
+        .sink("ysb_sink",
+            [&latency, &total_out](const Event<CampaignResult>& ev) {
+                latency.record(ev.latency_ns());
+                total_out.fetch_add(1, std::memory_order_relaxed);
+            });
 
     // ── Runtime ───────────────────────────────────────────────────────────
+    PlanOptions opts;
+    opts.workers     = 3;
+    opts.source_rate = 20e6;
+    opts.batch_size  = DEFAULT_BATCH_SIZE;
+    const GraphPlan plan = graph.plan(opts);
+    std::cout << plan.describe();
+
     Runtime rt;
-    rt.add_worker(CoreAffinity::Performance);  // 0: source + filter
-    rt.add_worker(CoreAffinity::Performance);  // 1: join + window
-    rt.add_worker(CoreAffinity::Efficiency);   // 2: sink
-
-    rt.register_op(&source,      0);
-    rt.register_op(&view_filter, 0);
-    rt.register_op(&join,        1);
-    rt.register_op(&win,         1);
-    rt.register_op(&sink,        2);
-
-    for (auto* m : {&m_src, &m_flt, &m_map, &m_win, &m_snk})
-        rt.metrics().add(m);
+    rt.set_operator_fusion(true);   // co-located filter/map stages run as one unit
+    auto pipeline = graph.build(rt, plan);
 
     std::cout << "KLStream Yahoo Streaming Benchmark — 30 seconds\n";
     rt.start();
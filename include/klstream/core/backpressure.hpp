@@ -1,10 +1,12 @@
 // include/klstream/core/backpressure.hpp
 #pragma once
 #include "config.hpp"
+#include "clock.hpp"
+#include <algorithm>
 #include <atomic>
-#include <chrono>
 #include <thread>
 #include <cstdint>
+#include <vector>
 
 namespace klstream {
 
@@ -35,11 +37,19 @@ public:
 
     // Call once per tick() to update the EMA.
     void update() noexcept {
-        double occ = queue_.occupancy();
-        ema_ = alpha_ * occ + (1.0 - alpha_) * ema_;
+        last_ = queue_.occupancy();
+        ema_  = alpha_ * last_ + (1.0 - alpha_) * ema_;
     }
 
     [[nodiscard]] double ema() const noexcept { return ema_; }
+    // The occupancy update() last read, without a second queue read.
+    [[nodiscard]] double last() const noexcept { return last_; }
+
+    // Resumes from a saved ema() / last() (a restored checkpoint).
+    void resume(double ema, double last) noexcept {
+        ema_  = ema;
+        last_ = last;
+    }
 
     // Returns true if the EMA exceeds the soft backpressure threshold.
     // When this returns true the source should reduce its emission rate.
@@ -58,6 +68,7 @@ private:
     Queue&      queue_;
     double      alpha_;
     double      ema_;
+    double      last_{0.0};
 };
 
 // ── TokenBucketRateLimiter ────────────────────────────────────────────────
@@ -69,6 +80,10 @@ private:
 // Each call to try_consume() uses one token. When the bucket is empty,
 // try_consume() returns false and the source should pause.
 //
+// Elapsed time comes from Clock::coarse_ns(): refill() runs once per event,
+// and a millisecond-resolution clock refills in steps of rate × 1–4 ms with
+// the same long-run rate, for a fraction of the cost of a precise read.
+//
 // The rate can be reduced at runtime via set_rate(). This is how the adaptive
 // backpressure controller gradually slows the source when soft pressure is
 // detected (before the queue is actually full).
@@ -77,14 +92,20 @@ public:
     explicit TokenBucketRateLimiter(double tokens_per_sec,
                                     double max_burst = 0.0)
         : rate_(tokens_per_sec)
-        , tokens_(tokens_per_sec) // start full
         , max_tokens_(max_burst > 0 ? max_burst : tokens_per_sec)
-        , last_(std::chrono::steady_clock::now())
-    {}
+        , last_ns_(Clock::coarse_ns())
+    {
+        tokens_ = max_tokens_; // start full
+    }
 
     // Refill tokens based on elapsed time, then try to consume one.
     [[nodiscard]] bool try_consume() noexcept {
-        refill();
+        return try_consume(Clock::coarse_ns());
+    }
+
+    // The same with a coarse_ns() reading the caller already has.
+    [[nodiscard]] bool try_consume(std::uint64_t now_ns) noexcept {
+        refill(now_ns);
         if (tokens_ >= 1.0) {
             tokens_ -= 1.0;
             return true;
@@ -92,6 +113,13 @@ public:
         return false;
     }
 
+    // Returns a token try_consume() took for nothing (the caller had no
+    // event to spend it on).
+    void refund() noexcept {
+        tokens_ += 1.0;
+        if (tokens_ > max_tokens_) tokens_ = max_tokens_;
+    }
+
     void set_rate(double tokens_per_sec) noexcept {
         rate_ = tokens_per_sec;
     }
@@ -99,18 +127,120 @@ public:
     double rate() const noexcept { return rate_; }
 
 private:
-    void refill() noexcept {
-        auto now     = std::chrono::steady_clock::now();
-        double elapsed = std::chrono::duration<double>(now - last_).count();
-        last_    = now;
-        tokens_ += elapsed * rate_;
+    void refill(std::uint64_t now) noexcept {
+        if (now <= last_ns_) return;
+        tokens_ += static_cast<double>(now - last_ns_) * 1e-9 * rate_;
+        last_ns_ = now;
         if (tokens_ > max_tokens_) tokens_ = max_tokens_;
     }
 
     double rate_;
-    double tokens_;
+    double tokens_{0.0};
     double max_tokens_;
-    std::chrono::steady_clock::time_point last_;
+    std::uint64_t last_ns_;
+};
+
+// ── QueueProbe ────────────────────────────────────────────────────────────
+//
+// A type-erased read of one queue's occupancy(), so a controller can watch
+// queues of different event types — every edge between a source and the
+// slowest operator downstream of it.
+struct QueueProbe {
+    const void* queue = nullptr;
+    double (*occupancy)(const void*) = nullptr;
+
+    [[nodiscard]] double read() const noexcept { return occupancy(queue); }
+};
+
+template <typename Queue>
+[[nodiscard]] QueueProbe probe(const Queue& q) noexcept {
+    return { &q, [](const void* p) { return static_cast<const Queue*>(p)->occupancy(); } };
+}
+
+// ── AimdRateController ────────────────────────────────────────────────────
+//
+// Publishes a target emission rate for a source from the occupancy of the
+// queues it watches: its own output and, through watch(), any queue
+// further downstream. Pressure is the EMA of the fullest watched queue, so
+// a slow operator three hops away throttles the source as soon as its
+// input queue starts filling — before the queues in between back up and
+// the source stalls on a full ring.
+//
+// Once per BP_CONTROL_INTERVAL_NS (update() is cheap to call every tick;
+// it does nothing in between):
+//   pressure > BP_SOFT_THRESHOLD  rate *= BP_DECREASE_FACTOR   (to min_rate)
+//   pressure < BP_LOW_THRESHOLD   rate += BP_INCREASE_FRACTION × max_rate
+//   in between                    rate unchanged
+// The additive step is a fixed fraction of max_rate, so after an overload
+// clears the rate is back at max_rate within 1 / BP_INCREASE_FRACTION
+// intervals rather than creeping up geometrically.
+//
+// One thread calls update(); rate(), pressure() and the counters may be
+// read from any thread.
+class AimdRateController {
+public:
+    explicit AimdRateController(double max_rate, double min_rate = 0.0,
+                                double alpha = 0.30,
+                                std::uint64_t interval_ns = BP_CONTROL_INTERVAL_NS)
+        : max_rate_(max_rate)
+        , min_rate_(min_rate > 0 ? min_rate : max_rate * 1e-3)
+        , step_(max_rate * BP_INCREASE_FRACTION)
+        , alpha_(alpha)
+        , interval_ns_(interval_ns)
+        , rate_(max_rate)
+    {}
+
+    template <typename Queue>
+    void watch(const Queue& q) { probes_.push_back(probe(q)); }
+    void watch(QueueProbe p) { probes_.push_back(p); }
+
+    std::size_t watched() const noexcept { return probes_.size(); }
+
+    // Samples the watched queues if an interval has passed since the last
+    // sample. Returns false while one of them was above BP_HARD_THRESHOLD
+    // at that sample: the source should emit nothing until the next one.
+    bool update(std::uint64_t now_ns) noexcept {
+        if (now_ns - last_ns_ < interval_ns_) return !hard_;
+        last_ns_ = now_ns;
+
+        double occ = 0.0;
+        for (const auto& p : probes_) occ = std::max(occ, p.read());
+        hard_ = occ > BP_HARD_THRESHOLD;
+        ema_  = alpha_ * occ + (1.0 - alpha_) * ema_;
+
+        double r = rate_.load(std::memory_order_relaxed);
+        if (hard_ || ema_ > BP_SOFT_THRESHOLD) {
+            r = std::max(min_rate_, r * BP_DECREASE_FACTOR);
+            decreases_.store(decreases_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        } else if (ema_ < BP_LOW_THRESHOLD && r < max_rate_) {
+            r = std::min(max_rate_, r + step_);
+            increases_.store(increases_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+        rate_.store(r, std::memory_order_relaxed);
+        pressure_.store(ema_, std::memory_order_relaxed);
+        return !hard_;
+    }
+
+    [[nodiscard]] double rate() const noexcept { return rate_.load(std::memory_order_relaxed); }
+    [[nodiscard]] double max_rate() const noexcept { return max_rate_; }
+    [[nodiscard]] double pressure() const noexcept { return pressure_.load(std::memory_order_relaxed); }
+    [[nodiscard]] std::uint64_t increases() const noexcept { return increases_.load(std::memory_order_relaxed); }
+    [[nodiscard]] std::uint64_t decreases() const noexcept { return decreases_.load(std::memory_order_relaxed); }
+
+private:
+    double                     max_rate_;
+    double                     min_rate_;
+    double                     step_;
+    double                     alpha_;
+    std::uint64_t              interval_ns_;
+    std::uint64_t              last_ns_{0};
+    double                     ema_{0.0};
+    bool                       hard_{false};
+    std::vector<QueueProbe>    probes_;
+    std::atomic<double>        rate_;
+    std::atomic<double>        pressure_{0.0};
+    std::atomic<std::uint64_t> increases_{0};
+    std::atomic<std::uint64_t> decreases_{0};
 };
 
 } // namespace klstream
@@ -0,0 +1,79 @@
+// include/klstream/core/batch.hpp
+#pragma once
+#include "config.hpp"
+#include "metrics.hpp"
+#include "operator.hpp"
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+namespace klstream {
+
+// ── PendingBatch<T> ───────────────────────────────────────────────────────
+//
+// The batch-mode generalisation of the single `pending_` slot every operator
+// carries (see IOperator). Holds up to capacity() already-computed output
+// events that have not yet been pushed downstream.
+//
+// Protocol, per batched tick():
+//   1. If !empty(): flush(). If still !empty() the output is full -> Blocked,
+//      and do NOT pop any new input.
+//   2. Otherwise pop up to capacity() inputs, append() one output per input
+//      (at most), then flush() once.
+//
+// Because each input produces at most one output and we never pop while
+// anything is pending, capacity() == batch size is always sufficient and the
+// buffer never reallocates after set_capacity().
+template <typename T>
+class PendingBatch {
+public:
+    void set_capacity(std::size_t n) {
+        buf_.resize(n);
+        head_ = tail_ = 0;
+    }
+
+    std::size_t capacity() const noexcept { return buf_.size(); }
+    bool        empty() const noexcept { return head_ == tail_; }
+    std::size_t size() const noexcept { return tail_ - head_; }
+
+    void append(const T& v) noexcept {
+        assert(tail_ < buf_.size() && "PendingBatch overflow");
+        buf_[tail_++] = v;
+    }
+
+    // Push as much as the queue accepts with a single try_push_n. Returns the
+    // number of events pushed.
+    template <typename Queue>
+    std::size_t flush(Queue& q) noexcept {
+        if (empty()) return 0;
+        std::size_t n = q.try_push_n(buf_.data() + head_, tail_ - head_);
+        head_ += n;
+        if (head_ == tail_) head_ = tail_ = 0;
+        return n;
+    }
+
+private:
+    std::vector<T> buf_;
+    std::size_t    head_{0};
+    std::size_t    tail_{0};
+};
+
+// ── flush_pending ─────────────────────────────────────────────────────────
+//
+// Shared tail of every batched tick(): push what is pending, account for it,
+// and translate the outcome into an OpStatus.
+//   everything pushed            -> Processed
+//   some pushed, rest still held -> Processed (progress was made; the held
+//                                   events go first on the next tick)
+//   nothing pushed               -> Blocked
+template <typename T, typename Queue>
+OpStatus flush_pending(PendingBatch<T>& pending, Queue& q,
+                       OperatorMetrics* metrics) noexcept {
+    const std::size_t pushed = pending.flush(q);
+    if (metrics && pushed) metrics->events_processed.add(pushed);
+    if (pending.empty()) return OpStatus::Processed;
+    if (metrics) metrics->events_blocked.increment();
+    return pushed ? OpStatus::Processed : OpStatus::Blocked;
+}
+
+} // namespace klstream
@@ -0,0 +1,494 @@
+// include/klstream/core/checkpoint.hpp
+#pragma once
+#include "operator.hpp"
+#include "clock.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace klstream {
+
+// ── StateWriter / StateReader ────────────────────────────────────────────
+//
+// What IOperator::snapshot() writes into and restore() reads back: a flat
+// byte buffer of trivially copyable values, in the writer's byte order.
+// The layout is the operator's own; restore() reads it back in the order
+// snapshot() wrote it.
+class StateWriter {
+public:
+    explicit StateWriter(std::vector<char>& out) noexcept : out_(out) {}
+
+    template <typename T>
+    void put(const T& v) {
+        static_assert(std::is_trivially_copyable_v<T>, "StateWriter::put needs a trivially copyable type");
+        put_bytes(&v, sizeof(T));
+    }
+
+    void put_bytes(const void* p, std::size_t n) {
+        const auto* c = static_cast<const char*>(p);
+        out_.insert(out_.end(), c, c + n);
+    }
+
+private:
+    std::vector<char>& out_;
+};
+
+class StateReader {
+public:
+    StateReader(const char* data, std::size_t size) noexcept : p_(data), end_(data + size) {}
+
+    template <typename T>
+    T get() {
+        static_assert(std::is_trivially_copyable_v<T>, "StateReader::get needs a trivially copyable type");
+        T v;
+        get_bytes(&v, sizeof(T));
+        return v;
+    }
+
+    void get_bytes(void* out, std::size_t n) {
+        if (static_cast<std::size_t>(end_ - p_) < n) throw std::runtime_error("checkpoint state truncated");
+        std::memcpy(out, p_, n);
+        p_ += n;
+    }
+
+    std::size_t remaining() const noexcept { return static_cast<std::size_t>(end_ - p_); }
+
+private:
+    const char* p_;
+    const char* end_;
+};
+
+// ── Checkpoint ───────────────────────────────────────────────────────────
+//
+// One checkpoint as read back from disk: every participating operator's
+// state, by operator name, as of the barrier — the source had emitted every
+// event with seq < barrier_seq and no later one.
+struct Checkpoint {
+    std::uint64_t epoch       = 0;
+    std::uint64_t barrier_seq = 0;
+    std::vector<std::pair<std::string, std::vector<char>>> states;
+
+    const std::vector<char>* find(const std::string& name) const {
+        for (const auto& s : states) if (s.first == name) return &s.second;
+        return nullptr;
+    }
+};
+
+class Checkpointer;
+
+// ── CheckpointPort ───────────────────────────────────────────────────────
+//
+// A participating operator's side of the checkpoint protocol, handed to it
+// by Checkpointer::add() (IOperator::attach_checkpoint). Only called from
+// the operator's own tick(), so nothing here is shared but the barrier the
+// Checkpointer publishes.
+//
+// The source calls at_source() at the top of every tick: when a checkpoint
+// has been requested it snapshots itself there, between two events, and
+// publishes the barrier — the seq its next event will be stamped at or
+// above — before it pushes that event. Every other participant calls
+// arrive() after each pop attempt, before applying what it popped (one
+// acquire load): it snapshots once it has applied every event below the
+// barrier. The queues order the barrier before any event past it, so
+// nothing past it can be applied first.
+class CheckpointPort {
+public:
+    static constexpr std::uint64_t NONE = std::numeric_limits<std::uint64_t>::max();
+
+    CheckpointPort(Checkpointer* owner, IOperator* op, std::size_t slot) noexcept
+        : owner_(owner), op_(op), slot_(slot) {}
+
+    // Source: `next_seq` is one past the seq of the last event generated
+    // (0 before the first). Generated but unpushed events are before it.
+    inline void at_source(std::uint64_t next_seq);
+
+    // Everyone else: after every pop attempt; `seq` is the popped event's.
+    inline void arrive(std::uint64_t seq);
+    inline void arrive() { arrive(NONE); }
+
+    // The source calls this from its attach_checkpoint().
+    inline void become_source();
+
+    IOperator*  op() const noexcept { return op_; }
+    std::size_t slot() const noexcept { return slot_; }
+
+private:
+    friend class Checkpointer;
+
+    inline void take(std::uint64_t epoch);
+
+    Checkpointer* owner_;
+    IOperator*    op_;
+    std::size_t   slot_;
+    std::uint64_t done_{0};       // last epoch this operator delivered
+    std::uint64_t applied_{0};    // every event with seq < applied_ has been applied
+    std::vector<char> buf_[2];    // epoch & 1: filled here, written by the writer thread
+};
+
+// ── Checkpointer ─────────────────────────────────────────────────────────
+//
+// Barrier-aligned, asynchronous checkpoints of a pipeline's operator state
+// (AggregateOperator's running state, a window op's partial window and
+// controller, the replay position of the source) for a restart that picks
+// up where the last checkpoint left off instead of replaying the day.
+//
+//   Checkpointer ckpt("checkpoints");
+//   ckpt.add(&source); ckpt.add(&window);      // before the runtime starts
+//   rt.start();
+//   ... ckpt.request();                        // any thread, e.g. a timer
+//
+// After a restart, build the same pipeline, then before starting it:
+//
+//   if (auto c = Checkpointer::load_latest("checkpoints")) ckpt.restore(*c);
+//
+// and the source resumes at the barrier: recovery is the load plus a
+// replay of whatever followed the barrier.
+//
+// The hot path never waits. Each participant copies its state into one of
+// two per-operator buffers on its own thread when it reaches the barrier
+// (CheckpointPort); nothing runs stop-the-world, and the only cost between
+// checkpoints is the barrier load per pop. Once every participant has
+// delivered, a writer thread writes the file — to a temporary name, then
+// renamed into place, so a crash mid-write leaves the previous checkpoint —
+// and keeps the newest `keep`. One checkpoint aligns at a time; request()
+// refuses while one is aligning or two wait on the disk.
+//
+// Requirements and limits:
+//   - one source, stamping strictly increasing Event::seq (the barrier is
+//     a seq); every participant's input carries the source's seqs, as
+//     every single-input operator here forwards them
+//   - a participant aligns on the first event it sees at or past the
+//     barrier, or as soon as it has applied the one just below it; one
+//     behind a Filter that dropped the tail of the stream waits for the
+//     next event
+//   - operators without state (inference, sinks) are not added; events in
+//     flight between participants need no saving, since the downstream
+//     side applies them before it aligns. A sink may therefore repeat the
+//     results between the checkpoint and the crash after a restart.
+class Checkpointer {
+public:
+    static constexpr char          MAGIC[4] = { 'K', 'L', 'C', 'K' };
+    static constexpr std::uint32_t VERSION  = 1;
+    static constexpr std::size_t   DEFAULT_KEEP = 2;
+
+    struct Stats {
+        std::uint64_t requested     = 0;
+        std::uint64_t refused       = 0;   // request() while one was in flight
+        std::uint64_t written       = 0;
+        std::uint64_t last_bytes    = 0;   // state in the last file written
+        std::uint64_t last_align_ns = 0;   // request() to the last participant's snapshot
+        std::uint64_t last_write_ns = 0;   // writing + renaming the file
+    };
+
+    explicit Checkpointer(std::string dir, std::size_t keep = DEFAULT_KEEP)
+        : dir_(std::move(dir)), keep_(keep < 1 ? 1 : keep)
+    {
+        std::filesystem::create_directories(dir_);
+        writer_ = std::thread([this] { write_loop(); });
+    }
+
+    ~Checkpointer() {
+        {
+            std::lock_guard<std::mutex> lk(mu_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        if (writer_.joinable()) writer_.join();
+    }
+
+    Checkpointer(const Checkpointer&)            = delete;
+    Checkpointer& operator=(const Checkpointer&) = delete;
+
+    // Before the runtime starts. Names must be unique: a checkpoint is
+    // restored by name. Throws std::logic_error for an operator without
+    // checkpointable state.
+    void add(IOperator* op) {
+        for (const auto& p : ports_) {
+            if (p.op()->name() == op->name()) throw std::logic_error("Checkpointer: duplicate operator name " + op->name());
+        }
+        ports_.emplace_back(this, op, ports_.size());
+        if (!op->attach_checkpoint(&ports_.back())) {
+            ports_.pop_back();
+            throw std::logic_error("Checkpointer: operator " + op->name() + " has no checkpointable state");
+        }
+    }
+
+    // Starts a checkpoint; any thread. False (and counted) if the previous
+    // one is still aligning, or the disk is two behind.
+    bool request() {
+        std::lock_guard<std::mutex> lk(mu_);
+        if (!source_ || aligned_ < epoch_ || epoch_ > written_ + 1) {
+            ++stats_.refused;
+            return false;
+        }
+        ++epoch_;
+        delivered_ = 0;
+        requested_ns_ = Clock::now_ns();
+        ++stats_.requested;
+        requested_.store(epoch_, std::memory_order_release);
+        return true;
+    }
+
+    // Blocks until checkpoint `epoch` is on disk, or the timeout.
+    bool wait_written(std::uint64_t epoch, std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lk(mu_);
+        return cv_.wait_for(lk, timeout, [&] { return written_ >= epoch || !error_.empty(); }) && written_ >= epoch;
+    }
+
+    // The epoch of the last request() that was accepted.
+    std::uint64_t epoch() const {
+        std::lock_guard<std::mutex> lk(mu_);
+        return epoch_;
+    }
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> lk(mu_);
+        return stats_;
+    }
+
+    // Set if the writer thread failed; no further checkpoint is written.
+    std::string error() const {
+        std::lock_guard<std::mutex> lk(mu_);
+        return error_;
+    }
+
+    const std::string& dir() const noexcept { return dir_; }
+
+    // File of checkpoint `epoch` in `dir`; zero-padded, so names sort by epoch.
+    static std::string path_of(const std::string& dir, std::uint64_t epoch) {
+        char name[40];
+        std::snprintf(name, sizeof(name), "checkpoint-%012llu.klck", static_cast<unsigned long long>(epoch));
+        return (std::filesystem::path(dir) / name).string();
+    }
+
+    // The newest checkpoint in `dir`, if any. A file that fails to load
+    // (not a checkpoint, truncated) is skipped for the one before it.
+    static std::optional<Checkpoint> load_latest(const std::string& dir) {
+        std::vector<std::string> files = list(dir);
+        for (auto it = files.rbegin(); it != files.rend(); ++it) {
+            try {
+                return load(*it);
+            } catch (const std::exception&) {
+            }
+        }
+        return std::nullopt;
+    }
+
+    static Checkpoint load(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) throw std::runtime_error("Checkpointer: cannot open " + path);
+        std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        StateReader r(bytes.data(), bytes.size());
+        char magic[4];
+        r.get_bytes(magic, sizeof(magic));
+        if (std::memcmp(magic, MAGIC, sizeof(magic)) != 0) throw std::runtime_error("Checkpointer: not a checkpoint: " + path);
+        if (r.get<std::uint32_t>() != VERSION) throw std::runtime_error("Checkpointer: unsupported version: " + path);
+        Checkpoint c;
+        c.epoch       = r.get<std::uint64_t>();
+        c.barrier_seq = r.get<std::uint64_t>();
+        const auto n  = r.get<std::uint32_t>();
+        for (std::uint32_t i = 0; i < n; ++i) {
+            std::string name(r.get<std::uint32_t>(), '\0');
+            r.get_bytes(name.data(), name.size());
+            std::vector<char> state(r.get<std::uint64_t>());
+            r.get_bytes(state.data(), state.size());
+            c.states.emplace_back(std::move(name), std::move(state));
+        }
+        if (r.remaining() != 0) throw std::runtime_error("Checkpointer: trailing bytes in " + path);
+        return c;
+    }
+
+    // Before the runtime starts, after add() and after whatever the
+    // operators' restore() needs (a window op's attach_pool()). Throws
+    // std::runtime_error if a participant has no state in `c`. Later
+    // checkpoints continue from c.epoch.
+    void restore(const Checkpoint& c) {
+        for (auto& p : ports_) {
+            const std::vector<char>* s = c.find(p.op()->name());
+            if (!s) throw std::runtime_error("Checkpointer: no state for " + p.op()->name() + " in the checkpoint");
+            StateReader r(s->data(), s->size());
+            p.op()->restore(r);
+            if (r.remaining() != 0) throw std::runtime_error("Checkpointer: state of " + p.op()->name() + " not fully read");
+            p.applied_ = c.barrier_seq;
+            p.done_    = c.epoch;
+        }
+        std::lock_guard<std::mutex> lk(mu_);
+        epoch_ = aligned_ = written_ = c.epoch;
+        requested_.store(c.epoch, std::memory_order_relaxed);
+        barrier_epoch_.store(c.epoch, std::memory_order_relaxed);
+    }
+
+private:
+    friend class CheckpointPort;
+
+    static std::vector<std::string> list(const std::string& dir) {
+        std::vector<std::string> files;
+        std::error_code ec;
+        for (const auto& e : std::filesystem::directory_iterator(dir, ec)) {
+            const std::string name = e.path().filename().string();
+            if (name.rfind("checkpoint-", 0) == 0 && e.path().extension() == ".klck") files.push_back(e.path().string());
+        }
+        std::sort(files.begin(), files.end());
+        return files;
+    }
+
+    void claim_source() {
+        if (source_) throw std::logic_error("Checkpointer: more than one source");
+        source_ = true;
+    }
+
+    void publish(std::uint64_t epoch, std::uint64_t barrier_seq) noexcept {
+        barrier_seq_.store(barrier_seq, std::memory_order_relaxed);
+        barrier_epoch_.store(epoch, std::memory_order_release);
+    }
+
+    void deliver() {
+        bool complete;
+        {
+            std::lock_guard<std::mutex> lk(mu_);
+            complete = ++delivered_ == ports_.size();
+            if (complete) {
+                stats_.last_align_ns = Clock::now_ns() - requested_ns_;
+                aligned_ = epoch_;
+                aligned_seq_ = barrier_seq_.load(std::memory_order_relaxed);
+            }
+        }
+        if (complete) cv_.notify_all();
+    }
+
+    void write_loop() {
+        std::unique_lock<std::mutex> lk(mu_);
+        for (;;) {
+            cv_.wait(lk, [&] { return stop_ || aligned_ > written_; });
+            if (aligned_ <= written_) return;   // stopping, nothing left to write
+            const std::uint64_t epoch = aligned_;
+            const std::uint64_t seq   = aligned_seq_;
+            lk.unlock();
+            // The buffers of `epoch` stay put until it is written: request()
+            // refuses the epoch that would reuse them.
+            std::string err;
+            const std::uint64_t t0 = Clock::now_ns();
+            std::uint64_t bytes = 0;
+            try {
+                bytes = write(epoch, seq);
+            } catch (const std::exception& e) {
+                err = e.what();
+            }
+            const std::uint64_t t1 = Clock::now_ns();
+            lk.lock();
+            if (!err.empty()) error_ = err;
+            written_ = epoch;
+            if (err.empty()) {
+                ++stats_.written;
+                stats_.last_bytes    = bytes;
+                stats_.last_write_ns = t1 - t0;
+            }
+            cv_.notify_all();
+        }
+    }
+
+    std::uint64_t write(std::uint64_t epoch, std::uint64_t seq) {
+        const std::string path = path_of(dir_, epoch);
+        const std::string tmp  = path + ".tmp";
+        std::uint64_t bytes = 0;
+        {
+            std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+            if (!out) throw std::runtime_error("Checkpointer: cannot write " + tmp);
+            std::vector<char> head;
+            StateWriter w(head);
+            w.put_bytes(MAGIC, sizeof(MAGIC));
+            w.put(VERSION);
+            w.put(epoch);
+            w.put(seq);
+            w.put(static_cast<std::uint32_t>(ports_.size()));
+            out.write(head.data(), static_cast<std::streamsize>(head.size()));
+            for (const auto& p : ports_) {
+                const std::vector<char>& s = p.buf_[epoch & 1];
+                const std::string& name = p.op()->name();
+                const auto name_len  = static_cast<std::uint32_t>(name.size());
+                const auto state_len = static_cast<std::uint64_t>(s.size());
+                out.write(reinterpret_cast<const char*>(&name_len), sizeof(name_len));
+                out.write(name.data(), static_cast<std::streamsize>(name.size()));
+                out.write(reinterpret_cast<const char*>(&state_len), sizeof(state_len));
+                out.write(s.data(), static_cast<std::streamsize>(s.size()));
+                bytes += s.size();
+            }
+            out.flush();
+            if (!out) throw std::runtime_error("Checkpointer: write failed: " + tmp);
+        }
+        std::filesystem::rename(tmp, path);
+        std::vector<std::string> files = list(dir_);
+        for (std::size_t i = 0; i + keep_ < files.size(); ++i) std::filesystem::remove(files[i]);
+        return bytes;
+    }
+
+    std::string                 dir_;
+    std::size_t                 keep_;
+    std::deque<CheckpointPort>  ports_;   // stable addresses
+    bool                        source_{false};
+
+    std::atomic<std::uint64_t>  requested_{0};       // source side: epoch asked for
+    std::atomic<std::uint64_t>  barrier_epoch_{0};   // epoch whose barrier is out
+    std::atomic<std::uint64_t>  barrier_seq_{0};
+
+    mutable std::mutex          mu_;
+    std::condition_variable     cv_;
+    std::uint64_t               epoch_{0};       // last accepted request
+    std::size_t                 delivered_{0};   // participants done with epoch_
+    std::uint64_t               aligned_{0};     // last epoch every participant delivered
+    std::uint64_t               aligned_seq_{0};
+    std::uint64_t               written_{0};     // last epoch on disk (or failed)
+    std::uint64_t               requested_ns_{0};
+    Stats                       stats_;
+    std::string                 error_;
+    bool                        stop_{false};
+    std::thread                 writer_;
+};
+
+// ── CheckpointPort (inline) ──────────────────────────────────────────────
+
+inline void CheckpointPort::become_source() { owner_->claim_source(); }
+
+inline void CheckpointPort::take(std::uint64_t epoch) {
+    std::vector<char>& buf = buf_[epoch & 1];
+    buf.clear();   // keeps its capacity: no allocation after the first checkpoint
+    StateWriter w(buf);
+    op_->snapshot(w);
+    done_ = epoch;
+    owner_->deliver();
+}
+
+inline void CheckpointPort::at_source(std::uint64_t next_seq) {
+    const std::uint64_t e = owner_->requested_.load(std::memory_order_acquire);
+    if (e == done_) return;
+    owner_->publish(e, next_seq);
+    take(e);
+}
+
+inline void CheckpointPort::arrive(std::uint64_t seq) {
+    const std::uint64_t e = owner_->barrier_epoch_.load(std::memory_order_acquire);
+    if (e != done_) {
+        const std::uint64_t barrier = owner_->barrier_seq_.load(std::memory_order_relaxed);
+        if (applied_ >= barrier || (seq != NONE && seq >= barrier)) take(e);
+    }
+    if (seq != NONE) applied_ = seq + 1;
+}
+
+} // namespace klstream
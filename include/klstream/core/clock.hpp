@@ -0,0 +1,248 @@
+// include/klstream/core/clock.hpp
+#pragma once
+#include <chrono>
+#include <cstdint>
+
+#if defined(__linux__)
+#  include <ctime>
+#  define KLSTREAM_HAS_COARSE_CLOCK 1
+#endif
+
+// KLSTREAM_TSC_CLOCK (CMake option, default ON) selects the cycle counter
+// as the clock source where the architecture has a usable one.
+#if defined(KLSTREAM_TSC_CLOCK) && KLSTREAM_TSC_CLOCK
+#  if defined(__x86_64__) || defined(__i386__)
+#    include <cpuid.h>
+#    include <x86intrin.h>
+#    define KLSTREAM_HAS_TSC 1
+#  elif defined(__aarch64__)
+#    define KLSTREAM_HAS_TSC 1
+#  endif
+#endif
+
+// KLSTREAM_VIRTUAL_CLOCK (a compile definition, off by default) replaces
+// both clocks with a per-thread virtual time the caller sets — for the
+// deterministic harness (virtual_time.hpp), not for anything that runs
+// against a wall clock.
+
+namespace klstream {
+
+// ── Clock ─────────────────────────────────────────────────────────────────
+//
+// The one clock behind event stamping (Event::make) and latency recording
+// (Event::latency_ns), processing-time windows and the operators' overhead
+// timers. All of them read it at least once per event or per tick, where
+// std::chrono::steady_clock::now() costs a vDSO call of 20–40 ns.
+//
+//   now_ns()    — nanoseconds on the steady_clock timeline. With
+//                 KLSTREAM_TSC_CLOCK it is computed from the cycle counter
+//                 (x86 rdtsc, ARM cntvct_el0): one instruction, a subtract
+//                 and a fixed-point multiply.
+//   coarse_ns() — the same timeline at scheduler-tick resolution (1–10 ms,
+//                 CLOCK_MONOTONIC_COARSE on Linux) for callers that only
+//                 need elapsed time on that scale — TokenBucketRateLimiter.
+//                 Falls back to now_ns() elsewhere. coarse_resolution_ns()
+//                 says how far apart its steps are.
+//
+// Calibration happens once, on the first call: the counter is sampled
+// either side of a 10 ms window of steady_clock, giving a ns-per-tick ratio
+// good to a few ppm and an anchor so that now_ns() and steady_clock agree
+// (values can be mixed and subtracted). Each end is the narrowest of
+// ANCHOR_TRIES counter/steady_clock pairs, so one preempted read cannot
+// skew the ratio, and a window whose ends still bound it to worse than
+// MAX_ANCHOR_PPM is taken again. On x86 the TSC is only used when
+// CPUID reports it invariant — constant rate across P-states, running in
+// C-states, synchronised across cores; otherwise, and on other
+// architectures, now_ns() is steady_clock itself. source() says which.
+//
+// Built with KLSTREAM_VIRTUAL_CLOCK, now_ns() and coarse_ns() return the
+// calling thread's virtual time instead, which only set_virtual_ns() moves:
+// a thread that never sets it sees 0.
+class Clock {
+public:
+    static std::uint64_t now_ns() noexcept {
+#if defined(KLSTREAM_VIRTUAL_CLOCK) && KLSTREAM_VIRTUAL_CLOCK
+        return virtual_ns();
+#elif defined(KLSTREAM_HAS_TSC)
+        const Calibration& c = calibration();
+        if (c.tsc) {
+            const std::uint64_t t = ticks();
+            const std::uint64_t d = t > c.base_ticks ? t - c.base_ticks : 0;
+            return c.base_ns + mul_shift(d, c.mult);
+        }
+#endif
+        return steady_ns();
+    }
+
+    static std::uint64_t coarse_ns() noexcept {
+#if defined(KLSTREAM_VIRTUAL_CLOCK) && KLSTREAM_VIRTUAL_CLOCK
+        return virtual_ns();
+#elif defined(KLSTREAM_HAS_COARSE_CLOCK)
+        timespec ts;
+        ::clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+        return static_cast<std::uint64_t>(ts.tv_sec) * 1'000'000'000ULL
+             + static_cast<std::uint64_t>(ts.tv_nsec);
+#else
+        return now_ns();
+#endif
+    }
+
+    // The step of coarse_ns() (clock_getres), or 0 where it is now_ns() or
+    // virtual time.
+    static std::uint64_t coarse_resolution_ns() noexcept {
+#if defined(KLSTREAM_VIRTUAL_CLOCK) && KLSTREAM_VIRTUAL_CLOCK
+        return 0;
+#elif defined(KLSTREAM_HAS_COARSE_CLOCK)
+        static const std::uint64_t res = []() -> std::uint64_t {
+            timespec ts;
+            if (::clock_getres(CLOCK_MONOTONIC_COARSE, &ts) != 0) return 0;
+            return static_cast<std::uint64_t>(ts.tv_sec) * 1'000'000'000ULL
+                 + static_cast<std::uint64_t>(ts.tv_nsec);
+        }();
+        return res;
+#else
+        return 0;
+#endif
+    }
+
+#if defined(KLSTREAM_VIRTUAL_CLOCK) && KLSTREAM_VIRTUAL_CLOCK
+    static void set_virtual_ns(std::uint64_t ns) noexcept { virtual_ns() = ns; }
+#endif
+
+    // "tsc", "steady_clock" or "virtual" — for benchmark and metrics headers.
+    static const char* source() noexcept {
+#if defined(KLSTREAM_VIRTUAL_CLOCK) && KLSTREAM_VIRTUAL_CLOCK
+        return "virtual";
+#endif
+#if defined(KLSTREAM_HAS_TSC)
+        if (calibration().tsc) return "tsc";
+#endif
+        return "steady_clock";
+    }
+
+    // Counter ticks per second, or 0 when now_ns() is steady_clock.
+    static double tick_hz() noexcept {
+#if defined(KLSTREAM_HAS_TSC)
+        const Calibration& c = calibration();
+        if (c.tsc) return 1e9 * 4294967296.0 / static_cast<double>(c.mult);
+#endif
+        return 0.0;
+    }
+
+private:
+#if defined(KLSTREAM_VIRTUAL_CLOCK) && KLSTREAM_VIRTUAL_CLOCK
+    static std::uint64_t& virtual_ns() noexcept {
+        thread_local std::uint64_t ns = 0;
+        return ns;
+    }
+#endif
+
+    static std::uint64_t steady_ns() noexcept {
+        using namespace std::chrono;
+        return static_cast<std::uint64_t>(
+            duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+    }
+
+#if defined(KLSTREAM_HAS_TSC)
+    struct Calibration {
+        bool          tsc{false};
+        std::uint64_t base_ticks{0};
+        std::uint64_t base_ns{0};
+        std::uint64_t mult{0};        // ns per tick, 32.32 fixed point
+    };
+
+    static std::uint64_t ticks() noexcept {
+#  if defined(__aarch64__)
+        std::uint64_t v;
+        __asm__ volatile("mrs %0, cntvct_el0" : "=r"(v));
+        return v;
+#  else
+        return __rdtsc();
+#  endif
+    }
+
+    // (d * mult) >> 32 without overflow for any d.
+    static std::uint64_t mul_shift(std::uint64_t d, std::uint64_t mult) noexcept {
+        __extension__ typedef unsigned __int128 u128;
+        return static_cast<std::uint64_t>((static_cast<u128>(d) * mult) >> 32);
+    }
+
+    static bool invariant_counter() noexcept {
+#  if defined(__aarch64__)
+        return true;                  // the generic timer is architecturally fixed-rate
+#  else
+        unsigned a = 0, b = 0, c = 0, d = 0;
+        if (__get_cpuid(0x80000000u, &a, &b, &c, &d) == 0 || a < 0x80000007u) return false;
+        __get_cpuid(0x80000007u, &a, &b, &c, &d);
+        return (d & (1u << 8)) != 0;  // CPUID.80000007H:EDX[8] — invariant TSC
+#  endif
+    }
+
+    static constexpr int           ANCHOR_TRIES       = 16;
+    static constexpr int           CALIBRATION_ROUNDS = 4;
+    static constexpr std::uint64_t MAX_ANCHOR_PPM     = 10;
+
+    // steady_clock sampled between two counter reads; the midpoint is the
+    // counter value that goes with it. Keeps the narrowest of ANCHOR_TRIES
+    // pairs (a preempted one is simply outbid) and returns its width in ticks.
+    static std::uint64_t anchor(std::uint64_t& tk, std::uint64_t& ns) noexcept {
+        std::uint64_t best = ~0ULL;
+        for (int i = 0; i < ANCHOR_TRIES; ++i) {
+            const std::uint64_t t0 = ticks();
+            const std::uint64_t n  = steady_ns();
+            const std::uint64_t t1 = ticks();
+            if (t1 - t0 < best) {
+                best = t1 - t0;
+                tk   = t0 + best / 2;
+                ns   = n;
+            }
+        }
+        return best;
+    }
+
+    static Calibration calibrate() noexcept {
+        Calibration c;
+        if (!invariant_counter()) return c;
+        std::uint64_t t0 = 0, n0 = 0, t1 = 0, n1 = 0;
+#  if defined(__aarch64__)
+        anchor(t0, n0);
+        std::uint64_t hz;
+        __asm__ volatile("mrs %0, cntfrq_el0" : "=r"(hz));
+        t1 = t0 + hz;
+        n1 = n0 + 1'000'000'000ULL;
+#  else
+        // Each anchor is off by at most half its width, so the ratio is off
+        // by (w0 + w1) / 2 over the window. Retake a window worse than
+        // MAX_ANCHOR_PPM; if none is better, keep the best one seen.
+        double best_err = 1.0;
+        for (int round = 0; round < CALIBRATION_ROUNDS; ++round) {
+            std::uint64_t a0 = 0, m0 = 0, a1 = 0, m1 = 0;
+            const std::uint64_t w0 = anchor(a0, m0);
+            std::uint64_t w1;
+            do { w1 = anchor(a1, m1); } while (m1 - m0 < 10'000'000ULL);
+            if (a1 <= a0) continue;
+            const double err = static_cast<double>(w0 + w1) / (2.0 * static_cast<double>(a1 - a0));
+            if (err < best_err) {
+                best_err = err;
+                t0 = a0; n0 = m0; t1 = a1; n1 = m1;
+            }
+            if (err * 1e6 <= static_cast<double>(MAX_ANCHOR_PPM)) break;
+        }
+#  endif
+        if (t1 <= t0) return c;
+        c.tsc        = true;
+        c.base_ticks = t0;
+        c.base_ns    = n0;
+        c.mult       = static_cast<std::uint64_t>(
+            (static_cast<long double>(n1 - n0) * 4294967296.0L) / static_cast<long double>(t1 - t0));
+        return c;
+    }
+
+    static const Calibration& calibration() noexcept {
+        static const Calibration c = calibrate();
+        return c;
+    }
+#endif
+};
+
+} // namespace klstream
@@ -24,11 +24,28 @@ namespace klstream {
 // 4096 events × sizeof(Event<uint64_t>) = ~64 KB per queue — fits in L2 cache.
 inline constexpr std::size_t DEFAULT_QUEUE_CAPACITY = 4096;
 
+// ── Batching ──────────────────────────────────────────────────────────────
+// Upper bound on how many events an operator moves per tick() when batch mode
+// is enabled via set_batch_size(). 32 × sizeof(Event<uint64_t>) (40 bytes)
+// = 1.25 KB of staging per operator — small enough to stay in L1 alongside
+// the operator's own state, large enough to amortise the per-tick virtual
+// call and index publication.
+inline constexpr std::size_t DEFAULT_BATCH_SIZE = 32;
+
 // ── Backpressure thresholds ────────────────────────────────────────────────
 // Soft threshold: when EMA occupancy fraction exceeds this, start throttling.
 inline constexpr double BP_SOFT_THRESHOLD = 0.70;
 // Hard threshold: when instantaneous occupancy exceeds this, block immediately.
 inline constexpr double BP_HARD_THRESHOLD = 0.95;
+// AimdRateController: below this EMA occupancy the target rate grows again.
+inline constexpr double BP_LOW_THRESHOLD = 0.30;
+// AimdRateController: how often the watched queues are sampled and the
+// target rate adjusted (bounded below by Clock::coarse_ns() resolution).
+inline constexpr std::uint64_t BP_CONTROL_INTERVAL_NS = 1'000'000;
+// AIMD steps: additive increase of this fraction of the maximum rate per
+// interval, multiplicative decrease by this factor.
+inline constexpr double BP_INCREASE_FRACTION = 0.05;
+inline constexpr double BP_DECREASE_FACTOR   = 0.5;
 
 // ── Worker backoff parameters ──────────────────────────────────────────────
 // How many ARM `yield` spins before escalating to std::this_thread::yield().
@@ -37,15 +54,32 @@ inline constexpr int SPIN_BEFORE_YIELD = 64;
 inline constexpr int YIELD_BEFORE_SLEEP = 32;
 // Sleep duration in nanoseconds when all operators are Idle.
 inline constexpr int SLEEP_NS = 100;
+// IdleStrategy::Park: longest a parked worker sleeps without a wake-up
+// (covers operators whose readiness changes without a queue push).
+inline constexpr std::int64_t PARK_TIMEOUT_NS = 1'000'000;
 
 // ── Metrics ───────────────────────────────────────────────────────────────
 // Reporting interval in seconds for the metrics printer.
 inline constexpr int METRICS_INTERVAL_SEC = 1;
 
+// Hardware counters (core/perf_counters.hpp): a profiled operator has one
+// tick in PERF_SAMPLE_EVERY wrapped in two counter reads (~1 µs each).
+inline constexpr std::uint32_t PERF_SAMPLE_EVERY = 16;
+
+// ── Rebalancing ───────────────────────────────────────────────────────────
+// With rebalancing on (Runtime::set_rebalancing), a worker times one tick in
+// LOAD_SAMPLE_EVERY of each operator (two clock reads) to estimate its busy
+// time, and the rebalancer compares workers every REBALANCE_INTERVAL_NS.
+inline constexpr std::uint32_t LOAD_SAMPLE_EVERY     = 16;
+inline constexpr std::uint64_t REBALANCE_INTERVAL_NS = 100'000'000;
+
 // ── Latency histogram ─────────────────────────────────────────────────────
-// Number of buckets. Each bucket covers 1 microsecond up to MAX_LATENCY_US,
-// then a final overflow bucket.
-inline constexpr std::size_t HISTOGRAM_BUCKETS = 10000;
-inline constexpr std::size_t MAX_LATENCY_US    = 10000; // 10 ms
+// Log-linear buckets (core/histogram.hpp): 2^PRECISION_BITS per power of
+// two, so any recorded value is off by at most 1 / 2^PRECISION_BITS
+// (6 bits -> 1.6%). Values up to 2^(MAX_EXPONENT + 1) ns (~2.4 hours) are
+// resolved; larger ones land in the last bucket. 6 bits = 2432 buckets,
+// 19 KB per histogram.
+inline constexpr unsigned HISTOGRAM_PRECISION_BITS = 6;
+inline constexpr unsigned HISTOGRAM_MAX_EXPONENT   = 42;
 
 } // namespace klstream
@@ -1,8 +1,9 @@
 // include/klstream/core/event.hpp
 #pragma once
 #include "config.hpp"
+#include "clock.hpp"
 #include <cstdint>
-#include <chrono>
+#include <utility>
 
 namespace klstream {
 
@@ -13,7 +14,7 @@ namespace klstream {
 // expects Event<uint64_t>.
 //
 // Design notes:
-//   * timestamp_ns: set by the source at creation time using a monotonic clock.
+//   * timestamp_ns: set by the source at creation time from Clock::now_ns().
 //     Used to compute end-to-end latency at the sink. Never modified by
 //     intermediate operators.
 //   * key: for keyed streams (e.g., consistent-hashing placement, Section 14.3).
@@ -21,39 +22,46 @@ namespace klstream {
 //     (Aggregate, Window) use it to group events.
 //   * seq: monotonically increasing sequence number set by the source. Used in
 //     tests to verify ordering is preserved within a single queue.
+//   * event_ts_ns: when the event happened, in the source's own clock — the
+//     exchange timestamp of a replayed tick, say. make() sets it to
+//     timestamp_ns (event time == arrival time); make_at() sets it
+//     explicitly. Forwarded by every operator; count windows stamp their
+//     output with the event time of the event that closed them. Event-time
+//     windows (event_time_window.hpp) group by it, so their results do not
+//     depend on replay speed.
 //   * data: the user-defined payload. Must be trivially copyable for lock-free
 //     queue correctness (no internal pointers, no vtable, no reference counting).
 //
 // Alignment: alignas(CACHE_LINE_SIZE) would waste space for small payloads.
 // We leave the struct naturally aligned and rely on the queue's own ring
 // buffer being cache-line aligned. The struct should be kept small (<=64 bytes
-// including the three metadata fields) so it fits in one or two cache lines.
+// including the four metadata fields) so it fits in one or two cache lines.
 template <typename Payload>
 struct Event {
     std::uint64_t timestamp_ns;  // nanoseconds since epoch (monotonic)
     std::uint64_t key;           // routing / grouping key
     std::uint64_t seq;           // sequence number (set by source, monotonic)
+    std::uint64_t event_ts_ns;   // event time (set by source; see above)
     Payload       data;          // user payload — must be trivially copyable
 
     // ── Factory helpers ───────────────────────────────────────────────────
     static Event make(Payload d, std::uint64_t k = 0, std::uint64_t s = 0) {
-        using namespace std::chrono;
-        auto now_ns = static_cast<std::uint64_t>(
-            duration_cast<nanoseconds>(
-                steady_clock::now().time_since_epoch()
-            ).count()
-        );
-        return Event{ now_ns, k, s, std::move(d) };
+        const std::uint64_t now_ns = Clock::now_ns();
+        return Event{ now_ns, k, s, now_ns, std::move(d) };
+    }
+
+    // make() for an event that happened at `event_ts_ns` (replayed or
+    // device-timestamped data); timestamp_ns is still the arrival time.
+    static Event make_at(Payload d, std::uint64_t event_ts_ns,
+                         std::uint64_t k = 0, std::uint64_t s = 0) {
+        Event ev = make(std::move(d), k, s);
+        ev.event_ts_ns = event_ts_ns;
+        return ev;
     }
 
     // Elapsed nanoseconds since this event was created (call at the sink).
     std::uint64_t latency_ns() const {
-        using namespace std::chrono;
-        auto now_ns = static_cast<std::uint64_t>(
-            duration_cast<nanoseconds>(
-                steady_clock::now().time_since_epoch()
-            ).count()
-        );
+        const std::uint64_t now_ns = Clock::now_ns();
         return (now_ns >= timestamp_ns) ? (now_ns - timestamp_ns) : 0;
     }
 };
@@ -0,0 +1,90 @@
+// include/klstream/core/fusion.hpp
+#pragma once
+#include "operator.hpp"
+#include "event.hpp"
+#include "spsc_queue.hpp"
+#include <cstddef>
+
+namespace klstream {
+
+// ── Operator fusion ──────────────────────────────────────────────────────
+//
+// Two operators on the same worker linked by an SPSCQueue pay for that queue
+// on every event: a copy into the ring, a copy out, the index publication,
+// and a second pending/Blocked bookkeeping pass. Fusion removes the hop. The
+// upstream operator hands each output event by reference straight to the
+// downstream operator's offer(), which runs its per-event logic inline and
+// pushes the result to its own output (or offers it on again). The fused
+// downstream operator is then no longer ticked; the queue between them is
+// left untouched.
+//
+//   source ──q1──▶ filter ──q2──▶ map ──q3──▶ ...
+//   source ─offer▶ filter ─offer▶ map ──q3──▶ ...      (after fusion)
+//
+// Only stateless 1-to-at-most-1 operators (Filter, Map) can be fused into
+// an upstream: offer() is all-or-nothing, and when the end of the chain is
+// full it returns false having kept nothing. The upstream keeps the event in
+// its own pending slot and offers it again later, which re-runs the
+// downstream predicate/function on it, so those must be pure.
+//
+// Runtime::set_operator_fusion(true) fuses every eligible pair registered on
+// the same worker at start(); IOperator::fuse_downstream() does it by hand.
+
+// ── EventConsumer<T> ─────────────────────────────────────────────────────
+//
+// The downstream half: an operator that can take an Event<T> directly,
+// as if it had popped it from fused_input().
+template <typename T>
+class EventConsumer {
+public:
+    virtual ~EventConsumer() = default;
+
+    // Process `ev` completely, or return false and keep nothing.
+    virtual bool offer(const Event<T>& ev) = 0;
+
+    // The queue offer() stands in for — the upstream's output queue.
+    virtual const SPSCQueue<Event<T>>* fused_input() const noexcept = 0;
+};
+
+// ── FusedOutput<T> ───────────────────────────────────────────────────────
+//
+// The upstream half: an operator's output, which is its output queue until
+// fuse() links it to the consumer of that queue. Has the try_push /
+// try_push_n shape of the queue, so PendingBatch::flush and flush_pending
+// work on it unchanged.
+template <typename T>
+class FusedOutput {
+public:
+    using Queue = SPSCQueue<Event<T>>;
+
+    explicit FusedOutput(Queue* q) noexcept : queue_(q) {}
+
+    bool try_push(const Event<T>& ev) {
+        return next_ ? next_->offer(ev) : queue_->try_push(ev);
+    }
+
+    std::size_t try_push_n(const Event<T>* evs, std::size_t n) {
+        if (!next_) return queue_->try_push_n(evs, n);
+        std::size_t i = 0;
+        while (i < n && next_->offer(evs[i])) ++i;
+        return i;
+    }
+
+    // Links to `downstream` if it is an EventConsumer<T> reading this
+    // output's queue. Returns false (and changes nothing) otherwise.
+    bool fuse(IOperator* downstream) {
+        auto* c = dynamic_cast<EventConsumer<T>*>(downstream);
+        if (next_ || !c || c->fused_input() != queue_) return false;
+        next_ = c;
+        return true;
+    }
+
+    bool   fused() const noexcept { return next_ != nullptr; }
+    Queue* queue() const noexcept { return queue_; }
+
+private:
+    Queue*            queue_;
+    EventConsumer<T>* next_{nullptr};
+};
+
+} // namespace klstream
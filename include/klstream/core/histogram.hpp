@@ -0,0 +1,242 @@
+// include/klstream/core/histogram.hpp
+#pragma once
+#include "config.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace klstream {
+
+// ── HistogramLayout ───────────────────────────────────────────────────────
+//
+// HDR-style log-linear bucketing of nanosecond values. With P precision
+// bits and S = 2^P:
+//
+//   [0, 2S)            one bucket per value (exact)
+//   [2^e, 2^(e+1))     S buckets of width 2^(e-P), for P <= e <= MAX_EXPONENT
+//
+// so a bucket's width is at most 1/S of the values in it: every recorded
+// value is known to within 2^-P relative error, from 1 ns to hours, in
+// (MAX_EXPONENT - P + 2) * S buckets. index_of() is a count-leading-zeros,
+// a shift and an add.
+struct HistogramLayout {
+    unsigned precision_bits;
+
+    explicit HistogramLayout(unsigned p = HISTOGRAM_PRECISION_BITS) : precision_bits(p) {
+        if (p < 1 || p > 16 || p > HISTOGRAM_MAX_EXPONENT)
+            throw std::invalid_argument("HistogramLayout: precision_bits must be in [1, 16]");
+    }
+
+    std::size_t bucket_count() const noexcept {
+        return static_cast<std::size_t>(HISTOGRAM_MAX_EXPONENT - precision_bits + 2) << precision_bits;
+    }
+
+    std::size_t index_of(std::uint64_t v) const noexcept {
+        const unsigned      p = precision_bits;
+        const std::uint64_t s = std::uint64_t{1} << p;
+        if (v < s) return static_cast<std::size_t>(v);
+        const unsigned e = 63u - static_cast<unsigned>(__builtin_clzll(v));
+        if (e > HISTOGRAM_MAX_EXPONENT) return bucket_count() - 1;
+        return (static_cast<std::size_t>(e - p + 1) << p)
+             + static_cast<std::size_t>((v >> (e - p)) - s);
+    }
+
+    // Smallest and largest value that index_of() maps to bucket i.
+    std::uint64_t lowest(std::size_t i) const noexcept {
+        const std::size_t   g = i >> precision_bits;
+        const std::uint64_t m = i & ((std::size_t{1} << precision_bits) - 1);
+        if (g == 0) return m;
+        return ((std::uint64_t{1} << precision_bits) + m) << (g - 1);
+    }
+    std::uint64_t highest(std::size_t i) const noexcept {
+        const std::size_t g = i >> precision_bits;
+        return g == 0 ? lowest(i) : lowest(i) + ((std::uint64_t{1} << (g - 1)) - 1);
+    }
+};
+
+// ── HistogramSnapshot ─────────────────────────────────────────────────────
+//
+// Plain (non-atomic) copy of a LatencyHistogram, for reporting. Snapshots
+// of histograms with the same precision merge by adding buckets, so each
+// recording thread keeps its own LatencyHistogram and a reporter sums
+// them — no shared counters on the hot path.
+class HistogramSnapshot {
+public:
+    explicit HistogramSnapshot(unsigned precision_bits = HISTOGRAM_PRECISION_BITS)
+        : layout_(precision_bits), counts_(layout_.bucket_count(), 0) {}
+
+    void record(std::uint64_t ns, std::uint64_t n = 1) noexcept {
+        counts_[layout_.index_of(ns)] += n;
+        add_summary(n, ns, ns, ns * n);
+    }
+
+    // Adds `other`'s counts. Throws std::invalid_argument if the two were
+    // recorded with different precision.
+    HistogramSnapshot& merge(const HistogramSnapshot& other) {
+        if (other.layout_.precision_bits != layout_.precision_bits)
+            throw std::invalid_argument("HistogramSnapshot::merge: precision mismatch");
+        for (std::size_t i = 0; i < counts_.size(); ++i) counts_[i] += other.counts_[i];
+        if (other.total_) add_summary(other.total_, other.min_, other.max_, other.sum_);
+        return *this;
+    }
+
+    // What was recorded after `earlier`, an older snapshot of the same
+    // histogram: per-interval percentiles from a cumulative histogram.
+    // min/max are those of the outermost non-empty buckets (max capped at
+    // max_ns()). Throws std::invalid_argument on a precision mismatch.
+    HistogramSnapshot since(const HistogramSnapshot& earlier) const {
+        if (earlier.layout_.precision_bits != layout_.precision_bits)
+            throw std::invalid_argument("HistogramSnapshot::since: precision mismatch");
+        HistogramSnapshot d(layout_.precision_bits);
+        for (std::size_t i = 0; i < counts_.size(); ++i) {
+            const std::uint64_t n = counts_[i] > earlier.counts_[i] ? counts_[i] - earlier.counts_[i] : 0;
+            if (n == 0) continue;
+            d.counts_[i] = n;
+            d.add_summary(n, layout_.lowest(i), std::min(layout_.highest(i), max_), 0);
+        }
+        d.sum_ = sum_ > earlier.sum_ ? sum_ - earlier.sum_ : 0;
+        return d;
+    }
+
+    std::uint64_t count() const noexcept { return total_; }
+    std::uint64_t min_ns() const noexcept { return total_ ? min_ : 0; }
+    std::uint64_t max_ns() const noexcept { return max_; }
+    double        mean_ns() const noexcept {
+        return total_ ? static_cast<double>(sum_) / static_cast<double>(total_) : 0.0;
+    }
+
+    // Latency in ns at or below which fraction `q` of the values fall
+    // (the highest value of that bucket, capped at max_ns()). 0 if empty.
+    std::uint64_t value_at(double q) const noexcept {
+        if (total_ == 0) return 0;
+        const std::uint64_t target = rank(q, total_);
+        std::uint64_t cumulative = 0;
+        for (std::size_t i = 0; i < counts_.size(); ++i) {
+            cumulative += counts_[i];
+            if (cumulative >= target) return std::min(layout_.highest(i), max_);
+        }
+        return max_;
+    }
+
+    // value_at(q) in microseconds, as LatencyHistogram::percentile().
+    double percentile(double q) const noexcept { return static_cast<double>(value_at(q)) / 1000.0; }
+
+    const HistogramLayout&            layout() const noexcept { return layout_; }
+    const std::vector<std::uint64_t>& counts() const noexcept { return counts_; }
+
+    // 1-based rank of quantile q among n values, in [1, n].
+    static std::uint64_t rank(double q, std::uint64_t n) noexcept {
+        const double r = q * static_cast<double>(n);
+        std::uint64_t k = static_cast<std::uint64_t>(r);
+        if (static_cast<double>(k) < r) ++k;
+        return std::clamp<std::uint64_t>(k, 1, n);
+    }
+
+private:
+    friend class LatencyHistogram;
+
+    void add_summary(std::uint64_t n, std::uint64_t lo, std::uint64_t hi, std::uint64_t sum) noexcept {
+        min_    = std::min(min_, lo);
+        max_    = std::max(max_, hi);
+        sum_   += sum;
+        total_ += n;
+    }
+
+    HistogramLayout            layout_;
+    std::vector<std::uint64_t> counts_;
+    std::uint64_t              total_{0};
+    std::uint64_t              min_{std::numeric_limits<std::uint64_t>::max()};
+    std::uint64_t              max_{0};
+    std::uint64_t              sum_{0};
+};
+
+// ── LatencyHistogram ──────────────────────────────────────────────────────
+//
+// End-to-end latency histogram with HistogramLayout buckets, recorded in
+// nanoseconds (Event::latency_ns()).
+//
+// Single writer: record() is a relaxed load and store per counter, never a
+// locked read-modify-write, so it costs a few ns and shares no cache line
+// with any other thread's histogram. Any thread may read concurrently —
+// percentile(), value_at() and snapshot() see a recent, possibly slightly
+// torn, state. Several recording threads (sinks, operator replicas) each
+// own one and merge snapshot()s for reporting.
+//
+// percentile() keeps its old unit (microseconds) for existing callers;
+// value_at() answers in nanoseconds.
+class LatencyHistogram {
+public:
+    explicit LatencyHistogram(unsigned precision_bits = HISTOGRAM_PRECISION_BITS)
+        : layout_(precision_bits)
+        , buckets_(new std::atomic<std::uint64_t>[layout_.bucket_count()])
+    {
+        for (std::size_t i = 0; i < layout_.bucket_count(); ++i)
+            buckets_[i].store(0, std::memory_order_relaxed);
+    }
+
+    LatencyHistogram(const LatencyHistogram&)            = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    void record(std::uint64_t latency_ns) noexcept {
+        bump(buckets_[layout_.index_of(latency_ns)], 1);
+        bump(total_, 1);
+        bump(sum_, latency_ns);
+        if (latency_ns > max_.load(std::memory_order_relaxed)) max_.store(latency_ns, std::memory_order_relaxed);
+        if (latency_ns < min_.load(std::memory_order_relaxed)) min_.store(latency_ns, std::memory_order_relaxed);
+    }
+
+    std::uint64_t count() const noexcept { return total_.load(std::memory_order_relaxed); }
+
+    // As HistogramSnapshot::value_at(), read live in one pass.
+    std::uint64_t value_at(double q) const noexcept {
+        const std::uint64_t total = count();
+        if (total == 0) return 0;
+        const std::uint64_t max    = max_.load(std::memory_order_relaxed);
+        const std::uint64_t target = HistogramSnapshot::rank(q, total);
+        std::uint64_t cumulative = 0;
+        for (std::size_t i = 0; i < layout_.bucket_count(); ++i) {
+            cumulative += buckets_[i].load(std::memory_order_relaxed);
+            if (cumulative >= target) return std::min(layout_.highest(i), max);
+        }
+        return max;
+    }
+
+    // Latency in microseconds below which fraction `pct` of events fall.
+    // E.g., percentile(0.99) returns p99 latency in microseconds.
+    double percentile(double pct) const noexcept { return static_cast<double>(value_at(pct)) / 1000.0; }
+
+    HistogramSnapshot snapshot() const {
+        HistogramSnapshot s(layout_.precision_bits);
+        std::uint64_t total = 0;
+        for (std::size_t i = 0; i < layout_.bucket_count(); ++i) {
+            s.counts_[i] = buckets_[i].load(std::memory_order_relaxed);
+            total += s.counts_[i];
+        }
+        if (total) {
+            s.add_summary(total, min_.load(std::memory_order_relaxed),
+                          max_.load(std::memory_order_relaxed), sum_.load(std::memory_order_relaxed));
+        }
+        return s;
+    }
+
+    const HistogramLayout& layout() const noexcept { return layout_; }
+
+private:
+    static void bump(std::atomic<std::uint64_t>& c, std::uint64_t n) noexcept {
+        c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    HistogramLayout                               layout_;
+    std::unique_ptr<std::atomic<std::uint64_t>[]> buckets_;
+    std::atomic<std::uint64_t>                    total_{0};
+    std::atomic<std::uint64_t>                    sum_{0};
+    std::atomic<std::uint64_t>                    max_{0};
+    std::atomic<std::uint64_t>                    min_{std::numeric_limits<std::uint64_t>::max()};
+};
+
+} // namespace klstream
@@ -0,0 +1,135 @@
+// include/klstream/core/keyed_state.hpp
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace klstream {
+
+// ── mix64 ─────────────────────────────────────────────────────────────────
+//
+// splitmix64 finaliser: spreads dense keys (campaign ids, symbol numbers)
+// over all 64 bits. Shared by KeyedStateStore (low bits pick the slot) and
+// partition_of (high bits pick the partition), so the two stay independent.
+inline std::uint64_t mix64(std::uint64_t key) noexcept {
+    std::uint64_t h = key + 0x9e3779b97f4a7c15ULL;
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+    return h ^ (h >> 31);
+}
+
+// ── KeyedStateStore<State> ────────────────────────────────────────────────
+//
+// Per-key state for keyed operators, keyed by Event::key. Replaces
+// std::unordered_map on the hot path:
+//
+//   entries — one flat array of { key, value } in insertion order. This is
+//             the arena: values never move except when it grows, and
+//             iteration (begin()/end()) walks it front to back.
+//   slots   — an open-addressing index (linear probing, power-of-two size,
+//             at most 3/4 full) of 32-bit positions into entries. A lookup
+//             is one hash, a short probe over a 4-byte array, and one
+//             access into entries.
+//
+// Nothing is allocated per insert: entries and slots only grow (doubling)
+// when the store outgrows its high-water mark, and clear() keeps both, so a
+// store reused across windows stops allocating after the first one. Call
+// reserve() with the expected key count to skip even those.
+//
+// There is no erase(); keyed operators keep a key's state until clear().
+// Not thread-safe — each operator replica owns its store.
+template <typename State>
+class KeyedStateStore {
+public:
+    struct Entry {
+        std::uint64_t key;
+        State         value;
+    };
+
+    using iterator       = typename std::vector<Entry>::iterator;
+    using const_iterator = typename std::vector<Entry>::const_iterator;
+
+    explicit KeyedStateStore(std::size_t expected_keys = 16) { reserve(expected_keys); }
+
+    // Room for n keys without growing either array.
+    void reserve(std::size_t n) {
+        entries_.reserve(n);
+        std::size_t cap = 8;
+        while (cap * 3 < n * 4) cap <<= 1;
+        if (cap > slots_.size()) rehash(cap);
+    }
+
+    std::size_t size() const noexcept { return entries_.size(); }
+    bool        empty() const noexcept { return entries_.empty(); }
+
+    // Number of index slots (a power of two).
+    std::size_t slot_count() const noexcept { return slots_.size(); }
+
+    // The state of `key`, or nullptr if it has none.
+    State* find(std::uint64_t key) noexcept {
+        const std::uint32_t* s = probe(key);
+        return *s == EMPTY ? nullptr : &entries_[*s].value;
+    }
+    const State* find(std::uint64_t key) const noexcept {
+        return const_cast<KeyedStateStore*>(this)->find(key);
+    }
+
+    bool contains(std::uint64_t key) const noexcept { return find(key) != nullptr; }
+
+    // The state of `key`, inserted as a copy of `init` if it has none.
+    State& get_or_insert(std::uint64_t key, const State& init) {
+        std::uint32_t* s = probe(key);
+        if (*s != EMPTY) return entries_[*s].value;
+        if ((entries_.size() + 1) * 4 > slots_.size() * 3) {
+            rehash(slots_.size() * 2);
+            s = probe(key);
+        }
+        assert(entries_.size() < EMPTY);
+        *s = static_cast<std::uint32_t>(entries_.size());
+        entries_.push_back({ key, init });
+        return entries_.back().value;
+    }
+
+    // get_or_insert with a value-initialised State.
+    State& operator[](std::uint64_t key) { return get_or_insert(key, State{}); }
+
+    // Drops every key but keeps both arrays' capacity. Costs O(size()),
+    // not O(slot_count()): only the slots in use are reset, newest key
+    // first — a key's probe path only crosses keys inserted before it, so
+    // every key still left is found at its own slot.
+    void clear() noexcept {
+        for (auto e = entries_.rbegin(); e != entries_.rend(); ++e) *probe(e->key) = EMPTY;
+        entries_.clear();
+    }
+
+    iterator       begin() noexcept { return entries_.begin(); }
+    iterator       end() noexcept { return entries_.end(); }
+    const_iterator begin() const noexcept { return entries_.begin(); }
+    const_iterator end() const noexcept { return entries_.end(); }
+
+private:
+    static constexpr std::uint32_t EMPTY = std::numeric_limits<std::uint32_t>::max();
+
+    // The slot holding `key`, or the empty slot where it would go.
+    std::uint32_t* probe(std::uint64_t key) noexcept {
+        const std::size_t mask = slots_.size() - 1;
+        std::size_t i = static_cast<std::size_t>(mix64(key)) & mask;
+        while (slots_[i] != EMPTY && entries_[slots_[i]].key != key) i = (i + 1) & mask;
+        return &slots_[i];
+    }
+
+    void rehash(std::size_t cap) {
+        slots_.assign(cap, EMPTY);
+        for (std::size_t e = 0; e < entries_.size(); ++e) {
+            *probe(entries_[e].key) = static_cast<std::uint32_t>(e);
+        }
+    }
+
+    std::vector<Entry>         entries_;
+    std::vector<std::uint32_t> slots_;
+};
+
+} // namespace klstream
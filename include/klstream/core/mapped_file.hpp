@@ -0,0 +1,131 @@
+// include/klstream/core/mapped_file.hpp
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <fstream>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#  define KLSTREAM_HAS_MMAP 1
+#endif
+
+namespace klstream {
+
+// ── MappedFile ───────────────────────────────────────────────────────────
+//
+// A whole file mapped read-only. Pages are shared with every other process
+// mapping the same file and are faulted in on first touch, so "loading" a
+// large model or replay file costs one syscall rather than a parse.
+//
+// Like apply_affinity(), this is the only place that touches the platform
+// API. On targets without mmap the file is read into a 64-byte-aligned
+// heap buffer instead — same interface, just without the sharing.
+//
+// Throws std::runtime_error if the file cannot be opened, is empty, or
+// cannot be mapped.
+class MappedFile {
+public:
+    // Access-pattern hints for advise(), after madvise(2).
+    enum class Advice {
+        Normal,
+        Sequential,   // aggressive kernel read-ahead over the range
+        WillNeed,     // start reading the range in now, asynchronously
+        DontNeed,     // drop the range from this mapping; re-read on next touch
+    };
+
+    explicit MappedFile(const std::string& path) {
+#if defined(KLSTREAM_HAS_MMAP)
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("MappedFile: cannot open " + path);
+        struct stat st{};
+        if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+            ::close(fd);
+            throw std::runtime_error("MappedFile: empty or unreadable " + path);
+        }
+        size_ = static_cast<std::size_t>(st.st_size);
+        void* p = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);   // the mapping keeps its own reference
+        if (p == MAP_FAILED) throw std::runtime_error("MappedFile: mmap failed for " + path);
+        data_ = static_cast<const std::byte*>(p);
+#else
+        std::ifstream in(path, std::ios::binary | std::ios::ate);
+        if (!in) throw std::runtime_error("MappedFile: cannot open " + path);
+        const auto end = in.tellg();
+        if (end <= 0) throw std::runtime_error("MappedFile: empty or unreadable " + path);
+        size_ = static_cast<std::size_t>(end);
+        auto* buf = static_cast<std::byte*>(::operator new(size_, std::align_val_t{64}));
+        in.seekg(0);
+        if (!in.read(reinterpret_cast<char*>(buf), static_cast<std::streamsize>(size_))) {
+            ::operator delete(buf, std::align_val_t{64});
+            throw std::runtime_error("MappedFile: short read from " + path);
+        }
+        data_ = buf;
+#endif
+    }
+
+    ~MappedFile() { unmap(); }
+
+    MappedFile(const MappedFile&)            = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& o) noexcept
+        : data_(std::exchange(o.data_, nullptr)), size_(std::exchange(o.size_, 0)) {}
+    MappedFile& operator=(MappedFile&& o) noexcept {
+        if (this != &o) {
+            unmap();
+            data_ = std::exchange(o.data_, nullptr);
+            size_ = std::exchange(o.size_, 0);
+        }
+        return *this;
+    }
+
+    const std::byte* data() const noexcept { return data_; }
+    std::size_t      size() const noexcept { return size_; }
+
+    // Hints how [offset, offset + len) is about to be used. The range is
+    // widened to whole pages and clipped to the file. Best effort: a no-op
+    // without mmap, and errors are ignored — the data stays readable either
+    // way, since the mapping is read-only and backed by the file.
+    void advise(std::size_t offset, std::size_t len, Advice a) const noexcept {
+#if defined(KLSTREAM_HAS_MMAP)
+        if (!data_ || offset >= size_ || len == 0) return;
+        static const std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+        const std::size_t begin = offset / page * page;
+        const std::size_t end   = std::min(size_, offset + len);
+        int advice = MADV_NORMAL;
+        switch (a) {
+            case Advice::Normal:     advice = MADV_NORMAL;     break;
+            case Advice::Sequential: advice = MADV_SEQUENTIAL; break;
+            case Advice::WillNeed:   advice = MADV_WILLNEED;   break;
+            case Advice::DontNeed:   advice = MADV_DONTNEED;   break;
+        }
+        ::madvise(const_cast<std::byte*>(data_) + begin, end - begin, advice);
+#else
+        (void)offset; (void)len; (void)a;
+#endif
+    }
+
+private:
+    void unmap() noexcept {
+        if (!data_) return;
+#if defined(KLSTREAM_HAS_MMAP)
+        ::munmap(const_cast<std::byte*>(data_), size_);
+#else
+        ::operator delete(const_cast<std::byte*>(data_), std::align_val_t{64});
+#endif
+        data_ = nullptr;
+    }
+
+    const std::byte* data_ = nullptr;
+    std::size_t      size_ = 0;
+};
+
+} // namespace klstream
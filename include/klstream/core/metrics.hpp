@@ -1,6 +1,8 @@
 // include/klstream/core/metrics.hpp
 #pragma once
 #include "config.hpp"
+#include "clock.hpp"
+#include "histogram.hpp"
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
@@ -9,14 +11,17 @@
 #include <chrono>
 #include <iostream>
 #include <iomanip>
+#include <memory>
+#include <mutex>
+#include <thread>
 
 namespace klstream {
 
 // ── Counter ───────────────────────────────────────────────────────────────
 //
-// A cache-line-aligned atomic counter for counting events.
-// Each operator has one Counter for events_processed and one for
-// events_blocked (backpressure occurrences).
+// A cache-line-aligned atomic counter for counting events, safe for any
+// number of writers. Counters with a single writer — an operator's own
+// metrics — use LocalCounter below instead.
 //
 // memory_order_relaxed is used everywhere because:
 //   a) We only care about approximate throughput, not exact synchronisation.
@@ -31,6 +36,11 @@ struct Counter {
         value.fetch_add(1, std::memory_order_relaxed);
     }
 
+    // Batched increment — one RMW for a whole tick's worth of events.
+    void add(std::uint64_t n) noexcept {
+        value.fetch_add(n, std::memory_order_relaxed);
+    }
+
     std::uint64_t load() const noexcept {
         return value.load(std::memory_order_relaxed);
     }
@@ -42,71 +52,224 @@ struct Counter {
     }
 };
 
-// ── LatencyHistogram ──────────────────────────────────────────────────────
+// ── LocalCounter ──────────────────────────────────────────────────────────
 //
-// A fixed-width histogram for end-to-end latency. Each bucket covers 1 us.
-// Bucket index = latency_us = latency_ns / 1000.
-// Values beyond MAX_LATENCY_US go into an overflow bucket.
+// A Counter with exactly one writer: the thread currently ticking the
+// operator that owns it (the scheduler never ticks one operator on two
+// threads at once, and hands it between workers through its run queues).
+// add() is therefore a relaxed load and a relaxed store — an ordinary
+// load/add/store, no lock prefix or LL/SC loop — and every update is
+// already published to readers such as MetricsReporter.
 //
-// Not lock-free: uses a single compare_exchange_weak per record. Suitable
-// for the sink operator (single consumer thread increments buckets).
-// If multiple sinks need to share a histogram, protect with a mutex or
-// use per-thread histograms merged periodically.
-struct LatencyHistogram {
-    std::array<std::atomic<std::uint64_t>, HISTOGRAM_BUCKETS + 1> buckets{};
-
-    LatencyHistogram() {
-        for (auto& b : buckets) b.store(0, std::memory_order_relaxed);
-    }
-
-    void record(std::uint64_t latency_ns) noexcept {
-        std::size_t idx = latency_ns / 1000; // convert ns -> us
-        if (idx >= HISTOGRAM_BUCKETS) idx = HISTOGRAM_BUCKETS; // overflow
-        buckets[idx].fetch_add(1, std::memory_order_relaxed);
-    }
-
-    // Returns the latency_us value below which `pct` fraction of events fall.
-    // E.g., percentile(0.99) returns p99 latency in microseconds.
-    double percentile(double pct) const noexcept {
-        std::uint64_t total = 0;
-        for (const auto& b : buckets)
-            total += b.load(std::memory_order_relaxed);
-        if (total == 0) return 0.0;
-        const std::uint64_t target = static_cast<std::uint64_t>(pct * total);
-        std::uint64_t cumulative = 0;
-        for (std::size_t i = 0; i < HISTOGRAM_BUCKETS; ++i) {
-            cumulative += buckets[i].load(std::memory_order_relaxed);
-            if (cumulative >= target) return static_cast<double>(i);
-        }
-        return static_cast<double>(MAX_LATENCY_US); // overflow bucket
+// There is no reset(): a second thread resetting would race with the
+// owner's store. Readers keep the previous value and work with deltas.
+// Not aligned to a cache line by itself: counters with the same writer
+// share one (see OperatorMetrics).
+struct LocalCounter {
+    std::atomic<std::uint64_t> value{0};
+
+    void increment() noexcept { add(1); }
+
+    void add(std::uint64_t n) noexcept {
+        value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    std::uint64_t load() const noexcept {
+        return value.load(std::memory_order_relaxed);
+    }
+};
+
+// ── OpLoad ────────────────────────────────────────────────────────────────
+//
+// Estimated time one operator spends doing work: the worker times every
+// LOAD_SAMPLE_EVERY-th tick and, if it returned Processed, charges it
+// LOAD_SAMPLE_EVERY times over. Idle and Blocked ticks are not work — an
+// operator polling an empty queue is cheap to move and cheap to keep.
+// Read by the rebalancer (Runtime::set_rebalancing) as deltas over time.
+struct OpLoad {
+    LocalCounter  busy_ns;
+    std::uint32_t countdown{0};    // ticks to the next sample; the ticking thread's
+};
+
+// ── PerfMetrics ───────────────────────────────────────────────────────────
+//
+// Hardware counter deltas (perf_counters.hpp) summed over the sampled
+// ticks of one operator: every PERF_SAMPLE_EVERY-th tick when profiling is
+// on (IOperator::perf, StreamGraph::profile). Only ratios are
+// meaningful — IPC, misses per kilo-instruction, stalled share of cycles.
+// All zero when the platform has no usable counters.
+struct PerfMetrics {
+    LocalCounter ticks;            // sampled ticks counted
+    LocalCounter cycles;
+    LocalCounter instructions;
+    LocalCounter cache_misses;     // last-level cache
+    LocalCounter branch_misses;
+    LocalCounter l1d_misses;
+    LocalCounter stalled_cycles;   // backend stalls
+    std::uint32_t countdown{0};    // ticks to the next sample; the ticking thread's
+
+    double ipc() const noexcept {
+        const std::uint64_t c = cycles.load();
+        return c ? static_cast<double>(instructions.load()) / static_cast<double>(c) : 0.0;
+    }
+    // `misses` (one of the counters above) per 1000 instructions.
+    double mpki(const LocalCounter& misses) const noexcept {
+        const std::uint64_t i = instructions.load();
+        return i ? 1000.0 * static_cast<double>(misses.load()) / static_cast<double>(i) : 0.0;
     }
 };
 
 // ── OperatorMetrics ───────────────────────────────────────────────────────
 //
 // One per operator instance. Attached to the operator at construction and
-// read by the MetricsReporter thread.
-struct OperatorMetrics {
-    Counter events_processed;   // successfully processed events
-    Counter events_blocked;     // tick() returned Blocked (backpressure)
-    Counter events_idle;        // tick() returned Idle (no input)
-    std::string op_name;        // set at construction, never modified after
+// read by the MetricsReporter thread. Only the owning operator writes its
+// counters, so they are LocalCounters packed into one cache line — per
+// event a Filter pays one plain store into a line no other writer touches,
+// instead of a locked fetch_add per counter.
+struct alignas(CACHE_LINE_SIZE) OperatorMetrics {
+    LocalCounter events_processed;   // successfully processed events
+    LocalCounter events_blocked;     // tick() returned Blocked (backpressure)
+    LocalCounter events_idle;        // tick() returned Idle (no input)
+    LocalCounter events_shed;        // dropped under load (LoadShedOperator)
+    std::string  op_name;            // set at construction, never modified after
+    PerfMetrics  perf;               // hardware counters, when profiled
 
     OperatorMetrics() = default;
     explicit OperatorMetrics(std::string name) : op_name(std::move(name)) {}
 };
 
+// ── WorkerStats ───────────────────────────────────────────────────────────
+//
+// Time a WorkerThread spent in scheduling rounds that made progress (busy)
+// and in rounds that did not, backoff and parking included (idle). One
+// clock read per round; the worker is the only writer.
+struct alignas(CACHE_LINE_SIZE) WorkerStats {
+    LocalCounter busy_ns;
+    LocalCounter idle_ns;
+};
+
+// ── MetricsSnapshot ───────────────────────────────────────────────────────
+//
+// Everything a MetricsReporter samples in one interval, handed to each
+// MetricsExporter. Rates and ratios cover the interval since the previous
+// snapshot; *_total fields and histograms are cumulative.
+struct OperatorRates {
+    const OperatorMetrics* metrics;
+    double                 processed_per_sec;
+    double                 blocked_per_sec;
+    double                 idle_per_sec;
+    std::uint64_t          processed_total;
+    std::uint64_t          blocked_total;
+    std::uint64_t          idle_total;
+    std::uint64_t          shed_total;
+};
+
+struct QueueSample {
+    std::string name;
+    std::size_t depth;        // events queued (approximate, as occupancy())
+    std::size_t capacity;
+    double      occupancy;    // depth / capacity
+};
+
+struct HistogramSample {
+    std::string   name;
+    std::uint64_t count;
+    double        mean_ns;
+    std::uint64_t p50_ns, p90_ns, p99_ns, p999_ns, max_ns;
+};
+
+struct WorkerSample {
+    std::size_t index;
+    double      busy_ratio;   // share of the interval in productive rounds
+    double      idle_ratio;
+};
+
+struct MetricsSnapshot {
+    std::uint64_t                at_ns;       // Clock::now_ns() when taken
+    std::vector<OperatorRates>   operators;
+    std::vector<QueueSample>     queues;
+    std::vector<HistogramSample> histograms;
+    std::vector<WorkerSample>    workers;
+};
+
+// ── MetricsExporter ───────────────────────────────────────────────────────
+//
+// Receives every snapshot on the reporter thread. Implementations must not
+// block for long — the next interval waits. See metrics_export.hpp for the
+// Prometheus endpoint and the JSON-lines file.
+class MetricsExporter {
+public:
+    virtual ~MetricsExporter() = default;
+    virtual void publish(const MetricsSnapshot& s) = 0;
+};
+
+// ── ConsoleExporter ───────────────────────────────────────────────────────
+//
+// The original stdout table of operator rates. MetricsReporter uses it when
+// no other exporter is registered.
+class ConsoleExporter : public MetricsExporter {
+public:
+    void publish(const MetricsSnapshot& s) override {
+        using namespace std;
+        cout << "\n── KLStream Metrics ─────────────────────────────────\n";
+        cout << left
+             << setw(22) << "Operator"
+             << setw(16) << "Events/sec"
+             << setw(14) << "Blocked/sec"
+             << setw(12) << "Idle/sec" << "\n";
+        cout << string(64, '-') << "\n";
+        cout << fixed << setprecision(0);
+        for (const auto& r : s.operators) {
+            cout << setw(22) << r.metrics->op_name
+                 << setw(16) << r.processed_per_sec
+                 << setw(14) << r.blocked_per_sec
+                 << setw(12) << r.idle_per_sec
+                 << "\n";
+        }
+        cout << flush;
+    }
+};
+
 // ── MetricsReporter ───────────────────────────────────────────────────────
 //
 // Runs on its own background std::thread. Every METRICS_INTERVAL_SEC seconds
-// it samples all registered OperatorMetrics instances and prints a summary
-// table to stdout.
+// it takes a MetricsSnapshot of everything registered — operators, queues,
+// latency histograms, workers — and hands it to each exporter (a
+// ConsoleExporter if none was added). With exporters, one last snapshot is
+// published at stop(), so short runs are not lost.
+//
+// Rates come from deltas: snapshot() remembers each counter's previous
+// value and the time it was read, and divides by the time actually
+// elapsed. The counters themselves are never reset, so cumulative totals
+// stay valid for everyone else (tests, StreamGraph::observed_rates).
 //
 // To use: create one MetricsReporter, call add(metrics_ptr) for each operator,
-// then call start(). Call stop() on shutdown.
+// then call start(). Call stop() on shutdown. Registration must happen
+// before start(); the registered objects must outlive the reporter.
 class MetricsReporter {
 public:
-    void add(OperatorMetrics* m) { entries_.push_back(m); }
+    void add(OperatorMetrics* m) {
+        entries_.push_back({ m, m->events_processed.load(), m->events_blocked.load(),
+                             m->events_idle.load(), Clock::now_ns() });
+    }
+
+    // Any queue with occupancy() and capacity() (SPSCQueue, MPMCQueue).
+    template <typename Queue>
+    void add_queue(std::string name, const Queue* q) {
+        queues_.push_back({ std::move(name), q, q->capacity(), [](const void* p) {
+            return static_cast<const Queue*>(p)->occupancy();
+        } });
+    }
+
+    void add_histogram(std::string name, const LatencyHistogram* h) {
+        histograms_.push_back({ std::move(name), h });
+    }
+
+    void add_worker(const WorkerStats* w) {
+        workers_.push_back({ w, w->busy_ns.load(), w->idle_ns.load() });
+    }
+
+    void add_exporter(std::unique_ptr<MetricsExporter> e) { exporters_.push_back(std::move(e)); }
 
     void start() {
         running_.store(true);
@@ -115,42 +278,103 @@ public:
 
     void stop() {
         running_.store(false);
-        if (thread_.joinable()) thread_.join();
+        if (!thread_.joinable()) return;
+        thread_.join();
+        if (!exporters_.empty()) publish();
     }
 
     ~MetricsReporter() { stop(); }
 
+    // Operator rates since the previous snapshot() (or their add()).
+    std::vector<OperatorRates> sample() { return snapshot().operators; }
+
+    // Samples everything registered. Safe from any thread, but intervals
+    // are shared: a caller's snapshot ends the reporter's current interval.
+    MetricsSnapshot snapshot() {
+        std::lock_guard<std::mutex> lock(mu_);
+        MetricsSnapshot out;
+        const std::uint64_t now = Clock::now_ns();
+        out.at_ns = now;
+        out.operators.reserve(entries_.size());
+        for (auto& e : entries_) {
+            const std::uint64_t p = e.m->events_processed.load();
+            const std::uint64_t b = e.m->events_blocked.load();
+            const std::uint64_t i = e.m->events_idle.load();
+            const double secs = now > e.at_ns ? static_cast<double>(now - e.at_ns) * 1e-9 : 0.0;
+            const auto rate = [secs](std::uint64_t d) { return secs > 0 ? static_cast<double>(d) / secs : 0.0; };
+            out.operators.push_back({ e.m, rate(p - e.processed), rate(b - e.blocked), rate(i - e.idle),
+                                      p, b, i, e.m->events_shed.load() });
+            e.processed = p;
+            e.blocked   = b;
+            e.idle      = i;
+            e.at_ns     = now;
+        }
+        for (const auto& q : queues_) {
+            const double occ = q.occupancy(q.q);
+            out.queues.push_back({ q.name, static_cast<std::size_t>(occ * static_cast<double>(q.capacity) + 0.5),
+                                   q.capacity, occ });
+        }
+        for (const auto& h : histograms_) {
+            const HistogramSnapshot hs = h.h->snapshot();
+            out.histograms.push_back({ h.name, hs.count(), hs.mean_ns(), hs.value_at(0.50), hs.value_at(0.90),
+                                       hs.value_at(0.99), hs.value_at(0.999), hs.max_ns() });
+        }
+        for (std::size_t w = 0; w < workers_.size(); ++w) {
+            auto& e = workers_[w];
+            const std::uint64_t busy = e.w->busy_ns.load(), idle = e.w->idle_ns.load();
+            const double total = static_cast<double>((busy - e.busy) + (idle - e.idle));
+            out.workers.push_back({ w, total > 0 ? static_cast<double>(busy - e.busy) / total : 0.0,
+                                       total > 0 ? static_cast<double>(idle - e.idle) / total : 0.0 });
+            e.busy = busy;
+            e.idle = idle;
+        }
+        return out;
+    }
+
 private:
+    struct Entry {
+        OperatorMetrics* m;
+        std::uint64_t    processed, blocked, idle;   // at the previous snapshot()
+        std::uint64_t    at_ns;
+    };
+    struct QueueEntry {
+        std::string name;
+        const void* q;
+        std::size_t capacity;
+        double    (*occupancy)(const void*);
+    };
+    struct HistogramEntry {
+        std::string             name;
+        const LatencyHistogram* h;
+    };
+    struct WorkerEntry {
+        const WorkerStats* w;
+        std::uint64_t      busy, idle;               // at the previous snapshot()
+    };
+
     void run() {
         while (running_.load(std::memory_order_relaxed)) {
             std::this_thread::sleep_for(
                 std::chrono::seconds(METRICS_INTERVAL_SEC));
-            print();
+            publish();
         }
     }
 
-    void print() {
-        using namespace std;
-        cout << "\n── KLStream Metrics ─────────────────────────────────\n";
-        cout << left
-             << setw(22) << "Operator"
-             << setw(16) << "Events/sec"
-             << setw(14) << "Blocked/sec"
-             << setw(12) << "Idle/sec" << "\n";
-        cout << string(64, '-') << "\n";
-        for (auto* m : entries_) {
-            cout << setw(22) << m->op_name
-                 << setw(16) << m->events_processed.reset()
-                 << setw(14) << m->events_blocked.reset()
-                 << setw(12) << m->events_idle.reset()
-                 << "\n";
-        }
-        cout << flush;
+    void publish() {
+        const MetricsSnapshot s = snapshot();
+        if (exporters_.empty()) { console_.publish(s); return; }
+        for (auto& e : exporters_) e->publish(s);
     }
 
-    std::vector<OperatorMetrics*> entries_;
-    std::atomic<bool>             running_{false};
-    std::thread                   thread_;
+    std::vector<Entry>                            entries_;
+    std::vector<QueueEntry>                       queues_;
+    std::vector<HistogramEntry>                   histograms_;
+    std::vector<WorkerEntry>                      workers_;
+    std::vector<std::unique_ptr<MetricsExporter>> exporters_;
+    ConsoleExporter                               console_;
+    std::mutex                                    mu_;
+    std::atomic<bool>                             running_{false};
+    std::thread                                   thread_;
 };
 
 } // namespace klstream
@@ -0,0 +1,320 @@
+// include/klstream/core/metrics_export.hpp
+#pragma once
+#include "metrics.hpp"
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#  include <arpa/inet.h>
+#  include <netinet/in.h>
+#  include <poll.h>
+#  include <sys/socket.h>
+#  include <unistd.h>
+#  define KLSTREAM_HAS_SOCKETS 1
+#endif
+
+namespace klstream {
+
+// ── Text formats ──────────────────────────────────────────────────────────
+//
+// render_prometheus(): Prometheus text exposition format 0.0.4. Cumulative
+// values are counters (*_total), current values gauges; latency histograms
+// are summaries in seconds with quantile labels.
+//
+// render_json(): one JSON object, no trailing newline, for JSON-lines.
+//
+// Operators profiled with hardware counters (OperatorMetrics::perf) also
+// get their counter totals: *_total counters in Prometheus, a "perf"
+// object in JSON.
+namespace detail {
+
+inline std::string escape_label(const std::string& v) {
+    std::string out;
+    for (char c : v) {
+        if (c == '\\' || c == '"') { out += '\\'; out += c; }
+        else if (c == '\n') out += "\\n";
+        else out += c;
+    }
+    return out;
+}
+
+inline std::string escape_json(const std::string& v) {
+    std::string out;
+    for (char c : v) {
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n";  break;
+            case '\t': out += "\\t";  break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned>(c));
+                    out += buf;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    return out;
+}
+
+} // namespace detail
+
+inline std::string render_prometheus(const MetricsSnapshot& s) {
+    std::ostringstream o;
+    o.precision(17);
+    const auto family = [&o](const char* name, const char* type, const char* help) {
+        o << "# HELP " << name << ' ' << help << "\n# TYPE " << name << ' ' << type << '\n';
+    };
+    const auto op = [](const OperatorRates& r) {
+        return "{op=\"" + detail::escape_label(r.metrics->op_name) + "\"} ";
+    };
+
+    family("klstream_operator_events_processed_total", "counter", "Events processed by the operator.");
+    for (const auto& r : s.operators) o << "klstream_operator_events_processed_total" << op(r) << r.processed_total << '\n';
+    family("klstream_operator_blocked_total", "counter", "Ticks that returned Blocked (backpressure).");
+    for (const auto& r : s.operators) o << "klstream_operator_blocked_total" << op(r) << r.blocked_total << '\n';
+    family("klstream_operator_idle_total", "counter", "Ticks that returned Idle (no input).");
+    for (const auto& r : s.operators) o << "klstream_operator_idle_total" << op(r) << r.idle_total << '\n';
+    family("klstream_operator_shed_total", "counter", "Events dropped under load.");
+    for (const auto& r : s.operators) o << "klstream_operator_shed_total" << op(r) << r.shed_total << '\n';
+    family("klstream_operator_events_per_second", "gauge", "Events processed per second over the last interval.");
+    for (const auto& r : s.operators) o << "klstream_operator_events_per_second" << op(r) << r.processed_per_sec << '\n';
+
+    // Hardware counters, for profiled operators only (OperatorMetrics::perf).
+    const std::pair<const char*, LocalCounter PerfMetrics::*> perf[] = {
+        { "klstream_operator_perf_ticks_total", &PerfMetrics::ticks },
+        { "klstream_operator_cycles_total", &PerfMetrics::cycles },
+        { "klstream_operator_instructions_total", &PerfMetrics::instructions },
+        { "klstream_operator_cache_misses_total", &PerfMetrics::cache_misses },
+        { "klstream_operator_branch_misses_total", &PerfMetrics::branch_misses },
+        { "klstream_operator_l1d_misses_total", &PerfMetrics::l1d_misses },
+        { "klstream_operator_stalled_cycles_total", &PerfMetrics::stalled_cycles } };
+    bool profiled = false;
+    for (const auto& r : s.operators) profiled = profiled || r.metrics->perf.ticks.load() > 0;
+    for (const auto& f : perf) {
+        if (!profiled) break;
+        family(f.first, "counter", "Hardware counter over the operator's sampled ticks.");
+        for (const auto& r : s.operators) {
+            if (r.metrics->perf.ticks.load() > 0) o << f.first << op(r) << (r.metrics->perf.*f.second).load() << '\n';
+        }
+    }
+
+    const auto queue = [](const QueueSample& q) {
+        return "{queue=\"" + detail::escape_label(q.name) + "\"} ";
+    };
+    family("klstream_queue_depth", "gauge", "Events waiting in the queue.");
+    for (const auto& q : s.queues) o << "klstream_queue_depth" << queue(q) << q.depth << '\n';
+    family("klstream_queue_capacity", "gauge", "Queue capacity in events.");
+    for (const auto& q : s.queues) o << "klstream_queue_capacity" << queue(q) << q.capacity << '\n';
+    family("klstream_queue_occupancy", "gauge", "Queue fill fraction, 0 to 1.");
+    for (const auto& q : s.queues) o << "klstream_queue_occupancy" << queue(q) << q.occupancy << '\n';
+
+    family("klstream_latency_seconds", "summary", "End-to-end latency.");
+    for (const auto& h : s.histograms) {
+        const std::string n = detail::escape_label(h.name);
+        const std::pair<const char*, std::uint64_t> qs[] = {
+            { "0.5", h.p50_ns }, { "0.9", h.p90_ns }, { "0.99", h.p99_ns }, { "0.999", h.p999_ns }, { "1", h.max_ns } };
+        for (const auto& q : qs) {
+            o << "klstream_latency_seconds{histogram=\"" << n << "\",quantile=\"" << q.first << "\"} "
+              << static_cast<double>(q.second) * 1e-9 << '\n';
+        }
+        o << "klstream_latency_seconds_sum{histogram=\"" << n << "\"} "
+          << h.mean_ns * static_cast<double>(h.count) * 1e-9 << '\n';
+        o << "klstream_latency_seconds_count{histogram=\"" << n << "\"} " << h.count << '\n';
+    }
+
+    family("klstream_worker_busy_ratio", "gauge", "Share of the last interval the worker made progress.");
+    for (const auto& w : s.workers) o << "klstream_worker_busy_ratio{worker=\"" << w.index << "\"} " << w.busy_ratio << '\n';
+    family("klstream_worker_idle_ratio", "gauge", "Share of the last interval the worker was idle.");
+    for (const auto& w : s.workers) o << "klstream_worker_idle_ratio{worker=\"" << w.index << "\"} " << w.idle_ratio << '\n';
+    return o.str();
+}
+
+inline std::string render_json(const MetricsSnapshot& s) {
+    std::ostringstream o;
+    o.precision(17);
+    const auto str = [](const std::string& v) { return '"' + detail::escape_json(v) + '"'; };
+    o << "{\"ts_ns\":" << s.at_ns << ",\"operators\":[";
+    for (std::size_t i = 0; i < s.operators.size(); ++i) {
+        const auto& r = s.operators[i];
+        o << (i ? "," : "") << "{\"name\":" << str(r.metrics->op_name)
+          << ",\"processed_per_sec\":" << r.processed_per_sec
+          << ",\"blocked_per_sec\":" << r.blocked_per_sec
+          << ",\"idle_per_sec\":" << r.idle_per_sec
+          << ",\"processed_total\":" << r.processed_total
+          << ",\"blocked_total\":" << r.blocked_total
+          << ",\"idle_total\":" << r.idle_total
+          << ",\"shed_total\":" << r.shed_total;
+        const PerfMetrics& pm = r.metrics->perf;
+        if (pm.ticks.load() > 0) {
+            o << ",\"perf\":{\"ticks\":" << pm.ticks.load() << ",\"cycles\":" << pm.cycles.load()
+              << ",\"instructions\":" << pm.instructions.load() << ",\"cache_misses\":" << pm.cache_misses.load()
+              << ",\"branch_misses\":" << pm.branch_misses.load() << ",\"l1d_misses\":" << pm.l1d_misses.load()
+              << ",\"stalled_cycles\":" << pm.stalled_cycles.load() << ",\"ipc\":" << pm.ipc() << '}';
+        }
+        o << '}';
+    }
+    o << "],\"queues\":[";
+    for (std::size_t i = 0; i < s.queues.size(); ++i) {
+        const auto& q = s.queues[i];
+        o << (i ? "," : "") << "{\"name\":" << str(q.name) << ",\"depth\":" << q.depth
+          << ",\"capacity\":" << q.capacity << ",\"occupancy\":" << q.occupancy << '}';
+    }
+    o << "],\"histograms\":[";
+    for (std::size_t i = 0; i < s.histograms.size(); ++i) {
+        const auto& h = s.histograms[i];
+        o << (i ? "," : "") << "{\"name\":" << str(h.name) << ",\"count\":" << h.count
+          << ",\"mean_ns\":" << h.mean_ns << ",\"p50_ns\":" << h.p50_ns << ",\"p90_ns\":" << h.p90_ns
+          << ",\"p99_ns\":" << h.p99_ns << ",\"p999_ns\":" << h.p999_ns << ",\"max_ns\":" << h.max_ns << '}';
+    }
+    o << "],\"workers\":[";
+    for (std::size_t i = 0; i < s.workers.size(); ++i) {
+        const auto& w = s.workers[i];
+        o << (i ? "," : "") << "{\"index\":" << w.index << ",\"busy_ratio\":" << w.busy_ratio
+          << ",\"idle_ratio\":" << w.idle_ratio << '}';
+    }
+    o << "]}";
+    return o.str();
+}
+
+// ── JsonLinesExporter ─────────────────────────────────────────────────────
+//
+// Appends one render_json() line per snapshot to a file, flushed each
+// time so a tailing collector sees complete lines. Throws
+// std::runtime_error if the file cannot be opened.
+class JsonLinesExporter : public MetricsExporter {
+public:
+    explicit JsonLinesExporter(const std::string& path) : out_(path, std::ios::app) {
+        if (!out_) throw std::runtime_error("JsonLinesExporter: cannot open " + path);
+    }
+
+    void publish(const MetricsSnapshot& s) override {
+        out_ << render_json(s) << '\n';
+        out_.flush();
+    }
+
+private:
+    std::ofstream out_;
+};
+
+// ── PrometheusExporter ────────────────────────────────────────────────────
+//
+// Serves the latest snapshot as render_prometheus() text over HTTP on
+// `bind_addr:port` (port 0 = any free port; see port()). The page is
+// rendered on the reporter thread at publish(); a small server thread only
+// copies it out, one short-lived connection at a time — a scrape every few
+// seconds is all it has to handle. Any GET path returns the metrics.
+//
+// Throws std::runtime_error if the socket cannot be bound, or on targets
+// without BSD sockets.
+class PrometheusExporter : public MetricsExporter {
+public:
+    explicit PrometheusExporter(std::uint16_t port, const std::string& bind_addr = "127.0.0.1") {
+#if defined(KLSTREAM_HAS_SOCKETS)
+        fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (fd_ < 0) throw std::runtime_error("PrometheusExporter: socket() failed");
+        int one = 1;
+        ::setsockopt(fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port   = htons(port);
+        if (::inet_pton(AF_INET, bind_addr.c_str(), &addr.sin_addr) != 1
+            || ::bind(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0
+            || ::listen(fd_, 8) != 0) {
+            ::close(fd_);
+            throw std::runtime_error("PrometheusExporter: cannot listen on " + bind_addr + ":" + std::to_string(port));
+        }
+        socklen_t len = sizeof(addr);
+        ::getsockname(fd_, reinterpret_cast<sockaddr*>(&addr), &len);
+        port_   = ntohs(addr.sin_port);
+        server_ = std::thread([this] { serve(); });
+#else
+        (void)port; (void)bind_addr;
+        throw std::runtime_error("PrometheusExporter: no socket support on this platform");
+#endif
+    }
+
+    PrometheusExporter(const PrometheusExporter&)            = delete;
+    PrometheusExporter& operator=(const PrometheusExporter&) = delete;
+
+    ~PrometheusExporter() override {
+#if defined(KLSTREAM_HAS_SOCKETS)
+        stop_.store(true, std::memory_order_relaxed);
+        if (server_.joinable()) server_.join();
+        ::close(fd_);
+#endif
+    }
+
+    std::uint16_t port() const noexcept { return port_; }
+
+    void publish(const MetricsSnapshot& s) override {
+        std::string page = render_prometheus(s);
+        std::lock_guard<std::mutex> lock(mu_);
+        page_.swap(page);
+    }
+
+private:
+#if defined(KLSTREAM_HAS_SOCKETS)
+    void serve() {
+        while (!stop_.load(std::memory_order_relaxed)) {
+            pollfd p{ fd_, POLLIN, 0 };
+            if (::poll(&p, 1, 100) <= 0) continue;    // wake to check stop_
+            const int c = ::accept(fd_, nullptr, nullptr);
+            if (c < 0) continue;
+            respond(c);
+            ::close(c);
+        }
+    }
+
+    void respond(int c) {
+        char req[1024];
+        pollfd p{ c, POLLIN, 0 };
+        if (::poll(&p, 1, 1000) <= 0 || ::recv(c, req, sizeof(req), 0) <= 0) return;
+        std::string body;
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            body = page_;
+        }
+        const std::string head = "HTTP/1.1 200 OK\r\n"
+                                 "Content-Type: text/plain; version=0.0.4\r\n"
+                                 "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                                 "Connection: close\r\n\r\n";
+        send_all(c, head);
+        send_all(c, body);
+    }
+
+    static void send_all(int c, const std::string& data) {
+        std::size_t off = 0;
+        while (off < data.size()) {
+            const auto n = ::send(c, data.data() + off, data.size() - off, MSG_NOSIGNAL_FLAG);
+            if (n <= 0) return;
+            off += static_cast<std::size_t>(n);
+        }
+    }
+
+#  if defined(MSG_NOSIGNAL)
+    static constexpr int MSG_NOSIGNAL_FLAG = MSG_NOSIGNAL;
+#  else
+    static constexpr int MSG_NOSIGNAL_FLAG = 0;
+#  endif
+
+    int               fd_{-1};
+    std::thread       server_;
+    std::atomic<bool> stop_{false};
+#endif
+    std::uint16_t     port_{0};
+    std::mutex        mu_;
+    std::string       page_;
+};
+
+} // namespace klstream
@@ -1,48 +1,86 @@
 // include/klstream/core/mpmc_queue.hpp
 #pragma once
 #include "config.hpp"
+#include "page_alloc.hpp"
+#include <algorithm>
 #include <atomic>
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
 #include <new>
 #include <optional>
 #include <type_traits>
 
 namespace klstream {
 
-template <typename T>
+// ── MPMCSlotLayout ───────────────────────────────────────────────────────
+//
+// How MPMCQueue lays out its slots.
+//   Padded   one slot per cache line (the sequence counter is line-aligned):
+//            no two slots ever share a line, at the cost of a whole line per
+//            slot — 64 / 128 bytes for a 4-byte index or a 40-byte event.
+//   Compact  slots padded only to the next power of two, several per line,
+//            with the ring index scrambled so that consecutive positions —
+//            the ones concurrent producers (or consumers) claim at the same
+//            moment — land on different lines. Slots sharing a line are
+//            `capacity / slots_per_line` positions apart, i.e. touched a
+//            whole lap apart. Same footprint per element as the payload
+//            rounded up, so a ring of small payloads fits cache 2–16× better.
+// Payloads of half a line or more get one slot per line either way.
+enum class MPMCSlotLayout : std::uint8_t { Padded, Compact };
+
+template <typename T, MPMCSlotLayout Layout = MPMCSlotLayout::Padded>
 class MPMCQueue {
     static_assert(std::is_trivially_copyable_v<T>,
         "MPMCQueue<T>: T must be trivially copyable.");
 
+    static constexpr std::size_t pow2_at_least(std::size_t n) {
+        std::size_t p = 1;
+        while (p < n) p <<= 1;
+        return p;
+    }
+
+    static constexpr std::size_t RAW_SLOT = sizeof(std::atomic<std::size_t>) + sizeof(T);
+    static constexpr std::size_t SLOT_ALIGN =
+        Layout == MPMCSlotLayout::Padded || RAW_SLOT > CACHE_LINE_SIZE
+            ? CACHE_LINE_SIZE : std::max(alignof(T), pow2_at_least(RAW_SLOT));
+
     // Each slot holds the data and a sequence number.
     // The sequence number encodes whether the slot is:
     //   empty (seq == slot_index)        -> enqueuer can claim it
     //   filled (seq == slot_index + 1)   -> dequeuer can consume it
     struct Slot {
-        alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> seq;
+        alignas(SLOT_ALIGN) std::atomic<std::size_t> seq;
         T data;
     };
 
 public:
-    explicit MPMCQueue(std::size_t capacity = DEFAULT_QUEUE_CAPACITY)
+    static constexpr std::size_t SLOTS_PER_LINE =
+        sizeof(Slot) >= CACHE_LINE_SIZE ? 1 : CACHE_LINE_SIZE / sizeof(Slot);
+
+    explicit MPMCQueue(std::size_t capacity = DEFAULT_QUEUE_CAPACITY,
+                       const MemoryPolicy& policy = default_memory_policy())
         : capacity_(capacity)
         , mask_(capacity - 1)
-        , buffer_(static_cast<Slot*>(
-            ::operator new(capacity * sizeof(Slot),
-                           std::align_val_t{CACHE_LINE_SIZE})))
+        , buffer_(static_cast<Slot*>(PageAllocator::instance().allocate(
+            capacity * sizeof(Slot), CACHE_LINE_SIZE, policy)))
     {
         assert(capacity >= 2);
         assert((capacity & (capacity - 1)) == 0 &&
                "MPMCQueue capacity must be a power of 2");
+        // Scramble: position i lives at line (i mod lines), offset (i / lines).
+        std::size_t per_line = std::min(SLOTS_PER_LINE, capacity);
+        while ((std::size_t{1} << slot_shift_) < per_line) ++slot_shift_;
+        while ((capacity >> (slot_shift_ + line_shift_)) > 1) ++line_shift_;
+        line_mask_ = (capacity >> slot_shift_) - 1;
         for (std::size_t i = 0; i < capacity; ++i) {
-            buffer_[i].seq.store(i, std::memory_order_relaxed);
+            buffer_[index(i)].seq.store(i, std::memory_order_relaxed);
         }
     }
 
     ~MPMCQueue() {
-        ::operator delete(buffer_,
-            std::align_val_t{CACHE_LINE_SIZE});
+        PageAllocator::instance().deallocate(buffer_, capacity_ * sizeof(Slot),
+                                             CACHE_LINE_SIZE);
     }
 
     MPMCQueue(const MPMCQueue&)            = delete;
@@ -51,7 +89,7 @@ public:
     [[nodiscard]] bool try_push(const T& val) noexcept {
         std::size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
         for (;;) {
-            Slot& slot = buffer_[pos & mask_];
+            Slot& slot = buffer_[index(pos)];
             std::size_t seq = slot.seq.load(std::memory_order_acquire);
             std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq)
                                 - static_cast<std::ptrdiff_t>(pos);
@@ -75,7 +113,7 @@ public:
     [[nodiscard]] bool try_pop(T* out) noexcept {
         std::size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
         for (;;) {
-            Slot& slot = buffer_[pos & mask_];
+            Slot& slot = buffer_[index(pos)];
             std::size_t seq = slot.seq.load(std::memory_order_acquire);
             std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq)
                                 - static_cast<std::ptrdiff_t>(pos + 1);
@@ -95,6 +133,80 @@ public:
         }
     }
 
+    // try_push_n: claims a run of up to n consecutive free slots with a single
+    // CAS on enqueue_pos_, then fills them and publishes each slot's seq.
+    // Returns the number of elements pushed (0 if the queue is full). Elements
+    // from one call land contiguously and in order, so a lone producer's batch
+    // is never interleaved with another producer's.
+    [[nodiscard]] std::size_t try_push_n(const T* vals, std::size_t n) noexcept {
+        if (n == 0) return 0;
+        std::size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            std::size_t seq = buffer_[index(pos)].seq.load(std::memory_order_acquire);
+            std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq)
+                                - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                // First slot is free; extend the run while later slots are
+                // free for this lap too.
+                std::size_t count = 1;
+                while (count < n &&
+                       buffer_[index(pos + count)].seq.load(
+                           std::memory_order_acquire) == pos + count) {
+                    ++count;
+                }
+                if (enqueue_pos_.compare_exchange_weak(
+                        pos, pos + count, std::memory_order_relaxed)) {
+                    for (std::size_t i = 0; i < count; ++i) {
+                        Slot& slot = buffer_[index(pos + i)];
+                        slot.data = vals[i];
+                        slot.seq.store(pos + i + 1, std::memory_order_release);
+                    }
+                    return count;
+                }
+                // CAS failed — pos was reloaded by compare_exchange; retry.
+            } else if (diff < 0) {
+                return 0; // Queue is full.
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // try_pop_n: claims a run of up to max consecutive filled slots with a
+    // single CAS on dequeue_pos_ and copies them out in FIFO order. Returns
+    // the number of elements popped (0 if the queue is empty).
+    [[nodiscard]] std::size_t try_pop_n(T* out, std::size_t max) noexcept {
+        if (max == 0) return 0;
+        std::size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            std::size_t seq = buffer_[index(pos)].seq.load(std::memory_order_acquire);
+            std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq)
+                                - static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0) {
+                std::size_t count = 1;
+                while (count < max &&
+                       buffer_[index(pos + count)].seq.load(
+                           std::memory_order_acquire) == pos + count + 1) {
+                    ++count;
+                }
+                if (dequeue_pos_.compare_exchange_weak(
+                        pos, pos + count, std::memory_order_relaxed)) {
+                    for (std::size_t i = 0; i < count; ++i) {
+                        Slot& slot = buffer_[index(pos + i)];
+                        out[i] = slot.data;
+                        slot.seq.store(pos + i + mask_ + 1,
+                                       std::memory_order_release);
+                    }
+                    return count;
+                }
+            } else if (diff < 0) {
+                return 0; // Queue is empty.
+            } else {
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
     std::optional<T> pop() noexcept {
         T val;
         if (try_pop(&val)) return val;
@@ -110,10 +222,25 @@ public:
 
     [[nodiscard]] std::size_t capacity() const noexcept { return capacity_; }
 
+    // Approximate, like occupancy().
+    [[nodiscard]] bool empty() const noexcept {
+        return enqueue_pos_.load(std::memory_order_acquire)
+            == dequeue_pos_.load(std::memory_order_acquire);
+    }
+
 private:
+    std::size_t index(std::size_t pos) const noexcept {
+        const std::size_t i = pos & mask_;
+        if constexpr (SLOTS_PER_LINE == 1) return i;
+        else return ((i & line_mask_) << slot_shift_) | (i >> line_shift_);
+    }
+
     const std::size_t capacity_;
     const std::size_t mask_;
     Slot*             buffer_;
+    unsigned          slot_shift_{0};   // log2(slots per line)
+    unsigned          line_shift_{0};   // log2(lines)
+    std::size_t       line_mask_{0};
 
     alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> enqueue_pos_{0};
     alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> dequeue_pos_{0};
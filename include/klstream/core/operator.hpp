@@ -31,9 +31,13 @@ enum class OpStatus : std::uint8_t {
 //   3. Runtime calls tick() in a tight loop for the operator's lifetime.
 //   4. Runtime calls shutdown() once when stopping (after setting stop flag).
 //
-// Threading: init(), tick(), and shutdown() are always called from the same
-// worker thread. The operator does not need to protect its own state with
-// locks — the queues are the synchronisation boundary.
+// Threading: init(), tick(), and shutdown() are never called concurrently.
+// Under the default RoundRobin policy init() and tick() always run on the
+// same worker thread, unless rebalancing migrates the operator; under
+// WorkStealing, tick() may move between workers. Each hand-over is
+// synchronised by the scheduler (scheduler.hpp, worker.hpp). Either
+// way the operator does not need to protect its own state with locks — the
+// queues are the synchronisation boundary.
 //
 // The operator OWNS a "pending" slot: when tick() returns Blocked, it means
 // the operator has popped an event from its input queue and stored it in an
@@ -54,13 +58,58 @@ public:
     // Called once after the stop flag is set. Flush, close files, etc.
     virtual void shutdown() {}
 
+    // Cheap hint: could tick() make progress now (input waiting, or output
+    // held from a Blocked tick)? The work-stealing scheduler parks an
+    // operator that returned Idle until this is true. The default, true,
+    // means "unknown" and keeps the operator polled every round.
+    [[nodiscard]] virtual bool ready() const noexcept { return true; }
+
+    // IdleStrategy::Park: have every input queue's producer notify `p`
+    // (SPSCQueue::set_waker), so a parked worker wakes when input arrives.
+    // Operators without input queues keep the default no-op.
+    virtual void wake_on_input(class Parker* /*p*/) {}
+
+    // The scheduler is about to stop ticking this operator for a while
+    // (parked until ready(), or its worker asleep). Nothing is held across
+    // this point unless the operator holds it itself.
+    virtual void on_park() {}
+
+    // Hand every output event straight to `next`, which reads this
+    // operator's output queue, instead of pushing it there (see fusion.hpp).
+    // Returns false if either side cannot be fused. Must be called before
+    // the runtime starts; `next` must then not be ticked.
+    virtual bool fuse_downstream(IOperator* /*next*/) { return false; }
+
     virtual void attach_metrics(struct OperatorMetrics*) {}
 
+    // Checkpointing (checkpoint.hpp). An operator with state worth keeping
+    // across a restart keeps the port Checkpointer::add() hands it and
+    // returns true; its tick() then drives the port, which calls
+    // snapshot() on the operator's thread when the operator is aligned on
+    // a barrier. restore() reads back what snapshot() wrote, before the
+    // runtime starts. The default has no state and refuses.
+    virtual bool attach_checkpoint(class CheckpointPort* /*port*/) { return false; }
+    virtual void snapshot(class StateWriter& /*out*/) const {}
+    virtual void restore(class StateReader& /*in*/) {}
+
     const std::string& name() const { return name_; }
 
     // Unique integer ID assigned by the Runtime at registration time.
     std::uint64_t id = 0;
 
+    // Set by TraceRecorder::trace_operator(): the worker then times a sample
+    // of this operator's ticks (trace.hpp). Set before the runtime starts.
+    class OpTrace* trace = nullptr;
+
+    // Where the worker adds hardware counter deltas of a sample of this
+    // operator's ticks (perf_counters.hpp); usually &OperatorMetrics::perf.
+    // Set before the runtime starts (StreamGraph::profile).
+    struct PerfMetrics* perf = nullptr;
+
+    // Where the worker adds the estimated busy time of this operator's
+    // ticks (metrics.hpp); set by Runtime::start() when rebalancing is on.
+    struct OpLoad* load = nullptr;
+
 private:
     std::string name_;
 };
@@ -0,0 +1,246 @@
+// include/klstream/core/page_alloc.hpp
+#pragma once
+#include "config.hpp"
+#include "pinning.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#if defined(__linux__)
+#  include <sys/mman.h>
+#  include <unistd.h>
+#  define KLSTREAM_HAS_PAGE_ALLOC 1
+#endif
+
+namespace klstream {
+
+// ── MemoryPolicy ─────────────────────────────────────────────────────────
+//
+// How a core structure's long-lived buffer (queue ring, pool slab, forest
+// image) is backed. The default is what those structures always did —
+// aligned operator new, pages faulted in by whoever touches them first,
+// usually the hot loop just after Runtime::start().
+//
+//   pages     Default      ordinary pages
+//             Transparent  2 MB-aligned, madvise(MADV_HUGEPAGE): the kernel
+//                          backs it with transparent huge pages if it can
+//             Huge         MAP_HUGETLB from the reserved pool
+//                          (vm.nr_hugepages); falls back to Transparent when
+//                          the pool cannot supply it
+//   prefault  touch every page at allocation, so no fault is left for the
+//             hot loop (after the NUMA binding, so pages land on the node)
+//   lock      mlock() the memory; refused when RLIMIT_MEMLOCK is too small,
+//             which is counted (PageAllocator::stats()), not an error
+//   numa_node bind the pages there before they are faulted (-1 = no binding)
+struct MemoryPolicy {
+    enum class Pages : std::uint8_t { Default, Transparent, Huge };
+
+    Pages pages     = Pages::Default;
+    bool  prefault  = false;
+    bool  lock      = false;
+    int   numa_node = -1;
+
+    bool is_default() const noexcept {
+        return pages == Pages::Default && !prefault && !lock && numa_node < 0;
+    }
+    bool operator==(const MemoryPolicy& o) const noexcept {
+        return pages == o.pages && prefault == o.prefault && lock == o.lock && numa_node == o.numa_node;
+    }
+};
+
+// The policy SPSCQueue, MPMCQueue, WindowBatchPool and FlatForest use when
+// none is passed. Set it once in main(), before building the pipeline; it
+// is not synchronised.
+inline MemoryPolicy& default_memory_policy() noexcept {
+    static MemoryPolicy policy;
+    return policy;
+}
+
+// ── PageAllocator ────────────────────────────────────────────────────────
+//
+// Backs allocations according to a MemoryPolicy. The default policy goes
+// straight to aligned operator new. Any other is served from anonymous
+// mappings in 2 MB chunks; small buffers with the same policy share a
+// chunk. That sharing is what makes huge pages pay here: a dozen 300 KB
+// rings fit one 2 MB page, one TLB entry instead of nearly a thousand.
+// A buffer of a chunk or more gets a mapping of its own, rounded up to
+// whole chunk-sized pages. A chunk is unmapped when its last buffer is
+// freed.
+//
+// Allocation is construction-time work and takes a mutex; nothing here is
+// on a hot path. Without mmap (non-Linux) every policy is the default.
+class PageAllocator {
+public:
+    static constexpr std::size_t CHUNK_BYTES = std::size_t{2} << 20;   // one x86-64 / arm64 huge page
+
+    struct Stats {
+        std::uint64_t mapped_bytes     = 0;   // currently mapped by policy allocations
+        std::uint64_t hugetlb_bytes    = 0;   // of which MAP_HUGETLB
+        std::uint64_t thp_bytes        = 0;   // of which advised MADV_HUGEPAGE
+        std::uint64_t prefaulted_bytes = 0;   // total touched at allocation
+        std::uint64_t locked_bytes     = 0;   // currently mlock()ed
+        std::uint64_t lock_failures    = 0;
+        std::uint64_t hugetlb_fallbacks = 0;  // Huge served as Transparent
+        std::uint64_t chunks           = 0;   // live mappings
+    };
+
+    static PageAllocator& instance() {
+        static PageAllocator a;
+        return a;
+    }
+
+    // `align` must be at most the system page size.
+    void* allocate(std::size_t bytes, std::size_t align,
+                   const MemoryPolicy& policy = default_memory_policy()) {
+        bytes = std::max<std::size_t>(bytes, 1);
+#if defined(KLSTREAM_HAS_PAGE_ALLOC)
+        if (!policy.is_default()) return allocate_mapped(bytes, align, policy);
+#endif
+        return ::operator new(bytes, std::align_val_t{align});
+    }
+
+    void deallocate(void* p, std::size_t bytes, std::size_t align) noexcept {
+        if (!p) return;
+        (void)bytes;
+#if defined(KLSTREAM_HAS_PAGE_ALLOC)
+        if (live_mapped_.load(std::memory_order_acquire) > 0) {
+            std::lock_guard<std::mutex> lk(mu_);
+            auto it = owner_.find(p);
+            if (it != owner_.end()) {
+                Chunk* c = it->second;
+                owner_.erase(it);
+                live_mapped_.fetch_sub(1, std::memory_order_release);
+                if (--c->live == 0) unmap(c);
+                return;
+            }
+        }
+#endif
+        ::operator delete(p, std::align_val_t{align});
+    }
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> lk(mu_);
+        return stats_;
+    }
+
+private:
+    struct Chunk {
+        char*        base = nullptr;
+        std::size_t  size = 0;
+        std::size_t  used = 0;
+        std::size_t  live = 0;
+        MemoryPolicy policy;
+        bool         hugetlb = false;
+        bool         thp     = false;
+        bool         locked  = false;
+        bool         shared  = false;   // small buffers may be added
+    };
+
+    PageAllocator() = default;
+
+    static std::size_t round_up(std::size_t n, std::size_t a) { return (n + a - 1) / a * a; }
+
+#if defined(KLSTREAM_HAS_PAGE_ALLOC)
+    void* allocate_mapped(std::size_t bytes, std::size_t align, const MemoryPolicy& policy) {
+        std::lock_guard<std::mutex> lk(mu_);
+        Chunk* c = nullptr;
+        std::size_t at = 0;
+        if (bytes < CHUNK_BYTES) {
+            for (auto& ch : chunks_) {
+                if (!ch->shared || !(ch->policy == policy)) continue;
+                const std::size_t off = round_up(ch->used, align);
+                if (off + bytes <= ch->size) { c = ch.get(); at = off; break; }
+            }
+        }
+        if (!c) {
+            c = map(bytes < CHUNK_BYTES ? CHUNK_BYTES : round_up(bytes, CHUNK_BYTES), policy);
+            c->shared = bytes < CHUNK_BYTES;
+        }
+        c->used = at + bytes;
+        ++c->live;
+        void* p = c->base + at;
+        owner_.emplace(p, c);
+        live_mapped_.fetch_add(1, std::memory_order_release);
+        return p;
+    }
+
+    Chunk* map(std::size_t size, const MemoryPolicy& policy) {
+        auto chunk = std::make_unique<Chunk>();
+        Chunk& c = *chunk;
+        c.policy = policy;
+        c.size   = size;
+        void* p = MAP_FAILED;
+        if (policy.pages == MemoryPolicy::Pages::Huge) {
+            p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (p != MAP_FAILED) c.hugetlb = true;
+            else ++stats_.hugetlb_fallbacks;
+        }
+        if (p == MAP_FAILED) {
+            if (policy.pages == MemoryPolicy::Pages::Default) {
+                p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                if (p == MAP_FAILED) throw std::bad_alloc();
+            } else {
+                p = map_aligned(size);
+                c.thp = ::madvise(p, size, MADV_HUGEPAGE) == 0;
+            }
+        }
+        c.base = static_cast<char*>(p);
+        if (policy.numa_node >= 0) bind_to_numa_node(c.base, size, policy.numa_node);
+        if (policy.prefault) {
+            // One write per page: a hugetlb or THP chunk faults 2 MB at a time.
+            const std::size_t step = c.hugetlb ? CHUNK_BYTES : static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+            for (std::size_t off = 0; off < size; off += step)
+                static_cast<volatile char*>(p)[off] = 0;
+            stats_.prefaulted_bytes += size;
+        }
+        if (policy.lock) {
+            c.locked = ::mlock(p, size) == 0;
+            if (c.locked) stats_.locked_bytes += size;
+            else ++stats_.lock_failures;
+        }
+        stats_.mapped_bytes += size;
+        if (c.hugetlb) stats_.hugetlb_bytes += size;
+        if (c.thp) stats_.thp_bytes += size;
+        ++stats_.chunks;
+        chunks_.push_back(std::move(chunk));
+        return chunks_.back().get();
+    }
+
+    // A 2 MB-aligned range — THP only backs whole aligned huge pages.
+    static void* map_aligned(std::size_t size) {
+        void* raw = ::mmap(nullptr, size + CHUNK_BYTES, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) throw std::bad_alloc();
+        const auto r = reinterpret_cast<std::uintptr_t>(raw);
+        const auto a = round_up(r, CHUNK_BYTES);
+        if (a > r) ::munmap(raw, a - r);
+        if (CHUNK_BYTES - (a - r) > 0) ::munmap(reinterpret_cast<void*>(a + size), CHUNK_BYTES - (a - r));
+        return reinterpret_cast<void*>(a);
+    }
+
+    void unmap(Chunk* c) noexcept {
+        ::munmap(c->base, c->size);
+        stats_.mapped_bytes -= c->size;
+        if (c->hugetlb) stats_.hugetlb_bytes -= c->size;
+        if (c->thp) stats_.thp_bytes -= c->size;
+        if (c->locked) stats_.locked_bytes -= c->size;
+        --stats_.chunks;
+        chunks_.erase(std::find_if(chunks_.begin(), chunks_.end(),
+                                   [c](const std::unique_ptr<Chunk>& p) { return p.get() == c; }));
+    }
+#endif
+
+    mutable std::mutex                  mu_;
+    std::vector<std::unique_ptr<Chunk>> chunks_;
+    std::map<void*, Chunk*>             owner_;
+    std::atomic<std::size_t>            live_mapped_{0};
+    Stats                               stats_;
+};
+
+} // namespace klstream
@@ -0,0 +1,113 @@
+// include/klstream/core/parker.hpp
+#pragma once
+#include "config.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#if defined(__linux__)
+#  include <climits>
+#  include <ctime>
+#  include <linux/futex.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#  define KLSTREAM_HAS_FUTEX 1
+#else
+#  include <condition_variable>
+#  include <mutex>
+#endif
+
+namespace klstream {
+
+// ── IdleStrategy ─────────────────────────────────────────────────────────
+//
+// What a worker does once its spin/yield ladder runs out with nothing to do:
+//   Backoff — sleep SLEEP_NS and poll again (the default; lowest latency,
+//             but every idle worker keeps waking up)
+//   Park    — block on the worker's Parker until a producer pushes into one
+//             of its operators' input queues, or PARK_TIMEOUT_NS passes.
+//             Idle pipelines cost no CPU; the first event of a burst pays
+//             one futex wake.
+enum class IdleStrategy : std::uint8_t {
+    Backoff = 0,
+    Park    = 1,
+};
+
+// ── Parker ───────────────────────────────────────────────────────────────
+//
+// An eventcount: lets a consumer sleep until "something may have changed"
+// without producers paying for it while nobody sleeps.
+//
+// Consumer:                             Producer (after publishing data):
+//   key = prepare();                      notify();
+//   if (work is visible) cancel();
+//   else wait(key);
+//
+// notify() is a fence plus one relaxed load of the sleeper count, and only
+// when that count is non-zero a futex wake. prepare() registers the sleeper
+// with a seq_cst RMW before the consumer's final look for work, so either
+// that look sees the producer's data or the producer sees the sleeper and
+// bumps the epoch — in which case wait() returns at once, since the futex
+// word no longer equals the key. No wake-up is lost.
+//
+// Futex on Linux; a mutex + condition variable elsewhere (slow path only).
+class Parker {
+public:
+    std::uint32_t prepare() noexcept {
+        sleepers_.fetch_add(1, std::memory_order_seq_cst);
+        return epoch_.load(std::memory_order_seq_cst);
+    }
+
+    void cancel() noexcept { sleepers_.fetch_sub(1, std::memory_order_relaxed); }
+
+    // Sleeps until notified after prepare() returned `key`, or `timeout`.
+    void wait(std::uint32_t key, std::chrono::nanoseconds timeout) noexcept {
+#if defined(KLSTREAM_HAS_FUTEX)
+        timespec ts{ static_cast<time_t>(timeout.count() / 1'000'000'000),
+                     static_cast<long>(timeout.count() % 1'000'000'000) };
+        ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&epoch_),
+                  FUTEX_WAIT_PRIVATE, key, &ts, nullptr, 0);
+#else
+        std::unique_lock<std::mutex> lk(mu_);
+        cv_.wait_for(lk, timeout, [&] { return epoch_.load(std::memory_order_acquire) != key; });
+#endif
+        sleepers_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    // Producer side: wakes every sleeper, if there is any.
+    void notify() noexcept {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleepers_.load(std::memory_order_relaxed) == 0) return;
+        wake_all();
+    }
+
+    // Unconditional wake (e.g. on stop).
+    void wake_all() noexcept {
+        epoch_.fetch_add(1, std::memory_order_release);
+#if defined(KLSTREAM_HAS_FUTEX)
+        ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&epoch_),
+                  FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+#else
+        { std::lock_guard<std::mutex> lk(mu_); }
+        cv_.notify_all();
+#endif
+        wakes_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Times a producer actually had to wake someone.
+    std::uint64_t wakes() const noexcept { return wakes_.load(std::memory_order_relaxed); }
+
+private:
+    static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t),
+                  "futex word must be a plain 32-bit integer");
+
+    alignas(CACHE_LINE_SIZE) std::atomic<std::uint32_t> epoch_{0};      // the futex word
+    alignas(CACHE_LINE_SIZE) std::atomic<std::uint32_t> sleepers_{0};
+    std::atomic<std::uint64_t>                          wakes_{0};
+#if !defined(KLSTREAM_HAS_FUTEX)
+    std::mutex              mu_;
+    std::condition_variable cv_;
+#endif
+};
+
+} // namespace klstream
@@ -0,0 +1,141 @@
+// include/klstream/core/perf_counters.hpp
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__linux__)
+#  include <linux/perf_event.h>
+#  include <sys/ioctl.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#  define KLSTREAM_HAS_PERF_EVENTS 1
+#endif
+
+namespace klstream {
+
+// ── PerfCounts ────────────────────────────────────────────────────────────
+//
+// One reading of the hardware counters of PerfCounterGroup, or the
+// difference of two. A counter the CPU or kernel does not offer reads 0.
+struct PerfCounts {
+    std::uint64_t cycles{0};
+    std::uint64_t instructions{0};
+    std::uint64_t cache_misses{0};     // last-level cache
+    std::uint64_t branch_misses{0};
+    std::uint64_t l1d_misses{0};       // L1 data cache read misses
+    std::uint64_t stalled_cycles{0};   // backend (memory / execution) stalls
+
+    PerfCounts operator-(const PerfCounts& o) const noexcept {
+        return { cycles - o.cycles, instructions - o.instructions, cache_misses - o.cache_misses,
+                 branch_misses - o.branch_misses, l1d_misses - o.l1d_misses,
+                 stalled_cycles - o.stalled_cycles };
+    }
+};
+
+// ── PerfCounterGroup ──────────────────────────────────────────────────────
+//
+// The calling thread's hardware counters, opened with perf_event_open(2) as
+// one group so that all of them count over the same intervals (the kernel
+// schedules a group onto the PMU together, even when it has to multiplex).
+// User space only (exclude_kernel), which perf_event_paranoid <= 2 — the
+// default — allows without privileges.
+//
+// open() is best effort: it returns false, and read() then always fails,
+// when perf events are unavailable — no PMU (most VMs and containers),
+// perf_event_paranoid = 3, seccomp, or not Linux (macOS has no equivalent
+// without entitlements). Counters the CPU lacks — stalled cycles on many
+// cores — are left out of the group and read 0.
+//
+// One read() costs a system call, ~0.5–1 µs; WorkerThread therefore reads
+// around a sample of ticks only (PERF_SAMPLE_EVERY).
+class PerfCounterGroup {
+public:
+    PerfCounterGroup() = default;
+    PerfCounterGroup(const PerfCounterGroup&)            = delete;
+    PerfCounterGroup& operator=(const PerfCounterGroup&) = delete;
+    ~PerfCounterGroup() { close(); }
+
+    // Opens the counters for the calling thread; they count from here on
+    // while this thread runs. Returns available().
+    bool open() noexcept {
+#if defined(KLSTREAM_HAS_PERF_EVENTS)
+        close();
+        const std::uint64_t hw_cache_l1d_read_miss =
+            PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+            | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        const struct { std::uint32_t type; std::uint64_t config; } events[N] = {
+            { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+            { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+            { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+            { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+            { PERF_TYPE_HW_CACHE, hw_cache_l1d_read_miss },
+            { PERF_TYPE_HARDWARE, PERF_COUNT_HW_STALLED_CYCLES_BACKEND },
+        };
+        for (std::size_t i = 0; i < N; ++i) {
+            perf_event_attr attr{};
+            attr.size           = sizeof(attr);
+            attr.type           = events[i].type;
+            attr.config         = events[i].config;
+            attr.disabled       = leader_ < 0 ? 1 : 0;   // the group starts with its leader
+            attr.exclude_kernel = 1;
+            attr.exclude_hv     = 1;
+            attr.read_format    = PERF_FORMAT_GROUP | PERF_FORMAT_ID;
+            const int fd = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, leader_, 0));
+            if (fd < 0) {
+                if (i == 0) return false;                  // no cycle counter: nothing usable
+                continue;
+            }
+            if (leader_ < 0) leader_ = fd;
+            fds_[i] = fd;
+            if (::ioctl(fd, PERF_EVENT_IOC_ID, &ids_[i]) != 0) ids_[i] = 0;
+        }
+        ::ioctl(leader_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ::ioctl(leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    bool available() const noexcept { return leader_ >= 0; }
+
+    // Current totals since open(). False if the group is not available.
+    bool read(PerfCounts& out) const noexcept {
+#if defined(KLSTREAM_HAS_PERF_EVENTS)
+        if (leader_ < 0) return false;
+        struct { std::uint64_t nr; struct { std::uint64_t value, id; } v[N]; } buf;
+        if (::read(leader_, &buf, sizeof(buf)) <= 0) return false;
+        std::uint64_t* fields[N] = { &out.cycles, &out.instructions, &out.cache_misses,
+                                     &out.branch_misses, &out.l1d_misses, &out.stalled_cycles };
+        for (std::size_t i = 0; i < N; ++i) *fields[i] = 0;
+        for (std::uint64_t k = 0; k < buf.nr && k < N; ++k) {
+            for (std::size_t i = 0; i < N; ++i) {
+                if (fds_[i] >= 0 && ids_[i] == buf.v[k].id) *fields[i] = buf.v[k].value;
+            }
+        }
+        return true;
+#else
+        (void)out;
+        return false;
+#endif
+    }
+
+    void close() noexcept {
+#if defined(KLSTREAM_HAS_PERF_EVENTS)
+        for (std::size_t i = 0; i < N; ++i) {
+            if (fds_[i] >= 0) ::close(fds_[i]);
+            fds_[i] = -1;
+        }
+#endif
+        leader_ = -1;
+    }
+
+private:
+    static constexpr std::size_t N = 6;
+
+    int           leader_{-1};
+    int           fds_[N]{ -1, -1, -1, -1, -1, -1 };
+    std::uint64_t ids_[N]{};
+};
+
+} // namespace klstream
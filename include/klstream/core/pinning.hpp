@@ -1,10 +1,24 @@
 // include/klstream/core/pinning.hpp
 #pragma once
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
 
-// macOS-specific QoS thread affinity. Compiles to no-ops on other platforms.
+// Platform thread-placement APIs: QoS classes on macOS, CPU affinity and
+// NUMA memory policy on Linux. Compiles to no-ops elsewhere.
 #if defined(__APPLE__)
 #  include <pthread.h>
+#elif defined(__linux__)
+#  include <pthread.h>
+#  include <sched.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#  include <linux/mempolicy.h>
+#  define KLSTREAM_HAS_LINUX_AFFINITY 1
 #endif
 
 namespace klstream {
@@ -19,20 +33,249 @@ namespace klstream {
 // Use Efficiency for lightweight operators (Source with rate limiting,
 // simple Filter, Sink that just counts or writes a counter).
 // Use Any to let the OS decide (default — identical to not calling anything).
+//
+// On Linux the hint becomes a CPU set from CpuTopology::cpus_for().
 enum class CoreAffinity : std::uint8_t {
     Any         = 0,  // OS-managed (default).
     Performance = 1,  // Prefer P-cores (QOS_CLASS_USER_INTERACTIVE on macOS).
     Efficiency  = 2,  // Prefer E-cores (QOS_CLASS_BACKGROUND on macOS).
 };
 
+// Parses a sysfs CPU/node list such as "0-3,8,10-11". Malformed pieces are
+// skipped.
+inline std::vector<int> parse_cpu_list(const std::string& s) {
+    std::vector<int> out;
+    std::size_t at = 0;
+    while (at < s.size()) {
+        std::size_t end = s.find(',', at);
+        if (end == std::string::npos) end = s.size();
+        const std::string part = s.substr(at, end - at);
+        at = end + 1;
+        try {
+            const std::size_t dash = part.find('-');
+            const int lo = std::stoi(part.substr(0, dash));
+            const int hi = dash == std::string::npos ? lo : std::stoi(part.substr(dash + 1));
+            for (int c = lo; c <= hi; ++c) out.push_back(c);
+        } catch (...) {
+            // whitespace, trailing newline, empty list
+        }
+    }
+    return out;
+}
+
+// ── CpuTopology ──────────────────────────────────────────────────────────
+//
+// The host's logical CPUs with what placement needs to know about each:
+// its physical core (SMT siblings share one), NUMA node, and whether it is
+// an efficiency core on a hybrid part.
+//
+// Discovered from sysfs on Linux:
+//   system/cpu/online, system/cpu/cpuN/topology/{core_id,physical_package_id,
+//   thread_siblings_list}, system/node/nodeM/cpulist, and for hybrid parts
+//   either cpu_atom/cpus (Intel) or a below-maximum system/cpu/cpuN/cpu_capacity
+//   (Arm big.LITTLE). Elsewhere: hardware_concurrency() CPUs on one node.
+class CpuTopology {
+public:
+    struct Cpu {
+        int  id;
+        int  core;          // physical core, unique across packages
+        int  node;          // NUMA node (0 if unknown)
+        bool efficiency;    // E-core on a hybrid part
+        bool smt_primary;   // lowest-numbered thread of its core
+    };
+
+    // The running host, discovered once.
+    static const CpuTopology& system() {
+        static const CpuTopology t = discover();
+        return t;
+    }
+
+    static CpuTopology discover() {
+#if defined(__linux__)
+        CpuTopology t = from_sysfs("/sys/devices");
+        if (!t.cpus_.empty()) return t;
+#endif
+        return flat(std::max(1u, std::thread::hardware_concurrency()));
+    }
+
+    // `root` is normally /sys/devices; tests point it at a fake tree.
+    static CpuTopology from_sysfs(const std::string& root) {
+        CpuTopology t;
+        const std::string cpu_dir = root + "/system/cpu/";
+        const auto online = parse_cpu_list(read_line(cpu_dir + "online"));
+        const auto atoms  = parse_cpu_list(read_line(root + "/cpu_atom/cpus"));
+
+        std::vector<long> capacity;
+        for (int id : online) {
+            const std::string topo = cpu_dir + "cpu" + std::to_string(id) + "/topology/";
+            const int package = read_int(topo + "physical_package_id", 0);
+            const int core_id = read_int(topo + "core_id", id);
+            const auto sibs   = parse_cpu_list(read_line(topo + "thread_siblings_list"));
+            Cpu c{};
+            c.id          = id;
+            c.core        = (package << 16) | (core_id & 0xFFFF);
+            c.node        = 0;
+            c.efficiency  = std::find(atoms.begin(), atoms.end(), id) != atoms.end();
+            c.smt_primary = sibs.empty() || *std::min_element(sibs.begin(), sibs.end()) == id;
+            t.cpus_.push_back(c);
+            capacity.push_back(read_int(cpu_dir + "cpu" + std::to_string(id) + "/cpu_capacity", 0));
+        }
+        if (atoms.empty() && !capacity.empty()) {
+            const long top = *std::max_element(capacity.begin(), capacity.end());
+            for (std::size_t i = 0; i < t.cpus_.size(); ++i) {
+                t.cpus_[i].efficiency = capacity[i] > 0 && capacity[i] < top;
+            }
+        }
+
+        for (int node : parse_cpu_list(read_line(root + "/system/node/online"))) {
+            const auto list = parse_cpu_list(
+                read_line(root + "/system/node/node" + std::to_string(node) + "/cpulist"));
+            for (auto& c : t.cpus_) {
+                if (std::find(list.begin(), list.end(), c.id) != list.end()) c.node = node;
+            }
+            t.n_nodes_ = std::max(t.n_nodes_, node + 1);
+        }
+        return t;
+    }
+
+    // n CPUs, one node, no SMT, no hybrid.
+    static CpuTopology flat(unsigned n) {
+        CpuTopology t;
+        for (unsigned i = 0; i < n; ++i) {
+            const int id = static_cast<int>(i);
+            t.cpus_.push_back(Cpu{ id, id, 0, false, true });
+        }
+        return t;
+    }
+
+    const std::vector<Cpu>& cpus() const noexcept { return cpus_; }
+    int  n_nodes() const noexcept { return n_nodes_; }
+    bool hybrid() const noexcept {
+        return std::any_of(cpus_.begin(), cpus_.end(), [](const Cpu& c) { return c.efficiency; });
+    }
+
+    // The CPU set a CoreAffinity hint maps to:
+    //   Performance — one thread per non-efficiency core, so a pinned
+    //                 operator never shares a core's pipeline with a sibling;
+    //   Efficiency  — the E-cores on a hybrid part; otherwise the secondary
+    //                 SMT threads, which the Performance set leaves free;
+    //                 otherwise every CPU;
+    //   Any         — every CPU.
+    // Never empty.
+    std::vector<int> cpus_for(CoreAffinity a) const {
+        std::vector<int> out;
+        auto pick = [&](auto pred) {
+            out.clear();
+            for (const auto& c : cpus_) if (pred(c)) out.push_back(c.id);
+            return !out.empty();
+        };
+        switch (a) {
+            case CoreAffinity::Performance:
+                if (pick([](const Cpu& c) { return !c.efficiency && c.smt_primary; })) return out;
+                if (pick([](const Cpu& c) { return !c.efficiency; })) return out;
+                break;
+            case CoreAffinity::Efficiency:
+                if (hybrid()) { pick([](const Cpu& c) { return c.efficiency; }); return out; }
+                if (pick([](const Cpu& c) { return !c.smt_primary; })) return out;
+                break;
+            case CoreAffinity::Any:
+            default:
+                break;
+        }
+        pick([](const Cpu&) { return true; });
+        return out;
+    }
+
+    std::vector<int> cpus_on_node(int node) const {
+        std::vector<int> out;
+        for (const auto& c : cpus_) if (c.node == node) out.push_back(c.id);
+        return out;
+    }
+
+    // NUMA node of `cpu`, or -1 if it is not in the topology.
+    int node_of(int cpu) const noexcept {
+        for (const auto& c : cpus_) if (c.id == cpu) return c.node;
+        return -1;
+    }
+
+private:
+    static std::string read_line(const std::string& path) {
+        std::ifstream in(path);
+        std::string s;
+        std::getline(in, s);
+        return s;
+    }
+    static int read_int(const std::string& path, int fallback) {
+        try { return std::stoi(read_line(path)); } catch (...) { return fallback; }
+    }
+
+    std::vector<Cpu> cpus_;
+    int              n_nodes_{1};
+};
+
+// ── pin_current_thread / NUMA memory ─────────────────────────────────────
+//
+// The Linux primitives behind WorkerPlacement. All return false where the
+// platform has no such control or the kernel refuses (a CPU outside the
+// container's cpuset, NUMA syscalls filtered); callers treat that as "left
+// to the OS", never as an error.
+
+// Restricts the calling thread to `cpus`.
+inline bool pin_current_thread(const std::vector<int>& cpus) noexcept {
+#if defined(KLSTREAM_HAS_LINUX_AFFINITY)
+    if (cpus.empty()) return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int c : cpus) if (c >= 0 && c < CPU_SETSIZE) CPU_SET(c, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpus;
+    return false;
+#endif
+}
+
+// Makes `node` the preferred node for the calling thread's future page
+// allocations (set_mempolicy MPOL_PREFERRED) — operator state allocated in
+// init() and anything the worker allocates later lands there.
+inline bool prefer_numa_node(int node) noexcept {
+#if defined(KLSTREAM_HAS_LINUX_AFFINITY)
+    if (node < 0 || node >= 64) return false;
+    const unsigned long mask = 1UL << node;
+    return ::syscall(SYS_set_mempolicy, MPOL_PREFERRED, &mask, 64UL) == 0;
+#else
+    (void)node;
+    return false;
+#endif
+}
+
+// Moves the pages of [p, p + bytes) to `node` and keeps future faults there
+// (mbind MPOL_PREFERRED | MPOL_MF_MOVE). For memory allocated before its
+// consumer thread exists, e.g. queue rings built in main(). The range is
+// widened to whole pages, so neighbouring small allocations may move too.
+inline bool bind_to_numa_node(const void* p, std::size_t bytes, int node) noexcept {
+#if defined(KLSTREAM_HAS_LINUX_AFFINITY)
+    if (!p || bytes == 0 || node < 0 || node >= 64) return false;
+    static const std::uintptr_t page = static_cast<std::uintptr_t>(::sysconf(_SC_PAGESIZE));
+    const auto begin = reinterpret_cast<std::uintptr_t>(p) / page * page;
+    const auto end   = reinterpret_cast<std::uintptr_t>(p) + bytes;
+    const unsigned long mask = 1UL << node;
+    return ::syscall(SYS_mbind, begin, end - begin, MPOL_PREFERRED, &mask, 64UL,
+                     MPOL_MF_MOVE) == 0;
+#else
+    (void)p; (void)bytes; (void)node;
+    return false;
+#endif
+}
+
 // ── apply_affinity ────────────────────────────────────────────────────────
 //
 // Call this at the START of a worker thread's execution (before any work).
-// It sets the calling thread's QoS class so the macOS scheduler routes it
-// to the requested core type.
+// On macOS it sets the calling thread's QoS class so the scheduler routes
+// it to the requested core type; on Linux it pins the thread to
+// CpuTopology::system().cpus_for(affinity). Any leaves the thread alone.
 //
-// On non-Apple platforms this is a compile-time no-op. The rest of the
-// codebase never calls any platform-specific API directly — only this function.
+// Elsewhere this is a compile-time no-op. The rest of the codebase never
+// calls any platform-specific API directly — only the functions in this file.
 inline void apply_affinity(CoreAffinity affinity) noexcept {
 #if defined(__APPLE__)
     switch (affinity) {
@@ -46,11 +289,63 @@ inline void apply_affinity(CoreAffinity affinity) noexcept {
         default:
             break; // Leave the OS to decide.
     }
+#elif defined(KLSTREAM_HAS_LINUX_AFFINITY)
+    if (affinity == CoreAffinity::Any) return;
+    try {
+        pin_current_thread(CpuTopology::system().cpus_for(affinity));
+    } catch (...) {
+        // Topology discovery allocates; stay unpinned rather than terminate.
+    }
 #else
     (void)affinity; // Suppress unused-parameter warning.
 #endif
 }
 
+// ── WorkerPlacement ──────────────────────────────────────────────────────
+//
+// Where a worker thread runs and allocates. Most specific wins:
+//   cpus non-empty  — pin to exactly these logical CPUs;
+//   numa_node >= 0  — pin to that node's CPUs (narrowed to the affinity
+//                     class's CPUs on the node, when there are any);
+//   otherwise       — apply_affinity(affinity).
+// With numa_node >= 0, or cpus that all sit on one node, the thread's page
+// allocations also prefer that node.
+struct WorkerPlacement {
+    CoreAffinity     affinity{CoreAffinity::Any};
+    std::vector<int> cpus;
+    int              numa_node{-1};
+};
+
+// Applies `p` to the calling thread. Returns false if a requested pin or
+// memory policy could not be applied.
+inline bool apply_placement(const WorkerPlacement& p) noexcept {
+    if (p.cpus.empty() && p.numa_node < 0) {
+        apply_affinity(p.affinity);
+        return true;
+    }
+    try {
+        const CpuTopology& topo = CpuTopology::system();
+        std::vector<int> set = p.cpus;
+        int node = p.numa_node;
+        if (set.empty()) {
+            set = topo.cpus_on_node(node);
+            std::vector<int> narrowed;
+            for (int c : topo.cpus_for(p.affinity)) {
+                if (topo.node_of(c) == node) narrowed.push_back(c);
+            }
+            if (!narrowed.empty()) set = std::move(narrowed);
+        } else if (node < 0) {
+            node = topo.node_of(set.front());
+            for (int c : set) if (topo.node_of(c) != node) { node = -1; break; }
+        }
+        bool ok = pin_current_thread(set);
+        if (node >= 0 && topo.n_nodes() > 1) ok = prefer_numa_node(node) && ok;
+        return ok;
+    } catch (...) {
+        return false;
+    }
+}
+
 // ── AffinityMap ──────────────────────────────────────────────────────────
 //
 // Convenience struct used by Runtime (Section 7.10) to pair an operator ID
@@ -0,0 +1,152 @@
+// include/klstream/core/rcu.hpp
+#pragma once
+#include "config.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace klstream {
+
+// ── RcuCell<T> ────────────────────────────────────────────────────────────
+//
+// A read-mostly pointer to an immutable T that a control thread can replace
+// while operator threads keep reading — used to roll a new IsolationForest
+// into a running InferenceOp without a restart.
+//
+// Reclamation is quiescent-state based (QSBR). Each reading operator owns a
+// Reader and, between units of work (one window for InferenceOp), calls
+// quiescent() to declare "I hold no T* obtained before this point". A
+// retired T is deleted once every registered Reader has declared a
+// quiescent state after it was retired.
+//
+// Reader cost per unit of work: get() is one acquire load of the pointer;
+// quiescent() is one acquire load of the global epoch plus one release
+// store to the reader's own cache line. No RMW, no shared writes, nothing
+// the writer can make a reader wait for.
+//
+// Writer side (publish / reclaim) takes a mutex that readers never touch,
+// and never blocks on readers: an old T that is still in use simply stays
+// on the retired list until a later reclaim() finds it free.
+//
+// A reader that stops calling quiescent() (a stalled or finished worker)
+// holds back reclamation; call Reader::offline() when it is done for good.
+// Readers must be created before, and T* must not be used after, the
+// RcuCell itself is destroyed.
+template <typename T>
+class RcuCell {
+    struct alignas(CACHE_LINE_SIZE) Slot {
+        std::atomic<std::uint64_t> seen{0};
+    };
+
+    // Reader marked offline: never holds anything back.
+    static constexpr std::uint64_t OFFLINE = UINT64_MAX;
+
+public:
+    class Reader {
+    public:
+        // The current T. Stays valid until this reader's next quiescent().
+        const T* get() const noexcept {
+            return cell_->current_.load(std::memory_order_acquire);
+        }
+
+        // Every T* this reader obtained so far is no longer in use.
+        void quiescent() noexcept {
+            slot_->seen.store(cell_->epoch_.load(std::memory_order_acquire),
+                              std::memory_order_release);
+        }
+
+        // Permanently quiescent (e.g. at operator shutdown).
+        void offline() noexcept {
+            slot_->seen.store(OFFLINE, std::memory_order_release);
+        }
+
+    private:
+        friend class RcuCell;
+        Reader(RcuCell* cell, Slot* slot) : cell_(cell), slot_(slot) {}
+        RcuCell* cell_;
+        Slot*    slot_;
+    };
+
+    explicit RcuCell(std::unique_ptr<const T> initial)
+        : current_(initial.release())
+    {}
+
+    RcuCell(const RcuCell&)            = delete;
+    RcuCell& operator=(const RcuCell&) = delete;
+
+    ~RcuCell() {
+        delete current_.load(std::memory_order_relaxed);
+        for (auto& r : retired_) delete r.ptr;
+    }
+
+    // Called once per reading operator, normally before Runtime::start().
+    // The returned Reader lives as long as this RcuCell.
+    Reader& make_reader() {
+        std::lock_guard<std::mutex> lk(mu_);
+        Slot& s = slots_.emplace_back();
+        s.seen.store(epoch_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        readers_.push_back(Reader(this, &s));
+        return readers_.back();
+    }
+
+    // Swaps in `next` and retires the previous T. Never waits for readers;
+    // returns the new version number (1 for the first publish).
+    std::uint64_t publish(std::unique_ptr<const T> next) {
+        std::lock_guard<std::mutex> lk(mu_);
+        const T* old = current_.exchange(next.release(), std::memory_order_acq_rel);
+        // A reader that loads an epoch >= e has synchronised with this
+        // increment, so its next get() already sees `next`.
+        const std::uint64_t e = epoch_.fetch_add(1, std::memory_order_acq_rel) + 1;
+        retired_.push_back({ old, e });
+        reclaim_locked();
+        return e;
+    }
+
+    // Frees every retired T that no reader can still hold. Returns how many
+    // are still pending.
+    std::size_t reclaim() {
+        std::lock_guard<std::mutex> lk(mu_);
+        return reclaim_locked();
+    }
+
+    // Number of publishes so far (0 = still the initial T).
+    std::uint64_t version() const noexcept {
+        return epoch_.load(std::memory_order_acquire);
+    }
+
+private:
+    struct Retired {
+        const T*      ptr;
+        std::uint64_t epoch;   // free once every reader has seen >= epoch
+    };
+
+    std::size_t reclaim_locked() {
+        std::uint64_t min_seen = OFFLINE;
+        for (const auto& s : slots_) {
+            min_seen = std::min(min_seen, s.seen.load(std::memory_order_acquire));
+        }
+        std::size_t kept = 0;
+        for (auto& r : retired_) {
+            if (r.epoch <= min_seen) delete r.ptr;
+            else retired_[kept++] = r;
+        }
+        retired_.resize(kept);
+        return kept;
+    }
+
+    std::atomic<const T*>      current_;
+    std::atomic<std::uint64_t> epoch_{0};
+
+    std::mutex           mu_;        // writer side only
+    std::deque<Slot>     slots_;     // deque: stable addresses on growth
+    std::deque<Reader>   readers_;
+    std::vector<Retired> retired_;
+};
+
+} // namespace klstream
@@ -0,0 +1,134 @@
+// include/klstream/core/rebalancer.hpp
+#pragma once
+#include "config.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace klstream {
+
+// ── RebalancePolicy ──────────────────────────────────────────────────────
+//
+// When the Runtime moves an operator to another worker at run time
+// (Runtime::set_rebalancing). Loads are shares of one interval: an
+// operator's is its estimated busy time (OpLoad) over the interval, a
+// worker's the sum of its operators'.
+//
+//   interval_ns  how often loads are compared; 0 = never on its own, only
+//                Runtime::migrate()
+//   split_above  a worker at least this loaded sheds an operator to the
+//                least loaded worker...
+//   min_gain     ...if that lowers the busier of the two by at least this
+//   merge_below  two workers whose loads sum below this are packed onto
+//                one, an operator per interval, so the stages share a core
+//                and its cache (0 = off); keep it well under split_above,
+//                or a split and a merge undo each other
+//   max_blocked  an operator whose ticks are more than this share Blocked
+//                (OperatorMetrics, Runtime::observe) stays put: it waits on
+//                its consumer, and moving it frees no time
+//   cooldown     intervals an operator stays put after a move
+struct RebalancePolicy {
+    std::uint64_t interval_ns = REBALANCE_INTERVAL_NS;
+    double        split_above = 0.85;
+    double        min_gain    = 0.10;
+    double        merge_below = 0.0;
+    double        max_blocked = 0.50;
+    unsigned      cooldown    = 3;
+};
+
+// One operator as the rebalancer sees it over the last interval.
+struct OperatorLoad {
+    int    worker  = 0;
+    double load    = 0.0;   // busy share of the interval
+    double blocked = 0.0;   // Blocked share of its ticks that were not Idle
+};
+
+struct Migration {
+    std::size_t op;         // index into the plan() argument
+    int         from;
+    int         to;
+};
+
+// ── Rebalancer ───────────────────────────────────────────────────────────
+//
+// The decision half of rebalancing: given every operator's load, at most
+// one move per interval — greedy, the move that most lowers the busiest
+// worker's load. One operator is the unit; a single operator that
+// saturates its worker cannot be split here (replicate it in the graph,
+// Stream::parallel_map). Not thread-safe; the Runtime calls it from its
+// rebalancing thread.
+class Rebalancer {
+public:
+    Rebalancer(RebalancePolicy policy, std::size_t n_workers)
+        : policy_(policy), n_workers_(n_workers) {}
+
+    std::optional<Migration> plan(const std::vector<OperatorLoad>& ops) {
+        if (quiet_.size() < ops.size()) quiet_.resize(ops.size(), 0);
+        for (auto& q : quiet_) if (q) --q;
+        if (n_workers_ < 2) return std::nullopt;
+
+        std::vector<double>      load(n_workers_, 0.0);
+        std::vector<std::size_t> count(n_workers_, 0);
+        for (const auto& o : ops) {
+            load[static_cast<std::size_t>(o.worker)] += o.load;
+            ++count[static_cast<std::size_t>(o.worker)];
+        }
+        auto m = split(ops, load, count);
+        if (!m) m = merge(ops, load, count);
+        if (m) quiet_[m->op] = policy_.cooldown;
+        return m;
+    }
+
+    const RebalancePolicy& policy() const noexcept { return policy_; }
+
+private:
+    std::optional<Migration> split(const std::vector<OperatorLoad>& ops, const std::vector<double>& load,
+                                   const std::vector<std::size_t>& count) const {
+        const auto hot  = static_cast<std::size_t>(std::max_element(load.begin(), load.end()) - load.begin());
+        const auto cold = static_cast<std::size_t>(std::min_element(load.begin(), load.end()) - load.begin());
+        if (hot == cold || load[hot] < policy_.split_above || count[hot] < 2) return std::nullopt;
+
+        std::optional<Migration> best;
+        double best_gain = policy_.min_gain;
+        for (std::size_t i = 0; i < ops.size(); ++i) {
+            const auto& o = ops[i];
+            if (static_cast<std::size_t>(o.worker) != hot || quiet_[i] || o.blocked > policy_.max_blocked) continue;
+            const double after = std::max(load[hot] - o.load, load[cold] + o.load);
+            const double gain  = load[hot] - after;
+            if (gain >= best_gain) {
+                best_gain = gain;
+                best = Migration{ i, static_cast<int>(hot), static_cast<int>(cold) };
+            }
+        }
+        return best;
+    }
+
+    // The lightest operator of the least loaded busy worker moves to the
+    // next least loaded one, if together they stay under merge_below.
+    std::optional<Migration> merge(const std::vector<OperatorLoad>& ops, const std::vector<double>& load,
+                                   const std::vector<std::size_t>& count) const {
+        if (policy_.merge_below <= 0.0) return std::nullopt;
+        std::size_t a = n_workers_, b = n_workers_;
+        for (std::size_t w = 0; w < n_workers_; ++w) {
+            if (count[w] == 0) continue;
+            if (a == n_workers_ || load[w] < load[a]) { b = a; a = w; }
+            else if (b == n_workers_ || load[w] < load[b]) b = w;
+        }
+        if (b == n_workers_ || load[a] + load[b] >= policy_.merge_below) return std::nullopt;
+
+        std::optional<Migration> best;
+        for (std::size_t i = 0; i < ops.size(); ++i) {
+            if (static_cast<std::size_t>(ops[i].worker) != a || quiet_[i]) continue;
+            if (!best || ops[i].load < ops[best->op].load) best = Migration{ i, static_cast<int>(a), static_cast<int>(b) };
+        }
+        return best;
+    }
+
+    RebalancePolicy       policy_;
+    std::size_t           n_workers_;
+    std::vector<unsigned> quiet_;   // per operator: intervals left in cooldown
+};
+
+} // namespace klstream
@@ -3,11 +3,19 @@
 #include "operator.hpp"
 #include "pinning.hpp"
 #include "worker.hpp"
+#include "scheduler.hpp"
 #include "metrics.hpp"
+#include "rebalancer.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <cstdint>
+#include <deque>
 #include <memory>
+#include <mutex>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
@@ -34,6 +42,7 @@ struct OperatorRegistration {
 //   klstream::Runtime rt;
 //   rt.add_worker();                         // Worker 0
 //   rt.add_worker();                         // Worker 1
+//   rt.add_worker(WorkerPlacement{ CoreAffinity::Any, {}, 1 });  // Worker 2, NUMA node 1
 //   rt.register_op(&my_source, 0, CoreAffinity::Efficiency);
 //   rt.register_op(&my_map,    0, CoreAffinity::Performance);
 //   rt.register_op(&my_sink,   1, CoreAffinity::Efficiency);
@@ -43,8 +52,26 @@ struct OperatorRegistration {
 //   rt.wait_for(std::chrono::seconds(10));
 //   rt.stop();
 //
+// Scheduling: by default each worker ticks exactly the operators registered
+// on it (SchedulingPolicy::RoundRobin). After
+// set_scheduling_policy(SchedulingPolicy::WorkStealing), the worker_id given
+// to register_op() is only the operator's home: idle workers steal runnable
+// operators from busy ones (see WorkerThread).
+//
+// Fusion: after set_operator_fusion(true), start() fuses each operator into
+// its upstream neighbour when both are registered on the same worker and
+// fuse_downstream() accepts the pair (see fusion.hpp) — e.g. source and
+// filter on worker 0 above become one scheduled unit with no queue between.
+//
+// Rebalancing: after set_rebalancing(), operators can move between workers
+// while the pipeline runs — by migrate(), or by a thread that compares the
+// workers' loads every interval and moves operators off the busiest one
+// (rebalancer.hpp). A move waits for a safe point between two of the
+// operator's ticks, so no event is lost or reordered (see WorkerThread).
+//
 // Thread safety: add_worker(), register_op(), start(), stop(), and wait_for()
-// must all be called from the same thread (typically main()).
+// must all be called from the same thread (typically main()); migrate(),
+// worker_of() and migrations() from any.
 class Runtime {
 public:
     // Add a worker thread slot. Returns its 0-based index.
@@ -55,6 +82,33 @@ public:
         return idx;
     }
 
+    // Add a worker pinned to explicit CPUs and/or a NUMA node. Returns its
+    // 0-based index.
+    int add_worker(WorkerPlacement placement) {
+        int idx = static_cast<int>(workers_.size());
+        workers_.emplace_back(std::make_unique<WorkerThread>());
+        workers_.back()->set_placement(std::move(placement));
+        return idx;
+    }
+
+    // NUMA node worker_id will run on, or -1 if it is not tied to one. Used
+    // to place a queue ring on its consumer's node (SPSCQueue::bind_to_numa_node).
+    int worker_numa_node(int worker_id) const {
+        const WorkerPlacement& p = workers_.at(static_cast<std::size_t>(worker_id))->placement();
+        if (p.numa_node >= 0) return p.numa_node;
+        if (p.cpus.empty()) return -1;
+        const CpuTopology& topo = CpuTopology::system();
+        const int node = topo.node_of(p.cpus.front());
+        for (int c : p.cpus) if (topo.node_of(c) != node) return -1;
+        return node;
+    }
+
+    std::size_t n_workers() const noexcept { return workers_.size(); }
+
+    const WorkerThread& worker(int worker_id) const {
+        return *workers_.at(static_cast<std::size_t>(worker_id));
+    }
+
     // Register an operator with a specific worker thread.
     void register_op(IOperator* op, int worker_id,
                      CoreAffinity affinity = CoreAffinity::Any)
@@ -71,16 +125,154 @@ public:
             workers_[worker_id]->set_affinity(affinity);
         }
         workers_[worker_id]->assign(op);
+        registrations_.push_back({ op, affinity, worker_id });
     }
 
     MetricsReporter& metrics() { return reporter_; }
 
+    // Must be called BEFORE start().
+    void set_scheduling_policy(SchedulingPolicy p) {
+        if (started_) throw std::logic_error("Runtime::set_scheduling_policy() after start()");
+        policy_ = p;
+    }
+    SchedulingPolicy scheduling_policy() const noexcept { return policy_; }
+
+    // IdleStrategy::Park puts idle workers to sleep until input arrives
+    // (see parker.hpp). Must be called BEFORE start().
+    void set_idle_strategy(IdleStrategy s) {
+        if (started_) throw std::logic_error("Runtime::set_idle_strategy() after start()");
+        idle_ = s;
+    }
+
+    // Fuse co-located stateless operators at start() (see fusion.hpp).
+    // Must be called BEFORE start().
+    void set_operator_fusion(bool on) {
+        if (started_) throw std::logic_error("Runtime::set_operator_fusion() after start()");
+        fusion_ = on;
+    }
+
+    // Let operators move between workers while running (RoundRobin only):
+    // migrate(), and, unless p.interval_ns is 0, moves made per `p`.
+    // Workers then time a sample of every operator's ticks (OpLoad); with
+    // IdleStrategy::Park they share one Parker, as stealing workers do,
+    // since a queue's waker cannot follow its consumer to another worker.
+    // Must be called BEFORE start().
+    void set_rebalancing(RebalancePolicy p = {}) {
+        if (started_) throw std::logic_error("Runtime::set_rebalancing() after start()");
+        rebalancing_ = true;
+        rebalance_   = p;
+    }
+
+    // Have the rebalancer read op's Blocked share from `m`
+    // (RebalancePolicy::max_blocked). Must be called BEFORE start().
+    void observe(IOperator* op, const OperatorMetrics* m) {
+        if (started_) throw std::logic_error("Runtime::observe() after start()");
+        observed_[op] = m;
+    }
+
+    // Move `op` to worker_id at its current worker's next safe point.
+    // Returns false, doing nothing, if op is not scheduled on its own (or
+    // fused away), already on worker_id, or still moving. Valid after
+    // start() with rebalancing on.
+    bool migrate(IOperator* op, int worker_id) {
+        if (!started_ || !rebalancing_) {
+            throw std::logic_error("Runtime::migrate() needs set_rebalancing() and start()");
+        }
+        if (worker_id < 0 || worker_id >= static_cast<int>(workers_.size())) {
+            throw std::out_of_range("Runtime::migrate: invalid worker_id " + std::to_string(worker_id));
+        }
+        std::lock_guard<std::mutex> lk(move_mu_);
+        Placed* p = placed(op);
+        if (!p) return false;
+        const int from = p->worker.load(std::memory_order_relaxed);
+        if (from == worker_id || p->moving.load(std::memory_order_acquire)) return false;
+        p->moving.store(true, std::memory_order_relaxed);
+        p->worker.store(worker_id, std::memory_order_relaxed);
+        workers_[static_cast<std::size_t>(from)]->release(op, workers_[static_cast<std::size_t>(worker_id)].get(),
+                                                          &p->moving);
+        return true;
+    }
+
+    // The worker op runs on, or is moving to; -1 if it is not registered.
+    int worker_of(const IOperator* op) const {
+        for (const auto& p : placed_) if (p.op == op) return p.worker.load(std::memory_order_relaxed);
+        for (const auto& r : registrations_) if (r.op == op) return r.worker_id;
+        return -1;
+    }
+
+    // Operators that completed a move to another worker.
+    std::uint64_t migrations() const noexcept {
+        std::uint64_t n = 0;
+        for (const auto& w : workers_) n += w->migrations();
+        return n;
+    }
+
+    // Operators fused into an upstream neighbour at start(), and so no
+    // longer scheduled on their own.
+    std::size_t fused_ops() const noexcept { return fused_ops_; }
+
+    // Times any worker went to sleep (IdleStrategy::Park only).
+    std::uint64_t parks() const noexcept {
+        std::uint64_t n = 0;
+        for (const auto& w : workers_) n += w->parks();
+        return n;
+    }
+
     // Start all workers and the metrics reporter.
     void start() {
         if (started_) throw std::logic_error("Runtime::start() called twice");
         started_ = true;
+        if (rebalancing_ && policy_ != SchedulingPolicy::RoundRobin) {
+            throw std::logic_error("Runtime: rebalancing needs SchedulingPolicy::RoundRobin");
+        }
+        if (fusion_) fuse_co_located();
+        if (rebalancing_) {
+            for (const auto& r : registrations_) {
+                placed_.emplace_back();
+                Placed& p = placed_.back();
+                p.op = r.op;
+                p.worker.store(r.worker_id, std::memory_order_relaxed);
+                const auto it = observed_.find(r.op);
+                if (it != observed_.end()) p.metrics = it->second;
+                r.op->load = &p.load;
+            }
+        }
+        if (policy_ == SchedulingPolicy::WorkStealing && !workers_.empty()) {
+            for (const auto& r : registrations_) tasks_.push_back(ScheduledTask{ r.op });
+            group_ = std::make_unique<StealGroup>(workers_.size(), tasks_.size());
+            std::vector<std::vector<ScheduledTask*>> home(workers_.size());
+            for (std::size_t i = 0; i < registrations_.size(); ++i) {
+                home[static_cast<std::size_t>(registrations_[i].worker_id)].push_back(&tasks_[i]);
+            }
+            for (std::size_t w = 0; w < workers_.size(); ++w) {
+                workers_[w]->join_group(group_.get(), w, std::move(home[w]));
+            }
+        }
+        if (idle_ == IdleStrategy::Park) {
+            // Stealing or rebalancing: any worker may run any operator, so
+            // one Parker is shared by all; otherwise each worker has its own.
+            const bool shared = policy_ == SchedulingPolicy::WorkStealing || rebalancing_;
+            for (std::size_t w = 0; w < (shared ? 1 : workers_.size()); ++w) parkers_.emplace_back();
+            for (std::size_t w = 0; w < workers_.size(); ++w) {
+                workers_[w]->set_parker(&parkers_[shared ? 0 : w]);
+            }
+            for (const auto& r : registrations_) {
+                r.op->wake_on_input(&parkers_[shared ? 0 : static_cast<std::size_t>(r.worker_id)]);
+            }
+        }
+        for (auto& w : workers_) reporter_.add_worker(&w->stats());
         reporter_.start();
         for (auto& w : workers_) w->start();
+        if (rebalancing_ && rebalance_.interval_ns > 0 && workers_.size() > 1) {
+            rebalancer_ = std::thread([this] { rebalance_loop(); });
+        }
+    }
+
+    // Operators taken from another worker's run queue (WorkStealing only).
+    std::uint64_t steals() const noexcept {
+        std::uint64_t n = 0;
+        for (const auto& w : workers_) n += w->steals();
+        return n;
     }
 
     // Block the calling thread until duration elapses, then return.
@@ -89,8 +281,21 @@ public:
         std::this_thread::sleep_for(duration);
     }
 
-    // Stop all workers and the metrics reporter.
+    // Stop all workers and the metrics reporter. Every worker is signalled
+    // before any is joined, and joined before any operator is shut down,
+    // so no operator is shut down while another worker could still be
+    // ticking it or handing it over.
     void stop() {
+        if (rebalancer_.joinable()) {
+            {
+                std::lock_guard<std::mutex> lk(rebalance_mu_);
+                rebalance_stop_ = true;
+            }
+            rebalance_cv_.notify_all();
+            rebalancer_.join();
+        }
+        for (auto& w : workers_) w->request_stop();
+        for (auto& w : workers_) w->join();
         for (auto& w : workers_) w->stop();
         reporter_.stop();
     }
@@ -98,10 +303,101 @@ public:
     ~Runtime() { if (started_) stop(); }
 
 private:
+    // An operator's current worker and load while rebalancing.
+    struct Placed {
+        IOperator*             op = nullptr;
+        std::atomic<int>       worker{0};
+        std::atomic<bool>      moving{false};
+        OpLoad                 load;
+        const OperatorMetrics* metrics = nullptr;
+    };
+
+    Placed* placed(const IOperator* op) {
+        for (auto& p : placed_) if (p.op == op) return &p;
+        return nullptr;
+    }
+
+    // Every interval: each operator's busy share and Blocked share since
+    // the last, then at most one move (Rebalancer::plan).
+    void rebalance_loop() {
+        Rebalancer planner(rebalance_, workers_.size());
+        struct Seen { std::uint64_t busy_ns = 0, processed = 0, blocked = 0; };
+        std::vector<Seen>         seen(placed_.size());
+        std::vector<OperatorLoad> loads(placed_.size());
+        const auto look = [this](std::size_t i) {
+            const Placed& p = placed_[i];
+            return Seen{ p.load.busy_ns.load(), p.metrics ? p.metrics->events_processed.load() : 0,
+                         p.metrics ? p.metrics->events_blocked.load() : 0 };
+        };
+        for (std::size_t i = 0; i < placed_.size(); ++i) seen[i] = look(i);
+        std::uint64_t mark = Clock::now_ns();
+
+        std::unique_lock<std::mutex> lk(rebalance_mu_);
+        while (!rebalance_cv_.wait_for(lk, std::chrono::nanoseconds(rebalance_.interval_ns),
+                                       [this] { return rebalance_stop_; })) {
+            const std::uint64_t now  = Clock::now_ns();
+            const double        span = static_cast<double>(std::max<std::uint64_t>(now - mark, 1));
+            mark = now;
+            for (std::size_t i = 0; i < placed_.size(); ++i) {
+                const Seen s = look(i);
+                const std::uint64_t ticks = (s.processed - seen[i].processed) + (s.blocked - seen[i].blocked);
+                loads[i].worker  = placed_[i].worker.load(std::memory_order_relaxed);
+                loads[i].load    = static_cast<double>(s.busy_ns - seen[i].busy_ns) / span;
+                loads[i].blocked = ticks ? static_cast<double>(s.blocked - seen[i].blocked) / static_cast<double>(ticks) : 0.0;
+                seen[i] = s;
+            }
+            if (const auto m = planner.plan(loads)) migrate(placed_[m->op].op, m->to);
+        }
+    }
+
+    // Links every registered pair (up, down) on one worker that
+    // fuse_downstream() accepts, then drops the fused-in operators from
+    // scheduling. A chain source -> filter -> map fuses pair by pair.
+    void fuse_co_located() {
+        std::vector<bool> fused(registrations_.size(), false);
+        for (const auto& up : registrations_) {
+            for (std::size_t j = 0; j < registrations_.size(); ++j) {
+                const auto& down = registrations_[j];
+                if (fused[j] || down.op == up.op || down.worker_id != up.worker_id) continue;
+                if (up.op->fuse_downstream(down.op)) {
+                    fused[j] = true;
+                    break;   // one output, so at most one consumer
+                }
+            }
+        }
+        std::vector<OperatorRegistration> kept;
+        for (std::size_t j = 0; j < registrations_.size(); ++j) {
+            if (fused[j]) {
+                workers_[static_cast<std::size_t>(registrations_[j].worker_id)]->unassign(registrations_[j].op);
+                ++fused_ops_;
+            } else {
+                kept.push_back(registrations_[j]);
+            }
+        }
+        registrations_ = std::move(kept);
+    }
+
+    std::deque<Parker>                         parkers_;  // outlive the workers that wake them
     std::vector<std::unique_ptr<WorkerThread>> workers_;
+    std::vector<OperatorRegistration>          registrations_;
+    SchedulingPolicy                           policy_{SchedulingPolicy::RoundRobin};
+    std::deque<ScheduledTask>                  tasks_;   // stable addresses
+    std::unique_ptr<StealGroup>                group_;
+    IdleStrategy                               idle_{IdleStrategy::Backoff};
+    bool                                       fusion_{false};
+    std::size_t                                fused_ops_{0};
     MetricsReporter                            reporter_;
     std::uint64_t                              next_op_id_{0};
     bool                                       started_{false};
+    bool                                       rebalancing_{false};
+    RebalancePolicy                            rebalance_;
+    std::unordered_map<IOperator*, const OperatorMetrics*> observed_;
+    std::deque<Placed>                         placed_;   // stable addresses
+    std::mutex                                 move_mu_;
+    std::thread                                rebalancer_;
+    std::mutex                                 rebalance_mu_;
+    std::condition_variable                    rebalance_cv_;
+    bool                                       rebalance_stop_{false};
 };
 
 } // namespace klstream
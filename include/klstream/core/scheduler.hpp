@@ -0,0 +1,83 @@
+// include/klstream/core/scheduler.hpp
+#pragma once
+#include "operator.hpp"
+#include "mpmc_queue.hpp"
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace klstream {
+
+// ── SchedulingPolicy ─────────────────────────────────────────────────────
+//
+//   RoundRobin   — the default: each worker ticks its registered operators
+//                  in a fixed round-robin loop, forever. Operators never
+//                  move between workers, unless rebalancing moves one
+//                  (Runtime::set_rebalancing).
+//   WorkStealing — each worker keeps a run queue of runnable operators,
+//                  starting with the ones registered on it. A worker whose
+//                  queue runs dry steals from another worker's, so a hot
+//                  stage spreads over workers that would otherwise idle.
+//                  An operator whose tick() returns Idle is parked until its
+//                  ready() hint says it has input again.
+enum class SchedulingPolicy : std::uint8_t {
+    RoundRobin   = 0,
+    WorkStealing = 1,
+};
+
+// One schedulable operator. Exactly one worker holds a task at a time —
+// either running it, or parking it — so tick() is never concurrent with
+// itself. Handing a task over through a run queue is a release/acquire
+// pair, so the next worker sees everything the last tick() wrote,
+// including the SPSC queues' cached indices.
+struct ScheduledTask {
+    IOperator* op;
+};
+
+// ── StealGroup ───────────────────────────────────────────────────────────
+//
+// The run queues of every worker in a WorkStealing runtime. Queue w is
+// pushed only by worker w (re-queueing what it just ran) and popped by w
+// and by thieves — hence MPMCQueue. Each queue can hold every task, since a
+// task is in at most one queue at a time, so a push never fails.
+class StealGroup {
+public:
+    StealGroup(std::size_t n_workers, std::size_t n_tasks) {
+        std::size_t cap = 2;
+        while (cap < n_tasks) cap <<= 1;
+        for (std::size_t w = 0; w < n_workers; ++w) {
+            queues_.push_back(std::make_unique<MPMCQueue<ScheduledTask*>>(cap));
+        }
+    }
+
+    std::size_t n_workers() const noexcept { return queues_.size(); }
+
+    void push(std::size_t w, ScheduledTask* t) noexcept {
+        [[maybe_unused]] const bool ok = queues_[w]->try_push(t);
+        assert(ok && "StealGroup: run queue sized for every task");
+    }
+
+    bool pop(std::size_t w, ScheduledTask** out) noexcept { return queues_[w]->try_pop(out); }
+
+    // Is any task waiting in any run queue? Approximate.
+    bool any_runnable() const noexcept {
+        for (const auto& q : queues_) if (!q->empty()) return true;
+        return false;
+    }
+
+    // Tries every other worker once, starting after `thief`.
+    bool steal(std::size_t thief, ScheduledTask** out) noexcept {
+        const std::size_t n = queues_.size();
+        for (std::size_t k = 1; k < n; ++k) {
+            if (queues_[(thief + k) % n]->try_pop(out)) return true;
+        }
+        return false;
+    }
+
+private:
+    std::vector<std::unique_ptr<MPMCQueue<ScheduledTask*>>> queues_;
+};
+
+} // namespace klstream
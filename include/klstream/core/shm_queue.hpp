@@ -0,0 +1,722 @@
+// include/klstream/core/shm_queue.hpp
+#pragma once
+#include "config.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#  include <fcntl.h>
+#  include <signal.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#  define KLSTREAM_HAS_SHM 1
+#endif
+
+namespace klstream {
+
+// ── ShmSegment ───────────────────────────────────────────────────────────
+//
+// A shared-memory object mapped read-write: POSIX shm_open() by name, or
+// an anonymous memfd (Linux) whose descriptor is handed to the peer by
+// fork() or over a Unix socket. The creator sizes the object; openers map
+// whatever size it has. A named segment created here is unlinked when its
+// creator's ShmSegment is destroyed (mappings already open stay valid),
+// unless release_name() was called.
+//
+// Throws std::runtime_error on any failure; on targets without POSIX
+// shared memory every constructor throws.
+class ShmSegment {
+public:
+    static ShmSegment create(const std::string& name, std::size_t bytes) {
+#if defined(KLSTREAM_HAS_SHM)
+        const int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd < 0) fail("shm_open(" + name + ", O_CREAT)");
+        if (::ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+            const int e = errno;
+            ::close(fd);
+            ::shm_unlink(name.c_str());
+            errno = e;
+            fail("ftruncate(" + name + ")");
+        }
+        ShmSegment s = map(fd, bytes, name);
+        s.owns_name_ = true;
+        return s;
+#else
+        (void)name; (void)bytes;
+        unsupported();
+#endif
+    }
+
+    static ShmSegment open(const std::string& name) {
+#if defined(KLSTREAM_HAS_SHM)
+        const int fd = ::shm_open(name.c_str(), O_RDWR, 0);
+        if (fd < 0) fail("shm_open(" + name + ")");
+        return map(fd, size_of(fd), name);
+#else
+        (void)name;
+        unsupported();
+#endif
+    }
+
+    // open(), or nothing yet while `name` does not exist or its creator
+    // has not sized it: create() is shm_open() then ftruncate(), and a
+    // peer can open the object in between.
+    static std::optional<ShmSegment> try_open(const std::string& name) {
+#if defined(KLSTREAM_HAS_SHM)
+        const int fd = ::shm_open(name.c_str(), O_RDWR, 0);
+        if (fd < 0) {
+            if (errno == ENOENT) return std::nullopt;
+            fail("shm_open(" + name + ")");
+        }
+        const std::size_t bytes = size_of(fd);
+        if (bytes == 0) {
+            ::close(fd);
+            return std::nullopt;
+        }
+        return map(fd, bytes, name);
+#else
+        (void)name;
+        unsupported();
+#endif
+    }
+
+#if defined(__linux__)
+    // An unnamed segment: pass fd() to the peer, which calls from_fd().
+    static ShmSegment create_anonymous(std::size_t bytes) {
+        const int fd = ::memfd_create("klstream-shm", MFD_CLOEXEC);
+        if (fd < 0) fail("memfd_create");
+        if (::ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+            const int e = errno;
+            ::close(fd);
+            errno = e;
+            fail("ftruncate(memfd)");
+        }
+        return map(fd, bytes, std::string());
+    }
+#endif
+
+#if defined(KLSTREAM_HAS_SHM)
+    // Maps a segment from a descriptor received from its creator; takes
+    // ownership of fd.
+    static ShmSegment from_fd(int fd) { return map(fd, size_of(fd), std::string()); }
+#endif
+
+    ShmSegment(ShmSegment&& o) noexcept
+        : base_(std::exchange(o.base_, nullptr)), size_(std::exchange(o.size_, 0))
+        , fd_(std::exchange(o.fd_, -1)), name_(std::move(o.name_))
+        , owns_name_(std::exchange(o.owns_name_, false)) {}
+
+    ShmSegment& operator=(ShmSegment&& o) noexcept {
+        if (this != &o) {
+            reset();
+            base_      = std::exchange(o.base_, nullptr);
+            size_      = std::exchange(o.size_, 0);
+            fd_        = std::exchange(o.fd_, -1);
+            name_      = std::move(o.name_);
+            owns_name_ = std::exchange(o.owns_name_, false);
+        }
+        return *this;
+    }
+
+    ShmSegment(const ShmSegment&)            = delete;
+    ShmSegment& operator=(const ShmSegment&) = delete;
+
+    ~ShmSegment() { reset(); }
+
+    void*       data() const noexcept { return base_; }
+    std::size_t size() const noexcept { return size_; }
+    int         fd() const noexcept   { return fd_; }
+    const std::string& name() const noexcept { return name_; }
+
+    // Keep the name after this object is destroyed (another process owns
+    // the segment's lifetime from now on).
+    void release_name() noexcept { owns_name_ = false; }
+
+    // Removes a named segment, e.g. one left behind by a crashed creator.
+    static void remove(const std::string& name) noexcept {
+#if defined(KLSTREAM_HAS_SHM)
+        ::shm_unlink(name.c_str());
+#else
+        (void)name;
+#endif
+    }
+
+private:
+    ShmSegment() = default;
+
+    [[noreturn]] static void fail(const std::string& what) {
+        throw std::runtime_error("ShmSegment: " + what + ": " + std::strerror(errno));
+    }
+    [[noreturn]] static void unsupported() {
+        throw std::runtime_error("ShmSegment: POSIX shared memory is not available on this platform");
+    }
+
+#if defined(KLSTREAM_HAS_SHM)
+    static std::size_t size_of(int fd) {
+        struct stat st{};
+        if (::fstat(fd, &st) != 0) {
+            const int e = errno;
+            ::close(fd);
+            errno = e;
+            fail("fstat");
+        }
+        return static_cast<std::size_t>(st.st_size);
+    }
+
+    static ShmSegment map(int fd, std::size_t bytes, std::string name) {
+        if (bytes == 0) {
+            ::close(fd);
+            errno = EINVAL;
+            fail("empty segment " + name);
+        }
+        void* p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) {
+            const int e = errno;
+            ::close(fd);
+            errno = e;
+            fail("mmap(" + name + ")");
+        }
+        ShmSegment s;
+        s.base_ = p;
+        s.size_ = bytes;
+        s.fd_   = fd;
+        s.name_ = std::move(name);
+        return s;
+    }
+#endif
+
+    void reset() noexcept {
+#if defined(KLSTREAM_HAS_SHM)
+        if (base_) ::munmap(base_, size_);
+        if (fd_ >= 0) ::close(fd_);
+        if (owns_name_ && !name_.empty()) ::shm_unlink(name_.c_str());
+#endif
+        base_ = nullptr;
+        size_ = 0;
+        fd_   = -1;
+        owns_name_ = false;
+    }
+
+    void*       base_{nullptr};
+    std::size_t size_{0};
+    int         fd_{-1};
+    std::string name_;
+    bool        owns_name_{false};
+};
+
+// ── ShmQueueHeader ───────────────────────────────────────────────────────
+//
+// The first bytes of a shared-memory queue segment. The creator fills in
+// the layout fields, then publishes `state = READY` (release); an
+// attacher waits for READY (acquire) and checks every field against its
+// own view of the queue before touching the ring, so a producer and a
+// consumer built from different sources — a different element type, a
+// changed struct, another build of this header — refuse to attach instead
+// of misreading each other's bytes.
+//
+// type_tag is the caller's name for the element type (e.g. a hash of a
+// schema string); 0 means "size and alignment only". Role slots record the
+// pid of the attached producer / consumer for the SPSC queue; a slot whose
+// process has died is reclaimed.
+struct ShmQueueHeader {
+    static constexpr char          MAGIC[8]   = { 'K', 'L', 'S', 'S', 'H', 'M', 'Q', '\0' };
+    static constexpr std::uint32_t VERSION    = 1;
+    static constexpr std::uint32_t ENDIAN_TAG = 0x01020304;
+    static constexpr std::uint32_t READY      = 0x52454459;   // "REDY"
+
+    enum Kind : std::uint32_t { SPSC = 1, MPMC = 2 };
+
+    char                       magic[8];
+    std::uint32_t              version;
+    std::uint32_t              endian_tag;
+    std::uint32_t              kind;
+    std::uint32_t              elem_size;
+    std::uint32_t              elem_align;
+    std::uint32_t              slot_size;
+    std::uint64_t              capacity;
+    std::uint64_t              type_tag;
+    std::uint64_t              ring_offset;
+    std::uint64_t              total_bytes;
+    std::atomic<std::uint32_t> state;
+    std::atomic<std::int32_t>  producer_pid;
+    std::atomic<std::int32_t>  consumer_pid;
+};
+
+enum class ShmRole : std::uint8_t { Producer, Consumer };
+
+namespace detail {
+
+static_assert(std::atomic<std::size_t>::is_always_lock_free &&
+              std::atomic<std::uint32_t>::is_always_lock_free &&
+              std::atomic<std::int32_t>::is_always_lock_free,
+              "shared-memory queues need address-free (lock-free) atomics");
+
+inline std::size_t round_up(std::size_t n, std::size_t a) { return (n + a - 1) / a * a; }
+
+inline ShmSegment create_anonymous_segment(std::size_t bytes) {
+#if defined(__linux__)
+    return ShmSegment::create_anonymous(bytes);
+#else
+    (void)bytes;
+    throw std::invalid_argument("anonymous shared-memory queues need Linux (memfd)");
+#endif
+}
+
+// Creates the segment and writes the header; the caller initialises the
+// ring, then calls publish_ready().
+template <typename Layout>
+ShmSegment create_queue_segment(const std::string& name, std::uint64_t capacity, std::uint64_t type_tag) {
+    if (capacity < 2 || (capacity & (capacity - 1)) != 0)
+        throw std::invalid_argument("shared-memory queue capacity must be a power of 2 and >= 2");
+    const std::size_t ring  = Layout::ring_offset();
+    const std::size_t total = ring + capacity * Layout::slot_size();
+    ShmSegment seg = name.empty() ? create_anonymous_segment(total) : ShmSegment::create(name, total);
+    auto* h = new (seg.data()) ShmQueueHeader{};
+    std::memcpy(h->magic, ShmQueueHeader::MAGIC, sizeof(h->magic));
+    h->version     = ShmQueueHeader::VERSION;
+    h->endian_tag  = ShmQueueHeader::ENDIAN_TAG;
+    h->kind        = Layout::KIND;
+    h->elem_size   = Layout::elem_size();
+    h->elem_align  = Layout::elem_align();
+    h->slot_size   = static_cast<std::uint32_t>(Layout::slot_size());
+    h->capacity    = capacity;
+    h->type_tag    = type_tag;
+    h->ring_offset = ring;
+    h->total_bytes = total;
+    return seg;
+}
+
+inline void publish_ready(ShmSegment& seg) noexcept {
+    static_cast<ShmQueueHeader*>(seg.data())->state.store(ShmQueueHeader::READY, std::memory_order_release);
+}
+
+// Opens a segment and validates its header against Layout; waits up to
+// `timeout` for the creator to finish initialising it.
+template <typename Layout>
+ShmSegment attach_queue_segment(ShmSegment seg, std::uint64_t type_tag, std::chrono::milliseconds timeout) {
+    auto bad = [&](const std::string& why) -> void {
+        throw std::runtime_error("shared-memory queue " + seg.name() + ": " + why);
+    };
+    if (seg.size() < sizeof(ShmQueueHeader)) bad("segment smaller than its header");
+    const auto* h = static_cast<const ShmQueueHeader*>(seg.data());
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (h->state.load(std::memory_order_acquire) != ShmQueueHeader::READY) {
+        if (std::chrono::steady_clock::now() >= deadline) bad("creator never finished initialising it");
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    if (std::memcmp(h->magic, ShmQueueHeader::MAGIC, sizeof(h->magic)) != 0) bad("bad magic");
+    if (h->version != ShmQueueHeader::VERSION) bad("unsupported version " + std::to_string(h->version));
+    if (h->endian_tag != ShmQueueHeader::ENDIAN_TAG) bad("created with another byte order");
+    if (h->kind != Layout::KIND) bad("queue kind mismatch (SPSC vs MPMC)");
+    if (h->elem_size != Layout::elem_size() || h->elem_align != Layout::elem_align())
+        bad("element layout mismatch: segment has " + std::to_string(h->elem_size) + " bytes / align " +
+            std::to_string(h->elem_align) + ", expected " + std::to_string(Layout::elem_size()) +
+            " / " + std::to_string(Layout::elem_align()));
+    if (h->slot_size != Layout::slot_size() || h->ring_offset != Layout::ring_offset())
+        bad("header layout mismatch (built with a different CACHE_LINE_SIZE?)");
+    if (h->type_tag != type_tag) bad("element type tag mismatch");
+    if (h->capacity < 2 || (h->capacity & (h->capacity - 1)) != 0) bad("corrupt capacity");
+    if (h->total_bytes != seg.size() || h->ring_offset + h->capacity * h->slot_size != h->total_bytes)
+        bad("segment size does not match its header");
+    return seg;
+}
+
+// Opens the segment `name` and attaches as above, all within `timeout`:
+// the attacher may arrive before the creator has created or sized it.
+template <typename Layout>
+ShmSegment attach_queue_segment(const std::string& name, std::uint64_t type_tag, std::chrono::milliseconds timeout) {
+    using std::chrono::steady_clock;
+    const auto deadline = steady_clock::now() + timeout;
+    for (;;) {
+        if (auto seg = ShmSegment::try_open(name)) {
+            const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - steady_clock::now());
+            return attach_queue_segment<Layout>(std::move(*seg), type_tag, std::max(left, std::chrono::milliseconds(0)));
+        }
+        if (steady_clock::now() >= deadline)
+            throw std::runtime_error("shared-memory queue " + name + ": never created, or never sized");
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+}
+
+inline bool process_alive(std::int32_t pid) noexcept {
+#if defined(KLSTREAM_HAS_SHM)
+    return pid > 0 && (::kill(pid, 0) == 0 || errno != ESRCH);
+#else
+    return pid > 0;
+#endif
+}
+
+inline std::int32_t self_pid() noexcept {
+#if defined(KLSTREAM_HAS_SHM)
+    return static_cast<std::int32_t>(::getpid());
+#else
+    return 1;
+#endif
+}
+
+// Takes the role slot for this process; a slot held by a dead process is
+// taken over.
+inline void claim_role(std::atomic<std::int32_t>& slot, const char* role, const std::string& name) {
+    const std::int32_t me = self_pid();
+    std::int32_t cur = 0;
+    while (!slot.compare_exchange_strong(cur, me, std::memory_order_acq_rel)) {
+        if (process_alive(cur))
+            throw std::runtime_error("shared-memory queue " + name + ": " + role +
+                                     " already attached (pid " + std::to_string(cur) + ")");
+    }
+}
+
+} // namespace detail
+
+// ── ShmSPSCQueue<T> ──────────────────────────────────────────────────────
+//
+// SPSCQueue with its ring and indices in a shared-memory segment, so the
+// producer and consumer can be different processes — a feed handler
+// feeding a detection engine, each deployed and restarted on its own,
+// with no socket in between.
+//
+// The protocol is SPSCQueue's, unchanged: write_idx_ / read_idx_ on their
+// own cache lines in the segment (release/acquire), and each side's cached
+// copy of the other's index in its own process, so the fast path touches
+// only lines the other side is not writing. The API is SPSCQueue's too,
+// claim()/publish() included, minus set_waker(): a Parker lives in one
+// process, so a consumer in another polls (IdleStrategy::Park still works,
+// bounded by PARK_TIMEOUT_NS). Operators take SPSCQueue, so a pipeline
+// crosses the boundary through ShmPublishOperator / ShmSubscribeOperator.
+//
+// Either side may create the segment (create()) and the other attach()
+// — by name, or by memfd descriptor (from_fd()). Each handle holds one
+// role; the segment accepts one live producer and one live consumer and
+// refuses a second of either. T must be trivially copyable and must not
+// contain pointers, which mean nothing in the other process.
+template <typename T>
+class ShmSPSCQueue {
+    static_assert(std::is_trivially_copyable_v<T>,
+        "ShmSPSCQueue<T>: T must be trivially copyable.");
+
+public:
+    // Creates the segment `name` ("/…"; empty = anonymous memfd, see fd())
+    // and takes `role` on it.
+    static ShmSPSCQueue create(const std::string& name, std::size_t capacity, ShmRole role,
+                               std::uint64_t type_tag = 0) {
+        ShmSegment seg = detail::create_queue_segment<Layout>(name, capacity, type_tag);
+        new (static_cast<char*>(seg.data()) + INDICES_OFFSET) Indices{};
+        detail::publish_ready(seg);
+        return ShmSPSCQueue(std::move(seg), role);
+    }
+
+    // Attaches to a segment another process creates, waiting up to
+    // `timeout` (by name: for it to be created, too).
+    static ShmSPSCQueue attach(const std::string& name, ShmRole role, std::uint64_t type_tag = 0,
+                               std::chrono::milliseconds timeout = std::chrono::seconds(5)) {
+        return ShmSPSCQueue(detail::attach_queue_segment<Layout>(name, type_tag, timeout), role);
+    }
+
+    static ShmSPSCQueue attach(ShmSegment seg, ShmRole role, std::uint64_t type_tag = 0,
+                               std::chrono::milliseconds timeout = std::chrono::seconds(5)) {
+        return ShmSPSCQueue(detail::attach_queue_segment<Layout>(std::move(seg), type_tag, timeout), role);
+    }
+
+    ShmSPSCQueue(ShmSPSCQueue&& o) noexcept
+        : seg_(std::move(o.seg_)), header_(std::exchange(o.header_, nullptr))
+        , idx_(o.idx_), buffer_(o.buffer_), capacity_(o.capacity_), role_(o.role_)
+        , write_idx_cached_(o.write_idx_cached_), read_idx_cached_(o.read_idx_cached_) {}
+
+    ShmSPSCQueue(const ShmSPSCQueue&)            = delete;
+    ShmSPSCQueue& operator=(const ShmSPSCQueue&) = delete;
+    ShmSPSCQueue& operator=(ShmSPSCQueue&&)      = delete;
+
+    ~ShmSPSCQueue() {
+        if (!header_) return;
+        std::int32_t me = detail::self_pid();
+        role_slot().compare_exchange_strong(me, 0, std::memory_order_acq_rel);
+    }
+
+    // ── Producer side ─────────────────────────────────────────────────────
+
+    [[nodiscard]] bool try_push(const T& val) noexcept {
+        const std::size_t wi = idx_->write_idx.load(std::memory_order_relaxed);
+        const std::size_t next_wi = (wi + 1) & (capacity_ - 1);
+        if (next_wi == write_idx_cached_) {
+            write_idx_cached_ = idx_->read_idx.load(std::memory_order_acquire);
+            if (next_wi == write_idx_cached_) return false;
+        }
+        buffer_[wi] = val;
+        idx_->write_idx.store(next_wi, std::memory_order_release);
+        return true;
+    }
+
+    [[nodiscard]] std::size_t try_push_n(const T* vals, std::size_t n) noexcept {
+        const std::size_t wi = idx_->write_idx.load(std::memory_order_relaxed);
+        std::size_t free = (write_idx_cached_ - wi - 1) & (capacity_ - 1);
+        if (free < n) {
+            write_idx_cached_ = idx_->read_idx.load(std::memory_order_acquire);
+            free = (write_idx_cached_ - wi - 1) & (capacity_ - 1);
+        }
+        const std::size_t count = n < free ? n : free;
+        if (count == 0) return 0;
+        const std::size_t first = std::min(count, capacity_ - wi);
+        std::copy_n(vals, first, buffer_ + wi);
+        std::copy_n(vals + first, count - first, buffer_);
+        idx_->write_idx.store((wi + count) & (capacity_ - 1), std::memory_order_release);
+        return count;
+    }
+
+    // As SPSCQueue::claim / publish.
+    [[nodiscard]] T* claim(std::size_t n, std::size_t* claimed) noexcept {
+        const std::size_t wi = idx_->write_idx.load(std::memory_order_relaxed);
+        std::size_t free = (write_idx_cached_ - wi - 1) & (capacity_ - 1);
+        if (free < n) {
+            write_idx_cached_ = idx_->read_idx.load(std::memory_order_acquire);
+            free = (write_idx_cached_ - wi - 1) & (capacity_ - 1);
+        }
+        *claimed = std::min({ n, free, capacity_ - wi });
+        return buffer_ + wi;
+    }
+
+    void publish(std::size_t k) noexcept {
+        if (k == 0) return;
+        const std::size_t wi = idx_->write_idx.load(std::memory_order_relaxed);
+        idx_->write_idx.store((wi + k) & (capacity_ - 1), std::memory_order_release);
+    }
+
+    // ── Consumer side ─────────────────────────────────────────────────────
+
+    [[nodiscard]] bool try_pop(T* out) noexcept {
+        const std::size_t ri = idx_->read_idx.load(std::memory_order_relaxed);
+        if (ri == read_idx_cached_) {
+            read_idx_cached_ = idx_->write_idx.load(std::memory_order_acquire);
+            if (ri == read_idx_cached_) return false;
+        }
+        *out = buffer_[ri];
+        idx_->read_idx.store((ri + 1) & (capacity_ - 1), std::memory_order_release);
+        return true;
+    }
+
+    [[nodiscard]] std::size_t try_pop_n(T* out, std::size_t max) noexcept {
+        const std::size_t ri = idx_->read_idx.load(std::memory_order_relaxed);
+        std::size_t avail = (read_idx_cached_ - ri) & (capacity_ - 1);
+        if (avail < max) {
+            read_idx_cached_ = idx_->write_idx.load(std::memory_order_acquire);
+            avail = (read_idx_cached_ - ri) & (capacity_ - 1);
+        }
+        const std::size_t count = max < avail ? max : avail;
+        if (count == 0) return 0;
+        const std::size_t first = std::min(count, capacity_ - ri);
+        std::copy_n(buffer_ + ri, first, out);
+        std::copy_n(buffer_, count - first, out + first);
+        idx_->read_idx.store((ri + count) & (capacity_ - 1), std::memory_order_release);
+        return count;
+    }
+
+    std::optional<T> pop() noexcept {
+        T val;
+        if (try_pop(&val)) return val;
+        return std::nullopt;
+    }
+
+    // ── Inspection ────────────────────────────────────────────────────────
+
+    [[nodiscard]] double occupancy() const noexcept {
+        const std::size_t wi = idx_->write_idx.load(std::memory_order_relaxed);
+        const std::size_t ri = idx_->read_idx.load(std::memory_order_relaxed);
+        return static_cast<double>((wi - ri + capacity_) & (capacity_ - 1)) / static_cast<double>(capacity_);
+    }
+
+    [[nodiscard]] std::size_t capacity() const noexcept { return capacity_; }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return idx_->write_idx.load(std::memory_order_acquire) == idx_->read_idx.load(std::memory_order_acquire);
+    }
+
+    ShmRole role() const noexcept { return role_; }
+    // The memfd to pass to the peer for an anonymous queue.
+    int fd() const noexcept { return seg_.fd(); }
+    const ShmSegment& segment() const noexcept { return seg_; }
+
+private:
+    struct Indices {
+        alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> write_idx{0};
+        alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> read_idx{0};
+    };
+
+    static constexpr std::size_t INDICES_OFFSET = (sizeof(ShmQueueHeader) + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+
+    struct Layout {
+        static constexpr std::uint32_t KIND = ShmQueueHeader::SPSC;
+        static std::uint32_t elem_size()  { return sizeof(T); }
+        static std::uint32_t elem_align() { return alignof(T); }
+        static std::size_t   slot_size()  { return sizeof(T); }
+        static std::size_t   ring_offset() {
+            return detail::round_up(INDICES_OFFSET + sizeof(Indices), std::max<std::size_t>(CACHE_LINE_SIZE, alignof(T)));
+        }
+    };
+
+    ShmSPSCQueue(ShmSegment seg, ShmRole role)
+        : seg_(std::move(seg))
+        , header_(static_cast<ShmQueueHeader*>(seg_.data()))
+        , idx_(reinterpret_cast<Indices*>(static_cast<char*>(seg_.data()) + INDICES_OFFSET))
+        , buffer_(reinterpret_cast<T*>(static_cast<char*>(seg_.data()) + header_->ring_offset))
+        , capacity_(static_cast<std::size_t>(header_->capacity))
+        , role_(role)
+    {
+        detail::claim_role(role_slot(), role == ShmRole::Producer ? "producer" : "consumer", seg_.name());
+        write_idx_cached_ = idx_->read_idx.load(std::memory_order_acquire);
+        read_idx_cached_  = idx_->write_idx.load(std::memory_order_acquire);
+    }
+
+    std::atomic<std::int32_t>& role_slot() noexcept {
+        return role_ == ShmRole::Producer ? header_->producer_pid : header_->consumer_pid;
+    }
+
+    ShmSegment      seg_;
+    ShmQueueHeader* header_;
+    Indices*        idx_;
+    T*              buffer_;
+    std::size_t     capacity_;
+    ShmRole         role_;
+
+    // Process-local shadows, as in SPSCQueue.
+    alignas(CACHE_LINE_SIZE) std::size_t write_idx_cached_{0};
+    alignas(CACHE_LINE_SIZE) std::size_t read_idx_cached_{0};
+};
+
+// ── ShmMPMCQueue<T> ──────────────────────────────────────────────────────
+//
+// MPMCQueue's sequence-numbered slots in a shared-memory segment: any
+// number of producer and consumer processes (and threads in them). Same
+// create / attach handshake and layout checks as ShmSPSCQueue; there are
+// no roles to claim.
+template <typename T>
+class ShmMPMCQueue {
+    static_assert(std::is_trivially_copyable_v<T>,
+        "ShmMPMCQueue<T>: T must be trivially copyable.");
+
+    struct Slot {
+        alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> seq;
+        T data;
+    };
+
+public:
+    static ShmMPMCQueue create(const std::string& name, std::size_t capacity, std::uint64_t type_tag = 0) {
+        ShmSegment seg = detail::create_queue_segment<Layout>(name, capacity, type_tag);
+        auto* base = static_cast<char*>(seg.data());
+        new (base + POS_OFFSET) Positions{};
+        Slot* slots = reinterpret_cast<Slot*>(base + Layout::ring_offset());
+        for (std::size_t i = 0; i < capacity; ++i) new (&slots[i].seq) std::atomic<std::size_t>(i);
+        detail::publish_ready(seg);
+        return ShmMPMCQueue(std::move(seg));
+    }
+
+    static ShmMPMCQueue attach(const std::string& name, std::uint64_t type_tag = 0,
+                               std::chrono::milliseconds timeout = std::chrono::seconds(5)) {
+        return ShmMPMCQueue(detail::attach_queue_segment<Layout>(name, type_tag, timeout));
+    }
+
+    static ShmMPMCQueue attach(ShmSegment seg, std::uint64_t type_tag = 0,
+                               std::chrono::milliseconds timeout = std::chrono::seconds(5)) {
+        return ShmMPMCQueue(detail::attach_queue_segment<Layout>(std::move(seg), type_tag, timeout));
+    }
+
+    ShmMPMCQueue(ShmMPMCQueue&&) noexcept        = default;
+    ShmMPMCQueue(const ShmMPMCQueue&)            = delete;
+    ShmMPMCQueue& operator=(const ShmMPMCQueue&) = delete;
+
+    [[nodiscard]] bool try_push(const T& val) noexcept {
+        std::size_t pos = pos_->enqueue.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = buffer_[pos & mask_];
+            const std::size_t seq = slot.seq.load(std::memory_order_acquire);
+            const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (pos_->enqueue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    slot.data = val;
+                    slot.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = pos_->enqueue.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    [[nodiscard]] bool try_pop(T* out) noexcept {
+        std::size_t pos = pos_->dequeue.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = buffer_[pos & mask_];
+            const std::size_t seq = slot.seq.load(std::memory_order_acquire);
+            const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0) {
+                if (pos_->dequeue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    *out = slot.data;
+                    slot.seq.store(pos + mask_ + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = pos_->dequeue.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    std::optional<T> pop() noexcept {
+        T val;
+        if (try_pop(&val)) return val;
+        return std::nullopt;
+    }
+
+    [[nodiscard]] double occupancy() const noexcept {
+        const std::size_t ep = pos_->enqueue.load(std::memory_order_relaxed);
+        const std::size_t dp = pos_->dequeue.load(std::memory_order_relaxed);
+        return static_cast<double>((ep - dp + mask_ + 1) & mask_) / static_cast<double>(mask_ + 1);
+    }
+
+    [[nodiscard]] std::size_t capacity() const noexcept { return mask_ + 1; }
+    int fd() const noexcept { return seg_.fd(); }
+    const ShmSegment& segment() const noexcept { return seg_; }
+
+private:
+    struct Positions {
+        alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> enqueue{0};
+        alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> dequeue{0};
+    };
+
+    static constexpr std::size_t POS_OFFSET = (sizeof(ShmQueueHeader) + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+
+    struct Layout {
+        static constexpr std::uint32_t KIND = ShmQueueHeader::MPMC;
+        static std::uint32_t elem_size()  { return sizeof(T); }
+        static std::uint32_t elem_align() { return alignof(T); }
+        static std::size_t   slot_size()  { return sizeof(Slot); }
+        static std::size_t   ring_offset() { return detail::round_up(POS_OFFSET + sizeof(Positions), alignof(Slot)); }
+    };
+
+    explicit ShmMPMCQueue(ShmSegment seg)
+        : seg_(std::move(seg))
+        , pos_(reinterpret_cast<Positions*>(static_cast<char*>(seg_.data()) + POS_OFFSET))
+        , buffer_(reinterpret_cast<Slot*>(static_cast<char*>(seg_.data()) + Layout::ring_offset()))
+        , mask_(static_cast<std::size_t>(static_cast<const ShmQueueHeader*>(seg_.data())->capacity) - 1) {}
+
+    ShmSegment  seg_;
+    Positions*  pos_;
+    Slot*       buffer_;
+    std::size_t mask_;
+};
+
+} // namespace klstream
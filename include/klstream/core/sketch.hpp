@@ -0,0 +1,479 @@
+// include/klstream/core/sketch.hpp
+#pragma once
+#include "keyed_state.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace klstream {
+
+// Sketches: fixed-memory summaries of a key stream, for aggregations whose
+// exact state grows with key cardinality (views per campaign, distinct
+// ads, heavy-hitter symbols). Each one
+//
+//   * allocates its state once, in its constructor; add() and clear()
+//     never allocate, add_n() only to grow its hash scratch to a batch
+//     larger than any before;
+//   * folds keys in one at a time (add) or a batch at a time (add_n), the
+//     batch path hashing every key in one tight pass over a flat array
+//     before touching the sketch, so the hash loop is free of branches
+//     and stores to the sketch and can be vectorised;
+//   * merges with another sketch of the same shape into the sketch of
+//     both streams, so keyed-parallel replicas (PartitionOperator) can
+//     each summarise their share and one downstream stage merge them.
+//
+// Keys are Event::key-style 64-bit integers, spread with mix64. Not
+// thread-safe — each operator replica owns its sketch.
+//
+// A sketch holds its state in a std::vector, so it cannot travel through
+// a queue itself. Each one exports it as a fixed-size, trivially copyable
+// state sized by template parameters — CountMinState<Width, Depth>,
+// HyperLogLogState<Precision>, SpaceSavingState<Capacity> — and merges
+// one back in: a replica's window emits sketch.state<...>() and the
+// downstream stage folds each into one sketch with merge(state). The
+// parameters must match the sketch's shape (state() throws
+// std::invalid_argument otherwise). The whole state travels in the event,
+// so queued states want small shapes: HyperLogLogState<8> is 256 bytes.
+template <std::size_t Width, std::size_t Depth> struct CountMinState;
+template <unsigned Precision>                   struct HyperLogLogState;
+template <std::size_t Capacity>                 struct SpaceSavingState;
+
+// ── CountMinSketch ────────────────────────────────────────────────────────
+//
+// Frequency of each key, never under-estimated: depth rows of width
+// counters, key k adding to one counter per row, and estimate(k) the least
+// of its depth counters. With N events added, an estimate exceeds the true
+// count by more than (e / width) * N with probability at most e^-depth.
+// Memory is depth * width counters whatever the key count; width is
+// rounded up to a power of two.
+//
+// The depth row indices of a key come from one mix64 (double hashing: row
+// r takes h1 + r * h2). add_n() hashes the batch into a scratch array,
+// then updates row by row, so one row's counters stay in cache for the
+// whole batch. merge() is an elementwise sum.
+class CountMinSketch {
+public:
+    explicit CountMinSketch(std::size_t width = 2048, std::size_t depth = 4)
+        : depth_(depth < 1 ? 1 : depth)
+    {
+        width_ = 8;
+        while (width_ < width) width_ <<= 1;
+        mask_ = width_ - 1;
+        counts_.assign(width_ * depth_, 0);
+    }
+
+    std::size_t width() const noexcept { return width_; }
+    std::size_t depth() const noexcept { return depth_; }
+
+    // Sum of every count added.
+    std::uint64_t total() const noexcept { return total_; }
+
+    void add(std::uint64_t key, std::uint64_t count = 1) noexcept {
+        const std::uint64_t h = mix64(key);
+        for (std::size_t r = 0; r < depth_; ++r) counts_[r * width_ + index(h, r)] += count;
+        total_ += count;
+    }
+
+    // add(keys[i]) for every i < n.
+    void add_n(const std::uint64_t* keys, std::size_t n) {
+        hashes_.resize(n);
+        std::uint64_t* h = hashes_.data();
+        for (std::size_t i = 0; i < n; ++i) h[i] = mix64(keys[i]);
+        for (std::size_t r = 0; r < depth_; ++r) {
+            std::uint64_t* row = counts_.data() + r * width_;
+            for (std::size_t i = 0; i < n; ++i) ++row[index(h[i], r)];
+        }
+        total_ += n;
+    }
+
+    std::uint64_t estimate(std::uint64_t key) const noexcept {
+        const std::uint64_t h = mix64(key);
+        std::uint64_t best = std::numeric_limits<std::uint64_t>::max();
+        for (std::size_t r = 0; r < depth_; ++r) best = std::min(best, counts_[r * width_ + index(h, r)]);
+        return best;
+    }
+
+    // Add `other`'s counts: the sketch of both streams. Throws
+    // std::invalid_argument unless the two have the same width and depth.
+    void merge(const CountMinSketch& other) {
+        check_shape(other.width_, other.depth_);
+        merge_counts(other.counts_.data(), other.total_);
+    }
+
+    // The counters as a CountMinState, and merge() of one. Both throw
+    // std::invalid_argument unless Width and Depth are the sketch's.
+    template <std::size_t Width, std::size_t Depth>
+    CountMinState<Width, Depth> state() const {
+        check_shape(Width, Depth);
+        CountMinState<Width, Depth> s;
+        s.total = total_;
+        std::copy(counts_.begin(), counts_.end(), s.counts.begin());
+        return s;
+    }
+
+    template <std::size_t Width, std::size_t Depth>
+    void merge(const CountMinState<Width, Depth>& s) {
+        check_shape(Width, Depth);
+        merge_counts(s.counts.data(), s.total);
+    }
+
+    void clear() noexcept {
+        std::fill(counts_.begin(), counts_.end(), 0);
+        total_ = 0;
+    }
+
+    // Bytes of counters (the sketch's fixed footprint).
+    std::size_t memory_bytes() const noexcept { return counts_.size() * sizeof(std::uint64_t); }
+
+private:
+    void check_shape(std::size_t width, std::size_t depth) const {
+        if (width != width_ || depth != depth_)
+            throw std::invalid_argument("CountMinSketch: different width or depth");
+    }
+
+    void merge_counts(const std::uint64_t* b, std::uint64_t total) noexcept {
+        std::uint64_t* a = counts_.data();
+        for (std::size_t i = 0, n = counts_.size(); i < n; ++i) a[i] += b[i];
+        total_ += total;
+    }
+
+    std::size_t index(std::uint64_t h, std::size_t r) const noexcept {
+        const std::uint64_t h1 = h & 0xffffffffULL;
+        const std::uint64_t h2 = (h >> 32) | 1;   // odd: every row differs
+        return static_cast<std::size_t>(h1 + r * h2) & mask_;
+    }
+
+    std::size_t                width_;
+    std::size_t                depth_;
+    std::size_t                mask_;
+    std::vector<std::uint64_t> counts_;   // row-major, depth_ x width_
+    std::vector<std::uint64_t> hashes_;   // add_n scratch
+    std::uint64_t              total_{0};
+};
+
+template <std::size_t Width, std::size_t Depth>
+struct CountMinState {
+    static_assert(Width >= 8 && (Width & (Width - 1)) == 0,
+                  "CountMinState: Width must be a power of two, at least 8");
+    static_assert(Depth >= 1, "CountMinState: Depth must be at least 1");
+
+    std::uint64_t                            total;
+    std::array<std::uint64_t, Width * Depth> counts;   // row-major, Depth x Width
+};
+
+// ── HyperLogLog ───────────────────────────────────────────────────────────
+//
+// Distinct keys, in 2^precision one-byte registers: the top `precision`
+// bits of a key's hash pick a register, which keeps the longest run of
+// leading zeros (plus one) seen in the rest. The standard error of
+// estimate() is about 1.04 / sqrt(2^precision) — 1.6% at the default 12,
+// in 4 KiB. Small counts use linear counting over the empty registers
+// (the usual small-range correction); with a 64-bit hash no large-range
+// correction is needed.
+//
+// merge() is an elementwise max, so the merged sketch is exactly the one
+// a single sketch over both streams would hold.
+class HyperLogLog {
+public:
+    // precision in [4, 18]; throws std::invalid_argument otherwise.
+    explicit HyperLogLog(unsigned precision = 12) : p_(precision) {
+        if (precision < 4 || precision > 18)
+            throw std::invalid_argument("HyperLogLog: precision must be in [4, 18]");
+        regs_.assign(std::size_t{1} << p_, 0);
+    }
+
+    unsigned    precision() const noexcept { return p_; }
+    std::size_t registers() const noexcept { return regs_.size(); }
+
+    void add(std::uint64_t key) noexcept { update(mix64(key)); }
+
+    // add(keys[i]) for every i < n.
+    void add_n(const std::uint64_t* keys, std::size_t n) {
+        hashes_.resize(n);
+        std::uint64_t* h = hashes_.data();
+        for (std::size_t i = 0; i < n; ++i) h[i] = mix64(keys[i]);
+        for (std::size_t i = 0; i < n; ++i) update(h[i]);
+    }
+
+    double estimate() const noexcept {
+        const double m = static_cast<double>(regs_.size());
+        double sum = 0.0;
+        std::size_t zeros = 0;
+        for (const std::uint8_t r : regs_) {
+            sum += std::ldexp(1.0, -static_cast<int>(r));
+            zeros += r == 0;
+        }
+        const double alpha = p_ == 4 ? 0.673 : p_ == 5 ? 0.697 : p_ == 6 ? 0.709
+                                             : 0.7213 / (1.0 + 1.079 / m);
+        const double e = alpha * m * m / sum;
+        if (e <= 2.5 * m && zeros != 0) return m * std::log(m / static_cast<double>(zeros));
+        return e;
+    }
+
+    // Fold in `other`: the sketch of both streams. Throws
+    // std::invalid_argument unless the two have the same precision.
+    void merge(const HyperLogLog& other) {
+        check_precision(other.p_);
+        merge_registers(other.regs_.data());
+    }
+
+    // The registers as a HyperLogLogState, and merge() of one. Both throw
+    // std::invalid_argument unless Precision is the sketch's.
+    template <unsigned Precision>
+    HyperLogLogState<Precision> state() const {
+        check_precision(Precision);
+        HyperLogLogState<Precision> s;
+        std::copy(regs_.begin(), regs_.end(), s.registers.begin());
+        return s;
+    }
+
+    template <unsigned Precision>
+    void merge(const HyperLogLogState<Precision>& s) {
+        check_precision(Precision);
+        merge_registers(s.registers.data());
+    }
+
+    void clear() noexcept { std::fill(regs_.begin(), regs_.end(), 0); }
+
+    std::size_t memory_bytes() const noexcept { return regs_.size(); }
+
+private:
+    void check_precision(unsigned p) const {
+        if (p != p_) throw std::invalid_argument("HyperLogLog: different precision");
+    }
+
+    void merge_registers(const std::uint8_t* b) noexcept {
+        std::uint8_t* a = regs_.data();
+        for (std::size_t i = 0, n = regs_.size(); i < n; ++i) a[i] = std::max(a[i], b[i]);
+    }
+
+    void update(std::uint64_t h) noexcept {
+        const std::size_t   idx  = static_cast<std::size_t>(h >> (64 - p_));
+        // The low bits, with a stop bit so the rank is at most 64 - p + 1.
+        const std::uint64_t rest = (h << p_) | (std::uint64_t{1} << (p_ - 1));
+        const auto          rank = static_cast<std::uint8_t>(__builtin_clzll(rest) + 1);
+        if (rank > regs_[idx]) regs_[idx] = rank;
+    }
+
+    unsigned                   p_;
+    std::vector<std::uint8_t>  regs_;
+    std::vector<std::uint64_t> hashes_;   // add_n scratch
+};
+
+template <unsigned Precision>
+struct HyperLogLogState {
+    static_assert(Precision >= 4 && Precision <= 18, "HyperLogLogState: Precision must be in [4, 18]");
+
+    std::array<std::uint8_t, std::size_t{1} << Precision> registers;
+};
+
+// ── SpaceSaving ───────────────────────────────────────────────────────────
+//
+// The heaviest keys of a stream (top-K), in `capacity` counters (Metwally
+// et al.'s Space-Saving). A tracked key adds to its counter; an untracked
+// one takes over the least counter, inheriting its count as error. Every
+// key with more than N / capacity occurrences in N events is tracked, and
+// a tracked key's count over-estimates its true count by at most `error`.
+//
+// Keys, counts and errors are three flat arrays: the lookup of a key and
+// the search for the least counter are branch-free scans over contiguous
+// memory, which beat any index for the capacities heavy-hitter detection
+// uses (tens to a few hundred) and which the compiler can vectorise.
+//
+// merge() follows Agarwal et al.'s mergeable summaries: counts of a key
+// in both add up, a key missing from a full side is charged that side's
+// least count (as count and error), and the `capacity` largest are kept.
+// The merged summary keeps the bounds above over both streams.
+class SpaceSaving {
+public:
+    struct Entry {
+        std::uint64_t key;
+        std::uint64_t count;   // an upper bound on the key's occurrences
+        std::uint64_t error;   // count - error is a lower bound
+    };
+
+    explicit SpaceSaving(std::size_t capacity = 64)
+        : capacity_(capacity < 1 ? 1 : capacity)
+    {
+        keys_.reserve(capacity_);
+        counts_.reserve(capacity_);
+        errors_.reserve(capacity_);
+    }
+
+    // The summary a SpaceSavingState holds, with capacity Capacity.
+    template <std::size_t Capacity>
+    explicit SpaceSaving(const SpaceSavingState<Capacity>& s) : SpaceSaving(Capacity) {
+        for (std::size_t i = 0; i < s.size; ++i) {
+            keys_.push_back(s.entries[i].key);
+            counts_.push_back(s.entries[i].count);
+            errors_.push_back(s.entries[i].error);
+        }
+        total_ = s.total;
+    }
+
+    std::size_t capacity() const noexcept { return capacity_; }
+    std::size_t size() const noexcept { return keys_.size(); }
+    std::uint64_t total() const noexcept { return total_; }
+
+    void add(std::uint64_t key, std::uint64_t count = 1) noexcept {
+        total_ += count;
+        const std::size_t n = keys_.size();
+        const std::size_t at = find(key);
+        if (at != n) {
+            counts_[at] += count;
+            return;
+        }
+        if (n < capacity_) {
+            keys_.push_back(key);
+            counts_.push_back(count);
+            errors_.push_back(0);
+            return;
+        }
+        const std::size_t m = least();
+        keys_[m]    = key;
+        errors_[m]  = counts_[m];
+        counts_[m] += count;
+    }
+
+    // add(keys[i]) for every i < n.
+    void add_n(const std::uint64_t* keys, std::size_t n) noexcept {
+        for (std::size_t i = 0; i < n; ++i) add(keys[i]);
+    }
+
+    // Upper bound on key's occurrences: its count if tracked, else the
+    // least count once full (0 before).
+    std::uint64_t estimate(std::uint64_t key) const noexcept {
+        const std::size_t at = find(key);
+        if (at != keys_.size()) return counts_[at];
+        return keys_.size() < capacity_ ? 0 : counts_[least()];
+    }
+
+    // The k heaviest tracked keys, heaviest first (ties: smaller key first).
+    std::vector<Entry> top(std::size_t k) const {
+        std::vector<Entry> out = entries();
+        k = std::min(k, out.size());
+        std::partial_sort(out.begin(), out.begin() + static_cast<std::ptrdiff_t>(k), out.end(), heavier);
+        out.resize(k);
+        return out;
+    }
+
+    // Fold in `other` (see above). Allocates; meant for merging window
+    // results, not the per-event path.
+    void merge(const SpaceSaving& other) {
+        const std::uint64_t my_floor    = keys_.size() < capacity_ ? 0 : counts_[least()];
+        const std::uint64_t other_floor = other.keys_.size() < other.capacity_ ? 0 : other.counts_[other.least()];
+
+        std::vector<Entry> all = entries();
+        for (Entry& e : all) {
+            const std::size_t at = other.find(e.key);
+            if (at != other.keys_.size()) {
+                e.count += other.counts_[at];
+                e.error += other.errors_[at];
+            } else {
+                e.count += other_floor;
+                e.error += other_floor;
+            }
+        }
+        for (std::size_t i = 0; i < other.keys_.size(); ++i) {
+            if (find(other.keys_[i]) != keys_.size()) continue;
+            all.push_back(Entry{ other.keys_[i], other.counts_[i] + my_floor, other.errors_[i] + my_floor });
+        }
+        const std::size_t keep = std::min(capacity_, all.size());
+        std::partial_sort(all.begin(), all.begin() + static_cast<std::ptrdiff_t>(keep), all.end(), heavier);
+        all.resize(keep);
+
+        keys_.clear(); counts_.clear(); errors_.clear();
+        for (const Entry& e : all) {
+            keys_.push_back(e.key);
+            counts_.push_back(e.count);
+            errors_.push_back(e.error);
+        }
+        total_ += other.total_;
+    }
+
+    // The summary as a SpaceSavingState, and merge() of one (which
+    // allocates, as merge() does). Both throw std::invalid_argument unless
+    // Capacity is the summary's.
+    template <std::size_t Capacity>
+    SpaceSavingState<Capacity> state() const {
+        check_capacity(Capacity);
+        SpaceSavingState<Capacity> s{};
+        s.total = total_;
+        s.size  = keys_.size();
+        for (std::size_t i = 0; i < keys_.size(); ++i) s.entries[i] = Entry{ keys_[i], counts_[i], errors_[i] };
+        return s;
+    }
+
+    template <std::size_t Capacity>
+    void merge(const SpaceSavingState<Capacity>& s) {
+        check_capacity(Capacity);
+        merge(SpaceSaving(s));
+    }
+
+    void clear() noexcept {
+        keys_.clear(); counts_.clear(); errors_.clear();
+        total_ = 0;
+    }
+
+    std::size_t memory_bytes() const noexcept { return capacity_ * sizeof(Entry); }
+
+private:
+    void check_capacity(std::size_t capacity) const {
+        if (capacity != capacity_) throw std::invalid_argument("SpaceSaving: different capacity");
+    }
+
+    static bool heavier(const Entry& a, const Entry& b) noexcept {
+        return a.count != b.count ? a.count > b.count : a.key < b.key;
+    }
+
+    std::vector<Entry> entries() const {
+        std::vector<Entry> out(keys_.size());
+        for (std::size_t i = 0; i < keys_.size(); ++i) out[i] = Entry{ keys_[i], counts_[i], errors_[i] };
+        return out;
+    }
+
+    // Position of key in keys_, or size() if untracked. The last match
+    // wins (keys are unique, so there is at most one).
+    std::size_t find(std::uint64_t key) const noexcept {
+        const std::uint64_t* k = keys_.data();
+        const std::size_t n = keys_.size();
+        std::size_t at = n;
+        for (std::size_t i = 0; i < n; ++i) at = k[i] == key ? i : at;
+        return at;
+    }
+
+    // Position of the least count. Full summaries only.
+    std::size_t least() const noexcept {
+        const std::uint64_t* c = counts_.data();
+        std::size_t m = 0;
+        for (std::size_t i = 1, n = counts_.size(); i < n; ++i) m = c[i] < c[m] ? i : m;
+        return m;
+    }
+
+    std::size_t                capacity_;
+    std::vector<std::uint64_t> keys_;
+    std::vector<std::uint64_t> counts_;
+    std::vector<std::uint64_t> errors_;
+    std::uint64_t              total_{0};
+};
+
+template <std::size_t Capacity>
+struct SpaceSavingState {
+    static_assert(Capacity >= 1, "SpaceSavingState: Capacity must be at least 1");
+
+    std::uint64_t                             total;
+    std::size_t                               size;      // entries in use
+    std::array<SpaceSaving::Entry, Capacity>  entries;
+};
+
+static_assert(std::is_trivially_copyable_v<CountMinState<8, 1>>);
+static_assert(std::is_trivially_copyable_v<HyperLogLogState<4>>);
+static_assert(std::is_trivially_copyable_v<SpaceSavingState<1>>);
+
+} // namespace klstream
@@ -1,6 +1,11 @@
 // include/klstream/core/spsc_queue.hpp
 #pragma once
 #include "config.hpp"
+#include "page_alloc.hpp"
+#include "pinning.hpp"
+#include "parker.hpp"
+#include "trace.hpp"
+#include <algorithm>
 #include <atomic>
 #include <cassert>
 #include <cstddef>
@@ -18,8 +23,10 @@ namespace klstream {
 // A bounded, lock-free, single-producer / single-consumer ring buffer.
 //
 // CORRECTNESS CONTRACT (do not violate):
-//   * Exactly one thread calls push() or try_push() at a time (the producer).
-//   * Exactly one thread calls pop() or try_pop() at a time (the consumer).
+//   * Exactly one thread calls push(), try_push(), try_push_n() or
+//     claim()/publish() at a time (the producer).
+//   * Exactly one thread calls pop(), try_pop() or try_pop_n() at a time
+//     (the consumer).
 //   * These two threads may be different OS threads — that is the whole point.
 //   * T must be trivially copyable (POD-like). For complex types, wrap them
 //     in a std::shared_ptr before putting them in an Event.
@@ -36,7 +43,7 @@ namespace klstream {
 //   read_idx_cached_     <- consumer's local shadow of write_idx_ (relaxed)
 //   [padding 4]
 //   capacity_            <- const after construction
-//   buffer_              <- the actual ring, heap-allocated, cache-line aligned
+//   buffer_              <- the actual ring, cache-line aligned (PageAllocator)
 //
 // WHY CACHED INDICES:
 //   In the fast path (queue neither full nor empty), the producer only ever
@@ -52,12 +59,13 @@ class SPSCQueue {
         "Wrap complex types in std::shared_ptr.");
 
 public:
-    // capacity must be a power of 2 and >= 2.
-    explicit SPSCQueue(std::size_t capacity = DEFAULT_QUEUE_CAPACITY)
+    // capacity must be a power of 2 and >= 2. The ring is backed per
+    // `policy` (huge pages, pre-faulted, locked; see page_alloc.hpp).
+    explicit SPSCQueue(std::size_t capacity = DEFAULT_QUEUE_CAPACITY,
+                       const MemoryPolicy& policy = default_memory_policy())
         : capacity_(capacity)
-        , buffer_(static_cast<T*>(
-            ::operator new(capacity * sizeof(T),
-                           std::align_val_t{CACHE_LINE_SIZE})))
+        , buffer_(static_cast<T*>(PageAllocator::instance().allocate(
+            capacity * sizeof(T), CACHE_LINE_SIZE, policy)))
     {
         assert(capacity >= 2 && "SPSCQueue capacity must be >= 2");
         assert((capacity & (capacity - 1)) == 0 &&
@@ -65,8 +73,8 @@ public:
     }
 
     ~SPSCQueue() {
-        ::operator delete(buffer_,
-            std::align_val_t{CACHE_LINE_SIZE});
+        PageAllocator::instance().deallocate(buffer_, capacity_ * sizeof(T),
+                                             CACHE_LINE_SIZE);
     }
 
     // Non-copyable, non-movable (contains raw pointer + atomics).
@@ -92,13 +100,69 @@ public:
             }
         }
         buffer_[wi] = val;
+        if (trace_) trace_->on_push(1);
         // Release: make the write visible to the consumer before we advance
         // write_idx_. The consumer will see the updated index and then read
         // the element we just wrote.
         write_idx_.store(next_wi, std::memory_order_release);
+        if (waker_) waker_->notify();
         return true;
     }
 
+    // try_push_n: pushes up to n elements from vals[0..n) in order and returns
+    // how many were actually pushed (0 if the queue is full). write_idx_ is
+    // published ONCE for the whole batch, so the release-store and the
+    // consumer's cache-line refetch are amortised over every element.
+    [[nodiscard]] std::size_t try_push_n(const T* vals, std::size_t n) noexcept {
+        const std::size_t wi = write_idx_.load(std::memory_order_relaxed);
+
+        // Free slots according to the cached read index; only re-read the
+        // real index if the cache says there is not room for the whole batch.
+        std::size_t free = (write_idx_cached_ - wi - 1) & (capacity_ - 1);
+        if (free < n) {
+            write_idx_cached_ = read_idx_.load(std::memory_order_acquire);
+            free = (write_idx_cached_ - wi - 1) & (capacity_ - 1);
+        }
+        const std::size_t count = n < free ? n : free;
+        if (count == 0) return 0;
+
+        // Copy in at most two contiguous segments (before and after wrap).
+        const std::size_t first = std::min(count, capacity_ - wi);
+        std::copy_n(vals, first, buffer_ + wi);
+        std::copy_n(vals + first, count - first, buffer_);
+        if (trace_) trace_->on_push(count);
+
+        write_idx_.store((wi + count) & (capacity_ - 1),
+                         std::memory_order_release);
+        if (waker_) waker_->notify();
+        return count;
+    }
+
+    // claim / publish: in-place production. claim() returns a pointer to up
+    // to n contiguous free slots (fewer at the ring's wrap point, 0 if the
+    // queue is full) for the producer to write directly — a receive call
+    // can land data in the ring itself. publish(k) then makes the first
+    // k <= claimed of them visible, in one release-store as try_push_n.
+    // Claiming again before publishing returns the same slots.
+    [[nodiscard]] T* claim(std::size_t n, std::size_t* claimed) noexcept {
+        const std::size_t wi = write_idx_.load(std::memory_order_relaxed);
+        std::size_t free = (write_idx_cached_ - wi - 1) & (capacity_ - 1);
+        if (free < n) {
+            write_idx_cached_ = read_idx_.load(std::memory_order_acquire);
+            free = (write_idx_cached_ - wi - 1) & (capacity_ - 1);
+        }
+        *claimed = std::min({ n, free, capacity_ - wi });
+        return buffer_ + wi;
+    }
+
+    void publish(std::size_t k) noexcept {
+        if (k == 0) return;
+        const std::size_t wi = write_idx_.load(std::memory_order_relaxed);
+        if (trace_) trace_->on_push(k);
+        write_idx_.store((wi + k) & (capacity_ - 1), std::memory_order_release);
+        if (waker_) waker_->notify();
+    }
+
     // Blocking push: spins with three-tier backoff until space is available.
     // Not recommended in the hot path — prefer try_push() + OpStatus::Blocked.
     void push(const T& val) noexcept {
@@ -136,11 +200,36 @@ public:
             }
         }
         *out = buffer_[ri];
+        if (trace_) trace_->on_pop(out, 1);
         read_idx_.store((ri + 1) & (capacity_ - 1),
                         std::memory_order_release);
         return true;
     }
 
+    // try_pop_n: pops up to max elements into out[0..max) in FIFO order and
+    // returns how many were popped (0 if the queue is empty). Mirror image of
+    // try_push_n — read_idx_ is published once per batch.
+    [[nodiscard]] std::size_t try_pop_n(T* out, std::size_t max) noexcept {
+        const std::size_t ri = read_idx_.load(std::memory_order_relaxed);
+
+        std::size_t avail = (read_idx_cached_ - ri) & (capacity_ - 1);
+        if (avail < max) {
+            read_idx_cached_ = write_idx_.load(std::memory_order_acquire);
+            avail = (read_idx_cached_ - ri) & (capacity_ - 1);
+        }
+        const std::size_t count = max < avail ? max : avail;
+        if (count == 0) return 0;
+
+        const std::size_t first = std::min(count, capacity_ - ri);
+        std::copy_n(buffer_ + ri, first, out);
+        std::copy_n(buffer_, count - first, out + first);
+        if (trace_) trace_->on_pop(out, count);
+
+        read_idx_.store((ri + count) & (capacity_ - 1),
+                        std::memory_order_release);
+        return count;
+    }
+
     // Convenience: returns std::nullopt when empty.
     std::optional<T> pop() noexcept {
         T val;
@@ -167,6 +256,21 @@ public:
             == read_idx_.load(std::memory_order_acquire);
     }
 
+    // Every successful push also notifies `p` (the consumer's worker
+    // Parker, IdleStrategy::Park) — a fence and a relaxed load unless the
+    // consumer is actually asleep. Set before the pipeline starts.
+    void set_waker(Parker* p) noexcept { waker_ = p; }
+
+    // Samples push-to-pop dwell time into `t` (see QueueTrace). Set before
+    // the pipeline starts.
+    void set_trace(QueueTrace* t) noexcept { trace_ = t; }
+
+    // Moves the ring to NUMA node `node` — normally the consumer's, whose
+    // reads are the ones that miss. Call before the pipeline starts.
+    bool bind_to_numa_node(int node) noexcept {
+        return klstream::bind_to_numa_node(buffer_, capacity_ * sizeof(T), node);
+    }
+
 private:
     // Each hot atomic lives on its own 128-byte cache line.
     // The layout is: pad | atomic | cache-shadow | pad | atomic | cache-shadow | pad
@@ -178,7 +282,9 @@ private:
     alignas(CACHE_LINE_SIZE) std::size_t              read_idx_cached_{0};
 
     const std::size_t capacity_;
-    T*                buffer_;   // heap-allocated, CACHE_LINE_SIZE-aligned
+    T*                buffer_;   // PageAllocator, CACHE_LINE_SIZE-aligned
+    Parker*           waker_{nullptr};   // const once running
+    QueueTrace*       trace_{nullptr};   // const once running
 };
 
 } // namespace klstream
@@ -0,0 +1,260 @@
+// include/klstream/core/trace.hpp
+#pragma once
+#include "clock.hpp"
+#include "histogram.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace klstream {
+
+// ── TraceSpan ─────────────────────────────────────────────────────────────
+//
+// One sampled interval: an event waiting in a queue, or an operator tick.
+struct TraceSpan {
+    std::uint64_t start_ns;   // Clock::now_ns()
+    std::uint64_t dur_ns;
+    std::uint64_t seq;        // Event::seq of the traced event (0 for ticks)
+};
+
+// ── SpanRing ──────────────────────────────────────────────────────────────
+//
+// The last `capacity` spans of one track, overwritten oldest first. Single
+// writer; read it (TraceRecorder::write_chrome_trace) once the pipeline has
+// stopped.
+class SpanRing {
+public:
+    explicit SpanRing(std::size_t capacity) : spans_(std::max<std::size_t>(capacity, 1)) {}
+
+    void push(const TraceSpan& s) noexcept { spans_[written_++ % spans_.size()] = s; }
+
+    std::size_t size() const noexcept { return std::min<std::size_t>(written_, spans_.size()); }
+    std::uint64_t written() const noexcept { return written_; }
+
+    // Oldest first.
+    template <typename F>
+    void for_each(F&& f) const {
+        const std::size_t n = size();
+        for (std::uint64_t i = written_ - n; i < written_; ++i) f(spans_[i % spans_.size()]);
+    }
+
+private:
+    std::vector<TraceSpan> spans_;
+    std::uint64_t          written_{0};
+};
+
+// Event::seq of a traced item, or 0 for queues of anything else.
+template <typename T>
+auto trace_seq(const T& v, int) noexcept -> decltype(static_cast<std::uint64_t>(v.seq)) { return v.seq; }
+template <typename T>
+std::uint64_t trace_seq(const T&, long) noexcept { return 0; }
+
+// ── QueueTrace ────────────────────────────────────────────────────────────
+//
+// Dwell time of one queue: from the push of an event to its pop. Installed
+// with SPSCQueue::set_trace(); disabled queues pay one untaken branch.
+//
+// No event carries a tag: a queue is FIFO, so the k-th event pushed is the
+// k-th popped. Every sample_every-th position is sampled — the producer
+// stamps its push time into slot (k / sample_every) of a small ring, the
+// consumer reads it back at the pop and records now - stamp. The ring holds
+// more samples than can be in flight, and both sides touch their slot before
+// publishing their queue index, so the queue's own release/acquire pair
+// orders every slot hand-over; the slots need no atomics. One clock read
+// per push or pop batch that contains a sampled position, none otherwise.
+class QueueTrace {
+public:
+    QueueTrace(std::string name, std::size_t sample_every, std::size_t queue_capacity,
+               std::size_t max_spans)
+        : name_(std::move(name))
+        , every_(std::max<std::size_t>(sample_every, 1))
+        , spans_(max_spans)
+    {
+        std::size_t slots = 2;
+        while (slots < queue_capacity / every_ + 2) slots <<= 1;
+        stamps_.assign(slots, 0);
+        mask_ = slots - 1;
+    }
+
+    // Producer side: `n` events were just written and are about to be
+    // published.
+    void on_push(std::size_t n) noexcept {
+        const std::uint64_t end = pushed_ += n;
+        if (next_push_ >= end) return;
+        const std::uint64_t now = Clock::now_ns();
+        for (; next_push_ < end; next_push_ += every_) stamps_[(next_push_ / every_) & mask_] = now;
+    }
+
+    // Consumer side: `items[0..n)` were just read and their slots are about
+    // to be released.
+    template <typename T>
+    void on_pop(const T* items, std::size_t n) noexcept {
+        const std::uint64_t begin = popped_;
+        const std::uint64_t end   = popped_ += n;
+        if (next_pop_ >= end) return;
+        const std::uint64_t now = Clock::now_ns();
+        for (; next_pop_ < end; next_pop_ += every_) {
+            const std::uint64_t at   = stamps_[(next_pop_ / every_) & mask_];
+            const std::uint64_t dwell = now > at ? now - at : 0;
+            dwell_.record(dwell);
+            spans_.push({ at, dwell, trace_seq(items[next_pop_ - begin], 0) });
+        }
+    }
+
+    const std::string&      name() const noexcept { return name_; }
+    const LatencyHistogram& dwell() const noexcept { return dwell_; }
+    const SpanRing&         spans() const noexcept { return spans_; }
+
+private:
+    std::string                name_;
+    std::size_t                every_;
+    std::vector<std::uint64_t> stamps_;
+    std::size_t                mask_{0};
+    std::uint64_t              pushed_{0}, next_push_{0};   // producer
+    std::uint64_t              popped_{0}, next_pop_{0};    // consumer
+    LatencyHistogram           dwell_;                      // consumer
+    SpanRing                   spans_;                      // consumer
+};
+
+// ── OpTrace ───────────────────────────────────────────────────────────────
+//
+// Service time of one operator: the duration of every sample_every-th
+// tick() that made progress, timed by the worker (IOperator::trace). A
+// sampled tick that returns Idle or Blocked passes the sample on to the
+// next tick. With fusion, a tick includes the fused downstream operators.
+class OpTrace {
+public:
+    OpTrace(std::string name, std::size_t sample_every, std::size_t max_spans)
+        : name_(std::move(name)), every_(std::max<std::size_t>(sample_every, 1)), spans_(max_spans) {}
+
+    // Should the worker time this tick?
+    bool sample() noexcept {
+        if (pending_) return true;
+        if (++ticks_ < every_) return false;
+        ticks_   = 0;
+        pending_ = true;
+        return true;
+    }
+
+    // A sampled tick ran from t0 to t1; `progress` if it returned Processed.
+    void record(std::uint64_t t0, std::uint64_t t1, bool progress) noexcept {
+        if (!progress) return;
+        pending_ = false;
+        service_.record(t1 - t0);
+        spans_.push({ t0, t1 - t0, 0 });
+    }
+
+    const std::string&      name() const noexcept { return name_; }
+    const LatencyHistogram& service() const noexcept { return service_; }
+    const SpanRing&         spans() const noexcept { return spans_; }
+
+private:
+    std::string      name_;
+    std::size_t      every_;
+    std::size_t      ticks_{0};
+    bool             pending_{false};
+    LatencyHistogram service_;
+    SpanRing         spans_;
+};
+
+// ── TraceRecorder ─────────────────────────────────────────────────────────
+//
+// Owns the traces of one pipeline and exports them. Typical use:
+//
+//   TraceRecorder tr(1024);               // one event / tick in 1024
+//   tr.trace_queue("win->inf", q_win_inf);
+//   tr.trace_operator(inference_op);
+//   tr.report_to(rt.metrics());           // dwell / service percentiles
+//   rt.start(); ... rt.stop();
+//   std::ofstream f("trace.json");
+//   tr.write_chrome_trace(f);             // chrome://tracing, ui.perfetto.dev
+//
+// StreamGraph::trace() registers every edge and node of a graph. All
+// registration must happen before the runtime starts.
+class TraceRecorder {
+public:
+    explicit TraceRecorder(std::size_t sample_every = 1024, std::size_t max_spans = 1 << 16)
+        : every_(sample_every), max_spans_(max_spans), origin_ns_(Clock::now_ns()) {}
+
+    TraceRecorder(const TraceRecorder&)            = delete;
+    TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+    // Any queue with capacity() and set_trace(QueueTrace*) (SPSCQueue).
+    template <typename Queue>
+    QueueTrace& trace_queue(std::string name, Queue& q) {
+        queues_.emplace_back(std::move(name), every_, q.capacity(), max_spans_);
+        q.set_trace(&queues_.back());
+        return queues_.back();
+    }
+
+    // Op: an IOperator (takes its name()). Defined as a template so this
+    // header does not need operator.hpp.
+    template <typename Op>
+    OpTrace& trace_operator(Op& op) {
+        ops_.emplace_back(op.name(), every_, max_spans_);
+        op.trace = &ops_.back();
+        return ops_.back();
+    }
+
+    const std::deque<QueueTrace>& queues() const noexcept { return queues_; }
+    const std::deque<OpTrace>&    operators() const noexcept { return ops_; }
+
+    // Adds every dwell histogram to a MetricsReporter as "dwell:<queue>"
+    // and every service histogram as "service:<op>".
+    template <typename Reporter>
+    void report_to(Reporter& r) const {
+        for (const auto& q : queues_) r.add_histogram("dwell:" + q.name(), &q.dwell());
+        for (const auto& o : ops_) r.add_histogram("service:" + o.name(), &o.service());
+    }
+
+    // Chrome trace-event JSON: one track per queue ("dwell") and per
+    // operator ("service"), one complete ("X") event per sampled span, with
+    // the event's seq in args. Call once the pipeline has stopped.
+    void write_chrome_trace(std::ostream& out) const {
+        out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+        bool first = true;
+        const auto sep = [&] { if (!first) out << ','; first = false; };
+        const auto us = [this](std::uint64_t ns) {
+            return static_cast<double>(ns > origin_ns_ ? ns - origin_ns_ : 0) / 1000.0;
+        };
+        std::size_t tid = 1;
+        const auto track = [&](const std::string& name, const char* cat, const SpanRing& spans) {
+            sep();
+            out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid
+                << ",\"args\":{\"name\":\"" << cat << ' ' << escaped(name) << "\"}}";
+            spans.for_each([&](const TraceSpan& s) {
+                sep();
+                out << "{\"name\":\"" << escaped(name) << "\",\"cat\":\"" << cat
+                    << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << tid
+                    << ",\"ts\":" << us(s.start_ns) << ",\"dur\":" << static_cast<double>(s.dur_ns) / 1000.0
+                    << ",\"args\":{\"seq\":" << s.seq << "}}";
+            });
+            ++tid;
+        };
+        for (const auto& q : queues_) track(q.name(), "dwell", q.spans());
+        for (const auto& o : ops_) track(o.name(), "service", o.spans());
+        out << "]}\n";
+    }
+
+private:
+    static std::string escaped(const std::string& v) {
+        std::string out;
+        for (char c : v) {
+            if (c == '"' || c == '\\') out += '\\';
+            if (static_cast<unsigned char>(c) >= 0x20) out += c;
+        }
+        return out;
+    }
+
+    std::size_t            every_;
+    std::size_t            max_spans_;
+    std::uint64_t          origin_ns_;
+    std::deque<QueueTrace> queues_;
+    std::deque<OpTrace>    ops_;
+};
+
+} // namespace klstream
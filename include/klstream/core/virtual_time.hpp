@@ -0,0 +1,152 @@
+// include/klstream/core/virtual_time.hpp
+#pragma once
+#include "operator.hpp"
+#include "clock.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#if !(defined(KLSTREAM_VIRTUAL_CLOCK) && KLSTREAM_VIRTUAL_CLOCK)
+#  error "virtual_time.hpp needs KLSTREAM_VIRTUAL_CLOCK: the operators must read the virtual clock"
+#endif
+
+namespace klstream {
+
+// ── VirtualTimeRunner ────────────────────────────────────────────────────
+//
+// Runs a pipeline on the calling thread in virtual time, for performance
+// experiments that must be reproducible: the same operators, queues and
+// settings give the same events, window sizes and latencies on any machine,
+// under any load. Several runners on several threads do not interfere
+// (the virtual clock is per thread).
+//
+// Each operator is its own server, as if it had a worker to itself. Its
+// work is priced, not timed: `cost` returns the virtual nanoseconds of work
+// the operator has done so far, computed from its counters (events
+// processed, tree walks); the increase over one tick is what the tick
+// took. Every tick runs with Clock::now_ns() at the instant it starts, so
+// event stamps, latencies and every controller reading the clock or the
+// queues see virtual time:
+//
+//   t[o] = when operator o is next free; all 0 at the start
+//   loop: o = the operator with the least t (equal t: round-robin)
+//         Clock = t[o]; s = o.tick()
+//         Processed      -> t[o] += the cost of the tick (at least 1 ns); a
+//                           consumer of o (feeds()) that has caught up
+//                           (last tick Idle, or not ready() after it)
+//                           starts on the output at that instant
+//         Idle / Blocked -> o waits for the next instant another operator
+//                           is due at
+//   until no operator makes progress through a whole round (drained), or
+//   the next tick would start after the deadline
+//
+// A consumer still working through a backlog may take o's output before
+// o's tick has finished in virtual time; only output into a caught-up
+// consumer is held back. An operator whose readiness changes with time
+// alone (a processing-time window's timeout) only sees time move while
+// other operators work, and a run with none left working ends instead of
+// waiting for it.
+class VirtualTimeRunner {
+public:
+    using Cost = std::function<std::uint64_t()>;
+
+    // Returns the operator's index, for feeds(). Before run().
+    std::size_t add(IOperator* op, Cost cost) {
+        ops_.push_back(Stage{ op, std::move(cost), {}, 0, 0, 0, true });
+        return ops_.size() - 1;
+    }
+
+    // `down` reads the output of `up`. Before run().
+    void feeds(std::size_t up, std::size_t down) {
+        if (up >= ops_.size() || down >= ops_.size()) throw std::out_of_range("VirtualTimeRunner::feeds");
+        ops_[up].down.push_back(down);
+    }
+
+    // init() every operator, run them as above, shutdown() every operator.
+    // Returns the virtual time the last tick finished (the run's length).
+    std::uint64_t run(std::uint64_t deadline_ns = std::numeric_limits<std::uint64_t>::max()) {
+        if (ran_) throw std::logic_error("VirtualTimeRunner::run() called twice");
+        ran_ = true;
+        Clock::set_virtual_ns(0);
+        for (auto& s : ops_) s.op->init();
+
+        std::vector<std::uint64_t> before(ops_.size());
+        for (std::size_t i = 0; i < ops_.size(); ++i) before[i] = ops_[i].cost();
+        std::vector<bool> fruitless(ops_.size(), false);
+        std::size_t n_fruitless = 0;
+
+        while (!ops_.empty() && n_fruitless < ops_.size()) {
+            const std::size_t i = next();
+            Stage& s = ops_[i];
+            if (s.t > deadline_ns) break;
+            Clock::set_virtual_ns(s.t);
+            const OpStatus st = s.op->tick();
+            ++ticks_;
+            const std::uint64_t spent = s.cost();
+            if (st == OpStatus::Processed) {
+                s.t += std::max<std::uint64_t>(spent - before[i], 1);
+                end_ns_ = std::max(end_ns_, s.t);
+                s.idle = !s.op->ready();
+                s.since = s.t;
+                for (const std::size_t d : s.down) {
+                    if (ops_[d].idle) ops_[d].t = std::max(ops_[d].since, s.t);
+                }
+                std::fill(fruitless.begin(), fruitless.end(), false);
+                n_fruitless = 0;
+            } else {
+                s.idle = st == OpStatus::Idle;
+                s.since = s.t;
+                s.t = next_after(s.t);
+                if (!fruitless[i]) { fruitless[i] = true; ++n_fruitless; }
+            }
+            before[i] = spent;
+            s.turn = ++turns_;
+        }
+
+        Clock::set_virtual_ns(end_ns_);
+        for (auto& s : ops_) s.op->shutdown();
+        return end_ns_;
+    }
+
+    std::uint64_t ticks() const noexcept { return ticks_; }
+
+private:
+    struct Stage {
+        IOperator*               op;
+        Cost                     cost;
+        std::vector<std::size_t> down;
+        std::uint64_t            t;      // next free instant
+        std::uint64_t            turn;   // last ticked; breaks ties in t
+        std::uint64_t            since;  // caught up since (when idle)
+        bool                     idle;   // caught up: no input after its last tick
+    };
+
+    std::size_t next() const noexcept {
+        std::size_t best = 0;
+        for (std::size_t i = 1; i < ops_.size(); ++i) {
+            const Stage& a = ops_[i];
+            const Stage& b = ops_[best];
+            if (a.t < b.t || (a.t == b.t && a.turn < b.turn)) best = i;
+        }
+        return best;
+    }
+
+    // The next instant after `t` any operator is due; `t` if none is.
+    std::uint64_t next_after(std::uint64_t t) const noexcept {
+        std::uint64_t n = std::numeric_limits<std::uint64_t>::max();
+        for (const auto& s : ops_) if (s.t > t) n = std::min(n, s.t);
+        return n == std::numeric_limits<std::uint64_t>::max() ? t : n;
+    }
+
+    std::vector<Stage> ops_;
+    std::uint64_t      ticks_{0};
+    std::uint64_t      turns_{0};
+    std::uint64_t      end_ns_{0};
+    bool               ran_{false};
+};
+
+} // namespace klstream
@@ -0,0 +1,53 @@
+// include/klstream/core/watermark.hpp
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <limits>
+
+namespace klstream {
+
+// ── Watermark ─────────────────────────────────────────────────────────────
+//
+// Event-time progress of a stream: the watermark W promises that no event
+// still to come has event_ts_ns < W, so an event-time window ending at or
+// before W can be closed for good.
+//
+// KLStream's queues are FIFO and its operators preserve order, so the
+// event times themselves travel in band: a source that declares how far
+// out of order it emits (the bound) is its own watermark generator, and a
+// window downstream recomputes the same watermark from the events it
+// receives — W = max event time seen - bound. A bound of zero suits
+// sources that emit in event-time order (every replay source). Events
+// later than the bound are late and are dropped by the window.
+//
+// advance() moves the watermark without an event — end of a replay, or a
+// source that knows time has passed while it had nothing to emit.
+class Watermark {
+public:
+    static constexpr std::uint64_t MAX = std::numeric_limits<std::uint64_t>::max();
+
+    explicit Watermark(std::chrono::nanoseconds max_out_of_order = std::chrono::nanoseconds(0))
+        : bound_(max_out_of_order.count() < 0 ? 0 : static_cast<std::uint64_t>(max_out_of_order.count())) {}
+
+    // Records an event at event time `ts`.
+    void observe(std::uint64_t ts) noexcept {
+        if (ts > max_seen_) max_seen_ = ts;
+        const std::uint64_t w = max_seen_ > bound_ ? max_seen_ - bound_ : 0;
+        if (w > current_) current_ = w;
+    }
+
+    // Raises the watermark to at least `w`.
+    void advance(std::uint64_t w) noexcept {
+        if (w > current_) current_ = w;
+    }
+
+    std::uint64_t current() const noexcept { return current_; }
+    std::uint64_t bound() const noexcept { return bound_; }
+
+private:
+    std::uint64_t bound_;
+    std::uint64_t max_seen_{0};
+    std::uint64_t current_{0};
+};
+
+} // namespace klstream
@@ -3,9 +3,17 @@
 #include "operator.hpp"
 #include "pinning.hpp"
 #include "config.hpp"
+#include "metrics.hpp"
+#include "scheduler.hpp"
+#include "parker.hpp"
+#include "clock.hpp"
+#include "trace.hpp"
+#include "perf_counters.hpp"
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <memory>
+#include <mutex>
 #include <thread>
 #include <vector>
 
@@ -33,6 +41,34 @@ namespace klstream {
 //
 // This keeps latency low (the ARM yield instruction is ~1 ns) while
 // not burning 100% CPU indefinitely when the pipeline is truly idle.
+//
+// Under SchedulingPolicy::WorkStealing (join_group() before start()) the
+// assigned operators are only this worker's initial share:
+//
+//   while (running):
+//       un-park every parked operator whose ready() is true
+//       pop the next task from this worker's run queue, or steal one
+//       tick it up to STEAL_BURST times while it returns Processed
+//       Idle -> park it here;  Processed / Blocked -> back on our queue
+//
+// Backoff as above, counted in tasks run without progress; it escalates
+// once a whole round of this worker's tasks made none. init() runs on the
+// home worker before its operators become stealable; tick() of one
+// operator may then run on any worker of the group, but never two at once.
+//
+// With a Parker (IdleStrategy::Park), the last tier of the backoff becomes
+// "sleep until a producer pushes into one of our operators' inputs"
+// instead of sleep_for(SLEEP_NS) — but only once no operator reports
+// ready(); an operator without the hint keeps its worker polling.
+//
+// Migration (RoundRobin, Runtime::migrate): an operator moves between
+// workers only at a safe point — between two rounds of its current worker,
+// after its last tick() there has returned. The worker gives it on_park(),
+// drops it from its list and posts it to the new worker, which appends it
+// at its own next safe point. Both hand-overs go through a mutex, so the
+// operator's state (held events, cached queue indices) is published to the
+// new thread, and it is never ticked by two workers or between them. Its
+// events stay in its queues, so none is lost or reordered.
 
 class WorkerThread {
 public:
@@ -50,9 +86,63 @@ public:
         operators_.push_back(op);
     }
 
+    // Drop an operator from the scheduling list (e.g. fused into another).
+    // Must be called BEFORE start().
+    void unassign(IOperator* op) {
+        operators_.erase(std::remove(operators_.begin(), operators_.end(), op),
+                         operators_.end());
+    }
+
     // Set the core affinity hint for this worker.
     // Must be called BEFORE start().
-    void set_affinity(CoreAffinity aff) { affinity_ = aff; }
+    void set_affinity(CoreAffinity aff) { placement_.affinity = aff; }
+
+    // Set explicit CPUs and/or NUMA node (see WorkerPlacement); overrides
+    // the affinity hint where given. Must be called BEFORE start().
+    void set_placement(WorkerPlacement p) { placement_ = std::move(p); }
+    const WorkerPlacement& placement() const noexcept { return placement_; }
+
+    // Run this worker's operators through `group` (WorkStealing) as worker
+    // `index`. Must be called BEFORE start(); tasks must outlive the worker.
+    void join_group(StealGroup* group, std::size_t index, std::vector<ScheduledTask*> tasks) {
+        group_      = group;
+        group_idx_  = index;
+        home_tasks_ = std::move(tasks);
+    }
+
+    // IdleStrategy::Park: sleep on `p` when idle; producers feeding this
+    // worker's operators must notify it (IOperator::wake_on_input). Must be
+    // called BEFORE start().
+    void set_parker(Parker* p) noexcept { parker_ = p; }
+
+    // Times this worker went to sleep on its Parker.
+    std::uint64_t parks() const noexcept { return parks_.load(); }
+
+    // Tasks this worker took from another worker's run queue.
+    std::uint64_t steals() const noexcept { return steals_.load(); }
+
+    // Hand `op` to worker `to` at this worker's next safe point (see
+    // Migration above); `*moving` is cleared once `to` has taken it, or
+    // at once if `op` is not on this worker. Valid while running.
+    void release(IOperator* op, WorkerThread* to, std::atomic<bool>* moving) {
+        post(outbox_, { op, to, moving });
+    }
+
+    // Operators this worker took over from another (release()).
+    std::uint64_t migrations() const noexcept { return migrations_.load(); }
+
+    // True once this worker has opened hardware counters for a profiled
+    // operator (IOperator::perf); false before, or if the platform has none.
+    bool perf_counters_active() const noexcept { return perf_ok_.load(std::memory_order_relaxed); }
+
+    // Busy / idle time of the scheduling loop (MetricsReporter::add_worker).
+    const WorkerStats& stats() const noexcept { return stats_; }
+
+    // False if the worker could not be pinned as its placement asked
+    // (valid once the worker has started running).
+    bool placement_applied() const noexcept {
+        return placement_ok_.load(std::memory_order_acquire);
+    }
 
     // Start the worker thread. Calls init() on all operators, then enters
     // the scheduling loop.
@@ -61,10 +151,38 @@ public:
         thread_ = std::thread([this]{ run(); });
     }
 
-    // Signal the worker to stop and wait for it to join.
-    void stop() {
+    // Signal the worker to stop without waiting for it.
+    void request_stop() noexcept {
         running_.store(false, std::memory_order_release);
-        if (thread_.joinable()) thread_.join();
+        if (parker_) parker_->wake_all();
+    }
+
+    // Signal the worker to stop and wait for its thread to exit, without
+    // shutting its operators down (stop() does). Lets the Runtime join
+    // every worker before any operator is shut down: under WorkStealing a
+    // worker still running may be ticking an operator of another, and an
+    // operator it releases may land in the inbox of one that has exited.
+    void join() {
+        if (!thread_.joinable()) return;
+        request_stop();
+        thread_.join();
+        exited_ = true;
+    }
+
+    // Signal the worker to stop and wait for it to join. Operators are
+    // shut down once, after the thread that ran them has exited —
+    // including any migrated here that it never took over; a worker
+    // that never started, or a second stop() (e.g. from the destructor),
+    // leaves them alone — by then they may be gone.
+    void stop() {
+        join();
+        if (!exited_) return;
+        exited_ = false;
+        {
+            std::lock_guard<std::mutex> lk(mail_mu_);
+            for (const auto& h : inbox_) operators_.push_back(h.op);
+            inbox_.clear();
+        }
         for (auto* op : operators_) op->shutdown();
     }
 
@@ -72,43 +190,270 @@ public:
 
 private:
     void run() {
-        // Apply core-affinity hint at the very beginning of the thread.
-        apply_affinity(affinity_);
+        // Apply placement at the very beginning of the thread, so memory
+        // the operators allocate in init() already follows its NUMA policy.
+        placement_ok_.store(apply_placement(placement_), std::memory_order_release);
 
         // Initialise all owned operators.
         for (auto* op : operators_) op->init();
+        if (group_) { run_stealing(); return; }
 
         int idle_rounds = 0;
         const int YIELD_CAP = SPIN_BEFORE_YIELD + YIELD_BEFORE_SLEEP;
+        std::uint64_t mark = Clock::now_ns();
 
         while (running_.load(std::memory_order_relaxed)) {
+            if (mail_.load(std::memory_order_acquire)) take_mail();
             bool any_progress = false;
             for (auto* op : operators_) {
-                OpStatus s = op->tick();
+                OpStatus s = tick(op);
                 if (s == OpStatus::Processed) any_progress = true;
             }
             if (!any_progress) {
                 ++idle_rounds;
-                if (idle_rounds < SPIN_BEFORE_YIELD) {
+                const auto has_work = [this] {
+                    for (auto* op : operators_) if (op->ready()) return true;
+                    return false;
+                };
+                if (parker_ && idle_rounds >= YIELD_CAP && park(has_work, operators_)) {
+                    idle_rounds = 0;   // spin again first: a burst is likely starting
+                } else {
+                    backoff(idle_rounds, YIELD_CAP);
+                }
+            } else {
+                idle_rounds = 0;
+            }
+            account(any_progress, mark);
+        }
+    }
+
+    struct Handoff {
+        IOperator*         op;
+        WorkerThread*      to;       // outbox only
+        std::atomic<bool>* moving;
+    };
+
+    void post(std::vector<Handoff>& box, Handoff h) {
+        {
+            std::lock_guard<std::mutex> lk(mail_mu_);
+            box.push_back(h);
+            mail_.store(true, std::memory_order_release);
+        }
+        if (parker_) parker_->wake_all();
+    }
+
+    // The safe point: no operator of this worker is inside tick().
+    void take_mail() {
+        std::vector<Handoff> out, in;
+        {
+            std::lock_guard<std::mutex> lk(mail_mu_);
+            mail_.store(false, std::memory_order_relaxed);
+            out.swap(outbox_);
+            in.swap(inbox_);
+        }
+        for (const auto& h : out) {
+            const auto it = std::find(operators_.begin(), operators_.end(), h.op);
+            if (it == operators_.end()) {
+                h.moving->store(false, std::memory_order_release);
+                continue;
+            }
+            operators_.erase(it);
+            h.op->on_park();
+            h.to->post(h.to->inbox_, { h.op, nullptr, h.moving });
+        }
+        for (const auto& h : in) {
+            operators_.push_back(h.op);
+            migrations_.increment();
+            h.moving->store(false, std::memory_order_release);
+        }
+    }
+
+    // op->tick(), timed when the operator is traced and due a sample, and
+    // wrapped in counter reads when it is profiled and due one. With
+    // rebalancing on, a sample of ticks is also timed into op->load.
+    OpStatus tick(IOperator* op) {
+        OpLoad* ld = op->load;
+        if (ld && ld->countdown-- == 0) {
+            ld->countdown = LOAD_SAMPLE_EVERY - 1;
+            const std::uint64_t t0 = Clock::now_ns();
+            const OpStatus s = measured_tick(op);
+            if (s == OpStatus::Processed) ld->busy_ns.add((Clock::now_ns() - t0) * LOAD_SAMPLE_EVERY);
+            return s;
+        }
+        return measured_tick(op);
+    }
+
+    OpStatus measured_tick(IOperator* op) {
+        PerfMetrics* pm = op->perf;
+        if (pm && pm->countdown-- == 0) {
+            pm->countdown = PERF_SAMPLE_EVERY - 1;
+            return profiled_tick(op, *pm);
+        }
+        return timed_tick(op);
+    }
+
+    static OpStatus timed_tick(IOperator* op) {
+        OpTrace* tr = op->trace;
+        if (!tr || !tr->sample()) return op->tick();
+        const std::uint64_t t0 = Clock::now_ns();
+        const OpStatus s = op->tick();
+        tr->record(t0, Clock::now_ns(), s == OpStatus::Processed);
+        return s;
+    }
+
+    // The group is opened on first use, from this worker's own thread: perf
+    // events count the thread that opened them.
+    OpStatus profiled_tick(IOperator* op, PerfMetrics& pm) {
+        if (!perf_tried_) {
+            perf_tried_ = true;
+            perf_ok_.store(perf_.open(), std::memory_order_relaxed);
+        }
+        PerfCounts before;
+        if (!perf_.read(before)) return timed_tick(op);
+        const OpStatus s = timed_tick(op);
+        PerfCounts after;
+        if (!perf_.read(after)) return s;
+        const PerfCounts d = after - before;
+        pm.ticks.increment();
+        pm.cycles.add(d.cycles);
+        pm.instructions.add(d.instructions);
+        pm.cache_misses.add(d.cache_misses);
+        pm.branch_misses.add(d.branch_misses);
+        pm.l1d_misses.add(d.l1d_misses);
+        pm.stalled_cycles.add(d.stalled_cycles);
+        return s;
+    }
+
+    // Charges the time since `mark` to busy or idle and moves the mark.
+    void account(bool busy, std::uint64_t& mark) noexcept {
+        const std::uint64_t now = Clock::now_ns();
+        (busy ? stats_.busy_ns : stats_.idle_ns).add(now - mark);
+        mark = now;
+    }
+
+    // IdleStrategy::Park: sleeps on parker_ unless `has_work()` — checked
+    // again after registering as a sleeper (see Parker for why that order).
+    // The operators in `ops` get on_park() first. Returns false, without
+    // sleeping, if there was work (or an operator that cannot tell).
+    template <typename HasWork, typename Ops>
+    bool park(const HasWork& has_work, const Ops& ops) {
+        if (has_work()) return false;
+        for (auto* op : ops) on_park(op);
+        const std::uint32_t key = parker_->prepare();
+        if (has_work() || !running_.load(std::memory_order_acquire)) {
+            parker_->cancel();
+            return false;
+        }
+        parker_->wait(key, std::chrono::nanoseconds(PARK_TIMEOUT_NS));
+        parks_.increment();
+        return true;
+    }
+
+    static void on_park(IOperator* op) { op->on_park(); }
+    static void on_park(ScheduledTask* t) { t->op->on_park(); }
+
+    static void backoff(int idle_rounds, int yield_cap) {
+        if (idle_rounds < SPIN_BEFORE_YIELD) {
 #if defined(__aarch64__)
-                    __asm__ volatile("yield" ::: "memory");
+            __asm__ volatile("yield" ::: "memory");
 #elif defined(__x86_64__)
-                    __asm__ volatile("pause" ::: "memory");
+            __asm__ volatile("pause" ::: "memory");
 #endif
-                } else if (idle_rounds < YIELD_CAP) {
-                    std::this_thread::yield();
+        } else if (idle_rounds < yield_cap) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(
+                std::chrono::nanoseconds(SLEEP_NS));
+        }
+    }
+
+    // Ticks per task before it goes back on the queue: long enough to keep
+    // a hot operator's state in cache, short enough for others to run.
+    static constexpr int STEAL_BURST = 32;
+
+    void run_stealing() {
+        for (auto* t : home_tasks_) group_->push(group_idx_, t);
+        std::vector<ScheduledTask*> parked;
+        const int YIELD_CAP = SPIN_BEFORE_YIELD + YIELD_BEFORE_SLEEP;
+        int idle_rounds = 0, fruitless = 0;
+        std::uint64_t mark = Clock::now_ns();
+
+        while (running_.load(std::memory_order_relaxed)) {
+            for (std::size_t i = 0; i < parked.size();) {
+                if (parked[i]->op->ready()) {
+                    group_->push(group_idx_, parked[i]);
+                    parked[i] = parked.back();
+                    parked.pop_back();
                 } else {
-                    std::this_thread::sleep_for(
-                        std::chrono::nanoseconds(SLEEP_NS));
+                    ++i;
                 }
+            }
+
+            ScheduledTask* t = nullptr;
+            if (!group_->pop(group_idx_, &t)) {
+                if (!group_->steal(group_idx_, &t)) {
+                    ++idle_rounds;
+                    // Parked tasks already had on_park(); nothing else is held.
+                    const auto has_work = [&] {
+                        if (group_->any_runnable()) return true;
+                        for (auto* p : parked) if (p->op->ready()) return true;
+                        return false;
+                    };
+                    if (parker_ && idle_rounds >= YIELD_CAP && park(has_work, no_ops_)) {
+                        idle_rounds = 0;
+                    } else {
+                        backoff(idle_rounds, YIELD_CAP);
+                    }
+                    account(false, mark);
+                    continue;
+                }
+                steals_.increment();
+            }
+
+            OpStatus s = OpStatus::Idle;
+            bool progress = false;
+            for (int k = 0; k < STEAL_BURST; ++k) {
+                s = tick(t->op);
+                if (s != OpStatus::Processed) break;
+                progress = true;
+            }
+            if (s == OpStatus::Idle) {
+                t->op->on_park();
+                parked.push_back(t);
             } else {
-                idle_rounds = 0;
+                group_->push(group_idx_, t);
+            }
+
+            if (progress) {
+                idle_rounds = fruitless = 0;
+            } else if (++fruitless > static_cast<int>(home_tasks_.size() + parked.size())) {
+                fruitless = 0;
+                backoff(++idle_rounds, YIELD_CAP);
             }
+            account(progress, mark);
         }
     }
 
     std::vector<IOperator*>  operators_;
-    CoreAffinity             affinity_{CoreAffinity::Any};
+    std::mutex                  mail_mu_;
+    std::vector<Handoff>        outbox_;             // mail_mu_
+    std::vector<Handoff>        inbox_;              // mail_mu_
+    std::atomic<bool>           mail_{false};
+    LocalCounter                migrations_;
+    bool                        exited_{false};
+    StealGroup*                 group_{nullptr};
+    std::size_t                 group_idx_{0};
+    std::vector<ScheduledTask*> home_tasks_;
+    LocalCounter                steals_;
+    Parker*                     parker_{nullptr};
+    LocalCounter                parks_;
+    WorkerStats                 stats_;
+    PerfCounterGroup            perf_;               // this thread's, once opened
+    bool                        perf_tried_{false};
+    std::atomic<bool>           perf_ok_{false};
+    const std::vector<IOperator*> no_ops_;
+    WorkerPlacement          placement_;
+    std::atomic<bool>        placement_ok_{true};
     std::atomic<bool>        running_{false};
     std::thread              thread_;
 };
@@ -0,0 +1,611 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <istream>
+#include <limits>
+#include <memory>
+#include <new>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "../core/mapped_file.hpp"
+#include "../core/page_alloc.hpp"
+
+#if defined(__AVX2__)
+#  include <immintrin.h>
+#endif
+
+namespace klstream {
+
+// ── FlatForestHeader ──────────────────────────────────────────────────────
+//
+// First 128 bytes of a flat forest file (and of every in-memory FlatForest
+// blob — they are the same bytes). Followed by SECTIONS arrays, each
+// starting on an ALIGN boundary. ALIGN is fixed rather than CACHE_LINE_SIZE
+// so one file is valid on every target, and 128 covers both 64- and
+// 128-byte lines. Bump VERSION on any layout change; readers reject
+// anything else rather than guess.
+struct FlatForestHeader {
+    static constexpr char          MAGIC[8]   = { 'K', 'L', 'S', 'F', 'L', 'A', 'T', '\0' };
+    static constexpr std::uint32_t VERSION    = 1;
+    static constexpr std::uint32_t ENDIAN_TAG = 0x01020304;   // reads back permuted if foreign
+    static constexpr std::size_t   ALIGN      = 128;
+
+    enum Section : std::size_t {
+        TREE_BASE, LEAF_BASE, FEATURE, SPLIT, CHILD, LEAF_VALUE, MIN_SUFFIX, MAX_SUFFIX,
+        SECTIONS
+    };
+
+    char          magic[8];
+    std::uint32_t version;
+    std::uint32_t byte_order;
+    std::uint32_t dim;
+    std::uint32_t n_trees;
+    std::uint32_t n_nodes;          // excluding gather slack
+    std::uint32_t n_leaves;
+    double        c_psi;
+    std::uint64_t file_size;
+    std::uint64_t offset[SECTIONS]; // from the start of the file
+    std::uint64_t reserved[2];
+};
+static_assert(sizeof(FlatForestHeader) == 128);
+static_assert(std::is_trivially_copyable_v<FlatForestHeader>);
+
+// ── FlatForest ────────────────────────────────────────────────────────────
+//
+// The scoring-time representation of an IsolationForest: every tree's nodes
+// in one set of structure-of-arrays, re-laid out breadth-first so that an
+// internal node's two children are adjacent (right == left + 1). One node
+// costs 7 bytes (feature u8, split f32, child u16) versus 20 for
+// IsolationTree::Node, so a psi=256 tree (<= 511 nodes) is ~3.5 KB and
+// stays L1-resident while a whole window is pushed through it.
+//
+//   feature_[n]  split feature, or LEAF
+//   split_[n]    split value (unused at leaves)
+//   child_[n]    internal: local index of the left child
+//                leaf:     local index into this tree's leaf_value_ run
+//   leaf_value_  depth + c(size_at_leaf), precomputed in double exactly as
+//                IsolationTree::path_length() computes it
+//
+// Indices are local to a tree (tree_base_/leaf_base_ hold the offsets), which
+// is what lets them be 16-bit. build() throws std::length_error for a tree
+// with more than 65535 nodes (psi > 32768), far beyond the psi=256 default.
+//
+// score_batch() is tree-major: one tree at a time for all points, so the
+// tree is read from cache instead of memory for every point after the first.
+// Within a tree, LANES points descend in lockstep — with AVX2 via gathers,
+// otherwise as LANES independent dependency chains the core can overlap
+// (which is what NEON-class cores without gathers benefit from). Per-point
+// sums are accumulated in the same tree order as IsolationForest's scalar
+// path, so scores are bit-identical to anomaly_score().
+//
+// score_max() is the early-exit variant for callers that only need the
+// window maximum: see its comment.
+//
+// Storage is a single blob in the flat file format (FlatForestHeader),
+// whether it came from build(), load() or map(). map() scores straight out
+// of a read-only mapping: no deserialisation at startup, and one physical
+// copy shared by every process on the box. Copies of a FlatForest share
+// the blob.
+template <std::size_t D>
+class FlatForest {
+    static_assert(D < 255, "FlatForest stores feature indices as uint8_t");
+
+public:
+    using Point = std::array<float, D>;
+
+    static constexpr std::uint8_t LEAF  = 0xFF;
+    static constexpr std::size_t  LANES = 8;
+    // score_max() re-checks its bounds after every BOUND_STRIDE trees.
+    static constexpr std::size_t  BOUND_STRIDE = 8;
+
+    struct BoundedMax {
+        double        score         = -1.0;
+        std::uint32_t index         = 0;
+        std::uint64_t trees_skipped = 0;   // of n * n_trees() tree walks
+    };
+
+    FlatForest()                             = default;
+    FlatForest(const FlatForest&)            = default;
+    FlatForest& operator=(const FlatForest&) = default;
+    // The scoring pointers alias blob_, so a moved-from FlatForest is reset
+    // to empty rather than left pointing at a blob it no longer owns.
+    FlatForest(FlatForest&& o) noexcept : FlatForest(o) { o.reset(); }
+    FlatForest& operator=(FlatForest&& o) noexcept {
+        if (this != &o) { *this = o; o.reset(); }
+        return *this;
+    }
+
+    // Tree must expose nodes() / root() with IsolationTree<D>::Node fields.
+    template <typename Tree>
+    void build(const std::vector<Tree>& trees, double c_psi) {
+        Staging st;
+        for (const auto& tree : trees) append_tree(st, tree);
+        st.tree_base.push_back(static_cast<std::uint32_t>(st.feature.size()));
+        st.leaf_base.push_back(static_cast<std::uint32_t>(st.leaf_value.size()));
+        auto blob = pack(st, c_psi);
+        const auto size = reinterpret_cast<const FlatForestHeader*>(blob.get())->file_size;
+        adopt(std::move(blob), static_cast<std::size_t>(size), "build()");
+    }
+
+    // ── Flat file format ─────────────────────────────────────────────────
+    // The in-memory blob and the file are byte-for-byte the same thing, so
+    // save() is one write and map() scores straight out of the page cache.
+    void save(std::ostream& out) const {
+        if (!blob_) throw std::logic_error("FlatForest::save: nothing built or loaded");
+        out.write(reinterpret_cast<const char*>(blob_.get()),
+                  static_cast<std::streamsize>(hdr_->file_size));
+    }
+
+    // Reads a saved blob into an aligned heap buffer (one allocation).
+    void load(std::istream& in) {
+        FlatForestHeader h{};
+        if (!in.read(reinterpret_cast<char*>(&h), sizeof(h))) {
+            throw std::runtime_error("FlatForest: truncated header");
+        }
+        if (std::memcmp(h.magic, FlatForestHeader::MAGIC, sizeof(h.magic)) != 0 ||
+            h.file_size < sizeof(h) || h.file_size > (std::uint64_t{1} << 32)) {
+            throw std::runtime_error("FlatForest: not a flat forest stream");
+        }
+        auto blob = allocate(static_cast<std::size_t>(h.file_size));
+        std::byte* p = const_cast<std::byte*>(blob.get());
+        std::memcpy(p, &h, sizeof(h));
+        if (!in.read(reinterpret_cast<char*>(p + sizeof(h)),
+                     static_cast<std::streamsize>(h.file_size - sizeof(h)))) {
+            throw std::runtime_error("FlatForest: truncated stream");
+        }
+        adopt(std::move(blob), static_cast<std::size_t>(h.file_size), "stream");
+    }
+
+    // Maps a saved file read-only and scores it in place. The mapping lives
+    // as long as this FlatForest or any copy of it.
+    void map(const std::string& path) {
+        auto file = std::make_shared<MappedFile>(path);
+        const std::size_t size = file->size();
+        adopt(std::shared_ptr<const std::byte>(file, file->data()), size, path);
+    }
+
+    // Total size of the blob / file in bytes (0 when empty).
+    [[nodiscard]] std::size_t bytes() const noexcept { return hdr_ ? hdr_->file_size : 0; }
+    [[nodiscard]] double      c_psi() const noexcept { return c_psi_; }
+
+    [[nodiscard]] bool        empty() const noexcept { return n_trees_ == 0; }
+    [[nodiscard]] std::size_t n_trees() const noexcept { return n_trees_; }
+
+    // Sum over trees of the path length of x (the numerator of E[h(x)]).
+    [[nodiscard]] double path_sum(const Point& x) const noexcept {
+        double total = 0.0;
+        for (std::size_t t = 0; t < n_trees_; ++t) total += tree_path(t, x);
+        return total;
+    }
+
+    // s(x) = 2 ^ (-E[h(x)] / c(psi)) from a path_sum().
+    [[nodiscard]] double score_from_sum(double sum) const noexcept {
+        return std::exp2(-(sum / static_cast<double>(n_trees_)) / c_psi_);
+    }
+
+    // Scores pts[0..n) into out[0..n). out doubles as the per-point path
+    // sum accumulator, so there is no scratch allocation.
+    void score_batch(const Point* pts, std::size_t n, double* out) const noexcept {
+        for (std::size_t i = 0; i < n; ++i) out[i] = 0.0;
+        const std::size_t full = n - n % LANES;
+        for (std::size_t t = 0; t < n_trees_; ++t) {
+            for (std::size_t i = 0; i < full; i += LANES) {
+                accumulate_block(t, pts + i, IOTA, out + i);
+            }
+            for (std::size_t i = full; i < n; ++i) out[i] += tree_path(t, pts[i]);
+        }
+        for (std::size_t i = 0; i < n; ++i) out[i] = score_from_sum(out[i]);
+    }
+
+    // The maximum score over pts[0..n) and the first index reaching it,
+    // stopping the tree walks for a point as soon as its partial path sum
+    // proves it cannot matter:
+    //
+    //   - its lowest possible final sum (partial + min_suffix_) is above
+    //     some other point's highest possible one (partial + max_suffix_),
+    //     so it cannot beat the window max; or
+    //   - threshold > 0 and its lowest possible final sum is above the sum
+    //     that scores exactly threshold, so it cannot reach threshold.
+    //
+    // Points still descend together, tree-major, between bound checks.
+    // Surviving points accumulate in the same order as path_sum(), so with
+    // threshold <= 0 the result is bit-identical to a full score_batch()
+    // followed by a max scan. With a threshold, it is bit-identical whenever
+    // the true max is >= threshold. Otherwise every point may have been
+    // cut short, and score is then an upper bound on the true max that is
+    // itself below threshold, so `score >= threshold` is decided exactly
+    // either way.
+    //
+    // A relative slack of 1e-9 on every comparison absorbs rounding in
+    // the bound sums. That is several orders of magnitude above the
+    // worst-case summation error for any realistic forest size.
+    //
+    // sums and live are caller scratch of at least n elements each.
+    BoundedMax score_max(const Point* pts, std::size_t n, double threshold,
+                         double* sums, std::uint32_t* live) const noexcept {
+        constexpr double SLACK = 1e-9;
+        const double thr_sum = threshold > 0.0
+            ? -std::log2(threshold) * c_psi_ * static_cast<double>(n_trees_)
+            : std::numeric_limits<double>::infinity();
+
+        BoundedMax r;
+        double        cut_best = -1.0;   // best upper bound among cut points
+        std::uint32_t cut_idx  = 0;
+        std::size_t   n_live   = n;
+        for (std::size_t i = 0; i < n; ++i) {
+            sums[i] = 0.0;
+            live[i] = static_cast<std::uint32_t>(i);
+        }
+
+        for (std::size_t t0 = 0; t0 < n_trees_ && n_live > 0; t0 += BOUND_STRIDE) {
+            const std::size_t t1   = std::min(n_trees_, t0 + BOUND_STRIDE);
+            const std::size_t full = n_live - n_live % LANES;
+            for (std::size_t t = t0; t < t1; ++t) {
+                for (std::size_t j = 0; j < full; j += LANES) {
+                    accumulate_block(t, pts, live + j, sums);
+                }
+                for (std::size_t j = full; j < n_live; ++j) {
+                    sums[live[j]] += tree_path(t, pts[live[j]]);
+                }
+            }
+            if (t1 == n_trees_) break;
+
+            double min_hi = std::numeric_limits<double>::infinity();
+            for (std::size_t j = 0; j < n_live; ++j) {
+                min_hi = std::min(min_hi, sums[live[j]] + max_suffix_[t1]);
+            }
+            const double target = std::min(min_hi, thr_sum) * (1.0 + SLACK);
+
+            // Compact survivors in place; index order is preserved, which
+            // keeps first-index tie-breaking below.
+            std::size_t kept = 0;
+            for (std::size_t j = 0; j < n_live; ++j) {
+                const std::uint32_t i  = live[j];
+                const double        lo = (sums[i] + min_suffix_[t1]) * (1.0 - SLACK);
+                if (lo > target) {
+                    r.trees_skipped += n_trees_ - t1;
+                    const double bound = score_from_sum(lo);
+                    if (bound > cut_best) { cut_best = bound; cut_idx = i; }
+                } else {
+                    live[kept++] = i;
+                }
+            }
+            n_live = kept;
+        }
+
+        for (std::size_t j = 0; j < n_live; ++j) {
+            const double s = score_from_sum(sums[live[j]]);
+            if (s > r.score) { r.score = s; r.index = live[j]; }
+        }
+        if (cut_best > r.score) { r.score = cut_best; r.index = cut_idx; }
+        return r;
+    }
+
+private:
+    // Build-time arrays, before pack() lays them out in one blob.
+    struct Staging {
+        std::vector<std::uint32_t> tree_base, leaf_base;
+        std::vector<std::uint8_t>  feature;
+        std::vector<float>         split;
+        std::vector<std::uint16_t> child;
+        std::vector<double>        leaf_value;
+    };
+
+    template <typename Tree>
+    void append_tree(Staging& st, const Tree& tree) {
+        const auto& nodes = tree.nodes();
+        if (nodes.size() > 0xFFFF) {
+            throw std::length_error(
+                "FlatForest: tree has " + std::to_string(nodes.size()) +
+                " nodes; 16-bit local indices allow at most 65535");
+        }
+        const auto base      = static_cast<std::uint32_t>(st.feature.size());
+        const auto leaf_base = static_cast<std::uint32_t>(st.leaf_value.size());
+        st.tree_base.push_back(base);
+        st.leaf_base.push_back(leaf_base);
+        st.feature.resize(base + nodes.size());
+        st.split.resize(base + nodes.size());
+        st.child.resize(base + nodes.size());
+
+        // Breadth-first relayout. Each queue entry: (old index, depth).
+        struct Item { int old_idx; int depth; };
+        std::deque<Item> queue{ { tree.root(), 0 } };
+        std::uint32_t next = 1;        // new index 0 is the root
+        std::uint32_t cur  = 0;
+        std::uint16_t leaves = 0;
+        while (!queue.empty()) {
+            const Item it = queue.front();
+            queue.pop_front();
+            const auto& n = nodes[it.old_idx];
+            const std::uint32_t slot = base + cur++;
+            if (n.feature == -1) {
+                st.feature[slot] = LEAF;
+                st.split[slot]   = 0.0f;
+                st.child[slot]   = leaves++;
+                // Same expression as IsolationTree::path_length().
+                st.leaf_value.push_back(it.depth + Tree::c_factor(n.size_at_leaf));
+            } else {
+                st.feature[slot] = static_cast<std::uint8_t>(n.feature);
+                st.split[slot]   = n.split;
+                st.child[slot]   = static_cast<std::uint16_t>(next);
+                next += 2;
+                queue.push_back({ n.left,  it.depth + 1 });
+                queue.push_back({ n.right, it.depth + 1 });
+            }
+        }
+    }
+
+    static constexpr std::uint32_t IOTA[LANES] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+
+    double tree_path(std::size_t t, const Point& x) const noexcept {
+        const std::uint8_t*  feat  = feature_ + tree_base_[t];
+        const float*         split = split_   + tree_base_[t];
+        const std::uint16_t* child = child_   + tree_base_[t];
+        std::uint32_t node = 0;
+        while (feat[node] != LEAF) {
+            // !(x < split) rather than x >= split: NaN goes right, exactly
+            // like IsolationTree::path_length().
+            node = child[node] + (x[feat[node]] < split[node] ? 0u : 1u);
+        }
+        return leaf_value_[leaf_base_[t] + child[node]];
+    }
+
+    // Adds tree t's path length for pts[idx[0..LANES)] to acc[idx[...]];
+    // score_batch() passes IOTA for LANES consecutive points.
+    void accumulate_block(std::size_t t, const Point* pts, const std::uint32_t* idx,
+                          double* acc) const noexcept {
+        const std::uint8_t*  feat  = feature_ + tree_base_[t];
+        const float*         split = split_   + tree_base_[t];
+        const std::uint16_t* child = child_   + tree_base_[t];
+        const double*        leafv = leaf_value_ + leaf_base_[t];
+#if defined(__AVX2__)
+        static_assert(LANES == 8, "AVX2 path assumes 8 x 32-bit lanes");
+        static_assert(sizeof(Point) == D * sizeof(float),
+                      "AVX2 path gathers across an array of Points");
+        const float*  xs      = pts[0].data();
+        const __m256i lane_x  = _mm256_mullo_epi32(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(idx)),
+            _mm256_set1_epi32(static_cast<int>(D)));
+        const __m256i leaf    = _mm256_set1_epi32(LEAF);
+        const __m256i mask8   = _mm256_set1_epi32(0xFF);
+        const __m256i mask16  = _mm256_set1_epi32(0xFFFF);
+        const __m256i one     = _mm256_set1_epi32(1);
+        const int*    feat32  = reinterpret_cast<const int*>(feat);
+        const int*    child32 = reinterpret_cast<const int*>(child);
+
+        __m256i node = _mm256_setzero_si256();
+        for (;;) {
+            __m256i f = _mm256_and_si256(_mm256_i32gather_epi32(feat32, node, 1), mask8);
+            __m256i is_leaf = _mm256_cmpeq_epi32(f, leaf);
+            if (_mm256_movemask_epi8(is_leaf) == -1) break;
+            __m256  sp = _mm256_i32gather_ps(split, node, 4);
+            __m256i ch = _mm256_and_si256(_mm256_i32gather_epi32(child32, node, 2), mask16);
+            // Leaf lanes read feature 0 so the gather stays in bounds.
+            __m256i xi = _mm256_add_epi32(lane_x, _mm256_andnot_si256(is_leaf, f));
+            __m256  x  = _mm256_i32gather_ps(xs, xi, 4);
+            // lt lanes are all-ones (-1): step = 1 + lt -> 0 (left) or 1 (right).
+            __m256  lt   = _mm256_cmp_ps(x, sp, _CMP_LT_OQ);
+            __m256i step = _mm256_add_epi32(one, _mm256_castps_si256(lt));
+            node = _mm256_blendv_epi8(_mm256_add_epi32(ch, step), node, is_leaf);
+        }
+        __m256i leaf_id = _mm256_and_si256(_mm256_i32gather_epi32(child32, node, 2), mask16);
+        // Masked form with a zero source: the unmasked one trips GCC 12's
+        // -Wmaybe-uninitialized on its internal _mm256_undefined_pd().
+        const __m256d all = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+        __m256d lo = _mm256_mask_i32gather_pd(_mm256_setzero_pd(), leafv,
+                                              _mm256_castsi256_si128(leaf_id), all, 8);
+        __m256d hi = _mm256_mask_i32gather_pd(_mm256_setzero_pd(), leafv,
+                                              _mm256_extracti128_si256(leaf_id, 1), all, 8);
+        alignas(32) double add[LANES];
+        _mm256_store_pd(add,     lo);
+        _mm256_store_pd(add + 4, hi);
+        for (std::size_t l = 0; l < LANES; ++l) acc[idx[l]] += add[l];
+#else
+        std::uint32_t node[LANES] = {};
+        bool moving = true;
+        while (moving) {
+            moving = false;
+            for (std::size_t l = 0; l < LANES; ++l) {
+                const std::uint8_t f = feat[node[l]];
+                if (f == LEAF) continue;
+                node[l] = child[node[l]] + (pts[idx[l]][f] < split[node[l]] ? 0u : 1u);
+                moving = true;
+            }
+        }
+        for (std::size_t l = 0; l < LANES; ++l) acc[idx[l]] += leafv[child[node[l]]];
+#endif
+    }
+
+    void reset() noexcept {
+        const FlatForest empty;
+        *this = empty;
+    }
+
+    // Section offsets for the given counts; every section starts on a
+    // FlatForestHeader::ALIGN boundary. Slack: the AVX2 path gathers 32 bits
+    // at any u8 / u16 index, so feature gets 4 extra bytes, child 2 entries.
+    struct Layout {
+        std::uint64_t offset[FlatForestHeader::SECTIONS];
+        std::uint64_t total;
+    };
+    static Layout layout_for(std::uint64_t n_trees, std::uint64_t n_nodes,
+                             std::uint64_t n_leaves) noexcept {
+        const std::uint64_t sizes[FlatForestHeader::SECTIONS] = {
+            (n_trees + 1) * sizeof(std::uint32_t),   // TREE_BASE
+            (n_trees + 1) * sizeof(std::uint32_t),   // LEAF_BASE
+            (n_nodes + 4) * sizeof(std::uint8_t),    // FEATURE
+            n_nodes * sizeof(float),                 // SPLIT
+            (n_nodes + 2) * sizeof(std::uint16_t),   // CHILD
+            n_leaves * sizeof(double),               // LEAF_VALUE
+            (n_trees + 1) * sizeof(double),          // MIN_SUFFIX
+            (n_trees + 1) * sizeof(double),          // MAX_SUFFIX
+        };
+        constexpr std::uint64_t A = FlatForestHeader::ALIGN;
+        Layout l{};
+        std::uint64_t at = sizeof(FlatForestHeader);
+        for (std::size_t k = 0; k < FlatForestHeader::SECTIONS; ++k) {
+            l.offset[k] = at;
+            at = (at + sizes[k] + A - 1) / A * A;
+        }
+        l.total = at;
+        return l;
+    }
+
+    static std::shared_ptr<const std::byte> allocate(std::size_t n) {
+        constexpr std::size_t A = FlatForestHeader::ALIGN;
+        auto* p = static_cast<std::byte*>(PageAllocator::instance().allocate(n, A));
+        std::memset(p, 0, n);
+        return std::shared_ptr<const std::byte>(
+            p, [n](const std::byte* q) { PageAllocator::instance().deallocate(const_cast<std::byte*>(q), n, A); });
+    }
+
+    // Lays st out as a complete flat-file image, suffix bounds included.
+    static std::shared_ptr<const std::byte> pack(const Staging& st, double c_psi) {
+        const std::uint64_t n_trees  = st.tree_base.size() - 1;
+        const std::uint64_t n_nodes  = st.feature.size();
+        const std::uint64_t n_leaves = st.leaf_value.size();
+        const Layout l = layout_for(n_trees, n_nodes, n_leaves);
+
+        auto blob = allocate(static_cast<std::size_t>(l.total));
+        std::byte* p = const_cast<std::byte*>(blob.get());
+
+        FlatForestHeader h{};
+        std::memcpy(h.magic, FlatForestHeader::MAGIC, sizeof(h.magic));
+        h.version    = FlatForestHeader::VERSION;
+        h.byte_order = FlatForestHeader::ENDIAN_TAG;
+        h.dim        = static_cast<std::uint32_t>(D);
+        h.n_trees    = static_cast<std::uint32_t>(n_trees);
+        h.n_nodes    = static_cast<std::uint32_t>(n_nodes);
+        h.n_leaves   = static_cast<std::uint32_t>(n_leaves);
+        h.c_psi      = c_psi;
+        h.file_size  = l.total;
+        for (std::size_t k = 0; k < FlatForestHeader::SECTIONS; ++k) h.offset[k] = l.offset[k];
+        std::memcpy(p, &h, sizeof(h));
+
+        auto put = [&](std::size_t sec, const auto& v) {
+            std::memcpy(p + l.offset[sec], v.data(), v.size() * sizeof(v[0]));
+        };
+        put(FlatForestHeader::TREE_BASE,  st.tree_base);
+        put(FlatForestHeader::LEAF_BASE,  st.leaf_base);
+        put(FlatForestHeader::FEATURE,    st.feature);
+        put(FlatForestHeader::SPLIT,      st.split);
+        put(FlatForestHeader::CHILD,      st.child);
+        put(FlatForestHeader::LEAF_VALUE, st.leaf_value);
+        std::memset(p + l.offset[FlatForestHeader::FEATURE] + n_nodes, LEAF, 4);
+
+        // min/max suffix [t]: bounds on what trees t.. can still add to a
+        // path sum, from each tree's shallowest / deepest leaf value.
+        std::vector<double> lo(n_trees + 1, 0.0), hi(n_trees + 1, 0.0);
+        suffix_bounds(st.leaf_base.data(), st.leaf_value.data(), n_trees, lo.data(), hi.data());
+        put(FlatForestHeader::MIN_SUFFIX, lo);
+        put(FlatForestHeader::MAX_SUFFIX, hi);
+        return blob;
+    }
+
+    static void suffix_bounds(const std::uint32_t* leaf_base, const double* leaf_value,
+                              std::uint64_t n_trees, double* lo, double* hi) {
+        lo[n_trees] = hi[n_trees] = 0.0;
+        for (std::uint64_t t = n_trees; t-- > 0;) {
+            const double* first = leaf_value + leaf_base[t];
+            const double* last  = leaf_value + leaf_base[t + 1];
+            lo[t] = lo[t + 1] + *std::min_element(first, last);
+            hi[t] = hi[t + 1] + *std::max_element(first, last);
+        }
+    }
+
+    // Validates a blob completely before pointing the scoring arrays into
+    // it, so a truncated or corrupt file fails here instead of walking off
+    // the end of a tree. One pass over the nodes; no copies.
+    void adopt(std::shared_ptr<const std::byte> blob, std::size_t avail, const std::string& what) {
+        auto fail = [&](const char* why) {
+            throw std::runtime_error("FlatForest: " + what + ": " + why);
+        };
+        const std::byte* p = blob.get();
+        if (avail < sizeof(FlatForestHeader)) fail("shorter than a header");
+        if (reinterpret_cast<std::uintptr_t>(p) % alignof(FlatForestHeader) != 0) fail("misaligned");
+
+        FlatForestHeader h;
+        std::memcpy(&h, p, sizeof(h));
+        if (std::memcmp(h.magic, FlatForestHeader::MAGIC, sizeof(h.magic)) != 0) fail("bad magic");
+        if (h.version != FlatForestHeader::VERSION) fail("unsupported version");
+        if (h.byte_order != FlatForestHeader::ENDIAN_TAG) fail("written with another byte order");
+        if (h.dim != D) fail("feature dimension does not match");
+        const Layout l = layout_for(h.n_trees, h.n_nodes, h.n_leaves);
+        if (h.file_size != l.total || h.file_size != avail) fail("size does not match header");
+        for (std::size_t k = 0; k < FlatForestHeader::SECTIONS; ++k) {
+            if (h.offset[k] != l.offset[k]) fail("section table does not match counts");
+        }
+
+        auto at = [&](std::size_t sec) { return p + l.offset[sec]; };
+        const auto* tb = reinterpret_cast<const std::uint32_t*>(at(FlatForestHeader::TREE_BASE));
+        const auto* lb = reinterpret_cast<const std::uint32_t*>(at(FlatForestHeader::LEAF_BASE));
+        const auto* ft = reinterpret_cast<const std::uint8_t*>(at(FlatForestHeader::FEATURE));
+        const auto* ch = reinterpret_cast<const std::uint16_t*>(at(FlatForestHeader::CHILD));
+        const auto* lv = reinterpret_cast<const double*>(at(FlatForestHeader::LEAF_VALUE));
+        const auto* lo = reinterpret_cast<const double*>(at(FlatForestHeader::MIN_SUFFIX));
+        const auto* hi = reinterpret_cast<const double*>(at(FlatForestHeader::MAX_SUFFIX));
+
+        if (tb[0] != 0 || tb[h.n_trees] != h.n_nodes) fail("bad tree offset table");
+        if (lb[0] != 0 || lb[h.n_trees] != h.n_leaves) fail("bad leaf offset table");
+        for (std::uint32_t t = 0; t < h.n_trees; ++t) {
+            if (tb[t + 1] <= tb[t] || tb[t + 1] - tb[t] > 0xFFFF) fail("bad tree extent");
+            if (lb[t + 1] <= lb[t]) fail("bad leaf extent");
+            const std::uint32_t nodes  = tb[t + 1] - tb[t];
+            const std::uint32_t leaves = lb[t + 1] - lb[t];
+            // Children strictly after their parent => every descent ends.
+            for (std::uint32_t n = 0; n < nodes; ++n) {
+                const std::uint8_t  f = ft[tb[t] + n];
+                const std::uint16_t c = ch[tb[t] + n];
+                if (f == LEAF) {
+                    if (c >= leaves) fail("leaf id out of range");
+                } else if (f >= D || c <= n || std::uint32_t{c} + 1 >= nodes) {
+                    fail("bad internal node");
+                }
+            }
+        }
+        std::vector<double> want_lo(h.n_trees + 1), want_hi(h.n_trees + 1);
+        suffix_bounds(lb, lv, h.n_trees, want_lo.data(), want_hi.data());
+        if (std::memcmp(want_lo.data(), lo, want_lo.size() * sizeof(double)) != 0 ||
+            std::memcmp(want_hi.data(), hi, want_hi.size() * sizeof(double)) != 0) {
+            fail("stale early-exit bounds");
+        }
+
+        blob_       = std::move(blob);
+        hdr_        = reinterpret_cast<const FlatForestHeader*>(p);
+        tree_base_  = tb;
+        leaf_base_  = lb;
+        feature_    = ft;
+        split_      = reinterpret_cast<const float*>(at(FlatForestHeader::SPLIT));
+        child_      = ch;
+        leaf_value_ = lv;
+        min_suffix_ = lo;
+        max_suffix_ = hi;
+        c_psi_      = h.c_psi;
+        n_trees_    = h.n_trees;
+    }
+
+    // Owns the heap blob or the MappedFile; copies share it (read-only).
+    std::shared_ptr<const std::byte> blob_;
+    const FlatForestHeader*          hdr_        = nullptr;
+    const std::uint32_t*             tree_base_  = nullptr;
+    const std::uint32_t*             leaf_base_  = nullptr;
+    const std::uint8_t*              feature_    = nullptr;
+    const float*                     split_      = nullptr;
+    const std::uint16_t*             child_      = nullptr;
+    const double*                    leaf_value_ = nullptr;
+    const double*                    min_suffix_ = nullptr;
+    const double*                    max_suffix_ = nullptr;
+    double                           c_psi_      = 1.0;
+    std::size_t                      n_trees_    = 0;
+};
+
+} // namespace klstream
@@ -1,14 +1,22 @@
 #pragma once
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cmath>
 #include <cstdint>
+#include <cstring>
+#include <fstream>
 #include <iostream>
 #include <limits>
 #include <memory>
 #include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
 #include <vector>
 
+#include "flat_forest.hpp"
+
 namespace klstream {
 
 // ── IsolationTree ─────────────────────────────────────────────────────────
@@ -37,9 +45,18 @@ public:
     // Builds the tree from `points` (a sub-sample already drawn by the
     // caller — IsolationForest::fit handles sampling, Section 12 below).
     void build(std::vector<Point> points, int height_limit, std::mt19937& rng) {
+        build(points.data(), points.size(), height_limit, rng);
+    }
+
+    // Same, over caller-owned storage that is partitioned in place: each
+    // node reorders its [first, last) range around the split instead of
+    // copying into fresh left/right vectors. The tree depends only on the
+    // set of points, not their order, so this builds exactly what the
+    // copying version did for the same rng.
+    void build(Point* points, std::size_t n, int height_limit, std::mt19937& rng) {
         nodes_.clear();
-        nodes_.reserve(2 * points.size());
-        root_ = build_node(points, 0, height_limit, rng);
+        nodes_.reserve(2 * n);
+        root_ = build_node(points, points + n, 0, height_limit, rng);
     }
 
     // Path length for a single query point, with the Liu et al. correction
@@ -69,6 +86,10 @@ public:
              - 2.0 * static_cast<double>(n - 1) / static_cast<double>(n);
     }
 
+    // Read-only views used by FlatForest::build() to relayout the tree.
+    const std::vector<Node>& nodes() const { return nodes_; }
+    int root() const { return root_; }
+
     void save(std::ostream& out) const {
         std::size_t n = nodes_.size();
         out.write(reinterpret_cast<const char*>(&n), sizeof(n));
@@ -85,11 +106,12 @@ public:
     }
 
 private:
-    int build_node(std::vector<Point>& points, int depth, int height_limit,
+    int build_node(Point* first, Point* last, int depth, int height_limit,
                     std::mt19937& rng) {
         Node n;
-        if (depth >= height_limit || points.size() <= 1) {
-            n.size_at_leaf = static_cast<int>(points.size());
+        const auto count = static_cast<int>(last - first);
+        if (depth >= height_limit || count <= 1) {
+            n.size_at_leaf = count;
             nodes_.push_back(n);
             return static_cast<int>(nodes_.size()) - 1;
         }
@@ -104,14 +126,14 @@ private:
             int f = feat_dist(rng);
             float mn = std::numeric_limits<float>::max();
             float mx = std::numeric_limits<float>::lowest();
-            for (const auto& p : points) {
-                mn = std::min(mn, p[f]);
-                mx = std::max(mx, p[f]);
+            for (const Point* p = first; p != last; ++p) {
+                mn = std::min(mn, (*p)[f]);
+                mx = std::max(mx, (*p)[f]);
             }
             if (mx > mn) { feature = f; lo = mn; hi = mx; break; }
         }
         if (feature == -1) {
-            n.size_at_leaf = static_cast<int>(points.size());
+            n.size_at_leaf = count;
             nodes_.push_back(n);
             return static_cast<int>(nodes_.size()) - 1;
         }
@@ -119,15 +141,11 @@ private:
         std::uniform_real_distribution<float> split_dist(lo, hi);
         float split = split_dist(rng);
 
-        std::vector<Point> left_pts, right_pts;
-        left_pts.reserve(points.size());
-        right_pts.reserve(points.size());
-        for (const auto& p : points) {
-            (p[feature] < split ? left_pts : right_pts).push_back(p);
-        }
+        Point* mid = std::partition(first, last,
+            [&](const Point& p) { return p[feature] < split; });
         // Degenerate split guard (all points landed on one side).
-        if (left_pts.empty() || right_pts.empty()) {
-            n.size_at_leaf = static_cast<int>(points.size());
+        if (mid == first || mid == last) {
+            n.size_at_leaf = count;
             nodes_.push_back(n);
             return static_cast<int>(nodes_.size()) - 1;
         }
@@ -136,8 +154,8 @@ private:
         n.split   = split;
         int self_idx = static_cast<int>(nodes_.size());
         nodes_.push_back(n);                       // reserve slot first
-        int left_idx  = build_node(left_pts,  depth + 1, height_limit, rng);
-        int right_idx = build_node(right_pts, depth + 1, height_limit, rng);
+        int left_idx  = build_node(first, mid, depth + 1, height_limit, rng);
+        int right_idx = build_node(mid,  last, depth + 1, height_limit, rng);
         nodes_[self_idx].left  = left_idx;
         nodes_[self_idx].right = right_idx;
         return self_idx;
@@ -156,56 +174,124 @@ private:
 //     s(x, psi) = 2 ^ ( -E[h(x)] / c(psi) )
 // Score approaches 1.0 for anomalies (short average path), approaches 0.5
 // or below for normal points (path length near c(psi)).
+//
+// The trees are kept for training and (de)serialisation; scoring runs on a
+// FlatForest rebuilt from them after every fit()/load(). score_batch() is
+// the hot-path entry point (InferenceOp); anomaly_score() scores one point
+// through the same layout and returns bit-identical values.
 template <std::size_t D>
 class IsolationForest {
 public:
-    using Point = typename IsolationTree<D>::Point;
+    using Point      = typename IsolationTree<D>::Point;
+    using BoundedMax = typename FlatForest<D>::BoundedMax;
 
     IsolationForest(int n_estimators = 100, int sub_sample_size = 256,
                     std::uint32_t seed = 42)
         : n_estimators_(n_estimators)
         , psi_(sub_sample_size)
-        , rng_(seed)
+        , seed_(seed)
     {}
 
     // points: the full calm-period training set (Section 26 covers
     // validating this against sklearn on a held-out split).
-    void fit(const std::vector<Point>& points) {
+    //
+    // Trees are built in parallel on n_threads threads (0 = one per
+    // hardware thread). Tree t draws everything from its own mt19937,
+    // seeded from (seed, t) alone, so the forest is a pure function of the
+    // seed and the training set — identical for any n_threads, including 1.
+    //
+    // Per tree: a psi-point sample drawn without replacement in O(psi)
+    // (Floyd's algorithm), copied once into a per-thread buffer that
+    // build() then partitions in place. Nothing scales with the training
+    // set except reading the sampled points.
+    void fit(const std::vector<Point>& points, unsigned n_threads = 0) {
         int height_limit = static_cast<int>(std::ceil(std::log2(
             static_cast<double>(std::max(2, psi_)))));
-        trees_.clear();
-        trees_.reserve(n_estimators_);
-        std::uniform_int_distribution<std::size_t> idx_dist(0, points.size() - 1);
-
-        for (int t = 0; t < n_estimators_; ++t) {
-            std::vector<Point> sample;
-            sample.reserve(psi_);
-            // Sampling without replacement within one tree, as in the
-            // original paper; reseed per tree off the forest's own rng so
-            // results are reproducible given a fixed `seed`.
-            std::vector<std::size_t> indices(points.size());
-            for (std::size_t i = 0; i < indices.size(); ++i) indices[i] = i;
-            std::shuffle(indices.begin(), indices.end(), rng_);
-            int take = std::min(psi_, static_cast<int>(points.size()));
-            for (int i = 0; i < take; ++i) sample.push_back(points[indices[i]]);
-
-            IsolationTree<D> tree;
-            tree.build(std::move(sample), height_limit, rng_);
-            trees_.push_back(std::move(tree));
-        }
+        trees_.assign(static_cast<std::size_t>(std::max(0, n_estimators_)), IsolationTree<D>{});
+        const std::size_t take = std::min(static_cast<std::size_t>(std::max(0, psi_)), points.size());
+
+        std::atomic<std::size_t> next{0};
+        auto worker = [&] {
+            std::vector<Point>         sample(take);
+            std::vector<std::uint64_t> table;   // Floyd's set, reused per tree
+            for (std::size_t t; (t = next.fetch_add(1, std::memory_order_relaxed)) < trees_.size();) {
+                std::mt19937 rng = tree_rng(t);
+                draw_sample(points, take, rng, table, sample.data());
+                trees_[t].build(sample.data(), take, height_limit, rng);
+            }
+        };
+
+        if (n_threads == 0) n_threads = std::max(1u, std::thread::hardware_concurrency());
+        n_threads = static_cast<unsigned>(std::min<std::size_t>(n_threads, trees_.size()));
+        std::vector<std::thread> pool;
+        for (unsigned k = 1; k < n_threads; ++k) pool.emplace_back(worker);
+        worker();   // this thread is worker 0
+        for (auto& th : pool) th.join();
+
         c_psi_ = IsolationTree<D>::c_factor(psi_);
+        flat_.build(trees_, c_psi_);
     }
 
     [[nodiscard]] double anomaly_score(const Point& x) const {
-        double total = 0.0;
-        for (const auto& tree : trees_) total += tree.path_length(x);
-        double avg_path = total / static_cast<double>(trees_.size());
-        return std::pow(2.0, -avg_path / c_psi_);
+        return flat_.score_from_sum(flat_.path_sum(x));
     }
 
-    [[nodiscard]] std::size_t n_trees() const { return trees_.size(); }
+    // Scores pts[0..n) into out[0..n). Points are pushed through each tree
+    // together (SIMD across points where available); see FlatForest.
+    void score_batch(const Point* pts, std::size_t n, double* out) const {
+        flat_.score_batch(pts, n, out);
+    }
+
+    // Max score over pts[0..n) with per-point early exit; threshold <= 0
+    // disables the threshold cut. sums / live: scratch of n elements. See
+    // FlatForest::score_max() for exactly what is guaranteed.
+    BoundedMax score_max(const Point* pts, std::size_t n, double threshold,
+                         double* sums, std::uint32_t* live) const {
+        return flat_.score_max(pts, n, threshold, sums, live);
+    }
+
+    [[nodiscard]] std::size_t n_trees() const { return flat_.n_trees(); }
+
+    // ── Flat format ──────────────────────────────────────────────────────
+    // save_flat() writes the scoring layout as one versioned, aligned blob
+    // (see FlatForestHeader); map_flat() maps such a file read-only and
+    // scores it in place; load_flat() reads one from a stream. A forest
+    // obtained either way carries no IsolationTree objects, so it can score
+    // and save_flat() but not save() in the tree-by-tree format below.
+    void save_flat(std::ostream& out) const { flat_.save(out); }
+
+    void load_flat(std::istream& in) {
+        flat_.load(in);
+        adopt_flat();
+    }
+
+    void map_flat(const std::string& path) {
+        flat_.map(path);
+        adopt_flat();
+    }
+
+    // A forest file written by train_forest in either format: flat files
+    // (FlatForestHeader) are mapped read-only and scored in place; older
+    // tree-by-tree files are deserialised with load().
+    void load_file(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) throw std::runtime_error("failed to open forest path: " + path);
+        char magic[sizeof(FlatForestHeader::MAGIC)] = {};
+        in.read(magic, sizeof(magic));
+        if (in && std::memcmp(magic, FlatForestHeader::MAGIC, sizeof(magic)) == 0) {
+            in.close();
+            map_flat(path);
+            return;
+        }
+        in.clear();
+        in.seekg(0);
+        load(in);
+    }
 
     void save(std::ostream& out) const {
+        if (trees_.empty() && !flat_.empty()) {
+            throw std::logic_error("IsolationForest::save: forest was loaded flat; use save_flat()");
+        }
         out.write(reinterpret_cast<const char*>(&n_estimators_), sizeof(n_estimators_));
         out.write(reinterpret_cast<const char*>(&psi_), sizeof(psi_));
         out.write(reinterpret_cast<const char*>(&c_psi_), sizeof(c_psi_));
@@ -226,14 +312,66 @@ public:
         for (auto& tree : trees_) {
             tree.load(in);
         }
+        flat_.build(trees_, c_psi_);
     }
 
 private:
+    // SplitMix64 finaliser over (seed, t): decorrelated per-tree streams
+    // without any shared generator state between threads.
+    std::mt19937 tree_rng(std::size_t t) const {
+        std::uint64_t z = (std::uint64_t{seed_} << 32) + t + 0x9E3779B97F4A7C15ULL;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        z ^= z >> 31;
+        std::seed_seq seq{ static_cast<std::uint32_t>(z), static_cast<std::uint32_t>(z >> 32) };
+        return std::mt19937(seq);
+    }
+
+    // Floyd's algorithm: `take` distinct indices from [0, N) with O(take)
+    // draws and an open-addressing set of ~2*take slots; the sampled points
+    // are written to out. take == N copies the whole set.
+    static void draw_sample(const std::vector<Point>& points, std::size_t take,
+                            std::mt19937& rng, std::vector<std::uint64_t>& table,
+                            Point* out) {
+        const std::size_t n = points.size();
+        if (take == n) {
+            std::copy(points.begin(), points.end(), out);
+            return;
+        }
+        std::size_t cap = 16;
+        while (cap < 2 * take) cap <<= 1;
+        constexpr std::uint64_t EMPTY = ~std::uint64_t{0};
+        table.assign(cap, EMPTY);
+        auto insert = [&](std::uint64_t v) {   // false if already present
+            std::size_t h = static_cast<std::size_t>((v * 0x9E3779B97F4A7C15ULL) >> 32) & (cap - 1);
+            while (table[h] != EMPTY) {
+                if (table[h] == v) return false;
+                h = (h + 1) & (cap - 1);
+            }
+            table[h] = v;
+            return true;
+        };
+        std::size_t k = 0;
+        for (std::size_t j = n - take; j < n; ++j) {
+            std::uniform_int_distribution<std::size_t> dist(0, j);
+            std::uint64_t v = dist(rng);
+            if (!insert(v)) { v = j; insert(v); }
+            out[k++] = points[v];
+        }
+    }
+
+    void adopt_flat() {
+        trees_.clear();
+        c_psi_        = flat_.c_psi();
+        n_estimators_ = static_cast<int>(flat_.n_trees());
+    }
+
     int                            n_estimators_;
     int                            psi_;
-    std::mt19937                   rng_;
+    std::uint32_t                  seed_;
     double                         c_psi_ = 1.0;
     std::vector<IsolationTree<D>>  trees_;
+    FlatForest<D>                  flat_;
 };
 
 } // namespace klstream
@@ -1,10 +1,17 @@
 // include/klstream/operators/aggregate.hpp
 #pragma once
 #include "../core/operator.hpp"
+#include "../core/batch.hpp"
+#include "../core/checkpoint.hpp"
+#include "../core/keyed_state.hpp"
 #include "../core/event.hpp"
 #include "../core/spsc_queue.hpp"
 #include "../core/metrics.hpp"
+#include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <type_traits>
+#include <vector>
 
 namespace klstream {
 
@@ -24,6 +31,9 @@ namespace klstream {
 //       0ULL,                                   // initial state
 //       [](uint64_t& st, uint64_t x){ st += x; },  // accumulate
 //       [](const uint64_t& st){ return st; });      // extract
+//
+// A trivially copyable State can be checkpointed (Checkpointer::add): the
+// running state is copied out at the barrier.
 template <typename In, typename State, typename Out>
 class AggregateOperator : public IOperator {
 public:
@@ -47,7 +57,40 @@ public:
 
     void attach_metrics(OperatorMetrics* m) override { metrics_ = m; }
 
+    // Batch mode: move up to n events per tick() via try_pop_n / try_push_n,
+    // amortising the virtual tick() call and the queue index publication.
+    // n == 1 (the default) keeps the one-event-per-tick behaviour. Must be
+    // called before the runtime starts.
+    void set_batch_size(std::size_t n) {
+        batch_size_ = n < 1 ? 1 : n;
+        in_batch_.resize(batch_size_);
+        out_batch_.set_capacity(batch_size_);
+    }
+
+    bool ready() const noexcept override { return has_pending_ || !out_batch_.empty() || !input_->empty(); }
+    void wake_on_input(Parker* p) override { input_->set_waker(p); }
+
+    bool attach_checkpoint(CheckpointPort* port) override {
+        if constexpr (!std::is_trivially_copyable_v<State>) return false;
+        port_ = port;
+        return true;
+    }
+
+    void snapshot(StateWriter& out) const override {
+        if constexpr (std::is_trivially_copyable_v<State>) out.put(state_);
+    }
+
+    void restore(StateReader& in) override {
+        if constexpr (std::is_trivially_copyable_v<State>) state_ = in.get<State>();
+    }
+
+    // The running state. Only meaningful from the operator's own thread or
+    // after the runtime has stopped.
+    const State& state() const noexcept { return state_; }
+
     OpStatus tick() override {
+        if (batch_size_ > 1) return tick_batch();
+
         if (has_pending_) {
             if (output_->try_push(pending_)) {
                 has_pending_ = false;
@@ -60,9 +103,11 @@ public:
 
         Event<In> in_ev;
         if (!input_->try_pop(&in_ev)) {
+            if (port_) port_->arrive();
             if (metrics_) metrics_->events_idle.increment();
             return OpStatus::Idle;
         }
+        if (port_) port_->arrive(in_ev.seq);
 
         accum_(state_, in_ev.data);
 
@@ -70,6 +115,7 @@ public:
         out_ev.timestamp_ns = in_ev.timestamp_ns;
         out_ev.key          = in_ev.key;
         out_ev.seq          = in_ev.seq;
+        out_ev.event_ts_ns  = in_ev.event_ts_ns;
         out_ev.data         = extract_(state_);
 
         if (output_->try_push(out_ev)) {
@@ -84,6 +130,30 @@ public:
     }
 
 private:
+    OpStatus tick_batch() {
+        if (!out_batch_.empty()) return flush_pending(out_batch_, *output_, metrics_);
+
+        const std::size_t n = input_->try_pop_n(in_batch_.data(), batch_size_);
+        if (n == 0) {
+            if (port_) port_->arrive();
+            if (metrics_) metrics_->events_idle.increment();
+            return OpStatus::Idle;
+        }
+        for (std::size_t i = 0; i < n; ++i) {
+            const Event<In>& in_ev = in_batch_[i];
+            if (port_) port_->arrive(in_ev.seq);
+            accum_(state_, in_ev.data);
+            Event<Out> out_ev;
+            out_ev.timestamp_ns = in_ev.timestamp_ns;
+            out_ev.key          = in_ev.key;
+            out_ev.seq          = in_ev.seq;
+            out_ev.event_ts_ns  = in_ev.event_ts_ns;
+            out_ev.data         = extract_(state_);
+            out_batch_.append(out_ev);
+        }
+        return flush_pending(out_batch_, *output_, metrics_);
+    }
+
     InQueue*         input_;
     OutQueue*        output_;
     State            state_;
@@ -92,6 +162,137 @@ private:
     Event<Out>       pending_{};
     bool             has_pending_{false};
     OperatorMetrics* metrics_{nullptr};
+    std::size_t              batch_size_{1};
+    std::vector<Event<In>>   in_batch_;
+    PendingBatch<Event<Out>> out_batch_;
+    CheckpointPort*          port_{nullptr};
+};
+
+// ── KeyedAggregateOperator<In, State, Out> ───────────────────────────────
+//
+// AggregateOperator with one State per Event::key, each starting as a copy
+// of `init_state`. Every input emits extract() of its own key's state, with
+// the key forwarded. Run N of them behind a PartitionOperator to spread a
+// keyed aggregation over N workers: each replica sees — and holds state
+// for — only the keys in its partition.
+//
+// Example — per-campaign view counts:
+//   KeyedAggregateOperator<AdView, uint64_t, uint64_t> views(
+//       "views", &q_in, &q_out, 0ULL,
+//       [](uint64_t& n, const AdView&) { ++n; },
+//       [](const uint64_t& n) { return n; });
+template <typename In, typename State, typename Out>
+class KeyedAggregateOperator : public IOperator {
+public:
+    using InQueue    = SPSCQueue<Event<In>>;
+    using OutQueue   = SPSCQueue<Event<Out>>;
+    using AccumFn    = std::function<void(State&, const In&)>;
+    using ExtractFn  = std::function<Out(const State&)>;
+
+    KeyedAggregateOperator(std::string name,
+                           InQueue*   input,
+                           OutQueue*  output,
+                           State      init_state,
+                           AccumFn    accum,
+                           ExtractFn  extract)
+        : IOperator(std::move(name))
+        , input_(input), output_(output)
+        , init_(std::move(init_state))
+        , accum_(std::move(accum))
+        , extract_(std::move(extract))
+    {}
+
+    void attach_metrics(OperatorMetrics* m) override { metrics_ = m; }
+
+    // Batch mode, as AggregateOperator. Must be called before the runtime
+    // starts.
+    void set_batch_size(std::size_t n) {
+        batch_size_ = n < 1 ? 1 : n;
+        in_batch_.resize(batch_size_);
+        out_batch_.set_capacity(batch_size_);
+    }
+
+    bool ready() const noexcept override { return has_pending_ || !out_batch_.empty() || !input_->empty(); }
+    void wake_on_input(Parker* p) override { input_->set_waker(p); }
+
+    // Distinct keys seen. Only meaningful from the operator's own thread
+    // or after the runtime has stopped.
+    std::size_t keys() const noexcept { return states_.size(); }
+
+    // State of `key`, or nullptr if it has not been seen. Same caveat; the
+    // pointer is invalidated by the next new key.
+    const State* state(std::uint64_t key) const {
+        return states_.find(key);
+    }
+
+    OpStatus tick() override {
+        if (batch_size_ > 1) return tick_batch();
+
+        if (has_pending_) {
+            if (output_->try_push(pending_)) {
+                has_pending_ = false;
+                if (metrics_) metrics_->events_processed.increment();
+                return OpStatus::Processed;
+            }
+            if (metrics_) metrics_->events_blocked.increment();
+            return OpStatus::Blocked;
+        }
+
+        Event<In> in_ev;
+        if (!input_->try_pop(&in_ev)) {
+            if (metrics_) metrics_->events_idle.increment();
+            return OpStatus::Idle;
+        }
+
+        const Event<Out> out_ev = apply(in_ev);
+        if (output_->try_push(out_ev)) {
+            if (metrics_) metrics_->events_processed.increment();
+            return OpStatus::Processed;
+        }
+
+        pending_     = out_ev;
+        has_pending_ = true;
+        if (metrics_) metrics_->events_blocked.increment();
+        return OpStatus::Blocked;
+    }
+
+private:
+    OpStatus tick_batch() {
+        if (!out_batch_.empty()) return flush_pending(out_batch_, *output_, metrics_);
+
+        const std::size_t n = input_->try_pop_n(in_batch_.data(), batch_size_);
+        if (n == 0) {
+            if (metrics_) metrics_->events_idle.increment();
+            return OpStatus::Idle;
+        }
+        for (std::size_t i = 0; i < n; ++i) out_batch_.append(apply(in_batch_[i]));
+        return flush_pending(out_batch_, *output_, metrics_);
+    }
+
+    Event<Out> apply(const Event<In>& in_ev) {
+        State& st = states_.get_or_insert(in_ev.key, init_);
+        accum_(st, in_ev.data);
+        Event<Out> out_ev;
+        out_ev.timestamp_ns = in_ev.timestamp_ns;
+        out_ev.key          = in_ev.key;
+        out_ev.seq          = in_ev.seq;
+        out_ev.event_ts_ns  = in_ev.event_ts_ns;
+        out_ev.data         = extract_(st);
+        return out_ev;
+    }
+
+    InQueue*         input_;
+    OutQueue*        output_;
+    State            init_;
+    AccumFn          accum_;
+    ExtractFn        extract_;
+    KeyedStateStore<State> states_;
+    Event<Out>       pending_{};
+    bool             has_pending_{false};
+    OperatorMetrics* metrics_{nullptr};
+    std::size_t              batch_size_{1};
+    std::vector<Event<In>>   in_batch_;
+    PendingBatch<Event<Out>> out_batch_;
 };
 
 } // namespace klstream
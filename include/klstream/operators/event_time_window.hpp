@@ -0,0 +1,203 @@
+// include/klstream/operators/event_time_window.hpp
+#pragma once
+#include "../core/operator.hpp"
+#include "../core/batch.hpp"
+#include "../core/keyed_state.hpp"
+#include "../core/event.hpp"
+#include "../core/spsc_queue.hpp"
+#include "../core/metrics.hpp"
+#include "../core/watermark.hpp"
+#include "incremental_window.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace klstream {
+
+// ── EventTimeWindow<T, Acc, Out> ──────────────────────────────────────────
+//
+// Tumbling windows in event time: each event folds (WindowAggregate) into
+// the window [k * size, (k + 1) * size) holding its event_ts_ns, and a
+// window closes when the Watermark passes its end — never on the wall
+// clock. The same input therefore yields the same windows whether it is
+// replayed at MaxRate, paced, or live, and however the machine is loaded.
+//
+// Windows are aligned to multiples of `size` from event time zero, and
+// several stay open at once when events arrive out of order (up to the
+// watermark bound). With per_key set each window holds one Acc per
+// Event::key and closes with one output per key; otherwise one in all.
+//
+// Outputs: event_ts_ns = window start, seq = window index (start / size),
+// key = the key (0 if !per_key), timestamp_ns = arrival time of the
+// window's first event, so sink latency still measures processing delay.
+//
+// Late events — in a window the watermark has already passed — are
+// dropped and counted (late_events()). Whether an event is late depends
+// only on the events before it, so batching does not change the result.
+// A closed window is drained into the output at most batch_size() results
+// per tick(), as in IncrementalTimeWindow; its accumulator store is then
+// reused by a later window.
+template <typename T, typename Acc, typename Out>
+class EventTimeWindow : public IOperator {
+public:
+    using InQueue   = SPSCQueue<Event<T>>;
+    using OutQueue  = SPSCQueue<Event<Out>>;
+    using Aggregate = WindowAggregate<T, Acc, Out>;
+
+    EventTimeWindow(std::string name,
+                    InQueue*    input,
+                    OutQueue*   output,
+                    std::chrono::nanoseconds size,
+                    Aggregate   agg,
+                    std::chrono::nanoseconds max_out_of_order = std::chrono::nanoseconds(0),
+                    bool        per_key = false)
+        : IOperator(std::move(name))
+        , input_(input), output_(output)
+        , size_ns_(size.count() < 1 ? 1 : static_cast<std::uint64_t>(size.count()))
+        , agg_(std::move(agg)), watermark_(max_out_of_order), per_key_(per_key)
+    {
+        set_batch_size(1);
+    }
+
+    void attach_metrics(OperatorMetrics* m) override { metrics_ = m; }
+
+    // Events popped, and closed-window results emitted, per tick(). Must be
+    // called before the runtime starts.
+    void set_batch_size(std::size_t n) {
+        batch_size_ = n < 1 ? 1 : n;
+        in_batch_.resize(batch_size_);
+        out_batch_.set_capacity(batch_size_);
+    }
+
+    bool ready() const noexcept override {
+        return !out_batch_.empty() || !closing_.empty() || !input_->empty()
+            || pushed_wm_.load(std::memory_order_relaxed) > watermark_.current();
+    }
+    void wake_on_input(Parker* p) override { input_->set_waker(p); }
+
+    // Raises the watermark to `ts` from any thread; windows ending by then
+    // close on the next tick(). advance_watermark(Watermark::MAX) at the
+    // end of a replay closes everything still open. Events still in flight
+    // upstream with an earlier event time become late.
+    void advance_watermark(std::uint64_t ts) noexcept {
+        std::uint64_t cur = pushed_wm_.load(std::memory_order_relaxed);
+        while (ts > cur && !pushed_wm_.compare_exchange_weak(cur, ts, std::memory_order_relaxed)) {}
+    }
+
+    // Current event-time watermark. Only meaningful from the operator's
+    // own thread or after the runtime has stopped (as open_windows()).
+    std::uint64_t watermark() const noexcept { return watermark_.current(); }
+    std::size_t   open_windows() const noexcept { return open_.size(); }
+    std::uint64_t late_events() const noexcept { return late_.load(); }
+
+    OpStatus tick() override {
+        if (!out_batch_.empty()) return flush_pending(out_batch_, *output_, metrics_);
+        if (!closing_.empty()) return drain();
+
+        const std::uint64_t pushed = pushed_wm_.load(std::memory_order_relaxed);
+        if (pushed > watermark_.current()) {
+            watermark_.advance(pushed);
+            if (close_ready()) return drain();
+        }
+
+        const std::size_t n = input_->try_pop_n(in_batch_.data(), batch_size_);
+        if (n == 0) {
+            if (metrics_) metrics_->events_idle.increment();
+            return OpStatus::Idle;
+        }
+        for (std::size_t i = 0; i < n; ++i) fold(in_batch_[i]);
+        if (metrics_) metrics_->events_processed.add(n);
+        if (close_ready()) return drain();
+        return OpStatus::Processed;
+    }
+
+private:
+    struct Window {
+        std::uint64_t        start;
+        std::uint64_t        first_arrival;
+        KeyedStateStore<Acc> accs;
+    };
+
+    void fold(const Event<T>& ev) {
+        const std::uint64_t ts    = ev.event_ts_ns;
+        const std::uint64_t start = ts - ts % size_ns_;
+        if (start + size_ns_ <= watermark_.current()) {
+            late_.increment();
+            return;
+        }
+        watermark_.observe(ts);
+        Window& w = window_at(start, ev.timestamp_ns);
+        agg_.accumulate(w.accs.get_or_insert(per_key_ ? ev.key : 0, agg_.init), ev.data);
+    }
+
+    // The open window starting at `start`; open_ stays sorted by start.
+    // In-order input always hits or appends at the back.
+    Window& window_at(std::uint64_t start, std::uint64_t arrival) {
+        auto it = open_.end();
+        while (it != open_.begin() && std::prev(it)->start >= start) --it;
+        if (it != open_.end() && it->start == start) return *it;
+        KeyedStateStore<Acc> accs;
+        if (!spare_.empty()) {
+            accs = std::move(spare_.back());
+            spare_.pop_back();
+        }
+        return *open_.insert(it, Window{ start, arrival, std::move(accs) });
+    }
+
+    // Moves every window the watermark has passed to closing_.
+    bool close_ready() {
+        const std::uint64_t wm = watermark_.current();
+        while (!open_.empty() && open_.front().start + size_ns_ <= wm) {
+            closing_.push_back(std::move(open_.front()));
+            open_.pop_front();
+        }
+        return !closing_.empty();
+    }
+
+    // Moves up to batch_size() results of closed windows to the output.
+    OpStatus drain() {
+        while (!closing_.empty() && out_batch_.size() < out_batch_.capacity()) {
+            Window& w = closing_.front();
+            auto it = w.accs.begin() + static_cast<std::ptrdiff_t>(cursor_);
+            for (; it != w.accs.end() && out_batch_.size() < out_batch_.capacity(); ++it, ++cursor_) {
+                Event<Out> out_ev;
+                out_ev.timestamp_ns = w.first_arrival;
+                out_ev.key          = it->key;
+                out_ev.seq          = w.start / size_ns_;
+                out_ev.event_ts_ns  = w.start;
+                out_ev.data         = agg_.extract(it->value);
+                out_batch_.append(out_ev);
+            }
+            if (it != w.accs.end()) break;
+            w.accs.clear();
+            spare_.push_back(std::move(w.accs));
+            closing_.pop_front();
+            cursor_ = 0;
+        }
+        return flush_pending(out_batch_, *output_, metrics_);
+    }
+
+    InQueue*                          input_;
+    OutQueue*                         output_;
+    std::uint64_t                     size_ns_;
+    Aggregate                         agg_;
+    Watermark                         watermark_;
+    bool                              per_key_;
+    std::deque<Window>                open_;          // sorted by start
+    std::deque<Window>                closing_;       // closed, being drained
+    std::vector<KeyedStateStore<Acc>> spare_;         // stores of drained windows
+    std::size_t                       cursor_{0};     // next entry of closing_.front()
+    std::atomic<std::uint64_t>        pushed_wm_{0};  // from advance_watermark()
+    LocalCounter                      late_;
+    OperatorMetrics*                  metrics_{nullptr};
+    std::size_t                       batch_size_{1};
+    std::vector<Event<T>>             in_batch_;
+    PendingBatch<Event<Out>>          out_batch_;
+};
+
+} // namespace klstream
@@ -0,0 +1,195 @@
+// include/klstream/operators/fan_out.hpp
+#pragma once
+#include "../core/operator.hpp"
+#include "../core/event.hpp"
+#include "../core/spsc_queue.hpp"
+#include "../core/metrics.hpp"
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace klstream {
+
+// Replica index per event, in dispatch order: FanOutOperator -> OrderedMerge.
+using RouteQueue = SPSCQueue<std::uint32_t>;
+
+enum class FanOutPolicy : std::uint8_t {
+    RoundRobin  = 0,   // replica i, i+1, ... regardless of load
+    LeastLoaded = 1,   // replica whose input queue is least occupied
+};
+
+// ── FanOutOperator<T> ─────────────────────────────────────────────────────
+//
+// Spreads one stream over N replicas of a downstream operator, each fed
+// by its own SPSC queue and running on its own worker. Used to run several
+// InferenceOps behind one window stage.
+//
+// Every dispatch also records the chosen replica on `route`. An
+// OrderedMergeOperator replays that record to put the replicas' outputs
+// back into input order, whatever the policy picked and however unevenly
+// the replicas run. route is optional — pass nullptr when order downstream
+// does not matter.
+//
+// The route entry is pushed before the event itself, so the merge may wait
+// on a replica the event has not reached yet, but never misses one. If the
+// replica's queue is full, the event is held (pending_) for that same
+// replica and the tick reports Blocked: the decision is never revisited,
+// or the route would lie.
+//
+// Size `route` to at least the sum of the replica queue capacities plus
+// their in-flight events, or it becomes the bottleneck.
+template <typename T>
+class FanOutOperator : public IOperator {
+public:
+    using Queue = SPSCQueue<Event<T>>;
+
+    FanOutOperator(std::string name, Queue* input, std::vector<Queue*> outputs,
+                   RouteQueue* route = nullptr,
+                   FanOutPolicy policy = FanOutPolicy::RoundRobin)
+        : IOperator(std::move(name))
+        , input_(input), outputs_(std::move(outputs)), route_(route), policy_(policy)
+    {
+        assert(!outputs_.empty());
+    }
+
+    void attach_metrics(OperatorMetrics* m) override { metrics_ = m; }
+
+    bool ready() const noexcept override { return has_pending_ || !input_->empty(); }
+    void wake_on_input(Parker* p) override { input_->set_waker(p); }
+
+    OpStatus tick() override {
+        if (!has_pending_) {
+            if (!input_->try_pop(&pending_)) {
+                if (metrics_) metrics_->events_idle.increment();
+                return OpStatus::Idle;
+            }
+            has_pending_ = true;
+            routed_      = false;
+            target_      = pick();
+        }
+        if (!routed_) {
+            if (route_ && !route_->try_push(target_)) {
+                if (metrics_) metrics_->events_blocked.increment();
+                return OpStatus::Blocked;
+            }
+            routed_ = true;
+        }
+        if (!outputs_[target_]->try_push(pending_)) {
+            if (metrics_) metrics_->events_blocked.increment();
+            return OpStatus::Blocked;
+        }
+        has_pending_ = false;
+        if (metrics_) metrics_->events_processed.increment();
+        return OpStatus::Processed;
+    }
+
+    std::size_t replicas() const noexcept { return outputs_.size(); }
+
+private:
+    std::uint32_t pick() noexcept {
+        const auto n = static_cast<std::uint32_t>(outputs_.size());
+        if (policy_ == FanOutPolicy::LeastLoaded) {
+            // Start the scan after the last pick so equal loads still rotate.
+            std::uint32_t best = (next_ + 1) % n;
+            double best_occ    = outputs_[best]->occupancy();
+            for (std::uint32_t k = 2; k <= n; ++k) {
+                const std::uint32_t i = (next_ + k) % n;
+                const double occ = outputs_[i]->occupancy();
+                if (occ < best_occ) { best = i; best_occ = occ; }
+            }
+            next_ = best;
+            return best;
+        }
+        const std::uint32_t r = next_;
+        next_ = (next_ + 1) % n;
+        return r;
+    }
+
+    Queue*              input_;
+    std::vector<Queue*> outputs_;
+    RouteQueue*         route_;
+    FanOutPolicy        policy_;
+    std::uint32_t       next_{0};
+    std::uint32_t       target_{0};
+    Event<T>            pending_{};
+    bool                has_pending_{false};
+    bool                routed_{false};
+    OperatorMetrics*    metrics_{nullptr};
+};
+
+// ── OrderedMergeOperator<T> ───────────────────────────────────────────────
+//
+// The other end of a FanOutOperator: pops the replica index for the next
+// event from `route`, waits (Idle) until that replica has produced it, and
+// forwards it. Output order is exactly the fan-out's input order, so results
+// stay deterministic however many replicas there are. Replicas must emit
+// exactly one event per event they receive.
+template <typename T>
+class OrderedMergeOperator : public IOperator {
+public:
+    using Queue = SPSCQueue<Event<T>>;
+
+    OrderedMergeOperator(std::string name, std::vector<Queue*> inputs,
+                         RouteQueue* route, Queue* output)
+        : IOperator(std::move(name))
+        , inputs_(std::move(inputs)), route_(route), output_(output)
+    {}
+
+    void attach_metrics(OperatorMetrics* m) override { metrics_ = m; }
+
+    bool ready() const noexcept override {
+        return has_pending_ || (has_route_ ? !inputs_[source_]->empty() : !route_->empty());
+    }
+    void wake_on_input(Parker* p) override {
+        route_->set_waker(p);
+        for (auto* q : inputs_) q->set_waker(p);
+    }
+
+    OpStatus tick() override {
+        if (has_pending_) {
+            if (!output_->try_push(pending_)) {
+                if (metrics_) metrics_->events_blocked.increment();
+                return OpStatus::Blocked;
+            }
+            has_pending_ = false;
+            if (metrics_) metrics_->events_processed.increment();
+            return OpStatus::Processed;
+        }
+
+        if (!has_route_) {
+            if (!route_->try_pop(&source_)) {
+                if (metrics_) metrics_->events_idle.increment();
+                return OpStatus::Idle;
+            }
+            assert(source_ < inputs_.size());
+            has_route_ = true;
+        }
+        // Head-of-line by design: a later replica's output waits here.
+        if (!inputs_[source_]->try_pop(&pending_)) {
+            if (metrics_) metrics_->events_idle.increment();
+            return OpStatus::Idle;
+        }
+        has_route_ = false;
+
+        if (output_->try_push(pending_)) {
+            if (metrics_) metrics_->events_processed.increment();
+            return OpStatus::Processed;
+        }
+        has_pending_ = true;
+        if (metrics_) metrics_->events_blocked.increment();
+        return OpStatus::Blocked;
+    }
+
+private:
+    std::vector<Queue*> inputs_;
+    RouteQueue*         route_;
+    Queue*              output_;
+    std::uint32_t       source_{0};
+    bool                has_route_{false};
+    Event<T>            pending_{};
+    bool                has_pending_{false};
+    OperatorMetrics*    metrics_{nullptr};
+};
+
+} // namespace klstream
@@ -0,0 +1,770 @@
+// include/klstream/operators/graph.hpp
+#pragma once
+#include "../core/config.hpp"
+#include "../core/event.hpp"
+#include "../core/metrics.hpp"
+#include "../core/runtime.hpp"
+#include "../core/spsc_queue.hpp"
+#include "../core/trace.hpp"
+#include "source.hpp"
+#include "filter.hpp"
+#include "map.hpp"
+#include "window.hpp"
+#include "sink.hpp"
+#include "fan_out.hpp"
+#include "partition.hpp"
+#include "aggregate.hpp"
+#include "incremental_window.hpp"
+#include "sliding_window.hpp"
+#include "event_time_window.hpp"
+#include "load_shed.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace klstream {
+
+// ── StreamGraphBuilder ────────────────────────────────────────────────────
+//
+// Declarative alternative to hand-wiring queues, capacities and worker ids.
+// Describe the graph as typed streams, let plan() decide where everything
+// goes, then build() it into a Runtime:
+//
+//   StreamGraphBuilder g;
+//   g.source<AdEvent>("src", gen)
+//       .filter("views", is_view).hint(5, 0.33)
+//       .map<CampaignResult>("join", lookup)
+//       .count_window<CampaignResult>("win", 1000, top_campaign)
+//       .sink("snk", record);
+//   Runtime rt;
+//   auto graph = g.build(rt, PlanOptions{});   // adds workers, registers ops
+//   rt.start();
+//
+// The operators are the ordinary ones (FilterOperator, MapOperator, ...),
+// constructed by build() once their queues exist; through() plugs in any
+// other operator. parallel_map() spreads a stage over replicas behind a
+// FanOutOperator and an OrderedMergeOperator; keyed_aggregate() and
+// keyed_count_window() spread a keyed stateful stage over replicas behind a
+// PartitionOperator and a MergeOperator, each replica owning one key
+// range. partition() and merge() expose those two for anything else.
+//
+// Planning (plan()):
+//   Rates — each source emits PlanOptions::source_rate events/s; a node's
+//     input rate is the sum of its input edges', and its output rate that
+//     times its selectivity (hint(), else 1; 1/n for a count window). Rates
+//     observed on a previous run (StreamGraph::observed_rates()) override
+//     both, so measured selectivities replace guessed ones.
+//   Placement — a node's load is input rate x cost per event (hint(), else
+//     PlanOptions::default_cost_ns). Nodes are cut, in graph order, into
+//     contiguous groups, one per worker, minimising the busiest worker's
+//     load. Neighbours therefore share a worker unless the load needs
+//     splitting, which keeps their queue hot in cache (and makes them
+//     candidates for Runtime::set_operator_fusion).
+//   Queues — every edge has exactly one producing and one consuming
+//     operator (fan-out and fan-in are operators with a ring per replica),
+//     so every edge is an SPSCQueue. An edge within one worker needs only
+//     the minimum capacity; one that crosses workers is sized to absorb
+//     PlanOptions::burst_ns of traffic at its rate, capped by
+//     max_queue_bytes.
+//   Backpressure — a source given Stream::rate_limit() is throttled by the
+//     fullest queue anywhere downstream of it (AimdRateController), so a
+//     slow stage slows the source before the queues in between fill.
+//
+// A Stream may be consumed once; build() throws if a stream has no
+// consumer. The StreamGraph returned by build() owns the queues, operators
+// and metrics, and must outlive the runtime's run.
+struct PlanOptions {
+    std::size_t workers         = 0;          // 0: hardware threads, at most one per node
+    double      source_rate     = 1e6;        // events/s per source
+    double      default_cost_ns = 50.0;       // per input event, when not hinted
+    double      burst_ns        = 1e6;        // traffic a cross-worker queue absorbs
+    std::size_t min_capacity    = 64;
+    std::size_t max_queue_bytes = 1u << 20;
+    std::size_t batch_size      = 1;          // set_batch_size() on every built operator
+    std::unordered_map<std::string, double> observed_rates;   // node -> input events/s
+};
+
+struct GraphPlan {
+    struct Node {
+        std::string name;
+        int         worker;
+        double      in_rate;    // events/s
+        double      cost_ns;    // per input event
+        double      load;       // fraction of one core
+    };
+    struct Edge {
+        std::size_t from, to;   // node indices
+        double      rate;       // events/s
+        std::size_t capacity;   // power of two
+        std::size_t bytes;      // ring footprint
+        bool        local;      // both ends on one worker
+    };
+
+    std::vector<Node> nodes;
+    std::vector<Edge> edges;
+    std::size_t       workers    = 0;
+    std::size_t       batch_size = 1;
+
+    std::vector<double> worker_loads() const {
+        std::vector<double> l(workers, 0.0);
+        for (const auto& n : nodes) l[static_cast<std::size_t>(n.worker)] += n.load;
+        return l;
+    }
+
+    // The busiest worker's load; above 1.0 it cannot keep up with the rates.
+    double bottleneck() const {
+        const auto l = worker_loads();
+        return l.empty() ? 0.0 : *std::max_element(l.begin(), l.end());
+    }
+
+    std::string describe() const {
+        std::ostringstream os;
+        os << std::left << std::setw(22) << "Node" << std::setw(8) << "Worker"
+           << std::setw(14) << "In ev/s" << "Load\n";
+        for (const auto& n : nodes) {
+            os << std::left << std::setw(22) << n.name << std::setw(8) << n.worker
+               << std::setw(14) << std::setprecision(3) << n.in_rate
+               << std::fixed << std::setprecision(1) << n.load * 100.0 << "%\n"
+               << std::defaultfloat;
+        }
+        for (const auto& e : edges) {
+            os << "  " << nodes[e.from].name << " -> " << nodes[e.to].name
+               << (e.local ? "  local  " : "  cross  ") << e.capacity
+               << " slots, " << e.bytes << " B\n";
+        }
+        return os.str();
+    }
+};
+
+// ── StreamGraph ───────────────────────────────────────────────────────────
+class StreamGraph {
+public:
+    const GraphPlan& plan() const noexcept { return plan_; }
+
+    IOperator* op(const std::string& name) const {
+        for (std::size_t i = 0; i < ops_.size(); ++i) {
+            if (plan_.nodes[i].name == name) return ops_[i].get();
+        }
+        return nullptr;
+    }
+
+    const OperatorMetrics* metrics(const std::string& name) const {
+        for (const auto& m : metrics_) if (m.op_name == name) return &m;
+        return nullptr;
+    }
+
+    // Samples every edge queue (named "from->to") and every node into `t`
+    // (trace.hpp). Call before the runtime starts.
+    void trace(TraceRecorder& t) {
+        for (std::size_t e = 0; e < queues_.size(); ++e) {
+            const auto& pe = plan_.edges[e];
+            edge_tracers_[e](t, plan_.nodes[pe.from].name + "->" + plan_.nodes[pe.to].name, queues_[e].get());
+        }
+        for (auto& op : ops_) t.trace_operator(*op);
+    }
+
+    // Has the workers read hardware counters around a sample of every
+    // node's ticks into its OperatorMetrics::perf (perf_counters.hpp). Call
+    // before the runtime starts.
+    void profile() {
+        for (std::size_t i = 0; i < ops_.size(); ++i) ops_[i]->perf = &metrics_[i].perf;
+    }
+
+    // Events each node took in per second over a run of `elapsed` (a
+    // source: emitted). Feed back as PlanOptions::observed_rates.
+    std::unordered_map<std::string, double>
+    observed_rates(std::chrono::duration<double> elapsed) const {
+        std::unordered_map<std::string, double> r;
+        const double s = elapsed.count() > 0 ? elapsed.count() : 1.0;
+        for (const auto& m : metrics_) r[m.op_name] = static_cast<double>(m.events_processed.load()) / s;
+        return r;
+    }
+
+private:
+    friend class StreamGraphBuilder;
+    explicit StreamGraph(GraphPlan plan) : plan_(std::move(plan)) {}
+
+    using EdgeTracer = void (*)(TraceRecorder&, std::string, void* queue);
+
+    GraphPlan                               plan_;
+    std::vector<std::shared_ptr<void>>      queues_;        // one per edge
+    std::vector<EdgeTracer>                 edge_tracers_;  // one per edge, see trace()
+    std::vector<std::shared_ptr<void>>      owned_;         // e.g. fan-out route queues
+    std::deque<OperatorMetrics>             metrics_;       // stable addresses
+    std::vector<std::unique_ptr<IOperator>> ops_;           // destroyed before their queues
+};
+
+template <typename T> class Stream;
+
+class StreamGraphBuilder {
+public:
+    template <typename T>
+    Stream<T> source(std::string name, typename SourceOperator<T>::Generator gen);
+
+    // One stream from several (MergeOperator): per-input order is kept,
+    // inputs interleave.
+    template <typename T>
+    Stream<T> merge(std::string name, const std::vector<Stream<T>>& inputs);
+
+    GraphPlan plan(const PlanOptions& opts = {}) const {
+        const std::size_t n_nodes = nodes_.size();
+        if (n_nodes == 0) throw std::logic_error("StreamGraphBuilder: empty graph");
+        GraphPlan p;
+        p.batch_size = opts.batch_size < 1 ? 1 : opts.batch_size;
+        std::size_t k = opts.workers;
+        if (k == 0) k = std::max(1u, std::thread::hardware_concurrency());
+        p.workers = std::min(k, n_nodes);
+
+        // Rates, in graph order (every edge points forward).
+        std::vector<double> edge_rate(edges_.size(), 0.0);
+        for (std::size_t n = 0; n < n_nodes; ++n) {
+            const NodeDef& d = nodes_[n];
+            const auto obs = opts.observed_rates.find(d.name);
+            double in = 0.0;
+            if (d.in.empty()) in = d.max_rate > 0 ? std::min(opts.source_rate, d.max_rate) : opts.source_rate;
+            for (std::size_t e : d.in) in += edge_rate[e];
+            if (obs != opts.observed_rates.end()) in = obs->second;
+
+            const double out = d.in.empty() ? in : in * d.selectivity;
+            for (std::size_t e : d.out) {
+                if (e == NONE) continue;
+                const NodeDef& to  = nodes_[edges_[e].to];
+                const auto     ot  = opts.observed_rates.find(to.name);
+                edge_rate[e] = (ot != opts.observed_rates.end() && to.in.size() == 1)
+                             ? ot->second : out / static_cast<double>(d.out.size());
+            }
+            const double cost = d.cost_ns > 0 ? d.cost_ns : opts.default_cost_ns;
+            p.nodes.push_back({ d.name, 0, in, cost, in * cost * 1e-9 });
+        }
+
+        assign_workers(p);
+
+        for (std::size_t e = 0; e < edges_.size(); ++e) {
+            const EdgeDef& d = edges_[e];
+            const bool local = p.nodes[d.from].worker == p.nodes[d.to].worker;
+            std::size_t cap = pow2_at_least(std::max<std::size_t>(opts.min_capacity, 2 * p.batch_size + 1));
+            if (!local) {
+                const double want = edge_rate[e] * opts.burst_ns * 1e-9;
+                cap = std::max(cap, pow2_at_least(static_cast<std::size_t>(want) + 1));
+                std::size_t limit = cap;
+                while (limit > 2 && limit * d.event_bytes > opts.max_queue_bytes) limit >>= 1;
+                cap = std::max(limit, pow2_at_least(opts.min_capacity));
+            }
+            p.edges.push_back({ d.from, d.to, edge_rate[e], cap, cap * d.event_bytes, local });
+        }
+        return p;
+    }
+
+    // Creates the queues and operators, adds workers until rt has
+    // plan.workers, and registers everything; each node's metrics are
+    // what rt's rebalancer reads (Runtime::observe). With `report`, each
+    // operator's metrics and each edge's queue (named "from->to") also go
+    // to rt.metrics().
+    std::unique_ptr<StreamGraph> build(Runtime& rt, const GraphPlan& plan, bool report = true) {
+        if (plan.nodes.size() != nodes_.size() || plan.edges.size() != edges_.size()) {
+            throw std::logic_error("StreamGraphBuilder::build: plan is for a different graph");
+        }
+        for (const auto& d : nodes_) {
+            if (!d.terminal && (d.out.empty() ||
+                                std::find(d.out.begin(), d.out.end(), NONE) != d.out.end())) {
+                throw std::logic_error("StreamGraphBuilder: stream '" + d.name + "' has no consumer");
+            }
+        }
+        std::unique_ptr<StreamGraph> g(new StreamGraph(plan));
+        for (std::size_t e = 0; e < edges_.size(); ++e) {
+            g->queues_.push_back(edges_[e].make_queue(plan.edges[e].capacity));
+            g->edge_tracers_.push_back(edges_[e].trace);
+            if (report) {
+                edges_[e].report(rt.metrics(), nodes_[edges_[e].from].name + "->" + nodes_[edges_[e].to].name,
+                                 g->queues_.back().get());
+            }
+        }
+        while (rt.n_workers() < plan.workers) rt.add_worker();
+
+        for (std::size_t n = 0; n < nodes_.size(); ++n) {
+            const NodeDef& d = nodes_[n];
+            Wiring w;
+            for (std::size_t e : d.in) w.in.push_back(g->queues_[e].get());
+            for (std::size_t e : d.out) {
+                w.out.push_back(g->queues_[e].get());
+                w.out_capacity.push_back(plan.edges[e].capacity);
+            }
+            w.batch = plan.batch_size;
+            w.keep  = &g->owned_;
+            if (d.max_rate > 0) {
+                w.max_rate = d.max_rate;
+                for (std::size_t e : downstream_edges(n)) w.downstream.push_back(edges_[e].probe(g->queues_[e].get()));
+            }
+
+            auto op = d.make(d.name, w);
+            g->metrics_.emplace_back(d.name);
+            op->attach_metrics(&g->metrics_.back());
+            if (report) rt.metrics().add(&g->metrics_.back());
+            rt.register_op(op.get(), plan.nodes[n].worker);
+            rt.observe(op.get(), &g->metrics_.back());
+            g->ops_.push_back(std::move(op));
+        }
+        return g;
+    }
+
+    std::unique_ptr<StreamGraph> build(Runtime& rt, const PlanOptions& opts = {}, bool report = true) {
+        return build(rt, plan(opts), report);
+    }
+
+private:
+    template <typename> friend class Stream;
+
+    struct Wiring {
+        std::vector<void*>                  in, out;        // SPSCQueue<Event<T>>*, per edge
+        std::vector<std::size_t>            out_capacity;
+        std::size_t                         batch = 1;
+        std::vector<std::shared_ptr<void>>* keep  = nullptr; // lives as long as the graph
+        double                              max_rate = 0.0;  // a rate_limit()ed source
+        std::vector<QueueProbe>             downstream;      // its output edge and beyond
+    };
+    using Factory = std::function<std::unique_ptr<IOperator>(const std::string&, const Wiring&)>;
+
+    struct NodeDef {
+        std::string              name;
+        double                   cost_ns;       // <= 0: PlanOptions::default_cost_ns
+        double                   selectivity;
+        bool                     terminal;      // a sink: no output stream
+        Factory                  make;
+        std::size_t              ports;         // output streams
+        std::vector<std::size_t> in, out;       // edge indices; out by port
+        double                   max_rate = 0.0; // events/s, see Stream::rate_limit()
+    };
+    struct EdgeDef {
+        std::size_t from, to;
+        std::size_t event_bytes;
+        std::function<std::shared_ptr<void>(std::size_t capacity)> make_queue;
+        void (*report)(MetricsReporter&, std::string, const void* queue);
+        void (*trace)(TraceRecorder&, std::string, void* queue);
+        QueueProbe (*probe)(const void* queue);
+    };
+
+    template <typename T>
+    static SPSCQueue<Event<T>>* queue_at(const std::vector<void*>& qs, std::size_t i) {
+        return static_cast<SPSCQueue<Event<T>>*>(qs[i]);
+    }
+
+    static std::size_t pow2_at_least(std::size_t n) {
+        std::size_t c = 2;
+        while (c < n) c <<= 1;
+        return c;
+    }
+
+    static constexpr std::size_t NONE = static_cast<std::size_t>(-1);
+
+    std::size_t add_node(std::string name, double selectivity, bool terminal, Factory make,
+                         std::size_t ports = 1) {
+        for (const auto& d : nodes_) {
+            if (d.name == name) throw std::invalid_argument("StreamGraphBuilder: duplicate node '" + name + "'");
+        }
+        nodes_.push_back({ std::move(name), 0.0, selectivity, terminal, std::move(make), ports,
+                           {}, std::vector<std::size_t>(terminal ? 0 : ports, NONE) });
+        return nodes_.size() - 1;
+    }
+
+    template <typename T>
+    void add_edge(std::size_t from, std::size_t to, std::size_t port = 0) {
+        edges_.push_back({ from, to, sizeof(Event<T>), [](std::size_t cap) -> std::shared_ptr<void> {
+            return std::make_shared<SPSCQueue<Event<T>>>(cap);
+        }, [](MetricsReporter& r, std::string name, const void* q) {
+            r.add_queue(std::move(name), static_cast<const SPSCQueue<Event<T>>*>(q));
+        }, [](TraceRecorder& t, std::string name, void* q) {
+            t.trace_queue(std::move(name), *static_cast<SPSCQueue<Event<T>>*>(q));
+        }, [](const void* q) {
+            return klstream::probe(*static_cast<const SPSCQueue<Event<T>>*>(q));
+        } });
+        nodes_[from].out[port] = edges_.size() - 1;
+        nodes_[to].in.push_back(edges_.size() - 1);
+    }
+
+    // Every edge reachable from `node`, in graph order.
+    std::vector<std::size_t> downstream_edges(std::size_t node) const {
+        std::vector<bool> reached(nodes_.size(), false);
+        reached[node] = true;
+        std::vector<std::size_t> es;
+        for (std::size_t n = node; n < nodes_.size(); ++n) {
+            if (!reached[n]) continue;
+            for (std::size_t e : nodes_[n].out) {
+                if (e == NONE) continue;
+                es.push_back(e);
+                reached[edges_[e].to] = true;
+            }
+        }
+        return es;
+    }
+
+    void claim(std::size_t node, std::size_t port = 0) const {
+        if (nodes_[node].out[port] != NONE) {
+            throw std::logic_error("StreamGraphBuilder: stream '" + nodes_[node].name + "' already has a consumer");
+        }
+    }
+
+    // Contiguous partition of the nodes, in graph order, into p.workers
+    // groups minimising the largest group load (linear partitioning DP).
+    static void assign_workers(GraphPlan& p) {
+        const std::size_t n = p.nodes.size(), k = p.workers;
+        std::vector<double> prefix(n + 1, 0.0);
+        for (std::size_t i = 0; i < n; ++i) prefix[i + 1] = prefix[i] + p.nodes[i].load;
+
+        constexpr double INF = std::numeric_limits<double>::infinity();
+        // best[j][i]: first i nodes on j workers; cut[j][i]: where group j starts.
+        std::vector<std::vector<double>>      best(k + 1, std::vector<double>(n + 1, INF));
+        std::vector<std::vector<std::size_t>> cut(k + 1, std::vector<std::size_t>(n + 1, 0));
+        best[0][0] = 0.0;
+        for (std::size_t j = 1; j <= k; ++j) {
+            for (std::size_t i = j; i <= n; ++i) {
+                for (std::size_t s = j - 1; s < i; ++s) {
+                    const double v = std::max(best[j - 1][s], prefix[i] - prefix[s]);
+                    if (v < best[j][i]) { best[j][i] = v; cut[j][i] = s; }
+                }
+            }
+        }
+        std::size_t i = n;
+        for (std::size_t j = k; j >= 1; --j) {
+            const std::size_t s = cut[j][i];
+            for (std::size_t x = s; x < i; ++x) p.nodes[x].worker = static_cast<int>(j - 1);
+            i = s;
+        }
+    }
+
+    std::vector<NodeDef> nodes_;
+    std::vector<EdgeDef> edges_;
+};
+
+// ── Stream<T> ─────────────────────────────────────────────────────────────
+//
+// A typed handle on one node's output. Each call adds a node consuming this
+// stream and returns a handle on the new node's output.
+template <typename T>
+class Stream {
+public:
+    // Planning hints for the node(s) behind this stream: CPU cost per input
+    // event, and output events per input event (< 0: keep the default).
+    Stream hint(double cost_ns, double selectivity = -1.0) {
+        for (std::size_t n : hinted_) {
+            g_->nodes_[n].cost_ns = cost_ns;
+            if (selectivity >= 0) g_->nodes_[n].selectivity = selectivity;
+        }
+        return *this;
+    }
+
+    // Adaptive backpressure on a source stream: emit at most `max_eps`
+    // events/s, and less while any queue downstream of the source fills
+    // (SourceOperator::enable_rate_limiting, watching every edge reachable
+    // from it). Also caps the rate plan() assumes for it.
+    Stream rate_limit(double max_eps) {
+        if (!g_->nodes_[node_].in.empty()) {
+            throw std::logic_error("Stream::rate_limit: '" + g_->nodes_[node_].name + "' is not a source");
+        }
+        if (!(max_eps > 0)) throw std::invalid_argument("Stream::rate_limit: rate must be positive");
+        g_->nodes_[node_].max_rate = max_eps;
+        return *this;
+    }
+
+    Stream<T> filter(std::string name, typename FilterOperator<T>::Predicate pred) {
+        return link<T>(std::move(name), 1.0,
+            [pred = std::move(pred)](const std::string& nm, const StreamGraphBuilder::Wiring& w) {
+                auto op = std::make_unique<FilterOperator<T>>(
+                    nm, queue<T>(w.in, 0), queue<T>(w.out, 0), pred);
+                op->set_batch_size(w.batch);
+                return std::unique_ptr<IOperator>(std::move(op));
+            });
+    }
+
+    // Drops events rather than blocking when the queue after it backs up
+    // (LoadShedOperator): lowest utility first, or evenly sampled without
+    // a utility function.
+    Stream<T> shed(std::string name, typename LoadShedOperator<T>::Utility utility = {}) {
+        return link<T>(std::move(name), 1.0,
+            [utility = std::move(utility)](const std::string& nm, const StreamGraphBuilder::Wiring& w) {
+                auto op = std::make_unique<LoadShedOperator<T>>(
+                    nm, queue<T>(w.in, 0), queue<T>(w.out, 0), utility);
+                op->set_batch_size(w.batch);
+                return std::unique_ptr<IOperator>(std::move(op));
+            });
+    }
+
+    template <typename Out>
+    Stream<Out> map(std::string name, typename MapOperator<T, Out>::Fn fn) {
+        return link<Out>(std::move(name), 1.0, map_factory<Out>(std::move(fn)));
+    }
+
+    template <typename Out>
+    Stream<Out> count_window(std::string name, std::size_t size,
+                             typename TumblingCountWindow<T, Out>::AggrFn aggr) {
+        return link<Out>(std::move(name), 1.0 / static_cast<double>(size ? size : 1),
+            [size, aggr = std::move(aggr)](const std::string& nm, const StreamGraphBuilder::Wiring& w) {
+                auto op = std::make_unique<TumblingCountWindow<T, Out>>(
+                    nm, queue<T>(w.in, 0), queue<Out>(w.out, 0), size, aggr);
+                op->set_batch_size(w.batch);
+                return std::unique_ptr<IOperator>(std::move(op));
+            });
+    }
+
+    // IncrementalCountWindow: count_window() folding each event into an
+    // accumulator instead of buffering the window.
+    template <typename Acc, typename Out>
+    Stream<Out> incremental_window(std::string name, std::size_t size,
+                                   WindowAggregate<T, Acc, Out> agg) {
+        return link<Out>(std::move(name), 1.0 / static_cast<double>(size ? size : 1),
+            [size, agg = std::move(agg)](const std::string& nm, const StreamGraphBuilder::Wiring& w) {
+                auto op = std::make_unique<IncrementalCountWindow<T, Acc, Out>>(
+                    nm, queue<T>(w.in, 0), queue<Out>(w.out, 0), size, agg);
+                op->set_batch_size(w.batch);
+                return std::unique_ptr<IOperator>(std::move(op));
+            });
+    }
+
+    // SlidingCountWindow: the last `size` events, every `slide` events.
+    template <typename Acc, typename Out>
+    Stream<Out> sliding_window(std::string name, std::size_t size, std::size_t slide,
+                               WindowAggregate<T, Acc, Out> agg) {
+        return link<Out>(std::move(name), 1.0 / static_cast<double>(slide ? slide : 1),
+            [size, slide, agg = std::move(agg)](const std::string& nm, const StreamGraphBuilder::Wiring& w) {
+                auto op = std::make_unique<SlidingCountWindow<T, Acc, Out>>(
+                    nm, queue<T>(w.in, 0), queue<Out>(w.out, 0), size, slide, agg);
+                op->set_batch_size(w.batch);
+                return std::unique_ptr<IOperator>(std::move(op));
+            });
+    }
+
+    // EventTimeWindow: tumbling windows of `size` in event time, closed by
+    // the watermark. hint() the selectivity if it matters to the plan.
+    template <typename Acc, typename Out>
+    Stream<Out> event_time_window(std::string name, std::chrono::nanoseconds size,
+                                  WindowAggregate<T, Acc, Out> agg,
+                                  std::chrono::nanoseconds max_out_of_order = std::chrono::nanoseconds(0),
+                                  bool per_key = false) {
+        return link<Out>(std::move(name), 1.0,
+            [size, agg = std::move(agg), max_out_of_order, per_key]
+            (const std::string& nm, const StreamGraphBuilder::Wiring& w) {
+                auto op = std::make_unique<EventTimeWindow<T, Acc, Out>>(
+                    nm, queue<T>(w.in, 0), queue<Out>(w.out, 0), size, agg, max_out_of_order, per_key);
+                op->set_batch_size(w.batch);
+                return std::unique_ptr<IOperator>(std::move(op));
+            });
+    }
+
+    // Any other single-input, single-output operator:
+    //   make(name, SPSCQueue<Event<T>>* in, SPSCQueue<Event<Out>>* out)
+    //     -> std::unique_ptr<IOperator>
+    template <typename Out, typename Make>
+    Stream<Out> through(std::string name, Make make, double selectivity = 1.0) {
+        return link<Out>(std::move(name), selectivity,
+            [make = std::move(make)](const std::string& nm, const StreamGraphBuilder::Wiring& w) {
+                return std::unique_ptr<IOperator>(make(nm, queue<T>(w.in, 0), queue<Out>(w.out, 0)));
+            });
+    }
+
+    // `replicas` copies of a map stage behind a FanOutOperator (name.fanout)
+    // and an OrderedMergeOperator (name.merge), which restores input order.
+    // hint() on the result applies to the replicas (name[0], name[1], ...).
+    template <typename Out>
+    Stream<Out> parallel_map(std::string name, std::size_t replicas,
+                             typename MapOperator<T, Out>::Fn fn,
+                             FanOutPolicy policy = FanOutPolicy::RoundRobin) {
+        if (replicas < 1) replicas = 1;
+        g_->claim(node_, port_);
+        auto route = std::make_shared<RouteQueue*>(nullptr);   // set by the fan-out
+
+        const std::size_t fan = g_->add_node(name + ".fanout", 1.0, false,
+            [route, policy](const std::string& nm, const StreamGraphBuilder::Wiring& w) {
+                // Room for every event in or between the replicas.
+                std::size_t in_flight = 2 * w.out.size() + 2;
+                for (std::size_t c : w.out_capacity) in_flight += c;
+                auto rq = std::make_shared<RouteQueue>(StreamGraphBuilder::pow2_at_least(in_flight));
+                *route = rq.get();
+                w.keep->push_back(rq);
+                std::vector<SPSCQueue<Event<T>>*> outs;
+                for (std::size_t i = 0; i < w.out.size(); ++i) outs.push_back(queue<T>(w.out, i));
+                return std::unique_ptr<IOperator>(std::make_unique<FanOutOperator<T>>(
+                    nm, queue<T>(w.in, 0), std::move(outs), *route, policy));
+            }, replicas);
+        g_->template add_edge<T>(node_, fan, port_);
+
+        std::vector<std::size_t> reps;
+        for (std::size_t r = 0; r < replicas; ++r) {
+            reps.push_back(g_->add_node(name + "[" + std::to_string(r) + "]", 1.0, false,
+                                        map_factory<Out>(fn)));
+            g_->template add_edge<T>(fan, reps.back(), r);
+        }
+
+        const std::size_t merge = g_->add_node(name + ".merge", 1.0, false,
+            [route](const std::string& nm, const StreamGraphBuilder::Wiring& w) {
+                std::vector<SPSCQueue<Event<Out>>*> ins;
+                for (std::size_t i = 0; i < w.in.size(); ++i) ins.push_back(queue<Out>(w.in, i));
+                return std::unique_ptr<IOperator>(std::make_unique<OrderedMergeOperator<Out>>(
+                    nm, std::move(ins), *route, queue<Out>(w.out, 0)));
+            });
+        for (std::size_t r : reps) g_->template add_edge<Out>(r, merge);
+
+        Stream<Out> s(g_, merge);
+        s.hinted_ = std::move(reps);
+        return s;
+    }
+
+    // Splits the stream by key into `n` streams, one per partition (see
+    // partition_of); key_of, if given, re-keys each event first.
+    std::vector<Stream<T>> partition(std::string name, std::size_t n,
+                                     typename PartitionOperator<T>::KeyFn key_of = nullptr) {
+        if (n < 1) n = 1;
+        g_->claim(node_, port_);
+        const std::size_t p = g_->add_node(std::move(name), 1.0, false,
+            [key_of = std::move(key_of)](const std::string& nm, const StreamGraphBuilder::Wiring& w) {
+                std::vector<SPSCQueue<Event<T>>*> outs;
+                for (std::size_t i = 0; i < w.out.size(); ++i) outs.push_back(queue<T>(w.out, i));
+                auto op = std::make_unique<PartitionOperator<T>>(nm, queue<T>(w.in, 0), std::move(outs), key_of);
+                op->set_batch_size(w.batch);
+                return std::unique_ptr<IOperator>(std::move(op));
+            }, n);
+        g_->template add_edge<T>(node_, p, port_);
+        std::vector<Stream<T>> parts;
+        for (std::size_t i = 0; i < n; ++i) parts.push_back(Stream<T>(g_, p, i));
+        return parts;
+    }
+
+    // `replicas` KeyedAggregateOperators, each owning one key range.
+    // hint() on the result applies to the replicas.
+    template <typename State, typename Out>
+    Stream<Out> keyed_aggregate(std::string name, std::size_t replicas, State init,
+                                typename KeyedAggregateOperator<T, State, Out>::AccumFn accum,
+                                typename KeyedAggregateOperator<T, State, Out>::ExtractFn extract,
+                                typename PartitionOperator<T>::KeyFn key_of = nullptr) {
+        return keyed<Out>(name, replicas, 1.0,
+            [init = std::move(init), accum = std::move(accum), extract = std::move(extract)]
+            (const std::string& nm, const StreamGraphBuilder::Wiring& w) {
+                auto op = std::make_unique<KeyedAggregateOperator<T, State, Out>>(
+                    nm, queue<T>(w.in, 0), queue<Out>(w.out, 0), init, accum, extract);
+                op->set_batch_size(w.batch);
+                return std::unique_ptr<IOperator>(std::move(op));
+            }, std::move(key_of));
+    }
+
+    // `replicas` KeyedTumblingCountWindows, each owning one key range.
+    template <typename Out>
+    Stream<Out> keyed_count_window(std::string name, std::size_t replicas, std::size_t size,
+                                   typename KeyedTumblingCountWindow<T, Out>::AggrFn aggr,
+                                   typename PartitionOperator<T>::KeyFn key_of = nullptr) {
+        return keyed<Out>(name, replicas, 1.0 / static_cast<double>(size ? size : 1),
+            [size, aggr = std::move(aggr)](const std::string& nm, const StreamGraphBuilder::Wiring& w) {
+                auto op = std::make_unique<KeyedTumblingCountWindow<T, Out>>(
+                    nm, queue<T>(w.in, 0), queue<Out>(w.out, 0), size, aggr);
+                op->set_batch_size(w.batch);
+                return std::unique_ptr<IOperator>(std::move(op));
+            }, std::move(key_of));
+    }
+
+    void sink(std::string name, typename SinkOperator<T>::ConsumerFn fn) {
+        g_->claim(node_, port_);
+        const std::size_t n = g_->add_node(std::move(name), 1.0, true,
+            [fn = std::move(fn)](const std::string& nm, const StreamGraphBuilder::Wiring& w) {
+                auto op = std::make_unique<SinkOperator<T>>(nm, queue<T>(w.in, 0), fn);
+                op->set_batch_size(w.batch);
+                return std::unique_ptr<IOperator>(std::move(op));
+            });
+        g_->template add_edge<T>(node_, n, port_);
+    }
+
+private:
+    friend class StreamGraphBuilder;
+    template <typename> friend class Stream;
+
+    Stream(StreamGraphBuilder* g, std::size_t node, std::size_t port = 0)
+        : g_(g), node_(node), port_(port), hinted_{ node } {}
+
+    template <typename U>
+    static SPSCQueue<Event<U>>* queue(const std::vector<void*>& qs, std::size_t i) {
+        return StreamGraphBuilder::queue_at<U>(qs, i);
+    }
+
+    template <typename Out>
+    static StreamGraphBuilder::Factory map_factory(typename MapOperator<T, Out>::Fn fn) {
+        return [fn = std::move(fn)](const std::string& nm, const StreamGraphBuilder::Wiring& w) {
+            auto op = std::make_unique<MapOperator<T, Out>>(
+                nm, queue<T>(w.in, 0), queue<Out>(w.out, 0), fn);
+            op->set_batch_size(w.batch);
+            return std::unique_ptr<IOperator>(std::move(op));
+        };
+    }
+
+    template <typename Out>
+    Stream<Out> link(std::string name, double selectivity, StreamGraphBuilder::Factory make) {
+        g_->claim(node_, port_);
+        const std::size_t n = g_->add_node(std::move(name), selectivity, false, std::move(make));
+        g_->template add_edge<T>(node_, n, port_);
+        return Stream<Out>(g_, n);
+    }
+
+    // partition(name + ".partition") -> `replicas` nodes made by `make`
+    // (name[0], name[1], ...) -> merge(name + ".merge").
+    template <typename Out>
+    Stream<Out> keyed(const std::string& name, std::size_t replicas, double selectivity,
+                      const StreamGraphBuilder::Factory& make,
+                      typename PartitionOperator<T>::KeyFn key_of) {
+        std::vector<Stream<Out>> outs;
+        std::vector<std::size_t> reps;
+        for (auto& part : partition(name + ".partition", replicas, std::move(key_of))) {
+            outs.push_back(part.template link<Out>(name + "[" + std::to_string(reps.size()) + "]",
+                                                   selectivity, make));
+            reps.push_back(outs.back().node_);
+        }
+        Stream<Out> s = g_->merge(name + ".merge", outs);
+        s.hinted_ = std::move(reps);
+        return s;
+    }
+
+    StreamGraphBuilder*      g_;
+    std::size_t              node_;
+    std::size_t              port_;
+    std::vector<std::size_t> hinted_;
+};
+
+template <typename T>
+Stream<T> StreamGraphBuilder::source(std::string name, typename SourceOperator<T>::Generator gen) {
+    const std::size_t n = add_node(std::move(name), 1.0, false,
+        [gen = std::move(gen)](const std::string& nm, const Wiring& w) {
+            auto op = std::make_unique<SourceOperator<T>>(nm, queue_at<T>(w.out, 0), gen);
+            op->set_batch_size(w.batch);
+            if (w.max_rate > 0) {
+                op->enable_rate_limiting(w.max_rate);
+                // downstream[0] is the source's own output, already watched.
+                for (std::size_t i = 1; i < w.downstream.size(); ++i) op->flow_control()->watch(w.downstream[i]);
+            }
+            return std::unique_ptr<IOperator>(std::move(op));
+        });
+    return Stream<T>(this, n);
+}
+
+template <typename T>
+Stream<T> StreamGraphBuilder::merge(std::string name, const std::vector<Stream<T>>& inputs) {
+    if (inputs.empty()) throw std::invalid_argument("StreamGraphBuilder::merge: no inputs");
+    for (const auto& s : inputs) claim(s.node_, s.port_);
+    const std::size_t n = add_node(std::move(name), 1.0, false,
+        [](const std::string& nm, const Wiring& w) {
+            std::vector<SPSCQueue<Event<T>>*> ins;
+            for (std::size_t i = 0; i < w.in.size(); ++i) ins.push_back(queue_at<T>(w.in, i));
+            auto op = std::make_unique<MergeOperator<T>>(nm, std::move(ins), queue_at<T>(w.out, 0));
+            op->set_batch_size(w.batch);
+            return std::unique_ptr<IOperator>(std::move(op));
+        });
+    for (const auto& s : inputs) add_edge<T>(s.node_, n, s.port_);
+    return Stream<T>(this, n);
+}
+
+} // namespace klstream
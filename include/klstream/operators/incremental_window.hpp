@@ -0,0 +1,354 @@
+// include/klstream/operators/incremental_window.hpp
+#pragma once
+#include "../core/operator.hpp"
+#include "../core/batch.hpp"
+#include "../core/clock.hpp"
+#include "../core/keyed_state.hpp"
+#include "../core/event.hpp"
+#include "../core/spsc_queue.hpp"
+#include "../core/metrics.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace klstream {
+
+// ── WindowAggregate<In, Acc, Out> ─────────────────────────────────────────
+//
+// An aggregation split into the four steps an incremental window needs:
+//
+//   init        — the accumulator of an empty window (copied on open)
+//   accumulate  — fold one input into an accumulator
+//   merge       — fold one accumulator into another (partials, panes);
+//                 may be left empty for the tumbling windows in this file
+//   extract     — the window's result, from its accumulator
+//
+// Windows built on it (IncrementalCountWindow, KeyedIncrementalCountWindow,
+// IncrementalTimeWindow) fold each event in as it arrives instead of
+// buffering it, so a window holds one Acc instead of its events, and
+// closing one costs a single extract() instead of a pass over the buffer.
+//
+// Example — mean of every window:
+//   struct SumCount { uint64_t sum = 0, n = 0; };
+//   WindowAggregate<uint64_t, SumCount, double> mean{
+//       SumCount{},
+//       [](SumCount& a, const uint64_t& x) { a.sum += x; ++a.n; },
+//       [](SumCount& a, const SumCount& b) { a.sum += b.sum; a.n += b.n; },
+//       [](const SumCount& a) { return a.n ? double(a.sum) / a.n : 0.0; } };
+template <typename In, typename Acc, typename Out>
+struct WindowAggregate {
+    Acc                                    init{};
+    std::function<void(Acc&, const In&)>   accumulate;
+    std::function<void(Acc&, const Acc&)>  merge;
+    std::function<Out(const Acc&)>         extract;
+};
+
+// ── IncrementalCountWindow<T, Acc, Out> ───────────────────────────────────
+//
+// TumblingCountWindow without the buffer: every window_size inputs emit one
+// extract(), stamped like TumblingCountWindow's (timestamp of the window's
+// first event, key and seq of its last). State is one Acc.
+//
+// Always batched: up to batch_size() events per tick() (default 1), the
+// window outputs of a batch pushed together with one try_push_n.
+template <typename T, typename Acc, typename Out>
+class IncrementalCountWindow : public IOperator {
+public:
+    using InQueue   = SPSCQueue<Event<T>>;
+    using OutQueue  = SPSCQueue<Event<Out>>;
+    using Aggregate = WindowAggregate<T, Acc, Out>;
+
+    IncrementalCountWindow(std::string name,
+                           InQueue*    input,
+                           OutQueue*   output,
+                           std::size_t window_size,
+                           Aggregate   agg)
+        : IOperator(std::move(name))
+        , input_(input), output_(output)
+        , window_size_(window_size < 1 ? 1 : window_size), agg_(std::move(agg))
+        , acc_(agg_.init)
+    {
+        set_batch_size(1);
+    }
+
+    void attach_metrics(OperatorMetrics* m) override { metrics_ = m; }
+
+    // Events popped per tick(). Must be called before the runtime starts.
+    void set_batch_size(std::size_t n) {
+        batch_size_ = n < 1 ? 1 : n;
+        in_batch_.resize(batch_size_);
+        out_batch_.set_capacity(batch_size_);
+    }
+
+    bool ready() const noexcept override { return !out_batch_.empty() || !input_->empty(); }
+    void wake_on_input(Parker* p) override { input_->set_waker(p); }
+
+    // Inputs folded into the open window so far.
+    std::size_t open_count() const noexcept { return count_; }
+
+    OpStatus tick() override {
+        if (!out_batch_.empty()) return flush_pending(out_batch_, *output_, metrics_);
+
+        const std::size_t n = input_->try_pop_n(in_batch_.data(), batch_size_);
+        if (n == 0) {
+            if (metrics_) metrics_->events_idle.increment();
+            return OpStatus::Idle;
+        }
+        std::size_t folded_only = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            const Event<T>& in_ev = in_batch_[i];
+            if (count_ == 0) start_ts_ = in_ev.timestamp_ns;
+            agg_.accumulate(acc_, in_ev.data);
+            if (++count_ < window_size_) {
+                ++folded_only;
+                continue;
+            }
+            Event<Out> out_ev;
+            out_ev.timestamp_ns = start_ts_;
+            out_ev.key          = in_ev.key;
+            out_ev.seq          = in_ev.seq;
+            out_ev.event_ts_ns  = in_ev.event_ts_ns;
+            out_ev.data         = agg_.extract(acc_);
+            out_batch_.append(out_ev);
+            acc_   = agg_.init;
+            count_ = 0;
+        }
+        // Folded events count as processed now; window outputs when pushed.
+        if (metrics_ && folded_only) metrics_->events_processed.add(folded_only);
+        if (out_batch_.empty()) return OpStatus::Processed;
+        return flush_pending(out_batch_, *output_, metrics_);
+    }
+
+private:
+    InQueue*                 input_;
+    OutQueue*                output_;
+    std::size_t              window_size_;
+    Aggregate                agg_;
+    Acc                      acc_;
+    std::size_t              count_{0};
+    std::uint64_t            start_ts_{0};
+    OperatorMetrics*         metrics_{nullptr};
+    std::size_t              batch_size_{1};
+    std::vector<Event<T>>    in_batch_;
+    PendingBatch<Event<Out>> out_batch_;
+};
+
+// ── KeyedIncrementalCountWindow<T, Acc, Out> ──────────────────────────────
+//
+// KeyedTumblingCountWindow without the buffers: each Event::key folds into
+// its own Acc and fires on its own every window_size of its events, with
+// the key forwarded. State is one Acc and a count per live key, in a
+// KeyedStateStore — O(keys), whatever the window size.
+template <typename T, typename Acc, typename Out>
+class KeyedIncrementalCountWindow : public IOperator {
+public:
+    using InQueue   = SPSCQueue<Event<T>>;
+    using OutQueue  = SPSCQueue<Event<Out>>;
+    using Aggregate = WindowAggregate<T, Acc, Out>;
+
+    KeyedIncrementalCountWindow(std::string name,
+                                InQueue*    input,
+                                OutQueue*   output,
+                                std::size_t window_size,
+                                Aggregate   agg)
+        : IOperator(std::move(name))
+        , input_(input), output_(output)
+        , window_size_(window_size < 1 ? 1 : window_size), agg_(std::move(agg))
+        , empty_{ agg_.init, 0, 0 }
+    {
+        set_batch_size(1);
+    }
+
+    void attach_metrics(OperatorMetrics* m) override { metrics_ = m; }
+
+    // Events popped per tick(). Must be called before the runtime starts.
+    void set_batch_size(std::size_t n) {
+        batch_size_ = n < 1 ? 1 : n;
+        in_batch_.resize(batch_size_);
+        out_batch_.set_capacity(batch_size_);
+    }
+
+    bool ready() const noexcept override { return !out_batch_.empty() || !input_->empty(); }
+    void wake_on_input(Parker* p) override { input_->set_waker(p); }
+
+    // Keys seen so far. Only meaningful from the operator's own thread or
+    // after the runtime has stopped.
+    std::size_t keys() const noexcept { return windows_.size(); }
+
+    OpStatus tick() override {
+        if (!out_batch_.empty()) return flush_pending(out_batch_, *output_, metrics_);
+
+        const std::size_t n = input_->try_pop_n(in_batch_.data(), batch_size_);
+        if (n == 0) {
+            if (metrics_) metrics_->events_idle.increment();
+            return OpStatus::Idle;
+        }
+        std::size_t folded_only = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            const Event<T>& in_ev = in_batch_[i];
+            Window& w = windows_.get_or_insert(in_ev.key, empty_);
+            if (w.count == 0) w.start_ts = in_ev.timestamp_ns;
+            agg_.accumulate(w.acc, in_ev.data);
+            if (++w.count < window_size_) {
+                ++folded_only;
+                continue;
+            }
+            Event<Out> out_ev;
+            out_ev.timestamp_ns = w.start_ts;
+            out_ev.key          = in_ev.key;
+            out_ev.seq          = in_ev.seq;
+            out_ev.event_ts_ns  = in_ev.event_ts_ns;
+            out_ev.data         = agg_.extract(w.acc);
+            out_batch_.append(out_ev);
+            w.acc   = agg_.init;
+            w.count = 0;
+        }
+        if (metrics_ && folded_only) metrics_->events_processed.add(folded_only);
+        if (out_batch_.empty()) return OpStatus::Processed;
+        return flush_pending(out_batch_, *output_, metrics_);
+    }
+
+private:
+    struct Window {
+        Acc           acc;
+        std::size_t   count;
+        std::uint64_t start_ts;
+    };
+
+    InQueue*                 input_;
+    OutQueue*                output_;
+    std::size_t              window_size_;
+    Aggregate                agg_;
+    Window                   empty_;
+    KeyedStateStore<Window>  windows_;
+    OperatorMetrics*         metrics_{nullptr};
+    std::size_t              batch_size_{1};
+    std::vector<Event<T>>    in_batch_;
+    PendingBatch<Event<Out>> out_batch_;
+};
+
+// ── IncrementalTimeWindow<T, Acc, Out> ────────────────────────────────────
+//
+// TumblingTimeWindow without the buffer: events fold into the open
+// window's Acc, and every `window_duration` the window closes, emitting
+// extract() stamped with the window's open time and index (as seq). An
+// empty window is not emitted.
+//
+// With per_key set, each Event::key folds into its own Acc and a close
+// emits one event per key seen in the window, key forwarded, all with the
+// same timestamp and seq. Memory is O(keys in a window) either way.
+//
+// A close swaps the open window's accumulators out (no copy) and drains
+// them into the output at most batch_size() per tick(), so a window with
+// many keys is emitted in steps instead of in one burst. Input is folded
+// into the next window again once the drain is done.
+template <typename T, typename Acc, typename Out>
+class IncrementalTimeWindow : public IOperator {
+public:
+    using InQueue   = SPSCQueue<Event<T>>;
+    using OutQueue  = SPSCQueue<Event<Out>>;
+    using Aggregate = WindowAggregate<T, Acc, Out>;
+
+    IncrementalTimeWindow(std::string name,
+                          InQueue*    input,
+                          OutQueue*   output,
+                          std::chrono::nanoseconds window_duration,
+                          Aggregate   agg,
+                          bool        per_key = false)
+        : IOperator(std::move(name))
+        , input_(input), output_(output)
+        , window_ns_(static_cast<std::uint64_t>(window_duration.count()))
+        , agg_(std::move(agg)), per_key_(per_key)
+        , open_(1), closing_(1)
+    {
+        set_batch_size(1);
+        window_open_ns_ = Clock::now_ns();
+    }
+
+    void attach_metrics(OperatorMetrics* m) override { metrics_ = m; }
+
+    // Events popped, and closed-window results emitted, per tick(). Must be
+    // called before the runtime starts.
+    void set_batch_size(std::size_t n) {
+        batch_size_ = n < 1 ? 1 : n;
+        in_batch_.resize(batch_size_);
+        out_batch_.set_capacity(batch_size_);
+    }
+
+    // Keys in the open window. Only meaningful from the operator's own
+    // thread or after the runtime has stopped.
+    std::size_t open_keys() const noexcept { return open_.size(); }
+
+    OpStatus tick() override {
+        if (!out_batch_.empty()) return flush_pending(out_batch_, *output_, metrics_);
+        if (draining()) return drain();
+
+        const std::uint64_t now = Clock::now_ns();
+        if (now - window_open_ns_ >= window_ns_) {
+            if (!open_.empty()) {
+                std::swap(open_, closing_);
+                closing_open_ns_ = window_open_ns_;
+                closing_seq_     = window_count_++;
+                window_open_ns_  = now;
+                return drain();
+            }
+            window_open_ns_ = now;
+        }
+
+        const std::size_t n = input_->try_pop_n(in_batch_.data(), batch_size_);
+        if (n == 0) {
+            if (metrics_) metrics_->events_idle.increment();
+            return OpStatus::Idle;
+        }
+        for (std::size_t i = 0; i < n; ++i) {
+            const Event<T>& in_ev = in_batch_[i];
+            agg_.accumulate(open_.get_or_insert(per_key_ ? in_ev.key : 0, agg_.init), in_ev.data);
+        }
+        if (metrics_) metrics_->events_processed.add(n);
+        return OpStatus::Processed;
+    }
+
+private:
+    bool draining() const noexcept { return cursor_ < closing_.size(); }
+
+    // Moves up to batch_size() results of the closed window to the output.
+    OpStatus drain() {
+        auto it = closing_.begin() + static_cast<std::ptrdiff_t>(cursor_);
+        for (; it != closing_.end() && out_batch_.size() < out_batch_.capacity(); ++it, ++cursor_) {
+            Event<Out> out_ev;
+            out_ev.timestamp_ns = closing_open_ns_;
+            out_ev.key          = it->key;
+            out_ev.seq          = closing_seq_;
+            out_ev.event_ts_ns  = closing_open_ns_;
+            out_ev.data         = agg_.extract(it->value);
+            out_batch_.append(out_ev);
+        }
+        if (!draining()) {
+            closing_.clear();
+            cursor_ = 0;
+        }
+        return flush_pending(out_batch_, *output_, metrics_);
+    }
+
+    InQueue*                 input_;
+    OutQueue*                output_;
+    std::uint64_t            window_ns_;
+    Aggregate                agg_;
+    bool                     per_key_;
+    KeyedStateStore<Acc>     open_;       // the open window, by key (0 if !per_key_)
+    KeyedStateStore<Acc>     closing_;    // the closed window being drained
+    std::size_t              cursor_{0};  // next closing_ entry to emit
+    std::uint64_t            window_open_ns_{0};
+    std::uint64_t            closing_open_ns_{0};
+    std::uint64_t            closing_seq_{0};
+    std::uint64_t            window_count_{0};
+    OperatorMetrics*         metrics_{nullptr};
+    std::size_t              batch_size_{1};
+    std::vector<Event<T>>    in_batch_;
+    PendingBatch<Event<Out>> out_batch_;
+};
+
+} // namespace klstream
@@ -0,0 +1,130 @@
+// include/klstream/operators/load_shed.hpp
+#pragma once
+#include "../core/operator.hpp"
+#include "../core/backpressure.hpp"
+#include "../core/batch.hpp"
+#include "../core/event.hpp"
+#include "../core/spsc_queue.hpp"
+#include "../core/metrics.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace klstream {
+
+// ── LoadShedOperator<T> ───────────────────────────────────────────────────
+//
+// Pass-through that drops events instead of blocking when its output queue
+// backs up, so a burst costs completeness rather than latency upstream.
+// Pressure is the EMAOccupancyTracker's EMA of the output queue's
+// occupancy, sampled once per tick():
+//
+//   ema <= BP_SOFT_THRESHOLD          pass everything
+//   soft < ema, occupancy <= hard     shed events whose utility is below
+//                                     cutoff = (ema - soft) / (hard - soft)
+//   occupancy > BP_HARD_THRESHOLD     cutoff = 1: shed all but utility 1
+//
+// The utility function scores each event in [0, 1]; a higher score keeps
+// it longer, and 1 is never shed (it waits for room like any operator).
+// Without one the operator samples instead: it keeps a (1 - cutoff) share
+// of the events, evenly spaced.
+//
+// Example — during a flash crash keep the volatile ticks, drop calm ones:
+//   LoadShedOperator<FeatureVector> shed("shed", &q_in, &q_out,
+//       [](const FeatureVector& f) { return f.rolling_vol / (f.rolling_vol + 1e-4f); });
+//
+// Shed events count as processed (consumed, as in FilterOperator) and in
+// OperatorMetrics::events_shed, which the exporters report. Not fusable:
+// the pressure signal is the output queue, which fusion would bypass.
+template <typename T>
+class LoadShedOperator : public IOperator {
+public:
+    using Queue   = SPSCQueue<Event<T>>;
+    using Utility = std::function<double(const T&)>;
+
+    LoadShedOperator(std::string name, Queue* input, Queue* output,
+                     Utility utility = {}, double alpha = 0.10)
+        : IOperator(std::move(name))
+        , input_(input), output_(output), utility_(std::move(utility))
+        , tracker_(*output, alpha)
+    {
+        set_batch_size(1);
+    }
+
+    void attach_metrics(OperatorMetrics* m) override { metrics_ = m; }
+
+    // Batch mode: move up to n events per tick(); the cutoff is computed
+    // once per batch. Must be called before the runtime starts.
+    void set_batch_size(std::size_t n) {
+        batch_size_ = n < 1 ? 1 : n;
+        in_batch_.resize(batch_size_);
+        out_batch_.set_capacity(batch_size_);
+    }
+
+    bool ready() const noexcept override { return !out_batch_.empty() || !input_->empty(); }
+    void wake_on_input(Parker* p) override { input_->set_waker(p); }
+
+    OpStatus tick() override {
+        if (!out_batch_.empty()) return flush_pending(out_batch_, *output_, metrics_);
+
+        const std::size_t n = input_->try_pop_n(in_batch_.data(), batch_size_);
+        if (n == 0) {
+            if (metrics_) metrics_->events_idle.increment();
+            return OpStatus::Idle;
+        }
+
+        tracker_.update();
+        const double cutoff = cutoff_now();
+        cutoff_.store(cutoff, std::memory_order_relaxed);
+        std::size_t dropped = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            if (keep(in_batch_[i].data, cutoff)) out_batch_.append(in_batch_[i]);
+            else ++dropped;
+        }
+        if (dropped) {
+            shed_.add(dropped);
+            if (metrics_) {
+                metrics_->events_shed.add(dropped);
+                metrics_->events_processed.add(dropped);
+            }
+        }
+        return flush_pending(out_batch_, *output_, metrics_);
+    }
+
+    std::uint64_t shed() const noexcept { return shed_.load(); }
+    // Cutoff applied by the latest tick, 0 (no shedding) to 1. Any thread.
+    double cutoff() const noexcept { return cutoff_.load(std::memory_order_relaxed); }
+
+private:
+    double cutoff_now() const noexcept {
+        if (tracker_.last() > BP_HARD_THRESHOLD) return 1.0;
+        const double c = (tracker_.ema() - BP_SOFT_THRESHOLD) / (BP_HARD_THRESHOLD - BP_SOFT_THRESHOLD);
+        return std::clamp(c, 0.0, 1.0);
+    }
+
+    bool keep(const T& v, double cutoff) {
+        if (cutoff <= 0.0) return true;
+        if (utility_) return utility_(v) >= cutoff;
+        // Sampling: keep (1 - cutoff) of the events, evenly spaced.
+        credit_ += 1.0 - cutoff;
+        if (credit_ < 1.0) return false;
+        credit_ -= 1.0;
+        return true;
+    }
+
+    Queue*                      input_;
+    Queue*                      output_;
+    Utility                     utility_;
+    EMAOccupancyTracker<Queue>  tracker_;
+    double                      credit_{0.0};
+    LocalCounter                shed_;
+    std::atomic<double>         cutoff_{0.0};
+    OperatorMetrics*            metrics_{nullptr};
+    std::size_t                 batch_size_{1};
+    std::vector<Event<T>>       in_batch_;
+    PendingBatch<Event<T>>      out_batch_;
+};
+
+} // namespace klstream
@@ -1,10 +1,14 @@
 // include/klstream/operators/map.hpp
 #pragma once
 #include "../core/operator.hpp"
+#include "../core/batch.hpp"
 #include "../core/event.hpp"
+#include "../core/fusion.hpp"
 #include "../core/spsc_queue.hpp"
 #include "../core/metrics.hpp"
+#include <cstddef>
 #include <functional>
+#include <vector>
 
 namespace klstream {
 
@@ -15,13 +19,16 @@ namespace klstream {
 // to the output queue. Metadata (timestamp_ns, key, seq) is forwarded
 // unchanged so latency measurement is accurate end-to-end.
 //
+// Fusable on both sides (see fusion.hpp). When fused, fn may be re-run on
+// an event whose result could not be delivered; it must be pure.
+//
 // Example:
 //   MapOperator<uint64_t, uint64_t> squarer(
 //       "squarer",
 //       &q_in, &q_out,
 //       [](uint64_t x) -> uint64_t { return x * x; });
 template <typename In, typename Out>
-class MapOperator : public IOperator {
+class MapOperator : public IOperator, public EventConsumer<In> {
 public:
     using InQueue  = SPSCQueue<Event<In>>;
     using OutQueue = SPSCQueue<Event<Out>>;
@@ -34,10 +41,41 @@ public:
 
     void attach_metrics(OperatorMetrics* m) override { metrics_ = m; }
 
+    // Batch mode: move up to n events per tick() via try_pop_n / try_push_n,
+    // amortising the virtual tick() call and the queue index publication.
+    // n == 1 (the default) keeps the one-event-per-tick behaviour. Must be
+    // called before the runtime starts.
+    void set_batch_size(std::size_t n) {
+        batch_size_ = n < 1 ? 1 : n;
+        in_batch_.resize(batch_size_);
+        out_batch_.set_capacity(batch_size_);
+    }
+
+    bool ready() const noexcept override { return has_pending_ || !out_batch_.empty() || !input_->empty(); }
+    void wake_on_input(Parker* p) override { input_->set_waker(p); }
+
+    bool fuse_downstream(IOperator* next) override { return output_.fuse(next); }
+
+    bool offer(const Event<In>& in_ev) override {
+        Event<Out> out_ev;
+        out_ev.timestamp_ns = in_ev.timestamp_ns;
+        out_ev.key          = in_ev.key;
+        out_ev.seq          = in_ev.seq;
+        out_ev.event_ts_ns  = in_ev.event_ts_ns;
+        out_ev.data         = fn_(in_ev.data);
+        if (!output_.try_push(out_ev)) return false;
+        if (metrics_) metrics_->events_processed.increment();
+        return true;
+    }
+
+    const InQueue* fused_input() const noexcept override { return input_; }
+
     OpStatus tick() override {
+        if (batch_size_ > 1) return tick_batch();
+
         // If we have a pending output from a previous Blocked tick, try again.
         if (has_pending_) {
-            if (output_->try_push(pending_)) {
+            if (output_.try_push(pending_)) {
                 has_pending_ = false;
                 if (metrics_) metrics_->events_processed.increment();
                 return OpStatus::Processed;
@@ -56,9 +94,10 @@ public:
         out_ev.timestamp_ns = in_ev.timestamp_ns; // forward original timestamp
         out_ev.key          = in_ev.key;
         out_ev.seq          = in_ev.seq;
+        out_ev.event_ts_ns  = in_ev.event_ts_ns;
         out_ev.data         = fn_(in_ev.data);
 
-        if (output_->try_push(out_ev)) {
+        if (output_.try_push(out_ev)) {
             if (metrics_) metrics_->events_processed.increment();
             return OpStatus::Processed;
         }
@@ -72,12 +111,36 @@ public:
     }
 
 private:
+    OpStatus tick_batch() {
+        if (!out_batch_.empty()) return flush_pending(out_batch_, output_, metrics_);
+
+        const std::size_t n = input_->try_pop_n(in_batch_.data(), batch_size_);
+        if (n == 0) {
+            if (metrics_) metrics_->events_idle.increment();
+            return OpStatus::Idle;
+        }
+        for (std::size_t i = 0; i < n; ++i) {
+            const Event<In>& in_ev = in_batch_[i];
+            Event<Out> out_ev;
+            out_ev.timestamp_ns = in_ev.timestamp_ns;
+            out_ev.key          = in_ev.key;
+            out_ev.seq          = in_ev.seq;
+            out_ev.event_ts_ns  = in_ev.event_ts_ns;
+            out_ev.data         = fn_(in_ev.data);
+            out_batch_.append(out_ev);
+        }
+        return flush_pending(out_batch_, output_, metrics_);
+    }
+
     InQueue*          input_;
-    OutQueue*         output_;
+    FusedOutput<Out>  output_;
     Fn                fn_;
     Event<Out>        pending_{};
     bool              has_pending_{false};
     OperatorMetrics*  metrics_{nullptr};
+    std::size_t              batch_size_{1};
+    std::vector<Event<In>>   in_batch_;
+    PendingBatch<Event<Out>> out_batch_;
 };
 
 } // namespace klstream
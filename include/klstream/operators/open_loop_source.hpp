@@ -0,0 +1,170 @@
+// include/klstream/operators/open_loop_source.hpp
+#pragma once
+#include "../core/operator.hpp"
+#include "../core/batch.hpp"
+#include "../core/clock.hpp"
+#include "../core/event.hpp"
+#include "../core/spsc_queue.hpp"
+#include "../core/metrics.hpp"
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <stdexcept>
+
+namespace klstream {
+
+// ── ArrivalSchedule ───────────────────────────────────────────────────────
+//
+// Intended send times of an open-loop load: the offset of each event from
+// the start of the run, fixed in advance by the profile and rate and not by
+// how fast the pipeline drains.
+//
+//   Constant — one event every 1/rate.
+//   Poisson  — exponential gaps with mean 1/rate (independent arrivals).
+//   Bursty   — burst_len events at burst_factor x rate, then silence until
+//              the next burst is due, so the long-run rate is still `rate`.
+//
+// Deterministic for a given seed, so two runs offer the same load.
+enum class ArrivalProfile : std::uint8_t { Constant, Poisson, Bursty };
+
+class ArrivalSchedule {
+public:
+    ArrivalSchedule(ArrivalProfile profile, double events_per_sec, std::uint64_t seed = 42,
+                    std::size_t burst_len = 1000, double burst_factor = 10.0)
+        : profile_(profile)
+        , gap_ns_(events_per_sec > 0 ? 1e9 / events_per_sec : 0.0)
+        , burst_len_(burst_len < 1 ? 1 : burst_len)
+        , burst_factor_(burst_factor < 1.0 ? 1.0 : burst_factor)
+        , rng_(seed)
+    {
+        if (!(events_per_sec > 0) || !std::isfinite(events_per_sec))
+            throw std::invalid_argument("ArrivalSchedule: events_per_sec must be positive");
+    }
+
+    // Offset of the next event, then advance past it.
+    std::uint64_t next() noexcept {
+        const std::uint64_t at = static_cast<std::uint64_t>(t_);
+        switch (profile_) {
+            case ArrivalProfile::Constant:
+                t_ += gap_ns_;
+                break;
+            case ArrivalProfile::Poisson:
+                t_ += -std::log(1.0 - uniform_(rng_)) * gap_ns_;
+                break;
+            case ArrivalProfile::Bursty:
+                if (++in_burst_ < burst_len_) {
+                    t_ += gap_ns_ / burst_factor_;
+                } else {
+                    in_burst_   = 0;
+                    burst_at_  += gap_ns_ * static_cast<double>(burst_len_);
+                    t_          = burst_at_;
+                }
+                break;
+        }
+        return at;
+    }
+
+    double events_per_sec() const noexcept { return 1e9 / gap_ns_; }
+
+private:
+    ArrivalProfile                         profile_;
+    double                                 gap_ns_;
+    std::size_t                            burst_len_;
+    double                                 burst_factor_;
+    double                                 t_{0.0};
+    double                                 burst_at_{0.0};
+    std::size_t                            in_burst_{0};
+    std::mt19937_64                        rng_;
+    std::uniform_real_distribution<double> uniform_{0.0, 1.0};
+};
+
+// ── OpenLoopSource<T> ─────────────────────────────────────────────────────
+//
+// A source that offers load on an ArrivalSchedule, independent of the
+// pipeline behind it, and stamps each event with its *intended* send time:
+// timestamp_ns = event_ts_ns = run start + schedule offset. Sink latency
+// (Event::latency_ns) is then measured from when the event should have
+// entered the system, not from when the source got round to it.
+//
+// That is what avoids coordinated omission. A closed-loop source — one that
+// generates as fast as the queue accepts (SourceOperator) — simply stops
+// generating while the pipeline stalls, so the events that would have
+// waited out the stall are never created and never measured. Here the
+// schedule keeps running: after a stall the source is behind, emits the
+// overdue events immediately, and each carries the full delay since its
+// intended time. Past saturation, lag_ns() grows without bound.
+//
+// Each tick() emits every event that is due, up to batch_size(); Idle when
+// none is. gen(seq) supplies the payload. The clock starts at the first
+// tick().
+template <typename T>
+class OpenLoopSource : public IOperator {
+public:
+    using Queue     = SPSCQueue<Event<T>>;
+    using Generator = std::function<T(std::uint64_t seq)>;
+
+    OpenLoopSource(std::string name, Queue* output, ArrivalSchedule schedule, Generator gen)
+        : IOperator(std::move(name)), output_(output), schedule_(std::move(schedule)), gen_(std::move(gen))
+    {
+        set_batch_size(1);
+    }
+
+    void attach_metrics(OperatorMetrics* m) override { metrics_ = m; }
+
+    // Events emitted per tick() at most, when that many are due. Must be
+    // called before the runtime starts.
+    void set_batch_size(std::size_t n) {
+        batch_size_ = n < 1 ? 1 : n;
+        out_batch_.set_capacity(batch_size_);
+    }
+
+    OpStatus tick() override {
+        if (!out_batch_.empty()) return flush_pending(out_batch_, *output_, metrics_);
+
+        const std::uint64_t now = Clock::now_ns();
+        if (start_ns_ == 0) {
+            start_ns_ = now;
+            next_ns_  = start_ns_ + schedule_.next();
+        }
+        std::size_t made = 0;
+        while (made < batch_size_ && next_ns_ <= now) {
+            Event<T> ev{ next_ns_, 0, seq_, next_ns_, gen_(seq_) };
+            ++seq_;
+            out_batch_.append(ev);
+            next_ns_ = start_ns_ + schedule_.next();
+            ++made;
+        }
+        lag_ns_.store(now > next_ns_ ? now - next_ns_ : 0, std::memory_order_relaxed);
+        if (made == 0) {
+            if (metrics_) metrics_->events_idle.increment();
+            return OpStatus::Idle;
+        }
+        return flush_pending(out_batch_, *output_, metrics_);
+    }
+
+    // Events generated (emitted or pending). From the operator's own
+    // thread or after the runtime has stopped.
+    std::uint64_t generated() const noexcept { return seq_; }
+
+    // How far behind its schedule the source was at its last tick that was
+    // not held by a full queue: ~0 while the pipeline keeps up. Readable
+    // from any thread.
+    std::uint64_t lag_ns() const noexcept { return lag_ns_.load(std::memory_order_relaxed); }
+
+private:
+    Queue*                     output_;
+    ArrivalSchedule            schedule_;
+    Generator                  gen_;
+    std::uint64_t              start_ns_{0};
+    std::uint64_t              next_ns_{0};
+    std::uint64_t              seq_{0};
+    std::atomic<std::uint64_t> lag_ns_{0};
+    OperatorMetrics*           metrics_{nullptr};
+    std::size_t                batch_size_{1};
+    PendingBatch<Event<T>>     out_batch_;
+};
+
+} // namespace klstream
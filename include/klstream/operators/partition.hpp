@@ -0,0 +1,193 @@
+// include/klstream/operators/partition.hpp
+#pragma once
+#include "../core/operator.hpp"
+#include "../core/batch.hpp"
+#include "../core/event.hpp"
+#include "../core/spsc_queue.hpp"
+#include "../core/metrics.hpp"
+#include "../core/keyed_state.hpp"
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace klstream {
+
+// ── partition_of ──────────────────────────────────────────────────────────
+//
+// Which of n partitions owns `key`. The key is mixed (mix64, so dense ids
+// like campaign numbers spread out) and the 64-bit hash space is cut into n
+// equal contiguous ranges by a multiply-shift: partition p owns hashes
+// [p * 2^64 / n, (p + 1) * 2^64 / n). Every key therefore has exactly one
+// owner, the ranges are disjoint, and no division is needed. The range is
+// picked by the high bits of the hash; a replica's KeyedStateStore indexes
+// by the low bits, so one partition's keys still fill the whole table.
+inline std::size_t partition_of(std::uint64_t key, std::size_t n) noexcept {
+    __extension__ typedef unsigned __int128 u128;
+    return static_cast<std::size_t>((static_cast<u128>(mix64(key)) * n) >> 64);
+}
+
+// ── PartitionOperator<T> ──────────────────────────────────────────────────
+//
+// Routes each event to outputs[partition_of(key, N)], so all events of a key
+// reach the same replica of a stateful keyed operator (KeyedAggregateOperator,
+// KeyedTumblingCountWindow), and each replica owns a disjoint key range.
+// Unlike FanOutOperator, placement depends only on the key, never on load.
+//
+// An optional key function re-keys each event (ev.key = key_of(ev.data))
+// before routing — for streams whose grouping field lives in the payload.
+//
+// Routing is batched: up to batch_size() events are popped with one
+// try_pop_n, bucketed per partition, and each bucket is published with one
+// try_push_n. If any bucket cannot be fully delivered nothing new is popped
+// until it drains: one slow replica stalls the partitioner (as it would a
+// single downstream operator), but per-key order is never broken and no
+// more than one batch is ever held.
+template <typename T>
+class PartitionOperator : public IOperator {
+public:
+    using Queue = SPSCQueue<Event<T>>;
+    using KeyFn = std::function<std::uint64_t(const T&)>;
+
+    PartitionOperator(std::string name, Queue* input, std::vector<Queue*> outputs,
+                      KeyFn key_of = nullptr)
+        : IOperator(std::move(name))
+        , input_(input), outputs_(std::move(outputs)), key_of_(std::move(key_of))
+        , buckets_(outputs_.size())
+    {
+        assert(!outputs_.empty());
+        set_batch_size(1);
+    }
+
+    void attach_metrics(OperatorMetrics* m) override { metrics_ = m; }
+
+    // Events popped per tick(). Each bucket can hold a whole batch (all of
+    // it may hash to one partition). Must be called before the runtime starts.
+    void set_batch_size(std::size_t n) {
+        batch_size_ = n < 1 ? 1 : n;
+        in_batch_.resize(batch_size_);
+        for (auto& b : buckets_) b.set_capacity(batch_size_);
+    }
+
+    std::size_t partitions() const noexcept { return outputs_.size(); }
+
+    bool ready() const noexcept override { return held() || !input_->empty(); }
+    void wake_on_input(Parker* p) override { input_->set_waker(p); }
+
+    OpStatus tick() override {
+        if (held()) {
+            const std::size_t pushed = flush();
+            if (!held()) return OpStatus::Processed;
+            if (metrics_) metrics_->events_blocked.increment();
+            return pushed ? OpStatus::Processed : OpStatus::Blocked;
+        }
+
+        const std::size_t n = input_->try_pop_n(in_batch_.data(), batch_size_);
+        if (n == 0) {
+            if (metrics_) metrics_->events_idle.increment();
+            return OpStatus::Idle;
+        }
+        const std::size_t parts = outputs_.size();
+        for (std::size_t i = 0; i < n; ++i) {
+            Event<T>& ev = in_batch_[i];
+            if (key_of_) ev.key = key_of_(ev.data);
+            buckets_[partition_of(ev.key, parts)].append(ev);
+        }
+        flush();
+        if (held() && metrics_) metrics_->events_blocked.increment();
+        return OpStatus::Processed;
+    }
+
+private:
+    bool held() const noexcept {
+        for (const auto& b : buckets_) if (!b.empty()) return true;
+        return false;
+    }
+
+    std::size_t flush() noexcept {
+        std::size_t pushed = 0;
+        for (std::size_t p = 0; p < buckets_.size(); ++p) pushed += buckets_[p].flush(*outputs_[p]);
+        if (metrics_ && pushed) metrics_->events_processed.add(pushed);
+        return pushed;
+    }
+
+    Queue*                              input_;
+    std::vector<Queue*>                 outputs_;
+    KeyFn                               key_of_;
+    std::vector<PendingBatch<Event<T>>> buckets_;     // one per output
+    std::vector<Event<T>>               in_batch_;
+    std::size_t                         batch_size_{1};
+    OperatorMetrics*                    metrics_{nullptr};
+};
+
+// ── MergeOperator<T> ──────────────────────────────────────────────────────
+//
+// The fan-in after keyed replicas: drains N input queues round-robin into
+// one output. Events from one input stay in order — so per-key order
+// survives a PartitionOperator -> replicas -> MergeOperator hop — but
+// inputs interleave in arrival order. (To restore the global input order of
+// a FanOutOperator, use OrderedMergeOperator.)
+template <typename T>
+class MergeOperator : public IOperator {
+public:
+    using Queue = SPSCQueue<Event<T>>;
+
+    MergeOperator(std::string name, std::vector<Queue*> inputs, Queue* output)
+        : IOperator(std::move(name))
+        , inputs_(std::move(inputs)), output_(output)
+    {
+        assert(!inputs_.empty());
+        set_batch_size(1);
+    }
+
+    void attach_metrics(OperatorMetrics* m) override { metrics_ = m; }
+
+    // Events forwarded per tick(), across all inputs.
+    void set_batch_size(std::size_t n) {
+        batch_size_ = n < 1 ? 1 : n;
+        in_batch_.resize(batch_size_);
+        out_batch_.set_capacity(batch_size_);
+    }
+
+    bool ready() const noexcept override {
+        if (!out_batch_.empty()) return true;
+        for (const auto* q : inputs_) if (!q->empty()) return true;
+        return false;
+    }
+    void wake_on_input(Parker* p) override {
+        for (auto* q : inputs_) q->set_waker(p);
+    }
+
+    OpStatus tick() override {
+        if (!out_batch_.empty()) return flush_pending(out_batch_, *output_, metrics_);
+
+        // One pass over the inputs, starting after the last one served, so
+        // a busy input cannot starve the others.
+        std::size_t taken = 0;
+        const std::size_t n_in = inputs_.size();
+        for (std::size_t k = 0; k < n_in && taken < batch_size_; ++k) {
+            const std::size_t i = (next_ + k) % n_in;
+            const std::size_t got = inputs_[i]->try_pop_n(in_batch_.data(), batch_size_ - taken);
+            for (std::size_t j = 0; j < got; ++j) out_batch_.append(in_batch_[j]);
+            taken += got;
+        }
+        next_ = (next_ + 1) % n_in;
+        if (taken == 0) {
+            if (metrics_) metrics_->events_idle.increment();
+            return OpStatus::Idle;
+        }
+        return flush_pending(out_batch_, *output_, metrics_);
+    }
+
+private:
+    std::vector<Queue*>    inputs_;
+    Queue*                 output_;
+    std::size_t            next_{0};
+    std::vector<Event<T>>  in_batch_;
+    PendingBatch<Event<T>> out_batch_;
+    std::size_t            batch_size_{1};
+    OperatorMetrics*       metrics_{nullptr};
+};
+
+} // namespace klstream
@@ -0,0 +1,361 @@
+// include/klstream/operators/pipeline.hpp
+#pragma once
+#include "../core/operator.hpp"
+#include "../core/batch.hpp"
+#include "../core/config.hpp"
+#include "../core/event.hpp"
+#include "../core/spsc_queue.hpp"
+#include "../core/metrics.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace klstream {
+
+// ── dsl: compile-time pipelines ───────────────────────────────────────────
+//
+// The runtime-assembled operators keep their user logic in std::function
+// and are ticked through IOperator's vtable, so nothing inlines across
+// stages. This is the static alternative for a fixed linear chain:
+//
+//   namespace dsl = klstream::dsl;
+//   auto ysb = dsl::from("ysb", &q_in)
+//            | dsl::filter([](const AdEvent& e) { return e.event_type == 0; })
+//            | dsl::map([](const AdEvent& e) { return CampaignResult{...}; })
+//            | dsl::window<1000>(top_campaign)
+//            | dsl::to(&q_out);            // or dsl::sink(fn)
+//   rt.register_op(&ysb, 0);
+//
+// Every callable is kept by its own (lambda) type, each stage's payload type
+// is deduced from the one before, and the stages call each other directly,
+// so the compiler sees — and inlines — the whole chain. The result is one
+// PipelineOperator: a single IOperator whose tick() moves up to
+// batch_size() head events through every stage, so the one virtual call is
+// amortised over the batch rather than paid per event per stage.
+//
+// Heads:  from(name, queue)          pop Event<T> from an SPSCQueue
+//         source<T>(name, gen)       bool gen(Event<T>& out, uint64_t seq),
+//                                    as SourceOperator's generator
+// Stages: filter(pred)               bool pred(const T&)
+//         map(fn)                    U fn(const T&)
+//         window<N>(aggr)            U aggr(const std::vector<Event<T>>&),
+//                                    every N events (as TumblingCountWindow)
+// Tails:  to(queue)                  push Event<T> to an SPSCQueue
+//         sink(fn)                   void fn(const Event<T>&)
+//
+// Metadata is forwarded as by the operator each stage mirrors. Backpressure
+// follows the batch protocol (see PendingBatch): each head event yields at
+// most one tail event, so a full output queue holds at most one batch,
+// and no head input is taken until it has drained.
+namespace dsl {
+
+// ── Stage specs (what the user writes) ────────────────────────────────────
+
+template <typename Pred> struct FilterSpec { Pred pred; };
+template <typename Fn>   struct MapSpec    { Fn fn; };
+template <std::size_t N, typename Fn> struct WindowSpec { Fn aggr; };
+template <typename T>    struct ToSpec     { SPSCQueue<Event<T>>* queue; };
+template <typename Fn>   struct SinkSpec   { Fn fn; };
+
+template <typename Pred>
+FilterSpec<std::decay_t<Pred>> filter(Pred&& pred) { return { std::forward<Pred>(pred) }; }
+
+template <typename Fn>
+MapSpec<std::decay_t<Fn>> map(Fn&& fn) { return { std::forward<Fn>(fn) }; }
+
+template <std::size_t N, typename Fn>
+WindowSpec<N, std::decay_t<Fn>> window(Fn&& aggr) {
+    static_assert(N > 0, "dsl::window<N>: N must be positive");
+    return { std::forward<Fn>(aggr) };
+}
+
+template <typename T>
+ToSpec<T> to(SPSCQueue<Event<T>>* queue) { return { queue }; }
+
+template <typename Fn>
+SinkSpec<std::decay_t<Fn>> sink(Fn&& fn) { return { std::forward<Fn>(fn) }; }
+
+// ── Stages (what runs) ────────────────────────────────────────────────────
+//
+// push(ev, next) handles one event and calls next(out) for each output.
+
+template <typename T, typename Pred>
+struct FilterStage {
+    using Out = T;
+    Pred pred;
+
+    template <typename Next>
+    void push(const Event<T>& ev, Next&& next) {
+        if (pred(ev.data)) next(ev);
+    }
+};
+
+template <typename T, typename Fn>
+struct MapStage {
+    using Out = std::decay_t<std::invoke_result_t<Fn&, const T&>>;
+    Fn fn;
+
+    template <typename Next>
+    void push(const Event<T>& ev, Next&& next) {
+        Event<Out> out;
+        out.timestamp_ns = ev.timestamp_ns;
+        out.key          = ev.key;
+        out.seq          = ev.seq;
+        out.event_ts_ns  = ev.event_ts_ns;
+        out.data         = fn(ev.data);
+        next(out);
+    }
+};
+
+template <typename T, std::size_t N, typename Fn>
+struct WindowStage {
+    using Out = std::decay_t<std::invoke_result_t<Fn&, const std::vector<Event<T>>&>>;
+    Fn                    aggr;
+    std::vector<Event<T>> buffer{};
+    std::uint64_t         window_start_ts{0};
+
+    explicit WindowStage(Fn f) : aggr(std::move(f)) { buffer.reserve(N); }
+
+    template <typename Next>
+    void push(const Event<T>& ev, Next&& next) {
+        if (buffer.empty()) window_start_ts = ev.timestamp_ns;
+        buffer.push_back(ev);
+        if (buffer.size() < N) return;
+        Event<Out> out;
+        out.timestamp_ns = window_start_ts;
+        out.key          = ev.key;
+        out.seq          = ev.seq;
+        out.event_ts_ns  = ev.event_ts_ns;
+        out.data         = aggr(buffer);
+        buffer.clear();
+        next(out);
+    }
+};
+
+// ── Heads ─────────────────────────────────────────────────────────────────
+//
+// pull(n, emit) feeds up to n events to emit(ev) and returns how many.
+
+template <typename T>
+class QueueHead {
+public:
+    using Out = T;
+
+    explicit QueueHead(SPSCQueue<Event<T>>* q) : queue_(q) {}
+
+    void set_batch_size(std::size_t n) { buf_.resize(n); }
+
+    template <typename Emit>
+    std::size_t pull(std::size_t n, Emit&& emit) {
+        const std::size_t got = queue_->try_pop_n(buf_.data(), n);
+        for (std::size_t i = 0; i < got; ++i) emit(buf_[i]);
+        return got;
+    }
+
+    bool ready() const noexcept { return !queue_->empty(); }
+    void wake_on_input(Parker* p) { queue_->set_waker(p); }
+
+private:
+    SPSCQueue<Event<T>>*  queue_;
+    std::vector<Event<T>> buf_;
+};
+
+template <typename T, typename Gen>
+class GeneratorHead {
+public:
+    using Out = T;
+
+    explicit GeneratorHead(Gen g) : gen_(std::move(g)) {}
+
+    void set_batch_size(std::size_t) {}
+
+    template <typename Emit>
+    std::size_t pull(std::size_t n, Emit&& emit) {
+        std::size_t made = 0;
+        while (made < n) {
+            Event<T> ev;
+            if (!gen_(ev, seq_++)) break;
+            emit(ev);
+            ++made;
+        }
+        return made;
+    }
+
+    bool ready() const noexcept { return true; }
+    void wake_on_input(Parker*) {}
+
+private:
+    Gen           gen_;
+    std::uint64_t seq_{0};
+};
+
+// ── Tails ─────────────────────────────────────────────────────────────────
+//
+// push(ev) takes one output; flush() delivers what push() could not and
+// returns how many it delivered; empty() is true once nothing is held.
+
+template <typename T>
+class QueueTail {
+public:
+    explicit QueueTail(SPSCQueue<Event<T>>* q) : queue_(q) {}
+
+    void set_batch_size(std::size_t n) { pending_.set_capacity(n); }
+
+    void        push(const Event<T>& ev) noexcept { pending_.append(ev); }
+    std::size_t flush() noexcept { return pending_.flush(*queue_); }
+    bool        empty() const noexcept { return pending_.empty(); }
+
+private:
+    SPSCQueue<Event<T>>*   queue_;
+    PendingBatch<Event<T>> pending_;
+};
+
+template <typename T, typename Fn>
+class SinkTail {
+public:
+    explicit SinkTail(Fn f) : fn_(std::move(f)) {}
+
+    void        set_batch_size(std::size_t) {}
+    void        push(const Event<T>& ev) { fn_(ev); }
+    std::size_t flush() noexcept { return 0; }
+    bool        empty() const noexcept { return true; }
+
+private:
+    Fn fn_;
+};
+
+// ── PipelineOperator ──────────────────────────────────────────────────────
+
+template <typename Head, typename Tail, typename... Stages>
+class PipelineOperator : public IOperator {
+public:
+    PipelineOperator(std::string name, Head head, std::tuple<Stages...> stages, Tail tail)
+        : IOperator(std::move(name))
+        , head_(std::move(head)), stages_(std::move(stages)), tail_(std::move(tail))
+    {
+        set_batch_size(DEFAULT_BATCH_SIZE);
+    }
+
+    void attach_metrics(OperatorMetrics* m) override { metrics_ = m; }
+
+    // Head events moved through the chain per tick(). Defaults to
+    // DEFAULT_BATCH_SIZE: with the stages inlined, the per-tick virtual call
+    // is the cost left to amortise. Must be called before the runtime starts.
+    void set_batch_size(std::size_t n) {
+        batch_size_ = n < 1 ? 1 : n;
+        head_.set_batch_size(batch_size_);
+        tail_.set_batch_size(batch_size_);
+    }
+    std::size_t batch_size() const noexcept { return batch_size_; }
+
+    bool ready() const noexcept override { return !tail_.empty() || head_.ready(); }
+    void wake_on_input(Parker* p) override { head_.wake_on_input(p); }
+
+    // events_processed counts head events taken in; events_blocked counts
+    // ticks that found the output still full.
+    OpStatus tick() override {
+        if (!tail_.empty()) {
+            const std::size_t pushed = tail_.flush();
+            if (!tail_.empty()) {
+                if (metrics_) metrics_->events_blocked.increment();
+                return pushed ? OpStatus::Processed : OpStatus::Blocked;
+            }
+        }
+
+        const std::size_t n = head_.pull(batch_size_, [this](const auto& ev) { run<0>(ev); });
+        if (n == 0) {
+            if (metrics_) metrics_->events_idle.increment();
+            return OpStatus::Idle;
+        }
+        if (metrics_) metrics_->events_processed.add(n);
+        tail_.flush();
+        return OpStatus::Processed;
+    }
+
+private:
+    template <std::size_t I, typename E>
+    void run(const E& ev) {
+        if constexpr (I == sizeof...(Stages)) {
+            tail_.push(ev);
+        } else {
+            std::get<I>(stages_).push(ev, [this](const auto& out) { run<I + 1>(out); });
+        }
+    }
+
+    Head                  head_;
+    std::tuple<Stages...> stages_;
+    Tail                  tail_;
+    OperatorMetrics*      metrics_{nullptr};
+    std::size_t           batch_size_{1};
+};
+
+// ── Pipeline (a head plus stages, not yet terminated) ─────────────────────
+
+template <typename T, typename Head, typename... Stages>
+struct Pipeline {
+    std::string           name;
+    Head                  head;
+    std::tuple<Stages...> stages;
+};
+
+template <typename T>
+Pipeline<T, QueueHead<T>> from(std::string name, SPSCQueue<Event<T>>* queue) {
+    return { std::move(name), QueueHead<T>(queue), {} };
+}
+
+template <typename T, typename Gen>
+Pipeline<T, GeneratorHead<T, std::decay_t<Gen>>> source(std::string name, Gen&& gen) {
+    return { std::move(name), GeneratorHead<T, std::decay_t<Gen>>(std::forward<Gen>(gen)), {} };
+}
+
+template <typename T, typename Head, typename... Stages, typename Stage>
+auto append(Pipeline<T, Head, Stages...>&& p, Stage&& s) {
+    using S = std::decay_t<Stage>;
+    return Pipeline<typename S::Out, Head, Stages..., S>{
+        std::move(p.name), std::move(p.head),
+        std::tuple_cat(std::move(p.stages), std::make_tuple(std::forward<Stage>(s))) };
+}
+
+template <typename T, typename Head, typename... Stages, typename Pred>
+auto operator|(Pipeline<T, Head, Stages...>&& p, FilterSpec<Pred> f) {
+    static_assert(std::is_invocable_r_v<bool, Pred&, const T&>,
+                  "dsl::filter: predicate must be callable as bool(const T&)");
+    return append(std::move(p), FilterStage<T, Pred>{ std::move(f.pred) });
+}
+
+template <typename T, typename Head, typename... Stages, typename Fn>
+auto operator|(Pipeline<T, Head, Stages...>&& p, MapSpec<Fn> m) {
+    static_assert(std::is_invocable_v<Fn&, const T&>,
+                  "dsl::map: function must be callable as U(const T&)");
+    return append(std::move(p), MapStage<T, Fn>{ std::move(m.fn) });
+}
+
+template <typename T, typename Head, typename... Stages, std::size_t N, typename Fn>
+auto operator|(Pipeline<T, Head, Stages...>&& p, WindowSpec<N, Fn> w) {
+    static_assert(std::is_invocable_v<Fn&, const std::vector<Event<T>>&>,
+                  "dsl::window: aggregate must be callable as U(const std::vector<Event<T>>&)");
+    return append(std::move(p), WindowStage<T, N, Fn>(std::move(w.aggr)));
+}
+
+template <typename T, typename Head, typename... Stages, typename U>
+PipelineOperator<Head, QueueTail<T>, Stages...>
+operator|(Pipeline<T, Head, Stages...>&& p, ToSpec<U> t) {
+    static_assert(std::is_same_v<T, U>, "dsl::to: queue payload differs from the pipeline's");
+    return { std::move(p.name), std::move(p.head), std::move(p.stages), QueueTail<T>(t.queue) };
+}
+
+template <typename T, typename Head, typename... Stages, typename Fn>
+PipelineOperator<Head, SinkTail<T, Fn>, Stages...>
+operator|(Pipeline<T, Head, Stages...>&& p, SinkSpec<Fn> s) {
+    static_assert(std::is_invocable_v<Fn&, const Event<T>&>,
+                  "dsl::sink: function must be callable as void(const Event<T>&)");
+    return { std::move(p.name), std::move(p.head), std::move(p.stages),
+             SinkTail<T, Fn>(std::move(s.fn)) };
+}
+
+} // namespace dsl
+} // namespace klstream
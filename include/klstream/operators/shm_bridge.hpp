@@ -0,0 +1,82 @@
+// include/klstream/operators/shm_bridge.hpp
+#pragma once
+#include "../core/operator.hpp"
+#include "../core/batch.hpp"
+#include "../core/event.hpp"
+#include "../core/spsc_queue.hpp"
+#include "../core/shm_queue.hpp"
+#include "../core/metrics.hpp"
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace klstream {
+
+// ── QueueBridge<T, InQueue, OutQueue> ────────────────────────────────────
+//
+// Moves events unchanged from one queue to another, in batches of up to
+// set_batch_size() (default 64) — one try_pop_n and one try_push_n per
+// tick(). Its use is crossing a process boundary, where every operator
+// still reads and writes SPSCQueues and only this edge is shared memory:
+//
+//   feed process:    source -> SPSCQueue -> ShmPublishOperator  -> ShmSPSCQueue
+//   engine process:  ShmSPSCQueue -> ShmSubscribeOperator -> SPSCQueue -> window ...
+//
+// Event::timestamp_ns survives the crossing: Clock is anchored to the
+// system-wide steady clock, so latency is still measured from ingest in
+// the feed process. A bridge reading shared memory has no Parker to be
+// woken by (see ShmSPSCQueue) and is polled.
+template <typename T, typename InQueue, typename OutQueue>
+class QueueBridge : public IOperator {
+public:
+    QueueBridge(std::string name, InQueue* input, OutQueue* output)
+        : IOperator(std::move(name))
+        , input_(input), output_(output)
+    {
+        set_batch_size(64);
+    }
+
+    void attach_metrics(OperatorMetrics* m) override { metrics_ = m; }
+
+    // Must be called before the runtime starts.
+    void set_batch_size(std::size_t n) {
+        batch_size_ = n < 1 ? 1 : n;
+        in_batch_.resize(batch_size_);
+        out_batch_.set_capacity(batch_size_);
+    }
+
+    bool ready() const noexcept override { return !out_batch_.empty() || !input_->empty(); }
+
+    void wake_on_input(Parker* p) override {
+        if constexpr (std::is_same_v<InQueue, SPSCQueue<T>>) input_->set_waker(p);
+        else (void)p;
+    }
+
+    OpStatus tick() override {
+        if (!out_batch_.empty()) return flush_pending(out_batch_, *output_, metrics_);
+
+        const std::size_t n = input_->try_pop_n(in_batch_.data(), batch_size_);
+        if (n == 0) {
+            if (metrics_) metrics_->events_idle.increment();
+            return OpStatus::Idle;
+        }
+        for (std::size_t i = 0; i < n; ++i) out_batch_.append(in_batch_[i]);
+        return flush_pending(out_batch_, *output_, metrics_);
+    }
+
+private:
+    InQueue*         input_;
+    OutQueue*        output_;
+    OperatorMetrics* metrics_{nullptr};
+    std::size_t      batch_size_{1};
+    std::vector<T>   in_batch_;
+    PendingBatch<T>  out_batch_;
+};
+
+template <typename T>
+using ShmPublishOperator = QueueBridge<Event<T>, SPSCQueue<Event<T>>, ShmSPSCQueue<Event<T>>>;
+
+template <typename T>
+using ShmSubscribeOperator = QueueBridge<Event<T>, ShmSPSCQueue<Event<T>>, SPSCQueue<Event<T>>>;
+
+} // namespace klstream
@@ -1,11 +1,14 @@
 // include/klstream/operators/sink.hpp
 #pragma once
 #include "../core/operator.hpp"
+#include "../core/batch.hpp"
 #include "../core/event.hpp"
 #include "../core/spsc_queue.hpp"
 #include "../core/metrics.hpp"
+#include <cstddef>
 #include <functional>
 #include <cstdint>
+#include <vector>
 
 namespace klstream {
 
@@ -36,7 +39,19 @@ public:
 
     void attach_metrics(OperatorMetrics* m) override { metrics_ = m; }
 
+    // Batch mode: drain up to n events per tick() with one try_pop_n.
+    // n == 1 (the default) keeps the one-event-per-tick behaviour.
+    void set_batch_size(std::size_t n) {
+        batch_size_ = n < 1 ? 1 : n;
+        in_batch_.resize(batch_size_);
+    }
+
+    bool ready() const noexcept override { return !input_->empty(); }
+    void wake_on_input(Parker* p) override { input_->set_waker(p); }
+
     OpStatus tick() override {
+        if (batch_size_ > 1) return tick_batch();
+
         Event<T> ev;
         if (!input_->try_pop(&ev)) {
             if (metrics_) metrics_->events_idle.increment();
@@ -48,9 +63,22 @@ public:
     }
 
 private:
+    OpStatus tick_batch() {
+        const std::size_t n = input_->try_pop_n(in_batch_.data(), batch_size_);
+        if (n == 0) {
+            if (metrics_) metrics_->events_idle.increment();
+            return OpStatus::Idle;
+        }
+        for (std::size_t i = 0; i < n; ++i) consumer_(in_batch_[i]);
+        if (metrics_) metrics_->events_processed.add(n);
+        return OpStatus::Processed;
+    }
+
     Queue*           input_;
     ConsumerFn       consumer_;
     OperatorMetrics* metrics_{nullptr};
+    std::size_t           batch_size_{1};
+    std::vector<Event<T>> in_batch_;
 };
 
 } // namespace klstream
@@ -0,0 +1,144 @@
+// include/klstream/operators/sketch_window.hpp
+#pragma once
+#include "../core/operator.hpp"
+#include "../core/batch.hpp"
+#include "../core/event.hpp"
+#include "../core/sketch.hpp"
+#include "../core/spsc_queue.hpp"
+#include "../core/metrics.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace klstream {
+
+// ── SketchCountWindow<T, Sketch, Out> ─────────────────────────────────────
+//
+// A tumbling count window over a sketch (sketch.hpp): every window_size
+// inputs, the key of each folded into one Sketch, emit one extract() of it
+// and clear it. Stamped like IncrementalCountWindow's outputs (timestamp
+// of the window's first event, key and seq of its last). Where an exact
+// aggregation builds a per-key map inside TumblingCountWindow's AggrFn,
+// state here is the sketch's fixed footprint whatever the key cardinality.
+//
+// The key is Event::key, or key_of(event) if given (a field of the data:
+// a campaign id, an ad id). Each tick() pops up to batch_size() events,
+// gathers their keys into one array and hands each window's share of it
+// to Sketch::add_n in one call.
+//
+// Sketch is CountMinSketch, HyperLogLog or SpaceSaving, or any type with
+// add_n(const uint64_t*, size_t) and clear(). For keyed-parallel
+// replicas, let extract() return the sketch's fixed-size state (Out =
+// HyperLogLogState<P> and the like, see sketch.hpp) and merge() each
+// replica's windows into one sketch downstream.
+//
+// Example — distinct ads per 10 000 views:
+//   SketchCountWindow<AdEvent, HyperLogLog, double> distinct(
+//       "distinct_ads", &q_in, &q_out, 10000, HyperLogLog(12),
+//       [](const HyperLogLog& h) { return h.estimate(); },
+//       [](const Event<AdEvent>& e) -> uint64_t { return e.data.ad_id; });
+template <typename T, typename Sketch, typename Out>
+class SketchCountWindow : public IOperator {
+public:
+    using InQueue   = SPSCQueue<Event<T>>;
+    using OutQueue  = SPSCQueue<Event<Out>>;
+    using ExtractFn = std::function<Out(const Sketch&)>;
+    using KeyFn     = std::function<std::uint64_t(const Event<T>&)>;
+
+    SketchCountWindow(std::string name,
+                      InQueue*    input,
+                      OutQueue*   output,
+                      std::size_t window_size,
+                      Sketch      sketch,
+                      ExtractFn   extract,
+                      KeyFn       key_of = {})
+        : IOperator(std::move(name))
+        , input_(input), output_(output)
+        , window_size_(window_size < 1 ? 1 : window_size)
+        , sketch_(std::move(sketch)), extract_(std::move(extract)), key_of_(std::move(key_of))
+    {
+        set_batch_size(1);
+    }
+
+    void attach_metrics(OperatorMetrics* m) override { metrics_ = m; }
+
+    // Events popped per tick(). Must be called before the runtime starts.
+    void set_batch_size(std::size_t n) {
+        batch_size_ = n < 1 ? 1 : n;
+        in_batch_.resize(batch_size_);
+        keys_.resize(batch_size_);
+        out_batch_.set_capacity(batch_size_);
+    }
+
+    bool ready() const noexcept override { return !out_batch_.empty() || !input_->empty(); }
+    void wake_on_input(Parker* p) override { input_->set_waker(p); }
+
+    // Inputs folded into the open window so far, and its sketch. Only
+    // meaningful from the operator's own thread or after the runtime has
+    // stopped.
+    std::size_t   open_count() const noexcept { return count_; }
+    const Sketch& sketch() const noexcept { return sketch_; }
+
+    OpStatus tick() override {
+        if (!out_batch_.empty()) return flush_pending(out_batch_, *output_, metrics_);
+
+        const std::size_t n = input_->try_pop_n(in_batch_.data(), batch_size_);
+        if (n == 0) {
+            if (metrics_) metrics_->events_idle.increment();
+            return OpStatus::Idle;
+        }
+        if (key_of_) {
+            for (std::size_t i = 0; i < n; ++i) keys_[i] = key_of_(in_batch_[i]);
+        } else {
+            for (std::size_t i = 0; i < n; ++i) keys_[i] = in_batch_[i].key;
+        }
+
+        std::size_t folded_only = 0;
+        for (std::size_t i = 0; i < n;) {
+            if (count_ == 0) start_ts_ = in_batch_[i].timestamp_ns;
+            const std::size_t run = std::min(n - i, window_size_ - count_);
+            sketch_.add_n(keys_.data() + i, run);
+            count_ += run;
+            i      += run;
+            if (count_ < window_size_) {
+                folded_only += run;
+                continue;
+            }
+            folded_only += run - 1;
+            const Event<T>& last = in_batch_[i - 1];
+            Event<Out> out_ev;
+            out_ev.timestamp_ns = start_ts_;
+            out_ev.key          = last.key;
+            out_ev.seq          = last.seq;
+            out_ev.event_ts_ns  = last.event_ts_ns;
+            out_ev.data         = extract_(sketch_);
+            out_batch_.append(out_ev);
+            sketch_.clear();
+            count_ = 0;
+        }
+        // Folded events count as processed now; window outputs when pushed.
+        if (metrics_ && folded_only) metrics_->events_processed.add(folded_only);
+        if (out_batch_.empty()) return OpStatus::Processed;
+        return flush_pending(out_batch_, *output_, metrics_);
+    }
+
+private:
+    InQueue*                   input_;
+    OutQueue*                  output_;
+    std::size_t                window_size_;
+    Sketch                     sketch_;
+    ExtractFn                  extract_;
+    KeyFn                      key_of_;
+    std::size_t                count_{0};
+    std::uint64_t              start_ts_{0};
+    OperatorMetrics*           metrics_{nullptr};
+    std::size_t                batch_size_{1};
+    std::vector<Event<T>>      in_batch_;
+    std::vector<std::uint64_t> keys_;
+    PendingBatch<Event<Out>>   out_batch_;
+};
+
+} // namespace klstream
@@ -0,0 +1,355 @@
+// include/klstream/operators/sliding_window.hpp
+#pragma once
+#include "../core/operator.hpp"
+#include "../core/batch.hpp"
+#include "../core/clock.hpp"
+#include "../core/event.hpp"
+#include "../core/spsc_queue.hpp"
+#include "../core/metrics.hpp"
+#include "incremental_window.hpp"
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+namespace klstream {
+
+// ── PaneStack<Acc> ────────────────────────────────────────────────────────
+//
+// FIFO of pane accumulators that answers "merge of everything in it" in
+// amortised O(1) merges — the two-stack sliding aggregation. New panes go
+// on the back stack, which keeps a running merge of its panes; evictions
+// pop the front stack, whose every entry holds the merge of itself and all
+// newer front entries. When the front runs dry, the back stack is flipped
+// into it, rebuilding those suffix merges once per pane. Each pane is thus
+// merged a constant number of times whatever the window/pane ratio.
+//
+// Needs merge(a, b) associative (a := a ⊕ b, a older than b); it need not
+// be commutative or invertible (max, min, top-k all work).
+template <typename Acc>
+class PaneStack {
+public:
+    using MergeFn = std::function<void(Acc&, const Acc&)>;
+
+    PaneStack(Acc identity, MergeFn merge)
+        : identity_(std::move(identity)), merge_(std::move(merge)), back_agg_(identity_) {}
+
+    std::size_t size() const noexcept { return front_.size() + back_.size(); }
+    bool        empty() const noexcept { return size() == 0; }
+
+    void push(const Acc& pane) {
+        back_.push_back(pane);
+        merge_(back_agg_, pane);
+    }
+
+    // Drops the oldest pane.
+    void pop() {
+        assert(!empty());
+        if (front_.empty()) flip();
+        front_.pop_back();
+    }
+
+    // Merge of every pane, oldest first.
+    Acc query() const {
+        Acc out = front_.empty() ? identity_ : front_.back();
+        if (!back_.empty()) merge_(out, back_agg_);
+        return out;
+    }
+
+    void clear() {
+        front_.clear();
+        back_.clear();
+        back_agg_ = identity_;
+    }
+
+private:
+    void flip() {
+        // back_ oldest..newest -> front_ with the oldest (merge of all) on top.
+        for (auto it = back_.rbegin(); it != back_.rend(); ++it) {
+            if (front_.empty()) {
+                front_.push_back(*it);
+            } else {
+                Acc suffix = *it;
+                merge_(suffix, front_.back());
+                front_.push_back(std::move(suffix));
+            }
+        }
+        back_.clear();
+        back_agg_ = identity_;
+    }
+
+    Acc              identity_;
+    MergeFn          merge_;
+    std::vector<Acc> front_;      // suffix merges; back() is the oldest pane's
+    std::vector<Acc> back_;       // raw panes, oldest first
+    Acc              back_agg_;   // merge of back_
+};
+
+// ── SlidingCountWindow<T, Acc, Out> ───────────────────────────────────────
+//
+// Every `slide` inputs, emits extract() over the last `size` inputs (once
+// `size` have arrived). slide < size gives overlapping (sliding) windows,
+// slide == size tumbling ones, slide > size hopping windows with gaps.
+//
+// Pane decomposition: inputs fold into panes of gcd(size, slide) events
+// with WindowAggregate::accumulate, and a closed pane is shared by every
+// window that covers it — a PaneStack merges it in, and evicts it, a
+// constant number of times. Each event is therefore aggregated once, and
+// cost per event does not grow with size / slide. State: size / gcd panes.
+//
+// Requires WindowAggregate::merge. Outputs are stamped with the timestamp
+// of the window's first event and the key and seq of its last.
+template <typename T, typename Acc, typename Out>
+class SlidingCountWindow : public IOperator {
+public:
+    using InQueue   = SPSCQueue<Event<T>>;
+    using OutQueue  = SPSCQueue<Event<Out>>;
+    using Aggregate = WindowAggregate<T, Acc, Out>;
+
+    SlidingCountWindow(std::string name,
+                       InQueue*    input,
+                       OutQueue*   output,
+                       std::size_t size,
+                       std::size_t slide,
+                       Aggregate   agg)
+        : IOperator(std::move(name))
+        , input_(input), output_(output)
+        , size_(size < 1 ? 1 : size), slide_(slide < 1 ? 1 : slide)
+        , pane_len_(std::gcd(size_, slide_)), panes_per_window_(size_ / pane_len_)
+        , agg_(std::move(agg))
+        , panes_(Pane{ agg_.init, 0 }, [m = agg_.merge](Pane& a, const Pane& b) {
+              m(a.acc, b.acc);
+              if (a.first_ts == 0) a.first_ts = b.first_ts;
+          })
+        , pane_{ agg_.init, 0 }
+    {
+        assert(agg_.merge && "SlidingCountWindow needs WindowAggregate::merge");
+        set_batch_size(1);
+    }
+
+    void attach_metrics(OperatorMetrics* m) override { metrics_ = m; }
+
+    // Events popped per tick(). Must be called before the runtime starts.
+    void set_batch_size(std::size_t n) {
+        batch_size_ = n < 1 ? 1 : n;
+        in_batch_.resize(batch_size_);
+        out_batch_.set_capacity(batch_size_);
+    }
+
+    bool ready() const noexcept override { return !out_batch_.empty() || !input_->empty(); }
+    void wake_on_input(Parker* p) override { input_->set_waker(p); }
+
+    // Events per pane, and panes held for the current window.
+    std::size_t pane_length() const noexcept { return pane_len_; }
+    std::size_t panes() const noexcept { return panes_.size(); }
+
+    OpStatus tick() override {
+        if (!out_batch_.empty()) return flush_pending(out_batch_, *output_, metrics_);
+
+        const std::size_t n = input_->try_pop_n(in_batch_.data(), batch_size_);
+        if (n == 0) {
+            if (metrics_) metrics_->events_idle.increment();
+            return OpStatus::Idle;
+        }
+        std::size_t folded_only = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            const Event<T>& in_ev = in_batch_[i];
+            if (in_pane_ == 0) pane_.first_ts = in_ev.timestamp_ns;
+            agg_.accumulate(pane_.acc, in_ev.data);
+            ++seen_;
+            if (++in_pane_ == pane_len_) {
+                panes_.push(pane_);
+                if (panes_.size() > panes_per_window_) panes_.pop();
+                pane_    = Pane{ agg_.init, 0 };
+                in_pane_ = 0;
+            }
+            if (seen_ < size_ || seen_ % slide_ != 0) {
+                ++folded_only;
+                continue;
+            }
+            const Pane w = panes_.query();
+            Event<Out> out_ev;
+            out_ev.timestamp_ns = w.first_ts;
+            out_ev.key          = in_ev.key;
+            out_ev.seq          = in_ev.seq;
+            out_ev.event_ts_ns  = in_ev.event_ts_ns;
+            out_ev.data         = agg_.extract(w.acc);
+            out_batch_.append(out_ev);
+        }
+        if (metrics_ && folded_only) metrics_->events_processed.add(folded_only);
+        if (out_batch_.empty()) return OpStatus::Processed;
+        return flush_pending(out_batch_, *output_, metrics_);
+    }
+
+private:
+    struct Pane {
+        Acc           acc;
+        std::uint64_t first_ts;   // timestamp of the pane's first event
+    };
+
+    InQueue*                 input_;
+    OutQueue*                output_;
+    std::size_t              size_;
+    std::size_t              slide_;
+    std::size_t              pane_len_;
+    std::size_t              panes_per_window_;
+    Aggregate                agg_;
+    PaneStack<Pane>          panes_;      // closed panes of the current window
+    Pane                     pane_;       // the open pane
+    std::size_t              in_pane_{0};
+    std::uint64_t            seen_{0};
+    OperatorMetrics*         metrics_{nullptr};
+    std::size_t              batch_size_{1};
+    std::vector<Event<T>>    in_batch_;
+    PendingBatch<Event<Out>> out_batch_;
+};
+
+// ── SlidingTimeWindow<T, Acc, Out> ────────────────────────────────────────
+//
+// Every `slide` (processing time, from construction), emits extract() over
+// the events that arrived in the last `size` — e.g. "last 10 s, every 1 s".
+// Same pane scheme as SlidingCountWindow, with panes gcd(size, slide) long:
+// one accumulate() per event, one PaneStack push / pop per pane. A window
+// with no events is not emitted; the windows that end before `size` has
+// elapsed cover only the time since construction. Outputs are stamped with
+// the window's start time and its index (as seq), key 0.
+//
+// Panes close on tick(), so the operator must keep being ticked while idle
+// (ready() stays true, as for TumblingTimeWindow). Once the last pane with
+// events has left the window, the rest of an idle gap is skipped in one
+// step rather than replayed pane by pane; at most batch_size() windows are
+// emitted per tick().
+template <typename T, typename Acc, typename Out>
+class SlidingTimeWindow : public IOperator {
+public:
+    using InQueue   = SPSCQueue<Event<T>>;
+    using OutQueue  = SPSCQueue<Event<Out>>;
+    using Aggregate = WindowAggregate<T, Acc, Out>;
+
+    SlidingTimeWindow(std::string name,
+                      InQueue*    input,
+                      OutQueue*   output,
+                      std::chrono::nanoseconds size,
+                      std::chrono::nanoseconds slide,
+                      Aggregate   agg)
+        : IOperator(std::move(name))
+        , input_(input), output_(output)
+        , size_ns_(clamp_ns(size)), slide_ns_(clamp_ns(slide))
+        , pane_ns_(std::gcd(size_ns_, slide_ns_))
+        , panes_per_window_(size_ns_ / pane_ns_), panes_per_slide_(slide_ns_ / pane_ns_)
+        , agg_(std::move(agg))
+        , panes_(Pane{ agg_.init, 0 }, [m = agg_.merge](Pane& a, const Pane& b) {
+              m(a.acc, b.acc);
+              a.events += b.events;
+          })
+        , pane_{ agg_.init, 0 }
+    {
+        assert(agg_.merge && "SlidingTimeWindow needs WindowAggregate::merge");
+        set_batch_size(1);
+        pane_end_ns_ = Clock::now_ns() + pane_ns_;
+    }
+
+    void attach_metrics(OperatorMetrics* m) override { metrics_ = m; }
+
+    // Events popped, and windows emitted at most, per tick(). Must be
+    // called before the runtime starts.
+    void set_batch_size(std::size_t n) {
+        batch_size_ = n < 1 ? 1 : n;
+        in_batch_.resize(batch_size_);
+        out_batch_.set_capacity(batch_size_);
+    }
+
+    std::chrono::nanoseconds pane_length() const noexcept { return std::chrono::nanoseconds(pane_ns_); }
+
+    OpStatus tick() override {
+        if (!out_batch_.empty()) return flush_pending(out_batch_, *output_, metrics_);
+
+        const std::uint64_t now = Clock::now_ns();
+        if (now >= pane_end_ns_) {
+            close_panes(now);
+            if (!out_batch_.empty()) return flush_pending(out_batch_, *output_, metrics_);
+        }
+
+        const std::size_t n = input_->try_pop_n(in_batch_.data(), batch_size_);
+        if (n == 0) {
+            if (metrics_) metrics_->events_idle.increment();
+            return OpStatus::Idle;
+        }
+        for (std::size_t i = 0; i < n; ++i) agg_.accumulate(pane_.acc, in_batch_[i].data);
+        pane_.events += n;
+        if (metrics_) metrics_->events_processed.add(n);
+        return OpStatus::Processed;
+    }
+
+private:
+    struct Pane {
+        Acc           acc;
+        std::uint64_t events;
+    };
+
+    static std::uint64_t clamp_ns(std::chrono::nanoseconds d) noexcept {
+        return d.count() < 1 ? 1 : static_cast<std::uint64_t>(d.count());
+    }
+
+    // Closes every pane that ended by `now`, emitting the windows that end
+    // with them (up to the out batch's capacity; the rest next tick).
+    void close_panes(std::uint64_t now) {
+        while (now >= pane_end_ns_ && out_batch_.size() < out_batch_.capacity()) {
+            if (pane_.events == 0 && pane_index_ - data_end_ >= panes_per_window_) {
+                // No pane holds data: every window up to `now` is empty.
+                // Jump to the pane containing `now` in one step, counting
+                // the panes and windows passed so boundaries stay aligned.
+                const std::uint64_t skip = (now - pane_end_ns_) / pane_ns_ + 1;
+                panes_.clear();
+                window_count_ += (pane_index_ + skip) / panes_per_slide_ - pane_index_ / panes_per_slide_;
+                pane_index_   += skip;
+                pane_end_ns_  += skip * pane_ns_;
+                return;
+            }
+            panes_.push(pane_);
+            if (panes_.size() > panes_per_window_) panes_.pop();
+            ++pane_index_;
+            if (pane_.events > 0) data_end_ = pane_index_;
+            pane_ = Pane{ agg_.init, 0 };
+            if (pane_index_ % panes_per_slide_ == 0) {
+                const Pane w = panes_.query();
+                if (w.events > 0) {
+                    Event<Out> out_ev;
+                    out_ev.timestamp_ns = pane_end_ns_ - size_ns_;
+                    out_ev.key          = 0;
+                    out_ev.seq          = window_count_;
+                    out_ev.event_ts_ns  = out_ev.timestamp_ns;
+                    out_ev.data         = agg_.extract(w.acc);
+                    out_batch_.append(out_ev);
+                }
+                ++window_count_;
+            }
+            pane_end_ns_ += pane_ns_;
+        }
+    }
+
+    InQueue*                 input_;
+    OutQueue*                output_;
+    std::uint64_t            size_ns_;
+    std::uint64_t            slide_ns_;
+    std::uint64_t            pane_ns_;
+    std::uint64_t            panes_per_window_;
+    std::uint64_t            panes_per_slide_;
+    Aggregate                agg_;
+    PaneStack<Pane>          panes_;
+    Pane                     pane_;
+    std::uint64_t            pane_end_ns_{0};
+    std::uint64_t            pane_index_{0};    // panes closed so far
+    std::uint64_t            data_end_{0};      // pane_index_ after the newest pane with events closed
+    std::uint64_t            window_count_{0};
+    OperatorMetrics*         metrics_{nullptr};
+    std::size_t              batch_size_{1};
+    std::vector<Event<T>>    in_batch_;
+    PendingBatch<Event<Out>> out_batch_;
+};
+
+} // namespace klstream
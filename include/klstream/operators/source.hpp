@@ -1,12 +1,17 @@
 // include/klstream/operators/source.hpp
 #pragma once
 #include "../core/operator.hpp"
+#include "../core/batch.hpp"
 #include "../core/event.hpp"
+#include "../core/fusion.hpp"
 #include "../core/spsc_queue.hpp"
 #include "../core/metrics.hpp"
 #include "../core/backpressure.hpp"
+#include "../core/checkpoint.hpp"
+#include <algorithm>
 #include <functional>
 #include <atomic>
+#include <cstddef>
 #include <cstdint>
 
 namespace klstream {
@@ -20,17 +25,29 @@ namespace klstream {
 // When the generator returns false, the source is exhausted (finite source).
 // When it returns true and populates `out`, the source pushes `out` downstream.
 //
-// Rate limiting:
-//   If a TokenBucketRateLimiter is attached (via enable_rate_limiting()),
-//   the source checks the bucket before calling the generator. This is the
-//   mechanism for both:
-//     (a) basic rate control (cap at N events/sec for testing)
-//     (b) adaptive backpressure (reduce rate when EMA occupancy rises)
+// Rate limiting / adaptive backpressure:
+//   enable_rate_limiting(max) caps the source at `max` events/s with a
+//   TokenBucketRateLimiter whose rate an AimdRateController sets from the
+//   occupancy of the output queue — and of any downstream queue added via
+//   flow_control().watch(), so a slow stage several hops away throttles the
+//   source directly (StreamGraphBuilder does this for a rate_limit()ed
+//   source). The controller samples at most once per
+//   BP_CONTROL_INTERVAL_NS; a tick otherwise costs one coarse clock read
+//   and the token check.
 //
 // Backpressure:
 //   If the output queue is full (try_push returns false), the source caches
 //   the generated event in pending_ and returns Blocked. On the next tick()
 //   it attempts to push pending_ again without generating a new event.
+//
+// Fusion:
+//   A downstream Filter/Map can be fused in (see fusion.hpp); the source then
+//   hands each generated event to it instead of pushing it to the queue.
+//
+// Checkpointing:
+//   With checkpoint_generator() the source can join a Checkpointer, as the
+//   place its barriers enter the stream (CheckpointPort::at_source, at the
+//   top of every tick). The generator must stamp strictly increasing seqs.
 template <typename T>
 class SourceOperator : public IOperator {
 public:
@@ -43,40 +60,91 @@ public:
         , gen_(std::move(gen))
     {}
 
+    // The bucket holds a few controller intervals' worth of tokens, not a
+    // whole second's: a full bucket would let a burst through unthrottled.
+    // Before the runtime starts; set_batch_size() may come before or after.
     void enable_rate_limiting(double events_per_sec) {
-        limiter_ = std::make_unique<TokenBucketRateLimiter>(events_per_sec);
-        ema_tracker_ = std::make_unique<EMAOccupancyTracker<Queue>>(*output_);
+        rate_limit_ = events_per_sec;
+        make_limiter();
+        controller_ = std::make_unique<AimdRateController>(events_per_sec);
+        controller_->watch(*output_.queue());
     }
 
+    // The controller behind enable_rate_limiting(), nullptr without it.
+    // watch() further queues on it before the runtime starts.
+    AimdRateController*       flow_control() noexcept { return controller_.get(); }
+    const AimdRateController* flow_control() const noexcept { return controller_.get(); }
+
     void attach_metrics(OperatorMetrics* m) override { metrics_ = m; }
 
+    // Not with adaptive backpressure: the controller watches the output
+    // queue, which a fused source no longer fills.
+    bool fuse_downstream(IOperator* next) override {
+        return !controller_ && output_.fuse(next);
+    }
+
+    // The generator's own position, for checkpointing: `save` copies it out
+    // (on this operator's thread, between two events), `load` takes it back
+    // before the runtime starts — FinancialTickSource::snapshot / restore.
+    // Before Checkpointer::add().
+    void checkpoint_generator(std::function<void(StateWriter&)> save, std::function<void(StateReader&)> load) {
+        gen_save_ = std::move(save);
+        gen_load_ = std::move(load);
+    }
+
+    bool attach_checkpoint(CheckpointPort* port) override {
+        if (!gen_save_ || !gen_load_) return false;
+        port->become_source();
+        port_ = port;
+        return true;
+    }
+
+    void snapshot(StateWriter& out) const override {
+        out.put(seq_);
+        out.put(next_seq_);
+        gen_save_(out);
+    }
+
+    void restore(StateReader& in) override {
+        seq_      = in.get<std::uint64_t>();
+        next_seq_ = in.get<std::uint64_t>();
+        gen_load_(in);
+    }
+
+    // Batch mode: generate up to n events per tick() and publish them with a
+    // single try_push_n. The rate limiter is still consulted per event, so a
+    // batch never overshoots the configured rate. n == 1 (the default) keeps
+    // the one-event-per-tick behaviour.
+    void set_batch_size(std::size_t n) {
+        batch_size_ = n < 1 ? 1 : n;
+        out_batch_.set_capacity(batch_size_);
+        if (limiter_) make_limiter();
+    }
+
     OpStatus tick() override {
+        if (port_) port_->at_source(next_seq_);
+
         // ── Adaptive backpressure (if enabled) ───────────────────────────
-        if (ema_tracker_) {
-            ema_tracker_->update();
-            if (ema_tracker_->hard_pressure()) {
+        if (controller_) {
+            now_ns_ = Clock::coarse_ns();
+            if (!controller_->update(now_ns_)) {
                 if (metrics_) metrics_->events_blocked.increment();
                 return OpStatus::Blocked;
             }
-            if (ema_tracker_->soft_pressure() && limiter_) {
-                // Reduce rate to 50% of configured rate.
-                limiter_->set_rate(limiter_->rate() * 0.5);
-            } else if (limiter_) {
-                // Recover rate gradually (5% per tick toward original).
-                limiter_->set_rate(
-                    std::min(limiter_->rate() * 1.05, original_rate_));
-            }
+            limiter_->set_rate(controller_->rate());
         }
 
+        if (batch_size_ > 1) return tick_batch();
+
         // ── Rate limiter check ────────────────────────────────────────────
-        if (limiter_ && !limiter_->try_consume()) {
+        if (limiter_ && !limiter_->try_consume(now_ns_)) {
             if (metrics_) metrics_->events_idle.increment();
             return OpStatus::Idle;
         }
 
         // ── Push pending event from previous Blocked tick ─────────────────
         if (has_pending_) {
-            if (output_->try_push(pending_)) {
+            if (output_.try_push(pending_)) {
                 has_pending_ = false;
                 if (metrics_) metrics_->events_processed.increment();
                 return OpStatus::Processed;
@@ -88,11 +156,13 @@ public:
         // ── Generate a new event ──────────────────────────────────────────
         Event<T> ev;
         if (!gen_(ev, seq_++)) {
+            if (limiter_) limiter_->refund();
             if (metrics_) metrics_->events_idle.increment();
             return OpStatus::Idle; // Generator exhausted or throttling.
         }
+        next_seq_ = ev.seq + 1;
 
-        if (output_->try_push(ev)) {
+        if (output_.try_push(ev)) {
             if (metrics_) metrics_->events_processed.increment();
             return OpStatus::Processed;
         }
@@ -105,15 +175,56 @@ public:
     }
 
 private:
-    Queue*             output_;
+    // The burst is at least one batch, and at least two steps of the
+    // coarse clock the bucket refills from: with less, each refill of one
+    // step's tokens would be clipped at the cap and the source would fall
+    // short of its rate.
+    void make_limiter() {
+        const double interval = 4.0 * static_cast<double>(BP_CONTROL_INTERVAL_NS);
+        const double step     = 2.0 * static_cast<double>(Clock::coarse_resolution_ns());
+        const double burst    = rate_limit_ * std::max(interval, step) * 1e-9;
+        limiter_ = std::make_unique<TokenBucketRateLimiter>(
+            rate_limit_, std::max(burst, static_cast<double>(batch_size_)));
+    }
+
+    OpStatus tick_batch() {
+        if (!out_batch_.empty()) return flush_pending(out_batch_, output_, metrics_);
+
+        std::size_t made = 0;
+        while (made < batch_size_) {
+            if (limiter_ && !limiter_->try_consume(now_ns_)) break;
+            Event<T> ev;
+            if (!gen_(ev, seq_++)) {
+                if (limiter_) limiter_->refund();   // no event: the token is unspent
+                break;
+            }
+            next_seq_ = ev.seq + 1;
+            out_batch_.append(ev);
+            ++made;
+        }
+        if (made == 0) {
+            if (metrics_) metrics_->events_idle.increment();
+            return OpStatus::Idle;
+        }
+        return flush_pending(out_batch_, output_, metrics_);
+    }
+
+    FusedOutput<T>     output_;
     Generator          gen_;
     std::uint64_t      seq_{0};
     Event<T>           pending_{};
     bool               has_pending_{false};
-    double             original_rate_{0.0};
+    std::uint64_t      now_ns_{0};
     OperatorMetrics*   metrics_{nullptr};
+    std::size_t            batch_size_{1};
+    PendingBatch<Event<T>> out_batch_;
+    double                                           rate_limit_{0.0};
     std::unique_ptr<TokenBucketRateLimiter>          limiter_;
-    std::unique_ptr<EMAOccupancyTracker<Queue>>      ema_tracker_;
+    std::unique_ptr<AimdRateController>              controller_;
+    std::uint64_t                          next_seq_{0};   // last generated seq + 1
+    CheckpointPort*                        port_{nullptr};
+    std::function<void(StateWriter&)>      gen_save_;
+    std::function<void(StateReader&)>      gen_load_;
 };
 
 } // namespace klstream
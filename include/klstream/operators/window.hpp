@@ -1,6 +1,9 @@
 // include/klstream/operators/window.hpp
 #pragma once
 #include "../core/operator.hpp"
+#include "../core/batch.hpp"
+#include "../core/clock.hpp"
+#include "../core/keyed_state.hpp"
 #include "../core/event.hpp"
 #include "../core/spsc_queue.hpp"
 #include "../core/metrics.hpp"
@@ -20,6 +23,9 @@ namespace klstream {
 //
 // Memory: stores up to window_size events in a std::vector (pre-reserved).
 // The window fires and emits exactly one Out event per window_size inputs.
+// When the aggregation can be folded an event at a time, prefer
+// IncrementalCountWindow (incremental_window.hpp): one accumulator instead
+// of the buffer, and no pass over it at close.
 //
 // Example — window average over every 100 integers:
 //   TumblingCountWindow<uint64_t, double> avg_window(
@@ -50,7 +56,21 @@ public:
 
     void attach_metrics(OperatorMetrics* m) override { metrics_ = m; }
 
+    // Batch mode: pop up to n events per tick() with one try_pop_n. Several
+    // windows may close inside one batch; their outputs are pushed together.
+    // n == 1 (the default) keeps the one-event-per-tick behaviour.
+    void set_batch_size(std::size_t n) {
+        batch_size_ = n < 1 ? 1 : n;
+        in_batch_.resize(batch_size_);
+        out_batch_.set_capacity(batch_size_);
+    }
+
+    bool ready() const noexcept override { return has_pending_ || !out_batch_.empty() || !input_->empty(); }
+    void wake_on_input(Parker* p) override { input_->set_waker(p); }
+
     OpStatus tick() override {
+        if (batch_size_ > 1) return tick_batch();
+
         if (has_pending_) {
             if (output_->try_push(pending_)) {
                 has_pending_ = false;
@@ -77,6 +97,7 @@ public:
             out_ev.timestamp_ns = window_start_ts_;
             out_ev.key          = in_ev.key;
             out_ev.seq          = in_ev.seq;
+            out_ev.event_ts_ns  = in_ev.event_ts_ns;
             out_ev.data         = aggr_(buffer_);
             buffer_.clear();
 
@@ -95,6 +116,39 @@ public:
     }
 
 private:
+    OpStatus tick_batch() {
+        if (!out_batch_.empty()) return flush_pending(out_batch_, *output_, metrics_);
+
+        const std::size_t n = input_->try_pop_n(in_batch_.data(), batch_size_);
+        if (n == 0) {
+            if (metrics_) metrics_->events_idle.increment();
+            return OpStatus::Idle;
+        }
+        std::size_t buffered_only = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            const Event<T>& in_ev = in_batch_[i];
+            if (buffer_.empty()) window_start_ts_ = in_ev.timestamp_ns;
+            buffer_.push_back(in_ev);
+            if (buffer_.size() < window_size_) {
+                ++buffered_only;
+                continue;
+            }
+            Event<Out> out_ev;
+            out_ev.timestamp_ns = window_start_ts_;
+            out_ev.key          = in_ev.key;
+            out_ev.seq          = in_ev.seq;
+            out_ev.event_ts_ns  = in_ev.event_ts_ns;
+            out_ev.data         = aggr_(buffer_);
+            buffer_.clear();
+            out_batch_.append(out_ev);
+        }
+        // Buffered events count as processed now; window outputs are counted
+        // by flush_pending() when they are actually pushed (as in tick()).
+        if (metrics_ && buffered_only) metrics_->events_processed.add(buffered_only);
+        if (out_batch_.empty()) return OpStatus::Processed;
+        return flush_pending(out_batch_, *output_, metrics_);
+    }
+
     InQueue*          input_;
     OutQueue*         output_;
     std::size_t       window_size_;
@@ -104,6 +158,142 @@ private:
     Event<Out>        pending_{};
     bool              has_pending_{false};
     OperatorMetrics*  metrics_{nullptr};
+    std::size_t              batch_size_{1};
+    std::vector<Event<T>>    in_batch_;
+    PendingBatch<Event<Out>> out_batch_;
+};
+
+// ── KeyedTumblingCountWindow<T, Out> ──────────────────────────────────────
+//
+// TumblingCountWindow per Event::key: each key fills its own window of
+// window_size events, and fires on its own with the key forwarded. Run N of
+// them behind a PartitionOperator to spread the windows over N workers;
+// each replica only ever buffers the keys of its partition.
+//
+// Memory: one buffer of up to window_size events per live key, reserved on
+// the key's first event and reused after every fire.
+template <typename T, typename Out>
+class KeyedTumblingCountWindow : public IOperator {
+public:
+    using InQueue   = SPSCQueue<Event<T>>;
+    using OutQueue  = SPSCQueue<Event<Out>>;
+    using AggrFn    = std::function<Out(const std::vector<Event<T>>&)>;
+
+    KeyedTumblingCountWindow(std::string name,
+                             InQueue*    input,
+                             OutQueue*   output,
+                             std::size_t window_size,
+                             AggrFn      aggr)
+        : IOperator(std::move(name))
+        , input_(input), output_(output)
+        , window_size_(window_size < 1 ? 1 : window_size), aggr_(std::move(aggr))
+    {}
+
+    void attach_metrics(OperatorMetrics* m) override { metrics_ = m; }
+
+    // Batch mode, as TumblingCountWindow.
+    void set_batch_size(std::size_t n) {
+        batch_size_ = n < 1 ? 1 : n;
+        in_batch_.resize(batch_size_);
+        out_batch_.set_capacity(batch_size_);
+    }
+
+    bool ready() const noexcept override { return has_pending_ || !out_batch_.empty() || !input_->empty(); }
+    void wake_on_input(Parker* p) override { input_->set_waker(p); }
+
+    // Keys with a window open or closed so far. Only meaningful from the
+    // operator's own thread or after the runtime has stopped.
+    std::size_t keys() const noexcept { return windows_.size(); }
+
+    OpStatus tick() override {
+        if (batch_size_ > 1) return tick_batch();
+
+        if (has_pending_) {
+            if (output_->try_push(pending_)) {
+                has_pending_ = false;
+                if (metrics_) metrics_->events_processed.increment();
+                return OpStatus::Processed;
+            }
+            if (metrics_) metrics_->events_blocked.increment();
+            return OpStatus::Blocked;
+        }
+
+        Event<T> in_ev;
+        if (!input_->try_pop(&in_ev)) {
+            if (metrics_) metrics_->events_idle.increment();
+            return OpStatus::Idle;
+        }
+
+        Event<Out> out_ev;
+        if (absorb(in_ev, out_ev)) {
+            if (output_->try_push(out_ev)) {
+                if (metrics_) metrics_->events_processed.increment();
+                return OpStatus::Processed;
+            }
+            pending_     = out_ev;
+            has_pending_ = true;
+            if (metrics_) metrics_->events_blocked.increment();
+            return OpStatus::Blocked;
+        }
+
+        if (metrics_) metrics_->events_processed.increment();
+        return OpStatus::Processed; // buffered, not yet emitted
+    }
+
+private:
+    struct Window {
+        std::vector<Event<T>> buffer;
+        std::uint64_t         start_ts{0};
+    };
+
+    // Buffers in_ev in its key's window; true (and `out` set) if it closed.
+    bool absorb(const Event<T>& in_ev, Event<Out>& out) {
+        Window& w = windows_[in_ev.key];
+        if (w.buffer.empty()) {
+            if (w.buffer.capacity() == 0) w.buffer.reserve(window_size_);
+            w.start_ts = in_ev.timestamp_ns;
+        }
+        w.buffer.push_back(in_ev);
+        if (w.buffer.size() < window_size_) return false;
+        out.timestamp_ns = w.start_ts;
+        out.key          = in_ev.key;
+        out.seq          = in_ev.seq;
+        out.event_ts_ns  = in_ev.event_ts_ns;
+        out.data         = aggr_(w.buffer);
+        w.buffer.clear();
+        return true;
+    }
+
+    OpStatus tick_batch() {
+        if (!out_batch_.empty()) return flush_pending(out_batch_, *output_, metrics_);
+
+        const std::size_t n = input_->try_pop_n(in_batch_.data(), batch_size_);
+        if (n == 0) {
+            if (metrics_) metrics_->events_idle.increment();
+            return OpStatus::Idle;
+        }
+        std::size_t buffered_only = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            Event<Out> out_ev;
+            if (absorb(in_batch_[i], out_ev)) out_batch_.append(out_ev);
+            else ++buffered_only;
+        }
+        if (metrics_ && buffered_only) metrics_->events_processed.add(buffered_only);
+        if (out_batch_.empty()) return OpStatus::Processed;
+        return flush_pending(out_batch_, *output_, metrics_);
+    }
+
+    InQueue*          input_;
+    OutQueue*         output_;
+    std::size_t       window_size_;
+    AggrFn            aggr_;
+    KeyedStateStore<Window> windows_;
+    Event<Out>        pending_{};
+    bool              has_pending_{false};
+    OperatorMetrics*  metrics_{nullptr};
+    std::size_t              batch_size_{1};
+    std::vector<Event<T>>    in_batch_;
+    PendingBatch<Event<Out>> out_batch_;
 };
 
 // ── TumblingTimeWindow<T, Out> ────────────────────────────────────────────
@@ -144,7 +334,18 @@ public:
 
     void attach_metrics(OperatorMetrics* m) override { metrics_ = m; }
 
+    // Batch mode: pop up to n events per tick() with one try_pop_n. The
+    // expiry check still runs once at the start of every tick().
+    // n == 1 (the default) keeps the one-event-per-tick behaviour.
+    void set_batch_size(std::size_t n) {
+        batch_size_ = n < 1 ? 1 : n;
+        in_batch_.resize(batch_size_);
+        out_batch_.set_capacity(batch_size_);
+    }
+
     OpStatus tick() override {
+        if (batch_size_ > 1) return tick_batch();
+
         if (has_pending_) {
             if (output_->try_push(pending_)) {
                 has_pending_ = false;
@@ -156,13 +357,14 @@ public:
         }
 
         // Check if the window has expired.
-        std::uint64_t now = now_ns();
+        std::uint64_t now = Clock::now_ns();
         if ((now - window_open_ns_) >= static_cast<std::uint64_t>(window_ns_)) {
             if (!buffer_.empty()) {
                 Event<Out> out_ev;
                 out_ev.timestamp_ns = window_open_ns_;
                 out_ev.key          = 0;
                 out_ev.seq          = window_count_++;
+                out_ev.event_ts_ns  = window_open_ns_;
                 out_ev.data         = aggr_(buffer_);
                 buffer_.clear();
                 reset_window();
@@ -190,15 +392,38 @@ public:
     }
 
 private:
-    void reset_window() {
-        window_open_ns_ = now_ns();
+    OpStatus tick_batch() {
+        if (!out_batch_.empty()) return flush_pending(out_batch_, *output_, metrics_);
+
+        std::uint64_t now = Clock::now_ns();
+        if ((now - window_open_ns_) >= static_cast<std::uint64_t>(window_ns_)) {
+            if (!buffer_.empty()) {
+                Event<Out> out_ev;
+                out_ev.timestamp_ns = window_open_ns_;
+                out_ev.key          = 0;
+                out_ev.seq          = window_count_++;
+                out_ev.event_ts_ns  = window_open_ns_;
+                out_ev.data         = aggr_(buffer_);
+                buffer_.clear();
+                reset_window();
+                out_batch_.append(out_ev);
+                return flush_pending(out_batch_, *output_, metrics_);
+            }
+            reset_window();
+        }
+
+        const std::size_t n = input_->try_pop_n(in_batch_.data(), batch_size_);
+        if (n == 0) {
+            if (metrics_) metrics_->events_idle.increment();
+            return OpStatus::Idle;
+        }
+        for (std::size_t i = 0; i < n; ++i) buffer_.push_back(in_batch_[i].data);
+        if (metrics_) metrics_->events_processed.add(n);
+        return OpStatus::Processed;
     }
 
-    static std::uint64_t now_ns() {
-        using namespace std::chrono;
-        return static_cast<std::uint64_t>(
-            duration_cast<nanoseconds>(
-                steady_clock::now().time_since_epoch()).count());
+    void reset_window() {
+        window_open_ns_ = Clock::now_ns();
     }
 
     InQueue*          input_;
@@ -211,6 +436,9 @@ private:
     Event<Out>        pending_{};
     bool              has_pending_{false};
     OperatorMetrics*  metrics_{nullptr};
+    std::size_t              batch_size_{1};
+    std::vector<Event<T>>    in_batch_;
+    PendingBatch<Event<Out>> out_batch_;
 };
 
 } // namespace klstream
@@ -1,12 +1,21 @@
 #pragma once
 #include "../core/operator.hpp"
+#include "../core/clock.hpp"
 #include "../core/event.hpp"
 #include "../core/spsc_queue.hpp"
 #include "../core/metrics.hpp"
 #include "../core/backpressure.hpp"   // EMAOccupancyTracker — reused as-is
+#include "../core/histogram.hpp"
 #include "types.hpp"
+#include "batch_pool.hpp"
+#include "slo_window_controller.hpp"
 #include <algorithm>
+#include <chrono>
 #include <cstdint>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <vector>
 
 namespace klstream {
 
@@ -60,6 +69,23 @@ public:
     // actually captures thrashing.
     std::uint64_t direction_changes() const { return direction_changes_; }
 
+    // Everything update() depends on or counts, for a window op's checkpoint.
+    void snapshot(StateWriter& out) const {
+        out.put(current_w_);
+        out.put(shrink_events_);
+        out.put(grow_events_);
+        out.put(direction_changes_);
+        out.put(last_dir_);
+    }
+
+    void restore(StateReader& in) {
+        current_w_         = in.get<std::uint32_t>();
+        shrink_events_     = in.get<std::uint64_t>();
+        grow_events_       = in.get<std::uint64_t>();
+        direction_changes_ = in.get<std::uint64_t>();
+        last_dir_          = in.get<int>();
+    }
+
 private:
     void track_direction(double ema_occupancy) {
         int dir = 0;
@@ -85,12 +111,32 @@ private:
 // Implements the IOperator interface (Section 7.5 of the Implementation
 // Guide) — same tick()/OpStatus contract as every other KLStream operator,
 // so it slots into Runtime::register_op() with no special handling.
-class AdaptiveWindowOp : public IOperator {
+//
+// Out selects the window→inference edge:
+//   WindowBatch  — AdaptiveWindowOp: the whole batch travels by value.
+//   WindowHandle — PooledAdaptiveWindowOp: points are written in place into
+//                  a WindowBatchPool slot (attach_pool() before start) and
+//                  only the handle is queued. The EMA then tracks the handle
+//                  queue, which has identical depth semantics.
+//
+// Latency SLO mode (enable_latency_slo()): the window size comes from a
+// SloWindowController instead — sink-side p99 from the LatencyHistogram the
+// sink records into, the inference cost from the InferenceOps'
+// WindowCostModels (one per server, fits averaged), and the tick
+// interarrival this operator measures per window. The
+// histogram is read (a snapshot, differenced against the previous one) only
+// when the controller is due for a decision, at most once per hold_ns.
+//
+// Checkpointing (Checkpointer::add): the partial window, the controller and
+// the occupancy EMA. The SLO controller is not saved; after a restore it
+// starts over from its own initial window.
+template <typename Out>
+class BasicAdaptiveWindowOp : public IOperator {
 public:
     using InQueue  = SPSCQueue<Event<FeatureVector>>;
-    using OutQueue = SPSCQueue<Event<WindowBatch>>;
+    using OutQueue = SPSCQueue<Event<Out>>;
 
-    AdaptiveWindowOp(std::string name, InQueue* input, OutQueue* output,
+    BasicAdaptiveWindowOp(std::string name, InQueue* input, OutQueue* output,
                      std::uint32_t w_min = 16, std::uint32_t w_max = MAX_WINDOW_SIZE,
                      double occ_low = 0.30, double occ_high = 0.70,
                      double shrink_factor = 0.70, double grow_factor = 1.15)
@@ -104,6 +150,66 @@ public:
     void attach_metrics(OperatorMetrics* m) override { metrics_ = m; }
     const AdaptiveWindowController& controller() const { return controller_; }
 
+    // Before the runtime starts. `sink_latency` and the models must outlive
+    // the run. `costs` holds one model per inference replica sharing the
+    // load (each written by its own replica); the controller sees the mean
+    // of the fits of those with samples.
+    void enable_latency_slo(SloWindowController slo, const LatencyHistogram* sink_latency,
+                            std::vector<const WindowCostModel*> costs) {
+        slo_          = std::make_unique<SloWindowController>(slo);
+        sink_latency_ = sink_latency;
+        costs_        = std::move(costs);
+        servers_      = static_cast<unsigned>(std::max<std::size_t>(costs_.size(), 1));
+    }
+
+    // One inference server, or `servers` of which only the one writing
+    // `cost` is measured and stands for the rest.
+    void enable_latency_slo(SloWindowController slo, const LatencyHistogram* sink_latency,
+                            const WindowCostModel* cost, unsigned servers = 1) {
+        enable_latency_slo(std::move(slo), sink_latency, std::vector<const WindowCostModel*>{ cost });
+        servers_ = servers;
+    }
+    const SloWindowController* slo_controller() const { return slo_.get(); }
+
+    // Size of the window being filled (or the last one fired), either mode.
+    std::uint32_t window_size() const { return target_w_; }
+
+    // Pooled variant only: the slab the windows are filled into.
+    void attach_pool(WindowBatchPool* pool) {
+        static_assert(std::is_same_v<Out, WindowHandle>,
+                      "attach_pool() is only meaningful for PooledAdaptiveWindowOp");
+        staging_.pool = pool;
+    }
+
+    bool ready() const noexcept override { return has_pending_ || !input_->empty(); }
+    void wake_on_input(Parker* p) override { input_->set_waker(p); }
+
+    bool attach_checkpoint(CheckpointPort* port) override {
+        port_ = port;
+        return true;
+    }
+
+    void snapshot(StateWriter& out) const override {
+        controller_.snapshot(out);
+        out.put(tracker_.ema());
+        out.put(tracker_.last());
+        out.put(target_w_);
+        out.put(first_ts_);
+        out.put(interarrival_ns_);
+        save_partial_window(out, cur_);
+    }
+
+    // Before the runtime starts; after attach_pool() for the pooled variant.
+    void restore(StateReader& in) override {
+        controller_.restore(in);
+        const double ema = in.get<double>();
+        tracker_.resume(ema, in.get<double>());
+        target_w_        = in.get<std::uint32_t>();
+        first_ts_        = in.get<std::uint64_t>();
+        interarrival_ns_ = in.get<double>();
+        restore_partial_window(in, staging_, cur_);
+    }
+
     OpStatus tick() override {
         if (has_pending_) {
             if (output_->try_push(pending_)) {
@@ -115,32 +221,41 @@ public:
             return OpStatus::Blocked;
         }
 
+        // Every pooled buffer is in flight downstream — same meaning as a
+        // full output queue.
+        if (!cur_ && !staging_.begin(cur_)) {
+            if (metrics_) metrics_->events_blocked.increment();
+            return OpStatus::Blocked;
+        }
+
         // At the START of a new window, capture this window's target size
         // ONCE from the current EMA reading. Held fixed until this window
         // fires (Section 7.2's "shrink for FUTURE windows" rule).
-        if (buffer_.count == 0) {
-            auto start_t = std::chrono::steady_clock::now();
+        if (cur_->count == 0) {
+            const std::uint64_t start_t = Clock::now_ns();
             tracker_.update();
-            target_w_ = controller_.update(tracker_.ema());
-            auto end_t = std::chrono::steady_clock::now();
-            overhead_ns_sum_ += std::chrono::duration_cast<std::chrono::nanoseconds>(end_t - start_t).count();
+            target_w_ = slo_ ? slo_update(start_t) : controller_.update(tracker_.ema());
+            overhead_ns_sum_ += Clock::now_ns() - start_t;
             overhead_samples_++;
         }
 
         Event<FeatureVector> in_ev;
         if (!input_->try_pop(&in_ev)) {
+            if (port_) port_->arrive();
             if (metrics_) metrics_->events_idle.increment();
             return OpStatus::Idle;
         }
+        if (port_) port_->arrive(in_ev.seq);
 
-        buffer_.push_back(in_ev.data, in_ev.seq);
+        if (cur_->count == 0) first_ts_ = in_ev.timestamp_ns;
+        cur_->push_back(in_ev.data, in_ev.seq);
 
-        if (!buffer_.full(target_w_)) {
+        if (!cur_->full(target_w_)) {
             if (metrics_) metrics_->events_processed.increment();
             return OpStatus::Processed;   // buffered, window not yet ready
         }
 
-        Event<WindowBatch> out_ev;
+        Event<Out> out_ev;
         out_ev.timestamp_ns = in_ev.timestamp_ns;  // last tick's timestamp;
                                                      // InferenceOp overwrites
                                                      // this with the flagged
@@ -149,8 +264,13 @@ public:
                                                      // (Section 7.4, 17.2)
         out_ev.key  = 0;
         out_ev.seq  = in_ev.seq;
-        out_ev.data = buffer_;
-        buffer_ = WindowBatch{};   // reset for next window
+        out_ev.event_ts_ns = in_ev.event_ts_ns;
+        if (slo_ && cur_->count > 1 && in_ev.timestamp_ns > first_ts_) {
+            const double ia = static_cast<double>(in_ev.timestamp_ns - first_ts_) / (cur_->count - 1);
+            interarrival_ns_ = interarrival_ns_ > 0 ? 0.9 * interarrival_ns_ + 0.1 * ia : ia;
+        }
+        out_ev.data = staging_.emit(*cur_);
+        cur_ = nullptr;   // next tick begins a fresh window
 
         if (output_->try_push(out_ev)) {
             if (metrics_) metrics_->events_processed.increment();
@@ -163,17 +283,50 @@ public:
     }
 
 private:
+    std::uint32_t slo_update(std::uint64_t now) {
+        if (!slo_->due(now)) return slo_->current();
+        SloWindowController::Inputs in;
+        in.interarrival_ns = interarrival_ns_;
+        in.servers         = servers_;
+        unsigned fitted = 0;
+        for (const WindowCostModel* c : costs_) {
+            if (!c || c->samples() == 0) continue;
+            in.cost_fixed_ns     += c->fixed_ns();
+            in.cost_per_point_ns += c->per_point_ns();
+            ++fitted;
+        }
+        if (fitted > 1) {
+            in.cost_fixed_ns     /= fitted;
+            in.cost_per_point_ns /= fitted;
+        }
+        if (sink_latency_) {
+            HistogramSnapshot now_h = sink_latency_->snapshot();
+            if (last_latency_) in.downstream_p99_ns = now_h.since(*last_latency_).value_at(0.99);
+            last_latency_ = std::move(now_h);
+        }
+        return slo_->update(now, in);
+    }
+
     InQueue*                       input_;
     OutQueue*                      output_;
     AdaptiveWindowController       controller_;
     EMAOccupancyTracker<OutQueue>  tracker_;
-    WindowBatch                    buffer_{};
+    WindowStaging<Out>             staging_{};
+    WindowBatch*                   cur_{nullptr};   // window being filled
     std::uint32_t                  target_w_{0};
-    Event<WindowBatch>             pending_{};
+    Event<Out>                     pending_{};
     bool                            has_pending_{false};
     OperatorMetrics*               metrics_{nullptr};
     std::uint64_t                  overhead_ns_sum_{0};
     std::uint64_t                  overhead_samples_{0};
+    std::unique_ptr<SloWindowController> slo_;
+    const LatencyHistogram*        sink_latency_{nullptr};
+    std::vector<const WindowCostModel*> costs_;
+    unsigned                       servers_{1};
+    std::optional<HistogramSnapshot> last_latency_;
+    std::uint64_t                  first_ts_{0};
+    double                         interarrival_ns_{0.0};
+    CheckpointPort*                port_{nullptr};
 
 public:
     double mean_overhead_ns() const {
@@ -181,4 +334,7 @@ public:
     }
 };
 
+using AdaptiveWindowOp       = BasicAdaptiveWindowOp<WindowBatch>;
+using PooledAdaptiveWindowOp = BasicAdaptiveWindowOp<WindowHandle>;
+
 } // namespace klstream
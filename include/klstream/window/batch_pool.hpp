@@ -0,0 +1,203 @@
+#pragma once
+#include "../core/checkpoint.hpp"
+#include "../core/config.hpp"
+#include "../core/mpmc_queue.hpp"
+#include "../core/page_alloc.hpp"
+#include "types.hpp"
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <stdexcept>
+
+namespace klstream {
+
+// ── WindowHandle ─────────────────────────────────────────────────────────
+// What crosses q_win_inf in pooled mode instead of a ~5 KB WindowBatch:
+// the slab slot holding the points plus the metadata InferenceOp needs
+// without touching the slot itself. 24 bytes — an Event<WindowHandle> fits
+// in one 64-byte line.
+struct WindowHandle {
+    std::uint32_t slot      = 0;
+    std::uint32_t count     = 0;
+    std::uint64_t first_seq = 0;
+    std::uint64_t last_seq  = 0;
+};
+static_assert(std::is_trivially_copyable_v<WindowHandle>);
+
+// ── WindowBatchPool ──────────────────────────────────────────────────────
+//
+// A fixed slab of cache-line-aligned WindowBatch buffers plus a return
+// channel. The window stage fills a slot in place and sends only a
+// WindowHandle downstream; InferenceOp scores the points in place and
+// release()s the slot. Each window's points are written exactly once and
+// read exactly once — no copies into out_ev, pending_, the queue ring or
+// the consumer's local.
+//
+// Threading: exactly one acquiring thread (the window stage) and any number
+// of releasing threads — one per InferenceOp replica when the stage is
+// fanned out (FanOutOperator). The free list is an MPMCQueue running in the
+// opposite direction to the window edge; its one CAS per release is paid
+// once per window, not per point. Its 4-byte indices use the Compact slot
+// layout, four (eight on 128-byte lines) to a cache line.
+//
+// Sizing: every slot can be simultaneously in flight — one being filled,
+// q_win_inf.capacity() - 1 queued, one held as the window op's pending_,
+// and one being scored. Size the pool at least q_win_inf.capacity() + 2
+// or the window stage reports Blocked before the queue is actually full,
+// which would also skew AdaptiveWindowOp's occupancy signal. With a fan-out,
+// add every downstream queue's capacity plus two per hop (pending + in
+// hand) on top.
+class WindowBatchPool {
+public:
+    explicit WindowBatchPool(std::size_t n_slots)
+        : n_slots_(n_slots)
+        , slots_(static_cast<Slot*>(PageAllocator::instance().allocate(n_slots * sizeof(Slot), alignof(Slot))))
+        , free_(free_list_capacity(n_slots))
+    {
+        for (std::size_t i = 0; i < n_slots_; ++i) new (&slots_[i]) Slot;
+        assert(n_slots >= 1 && n_slots <= UINT32_MAX);
+        // Runs before Runtime::start(), so the thread start publishes these.
+        for (std::size_t i = 0; i < n_slots_; ++i) {
+            bool ok = free_.try_push(static_cast<std::uint32_t>(i));
+            assert(ok);
+            (void)ok;
+        }
+    }
+
+    ~WindowBatchPool() {
+        PageAllocator::instance().deallocate(slots_, n_slots_ * sizeof(Slot), alignof(Slot));
+    }
+
+    WindowBatchPool(const WindowBatchPool&)            = delete;
+    WindowBatchPool& operator=(const WindowBatchPool&) = delete;
+
+    // ── Window-stage side ────────────────────────────────────────────────
+    // Pops a free slot and clears it (count/seq only — the 5 KB point array
+    // is not zeroed). Returns false when every slot is in flight.
+    [[nodiscard]] bool try_acquire(std::uint32_t* slot) noexcept {
+        if (!free_.try_pop(slot)) return false;
+        WindowBatch& b = slots_[*slot].batch;
+        b.count = 0;
+        b.first_seq = b.last_seq = 0;
+        return true;
+    }
+
+    // ── Inference side ───────────────────────────────────────────────────
+    void release(std::uint32_t slot) noexcept {
+        bool ok = free_.try_push(slot);   // can never be full, see ctor
+        assert(ok && "WindowBatchPool: slot released twice");
+        (void)ok;
+    }
+
+    WindowBatch&       at(std::uint32_t slot) noexcept       { return slots_[slot].batch; }
+    const WindowBatch& at(std::uint32_t slot) const noexcept { return slots_[slot].batch; }
+
+    std::size_t size() const noexcept { return n_slots_; }
+
+private:
+    struct alignas(CACHE_LINE_SIZE) Slot {
+        WindowBatch batch;
+    };
+
+    // Power of two that holds all n slot indices.
+    static std::size_t free_list_capacity(std::size_t n) {
+        std::size_t cap = 2;
+        while (cap < n + 1) cap <<= 1;
+        return cap;
+    }
+
+    std::size_t              n_slots_;
+    Slot*                    slots_;   // PageAllocator, default_memory_policy()
+    MPMCQueue<std::uint32_t, MPMCSlotLayout::Compact> free_;
+};
+
+// ── WindowStaging<Out> ───────────────────────────────────────────────────
+//
+// How a window operator obtains the buffer it fills and what it emits once
+// the window closes. Lets AdaptiveWindowOp / DataDrivenWindowOp run either
+// on the original by-value WindowBatch edge or on a pooled WindowHandle edge
+// with the same fill logic.
+template <typename Out>
+struct WindowStaging;
+
+// By value: fill a member buffer, copy it into the event on close.
+template <>
+struct WindowStaging<WindowBatch> {
+    WindowBatch local{};
+
+    bool begin(WindowBatch*& cur) noexcept {
+        local.count = 0;
+        local.first_seq = local.last_seq = 0;
+        cur = &local;
+        return true;
+    }
+    WindowBatch emit(const WindowBatch& b) const noexcept { return b; }
+};
+
+// Pooled: fill a slab slot in place, emit only its handle.
+template <>
+struct WindowStaging<WindowHandle> {
+    WindowBatchPool* pool = nullptr;
+    std::uint32_t    slot = 0;
+
+    bool begin(WindowBatch*& cur) noexcept {
+        assert(pool && "pooled window op used without attach_pool()");
+        if (!pool->try_acquire(&slot)) return false;
+        cur = &pool->at(slot);
+        return true;
+    }
+    WindowHandle emit(const WindowBatch& b) const noexcept {
+        return WindowHandle{ slot, b.count, b.first_seq, b.last_seq };
+    }
+};
+
+// The window being filled, for a window op's checkpoint: its points and
+// seqs, nothing once it has been handed on. restore_partial_window() takes
+// a fresh buffer from `staging` (the pool must be attached) and refills it.
+inline void save_partial_window(StateWriter& out, const WindowBatch* cur) {
+    const std::uint32_t count = cur ? cur->count : 0;
+    out.put(count);
+    if (count == 0) return;
+    out.put(cur->first_seq);
+    out.put(cur->last_seq);
+    out.put_bytes(cur->points.data(), count * sizeof(FeatureVector));
+}
+
+template <typename Out>
+void restore_partial_window(StateReader& in, WindowStaging<Out>& staging, WindowBatch*& cur) {
+    const auto count = in.get<std::uint32_t>();
+    if (count == 0) return;
+    if (count > MAX_WINDOW_SIZE) throw std::runtime_error("checkpoint window larger than MAX_WINDOW_SIZE");
+    if (!cur && !staging.begin(cur)) throw std::logic_error("restore: no free window buffer");
+    cur->count     = count;
+    cur->first_seq = in.get<std::uint64_t>();
+    cur->last_seq  = in.get<std::uint64_t>();
+    in.get_bytes(cur->points.data(), count * sizeof(FeatureVector));
+}
+
+// ── WindowView<In> ───────────────────────────────────────────────────────
+// The consumer-side counterpart: how InferenceOp reaches the points for an
+// incoming event, and what it does once it has finished with them.
+template <typename In>
+struct WindowView;
+
+template <>
+struct WindowView<WindowBatch> {
+    const WindowBatch& get(const WindowBatch& wb) const noexcept { return wb; }
+    void done(const WindowBatch&) const noexcept {}
+};
+
+template <>
+struct WindowView<WindowHandle> {
+    WindowBatchPool* pool = nullptr;
+
+    const WindowBatch& get(const WindowHandle& h) const noexcept {
+        assert(pool && "pooled InferenceOp used without attach_pool()");
+        return pool->at(h.slot);
+    }
+    void done(const WindowHandle& h) const noexcept { pool->release(h.slot); }
+};
+
+} // namespace klstream
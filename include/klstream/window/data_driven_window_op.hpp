@@ -1,20 +1,28 @@
 #pragma once
 #include "../core/operator.hpp"
+#include "../core/clock.hpp"
 #include "../core/event.hpp"
 #include "../core/spsc_queue.hpp"
 #include "../core/metrics.hpp"
 #include "types.hpp"
+#include "batch_pool.hpp"
 #include <algorithm>
+#include <chrono>
 #include <cstdint>
+#include <type_traits>
 
 namespace klstream {
 
-class DataDrivenWindowOp : public IOperator {
+// Out selects the window→inference edge exactly as for BasicAdaptiveWindowOp:
+// WindowBatch by value, or WindowHandle into a WindowBatchPool. Checkpoints
+// (Checkpointer::add) keep the partial window and the volatility reading.
+template <typename Out>
+class BasicDataDrivenWindowOp : public IOperator {
 public:
     using InQueue  = SPSCQueue<Event<FeatureVector>>;
-    using OutQueue = SPSCQueue<Event<WindowBatch>>;
+    using OutQueue = SPSCQueue<Event<Out>>;
 
-    DataDrivenWindowOp(std::string name, InQueue* input, OutQueue* output,
+    BasicDataDrivenWindowOp(std::string name, InQueue* input, OutQueue* output,
                        std::uint32_t w_min = 16, std::uint32_t w_max = MAX_WINDOW_SIZE,
                        float vol_low = 8.98e-09f, float vol_high = 1.52e-08f)
         : IOperator(std::move(name))
@@ -26,6 +34,34 @@ public:
 
     void attach_metrics(OperatorMetrics* m) override { metrics_ = m; }
 
+    // Pooled variant only: the slab the windows are filled into.
+    void attach_pool(WindowBatchPool* pool) {
+        static_assert(std::is_same_v<Out, WindowHandle>,
+                      "attach_pool() is only meaningful for PooledDataDrivenWindowOp");
+        staging_.pool = pool;
+    }
+
+    bool ready() const noexcept override { return has_pending_ || !input_->empty(); }
+    void wake_on_input(Parker* p) override { input_->set_waker(p); }
+
+    bool attach_checkpoint(CheckpointPort* port) override {
+        port_ = port;
+        return true;
+    }
+
+    void snapshot(StateWriter& out) const override {
+        out.put(target_w_);
+        out.put(last_vol_);
+        save_partial_window(out, cur_);
+    }
+
+    // Before the runtime starts; after attach_pool() for the pooled variant.
+    void restore(StateReader& in) override {
+        target_w_ = in.get<std::uint32_t>();
+        last_vol_ = in.get<float>();
+        restore_partial_window(in, staging_, cur_);
+    }
+
     OpStatus tick() override {
         if (has_pending_) {
             if (output_->try_push(pending_)) {
@@ -37,8 +73,13 @@ public:
             return OpStatus::Blocked;
         }
 
-        if (buffer_.count == 0) {
-            auto start_t = std::chrono::steady_clock::now();
+        if (!cur_ && !staging_.begin(cur_)) {
+            if (metrics_) metrics_->events_blocked.increment();
+            return OpStatus::Blocked;
+        }
+
+        if (cur_->count == 0) {
+            const std::uint64_t start_t = Clock::now_ns();
             // Linear interpolation between w_max (calm) and w_min (volatile),
             // clamped — the literature-baseline analogue of Section 14's
             // EMA-occupancy read, but driven by the FeatureVector's own
@@ -47,29 +88,32 @@ public:
             float frac = std::clamp((vol - vol_low_) / (vol_high_ - vol_low_), 0.0f, 1.0f);
             target_w_ = static_cast<std::uint32_t>(
                 w_max_ - frac * static_cast<float>(w_max_ - w_min_));
-            auto end_t = std::chrono::steady_clock::now();
-            overhead_ns_sum_ += std::chrono::duration_cast<std::chrono::nanoseconds>(end_t - start_t).count();
+            overhead_ns_sum_ += Clock::now_ns() - start_t;
             overhead_samples_++;
         }
 
         Event<FeatureVector> in_ev;
         if (!input_->try_pop(&in_ev)) {
+            if (port_) port_->arrive();
             if (metrics_) metrics_->events_idle.increment();
             return OpStatus::Idle;
         }
+        if (port_) port_->arrive(in_ev.seq);
         last_vol_ = in_ev.data.rolling_vol;
-        buffer_.push_back(in_ev.data, in_ev.seq);
+        cur_->push_back(in_ev.data, in_ev.seq);
 
-        if (!buffer_.full(target_w_)) {
+        if (!cur_->full(target_w_)) {
             if (metrics_) metrics_->events_processed.increment();
             return OpStatus::Processed;
         }
 
-        Event<WindowBatch> out_ev;
+        Event<Out> out_ev;
         out_ev.timestamp_ns = in_ev.timestamp_ns;
+        out_ev.key  = 0;
         out_ev.seq  = in_ev.seq;
-        out_ev.data = buffer_;
-        buffer_ = WindowBatch{};
+        out_ev.event_ts_ns = in_ev.event_ts_ns;
+        out_ev.data = staging_.emit(*cur_);
+        cur_ = nullptr;
 
         if (output_->try_push(out_ev)) {
             if (metrics_) metrics_->events_processed.increment();
@@ -88,12 +132,14 @@ private:
     float          vol_low_, vol_high_;
     std::uint32_t  target_w_;
     float          last_vol_{0.0f};
-    WindowBatch    buffer_{};
-    Event<WindowBatch> pending_{};
+    WindowStaging<Out> staging_{};
+    WindowBatch*   cur_{nullptr};
+    Event<Out>     pending_{};
     bool           has_pending_{false};
     OperatorMetrics* metrics_{nullptr};
     std::uint64_t  overhead_ns_sum_{0};
     std::uint64_t  overhead_samples_{0};
+    CheckpointPort* port_{nullptr};
 
 public:
     double mean_overhead_ns() const {
@@ -101,4 +147,7 @@ public:
     }
 };
 
+using DataDrivenWindowOp       = BasicDataDrivenWindowOp<WindowBatch>;
+using PooledDataDrivenWindowOp = BasicDataDrivenWindowOp<WindowHandle>;
+
 } // namespace klstream
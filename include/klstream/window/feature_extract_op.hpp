@@ -0,0 +1,207 @@
+#pragma once
+#include "../core/operator.hpp"
+#include "../core/batch.hpp"
+#include "../core/event.hpp"
+#include "../core/spsc_queue.hpp"
+#include "../core/metrics.hpp"
+#include "types.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace klstream {
+
+// ── FeatureExtractor ─────────────────────────────────────────────────────
+//
+// The online counterpart of preprocessing/preprocess_lobster.py: turns raw
+// BookTop updates into FeatureVectors with O(1) state per tick, so a live
+// feed needs no offline step. Per tick:
+//
+//   mid             = (ask_px + bid_px) / 2
+//   log_return      = log(mid) − log(previous mid)      0 on the first tick
+//   rolling_vol     see below
+//   order_imbalance = (bid_sz − ask_sz) / max(1, bid_sz + ask_sz)
+//   spread_bps      = 1e4 × (ask_px − bid_px) / mid
+//   volume          = log1p(bid_sz + ask_sz)
+//
+// rolling_vol has two modes:
+//   ema(beta)        beta × r² + (1 − beta) × previous — exactly the offline
+//                    feature (beta 0.05), so trained forests and the
+//                    DataDrivenWindowOp thresholds carry over unchanged
+//   rolling(window)  population variance of the last `window` returns,
+//                    by Welford add/remove over a ring buffer
+//
+// extract() over a batch runs in two passes: the per-tick features, which
+// depend only on their own tick, in one branch-free loop the compiler can
+// vectorize (the log calls too, through glibc's libmvec, once
+// -fno-math-errno allows it); then the return/volatility recurrence, the
+// only serial part. A batch gives the same results as the same ticks one
+// at a time.
+class FeatureExtractor {
+public:
+    static constexpr double DEFAULT_EMA_BETA = 0.05;   // preprocess_lobster.py
+
+    explicit FeatureExtractor(double ema_beta = DEFAULT_EMA_BETA) : beta_(ema_beta) {
+        if (!(ema_beta > 0.0 && ema_beta <= 1.0))
+            throw std::invalid_argument("FeatureExtractor: ema_beta must be in (0, 1]");
+    }
+
+    static FeatureExtractor rolling(std::size_t window) {
+        if (window < 2) throw std::invalid_argument("FeatureExtractor: rolling window must be >= 2");
+        FeatureExtractor fx;
+        fx.ring_.assign(window, 0.0);
+        return fx;
+    }
+
+    bool is_rolling() const noexcept { return !ring_.empty(); }
+
+    FeatureVector extract(const BookTop& t) {
+        FeatureVector f;
+        extract(&t, 1, &f);
+        return f;
+    }
+
+    void extract(const BookTop* in, std::size_t n, FeatureVector* out) {
+        if (n == 0) return;
+        if (log_mid_.size() < n) log_mid_.resize(n);
+        double* lm = log_mid_.data();
+
+        for (std::size_t i = 0; i < n; ++i) {
+            const double bid = in[i].bid_px, ask = in[i].ask_px;
+            const double bsz = in[i].bid_sz, asz = in[i].ask_sz;
+            const double mid = 0.5 * (ask + bid);
+            const double depth = bsz + asz;
+            lm[i] = std::log(mid);
+            out[i].spread_bps      = static_cast<float>(1e4 * (ask - bid) / mid);
+            out[i].order_imbalance = static_cast<float>((bsz - asz) / std::max(1.0, depth));
+            out[i].volume          = static_cast<float>(std::log1p(depth));
+        }
+
+        for (std::size_t i = 0; i < n; ++i) {
+            const double r = seen_ ? lm[i] - prev_log_mid_ : 0.0;
+            seen_ = true;
+            prev_log_mid_ = lm[i];
+            out[i].log_return  = static_cast<float>(r);
+            out[i].rolling_vol = static_cast<float>(is_rolling() ? push_rolling(r) : push_ema(r));
+        }
+        ticks_ += n;
+    }
+
+    // Forget all history, as at the start of a new trading day.
+    void reset() noexcept {
+        seen_ = false;
+        prev_log_mid_ = 0.0;
+        ema_ = 0.0;
+        head_ = count_ = 0;
+        mean_ = m2_ = 0.0;
+        ticks_ = 0;
+    }
+
+    std::uint64_t ticks() const noexcept { return ticks_; }
+
+private:
+    double push_ema(double r) noexcept {
+        ema_ = beta_ * r * r + (1.0 - beta_) * ema_;   // seeded at 0, as offline
+        return ema_;
+    }
+
+    double push_rolling(double r) noexcept {
+        const std::size_t cap = ring_.size();
+        if (count_ < cap) {
+            ++count_;
+            const double d = r - mean_;
+            mean_ += d / static_cast<double>(count_);
+            m2_   += d * (r - mean_);
+        } else {
+            // Replace the oldest: one combined remove + add keeps count fixed.
+            const double old = ring_[head_];
+            const double old_mean = mean_;
+            mean_ += (r - old) / static_cast<double>(cap);
+            m2_   += (r - old) * (r - mean_ + old - old_mean);
+        }
+        ring_[head_] = r;
+        head_ = head_ + 1 == cap ? 0 : head_ + 1;
+        return count_ > 0 ? std::max(0.0, m2_ / static_cast<double>(count_)) : 0.0;
+    }
+
+    double              beta_;
+    bool                seen_{false};
+    double              prev_log_mid_{0.0};
+    double              ema_{0.0};
+    std::vector<double> ring_;          // rolling mode only
+    std::size_t         head_{0}, count_{0};
+    double              mean_{0.0}, m2_{0.0};
+    std::uint64_t       ticks_{0};
+    std::vector<double> log_mid_;       // batch scratch
+};
+
+// ── FeatureExtractOp ─────────────────────────────────────────────────────
+//
+// Event<BookTop> in, Event<FeatureVector> out — placed in front of the
+// window stage in place of FinancialTickSource's precomputed columns. Each
+// output keeps its tick's seq, key and timestamps, so latency is still
+// measured from ingest. Batch mode pops up to n ticks per tick() and
+// extracts them as one batch (the vectorized path).
+class FeatureExtractOp : public IOperator {
+public:
+    using InQueue  = SPSCQueue<Event<BookTop>>;
+    using OutQueue = SPSCQueue<Event<FeatureVector>>;
+
+    FeatureExtractOp(std::string name, InQueue* input, OutQueue* output,
+                     FeatureExtractor extractor = FeatureExtractor{})
+        : IOperator(std::move(name))
+        , input_(input), output_(output), fx_(std::move(extractor))
+    {
+        set_batch_size(1);
+    }
+
+    void attach_metrics(OperatorMetrics* m) override { metrics_ = m; }
+
+    // Must be called before the runtime starts.
+    void set_batch_size(std::size_t n) {
+        batch_size_ = n < 1 ? 1 : n;
+        in_batch_.resize(batch_size_);
+        ticks_.resize(batch_size_);
+        features_.resize(batch_size_);
+        out_batch_.set_capacity(batch_size_);
+    }
+
+    bool ready() const noexcept override { return !out_batch_.empty() || !input_->empty(); }
+    void wake_on_input(Parker* p) override { input_->set_waker(p); }
+
+    OpStatus tick() override {
+        if (!out_batch_.empty()) return flush_pending(out_batch_, *output_, metrics_);
+
+        const std::size_t n = input_->try_pop_n(in_batch_.data(), batch_size_);
+        if (n == 0) {
+            if (metrics_) metrics_->events_idle.increment();
+            return OpStatus::Idle;
+        }
+
+        for (std::size_t i = 0; i < n; ++i) ticks_[i] = in_batch_[i].data;
+        fx_.extract(ticks_.data(), n, features_.data());
+        for (std::size_t i = 0; i < n; ++i) {
+            const Event<BookTop>& e = in_batch_[i];
+            out_batch_.append(Event<FeatureVector>{ e.timestamp_ns, e.key, e.seq, e.event_ts_ns, features_[i] });
+        }
+        return flush_pending(out_batch_, *output_, metrics_);
+    }
+
+    const FeatureExtractor& extractor() const noexcept { return fx_; }
+
+private:
+    InQueue*                          input_;
+    OutQueue*                         output_;
+    FeatureExtractor                  fx_;
+    OperatorMetrics*                  metrics_{nullptr};
+    std::size_t                       batch_size_{1};
+    std::vector<Event<BookTop>>       in_batch_;
+    std::vector<BookTop>              ticks_;
+    std::vector<FeatureVector>        features_;
+    PendingBatch<Event<FeatureVector>> out_batch_;
+};
+
+} // namespace klstream
@@ -1,11 +1,16 @@
 #pragma once
 #include "../core/operator.hpp"
+#include "../core/clock.hpp"
 #include "../core/event.hpp"
 #include "../core/spsc_queue.hpp"
 #include "../core/metrics.hpp"
 #include "../core/backpressure.hpp"
+#include "../core/checkpoint.hpp"
 #include "types.hpp"
+#include "replay_file.hpp"
+#include <algorithm>
 #include <fstream>
+#include <memory>
 #include <sstream>
 #include <stdexcept>
 #include <string>
@@ -15,19 +20,12 @@
 
 namespace klstream {
 
-// One row of the CSV produced by preprocess_lobster.py (Section 11).
-struct TickRow {
-    std::uint64_t seq;
-    std::uint64_t timestamp_ns;
-    float         log_return, rolling_vol, order_imbalance, spread_bps, volume;
-    std::uint8_t  label;          // 0=normal, 1=flash_crash, 2=wash_trade_proxy
-    std::uint8_t  is_burst_period;
-};
-
 // Loads the entire replay CSV into memory once at startup. LOBSTER sample
 // days are at most a few hundred thousand events — comfortably fits in RAM
 // on an 8GB+ machine; no streaming file I/O needed during the actual run,
-// which keeps TickSource's tick() allocation-free and fast.
+// which keeps TickSource's tick() allocation-free and fast. Prefer a
+// ReplayFile (replay_file.hpp) for anything bigger: it skips the parse
+// entirely and maps the day instead of copying it.
 inline std::vector<TickRow> load_replay_csv(const std::string& path) {
     std::ifstream f(path);
     if (!f) throw std::runtime_error("cannot open replay CSV: " + path);
@@ -71,59 +69,145 @@ inline std::vector<TickRow> load_replay_csv(const std::string& path) {
 // low-rate quiet phases" generator from the original adaptive-backpressure
 // research extension (Section 14.1 of the Implementation Guide), now driven
 // by real injected-anomaly placement instead of an artificial timer.
+//
+// The source reads through a ReplayColumns view: either straight out of a
+// mapped ReplayFile (shared, zero-copy), or over columns transposed from
+// load_replay_csv() rows. Either way, the object behind the view is kept
+// alive by owner_.
 enum class ReplayMode { PreserveTiming, MaxRate };
 
+// ── ReplayPacer ───────────────────────────────────────────────────────────
+// The PreserveTiming clock shared by the replay sources. pace(ts) waits
+// until ts (relative to the first timestamp since restart()) is due in
+// scaled wall-clock time; under MaxRate it only records the start.
+class ReplayPacer {
+public:
+    ReplayPacer(ReplayMode mode, double speed_factor)
+        : mode_(mode), speed_factor_(speed_factor) {}
+
+    // The next pace() starts a new timeline (new loop or new replay day).
+    void restart() noexcept { started_ = false; }
+
+    void pace(std::uint64_t timestamp_ns) {
+        if (!started_) {
+            started_    = true;
+            start_real_ = Clock::now_ns();
+            start_log_  = timestamp_ns;
+            return;
+        }
+        if (mode_ != ReplayMode::PreserveTiming) return;
+
+        auto elapsed_log = timestamp_ns - start_log_;
+        auto scaled_log  = static_cast<std::uint64_t>(static_cast<double>(elapsed_log) / speed_factor_);
+        auto target_real = start_real_ + scaled_log;
+
+        auto now = Clock::now_ns();
+        if (target_real > now) {
+            auto sleep_ns = target_real - now;
+            if (sleep_ns > 10'000'000) {
+                // Cap large sleeps (e.g. overnight gaps)
+                sleep_ns    = 10'000'000;
+                start_real_ = now - scaled_log + sleep_ns; // Advance base time
+                target_real = start_real_ + scaled_log;
+            }
+
+            if (sleep_ns > 100'000) {
+                std::this_thread::sleep_for(std::chrono::nanoseconds(sleep_ns - 50'000));
+            }
+            while (Clock::now_ns() < target_real) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+private:
+    ReplayMode    mode_;
+    double        speed_factor_;
+    bool          started_{false};
+    std::uint64_t start_real_{0};
+    std::uint64_t start_log_{0};
+};
+
+// ── ReplayEventClock ──────────────────────────────────────────────────────
+// Event time for replayed rows: the row's own timestamp_ns, shifted when a
+// new timeline (next loop pass, next file) would start at or before the
+// point the previous one reached, so event time never runs backwards and
+// event-time windows see each pass as later data. Independent of
+// ReplayMode: MaxRate and PreserveTiming produce the same event times.
+class ReplayEventClock {
+public:
+    // The next at() starts a new timeline.
+    void restart() noexcept { restarted_ = true; }
+
+    std::uint64_t at(std::uint64_t row_ts) noexcept {
+        if (restarted_) {
+            restarted_ = false;
+            if (seen_ && row_ts + offset_ <= last_) offset_ = last_ + 1 - row_ts;
+        }
+        seen_ = true;
+        last_ = row_ts + offset_;
+        return last_;
+    }
+
+    void snapshot(StateWriter& out) const {
+        out.put(offset_);
+        out.put(last_);
+        out.put(seen_);
+        out.put(restarted_);
+    }
+
+    void restore(StateReader& in) {
+        offset_    = in.get<std::uint64_t>();
+        last_      = in.get<std::uint64_t>();
+        seen_      = in.get<bool>();
+        restarted_ = in.get<bool>();
+    }
+
+private:
+    std::uint64_t offset_{0};
+    std::uint64_t last_{0};
+    bool          seen_{false};
+    bool          restarted_{false};
+};
+
 class FinancialTickSource {
 public:
-    FinancialTickSource(std::vector<TickRow> rows, ReplayMode mode,
+    FinancialTickSource(const std::vector<TickRow>& rows, ReplayMode mode,
+                        double speed_factor = 1.0)
+        : pacer_(mode, speed_factor)
+    {
+        auto owned = std::make_shared<OwnedColumns>(rows);
+        cols_  = owned->view();
+        owner_ = std::move(owned);
+        check_nonempty();
+    }
+
+    FinancialTickSource(std::shared_ptr<const ReplayFile> file, ReplayMode mode,
                         double speed_factor = 1.0)
-        : rows_(std::move(rows)), mode_(mode), speed_factor_(speed_factor)
-    {}
+        : cols_(file->columns()), owner_(std::move(file))
+        , pacer_(mode, speed_factor)
+    {
+        check_nonempty();
+    }
 
     // Generator function passed to SourceOperator<FeatureVector>'s ctor
     // (Section 8.1 of the Implementation Guide) — matches
     // SourceOperator<T>::Generator's exact signature.
     bool operator()(Event<FeatureVector>& out, std::uint64_t /*unused_seq*/) {
-        if (idx_ >= rows_.size()) {
+        if (idx_ >= cols_.n) {
             idx_ = 0;
-            start_real_ = std::chrono::steady_clock::now();
-            start_log_ = rows_[0].timestamp_ns;
-            loop_count_++;
-            base_seq_ += rows_.back().seq + 1;
+            pacer_.restart();
+            clock_.restart();
+            base_seq_ += cols_.seq[cols_.n - 1] + 1;
+            ++passes_;
         }
 
-        const TickRow& r = rows_[idx_];
-
-        if (idx_ == 0 && loop_count_ == 0) {
-            start_real_ = std::chrono::steady_clock::now();
-            start_log_ = r.timestamp_ns;
-        } else if (mode_ == ReplayMode::PreserveTiming) {
-            auto elapsed_log = r.timestamp_ns - start_log_;
-            auto scaled_log = std::chrono::nanoseconds(static_cast<std::int64_t>(elapsed_log / speed_factor_));
-            auto target_real = start_real_ + scaled_log;
-            
-            auto now = std::chrono::steady_clock::now();
-            if (target_real > now) {
-                auto sleep_dur = target_real - now;
-                if (sleep_dur > std::chrono::milliseconds(10)) {
-                    // Cap large sleeps (e.g. overnight gaps)
-                    sleep_dur = std::chrono::milliseconds(10);
-                    start_real_ = now - scaled_log + sleep_dur; // Advance base time
-                    target_real = start_real_ + scaled_log;
-                }
-                
-                if (sleep_dur > std::chrono::microseconds(100)) {
-                    std::this_thread::sleep_for(sleep_dur - std::chrono::microseconds(50));
-                }
-                while (std::chrono::steady_clock::now() < target_real) {
-                    std::this_thread::yield();
-                }
-            }
-        }
+        const TickRow r = cols_.row(idx_);
+        pacer_.pace(r.timestamp_ns);
 
         FeatureVector fv{ r.log_return, r.rolling_vol, r.order_imbalance,
                           r.spread_bps, r.volume };
-        out = Event<FeatureVector>::make(fv, 0, r.seq + base_seq_);
+        out = Event<FeatureVector>::make_at(fv, clock_.at(r.timestamp_ns), symbol_, r.seq + base_seq_);
         ground_truth_label_ = r.label;   // exposed via last_label() for the
                                           // optional online-eval harness
         ++idx_;
@@ -131,18 +215,140 @@ public:
     }
 
     std::uint8_t last_label() const { return ground_truth_label_; }
-    std::size_t  remaining() const { return rows_.size() - idx_; }
+    std::size_t  remaining() const { return cols_.n - idx_; }
+
+    // Replay position, for checkpointing (SourceOperator::
+    // checkpoint_generator): the next row, the pass over the day, and the
+    // event-time clock. restore() needs the same replay; it resumes at the
+    // saved row, and PreserveTiming paces from there as from a new start.
+    void snapshot(StateWriter& out) const {
+        out.put(static_cast<std::uint64_t>(cols_.n));
+        out.put(static_cast<std::uint64_t>(idx_));
+        out.put(base_seq_);
+        out.put(passes_);
+        out.put(ground_truth_label_);
+        clock_.snapshot(out);
+    }
+
+    void restore(StateReader& in) {
+        if (in.get<std::uint64_t>() != cols_.n)
+            throw std::runtime_error("FinancialTickSource: checkpoint is of a different replay");
+        idx_                = static_cast<std::size_t>(in.get<std::uint64_t>());
+        base_seq_           = in.get<std::uint64_t>();
+        passes_             = in.get<std::uint64_t>();
+        ground_truth_label_ = in.get<std::uint8_t>();
+        clock_.restore(in);
+        pacer_.restart();
+    }
+
+    // Event::key of every event emitted (symbol_key()); 0 by default.
+    void set_symbol(std::uint64_t key) noexcept { symbol_ = key; }
+    std::uint64_t symbol() const noexcept { return symbol_; }
+
+    // Where the next event falls in replay order: completed passes over the
+    // day and the row's own timestamp. MultiSymbolTickSource merges on it.
+    std::uint64_t passes() const noexcept { return passes_ + (idx_ >= cols_.n ? 1 : 0); }
+    std::uint64_t next_timestamp_ns() const noexcept { return cols_.timestamp_ns[idx_ >= cols_.n ? 0 : idx_]; }
 
 private:
-    std::vector<TickRow> rows_;
-    ReplayMode            mode_;
-    double                speed_factor_;
+    // Column storage for the vector-of-rows constructor.
+    struct OwnedColumns {
+        explicit OwnedColumns(const std::vector<TickRow>& rows) {
+            for (const auto& r : rows) {
+                seq.push_back(r.seq);
+                timestamp_ns.push_back(r.timestamp_ns);
+                log_return.push_back(r.log_return);
+                rolling_vol.push_back(r.rolling_vol);
+                order_imbalance.push_back(r.order_imbalance);
+                spread_bps.push_back(r.spread_bps);
+                volume.push_back(r.volume);
+                label.push_back(r.label);
+                is_burst_period.push_back(r.is_burst_period);
+            }
+        }
+        ReplayColumns view() const noexcept {
+            return ReplayColumns{ seq.size(), seq.data(), timestamp_ns.data(),
+                                  log_return.data(), rolling_vol.data(),
+                                  order_imbalance.data(), spread_bps.data(),
+                                  volume.data(), label.data(), is_burst_period.data() };
+        }
+        std::vector<std::uint64_t> seq, timestamp_ns;
+        std::vector<float>         log_return, rolling_vol, order_imbalance, spread_bps, volume;
+        std::vector<std::uint8_t>  label, is_burst_period;
+    };
+
+    void check_nonempty() const {
+        if (cols_.n == 0) throw std::runtime_error("FinancialTickSource: empty replay");
+    }
+
+    ReplayColumns         cols_;
+    std::shared_ptr<const void> owner_;
+    ReplayPacer           pacer_;
+    ReplayEventClock      clock_;
     std::size_t           idx_{0};
     std::uint8_t          ground_truth_label_{0};
-    std::chrono::steady_clock::time_point start_real_;
-    std::uint64_t         start_log_{0};
-    std::uint64_t         loop_count_{0};
     std::uint64_t         base_seq_{0};
+    std::uint64_t         passes_{0};
+    std::uint64_t         symbol_{0};
+};
+
+// ── MultiSymbolTickSource ─────────────────────────────────────────────────
+//
+// One replay per symbol, merged into a single stream in timestamp order —
+// the generator for a sharded run (PartitionOperator on Event::key behind
+// it). Each event carries its symbol's key and its own file's seq, so
+// (symbol, seq) identifies a tick and every symbol's seqs stay contiguous
+// for the ground-truth join. A symbol that finishes its day waits for the
+// rest before starting the next pass, so loops do not interleave.
+//
+// The per-symbol sources replay at MaxRate; this one paces the merged
+// stream (PreserveTiming) from the first symbol's timeline on each pass.
+// The next source is picked with a binary heap: O(log symbols) per event.
+class MultiSymbolTickSource {
+public:
+    MultiSymbolTickSource(std::vector<FinancialTickSource> sources, ReplayMode mode,
+                          double speed_factor = 1.0)
+        : sources_(std::move(sources)), pacer_(mode, speed_factor)
+    {
+        if (sources_.empty()) throw std::runtime_error("MultiSymbolTickSource: no symbols");
+        for (std::uint32_t i = 0; i < sources_.size(); ++i) heap_.push_back(i);
+        std::make_heap(heap_.begin(), heap_.end(), later_);
+    }
+
+    MultiSymbolTickSource(const MultiSymbolTickSource&)            = delete;   // later_ points into sources_
+    MultiSymbolTickSource& operator=(const MultiSymbolTickSource&) = delete;
+
+    bool operator()(Event<FeatureVector>& out, std::uint64_t seq) {
+        std::pop_heap(heap_.begin(), heap_.end(), later_);
+        FinancialTickSource& src = sources_[heap_.back()];
+        if (src.passes() != pass_) {
+            pass_ = src.passes();
+            pacer_.restart();
+        }
+        pacer_.pace(src.next_timestamp_ns());
+        const bool ok = src(out, seq);
+        std::push_heap(heap_.begin(), heap_.end(), later_);
+        return ok;
+    }
+
+    std::size_t symbols() const noexcept { return sources_.size(); }
+
+private:
+    struct Later {
+        const std::vector<FinancialTickSource>* s;
+        bool operator()(std::uint32_t a, std::uint32_t b) const noexcept {
+            const auto& x = (*s)[a];
+            const auto& y = (*s)[b];
+            if (x.passes() != y.passes()) return x.passes() > y.passes();
+            return x.next_timestamp_ns() > y.next_timestamp_ns();
+        }
+    };
+
+    std::vector<FinancialTickSource> sources_;
+    std::vector<std::uint32_t>       heap_;
+    Later                            later_{ &sources_ };
+    ReplayPacer                      pacer_;
+    std::uint64_t                    pass_{0};
 };
 
 } // namespace klstream
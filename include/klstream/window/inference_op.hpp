@@ -3,26 +3,95 @@
 #include "../core/event.hpp"
 #include "../core/spsc_queue.hpp"
 #include "../core/metrics.hpp"
+#include "../core/rcu.hpp"
 #include "../model/isolation_forest.hpp"
 #include "types.hpp"
+#include "batch_pool.hpp"
+#include "slo_window_controller.hpp"
+#include "../core/clock.hpp"
+#include <array>
+#include <type_traits>
 
 namespace klstream {
 
-class InferenceOp : public IOperator {
+// In selects the window→inference edge: WindowBatch by value (InferenceOp)
+// or WindowHandle into a WindowBatchPool (PooledInferenceOp). The pooled
+// variant scores the points where the window stage wrote them and returns
+// the slot to the pool before emitting its result.
+//
+// The model is either a fixed `const Forest*` or an RcuCell<Forest> that a
+// control thread may publish a new forest into at any time. In the RCU
+// case each window is scored entirely by the forest current when it was
+// popped. The next window sees the new one, and the old forest is freed by
+// the publisher once this operator has moved past it.
+template <typename In>
+class BasicInferenceOp : public IOperator {
 public:
-    using InQueue  = SPSCQueue<Event<WindowBatch>>;
+    using InQueue  = SPSCQueue<Event<In>>;
     using OutQueue = SPSCQueue<Event<DetectionResult>>;
     using Forest   = IsolationForest<FeatureVector::kDim>;
+    using Models   = RcuCell<Forest>;
 
-    InferenceOp(std::string name, InQueue* input, OutQueue* output,
+    BasicInferenceOp(std::string name, InQueue* input, OutQueue* output,
                const Forest* forest)
         : IOperator(std::move(name))
         , input_(input), output_(output), forest_(forest)
     {}
 
+    // Hot-swappable model: registers this operator as a reader of `models`.
+    BasicInferenceOp(std::string name, InQueue* input, OutQueue* output,
+               Models* models)
+        : IOperator(std::move(name))
+        , input_(input), output_(output), forest_(nullptr)
+        , models_(&models->make_reader())
+    {}
+
     void attach_metrics(OperatorMetrics* m) override { metrics_ = m; }
 
+    // Early-exit scoring: stop walking trees for a point once its partial
+    // path sum proves it cannot change the window's result. With the
+    // default threshold of 0 every DetectionResult is bit-identical to full
+    // scoring. With alert_threshold > 0, `max_score >= alert_threshold` is
+    // still decided exactly. Below-threshold windows may then report an
+    // upper bound (still below the threshold) instead of the exact max, so
+    // offline threshold sweeps are only valid at or above alert_threshold.
+    // See FlatForest::score_max().
+    void set_early_exit(bool on, double alert_threshold = 0.0) {
+        early_exit_      = on;
+        alert_threshold_ = alert_threshold;
+    }
+
+    // Records each window's scoring time into `model` (a SloWindowController
+    // input, see AdaptiveWindowOp::enable_latency_slo()). Two clock reads
+    // per window. Before the runtime starts; one writer per model, so a
+    // model already attached to another server throws std::logic_error.
+    void attach_cost_model(WindowCostModel* model) {
+        if (model) model->claim_writer();
+        cost_ = model;
+    }
+
+    // Tree walks performed / avoided by early exit, since construction.
+    std::uint64_t trees_evaluated() const noexcept { return trees_evaluated_.load(); }
+    std::uint64_t trees_skipped() const noexcept   { return trees_skipped_.load(); }
+
+    // Pooled variant only: must be the same pool the window stage fills.
+    void attach_pool(WindowBatchPool* pool) {
+        static_assert(std::is_same_v<In, WindowHandle>,
+                      "attach_pool() is only meaningful for PooledInferenceOp");
+        view_.pool = pool;
+    }
+
+    bool ready() const noexcept override { return has_pending_ || !input_->empty(); }
+    void wake_on_input(Parker* p) override { input_->set_waker(p); }
+
+    // Parked: holding no Forest*, so let a pending model swap reclaim.
+    void on_park() override { if (models_) models_->quiescent(); }
+
     OpStatus tick() override {
+        // No Forest* survives across ticks, so every tick start is a
+        // quiescent point for the RCU reader.
+        if (models_) models_->quiescent();
+
         if (has_pending_) {
             if (output_->try_push(pending_)) {
                 has_pending_ = false;
@@ -33,20 +102,41 @@ public:
             return OpStatus::Blocked;
         }
 
-        Event<WindowBatch> in_ev;
+        Event<In> in_ev;
         if (!input_->try_pop(&in_ev)) {
             if (metrics_) metrics_->events_idle.increment();
             return OpStatus::Idle;
         }
 
         // ── The O(W log psi) hot loop — Section 7.2's causal mechanism ───
-        const WindowBatch& wb = in_ev.data;
+        const std::uint64_t t0 = cost_ ? Clock::now_ns() : 0;
+        const WindowBatch& wb = view_.get(in_ev.data);
+        const Forest* forest = models_ ? models_->get() : forest_;   // one acquire load
+        // One score_batch() call per window: every tree sees all of the
+        // window's points back to back (see FlatForest).
+        for (std::uint32_t i = 0; i < wb.count; ++i) points_[i] = wb.points[i].to_point();
         double   max_score   = -1.0;
         uint32_t max_idx     = 0;
-        for (std::uint32_t i = 0; i < wb.count; ++i) {
-            double s = forest_->anomaly_score(wb.points[i].to_point());
-            if (s > max_score) { max_score = s; max_idx = i; }
+        const std::uint64_t walks = std::uint64_t{wb.count} * forest->n_trees();
+        if (early_exit_) {
+            const auto r = forest->score_max(points_.data(), wb.count, alert_threshold_,
+                                              scores_.data(), live_.data());
+            max_score = r.score;
+            max_idx   = r.index;
+            trees_skipped_.add(r.trees_skipped);
+            trees_evaluated_.add(walks - r.trees_skipped);
+        } else {
+            forest->score_batch(points_.data(), wb.count, scores_.data());
+            for (std::uint32_t i = 0; i < wb.count; ++i) {
+                if (scores_[i] > max_score) { max_score = scores_[i]; max_idx = i; }
+            }
+            trees_evaluated_.add(walks);
         }
+        if (cost_) cost_->record(wb.count, Clock::now_ns() - t0);
+        const std::uint32_t count     = wb.count;
+        const std::uint64_t first_seq = wb.first_seq;
+        const std::uint64_t last_seq  = wb.last_seq;
+        view_.done(in_ev.data);   // pooled: slot is free again from here on
 
         Event<DetectionResult> out_ev;
         // Re-stamp with the FLAGGED point's own timestamp, not the window's
@@ -65,13 +155,15 @@ public:
         // reported latency is an upper bound, not an exact per-tick figure,
         // which is the safe direction to bias an evaluation.
         out_ev.timestamp_ns = in_ev.timestamp_ns;
+        out_ev.key = in_ev.key;   // symbol, in a sharded run
         out_ev.seq = in_ev.seq;
+        out_ev.event_ts_ns = in_ev.event_ts_ns;
         out_ev.data = DetectionResult{
             max_score,
-            wb.count,
-            wb.first_seq,
-            wb.last_seq,
-            wb.first_seq + max_idx,
+            count,
+            first_seq,
+            last_seq,
+            first_seq + max_idx,
             0.0f   // filled in by the wiring code for the Adaptive variant only
         };
 
@@ -85,13 +177,31 @@ public:
         return OpStatus::Blocked;
     }
 
+    void shutdown() override {
+        if (models_) models_->offline();
+    }
+
 private:
     InQueue*       input_;
     OutQueue*      output_;
     const Forest*  forest_;   // owned by main(), lives for the runtime's lifetime
+    typename Models::Reader* models_{nullptr};   // set instead of forest_ for hot swap
+    WindowView<In> view_{};
+    // Per-window scratch (~9 KB), reused across ticks — L1-resident.
+    std::array<typename Forest::Point, MAX_WINDOW_SIZE> points_{};
+    std::array<double, MAX_WINDOW_SIZE>                 scores_{};
+    std::array<std::uint32_t, MAX_WINDOW_SIZE>          live_{};
+    bool           early_exit_{false};
+    double         alert_threshold_{0.0};
+    LocalCounter   trees_evaluated_;
+    LocalCounter   trees_skipped_;
     Event<DetectionResult> pending_{};
     bool           has_pending_{false};
     OperatorMetrics* metrics_{nullptr};
+    WindowCostModel* cost_{nullptr};
 };
 
+using InferenceOp       = BasicInferenceOp<WindowBatch>;
+using PooledInferenceOp = BasicInferenceOp<WindowHandle>;
+
 } // namespace klstream
@@ -0,0 +1,180 @@
+#pragma once
+#include "../core/operator.hpp"
+#include "../core/event.hpp"
+#include "../core/spsc_queue.hpp"
+#include "../core/metrics.hpp"
+#include "../core/backpressure.hpp"
+#include "../core/keyed_state.hpp"
+#include "types.hpp"
+#include "batch_pool.hpp"
+#include "adaptive_window_op.hpp"   // AdaptiveWindowController
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace klstream {
+
+// ── BasicKeyedAdaptiveWindowOp ───────────────────────────────────────────
+//
+// The window stage of one shard in a multi-symbol run: PartitionOperator
+// routes ticks by Event::key (symbol_key()) to K of these, and each keeps
+// one count window per symbol it owns instead of one operator instance per
+// symbol. Windows never mix symbols; each emitted window carries its
+// symbol as Event::key, which InferenceOp passes through to the sink.
+//
+// Per-symbol state is a KeyedStateStore of 24-byte SymbolWindow headers
+// (fill count, target size, first seq, and an offset into one shared
+// point arena): a thousand symbols' entries take 32 KB, so the lookup per
+// tick stays cache-resident. The arena holds w_max points per symbol,
+// contiguously; on close they are copied once into the output WindowBatch
+// (or pool slot).
+//
+// Sizing is adaptive exactly as in AdaptiveWindowOp, per shard: one
+// AdaptiveWindowController reading this shard's output-queue EMA, consulted
+// at each symbol's window start and held for that window. The queue is
+// what the symbols share, so it is the shard, not the symbol, that backs
+// off. Out selects the edge as for BasicAdaptiveWindowOp.
+template <typename Out>
+class BasicKeyedAdaptiveWindowOp : public IOperator {
+public:
+    using InQueue  = SPSCQueue<Event<FeatureVector>>;
+    using OutQueue = SPSCQueue<Event<Out>>;
+
+    BasicKeyedAdaptiveWindowOp(std::string name, InQueue* input, OutQueue* output,
+                               std::uint32_t w_min = 16, std::uint32_t w_max = MAX_WINDOW_SIZE,
+                               double occ_low = 0.30, double occ_high = 0.70,
+                               double shrink_factor = 0.70, double grow_factor = 1.15,
+                               std::size_t expected_symbols = 64)
+        : IOperator(std::move(name))
+        , input_(input), output_(output)
+        , w_max_(std::min<std::uint32_t>(w_max, MAX_WINDOW_SIZE))
+        , controller_(w_min, w_max_, occ_low, occ_high, shrink_factor, grow_factor)
+        , tracker_(*output)
+        , windows_(expected_symbols)
+    {
+        arena_.reserve(expected_symbols * w_max_);
+    }
+
+    void attach_metrics(OperatorMetrics* m) override { metrics_ = m; }
+    const AdaptiveWindowController& controller() const { return controller_; }
+
+    // Pooled variant only: the slab the closed windows are copied into.
+    void attach_pool(WindowBatchPool* pool) {
+        static_assert(std::is_same_v<Out, WindowHandle>,
+                      "attach_pool() is only meaningful for PooledKeyedAdaptiveWindowOp");
+        staging_.pool = pool;
+    }
+
+    // Symbols seen so far by this shard.
+    std::size_t symbols() const noexcept { return windows_.size(); }
+    std::uint64_t windows_emitted() const noexcept { return emitted_.load(); }
+
+    bool ready() const noexcept override { return has_pending_ || closing_ || !input_->empty(); }
+    void wake_on_input(Parker* p) override { input_->set_waker(p); }
+
+    OpStatus tick() override {
+        if (has_pending_) {
+            if (output_->try_push(pending_)) {
+                has_pending_ = false;
+                if (metrics_) metrics_->events_processed.increment();
+                return OpStatus::Processed;
+            }
+            if (metrics_) metrics_->events_blocked.increment();
+            return OpStatus::Blocked;
+        }
+        if (closing_) return close();
+
+        Event<FeatureVector> in_ev;
+        if (!input_->try_pop(&in_ev)) {
+            if (metrics_) metrics_->events_idle.increment();
+            return OpStatus::Idle;
+        }
+
+        SymbolWindow& w = window_of(in_ev.key);
+        if (w.count == 0) {
+            // Window start for this symbol: size it once, hold it until it closes.
+            tracker_.update();
+            w.target_w  = controller_.update(tracker_.ema());
+            w.first_seq = in_ev.seq;
+        }
+        arena_[w.offset + w.count++] = in_ev.data;
+        if (w.count < w.target_w) {
+            if (metrics_) metrics_->events_processed.increment();
+            return OpStatus::Processed;
+        }
+        last_    = in_ev;
+        closing_ = true;
+        return close();
+    }
+
+private:
+    struct SymbolWindow {
+        std::uint32_t offset   = 0;   // into arena_, in points
+        std::uint32_t count    = 0;
+        std::uint32_t target_w = 0;
+        std::uint64_t first_seq = 0;
+    };
+
+    SymbolWindow& window_of(std::uint64_t key) {
+        if (SymbolWindow* w = windows_.find(key)) return *w;
+        SymbolWindow init;
+        init.offset = static_cast<std::uint32_t>(arena_.size());
+        arena_.resize(arena_.size() + w_max_);
+        return windows_.get_or_insert(key, init);
+    }
+
+    // Copies last_'s symbol window out and emits it. Blocked (retried next
+    // tick) while every pool slot is in flight.
+    OpStatus close() {
+        WindowBatch* cur = nullptr;
+        if (!staging_.begin(cur)) {
+            if (metrics_) metrics_->events_blocked.increment();
+            return OpStatus::Blocked;
+        }
+        SymbolWindow& w = *windows_.find(last_.key);
+        std::copy_n(arena_.data() + w.offset, w.count, cur->points.data());
+        cur->count     = w.count;
+        cur->first_seq = w.first_seq;
+        cur->last_seq  = last_.seq;
+        w.count  = 0;
+        closing_ = false;
+        emitted_.increment();
+
+        Event<Out> out_ev;
+        out_ev.timestamp_ns = last_.timestamp_ns;   // last tick's, as AdaptiveWindowOp
+        out_ev.key          = last_.key;
+        out_ev.seq          = last_.seq;
+        out_ev.event_ts_ns  = last_.event_ts_ns;
+        out_ev.data         = staging_.emit(*cur);
+
+        if (output_->try_push(out_ev)) {
+            if (metrics_) metrics_->events_processed.increment();
+            return OpStatus::Processed;
+        }
+        pending_     = out_ev;
+        has_pending_ = true;
+        if (metrics_) metrics_->events_blocked.increment();
+        return OpStatus::Blocked;
+    }
+
+    InQueue*                       input_;
+    OutQueue*                      output_;
+    std::uint32_t                  w_max_;
+    AdaptiveWindowController       controller_;
+    EMAOccupancyTracker<OutQueue>  tracker_;
+    KeyedStateStore<SymbolWindow>  windows_;
+    std::vector<FeatureVector>     arena_;
+    WindowStaging<Out>             staging_{};
+    Event<FeatureVector>           last_{};       // tick that closed the window being emitted
+    bool                           closing_{false};
+    Event<Out>                     pending_{};
+    bool                           has_pending_{false};
+    LocalCounter                   emitted_;
+    OperatorMetrics*               metrics_{nullptr};
+};
+
+using KeyedAdaptiveWindowOp       = BasicKeyedAdaptiveWindowOp<WindowBatch>;
+using PooledKeyedAdaptiveWindowOp = BasicKeyedAdaptiveWindowOp<WindowHandle>;
+
+} // namespace klstream
@@ -0,0 +1,385 @@
+#pragma once
+#include "../core/operator.hpp"
+#include "../core/clock.hpp"
+#include "../core/event.hpp"
+#include "../core/spsc_queue.hpp"
+#include "../core/metrics.hpp"
+#include "types.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#if defined(__linux__)
+#  include <arpa/inet.h>
+#  include <cerrno>
+#  include <ctime>
+#  include <fcntl.h>
+#  include <linux/net_tstamp.h>
+#  include <netinet/in.h>
+#  include <sys/socket.h>
+#  include <sys/uio.h>
+#  include <unistd.h>
+#  define KLSTREAM_HAS_RECVMMSG 1
+#endif
+
+namespace klstream {
+
+// ── TickWireMessage ──────────────────────────────────────────────────────
+// One top-of-book update as the feed sends it: 48 bytes, little-endian —
+// byte for byte an Event<BookTop> without its leading receive timestamp.
+// That is what lets NetworkTickSource receive straight into queue slots:
+// the socket writes from &slot.key on, and only timestamp_ns is filled in
+// afterwards. A UDP datagram carries exactly one message; a TCP stream is
+// messages back to back.
+struct TickWireMessage {
+    std::uint64_t symbol;        // symbol_key()
+    std::uint64_t seq;           // the feed's sequence number
+    std::uint64_t event_ts_ns;   // exchange / publisher timestamp
+    BookTop       book;
+};
+static_assert(sizeof(TickWireMessage) == 48 && std::is_trivially_copyable_v<TickWireMessage>);
+static_assert(offsetof(Event<BookTop>, key) + sizeof(TickWireMessage) == sizeof(Event<BookTop>) &&
+              offsetof(Event<BookTop>, seq) == offsetof(Event<BookTop>, key) + 8 &&
+              offsetof(Event<BookTop>, event_ts_ns) == offsetof(Event<BookTop>, key) + 16 &&
+              offsetof(Event<BookTop>, data) == offsetof(Event<BookTop>, key) + 24,
+              "Event<BookTop> after timestamp_ns must be TickWireMessage's layout");
+
+enum class FeedTransport : std::uint8_t { Udp, Tcp };
+
+// Where Event::timestamp_ns comes from.
+//   Clock    — Clock::now_ns() once per receive call.
+//   Kernel   — the kernel's receive time per datagram (SO_TIMESTAMPNS).
+//   Hardware — the NIC's (SO_TIMESTAMPING, raw hardware), falling back to
+//              the kernel's per datagram when the NIC gives none. The NIC
+//              must have RX timestamping enabled (SIOCSHWTSTAMP, e.g.
+//              hwstamp_ctl) and its clock synced to CLOCK_REALTIME (phc2sys).
+// Kernel and hardware stamps are CLOCK_REALTIME; they are moved onto the
+// Clock timeline with an offset measured once per receive call. TCP has no
+// per-message stamps and always uses Clock.
+enum class RxTimestamp : std::uint8_t { Clock, Kernel, Hardware };
+
+struct FeedEndpoint {
+    FeedTransport transport = FeedTransport::Udp;
+    std::string   address   = "0.0.0.0";   // UDP: bind address; TCP: feed server to connect to
+    std::uint16_t port      = 0;           // UDP: 0 binds an ephemeral port (see port())
+    std::string   multicast_group;         // UDP: group to join; empty = unicast
+    std::string   interface_addr = "0.0.0.0";   // multicast: local interface address
+    RxTimestamp   timestamps = RxTimestamp::Kernel;
+    int           rcvbuf_bytes = 8 << 20;  // socket receive buffer; 0 = system default
+};
+
+// ── NetworkTickSource ────────────────────────────────────────────────────
+//
+// Source operator for a live feed: receives TickWireMessages from a UDP
+// (unicast or multicast) or TCP socket and emits Event<BookTop> — raw
+// ticks, for FeatureExtractOp and the window stage behind it.
+//
+// Each tick() claims up to `batch` free slots of the output queue
+// (SPSCQueue::claim) and receives into them directly: UDP with one
+// recvmmsg() for the whole batch, one datagram per slot; TCP with one
+// readv() scattering the stream across the slots, a message that arrives
+// split finishing in place on the next call. No intermediate buffer, no
+// per-message syscall; received slots are published in one store. The
+// socket is non-blocking: nothing to read is Idle, a full queue Blocked —
+// the kernel buffer absorbs the difference, and kernel_drops() reports
+// datagrams dropped once it overflowed (SO_RXQ_OVFL).
+//
+// A datagram that is not one whole message is dropped and counted in
+// malformed(). A TCP feed that closes ends the stream: closed() turns
+// true and error() says why.
+//
+// Linux only (recvmmsg, SO_TIMESTAMPNS, SO_TIMESTAMPING); elsewhere the
+// constructor throws std::runtime_error, as it does when the socket cannot
+// be set up. A kernel-bypass receive path (AF_XDP, DPDK) would replace the
+// receive call only: the slot-claim / decode-in-place structure is the same.
+class NetworkTickSource : public IOperator {
+public:
+    using OutQueue = SPSCQueue<Event<BookTop>>;
+
+    static constexpr std::size_t MESSAGE_BYTES = sizeof(TickWireMessage);
+
+    NetworkTickSource(std::string name, OutQueue* output, FeedEndpoint ep, std::size_t batch = 64)
+        : IOperator(std::move(name))
+        , output_(output), ep_(std::move(ep)), batch_(batch < 1 ? 1 : batch)
+    {
+#if defined(KLSTREAM_HAS_RECVMMSG)
+        if (ep_.transport == FeedTransport::Udp) open_udp();
+        else open_tcp();
+        msgs_.resize(batch_);
+        iov_.resize(batch_);
+        control_.resize(batch_ * CONTROL_BYTES);
+#else
+        throw std::runtime_error("NetworkTickSource: needs Linux (recvmmsg)");
+#endif
+    }
+
+    NetworkTickSource(const NetworkTickSource&)            = delete;
+    NetworkTickSource& operator=(const NetworkTickSource&) = delete;
+
+    ~NetworkTickSource() override {
+#if defined(KLSTREAM_HAS_RECVMMSG)
+        if (fd_ >= 0) ::close(fd_);
+#endif
+    }
+
+    void attach_metrics(OperatorMetrics* m) override { metrics_ = m; }
+
+    OpStatus tick() override {
+        if (closed_) {
+            if (metrics_) metrics_->events_idle.increment();
+            return OpStatus::Idle;
+        }
+        std::size_t room = 0;
+        Event<BookTop>* slots = output_->claim(batch_, &room);
+        if (room == 0) {
+            if (metrics_) metrics_->events_blocked.increment();
+            return OpStatus::Blocked;
+        }
+        const std::size_t got = ep_.transport == FeedTransport::Udp ? receive_udp(slots, room)
+                                                                    : receive_tcp(slots, room);
+        if (got == 0) {
+            if (metrics_) metrics_->events_idle.increment();
+            return OpStatus::Idle;
+        }
+        output_->publish(got);
+        received_.add(got);
+        if (metrics_) metrics_->events_processed.add(got);
+        return OpStatus::Processed;
+    }
+
+    // The bound UDP port (useful with port 0) or the connected TCP port.
+    std::uint16_t port() const noexcept { return port_; }
+
+    std::uint64_t received() const noexcept { return received_.load(); }
+    std::uint64_t malformed() const noexcept { return malformed_.load(); }
+    // Datagrams the kernel dropped for want of buffer space, as of the last
+    // receive that reported it.
+    std::uint64_t kernel_drops() const noexcept { return kernel_drops_.load(std::memory_order_relaxed); }
+    bool          closed() const noexcept { return closed_; }
+
+    std::string error() const {
+        std::lock_guard<std::mutex> lk(error_mu_);
+        return error_;
+    }
+
+private:
+    static constexpr std::size_t TAIL_OFFSET = offsetof(Event<BookTop>, key);
+
+    static char* tail(Event<BookTop>& e) noexcept { return reinterpret_cast<char*>(&e) + TAIL_OFFSET; }
+
+    // The wire is little-endian; so are the hosts this runs on, except here.
+    static void from_wire_order(Event<BookTop>& e) noexcept {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        auto swap64 = [](auto& v) {
+            std::uint64_t u;
+            std::memcpy(&u, &v, 8);
+            u = __builtin_bswap64(u);
+            std::memcpy(&v, &u, 8);
+        };
+        swap64(e.key); swap64(e.seq); swap64(e.event_ts_ns);
+        swap64(e.data.bid_px); swap64(e.data.ask_px);
+        e.data.bid_sz = __builtin_bswap32(e.data.bid_sz);
+        e.data.ask_sz = __builtin_bswap32(e.data.ask_sz);
+#else
+        (void)e;
+#endif
+    }
+
+    void fail(const std::string& what) {
+        std::lock_guard<std::mutex> lk(error_mu_);
+        error_ = what;
+    }
+
+#if defined(KLSTREAM_HAS_RECVMMSG)
+    static constexpr std::size_t CONTROL_BYTES = 256;   // room for a timestamp and a drop-count cmsg
+
+    [[noreturn]] void setup_failed(const std::string& what) {
+        const std::string why = what + ": " + std::strerror(errno);
+        if (fd_ >= 0) ::close(fd_);
+        fd_ = -1;
+        throw std::runtime_error("NetworkTickSource: " + why);
+    }
+
+    in_addr parse_addr(const std::string& a) {
+        in_addr out{};
+        if (::inet_pton(AF_INET, a.c_str(), &out) != 1) {
+            errno = EINVAL;
+            setup_failed("bad IPv4 address " + a);
+        }
+        return out;
+    }
+
+    void open_udp() {
+        fd_ = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+        if (fd_ < 0) setup_failed("socket()");
+        int one = 1;
+        ::setsockopt(fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if (ep_.rcvbuf_bytes > 0) ::setsockopt(fd_, SOL_SOCKET, SO_RCVBUF, &ep_.rcvbuf_bytes, sizeof(int));
+        ::setsockopt(fd_, SOL_SOCKET, SO_RXQ_OVFL, &one, sizeof(one));
+        if (ep_.timestamps == RxTimestamp::Kernel) {
+            if (::setsockopt(fd_, SOL_SOCKET, SO_TIMESTAMPNS, &one, sizeof(one)) != 0) setup_failed("SO_TIMESTAMPNS");
+        } else if (ep_.timestamps == RxTimestamp::Hardware) {
+            const int flags = SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE |
+                              SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+            if (::setsockopt(fd_, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)) != 0) setup_failed("SO_TIMESTAMPING");
+        }
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port   = htons(ep_.port);
+        addr.sin_addr   = parse_addr(ep_.multicast_group.empty() ? ep_.address : ep_.multicast_group);
+        if (::bind(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) setup_failed("bind()");
+        if (!ep_.multicast_group.empty()) {
+            ip_mreq m{};
+            m.imr_multiaddr = addr.sin_addr;
+            m.imr_interface = parse_addr(ep_.interface_addr);
+            if (::setsockopt(fd_, IPPROTO_IP, IP_ADD_MEMBERSHIP, &m, sizeof(m)) != 0) setup_failed("IP_ADD_MEMBERSHIP");
+        }
+        socklen_t len = sizeof(addr);
+        ::getsockname(fd_, reinterpret_cast<sockaddr*>(&addr), &len);
+        port_ = ntohs(addr.sin_port);
+    }
+
+    void open_tcp() {
+        fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (fd_ < 0) setup_failed("socket()");
+        if (ep_.rcvbuf_bytes > 0) ::setsockopt(fd_, SOL_SOCKET, SO_RCVBUF, &ep_.rcvbuf_bytes, sizeof(int));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port   = htons(ep_.port);
+        addr.sin_addr   = parse_addr(ep_.address);
+        if (::connect(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0)
+            setup_failed("connect() to " + ep_.address + ":" + std::to_string(ep_.port));
+        if (::fcntl(fd_, F_SETFL, ::fcntl(fd_, F_GETFL) | O_NONBLOCK) != 0) setup_failed("O_NONBLOCK");
+        port_ = ep_.port;
+    }
+
+    // CLOCK_REALTIME minus the Clock timeline, for moving socket stamps over.
+    static std::int64_t realtime_offset() noexcept {
+        timespec ts;
+        ::clock_gettime(CLOCK_REALTIME, &ts);
+        const std::uint64_t now = Clock::now_ns();
+        return static_cast<std::int64_t>(static_cast<std::uint64_t>(ts.tv_sec) * 1'000'000'000ULL +
+                                         static_cast<std::uint64_t>(ts.tv_nsec) - now);
+    }
+
+    static std::uint64_t ns_of(const timespec& t) noexcept {
+        return static_cast<std::uint64_t>(t.tv_sec) * 1'000'000'000ULL + static_cast<std::uint64_t>(t.tv_nsec);
+    }
+
+    // The datagram's receive time on the CLOCK_REALTIME timeline, or 0.
+    std::uint64_t socket_stamp(msghdr& h) noexcept {
+        std::uint64_t stamp = 0;
+        for (cmsghdr* c = CMSG_FIRSTHDR(&h); c; c = CMSG_NXTHDR(&h, c)) {
+            if (c->cmsg_level != SOL_SOCKET) continue;
+            if (c->cmsg_type == SCM_TIMESTAMPNS) {
+                timespec t;
+                std::memcpy(&t, CMSG_DATA(c), sizeof(t));
+                stamp = ns_of(t);
+            } else if (c->cmsg_type == SCM_TIMESTAMPING) {
+                timespec t[3];   // software, (deprecated), raw hardware
+                std::memcpy(t, CMSG_DATA(c), sizeof(t));
+                stamp = ns_of(t[2]) ? ns_of(t[2]) : ns_of(t[0]);
+            } else if (c->cmsg_type == SO_RXQ_OVFL) {
+                std::uint32_t drops;
+                std::memcpy(&drops, CMSG_DATA(c), sizeof(drops));
+                kernel_drops_.store(drops, std::memory_order_relaxed);
+            }
+        }
+        return stamp;
+    }
+
+    std::size_t receive_udp(Event<BookTop>* slots, std::size_t room) {
+        for (std::size_t i = 0; i < room; ++i) {
+            iov_[i] = iovec{ tail(slots[i]), MESSAGE_BYTES };
+            msghdr& h = msgs_[i].msg_hdr;
+            h = msghdr{};
+            h.msg_iov        = &iov_[i];
+            h.msg_iovlen     = 1;
+            h.msg_control    = control_.data() + i * CONTROL_BYTES;
+            h.msg_controllen = CONTROL_BYTES;
+        }
+        const int n = ::recvmmsg(fd_, msgs_.data(), static_cast<unsigned>(room), MSG_DONTWAIT, nullptr);
+        if (n <= 0) {
+            if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                fail(std::string("recvmmsg: ") + std::strerror(errno));
+            return 0;
+        }
+
+        const std::uint64_t now = Clock::now_ns();
+        const std::int64_t offset = ep_.timestamps == RxTimestamp::Clock ? 0 : realtime_offset();
+        std::size_t good = 0;
+        for (int i = 0; i < n; ++i) {
+            msghdr& h = msgs_[i].msg_hdr;
+            const std::uint64_t stamp = socket_stamp(h);
+            if (msgs_[i].msg_len != MESSAGE_BYTES || (h.msg_flags & MSG_TRUNC)) {
+                malformed_.increment();
+                continue;
+            }
+            // Compact over a dropped datagram; the common case copies nothing.
+            if (good != static_cast<std::size_t>(i)) std::memcpy(tail(slots[good]), tail(slots[i]), MESSAGE_BYTES);
+            Event<BookTop>& e = slots[good++];
+            from_wire_order(e);
+            const std::int64_t local = static_cast<std::int64_t>(stamp) - offset;
+            e.timestamp_ns = stamp && local > 0 && static_cast<std::uint64_t>(local) <= now
+                           ? static_cast<std::uint64_t>(local) : now;
+        }
+        return good;
+    }
+
+    std::size_t receive_tcp(Event<BookTop>* slots, std::size_t room) {
+        // The first slot may already hold the start of a message.
+        iov_[0] = iovec{ tail(slots[0]) + partial_, MESSAGE_BYTES - partial_ };
+        for (std::size_t i = 1; i < room; ++i) iov_[i] = iovec{ tail(slots[i]), MESSAGE_BYTES };
+        const ssize_t r = ::readv(fd_, iov_.data(), static_cast<int>(room));
+        if (r <= 0) {
+            if (r == 0) {
+                closed_ = true;
+                fail("feed closed the connection");
+            } else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                closed_ = true;
+                fail(std::string("readv: ") + std::strerror(errno));
+            }
+            return 0;
+        }
+        const std::size_t bytes = partial_ + static_cast<std::size_t>(r);
+        const std::size_t whole = bytes / MESSAGE_BYTES;
+        // An unfinished message is left in slots[whole]: unpublished, it is
+        // the first slot the next claim() returns, and readv() resumes it.
+        partial_ = bytes % MESSAGE_BYTES;
+        if (whole == 0) return 0;
+        const std::uint64_t now = Clock::now_ns();
+        for (std::size_t i = 0; i < whole; ++i) {
+            from_wire_order(slots[i]);
+            slots[i].timestamp_ns = now;
+        }
+        return whole;
+    }
+
+    std::vector<mmsghdr> msgs_;
+    std::vector<iovec>   iov_;
+    std::vector<char>    control_;
+#endif
+
+    OutQueue*          output_;
+    FeedEndpoint       ep_;
+    std::size_t        batch_;
+    int                fd_{-1};
+    std::uint16_t      port_{0};
+    std::size_t        partial_{0};   // TCP: bytes of the next message already received
+    bool               closed_{false};
+    LocalCounter       received_;
+    LocalCounter       malformed_;
+    std::atomic<std::uint64_t> kernel_drops_{0};
+    OperatorMetrics*   metrics_{nullptr};
+    mutable std::mutex error_mu_;
+    std::string        error_;
+};
+
+} // namespace klstream
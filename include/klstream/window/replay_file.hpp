@@ -0,0 +1,256 @@
+#pragma once
+#include "../core/mapped_file.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace klstream {
+
+// One row of the CSV produced by preprocess_lobster.py (Section 11).
+struct TickRow {
+    std::uint64_t seq;
+    std::uint64_t timestamp_ns;
+    float         log_return, rolling_vol, order_imbalance, spread_bps, volume;
+    std::uint8_t  label;          // 0=normal, 1=flash_crash, 2=wash_trade_proxy
+    std::uint8_t  is_burst_period;
+};
+
+// ── ReplayColumns ────────────────────────────────────────────────────────
+// A replay day as parallel column arrays — what FinancialTickSource reads
+// from, whether the columns live in a mapped ReplayFile or were transposed
+// from load_replay_csv() rows.
+struct ReplayColumns {
+    std::size_t          n               = 0;
+    const std::uint64_t* seq             = nullptr;
+    const std::uint64_t* timestamp_ns    = nullptr;
+    const float*         log_return      = nullptr;
+    const float*         rolling_vol     = nullptr;
+    const float*         order_imbalance = nullptr;
+    const float*         spread_bps      = nullptr;
+    const float*         volume          = nullptr;
+    const std::uint8_t*  label           = nullptr;
+    const std::uint8_t*  is_burst_period = nullptr;
+
+    TickRow row(std::size_t i) const noexcept {
+        return TickRow{ seq[i], timestamp_ns[i], log_return[i], rolling_vol[i],
+                        order_imbalance[i], spread_bps[i], volume[i],
+                        label[i], is_burst_period[i] };
+    }
+};
+
+// ── ReplayFileHeader ─────────────────────────────────────────────────────
+//
+// The binary columnar replay format written by
+// preprocess_lobster.py --binary-out (and by write_replay_file()): this
+// 256-byte header, then one array per Section, each starting on an ALIGN
+// boundary, little-endian, no padding inside a column:
+//
+//   SEQ, TIMESTAMP       u64[n_rows]
+//   LOG_RETURN..VOLUME   f32[n_rows]   (the five FeatureVector inputs)
+//   LABEL, IS_BURST      u8[n_rows]
+//   INDEX                u64[n_index]  first row with timestamp_ns >=
+//                                      index_base_ns + k * index_stride_ns
+//
+// mid_price is deliberately not stored — nothing downstream reads it.
+// index_stride_ns == 0 means no index (n_index == 0). Keep the Python
+// writer in preprocessing/preprocess_lobster.py in step with layout_for().
+struct ReplayFileHeader {
+    static constexpr char          MAGIC[8]   = { 'K', 'L', 'S', 'R', 'P', 'L', 'Y', '\0' };
+    static constexpr std::uint32_t VERSION    = 1;
+    static constexpr std::uint32_t ENDIAN_TAG = 0x01020304;
+    static constexpr std::size_t   ALIGN      = 128;
+
+    enum Section : std::size_t {
+        SEQ, TIMESTAMP, LOG_RETURN, ROLLING_VOL, ORDER_IMBALANCE, SPREAD_BPS, VOLUME,
+        LABEL, IS_BURST, INDEX,
+        SECTIONS
+    };
+
+    char          magic[8];
+    std::uint32_t version;
+    std::uint32_t endian_tag;
+    std::uint64_t n_rows;
+    std::uint64_t index_stride_ns;
+    std::uint64_t index_base_ns;
+    std::uint64_t n_index;
+    std::uint64_t file_size;
+    std::uint64_t offset[SECTIONS];
+    std::uint64_t reserved[15];
+
+    // Bytes per row in each column section (INDEX is per bucket, not row).
+    static constexpr std::uint64_t ROW_BYTES[SECTIONS] = { 8, 8, 4, 4, 4, 4, 4, 1, 1, 0 };
+
+    struct Layout {
+        std::uint64_t offset[SECTIONS];
+        std::uint64_t total;
+    };
+    static Layout layout_for(std::uint64_t n_rows, std::uint64_t n_index) noexcept {
+        Layout l{};
+        std::uint64_t at = sizeof(ReplayFileHeader);
+        for (std::size_t k = 0; k < SECTIONS; ++k) {
+            const std::uint64_t bytes = k == INDEX ? 8 * n_index : ROW_BYTES[k] * n_rows;
+            l.offset[k] = at;
+            at = (at + bytes + ALIGN - 1) / ALIGN * ALIGN;
+        }
+        l.total = at;
+        return l;
+    }
+};
+static_assert(sizeof(ReplayFileHeader) == 256);
+static_assert(std::is_trivially_copyable_v<ReplayFileHeader>);
+
+// ── ReplayFile ───────────────────────────────────────────────────────────
+//
+// A replay day mapped read-only: opening it costs one mmap and a header
+// check, not a parse, and concurrent experiment runs over the same day share
+// one copy in the page cache. columns() points straight into the mapping.
+//
+// Throws std::runtime_error on a missing, truncated or inconsistent file.
+// Only the header and the (small) index are validated eagerly — the
+// columns themselves are never touched until a row is read.
+class ReplayFile {
+public:
+    explicit ReplayFile(const std::string& path) : file_(path) {
+        auto fail = [&](const char* why) {
+            throw std::runtime_error("ReplayFile: " + path + ": " + why);
+        };
+        if (file_.size() < sizeof(ReplayFileHeader)) fail("shorter than a header");
+        std::memcpy(&hdr_, file_.data(), sizeof(hdr_));
+        if (std::memcmp(hdr_.magic, ReplayFileHeader::MAGIC, sizeof(hdr_.magic)) != 0) fail("bad magic");
+        if (hdr_.version != ReplayFileHeader::VERSION) fail("unsupported version");
+        if (hdr_.endian_tag != ReplayFileHeader::ENDIAN_TAG) fail("written with another byte order");
+        if (hdr_.n_rows == 0) fail("no rows");
+        if ((hdr_.index_stride_ns == 0) != (hdr_.n_index == 0)) fail("inconsistent index");
+        const auto l = ReplayFileHeader::layout_for(hdr_.n_rows, hdr_.n_index);
+        if (hdr_.file_size != l.total || hdr_.file_size != file_.size()) fail("size does not match header");
+        for (std::size_t k = 0; k < ReplayFileHeader::SECTIONS; ++k) {
+            if (hdr_.offset[k] != l.offset[k]) fail("section table does not match counts");
+        }
+
+        auto at = [&](std::size_t sec) { return file_.data() + l.offset[sec]; };
+        cols_.n               = static_cast<std::size_t>(hdr_.n_rows);
+        cols_.seq             = reinterpret_cast<const std::uint64_t*>(at(ReplayFileHeader::SEQ));
+        cols_.timestamp_ns    = reinterpret_cast<const std::uint64_t*>(at(ReplayFileHeader::TIMESTAMP));
+        cols_.log_return      = reinterpret_cast<const float*>(at(ReplayFileHeader::LOG_RETURN));
+        cols_.rolling_vol     = reinterpret_cast<const float*>(at(ReplayFileHeader::ROLLING_VOL));
+        cols_.order_imbalance = reinterpret_cast<const float*>(at(ReplayFileHeader::ORDER_IMBALANCE));
+        cols_.spread_bps      = reinterpret_cast<const float*>(at(ReplayFileHeader::SPREAD_BPS));
+        cols_.volume          = reinterpret_cast<const float*>(at(ReplayFileHeader::VOLUME));
+        cols_.label           = reinterpret_cast<const std::uint8_t*>(at(ReplayFileHeader::LABEL));
+        cols_.is_burst_period = reinterpret_cast<const std::uint8_t*>(at(ReplayFileHeader::IS_BURST));
+        index_                = reinterpret_cast<const std::uint64_t*>(at(ReplayFileHeader::INDEX));
+
+        for (std::uint64_t k = 0; k < hdr_.n_index; ++k) {
+            if (index_[k] > hdr_.n_rows || (k > 0 && index_[k] < index_[k - 1])) fail("bad time index");
+        }
+    }
+
+    // Passes an access hint for rows [begin, end) of every column to the
+    // mapping (MappedFile::advise). StreamingReplaySource uses it to read
+    // ahead of, and release pages behind, its cursor.
+    void advise_rows(std::size_t begin, std::size_t end, MappedFile::Advice a) const noexcept {
+        end = std::min(end, cols_.n);
+        if (begin >= end) return;
+        for (std::size_t k = 0; k < ReplayFileHeader::INDEX; ++k) {
+            const std::uint64_t w = ReplayFileHeader::ROW_BYTES[k];
+            file_.advise(static_cast<std::size_t>(hdr_.offset[k] + begin * w),
+                         static_cast<std::size_t>((end - begin) * w), a);
+        }
+    }
+
+    const ReplayColumns& columns() const noexcept { return cols_; }
+    std::size_t          size() const noexcept    { return cols_.n; }
+    bool                 has_index() const noexcept { return hdr_.n_index != 0; }
+
+    // First row with timestamp_ns >= ts (size() if none): one index lookup
+    // plus a scan within one stride when indexed, else a binary search.
+    std::size_t seek_time(std::uint64_t ts) const noexcept {
+        const std::uint64_t* t = cols_.timestamp_ns;
+        if (!has_index()) return static_cast<std::size_t>(std::lower_bound(t, t + cols_.n, ts) - t);
+        if (ts <= hdr_.index_base_ns) return 0;
+        const std::uint64_t k = std::min((ts - hdr_.index_base_ns) / hdr_.index_stride_ns,
+                                         hdr_.n_index - 1);
+        std::size_t i = static_cast<std::size_t>(index_[k]);
+        while (i < cols_.n && t[i] < ts) ++i;
+        return i;
+    }
+
+private:
+    MappedFile           file_;
+    ReplayFileHeader     hdr_{};
+    ReplayColumns        cols_{};
+    const std::uint64_t* index_ = nullptr;
+};
+
+// Is `path` a ReplayFile (rather than a replay CSV)? Checks the magic only.
+inline bool is_replay_file(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    char magic[sizeof(ReplayFileHeader::MAGIC)] = {};
+    return in.read(magic, sizeof(magic)) &&
+           std::memcmp(magic, ReplayFileHeader::MAGIC, sizeof(magic)) == 0;
+}
+
+// Writes rows in the ReplayFile format. Rows must be in timestamp order.
+// index_stride_ns == 0 omits the time index.
+inline void write_replay_file(const std::vector<TickRow>& rows, const std::string& path,
+                              std::uint64_t index_stride_ns = 1'000'000'000ULL) {
+    if (rows.empty()) throw std::runtime_error("write_replay_file: no rows");
+    const std::uint64_t n    = rows.size();
+    const std::uint64_t base = rows.front().timestamp_ns;
+    const std::uint64_t n_index = index_stride_ns
+        ? (rows.back().timestamp_ns - base) / index_stride_ns + 1 : 0;
+    const auto l = ReplayFileHeader::layout_for(n, n_index);
+
+    std::vector<char> buf(static_cast<std::size_t>(l.total), 0);
+    ReplayFileHeader h{};
+    std::memcpy(h.magic, ReplayFileHeader::MAGIC, sizeof(h.magic));
+    h.version         = ReplayFileHeader::VERSION;
+    h.endian_tag      = ReplayFileHeader::ENDIAN_TAG;
+    h.n_rows          = n;
+    h.index_stride_ns = index_stride_ns;
+    h.index_base_ns   = n_index ? base : 0;
+    h.n_index         = n_index;
+    h.file_size       = l.total;
+    for (std::size_t k = 0; k < ReplayFileHeader::SECTIONS; ++k) h.offset[k] = l.offset[k];
+    std::memcpy(buf.data(), &h, sizeof(h));
+
+    auto col = [&](std::size_t sec, auto member) {
+        using V = std::remove_reference_t<decltype(rows[0].*member)>;
+        char* dst = buf.data() + l.offset[sec];
+        for (std::size_t i = 0; i < rows.size(); ++i) {
+            const V v = rows[i].*member;
+            std::memcpy(dst + i * sizeof(V), &v, sizeof(V));
+        }
+    };
+    col(ReplayFileHeader::SEQ,             &TickRow::seq);
+    col(ReplayFileHeader::TIMESTAMP,       &TickRow::timestamp_ns);
+    col(ReplayFileHeader::LOG_RETURN,      &TickRow::log_return);
+    col(ReplayFileHeader::ROLLING_VOL,     &TickRow::rolling_vol);
+    col(ReplayFileHeader::ORDER_IMBALANCE, &TickRow::order_imbalance);
+    col(ReplayFileHeader::SPREAD_BPS,      &TickRow::spread_bps);
+    col(ReplayFileHeader::VOLUME,          &TickRow::volume);
+    col(ReplayFileHeader::LABEL,           &TickRow::label);
+    col(ReplayFileHeader::IS_BURST,        &TickRow::is_burst_period);
+
+    char* idx = buf.data() + l.offset[ReplayFileHeader::INDEX];
+    std::uint64_t row = 0;
+    for (std::uint64_t k = 0; k < n_index; ++k) {
+        const std::uint64_t edge = base + k * index_stride_ns;
+        while (row < n && rows[row].timestamp_ns < edge) ++row;
+        std::memcpy(idx + k * 8, &row, 8);
+    }
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out) throw std::runtime_error("write_replay_file: cannot open " + path);
+    out.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+    if (!out) throw std::runtime_error("write_replay_file: short write to " + path);
+}
+
+} // namespace klstream
@@ -0,0 +1,265 @@
+#pragma once
+#include "../core/clock.hpp"
+#include "../core/event.hpp"
+#include "../core/metrics.hpp"
+#include "../core/spsc_queue.hpp"
+#include "types.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace klstream {
+
+// ── ResultRecord ─────────────────────────────────────────────────────────
+// One ResultSink CSV row as a fixed-size binary record: what
+// BinaryResultSink appends per DetectionResult. Field for field the CSV
+// columns, so write_result_csv_row() reproduces ResultSink's output exactly.
+struct ResultRecord {
+    std::uint64_t seq;
+    std::uint64_t detect_timestamp_ns;
+    std::uint64_t latency_ns;
+    double        max_score;
+    std::uint64_t first_seq;
+    std::uint64_t last_seq;
+    std::uint64_t flagged_seq;
+    std::uint64_t symbol;                 // Event::key (symbol_key()), 0 = none
+    std::uint32_t window_size_used;
+    float         occupancy_at_decision;
+};
+static_assert(sizeof(ResultRecord) == 72 && std::is_trivially_copyable_v<ResultRecord>);
+
+inline ResultRecord make_result_record(const Event<DetectionResult>& ev, std::uint64_t latency_ns) noexcept {
+    const DetectionResult& r = ev.data;
+    return ResultRecord{ ev.seq, ev.timestamp_ns, latency_ns, r.max_score, r.first_seq, r.last_seq,
+                         r.flagged_seq, ev.key, r.window_size_used, r.occupancy_at_decision };
+}
+
+// The results CSV: header and one row per record, as ResultSink writes them.
+inline void write_result_csv_header(std::ostream& out) {
+    out << "seq,detect_timestamp_ns,latency_ns,max_score,window_size_used,"
+           "first_seq,last_seq,flagged_seq,occupancy_at_decision,symbol\n";
+}
+
+inline void write_result_csv_row(std::ostream& out, const ResultRecord& r) {
+    out << r.seq << ','
+        << r.detect_timestamp_ns << ','
+        << r.latency_ns << ','
+        << std::setprecision(8) << r.max_score << ','
+        << r.window_size_used << ','
+        << r.first_seq << ','
+        << r.last_seq << ','
+        << r.flagged_seq << ','
+        << r.occupancy_at_decision << ','
+        << symbol_name(r.symbol) << '\n';
+}
+
+// ── ResultLogHeader ──────────────────────────────────────────────────────
+// A result log is this header followed by ResultRecords back to back, in
+// the writer's byte order; the record count is implied by the file size.
+struct ResultLogHeader {
+    static constexpr char          MAGIC[8]   = { 'K', 'L', 'S', 'R', 'S', 'L', 'T', '\0' };
+    static constexpr std::uint32_t VERSION    = 1;
+    static constexpr std::uint32_t ENDIAN_TAG = 0x01020304;
+
+    char          magic[8];
+    std::uint32_t version;
+    std::uint32_t endian_tag;
+    std::uint32_t record_size;
+    std::uint32_t reserved;
+};
+static_assert(sizeof(ResultLogHeader) == 24);
+
+// ── ResultLogWriter ──────────────────────────────────────────────────────
+//
+// Takes file I/O off the sink's thread. The sink append()s records into
+// one of `blocks` memory blocks of `block_bytes`; a full block goes to a
+// dedicated writer thread over an SPSC queue and comes back over a second
+// one once written, as StreamingReplaySource's ring runs in the other
+// direction. The sink's side is a memcpy into the block, plus a queue push
+// per block; the writer issues one large sequential write per block.
+//
+// Storage slower than the pipeline fills the ring: append() then returns
+// false (counted in stalls()) and the caller decides — BinaryResultSink
+// reports Blocked, so a slow disk backpressures like a slow consumer
+// instead of dropping results. Two blocks (double buffering) suffice while
+// the disk keeps up on average; more absorb longer write stalls.
+//
+// A partly filled block is handed over by flush_if_stale() once it is
+// older than `max_delay_ns` (so a quiet stream still reaches the disk) and
+// by close(). The append side — append(), flush_if_stale(), close() — is
+// one thread at a time: the sink, then whoever closes after it stopped.
+class ResultLogWriter {
+public:
+    static constexpr std::size_t   DEFAULT_BLOCK_BYTES  = 1 << 20;
+    static constexpr std::size_t   DEFAULT_BLOCKS       = 2;
+    static constexpr std::uint64_t DEFAULT_MAX_DELAY_NS = 100'000'000;   // 100 ms
+
+    explicit ResultLogWriter(const std::string& path,
+                             std::size_t block_bytes = DEFAULT_BLOCK_BYTES,
+                             std::size_t blocks = DEFAULT_BLOCKS,
+                             std::uint64_t max_delay_ns = DEFAULT_MAX_DELAY_NS)
+        : records_per_block_(block_bytes / sizeof(ResultRecord) < 1 ? 1 : block_bytes / sizeof(ResultRecord))
+        , max_delay_ns_(max_delay_ns)
+        , ring_(blocks < 2 ? 2 : blocks)
+        , full_(queue_capacity(ring_.size()))
+        , free_(queue_capacity(ring_.size()))
+        , out_(path, std::ios::binary | std::ios::trunc)
+    {
+        if (!out_) throw std::runtime_error("ResultLogWriter: cannot open " + path);
+        ResultLogHeader h{};
+        std::memcpy(h.magic, ResultLogHeader::MAGIC, sizeof(h.magic));
+        h.version     = ResultLogHeader::VERSION;
+        h.endian_tag  = ResultLogHeader::ENDIAN_TAG;
+        h.record_size = sizeof(ResultRecord);
+        out_.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        for (std::uint32_t s = 0; s < ring_.size(); ++s) {
+            ring_[s].records.reset(new ResultRecord[records_per_block_]);
+            free_.push(s);
+        }
+        writer_ = std::thread([this] { write_loop(); });
+    }
+
+    ~ResultLogWriter() { close(); }
+
+    ResultLogWriter(const ResultLogWriter&)            = delete;
+    ResultLogWriter& operator=(const ResultLogWriter&) = delete;
+
+    // False if every block is waiting on the disk; nothing was appended.
+    bool append(const ResultRecord& r) noexcept {
+        if (cur_ == NONE) {
+            if (!free_.try_pop(&cur_)) {
+                cur_ = NONE;
+                stalls_.increment();
+                return false;
+            }
+            ring_[cur_].n = 0;
+            block_start_ns_ = Clock::coarse_ns();
+        }
+        Block& b = ring_[cur_];
+        b.records[b.n++] = r;
+        appended_.increment();
+        if (b.n == records_per_block_) hand_over();
+        return true;
+    }
+
+    // Hands the current block to the writer if it is older than max_delay_ns.
+    void flush_if_stale(std::uint64_t now_ns) noexcept {
+        if (cur_ != NONE && ring_[cur_].n > 0 && now_ns - block_start_ns_ >= max_delay_ns_) hand_over();
+    }
+
+    // Writes out everything appended and joins the writer. Idempotent.
+    void close() {
+        if (closed_) return;
+        closed_ = true;
+        if (cur_ != NONE && ring_[cur_].n > 0) hand_over();
+        full_.push(END);
+        if (writer_.joinable()) writer_.join();
+        out_.flush();
+    }
+
+    std::uint64_t appended() const noexcept { return appended_.load(); }
+    std::uint64_t written() const noexcept { return written_.load(); }
+    // append() calls refused because no block was free.
+    std::uint64_t stalls() const noexcept { return stalls_.load(); }
+    std::uint64_t blocks_written() const noexcept { return blocks_written_.load(); }
+
+    std::string error() const {
+        std::lock_guard<std::mutex> lk(error_mu_);
+        return error_;
+    }
+
+private:
+    struct Block {
+        std::unique_ptr<ResultRecord[]> records;
+        std::size_t                     n = 0;
+    };
+
+    static constexpr std::uint32_t NONE = UINT32_MAX;
+    static constexpr std::uint32_t END  = UINT32_MAX - 1;   // close() on full_
+
+    static std::size_t queue_capacity(std::size_t slots) {
+        std::size_t c = 1;
+        while (c < slots + 2) c <<= 1;
+        return c;
+    }
+
+    void hand_over() noexcept {
+        full_.push(cur_);   // never waits: full_ holds every slot
+        cur_ = NONE;
+    }
+
+    void write_loop() {
+        for (;;) {
+            std::uint32_t s;
+            while (!full_.try_pop(&s)) std::this_thread::sleep_for(std::chrono::microseconds(50));
+            if (s == END) return;
+            Block& b = ring_[s];
+            if (out_) {
+                out_.write(reinterpret_cast<const char*>(b.records.get()),
+                           static_cast<std::streamsize>(b.n * sizeof(ResultRecord)));
+                out_.flush();   // a block handed over is in the kernel's hands once written()
+                if (out_) {
+                    written_.add(b.n);
+                    blocks_written_.increment();
+                } else {
+                    std::lock_guard<std::mutex> lk(error_mu_);
+                    error_ = "ResultLogWriter: write failed";
+                }
+            }
+            free_.push(s);
+        }
+    }
+
+    const std::size_t        records_per_block_;
+    const std::uint64_t      max_delay_ns_;
+    std::vector<Block>       ring_;
+    SPSCQueue<std::uint32_t> full_;   // sink -> writer
+    SPSCQueue<std::uint32_t> free_;   // writer -> sink
+
+    // Append side.
+    std::uint32_t cur_{NONE};
+    std::uint64_t block_start_ns_{0};
+    bool          closed_{false};
+    LocalCounter  appended_;
+    LocalCounter  stalls_;
+
+    // Writer side.
+    std::ofstream      out_;
+    LocalCounter       written_;
+    LocalCounter       blocks_written_;
+    mutable std::mutex error_mu_;
+    std::string        error_;
+    std::thread        writer_;
+};
+
+// Reads a whole result log back, validating the header. A torn final
+// record (the writer died mid-block) is dropped.
+inline std::vector<ResultRecord> read_result_log(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) throw std::runtime_error("read_result_log: cannot open " + path);
+    ResultLogHeader h{};
+    if (!in.read(reinterpret_cast<char*>(&h), sizeof(h)) ||
+        std::memcmp(h.magic, ResultLogHeader::MAGIC, sizeof(h.magic)) != 0)
+        throw std::runtime_error("read_result_log: " + path + ": bad magic");
+    if (h.version != ResultLogHeader::VERSION) throw std::runtime_error("read_result_log: unsupported version");
+    if (h.endian_tag != ResultLogHeader::ENDIAN_TAG) throw std::runtime_error("read_result_log: written with another byte order");
+    if (h.record_size != sizeof(ResultRecord)) throw std::runtime_error("read_result_log: record size mismatch");
+
+    std::vector<ResultRecord> records;
+    ResultRecord r;
+    while (in.read(reinterpret_cast<char*>(&r), sizeof(r))) records.push_back(r);
+    return records;
+}
+
+} // namespace klstream
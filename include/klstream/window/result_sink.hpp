@@ -3,9 +3,14 @@
 #include "../core/event.hpp"
 #include "../core/spsc_queue.hpp"
 #include "../core/metrics.hpp"
+#include "../core/histogram.hpp"
 #include "types.hpp"
+#include "result_log.hpp"
+#include <algorithm>
 #include <fstream>
-#include <iomanip>
+#include <memory>
+#include <thread>
+#include <vector>
 
 namespace klstream {
 
@@ -13,7 +18,9 @@ namespace klstream {
 // injection_log.csv (Section 9.3) offline in Python (Section 23/25's
 // analysis notebook) — this operator does NOT compute F1/PATR/WOR/LBA
 // itself; it only records ground truth needed to compute them later,
-// keeping the hot C++ path free of any evaluation-metric logic.
+// keeping the hot C++ path free of any evaluation-metric logic. In a
+// sharded run seqs are per symbol, so the join key is (symbol, seq); the
+// symbol column is empty for single-symbol runs.
 class ResultSink : public IOperator {
 public:
     using InQueue = SPSCQueue<Event<DetectionResult>>;
@@ -23,11 +30,16 @@ public:
         , input_(input)
         , out_(out_csv_path)
     {
-        out_ << "seq,detect_timestamp_ns,latency_ns,max_score,window_size_used,"
-                "first_seq,last_seq,flagged_seq,occupancy_at_decision\n";
+        write_result_csv_header(out_);
     }
 
     void attach_metrics(OperatorMetrics* m) override { metrics_ = m; }
+    // Also records every result's latency_ns() — the sink-side feedback
+    // for AdaptiveWindowOp::enable_latency_slo().
+    void attach_latency(LatencyHistogram* h) { latency_ = h; }
+
+    bool ready() const noexcept override { return !input_->empty(); }
+    void wake_on_input(Parker* p) override { input_->set_waker(p); }
 
     OpStatus tick() override {
         Event<DetectionResult> ev;
@@ -35,16 +47,9 @@ public:
             if (metrics_) metrics_->events_idle.increment();
             return OpStatus::Idle;
         }
-        const auto& r = ev.data;
-        out_ << ev.seq << ','
-             << ev.timestamp_ns << ','
-             << ev.latency_ns() << ','
-             << std::setprecision(8) << r.max_score << ','
-             << r.window_size_used << ','
-             << r.first_seq << ','
-             << r.last_seq << ','
-             << r.flagged_seq << ','
-             << r.occupancy_at_decision << '\n';
+        const std::uint64_t latency = ev.latency_ns();
+        write_result_csv_row(out_, make_result_record(ev, latency));
+        if (latency_) latency_->record(latency);
         if (metrics_) metrics_->events_processed.increment();
         return OpStatus::Processed;
     }
@@ -55,6 +60,94 @@ private:
     InQueue*      input_;
     std::ofstream out_;
     OperatorMetrics* metrics_{nullptr};
+    LatencyHistogram* latency_{nullptr};
+};
+
+// ── BinaryResultSink ─────────────────────────────────────────────────────
+//
+// ResultSink without the formatting and the stream I/O on the sink's
+// worker: each DetectionResult becomes a 72-byte ResultRecord appended to
+// a ResultLogWriter, whose own thread does the writes. Convert the log to
+// the same CSV offline with results_to_csv (adaptive_window/).
+//
+// Batch mode pops up to n results per tick(). A full ring (storage behind)
+// leaves the rest of the batch held and reports Blocked until a block
+// comes back. When idle, the sink hands a stale partial block to the writer;
+// shutdown() appends a held remainder before the log is closed.
+class BinaryResultSink : public IOperator {
+public:
+    using InQueue = SPSCQueue<Event<DetectionResult>>;
+
+    BinaryResultSink(std::string name, InQueue* input, const std::string& out_path,
+                     std::size_t block_bytes = ResultLogWriter::DEFAULT_BLOCK_BYTES,
+                     std::size_t blocks = ResultLogWriter::DEFAULT_BLOCKS)
+        : IOperator(std::move(name))
+        , input_(input)
+        , log_(std::make_unique<ResultLogWriter>(out_path, block_bytes, blocks))
+    {
+        set_batch_size(1);
+    }
+
+    void attach_metrics(OperatorMetrics* m) override { metrics_ = m; }
+    // As ResultSink::attach_latency().
+    void attach_latency(LatencyHistogram* h) { latency_ = h; }
+
+    // Must be called before the runtime starts.
+    void set_batch_size(std::size_t n) {
+        batch_size_ = n < 1 ? 1 : n;
+        batch_.resize(batch_size_);
+    }
+
+    bool ready() const noexcept override { return pos_ < n_ || !input_->empty(); }
+    void wake_on_input(Parker* p) override { input_->set_waker(p); }
+
+    OpStatus tick() override {
+        if (pos_ == n_) {
+            n_   = input_->try_pop_n(batch_.data(), batch_size_);
+            pos_ = 0;
+            if (n_ == 0) {
+                log_->flush_if_stale(Clock::coarse_ns());
+                if (metrics_) metrics_->events_idle.increment();
+                return OpStatus::Idle;
+            }
+        }
+        const std::size_t start = pos_;
+        for (; pos_ < n_; ++pos_) {
+            const std::uint64_t latency = batch_[pos_].latency_ns();
+            if (!log_->append(make_result_record(batch_[pos_], latency))) break;
+            if (latency_) latency_->record(latency);
+        }
+        if (metrics_ && pos_ > start) metrics_->events_processed.add(pos_ - start);
+        if (pos_ < n_) {
+            if (metrics_) metrics_->events_blocked.increment();
+            return pos_ > start ? OpStatus::Processed : OpStatus::Blocked;
+        }
+        return OpStatus::Processed;
+    }
+
+    // Appends what is left of a held batch, waiting for the writer to free
+    // a block if it must, then writes everything out.
+    void shutdown() override {
+        const std::size_t start = pos_;
+        for (; pos_ < n_; ++pos_) {
+            const std::uint64_t latency = batch_[pos_].latency_ns();
+            while (!log_->append(make_result_record(batch_[pos_], latency))) std::this_thread::yield();
+            if (latency_) latency_->record(latency);
+        }
+        if (metrics_ && pos_ > start) metrics_->events_processed.add(pos_ - start);
+        log_->close();
+    }
+
+    const ResultLogWriter& log() const noexcept { return *log_; }
+
+private:
+    InQueue*                            input_;
+    std::unique_ptr<ResultLogWriter>    log_;
+    std::vector<Event<DetectionResult>> batch_;
+    std::size_t                         batch_size_{1};
+    std::size_t                         n_{0}, pos_{0};
+    OperatorMetrics*                    metrics_{nullptr};
+    LatencyHistogram*                   latency_{nullptr};
 };
 
 } // namespace klstream
@@ -0,0 +1,212 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+
+namespace klstream {
+
+// ── WindowCostModel ──────────────────────────────────────────────────────
+//
+// Measured cost of scoring one window, fitted as fixed + per_point × W by
+// exponentially weighted least squares over (W, ns) samples. InferenceOp
+// records one sample per window (attach_cost_model()); SloWindowController
+// reads the fit from the window stage's thread. With several inference
+// servers, each records into its own model and the window stage averages
+// their fits (AdaptiveWindowOp::enable_latency_slo()).
+//
+// With only one window size seen there is no slope to fit, and the whole
+// cost is attributed per point (fixed = 0) — the pessimistic side for a
+// controller deciding whether a larger window still fits.
+//
+// Single writer (record()); readers on any thread see the latest fit.
+// claim_writer() enforces it for the operators that record into a model.
+class WindowCostModel {
+public:
+    explicit WindowCostModel(double alpha = 0.05) : alpha_(alpha) {}
+
+    // Registers the one operator that will call record(); throws
+    // std::logic_error if another already has. Before the runtime starts.
+    void claim_writer() {
+        if (has_writer_) throw std::logic_error("WindowCostModel: already has a writer (one model per inference server)");
+        has_writer_ = true;
+    }
+
+    void record(std::uint32_t points, std::uint64_t ns) noexcept {
+        const double w = points, t = static_cast<double>(ns);
+        const double a = n_ == 0 ? 1.0 : alpha_;
+        mw_  += a * (w - mw_);
+        mt_  += a * (t - mt_);
+        mww_ += a * (w * w - mww_);
+        mwt_ += a * (w * t - mwt_);
+        ++n_;
+
+        double per_point = mw_ > 0 ? mt_ / mw_ : 0.0, fixed = 0.0;
+        const double var = mww_ - mw_ * mw_;
+        if (var > 1.0) {   // window sizes spread over more than ~1 point
+            const double b = (mwt_ - mw_ * mt_) / var;
+            const double f = mt_ - b * mw_;
+            if (b > 0 && f >= 0) { per_point = b; fixed = f; }
+        }
+        fixed_ns_.store(fixed, std::memory_order_relaxed);
+        per_point_ns_.store(per_point, std::memory_order_relaxed);
+        samples_.store(n_, std::memory_order_relaxed);
+    }
+
+    double fixed_ns() const noexcept     { return fixed_ns_.load(std::memory_order_relaxed); }
+    double per_point_ns() const noexcept { return per_point_ns_.load(std::memory_order_relaxed); }
+    std::uint64_t samples() const noexcept { return samples_.load(std::memory_order_relaxed); }
+    double predict_ns(std::uint32_t w) const noexcept { return fixed_ns() + per_point_ns() * w; }
+
+private:
+    double alpha_;
+    double mw_{0}, mt_{0}, mww_{0}, mwt_{0};   // writer-only running moments
+    std::uint64_t n_{0};
+    bool          has_writer_{false};
+    std::atomic<double>        fixed_ns_{0.0};
+    std::atomic<double>        per_point_ns_{0.0};
+    std::atomic<std::uint64_t> samples_{0};
+};
+
+// ── SloWindowController ──────────────────────────────────────────────────
+//
+// Picks the largest window whose predicted p99 end-to-end latency meets a
+// configured SLO — the alternative to AdaptiveWindowController's occupancy
+// proxy with fixed multipliers. Pure logic, like that controller: the
+// operator hands it measurements, it hands back a window size.
+//
+// Model, for window size W (all in ns):
+//   fill(W)    = 0.99 × (W − 1) × interarrival   a tick's wait for the rest
+//                                                 of its window, at p99
+//   cost(W)    = fixed + per_point × W           WindowCostModel
+//   predict(W) = fill(W) + ratio × cost(W)
+// `ratio` is the measured downstream p99 (sink-side latency, which starts
+// at the window's last tick) over cost(current W), smoothed — the queueing
+// and sink overhead the cost model cannot see. A window is feasible when
+// predict(W) <= headroom × SLO and the inference stage keeps up with it:
+// cost(W) / (W × interarrival × servers) <= MAX_UTILISATION. If no size is
+// feasible, the one with the lowest prediction among those inference keeps
+// up with wins (w_max if none): a backlog would break any latency bound.
+//
+// Changes are damped three ways: one decision per hold_ns at most; moves
+// smaller than `hysteresis` of the current size are ignored, except a
+// shrink while the measured p99 is over the SLO; and a grow is capped at
+// max_grow × current per decision.
+//
+// Window sizes are in [w_min, w_max], w_min >= 1; the constructor throws
+// std::invalid_argument otherwise.
+class SloWindowController {
+public:
+    static constexpr double MAX_UTILISATION = 0.90;
+
+    struct Inputs {
+        double        interarrival_ns    = 0.0;   // mean gap between ticks; 0 = unknown
+        double        cost_fixed_ns      = 0.0;
+        double        cost_per_point_ns  = 0.0;   // both 0: no cost model yet
+        std::uint64_t downstream_p99_ns  = 0;     // since the last decision; 0 = no samples
+        unsigned      servers            = 1;     // inference replicas
+    };
+
+    SloWindowController(std::uint32_t w_min, std::uint32_t w_max, std::uint64_t slo_p99_ns,
+                        double headroom = 0.80, std::uint64_t hold_ns = 20'000'000,
+                        double hysteresis = 0.10, double max_grow = 1.25)
+        : w_min_(w_min), w_max_(w_max), slo_ns_(static_cast<double>(slo_p99_ns))
+        , headroom_(headroom), hold_ns_(hold_ns), hysteresis_(hysteresis), max_grow_(max_grow)
+        , current_w_(w_max)
+    {
+        if (w_min < 1 || w_max < w_min)
+            throw std::invalid_argument("SloWindowController: need 1 <= w_min <= w_max");
+    }
+
+    // True once hold_ns has passed since the last decision: gather Inputs
+    // and call update(). Cheap enough for every window start.
+    bool due(std::uint64_t now_ns) const noexcept { return !decided_ || now_ns - last_ns_ >= hold_ns_; }
+
+    std::uint32_t update(std::uint64_t now_ns, const Inputs& in) {
+        if (!due(now_ns)) return current_w_;
+        decided_ = true;
+        last_ns_ = now_ns;
+        ++decisions_;
+        if (in.cost_fixed_ns <= 0 && in.cost_per_point_ns <= 0) return current_w_;   // nothing measured yet
+
+        const bool violating = static_cast<double>(in.downstream_p99_ns) > slo_ns_ ||
+                               (ratio_ > 0 && predict(current_w_, in) > slo_ns_);
+        if (in.downstream_p99_ns > 0) {
+            const double r = std::max(1.0, static_cast<double>(in.downstream_p99_ns) / cost(current_w_, in));
+            ratio_ = ratio_ > 0 ? 0.5 * ratio_ + 0.5 * r : r;
+        }
+        if (violating) ++violations_;
+
+        const std::uint32_t target = pick(in);
+        std::uint32_t next = current_w_;
+        if (target < current_w_) {
+            if (violating || target <= current_w_ * (1.0 - hysteresis_)) next = target;
+        } else if (target > current_w_ && target >= current_w_ * (1.0 + hysteresis_)) {
+            next = std::min(target, std::max(current_w_ + 1,
+                static_cast<std::uint32_t>(current_w_ * max_grow_)));
+        }
+        if (next != current_w_) {
+            const int dir = next > current_w_ ? 1 : -1;
+            if (last_dir_ != 0 && dir != last_dir_) ++direction_changes_;
+            last_dir_  = dir;
+            current_w_ = next;
+        }
+        predicted_ns_ = predict(current_w_, in);
+        return current_w_;
+    }
+
+    std::uint32_t current() const { return current_w_; }
+    std::uint64_t direction_changes() const { return direction_changes_; }
+    std::uint64_t decisions() const { return decisions_; }
+    // Decisions taken while the measured (or predicted) p99 was over the SLO.
+    std::uint64_t violations() const { return violations_; }
+    // predict(current()) at the last decision, ns.
+    double predicted_p99_ns() const { return predicted_ns_; }
+
+private:
+    static double cost(std::uint32_t w, const Inputs& in) {
+        return std::max(1.0, in.cost_fixed_ns + in.cost_per_point_ns * w);
+    }
+
+    double predict(std::uint32_t w, const Inputs& in) const {
+        const double fill = 0.99 * static_cast<double>(w - 1) * in.interarrival_ns;
+        return fill + std::max(1.0, ratio_) * cost(w, in);
+    }
+
+    bool keeps_up(std::uint32_t w, const Inputs& in) const {
+        if (in.interarrival_ns <= 0) return true;
+        const double supply = static_cast<double>(w) * in.interarrival_ns * std::max(1u, in.servers);
+        return cost(w, in) <= MAX_UTILISATION * supply;
+    }
+
+    std::uint32_t pick(const Inputs& in) const {
+        const double budget = headroom_ * slo_ns_;
+        for (std::uint32_t w = w_max_; w >= w_min_; --w) {
+            if (keeps_up(w, in) && predict(w, in) <= budget) return w;
+        }
+        std::uint32_t best = w_max_;
+        double best_ns = -1.0;
+        for (std::uint32_t w = w_min_; w <= w_max_; ++w) {
+            if (!keeps_up(w, in)) continue;
+            const double p = predict(w, in);
+            if (best_ns < 0 || p < best_ns) { best = w; best_ns = p; }
+        }
+        return best;
+    }
+
+    std::uint32_t w_min_, w_max_;
+    double        slo_ns_, headroom_;
+    std::uint64_t hold_ns_;
+    double        hysteresis_, max_grow_;
+    std::uint32_t current_w_;
+    double        ratio_{0.0};
+    double        predicted_ns_{0.0};
+    bool          decided_{false};
+    std::uint64_t last_ns_{0};
+    std::uint64_t decisions_{0};
+    std::uint64_t violations_{0};
+    std::uint64_t direction_changes_{0};
+    int           last_dir_{0};
+};
+
+} // namespace klstream
@@ -0,0 +1,236 @@
+#pragma once
+#include "../core/event.hpp"
+#include "../core/metrics.hpp"
+#include "../core/spsc_queue.hpp"
+#include "types.hpp"
+#include "replay_file.hpp"
+#include "financial_tick_source.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace klstream {
+
+// ── StreamingReplaySource ─────────────────────────────────────────────────
+//
+// FinancialTickSource for archives that do not fit in memory: a sequence of
+// ReplayFiles (e.g. one per day or symbol) replayed back to back, with
+// memory use fixed by the ring size rather than by the archive.
+//
+// A background reader thread owns the files. It maps one at a time, copies
+// rows into a ring of `ring_blocks` blocks of `block_rows` rows, and hands
+// full blocks to the generator over an SPSC queue; the generator hands
+// them back over a second one once consumed. Around its cursor the reader
+// hints the mapping — WillNeed up to a ring's worth of rows ahead, so the
+// kernel reads in ahead of the copy, and DontNeed on the rows just copied,
+// so pages behind it do not accumulate in the process. Resident set: the
+// ring plus about two rings' worth of mapped columns, whatever the archive
+// size. (Without mmap, MappedFile falls back to reading each whole file;
+// the bound then is one file.)
+//
+// Timing, event time and seq numbering match FinancialTickSource: each
+// file starts a new PreserveTiming timeline, and seq and event time carry
+// on from the previous file (and, when looping, from the previous pass) so
+// they stay monotonic.
+//
+// The generator never blocks: if the reader has fallen behind it returns
+// false (SourceOperator reports Idle) and counts a stall. With loop=false
+// it returns false for good once the archive is exhausted; see finished().
+//
+// Every path is opened and validated in the constructor, which throws what
+// ReplayFile throws. If a file later fails to reopen, the stream ends and
+// error() says why.
+class StreamingReplaySource {
+public:
+    static constexpr std::size_t DEFAULT_BLOCK_ROWS  = 4096;
+    static constexpr std::size_t DEFAULT_RING_BLOCKS = 8;
+
+    StreamingReplaySource(std::vector<std::string> paths, ReplayMode mode,
+                          double speed_factor = 1.0, bool loop = true,
+                          std::size_t block_rows  = DEFAULT_BLOCK_ROWS,
+                          std::size_t ring_blocks = DEFAULT_RING_BLOCKS)
+        : paths_(std::move(paths))
+        , loop_(loop)
+        , block_rows_(block_rows < 1 ? 1 : block_rows)
+        , ring_(ring_blocks < 2 ? 2 : ring_blocks)
+        , filled_(queue_capacity(ring_.size()))
+        , free_(queue_capacity(ring_.size()))
+        , pacer_(mode, speed_factor)
+    {
+        if (paths_.empty()) throw std::runtime_error("StreamingReplaySource: no replay files");
+        for (const auto& p : paths_) ReplayFile check(p);
+        for (std::uint32_t s = 0; s < ring_.size(); ++s) {
+            ring_[s].rows.resize(block_rows_);
+            free_.push(s);
+        }
+        reader_ = std::thread([this] { read_loop(); });
+    }
+
+    ~StreamingReplaySource() {
+        stop_.store(true, std::memory_order_relaxed);
+        if (reader_.joinable()) reader_.join();
+    }
+
+    StreamingReplaySource(const StreamingReplaySource&)            = delete;
+    StreamingReplaySource& operator=(const StreamingReplaySource&) = delete;
+
+    // Generator function for SourceOperator<FeatureVector>, as for
+    // FinancialTickSource.
+    bool operator()(Event<FeatureVector>& out, std::uint64_t /*unused_seq*/) {
+        if (done_) return false;
+        if (cur_ == NONE || pos_ >= ring_[cur_].n) {
+            if (cur_ != NONE) {
+                free_.push(cur_);   // never waits: free_ holds every slot
+                cur_ = NONE;
+            }
+            std::uint32_t s;
+            if (!filled_.try_pop(&s)) {
+                stalls_.increment();
+                return false;
+            }
+            if (s == END) {
+                done_ = true;
+                return false;
+            }
+            cur_ = s;
+            pos_ = 0;
+            if (ring_[cur_].new_timeline) {
+                pacer_.restart();
+                clock_.restart();
+            }
+        }
+
+        const Block&   b = ring_[cur_];
+        const TickRow& r = b.rows[pos_++];
+        pacer_.pace(r.timestamp_ns);
+
+        FeatureVector fv{ r.log_return, r.rolling_vol, r.order_imbalance,
+                          r.spread_bps, r.volume };
+        out = Event<FeatureVector>::make_at(fv, clock_.at(r.timestamp_ns), 0, r.seq + b.seq_base);
+        ground_truth_label_ = r.label;
+        return true;
+    }
+
+    std::uint8_t  last_label() const { return ground_truth_label_; }
+
+    // loop=false only: every row of every file has been emitted.
+    bool          finished() const noexcept { return done_; }
+
+    // Generator calls that found no block ready (reader behind).
+    std::uint64_t stalls() const noexcept { return stalls_.load(); }
+    std::uint64_t blocks_read() const noexcept { return blocks_read_.load(); }
+
+    // Heap held by the ring — the part of the footprint set by the
+    // configuration rather than by the kernel.
+    std::size_t   ring_bytes() const noexcept { return ring_.size() * block_rows_ * sizeof(TickRow); }
+
+    std::string error() const {
+        std::lock_guard<std::mutex> lk(error_mu_);
+        return error_;
+    }
+
+private:
+    struct Block {
+        std::vector<TickRow> rows;
+        std::size_t   n = 0;
+        std::uint64_t seq_base = 0;       // added to every row's seq
+        bool          new_timeline = false;   // first block of a file
+    };
+
+    static constexpr std::uint32_t NONE = UINT32_MAX;
+    static constexpr std::uint32_t END  = UINT32_MAX - 1;   // end of stream on filled_
+    static constexpr std::size_t   STOP_CHECK_ROWS = 1024;
+
+    // Room for every slot plus the END marker.
+    static std::size_t queue_capacity(std::size_t slots) {
+        std::size_t c = 1;
+        while (c < slots + 2) c <<= 1;
+        return c;
+    }
+
+    void read_loop() {
+        std::uint64_t seq_base = 0;
+        try {
+            do {
+                for (const auto& path : paths_) {
+                    if (stopping() || !stream_file(path, seq_base)) return;
+                }
+            } while (loop_);
+        } catch (const std::exception& e) {
+            std::lock_guard<std::mutex> lk(error_mu_);
+            error_ = e.what();
+        }
+        filled_.push(END);
+    }
+
+    bool stopping() const noexcept { return stop_.load(std::memory_order_relaxed); }
+
+    // Streams one file into the ring. Returns false if asked to stop, which
+    // it checks before every block and every STOP_CHECK_ROWS rows of a copy
+    // as well as while waiting for a free block, so a large block or a
+    // consumer that keeps up does not hold up the destructor's join.
+    // Opening the file (a whole read without mmap) is not interrupted.
+    bool stream_file(const std::string& path, std::uint64_t& seq_base) {
+        const ReplayFile file(path);
+        const ReplayColumns& c = file.columns();
+        const std::size_t ahead = ring_.size() * block_rows_;
+        file.advise_rows(0, c.n, MappedFile::Advice::Sequential);
+        file.advise_rows(0, ahead, MappedFile::Advice::WillNeed);
+
+        for (std::size_t row = 0; row < c.n; row += block_rows_) {
+            if (stopping()) return false;
+            std::uint32_t s;
+            while (!free_.try_pop(&s)) {
+                if (stopping()) return false;
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+            Block& b = ring_[s];
+            b.n            = std::min(block_rows_, c.n - row);
+            b.seq_base     = seq_base;
+            b.new_timeline = row == 0;
+            for (std::size_t i = 0; i < b.n; ++i) {
+                if (i % STOP_CHECK_ROWS == STOP_CHECK_ROWS - 1 && stopping()) return false;
+                b.rows[i] = c.row(row + i);
+            }
+
+            file.advise_rows(row + ahead, row + ahead + b.n, MappedFile::Advice::WillNeed);
+            file.advise_rows(row, row + b.n, MappedFile::Advice::DontNeed);
+            blocks_read_.increment();
+            filled_.push(s);   // never waits: filled_ holds every slot
+        }
+        seq_base += c.seq[c.n - 1] + 1;
+        return true;
+    }
+
+    const std::vector<std::string> paths_;
+    const bool                     loop_;
+    const std::size_t              block_rows_;
+    std::vector<Block>             ring_;
+    SPSCQueue<std::uint32_t>       filled_;   // reader -> generator
+    SPSCQueue<std::uint32_t>       free_;     // generator -> reader
+
+    // Generator side.
+    ReplayPacer      pacer_;
+    ReplayEventClock clock_;
+    std::uint32_t    cur_{NONE};
+    std::size_t      pos_{0};
+    bool             done_{false};
+    std::uint8_t     ground_truth_label_{0};
+    Counter          stalls_;
+
+    // Reader side.
+    Counter            blocks_read_;
+    std::atomic<bool>  stop_{false};
+    mutable std::mutex error_mu_;
+    std::string        error_;
+    std::thread        reader_;
+};
+
+} // namespace klstream
@@ -1,6 +1,9 @@
 #pragma once
 #include <array>
 #include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
 
 namespace klstream {
 
@@ -13,7 +16,7 @@ struct FeatureVector {
     float rolling_vol;
     float order_imbalance;
     float spread_bps;
-    float volume;          // already log1p-scaled by the Python preprocessor
+    float volume;          // log1p-scaled (preprocess_lobster.py, or FeatureExtractor online)
 
     static constexpr std::size_t kDim = 5;
 
@@ -25,6 +28,37 @@ struct FeatureVector {
 static_assert(sizeof(FeatureVector) == 5 * sizeof(float),
     "FeatureVector must stay a flat POD — no padding tricks, it crosses queues");
 
+// ── BookTop ──────────────────────────────────────────────────────────────
+// One raw top-of-book update, as LOBSTER's NumLevels=1 order book rows (and
+// a live feed) deliver it: prices in cents, sizes in shares. FeatureExtractOp
+// turns a stream of these into FeatureVectors online.
+struct BookTop {
+    double        bid_px;
+    double        ask_px;
+    std::uint32_t bid_sz;
+    std::uint32_t ask_sz;
+};
+static_assert(std::is_trivially_copyable_v<BookTop>);
+
+// ── Symbol keys ──────────────────────────────────────────────────────────
+// A ticker travels as Event::key: up to 8 ASCII characters packed into the
+// 64-bit key, first character in the low byte. Reversible and allocation-
+// free, and distinct tickers get distinct keys, so PartitionOperator and
+// KeyedStateStore route on it directly. Key 0 is the empty symbol — what
+// single-symbol runs carry.
+inline std::uint64_t symbol_key(std::string_view ticker) noexcept {
+    std::uint64_t k = 0;
+    for (std::size_t i = 0; i < ticker.size() && i < 8; ++i)
+        k |= static_cast<std::uint64_t>(static_cast<unsigned char>(ticker[i])) << (8 * i);
+    return k;
+}
+
+inline std::string symbol_name(std::uint64_t key) {
+    std::string s;
+    for (; key != 0; key >>= 8) s.push_back(static_cast<char>(key & 0xff));
+    return s;
+}
+
 // ── WindowBatch ────────────────────────────────────────────────────────────
 // Fixed-capacity, trivially-copyable container — see Section 7.3 for why
 // this cannot be a std::vector. MAX_WINDOW_SIZE caps every window
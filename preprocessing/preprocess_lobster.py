@@ -9,10 +9,17 @@ Usage:
         --message AAPL_2012-06-21_34200000_57600000_message_1.csv \
         --orderbook AAPL_2012-06-21_34200000_57600000_orderbook_1.csv \
         --out replay_AAPL_20120621.csv \
-        --seed 42
+        --seed 42 \
+        [--binary-out replay_AAPL_20120621.klsr]
+
+--binary-out additionally writes the same events in klstream's mmap-able
+columnar replay format (include/klstream/window/replay_file.hpp), which
+adaptive_window_main --replay= maps instead of parsing. The CSV is still
+written: the analysis scripts read ground truth from it.
 """
 import argparse
 import math
+import struct
 import random
 import pandas as pd
 import numpy as np
@@ -126,12 +133,49 @@ def compute_features(df):
     return out
 
 
+# Must match ReplayFileHeader in include/klstream/window/replay_file.hpp.
+REPLAY_MAGIC      = b"KLSRPLY\0"
+REPLAY_VERSION    = 1
+REPLAY_ENDIAN_TAG = 0x01020304
+REPLAY_ALIGN      = 128
+REPLAY_HEADER     = 256
+REPLAY_COLUMNS = [   # (column, dtype) in Section order; INDEX follows
+    ("seq", "<u8"), ("timestamp_ns", "<u8"),
+    ("log_return", "<f4"), ("rolling_vol", "<f4"), ("order_imbalance", "<f4"),
+    ("spread_bps", "<f4"), ("volume", "<f4"),
+    ("label", "u1"), ("is_burst_period", "u1"),
+]
+
+
+def write_replay_binary(out, path, index_stride_ns=1_000_000_000):
+    ts = out["timestamp_ns"].to_numpy(np.uint64)
+    base = int(ts[0])
+    n_index = (int(ts[-1]) - base) // index_stride_ns + 1
+    edges = base + np.arange(n_index, dtype=np.uint64) * np.uint64(index_stride_ns)
+    arrays = [out[c].to_numpy().astype(dt) for c, dt in REPLAY_COLUMNS]
+    arrays.append(np.searchsorted(ts, edges, side="left").astype("<u8"))
+
+    offsets, at = [], REPLAY_HEADER
+    for a in arrays:
+        offsets.append(at)
+        at = (at + a.nbytes + REPLAY_ALIGN - 1) // REPLAY_ALIGN * REPLAY_ALIGN
+    header = struct.pack("<8sIIQQQQQ10Q", REPLAY_MAGIC, REPLAY_VERSION, REPLAY_ENDIAN_TAG,
+                         len(out), index_stride_ns, base, n_index, at, *offsets)
+    with open(path, "wb") as f:
+        f.write(header.ljust(REPLAY_HEADER, b"\0"))
+        for off, a in zip(offsets, arrays):
+            f.write(b"\0" * (off - f.tell()))
+            f.write(a.tobytes())
+        f.write(b"\0" * (at - f.tell()))
+
+
 def main():
     ap = argparse.ArgumentParser()
     ap.add_argument("--message", required=True)
     ap.add_argument("--orderbook", required=True)
     ap.add_argument("--out", required=True)
     ap.add_argument("--seed", type=int, default=42)
+    ap.add_argument("--binary-out", help="also write the mmap-able replay format here")
     args = ap.parse_args()
 
     rng = random.Random(args.seed)
@@ -140,12 +184,16 @@ def main():
     df = mark_burst_periods(df, rng)
     out = compute_features(df)
     out.to_csv(args.out, index=False)
+    if args.binary_out:
+        write_replay_binary(out, args.binary_out)
 
     n_anom = (out["label"] != 0).sum()
     print(f"Wrote {len(out)} events to {args.out}")
     print(f"  Flash-crash-precursor events: {(out['label']==1).sum()}")
     print(f"  Wash-trade-proxy events:      {(out['label']==2).sum()}")
     print(f"  Total anomalous fraction:     {n_anom/len(out):.3%}")
+    if args.binary_out:
+        print(f"  Binary replay:                {args.binary_out}")
 
 
 if __name__ == "__main__":
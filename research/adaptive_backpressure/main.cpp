@@ -84,6 +84,10 @@ int main(int argc, char* argv[]) {
     std::cout << "p50 latency: " << latency.percentile(0.5) << " us\n";
     std::cout << "p99 latency: " << latency.percentile(0.99) << " us\n";
     std::cout << "p999 latency: " << latency.percentile(0.999) << " us\n";
+    if (const auto* ctl = source.flow_control()) {
+        std::cout << "Final rate: " << ctl->rate() << " ev/s (max " << ctl->max_rate() << ")\n";
+        std::cout << "AIMD steps: +" << ctl->increases() << " / -" << ctl->decreases() << "\n";
+    }
 
     return 0;
 }
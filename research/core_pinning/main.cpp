@@ -20,8 +20,18 @@ int main(int argc, char* argv[]) {
     std::string mode = "optimised";
     if (argc > 1) mode = argv[1];
 
+    // "explicit": each stage on its own physical core (first three of the
+    // Performance set, wrapping on smaller hosts), memory on that core's node.
+    const CpuTopology& topo = CpuTopology::system();
+    const std::vector<int> perf = topo.cpus_for(CoreAffinity::Performance);
+    std::cout << "Topology: " << topo.cpus().size() << " CPUs, " << topo.n_nodes()
+              << " NUMA node(s), " << perf.size() << " in the Performance set"
+              << (topo.hybrid() ? " (hybrid)" : "") << "\n";
+
     ExperimentAffinityConfig cfg;
-    if (mode == "all_any") {
+    if (mode == "explicit") {
+        cfg = { CoreAffinity::Any, CoreAffinity::Any, CoreAffinity::Any };
+    } else if (mode == "all_any") {
         cfg = { CoreAffinity::Any, CoreAffinity::Any, CoreAffinity::Any };
     } else if (mode == "all_perf") {
         cfg = { CoreAffinity::Performance, CoreAffinity::Performance, CoreAffinity::Performance };
@@ -55,9 +65,18 @@ int main(int argc, char* argv[]) {
     sink.attach_metrics(&m_snk);
 
     Runtime rt;
-    rt.add_worker(cfg.source);
-    rt.add_worker(cfg.compute);
-    rt.add_worker(cfg.sink);
+    if (mode == "explicit") {
+        for (std::size_t i = 0; i < 3; ++i) {
+            rt.add_worker(WorkerPlacement{ CoreAffinity::Any, { perf[i % perf.size()] }, -1 });
+        }
+        // Each ring on the node of the stage that reads it.
+        q1.bind_to_numa_node(rt.worker_numa_node(1));
+        q2.bind_to_numa_node(rt.worker_numa_node(2));
+    } else {
+        rt.add_worker(cfg.source);
+        rt.add_worker(cfg.compute);
+        rt.add_worker(cfg.sink);
+    }
 
     rt.register_op(&source, 0);
     rt.register_op(&map, 1);
@@ -68,6 +87,9 @@ int main(int argc, char* argv[]) {
     rt.wait_for(seconds(10));
     rt.stop();
 
+    for (int w = 0; w < 3; ++w) {
+        if (!rt.worker(w).placement_applied()) std::cout << "Worker " << w << " could not be pinned\n";
+    }
     std::cout << "Throughput: " << m_snk.events_processed.load() / 10 << " ev/s\n";
     std::cout << "p50 latency: " << latency.percentile(0.5) << " us\n";
     std::cout << "p99 latency: " << latency.percentile(0.99) << " us\n";
@@ -0,0 +1,517 @@
+#include <gtest/gtest.h>
+#include "klstream/operators/partition.hpp"
+#include "klstream/window/adaptive_window_op.hpp"
+#include "klstream/window/batch_pool.hpp"
+#include "klstream/window/data_driven_window_op.hpp"
+#include "klstream/window/feature_extract_op.hpp"
+#include "klstream/window/inference_op.hpp"
+#include "klstream/window/keyed_window_op.hpp"
+#include "klstream/window/slo_window_controller.hpp"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace klstream;
+
+namespace {
+
+IsolationForest<FeatureVector::kDim> small_forest() {
+    std::mt19937 rng(7);
+    std::normal_distribution<float> d(0.0f, 1.0f);
+    std::vector<std::array<float, FeatureVector::kDim>> pts(512);
+    for (auto& p : pts)
+        for (auto& v : p) v = d(rng);
+    IsolationForest<FeatureVector::kDim> f(20, 64, 1);
+    f.fit(pts);
+    return f;
+}
+
+FeatureVector fv(float x) { return FeatureVector{ x, x, x, x, x }; }
+
+} // namespace
+
+// Test 1: Pool_AcquireReleaseExhaustion
+TEST(AdaptiveWindowTest, Pool_AcquireReleaseExhaustion) {
+    WindowBatchPool pool(3);
+    std::uint32_t a, b, c, d;
+    EXPECT_TRUE(pool.try_acquire(&a));
+    EXPECT_TRUE(pool.try_acquire(&b));
+    EXPECT_TRUE(pool.try_acquire(&c));
+    EXPECT_FALSE(pool.try_acquire(&d));   // all in flight
+
+    pool.at(b).push_back(fv(1.0f), 10);
+    pool.release(b);
+    EXPECT_TRUE(pool.try_acquire(&d));
+    EXPECT_EQ(d, b);
+    EXPECT_EQ(pool.at(d).count, 0u);      // cleared on acquire
+}
+
+// Test 2: Pooled_MatchesByValueScores
+TEST(AdaptiveWindowTest, Pooled_MatchesByValueScores) {
+    auto forest = small_forest();
+
+    SPSCQueue<Event<FeatureVector>> in_copy(64), in_pool(64);
+    SPSCQueue<Event<WindowBatch>>   win_copy(8);
+    SPSCQueue<Event<WindowHandle>>  win_pool(8);
+    SPSCQueue<Event<DetectionResult>> out_copy(8), out_pool(8);
+    WindowBatchPool pool(win_pool.capacity() + 2);
+
+    // w_min == w_max == 4: fixed windows, so both paths cut identically.
+    DataDrivenWindowOp       w_copy("w", &in_copy, &win_copy, 4, 4);
+    PooledDataDrivenWindowOp w_pool("w", &in_pool, &win_pool, 4, 4);
+    w_pool.attach_pool(&pool);
+    InferenceOp       i_copy("i", &win_copy, &out_copy, &forest);
+    PooledInferenceOp i_pool("i", &win_pool, &out_pool, &forest);
+    i_pool.attach_pool(&pool);
+
+    for (std::uint64_t s = 0; s < 12; ++s) {
+        float x = (s == 6) ? 8.0f : 0.1f * static_cast<float>(s);
+        ASSERT_TRUE(in_copy.try_push(Event<FeatureVector>::make(fv(x), 0, s)));
+        ASSERT_TRUE(in_pool.try_push(Event<FeatureVector>::make(fv(x), 0, s)));
+    }
+    for (int t = 0; t < 12; ++t) {
+        EXPECT_EQ(w_copy.tick(), OpStatus::Processed);
+        EXPECT_EQ(w_pool.tick(), OpStatus::Processed);
+    }
+    for (int t = 0; t < 3; ++t) {
+        EXPECT_EQ(i_copy.tick(), OpStatus::Processed);
+        EXPECT_EQ(i_pool.tick(), OpStatus::Processed);
+    }
+
+    for (int w = 0; w < 3; ++w) {
+        auto a = out_copy.pop();
+        auto b = out_pool.pop();
+        ASSERT_TRUE(a.has_value());
+        ASSERT_TRUE(b.has_value());
+        EXPECT_DOUBLE_EQ(a->data.max_score, b->data.max_score);
+        EXPECT_EQ(a->data.window_size_used, 4u);
+        EXPECT_EQ(b->data.window_size_used, 4u);
+        EXPECT_EQ(a->data.first_seq, b->data.first_seq);
+        EXPECT_EQ(a->data.flagged_seq, b->data.flagged_seq);
+    }
+
+    // Every slot came back: the pool can hand out all of them again.
+    std::uint32_t slot;
+    for (std::size_t k = 0; k < pool.size(); ++k) EXPECT_TRUE(pool.try_acquire(&slot));
+}
+
+// Test 3: Pooled_BlocksWhenPoolExhausted
+TEST(AdaptiveWindowTest, Pooled_BlocksWhenPoolExhausted) {
+    SPSCQueue<Event<FeatureVector>> in(64);
+    SPSCQueue<Event<WindowHandle>>  out(16);
+    WindowBatchPool pool(2);
+    PooledAdaptiveWindowOp op("a", &in, &out, 2, 2);
+    op.attach_pool(&pool);
+
+    for (std::uint64_t s = 0; s < 6; ++s)
+        ASSERT_TRUE(in.try_push(Event<FeatureVector>::make(fv(0.0f), 0, s)));
+    for (int t = 0; t < 4; ++t) EXPECT_EQ(op.tick(), OpStatus::Processed);
+    EXPECT_EQ(op.tick(), OpStatus::Blocked);   // both slots queued downstream
+
+    auto h = out.pop();
+    ASSERT_TRUE(h.has_value());
+    EXPECT_EQ(h->data.count, 2u);
+    EXPECT_EQ(h->data.first_seq, 0u);
+    pool.release(h->data.slot);
+    EXPECT_EQ(op.tick(), OpStatus::Processed); // a slot is free again
+}
+
+// Test 4: Inference_EarlyExitMatchesFullScoring
+TEST(AdaptiveWindowTest, Inference_EarlyExitMatchesFullScoring) {
+    auto forest = small_forest();
+
+    SPSCQueue<Event<WindowBatch>>     in_full(8), in_fast(8);
+    SPSCQueue<Event<DetectionResult>> out_full(8), out_fast(8);
+    InferenceOp full("i", &in_full, &out_full, &forest);
+    InferenceOp fast("i", &in_fast, &out_fast, &forest);
+    fast.set_early_exit(true);
+
+    std::mt19937 rng(3);
+    std::normal_distribution<float> d(0.0f, 1.0f);
+    for (std::uint64_t w = 0; w < 4; ++w) {
+        WindowBatch wb;
+        for (std::uint64_t s = 0; s < 200; ++s) {
+            FeatureVector p{ d(rng), d(rng), d(rng), d(rng), d(rng) };
+            wb.push_back(w == 2 && s == 150 ? fv(6.0f) : p, w * 200 + s);
+        }
+        ASSERT_TRUE(in_full.try_push(Event<WindowBatch>::make(wb, 0, w)));
+        ASSERT_TRUE(in_fast.try_push(Event<WindowBatch>::make(wb, 0, w)));
+        EXPECT_EQ(full.tick(), OpStatus::Processed);
+        EXPECT_EQ(fast.tick(), OpStatus::Processed);
+
+        auto a = out_full.pop();
+        auto b = out_fast.pop();
+        ASSERT_TRUE(a.has_value());
+        ASSERT_TRUE(b.has_value());
+        EXPECT_EQ(a->data.max_score, b->data.max_score);
+        EXPECT_EQ(a->data.flagged_seq, b->data.flagged_seq);
+    }
+    EXPECT_EQ(full.trees_skipped(), 0u);
+    EXPECT_EQ(full.trees_evaluated(), 4u * 200u * forest.n_trees());
+    EXPECT_GT(fast.trees_skipped(), 0u);
+    EXPECT_EQ(fast.trees_evaluated() + fast.trees_skipped(), full.trees_evaluated());
+}
+
+// Test 5: Inference_HotSwapAppliesFromNextWindow
+TEST(AdaptiveWindowTest, Inference_HotSwapAppliesFromNextWindow) {
+    using Forest = InferenceOp::Forest;
+    auto first  = small_forest();
+    Forest second(5, 16, 99);
+    {
+        std::mt19937 rng(11);
+        std::uniform_real_distribution<float> u(-3.0f, 3.0f);
+        std::vector<Forest::Point> pts(64);
+        for (auto& p : pts)
+            for (auto& v : p) v = u(rng);
+        second.fit(pts);
+    }
+
+    InferenceOp::Models models(std::make_unique<const Forest>(first));
+    SPSCQueue<Event<WindowBatch>>     in(8);
+    SPSCQueue<Event<DetectionResult>> out(8);
+    InferenceOp op("i", &in, &out, &models);
+
+    WindowBatch wb;
+    for (std::uint64_t s = 0; s < 8; ++s) wb.push_back(fv(0.2f * static_cast<float>(s)), s);
+    auto expected = [&](const Forest& f) {
+        double best = -1.0;
+        for (std::uint32_t i = 0; i < wb.count; ++i)
+            best = std::max(best, f.anomaly_score(wb.points[i].to_point()));
+        return best;
+    };
+
+    ASSERT_TRUE(in.try_push(Event<WindowBatch>::make(wb, 0, 0)));
+    EXPECT_EQ(op.tick(), OpStatus::Processed);
+    EXPECT_EQ(out.pop()->data.max_score, expected(first));
+
+    models.publish(std::make_unique<const Forest>(second));
+    EXPECT_EQ(models.reclaim(), 1u);           // op has not ticked since
+    ASSERT_TRUE(in.try_push(Event<WindowBatch>::make(wb, 0, 1)));
+    EXPECT_EQ(op.tick(), OpStatus::Processed);
+    EXPECT_EQ(out.pop()->data.max_score, expected(second));
+    EXPECT_EQ(op.tick(), OpStatus::Idle);      // quiescent again
+    EXPECT_EQ(models.reclaim(), 0u);
+    op.shutdown();
+}
+
+// Test 6: CostModel_FitsFixedAndPerPointCost
+TEST(AdaptiveWindowTest, CostModel_FitsFixedAndPerPointCost) {
+    WindowCostModel one;
+    for (int i = 0; i < 10; ++i) one.record(64, 6400);
+    EXPECT_DOUBLE_EQ(one.fixed_ns(), 0.0);          // one size: all per point
+    EXPECT_DOUBLE_EQ(one.per_point_ns(), 100.0);
+
+    WindowCostModel m(0.05);
+    for (int i = 0; i < 2000; ++i) {
+        const std::uint32_t w = (i % 3 == 0) ? 16 : (i % 3 == 1) ? 64 : 256;
+        m.record(w, 2000 + 50 * w);
+    }
+    EXPECT_NEAR(m.fixed_ns(), 2000.0, 1.0);
+    EXPECT_NEAR(m.per_point_ns(), 50.0, 0.01);
+    EXPECT_NEAR(m.predict_ns(100), 7000.0, 2.0);
+    EXPECT_EQ(m.samples(), 2000u);
+}
+
+// Test 7: SloController_LargestWindowWithinBudget
+TEST(AdaptiveWindowTest, SloController_LargestWindowWithinBudget) {
+    // SLO 100 µs, headroom 0.8: 80 µs for 0.99 x (W - 1) x 1 µs of fill
+    // plus 2 µs + 50 ns x W of scoring -> W <= 75.
+    SloWindowController c(16, 256, 100'000, 0.80, /*hold_ns=*/1'000'000);
+    SloWindowController::Inputs in;
+    in.interarrival_ns   = 1000;
+    in.cost_fixed_ns     = 2000;
+    in.cost_per_point_ns = 50;
+    EXPECT_EQ(c.current(), 256u);
+    EXPECT_THROW(SloWindowController(0, 256, 100'000), std::invalid_argument);   // W - 1 must not wrap
+    EXPECT_EQ(c.update(0, in), 75u);
+    EXPECT_LE(c.predicted_p99_ns(), 80'000.0);
+
+    // Held for hold_ns whatever the inputs say.
+    in.interarrival_ns = 100;
+    EXPECT_FALSE(c.due(500'000));
+    EXPECT_EQ(c.update(500'000, in), 75u);
+
+    // A target within the hysteresis band (78 vs 75) is ignored.
+    in.interarrival_ns = 960;
+    EXPECT_EQ(c.update(1'000'000, in), 75u);
+
+    // Sink-side p99 three times the modelled cost: queueing the model
+    // missed, so the prediction is scaled up and the window shrinks.
+    in.interarrival_ns   = 1000;
+    in.downstream_p99_ns = 3 * (2000 + 50 * 75);
+    EXPECT_EQ(c.update(2'000'000, in), 65u);
+    EXPECT_EQ(c.violations(), 0u);
+
+    // Over the SLO at the sink: counted as a violation, and shrinks.
+    in.downstream_p99_ns = 150'000;
+    EXPECT_LT(c.update(3'000'000, in), 65u);
+    EXPECT_EQ(c.violations(), 1u);
+    EXPECT_EQ(c.decisions(), 4u);
+}
+
+// Test 8: SloController_GrowsAtMostMaxGrowPerDecision
+TEST(AdaptiveWindowTest, SloController_GrowsAtMostMaxGrowPerDecision) {
+    SloWindowController c(16, 256, 100'000, 0.80, /*hold_ns=*/10, 0.10, 1.25);
+    SloWindowController::Inputs in;
+    in.cost_fixed_ns     = 2000;
+    in.cost_per_point_ns = 50;
+    in.interarrival_ns   = 10'000;          // even W = 16 misses: smallest wins
+    std::uint64_t t = 0;
+    EXPECT_EQ(c.update(t, in), 16u);
+
+    in.interarrival_ns = 100;               // now all of 256 fits
+    std::vector<std::uint32_t> steps;
+    while (c.current() < 256 && steps.size() < 50) steps.push_back(c.update(t += 10, in));
+    ASSERT_FALSE(steps.empty());
+    EXPECT_EQ(steps.front(), 20u);          // 16 x 1.25
+    EXPECT_EQ(c.current(), 256u);
+    for (std::size_t i = 1; i < steps.size(); ++i) EXPECT_LE(steps[i], steps[i - 1] * 1.25 + 1);
+    EXPECT_EQ(c.direction_changes(), 1u);   // down once, then up
+}
+
+// Test 9: SloMode_WindowFollowsMeasuredArrivalsAndCost
+TEST(AdaptiveWindowTest, SloMode_WindowFollowsMeasuredArrivalsAndCost) {
+    auto forest = small_forest();
+    SPSCQueue<Event<FeatureVector>>   in(1024);
+    SPSCQueue<Event<WindowBatch>>     win(8);
+    SPSCQueue<Event<DetectionResult>> out(8);
+    AdaptiveWindowOp op("a", &in, &win, 16, 256);
+    InferenceOp      inf("i", &win, &out, &forest);
+
+    // Scoring cost as the model would have measured it; the inference op
+    // adds its own samples as windows go through.
+    WindowCostModel cost;
+    for (int i = 0; i < 100; ++i) cost.record(i % 2 ? 16 : 256, 2000 + (i % 2 ? 16 : 256) * 50);
+    LatencyHistogram sink_latency;
+    op.enable_latency_slo(SloWindowController(16, 256, 100'000, 0.80, /*hold_ns=*/0),
+                          &sink_latency, &cost);
+    ASSERT_NE(op.slo_controller(), nullptr);
+
+    // Ticks 1 µs apart. No interarrival yet: the first window is w_max.
+    std::uint64_t seq = 0;
+    auto feed = [&](std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i, ++seq) {
+            auto ev = Event<FeatureVector>::make(fv(0.1f), 0, seq);
+            ev.timestamp_ns = 1'000'000 + seq * 1000;
+            ASSERT_TRUE(in.try_push(ev));
+        }
+    };
+    feed(256);
+    while (!in.empty()) (void)op.tick();
+    ASSERT_EQ(win.pop()->data.count, 256u);
+
+    // The measured 1 µs gap puts the next window at the SLO's size. The
+    // real scoring cost of this tiny forest sits well below the injected
+    // one, so the fit only moves down.
+    feed(100);
+    while (!in.empty()) (void)op.tick();
+    EXPECT_LE(op.window_size(), 80u);
+    EXPECT_GE(op.window_size(), 70u);
+    auto w = win.pop();
+    ASSERT_TRUE(w.has_value());
+    EXPECT_EQ(w->data.count, op.window_size());
+
+    inf.attach_cost_model(&cost);
+    InferenceOp other("i2", &win, &out, &forest);
+    EXPECT_THROW(other.attach_cost_model(&cost), std::logic_error);   // one writer per model
+    ASSERT_TRUE(win.try_push(*w));
+    EXPECT_EQ(inf.tick(), OpStatus::Processed);
+    EXPECT_EQ(cost.samples(), 101u);
+}
+
+namespace {
+
+// A random walk of top-of-book updates: mid around $100 in cents, spreads
+// of 1-3 ticks, and occasional empty sides.
+std::vector<BookTop> book_walk(std::size_t n, std::uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> step(-2, 2), spread(1, 3), size(0, 500);
+    std::vector<BookTop> v(n);
+    double bid = 1'000'000.0;
+    for (auto& t : v) {
+        bid += 100.0 * step(rng);
+        t = BookTop{ bid, bid + 100.0 * spread(rng),
+                     static_cast<std::uint32_t>(size(rng)), static_cast<std::uint32_t>(size(rng)) };
+    }
+    return v;
+}
+
+} // namespace
+
+// Test 10: FeatureExtractor_MatchesOfflinePreprocessing
+// The formulas of preprocess_lobster.py's compute_features(), evaluated
+// directly in double; the extractor must agree one tick at a time and in
+// uneven batches alike.
+TEST(AdaptiveWindowTest, FeatureExtractor_MatchesOfflinePreprocessing) {
+    const auto book = book_walk(1000, 3);
+    std::vector<FeatureVector> ref(book.size());
+    double v = 0.0;
+    for (std::size_t i = 0; i < book.size(); ++i) {
+        const auto& t = book[i];
+        const double mid = (t.ask_px + t.bid_px) / 2.0;
+        const double r = i == 0 ? 0.0
+            : std::log(mid) - std::log((book[i - 1].ask_px + book[i - 1].bid_px) / 2.0);
+        v = 0.05 * r * r + 0.95 * v;
+        const double depth = static_cast<double>(t.bid_sz) + t.ask_sz;
+        ref[i] = FeatureVector{ static_cast<float>(r), static_cast<float>(v),
+                                static_cast<float>((static_cast<double>(t.bid_sz) - t.ask_sz) / std::max(1.0, depth)),
+                                static_cast<float>(1e4 * (t.ask_px - t.bid_px) / mid),
+                                static_cast<float>(std::log1p(depth)) };
+    }
+
+    FeatureExtractor one, batched;
+    std::vector<FeatureVector> a(book.size()), b(book.size());
+    for (std::size_t i = 0; i < book.size(); ++i) a[i] = one.extract(book[i]);
+    for (std::size_t i = 0, n = 1; i < book.size(); i += n, n = n * 2 + 1) {
+        n = std::min(n, book.size() - i);
+        batched.extract(book.data() + i, n, b.data() + i);
+    }
+    EXPECT_EQ(batched.ticks(), book.size());
+
+    for (std::size_t i = 0; i < book.size(); ++i) {
+        const auto e = ref[i].to_point(), x = a[i].to_point(), y = b[i].to_point();
+        for (std::size_t d = 0; d < FeatureVector::kDim; ++d) {
+            EXPECT_NEAR(x[d], e[d], 1e-6f * std::max(1.0f, std::fabs(e[d]))) << "tick " << i << " dim " << d;
+            EXPECT_EQ(x[d], y[d]) << "tick " << i << " dim " << d;
+        }
+    }
+    EXPECT_EQ(a[0].log_return, 0.0f);
+}
+
+// Test 11: FeatureExtractor_RollingVarianceMatchesTwoPass
+TEST(AdaptiveWindowTest, FeatureExtractor_RollingVarianceMatchesTwoPass) {
+    constexpr std::size_t W = 64;
+    const auto book = book_walk(2000, 5);
+    auto fx = FeatureExtractor::rolling(W);
+    ASSERT_TRUE(fx.is_rolling());
+    EXPECT_THROW(FeatureExtractor::rolling(1), std::invalid_argument);
+
+    std::vector<FeatureVector> f(book.size());
+    fx.extract(book.data(), book.size(), f.data());
+
+    std::vector<double> r(book.size(), 0.0);
+    for (std::size_t i = 1; i < book.size(); ++i) {
+        r[i] = std::log((book[i].ask_px + book[i].bid_px) / 2.0) -
+               std::log((book[i - 1].ask_px + book[i - 1].bid_px) / 2.0);
+    }
+    for (std::size_t i : { std::size_t{0}, std::size_t{10}, W - 1, W, W + 1, std::size_t{999}, book.size() - 1 }) {
+        const std::size_t lo = i + 1 >= W ? i + 1 - W : 0;
+        double mean = 0.0, m2 = 0.0;
+        for (std::size_t j = lo; j <= i; ++j) mean += r[j];
+        mean /= static_cast<double>(i + 1 - lo);
+        for (std::size_t j = lo; j <= i; ++j) m2 += (r[j] - mean) * (r[j] - mean);
+        const double var = m2 / static_cast<double>(i + 1 - lo);
+        EXPECT_NEAR(f[i].rolling_vol, var, 1e-3 * var + 1e-12) << "tick " << i;
+    }
+
+    fx.reset();
+    EXPECT_EQ(fx.ticks(), 0u);
+    EXPECT_EQ(fx.extract(book[5]).log_return, 0.0f);
+}
+
+// Test 12: FeatureExtractOp_FeedsWindowStage
+// Raw ticks in, windows out: the operator's batch path keeps each tick's
+// seq, and a batch stalled on a full queue is finished before the next.
+TEST(AdaptiveWindowTest, FeatureExtractOp_FeedsWindowStage) {
+    const auto book = book_walk(64, 7);
+    SPSCQueue<Event<BookTop>>       raw(128);
+    SPSCQueue<Event<FeatureVector>> features(32);
+    SPSCQueue<Event<WindowBatch>>   win(8);
+    FeatureExtractOp fx("fx", &raw, &features);
+    fx.set_batch_size(16);
+    AdaptiveWindowOp op("a", &features, &win, 16, 16);
+    OperatorMetrics m("fx");
+    fx.attach_metrics(&m);
+
+    for (std::size_t i = 0; i < book.size(); ++i) {
+        auto ev = Event<BookTop>::make(book[i], 0, i);
+        ev.timestamp_ns = 1'000 + i;
+        ASSERT_TRUE(raw.try_push(ev));
+    }
+    EXPECT_TRUE(fx.ready());
+    // 31 usable slots: the second batch only half fits and stays pending.
+    EXPECT_EQ(fx.tick(), OpStatus::Processed);
+    (void)fx.tick();
+    EXPECT_TRUE(fx.ready());
+    while (fx.ready() || !features.empty()) {
+        (void)fx.tick();
+        (void)op.tick();
+    }
+    EXPECT_EQ(m.events_processed.load(), book.size());
+    EXPECT_EQ(fx.extractor().ticks(), book.size());
+
+    FeatureExtractor ref;
+    std::size_t seq = 0;
+    for (int k = 0; k < 4; ++k) {
+        auto w = win.pop();
+        ASSERT_TRUE(w.has_value());
+        ASSERT_EQ(w->data.count, 16u);
+        EXPECT_EQ(w->data.first_seq, seq);
+        for (std::uint32_t j = 0; j < w->data.count; ++j, ++seq) {
+            const auto expect = ref.extract(book[seq]).to_point();
+            EXPECT_EQ(w->data.points[j].to_point(), expect) << "tick " << seq;
+        }
+    }
+    EXPECT_EQ(seq, book.size());
+}
+
+// Test 13: KeyedWindows_OnePerSymbolBehindPartition
+// Three symbols interleaved through a two-way partition: every window
+// holds one symbol's ticks only, in that symbol's seq order, and carries
+// the symbol through inference. Per-shard sizing: w_min = w_max fixes it.
+TEST(AdaptiveWindowTest, KeyedWindows_OnePerSymbolBehindPartition) {
+    const std::uint64_t syms[] = { symbol_key("AAPL"), symbol_key("MSFT"), symbol_key("INTC") };
+    SPSCQueue<Event<FeatureVector>> in(512);
+    std::vector<std::unique_ptr<SPSCQueue<Event<FeatureVector>>>> shard_in;
+    std::vector<std::unique_ptr<SPSCQueue<Event<WindowBatch>>>>   shard_win;
+    for (int s = 0; s < 2; ++s) {
+        shard_in.push_back(std::make_unique<SPSCQueue<Event<FeatureVector>>>(512));
+        shard_win.push_back(std::make_unique<SPSCQueue<Event<WindowBatch>>>(16));
+    }
+    PartitionOperator<FeatureVector> part("p", &in, { shard_in[0].get(), shard_in[1].get() });
+    part.set_batch_size(16);
+    std::vector<std::unique_ptr<KeyedAdaptiveWindowOp>> win;
+    for (int s = 0; s < 2; ++s) {
+        win.push_back(std::make_unique<KeyedAdaptiveWindowOp>(
+            "w" + std::to_string(s), shard_in[s].get(), shard_win[s].get(), 16, 16));
+    }
+
+    // 48 ticks per symbol, round-robin; seq counts per symbol.
+    for (std::uint64_t i = 0; i < 48; ++i) {
+        for (std::size_t k = 0; k < 3; ++k) {
+            ASSERT_TRUE(in.try_push(Event<FeatureVector>::make(fv(static_cast<float>(k)), syms[k], i)));
+        }
+    }
+    while (!in.empty()) (void)part.tick();
+    for (auto& w : win) while (w->ready()) (void)w->tick();
+    EXPECT_EQ(win[0]->symbols() + win[1]->symbols(), 3u);
+
+    auto forest = small_forest();
+    std::size_t windows = 0;
+    for (int s = 0; s < 2; ++s) {
+        SPSCQueue<Event<WindowBatch>>     one(4);
+        SPSCQueue<Event<DetectionResult>> out(4);
+        InferenceOp inf("i", &one, &out, &forest);
+        std::size_t next_first[3] = {};
+        while (auto w = shard_win[s]->pop()) {
+            const std::size_t k = std::find(std::begin(syms), std::end(syms), w->key) - std::begin(syms);
+            ASSERT_LT(k, 3u);
+            EXPECT_EQ(w->data.count, 16u);
+            EXPECT_EQ(w->data.first_seq, next_first[k]);
+            EXPECT_EQ(w->data.last_seq, next_first[k] + 15);
+            next_first[k] += 16;
+            for (std::uint32_t j = 0; j < w->data.count; ++j) {
+                EXPECT_EQ(w->data.points[j].log_return, static_cast<float>(k));
+            }
+            ASSERT_TRUE(one.try_push(*w));
+            ASSERT_EQ(inf.tick(), OpStatus::Processed);
+            EXPECT_EQ(out.pop()->key, syms[k]);
+            ++windows;
+        }
+    }
+    EXPECT_EQ(windows, 9u);
+    EXPECT_EQ(win[0]->windows_emitted() + win[1]->windows_emitted(), 9u);
+}
@@ -0,0 +1,294 @@
+#include <gtest/gtest.h>
+#include "klstream/core/checkpoint.hpp"
+#include "klstream/core/runtime.hpp"
+#include "klstream/operators/aggregate.hpp"
+#include "klstream/operators/map.hpp"
+#include "klstream/operators/sink.hpp"
+#include "klstream/operators/source.hpp"
+#include "klstream/window/batch_pool.hpp"
+#include "klstream/window/data_driven_window_op.hpp"
+#include "klstream/window/financial_tick_source.hpp"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace klstream;
+using namespace std::chrono;
+
+namespace {
+
+std::string temp_dir(const char* name) {
+    const std::string dir = ::testing::TempDir() + name;
+    std::filesystem::remove_all(dir);
+    return dir;
+}
+
+// source (value = seq, seqs 0.. up to `limit`) -> running sum -> sink.
+struct SumPipeline {
+    SPSCQueue<Event<std::uint64_t>> q_src{256}, q_out{256};
+    std::uint64_t next = 0;
+    std::uint64_t limit;
+    std::vector<Event<std::uint64_t>> out;
+    SourceOperator<std::uint64_t> source{ "src", &q_src, [this](Event<std::uint64_t>& ev, std::uint64_t) {
+        if (next >= limit) return false;
+        ev = Event<std::uint64_t>::make(next, 0, next);
+        ++next;
+        return true;
+    } };
+    AggregateOperator<std::uint64_t, std::uint64_t, std::uint64_t> sum{
+        "sum", &q_src, &q_out, 0ULL,
+        [](std::uint64_t& st, std::uint64_t x) { st += x; },
+        [](const std::uint64_t& st) { return st; } };
+    SinkOperator<std::uint64_t> sink{ "snk", &q_out, [this](const Event<std::uint64_t>& ev) {
+        if (limit != UINT64_MAX) out.push_back(ev);   // an endless run keeps nothing
+    } };
+
+    explicit SumPipeline(std::uint64_t n = UINT64_MAX) : limit(n) {
+        source.checkpoint_generator([this](StateWriter& w) { w.put(next); },
+                                    [this](StateReader& r) { next = r.get<std::uint64_t>(); });
+    }
+
+    void enroll(Checkpointer& c) {
+        c.add(&source);
+        c.add(&sum);
+    }
+
+    // One round over the operators; false once nothing moved.
+    bool round() {
+        bool moved = false;
+        for (IOperator* op : { static_cast<IOperator*>(&source), static_cast<IOperator*>(&sum),
+                               static_cast<IOperator*>(&sink) })
+            moved |= op->tick() == OpStatus::Processed;
+        return moved;
+    }
+};
+
+std::uint64_t state_word(const Checkpoint& c, const std::string& name, std::size_t word) {
+    const std::vector<char>* s = c.find(name);
+    if (!s || s->size() < (word + 1) * 8) return UINT64_MAX;
+    StateReader r(s->data() + word * 8, 8);
+    return r.get<std::uint64_t>();
+}
+
+} // namespace
+
+// Test 1: Running_CheckpointIsConsistentAtTheBarrier
+// Source and aggregate on different workers, checkpointed while running:
+// the saved sum is exactly the sum of the seqs before the barrier, and the
+// source's saved position is the barrier.
+TEST(CheckpointTest, Running_CheckpointIsConsistentAtTheBarrier) {
+    const std::string dir = temp_dir("klstream_ckpt_running");
+    SumPipeline p;
+    Checkpointer ckpt(dir);
+    p.enroll(ckpt);
+
+    Runtime rt;
+    rt.add_worker();
+    rt.add_worker();
+    rt.register_op(&p.source, 0);
+    rt.register_op(&p.sum, 1);
+    rt.register_op(&p.sink, 1);
+    rt.start();
+    std::this_thread::sleep_for(milliseconds(20));
+    ASSERT_TRUE(ckpt.request());
+    const bool written = ckpt.wait_written(1, seconds(10));
+    rt.stop();
+    ASSERT_TRUE(written);
+    EXPECT_EQ(ckpt.error(), "");
+
+    const auto c = Checkpointer::load_latest(dir);
+    ASSERT_TRUE(c.has_value());
+    EXPECT_EQ(c->epoch, 1u);
+    const std::uint64_t b = c->barrier_seq;
+    EXPECT_GT(b, 0u);
+    // Source state: SourceOperator's seq counter, next seq, then the generator's `next`.
+    EXPECT_EQ(state_word(*c, "src", 1), b);
+    EXPECT_EQ(state_word(*c, "src", 2), b);
+    EXPECT_EQ(state_word(*c, "sum", 0), b * (b - 1) / 2);
+}
+
+// Test 2: Restore_ResumesWhereTheCheckpointLeftOff
+// A checkpoint taken mid-stream and restored into a fresh pipeline: the
+// rest of the stream gives the same results and the same final state as
+// the run that was never interrupted.
+TEST(CheckpointTest, Restore_ResumesWhereTheCheckpointLeftOff) {
+    const std::string dir = temp_dir("klstream_ckpt_restore");
+    constexpr std::uint64_t N = 10000;
+
+    SumPipeline a(N);
+    Checkpointer ca(dir);
+    a.enroll(ca);
+    while (a.next < 3000) a.round();
+    ASSERT_TRUE(ca.request());
+    while (a.round()) {}
+    ASSERT_TRUE(ca.wait_written(1, seconds(10)));
+
+    const auto c = Checkpointer::load_latest(dir);
+    ASSERT_TRUE(c.has_value());
+    ASSERT_GE(c->barrier_seq, 3000u);
+    ASSERT_LT(c->barrier_seq, N);
+
+    SumPipeline b(N);
+    Checkpointer cb(temp_dir("klstream_ckpt_restore_b"));
+    b.enroll(cb);
+    cb.restore(*c);
+    EXPECT_EQ(b.next, c->barrier_seq);
+    while (b.round()) {}
+
+    EXPECT_EQ(b.sum.state(), a.sum.state());
+    EXPECT_EQ(b.sum.state(), N * (N - 1) / 2);
+    ASSERT_EQ(b.out.size(), N - c->barrier_seq);
+    for (const auto& ev : b.out) {
+        EXPECT_EQ(ev.data, a.out[ev.seq].data);
+        if (ev.data != a.out[ev.seq].data) break;
+    }
+    // Later checkpoints continue the numbering.
+    ASSERT_TRUE(cb.request());
+    EXPECT_EQ(cb.epoch(), c->epoch + 1);
+}
+
+// Test 3: Window_PartialWindowAndReplayPositionSurviveRestore
+// FinancialTickSource -> PooledDataDrivenWindowOp: a checkpoint in the
+// middle of a window. After restore the replay resumes at the barrier and
+// every window from the one the barrier fell in on matches the
+// uninterrupted run, points and all.
+TEST(CheckpointTest, Window_PartialWindowAndReplayPositionSurviveRestore) {
+    std::vector<TickRow> rows;
+    for (std::uint64_t i = 0; i < 5000; ++i) {
+        const float vol = 8.98e-09f + static_cast<float>(i % 37) * 1.6e-10f;
+        rows.push_back(TickRow{ i, 1000 + i * 10, 1e-4f * static_cast<float>(i % 11), vol,
+                                0.1f, 1.0f, static_cast<float>(i % 7), 0, 0 });
+    }
+    struct Run {
+        FinancialTickSource ticks;
+        SPSCQueue<Event<FeatureVector>> q_src{256};
+        SPSCQueue<Event<WindowHandle>>  q_win{8};
+        WindowBatchPool pool{ q_win.capacity() + 2 };
+        std::vector<WindowBatch> windows;
+        SourceOperator<FeatureVector> source{ "ticks", &q_src, [this](Event<FeatureVector>& ev, std::uint64_t s) {
+            return ticks.passes() == 0 && ticks(ev, s);
+        } };
+        PooledDataDrivenWindowOp window{ "window", &q_src, &q_win };
+        SinkOperator<WindowHandle> sink{ "snk", &q_win, [this](const Event<WindowHandle>& ev) {
+            windows.push_back(pool.at(ev.data.slot));
+            pool.release(ev.data.slot);
+        } };
+
+        explicit Run(const std::vector<TickRow>& r) : ticks(r, ReplayMode::MaxRate) {
+            window.attach_pool(&pool);
+            source.checkpoint_generator([this](StateWriter& w) { ticks.snapshot(w); },
+                                        [this](StateReader& in) { ticks.restore(in); });
+        }
+        bool round() {
+            bool moved = false;
+            for (IOperator* op : { static_cast<IOperator*>(&source), static_cast<IOperator*>(&window),
+                                   static_cast<IOperator*>(&sink) })
+                moved |= op->tick() == OpStatus::Processed;
+            return moved;
+        }
+    };
+
+    const std::string dir = temp_dir("klstream_ckpt_window");
+    Run a(rows);
+    Checkpointer ca(dir);
+    ca.add(&a.source);
+    ca.add(&a.window);
+    for (int i = 0; i < 2050; ++i) a.round();
+    ASSERT_TRUE(ca.request());
+    while (a.round()) {}
+    ASSERT_TRUE(ca.wait_written(1, seconds(10)));
+    const auto c = Checkpointer::load_latest(dir);
+    ASSERT_TRUE(c.has_value());
+
+    Run b(rows);
+    Checkpointer cb(temp_dir("klstream_ckpt_window_b"));
+    cb.add(&b.source);
+    cb.add(&b.window);
+    cb.restore(*c);
+    while (b.round()) {}
+
+    // The uninterrupted run's windows from the one holding the barrier on.
+    std::size_t first = 0;
+    while (first < a.windows.size() && a.windows[first].last_seq < c->barrier_seq) ++first;
+    ASSERT_LT(first, a.windows.size());
+    EXPECT_LT(a.windows[first].first_seq, c->barrier_seq);   // the barrier fell mid-window
+    ASSERT_EQ(b.windows.size(), a.windows.size() - first);
+    for (std::size_t i = 0; i < b.windows.size(); ++i) {
+        const WindowBatch& x = a.windows[first + i];
+        const WindowBatch& y = b.windows[i];
+        ASSERT_EQ(y.count, x.count) << "window " << i;
+        EXPECT_EQ(y.first_seq, x.first_seq);
+        EXPECT_EQ(y.last_seq, x.last_seq);
+        for (std::uint32_t k = 0; k < x.count; ++k) {
+            ASSERT_EQ(y.points[k].log_return, x.points[k].log_return);
+            ASSERT_EQ(y.points[k].volume, x.points[k].volume);
+        }
+    }
+}
+
+// Test 4: Request_OneAlignsAtATime_AndOldFilesArePruned
+TEST(CheckpointTest, Request_OneAlignsAtATime_AndOldFilesArePruned) {
+    const std::string dir = temp_dir("klstream_ckpt_prune");
+    SumPipeline p;
+    Checkpointer ckpt(dir, 2);
+    p.enroll(ckpt);
+
+    for (std::uint64_t e = 1; e <= 3; ++e) {
+        ASSERT_TRUE(ckpt.request());
+        EXPECT_FALSE(ckpt.request());   // still aligning: nothing has ticked
+        for (int i = 0; i < 100; ++i) p.round();
+        ASSERT_TRUE(ckpt.wait_written(e, seconds(10)));
+    }
+    const auto st = ckpt.stats();
+    EXPECT_EQ(st.requested, 3u);
+    EXPECT_EQ(st.refused, 3u);
+    EXPECT_EQ(st.written, 3u);
+
+    std::vector<std::string> files;
+    for (const auto& f : std::filesystem::directory_iterator(dir)) files.push_back(f.path().filename().string());
+    std::sort(files.begin(), files.end());
+    ASSERT_EQ(files.size(), 2u);
+    EXPECT_EQ(files[0], std::filesystem::path(Checkpointer::path_of(dir, 2)).filename().string());
+    EXPECT_EQ(Checkpointer::load_latest(dir)->epoch, 3u);
+}
+
+// Test 5: Add_RejectsStatelessAndDuplicateOperators
+TEST(CheckpointTest, Add_RejectsStatelessAndDuplicateOperators) {
+    Checkpointer ckpt(temp_dir("klstream_ckpt_reject"));
+    SPSCQueue<Event<std::uint64_t>> q_a(8), q_b(8);
+    MapOperator<std::uint64_t, std::uint64_t> map_op("map", &q_a, &q_b, [](std::uint64_t x) { return x; });
+    EXPECT_THROW(ckpt.add(&map_op), std::logic_error);
+
+    SourceOperator<std::uint64_t> plain("plain", &q_a, [](Event<std::uint64_t>&, std::uint64_t) { return false; });
+    EXPECT_THROW(ckpt.add(&plain), std::logic_error);   // no checkpoint_generator()
+
+    SumPipeline p;
+    p.enroll(ckpt);
+    SumPipeline q;
+    EXPECT_THROW(ckpt.add(&q.sum), std::logic_error);   // same name as p.sum
+}
+
+// Test 6: LoadLatest_SkipsADamagedNewestFile
+TEST(CheckpointTest, LoadLatest_SkipsADamagedNewestFile) {
+    const std::string dir = temp_dir("klstream_ckpt_damaged");
+    {
+        SumPipeline p(1000);
+        Checkpointer ckpt(dir);
+        p.enroll(ckpt);
+        for (int i = 0; i < 50; ++i) p.round();
+        ASSERT_TRUE(ckpt.request());
+        for (int i = 0; i < 50; ++i) p.round();
+        ASSERT_TRUE(ckpt.wait_written(1, seconds(10)));
+    }
+    {
+        std::ofstream out(Checkpointer::path_of(dir, 2), std::ios::binary);
+        out << "KLCK\x01";   // cut short mid-header
+    }
+    EXPECT_THROW(Checkpointer::load(Checkpointer::path_of(dir, 2)), std::runtime_error);
+    const auto c = Checkpointer::load_latest(dir);
+    ASSERT_TRUE(c.has_value());
+    EXPECT_EQ(c->epoch, 1u);
+    EXPECT_FALSE(Checkpointer::load_latest(temp_dir("klstream_ckpt_empty")).has_value());
+}
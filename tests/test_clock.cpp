@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include "klstream/core/clock.hpp"
+#include "klstream/core/event.hpp"
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+using namespace klstream;
+
+static std::uint64_t steady_now_ns() {
+    using namespace std::chrono;
+    return static_cast<std::uint64_t>(
+        duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+}
+
+// Clock::now_ns() read between two steady_clock reads, the narrowest of 16
+// tries: a try preempted between its reads is outbid. `steady` is the
+// bracket's midpoint, `width` its span.
+struct PairedRead { std::uint64_t clock, steady, width; };
+
+static PairedRead paired_read() {
+    PairedRead best{ 0, 0, ~0ULL };
+    for (int i = 0; i < 16; ++i) {
+        const std::uint64_t s0 = steady_now_ns();
+        const std::uint64_t c  = Clock::now_ns();
+        const std::uint64_t s1 = steady_now_ns();
+        if (s1 - s0 < best.width) best = { c, s0 + (s1 - s0) / 2, s1 - s0 };
+    }
+    return best;
+}
+
+// Test 1: NowIsMonotonicAndOnTheSteadyClockTimeline
+TEST(ClockTest, NowIsMonotonicAndOnTheSteadyClockTimeline) {
+    std::uint64_t prev = Clock::now_ns();
+    for (int i = 0; i < 100000; ++i) {
+        const std::uint64_t t = Clock::now_ns();
+        ASSERT_GE(t, prev);
+        prev = t;
+    }
+
+    // Values can be mixed with steady_clock: the anchor keeps the two
+    // within a few microseconds (allow 1 ms for a preempted sandbox).
+    const std::uint64_t s0 = steady_now_ns();
+    const std::uint64_t c  = Clock::now_ns();
+    const std::uint64_t s1 = steady_now_ns();
+    EXPECT_GE(c + 1'000'000, s0);
+    EXPECT_LE(c, s1 + 1'000'000);
+
+    const bool tsc = std::strcmp(Clock::source(), "tsc") == 0;
+    EXPECT_EQ(tsc, Clock::tick_hz() > 0.0);
+}
+
+// Test 2: TracksElapsedTime
+// Each end is a bracketed read, so preemption (during the sleep or between
+// reads) cannot skew the comparison: the two spans must agree to 0.1 %
+// plus the brackets' own widths.
+TEST(ClockTest, TracksElapsedTime) {
+    const PairedRead a = paired_read();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    const PairedRead b = paired_read();
+    const double clock_span  = static_cast<double>(b.clock - a.clock);
+    const double steady_span = static_cast<double>(b.steady - a.steady);
+    EXPECT_NEAR(clock_span, steady_span,
+                0.001 * steady_span + static_cast<double>(a.width + b.width));
+
+    const std::uint64_t k0 = Clock::coarse_ns();
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    const std::uint64_t k1 = Clock::coarse_ns();
+    EXPECT_GE(k1 - k0, 20'000'000u);
+    EXPECT_LE(k1 - k0, 1'000'000'000u);
+#if defined(__linux__)
+    EXPECT_GT(Clock::coarse_resolution_ns(), 0u);              // one scheduler tick
+    EXPECT_LE(Clock::coarse_resolution_ns(), 20'000'000u);
+#endif
+}
+
+// Test 3: EventLatencyUsesTheSameClock
+TEST(ClockTest, EventLatencyUsesTheSameClock) {
+    auto ev = IntEvent::make(1);
+    EXPECT_LE(ev.timestamp_ns, Clock::now_ns());
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    EXPECT_GE(ev.latency_ns(), 5'000'000u);
+    EXPECT_LT(ev.latency_ns(), 5'000'000'000u);
+}
@@ -0,0 +1,264 @@
+#include <gtest/gtest.h>
+#include "klstream/operators/graph.hpp"
+#include <atomic>
+#include <vector>
+
+using namespace klstream;
+using namespace std::chrono;
+
+namespace {
+
+// src -> flt -> map -> snk over uint64_t, counting what reaches the sink.
+struct Chain {
+    StreamGraphBuilder    g;
+    std::atomic<uint64_t> received{0};
+    std::atomic<bool>     in_order{true};
+    uint64_t              next = 1, last = 0;
+
+    explicit Chain(uint64_t n, double flt_cost = -1, double map_cost = -1) {
+        auto s = g.source<uint64_t>("src", [this, n](Event<uint64_t>& out, uint64_t) {
+                     if (next > n) return false;
+                     out = Event<uint64_t>::make(next++);
+                     return true;
+                 })
+                  .filter("flt", [](uint64_t x) { return x % 4 == 0; });
+        if (flt_cost > 0) s.hint(flt_cost, 0.25);
+        auto m = s.map<uint64_t>("map", [](uint64_t x) { return x / 4; });
+        if (map_cost > 0) m.hint(map_cost);
+        m.sink("snk", [this](const Event<uint64_t>& ev) {
+            if (ev.data != last + 1) in_order = false;
+            last = ev.data;
+            received++;
+        });
+    }
+};
+
+} // namespace
+
+// Test 1: Plan_BalancesLoadAndSizesCrossWorkerQueues
+TEST(GraphTest, Plan_BalancesLoadAndSizesCrossWorkerQueues) {
+    Chain c(0, /*flt_cost=*/10, /*map_cost=*/400);
+    PlanOptions o;
+    o.workers     = 2;
+    o.source_rate = 4e6;
+    const GraphPlan p = c.g.plan(o);
+
+    ASSERT_EQ(p.nodes.size(), 4u);
+    ASSERT_EQ(p.edges.size(), 3u);
+    // Loads: src 0.2, flt 0.04, map 1e6 * 400ns = 0.4, snk 0.05.
+    EXPECT_DOUBLE_EQ(p.nodes[2].in_rate, 1e6);
+    EXPECT_NEAR(p.nodes[2].load, 0.4, 1e-9);
+    // Cheapest bottleneck: {src, flt} | {map, snk}.
+    EXPECT_EQ(p.nodes[0].worker, 0);
+    EXPECT_EQ(p.nodes[1].worker, 0);
+    EXPECT_EQ(p.nodes[2].worker, 1);
+    EXPECT_EQ(p.nodes[3].worker, 1);
+    EXPECT_NEAR(p.bottleneck(), 0.45, 1e-9);
+
+    EXPECT_TRUE(p.edges[0].local);
+    EXPECT_EQ(p.edges[0].capacity, o.min_capacity);
+    EXPECT_FALSE(p.edges[1].local);
+    EXPECT_EQ(p.edges[1].capacity, 1024u);   // 1e6 ev/s for 1 ms, rounded up
+    EXPECT_EQ(p.edges[1].bytes, 1024u * sizeof(Event<uint64_t>));
+    EXPECT_NE(p.describe().find("flt -> map  cross  1024"), std::string::npos);
+
+    o.max_queue_bytes = 256 * sizeof(Event<uint64_t>);
+    EXPECT_EQ(c.g.plan(o).edges[1].capacity, 256u);
+}
+
+// Test 2: Plan_ObservedRatesOverrideHints
+TEST(GraphTest, Plan_ObservedRatesOverrideHints) {
+    Chain c(0);
+    PlanOptions o;
+    o.workers     = 1;
+    o.source_rate = 1e6;
+    EXPECT_DOUBLE_EQ(c.g.plan(o).nodes[2].in_rate, 1e6);   // filter assumed to pass all
+
+    o.observed_rates = { { "src", 2e6 }, { "flt", 2e6 }, { "map", 5e5 } };
+    const GraphPlan p = c.g.plan(o);
+    EXPECT_DOUBLE_EQ(p.nodes[0].in_rate, 2e6);
+    EXPECT_DOUBLE_EQ(p.nodes[2].in_rate, 5e5);
+    EXPECT_DOUBLE_EQ(p.edges[1].rate, 5e5);
+    EXPECT_DOUBLE_EQ(p.nodes[3].in_rate, 5e5);   // propagated from map
+}
+
+// Test 3: Build_RunsAndReportsObservedRates
+TEST(GraphTest, Build_RunsAndReportsObservedRates) {
+    constexpr uint64_t N = 100000;
+    Chain c(N);
+    PlanOptions o;
+    o.workers    = 2;
+    o.batch_size = DEFAULT_BATCH_SIZE;
+
+    Runtime rt;
+    auto graph = c.g.build(rt, o, /*report=*/false);
+    EXPECT_EQ(rt.n_workers(), 2u);
+    ASSERT_NE(graph->op("map"), nullptr);
+    EXPECT_EQ(graph->op("nope"), nullptr);
+
+    const auto t0 = steady_clock::now();
+    rt.start();
+    const auto deadline = t0 + seconds(20);
+    while (c.received.load() < N / 4 && steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(milliseconds(5));
+    }
+    rt.stop();
+
+    EXPECT_EQ(c.received.load(), N / 4);
+    EXPECT_TRUE(c.in_order.load());
+    EXPECT_EQ(graph->metrics("flt")->events_processed.load(), N);
+    const auto rates = graph->observed_rates(steady_clock::now() - t0);
+    EXPECT_GT(rates.at("flt"), 0.0);
+    EXPECT_NEAR(rates.at("map") / rates.at("flt"), 0.25, 1e-9);
+}
+
+// Test 4: ParallelMap_SpreadsReplicasAndPreservesOrder
+TEST(GraphTest, ParallelMap_SpreadsReplicasAndPreservesOrder) {
+    constexpr uint64_t N = 50000;
+    StreamGraphBuilder g;
+    uint64_t next = 1;
+    std::atomic<uint64_t> received{0};
+    std::atomic<bool>     in_order{true};
+    uint64_t last = 0;
+    g.source<uint64_t>("src", [&next](Event<uint64_t>& out, uint64_t) {
+         if (next > N) return false;
+         out = Event<uint64_t>::make(next++);
+         return true;
+     })
+     .parallel_map<uint64_t>("sq", 3, [](uint64_t x) { return x * 2; })
+     .hint(1000)
+     .sink("snk", [&](const Event<uint64_t>& ev) {
+         if (ev.data != last + 2) in_order = false;
+         last = ev.data;
+         received++;
+     });
+
+    PlanOptions o;
+    o.workers = 3;
+    const GraphPlan p = g.plan(o);
+    ASSERT_EQ(p.nodes.size(), 7u);   // src, fanout, 3 replicas, merge, snk
+    EXPECT_EQ(p.nodes[2].name, "sq[0]");
+    EXPECT_NEAR(p.nodes[2].in_rate, 1e6 / 3, 1e-6);
+    EXPECT_NE(p.nodes[2].worker, p.nodes[4].worker);   // the heavy replicas split up
+
+    Runtime rt;
+    auto graph = g.build(rt, p);
+    rt.start();
+    const auto deadline = steady_clock::now() + seconds(20);
+    while (received.load() < N && steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(milliseconds(5));
+    }
+    rt.stop();
+    EXPECT_EQ(received.load(), N);
+    EXPECT_TRUE(in_order.load());
+}
+
+// Test 5: Builder_RejectsMisuse
+TEST(GraphTest, Builder_RejectsMisuse) {
+    StreamGraphBuilder g;
+    auto src = g.source<uint64_t>("src", [](Event<uint64_t>&, uint64_t) { return false; });
+    auto flt = src.filter("flt", [](uint64_t) { return true; });
+    EXPECT_THROW(src.filter("flt2", [](uint64_t) { return true; }), std::logic_error);
+    EXPECT_THROW(flt.map<uint64_t>("src", [](uint64_t x) { return x; }), std::invalid_argument);
+
+    Runtime rt;
+    EXPECT_THROW(g.build(rt), std::logic_error);   // flt has no consumer
+    flt.sink("snk", [](const Event<uint64_t>&) {});
+    std::unique_ptr<StreamGraph> graph;
+    EXPECT_NO_THROW(graph = g.build(rt));
+}
+
+// Test 6: KeyedAggregate_PartitionsKeysOverReplicas
+TEST(GraphTest, KeyedAggregate_PartitionsKeysOverReplicas) {
+    constexpr uint64_t N = 40000, KEYS = 10;
+    StreamGraphBuilder g;
+    uint64_t next = 0;
+    std::atomic<uint64_t> received{0};
+    std::atomic<bool>     monotonic{true};
+    std::vector<uint64_t> last(KEYS, 0);
+    g.source<uint64_t>("src", [&next](Event<uint64_t>& out, uint64_t) {
+         if (next >= N) return false;
+         out = Event<uint64_t>::make(next++);
+         return true;
+     })
+     .keyed_aggregate<uint64_t, uint64_t>("cnt", 3, 0ULL,
+         [](uint64_t& n, const uint64_t&) { ++n; },
+         [](const uint64_t& n) { return n; },
+         [](const uint64_t& x) { return x % KEYS; })
+     .hint(500)
+     .sink("snk", [&](const Event<uint64_t>& ev) {
+         // Per-key order survives the partition -> replicas -> merge hop.
+         if (ev.data != last[ev.key] + 1) monotonic = false;
+         last[ev.key] = ev.data;
+         received++;
+     });
+
+    PlanOptions o;
+    o.workers    = 3;
+    o.batch_size = 16;
+    const GraphPlan p = g.plan(o);
+    ASSERT_EQ(p.nodes.size(), 7u);   // src, partition, 3 replicas, merge, snk
+    EXPECT_EQ(p.nodes[1].name, "cnt.partition");
+    EXPECT_EQ(p.nodes[3].name, "cnt[1]");
+    EXPECT_EQ(p.nodes[5].name, "cnt.merge");
+    EXPECT_NEAR(p.nodes[2].in_rate, 1e6 / 3, 1e-6);
+
+    Runtime rt;
+    auto graph = g.build(rt, p);
+    rt.start();
+    const auto deadline = steady_clock::now() + seconds(20);
+    while (received.load() < N && steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(milliseconds(5));
+    }
+    rt.stop();
+    EXPECT_EQ(received.load(), N);
+    EXPECT_TRUE(monotonic.load());
+    for (uint64_t k = 0; k < KEYS; ++k) EXPECT_EQ(last[k], N / KEYS);
+
+    // Each key lives in exactly one replica.
+    std::size_t keys = 0;
+    for (int r = 0; r < 3; ++r) {
+        auto* op = dynamic_cast<KeyedAggregateOperator<uint64_t, uint64_t, uint64_t>*>(
+            graph->op("cnt[" + std::to_string(r) + "]"));
+        ASSERT_NE(op, nullptr);
+        keys += op->keys();
+    }
+    EXPECT_EQ(keys, KEYS);
+}
+
+// Test 7: RateLimit_SourceWatchesEveryDownstreamQueue
+TEST(GraphTest, RateLimit_SourceWatchesEveryDownstreamQueue) {
+    constexpr uint64_t N = 20000;
+    StreamGraphBuilder g;
+    uint64_t next = 1;
+    std::atomic<uint64_t> received{0};
+    auto src = g.source<uint64_t>("src", [&next](Event<uint64_t>& out, uint64_t) {
+        if (next > N) return false;
+        out = Event<uint64_t>::make(next++);
+        return true;
+    });
+    auto flt = src.rate_limit(5e5).filter("flt", [](uint64_t) { return true; });
+    EXPECT_THROW(flt.rate_limit(1e3), std::logic_error);
+    flt.map<uint64_t>("map", [](uint64_t x) { return x; })
+       .sink("snk", [&received](const Event<uint64_t>&) { received++; });
+
+    PlanOptions o;
+    o.workers = 2;
+    const GraphPlan p = g.plan(o);
+    EXPECT_DOUBLE_EQ(p.nodes[0].in_rate, 5e5);   // capped below source_rate
+
+    Runtime rt;
+    auto graph = g.build(rt, p, /*report=*/false);
+    auto* s = dynamic_cast<SourceOperator<uint64_t>*>(graph->op("src"));
+    ASSERT_NE(s, nullptr);
+    ASSERT_NE(s->flow_control(), nullptr);
+    EXPECT_EQ(s->flow_control()->watched(), 3u);   // src->flt, flt->map, map->snk
+
+    rt.start();
+    const auto deadline = steady_clock::now() + seconds(20);
+    while (received.load() < N && steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(milliseconds(5));
+    }
+    rt.stop();
+    EXPECT_EQ(received.load(), N);
+}
@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+#include "klstream/core/histogram.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace klstream;
+
+// Test 1: LayoutBoundsEveryValueWithinPrecision
+TEST(HistogramTest, LayoutBoundsEveryValueWithinPrecision) {
+    for (unsigned p : { 1u, 6u, 10u }) {
+        HistogramLayout l(p);
+        std::size_t prev = 0;
+        for (std::uint64_t v = 0; v < 100000; ++v) {
+            const std::size_t i = l.index_of(v);
+            ASSERT_GE(i, prev);                      // monotonic in v
+            ASSERT_LE(l.lowest(i), v);
+            ASSERT_GE(l.highest(i), v);
+            prev = i;
+        }
+        std::mt19937_64 rng(p);
+        for (int k = 0; k < 100000; ++k) {
+            const std::uint64_t v = rng() >> (rng() % 40 + 22);   // ns .. ~hours
+            const std::size_t   i = l.index_of(v);
+            ASSERT_LE(l.lowest(i), v);
+            ASSERT_GE(l.highest(i), v);
+            ASSERT_LE(static_cast<double>(l.highest(i) - l.lowest(i)),
+                      static_cast<double>(v) / static_cast<double>(1u << p) + 1.0);
+            ASSERT_EQ(l.index_of(l.lowest(i)), i);
+            ASSERT_EQ(l.index_of(l.highest(i)), i);
+        }
+        EXPECT_EQ(l.index_of(~std::uint64_t{0}), l.bucket_count() - 1);
+        EXPECT_EQ(l.index_of(l.highest(l.bucket_count() - 1)), l.bucket_count() - 1);
+    }
+    EXPECT_THROW(HistogramLayout(0), std::invalid_argument);
+    EXPECT_THROW(HistogramLayout(17), std::invalid_argument);
+}
+
+// Test 2: PercentilesMatchSortedDataPastTenMilliseconds
+TEST(HistogramTest, PercentilesMatchSortedDataPastTenMilliseconds) {
+    LatencyHistogram h;
+    std::vector<std::uint64_t> values;
+    std::mt19937_64 rng(42);
+    std::lognormal_distribution<double> dist(11.0, 2.0);   // median ~60 us, tail into seconds
+    for (int i = 0; i < 200000; ++i) {
+        const auto v = static_cast<std::uint64_t>(dist(rng));
+        values.push_back(v);
+        h.record(v);
+    }
+    values.push_back(90'000'000'000ULL);                  // one 90 s stall
+    h.record(values.back());
+    std::sort(values.begin(), values.end());
+
+    const double tol = 1.0 / (1u << HISTOGRAM_PRECISION_BITS);
+    for (double q : { 0.5, 0.9, 0.99, 0.999, 0.9999 }) {
+        const std::uint64_t exact = values[HistogramSnapshot::rank(q, values.size()) - 1];
+        const std::uint64_t got   = h.value_at(q);
+        EXPECT_GE(got, exact) << q;
+        EXPECT_LE(static_cast<double>(got), static_cast<double>(exact) * (1.0 + tol) + 1.0) << q;
+    }
+    EXPECT_GT(h.value_at(0.999), 10'000'000u);            // the old histogram capped this at 10 ms
+    EXPECT_EQ(h.value_at(1.0), 90'000'000'000ULL);
+    EXPECT_DOUBLE_EQ(h.percentile(0.5), static_cast<double>(h.value_at(0.5)) / 1000.0);
+
+    const HistogramSnapshot s = h.snapshot();
+    EXPECT_EQ(s.count(), values.size());
+    EXPECT_EQ(s.min_ns(), values.front());
+    EXPECT_EQ(s.max_ns(), values.back());
+    EXPECT_EQ(s.value_at(0.99), h.value_at(0.99));
+}
+
+// Test 3: PerThreadHistogramsMergeIntoOneSnapshot
+TEST(HistogramTest, PerThreadHistogramsMergeIntoOneSnapshot) {
+    constexpr int N = 100000;
+    LatencyHistogram a, b;
+    std::thread ta([&] { for (int i = 0; i < N; ++i) a.record(1000); });
+    std::thread tb([&] { for (int i = 0; i < N; ++i) b.record(50'000'000); });
+    ta.join();
+    tb.join();
+
+    HistogramSnapshot merged;
+    merged.merge(a.snapshot()).merge(b.snapshot());
+    EXPECT_EQ(merged.count(), 2u * N);
+    EXPECT_EQ(merged.min_ns(), 1000u);
+    EXPECT_EQ(merged.max_ns(), 50'000'000u);
+    EXPECT_EQ(merged.value_at(0.5), merged.layout().highest(merged.layout().index_of(1000)));
+    EXPECT_EQ(merged.value_at(0.51), 50'000'000u);
+    EXPECT_DOUBLE_EQ(merged.mean_ns(), (1000.0 + 50'000'000.0) / 2);
+
+    HistogramSnapshot coarse(4);
+    EXPECT_THROW(merged.merge(coarse), std::invalid_argument);
+    EXPECT_EQ(HistogramSnapshot().value_at(0.99), 0u);
+}
+
+TEST(HistogramTest, SinceGivesTheIntervalBetweenSnapshots) {
+    LatencyHistogram h;
+    for (int i = 0; i < 1000; ++i) h.record(1000);
+    const HistogramSnapshot before = h.snapshot();
+    for (int i = 0; i < 100; ++i) h.record(2'000'000);
+
+    const HistogramSnapshot d = h.snapshot().since(before);
+    EXPECT_EQ(d.count(), 100u);
+    EXPECT_EQ(d.max_ns(), 2'000'000u);
+    EXPECT_NEAR(static_cast<double>(d.value_at(0.01)), 2e6, 2e6 * 0.02);   // none of the old 1 µs values
+    EXPECT_DOUBLE_EQ(d.mean_ns(), 2e6);
+    EXPECT_EQ(before.since(before).count(), 0u);
+    EXPECT_THROW(d.since(HistogramSnapshot(4)), std::invalid_argument);
+}
@@ -0,0 +1,238 @@
+#include <gtest/gtest.h>
+#include "klstream/model/isolation_forest.hpp"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <vector>
+
+using namespace klstream;
+
+namespace {
+
+using Forest = IsolationForest<5>;
+using Point  = Forest::Point;
+
+std::vector<Point> gaussian_points(std::size_t n, std::uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> d(0.0f, 1.0f);
+    std::vector<Point> pts(n);
+    for (auto& p : pts)
+        for (auto& v : p) v = d(rng);
+    return pts;
+}
+
+// Reference: the original per-tree walk over IsolationTree::Node, with the
+// same 2^x normalisation as the flat layout.
+double reference_score(const std::vector<IsolationTree<5>>& trees, double c_psi,
+                       const Point& x) {
+    double total = 0.0;
+    for (const auto& t : trees) total += t.path_length(x);
+    return std::exp2(-(total / static_cast<double>(trees.size())) / c_psi);
+}
+
+} // namespace
+
+// Test 1: ScoreBatch_BitIdenticalToScalar
+TEST(IsolationForestTest, ScoreBatch_BitIdenticalToScalar) {
+    Forest forest(50, 128, 3);
+    forest.fit(gaussian_points(2000, 1));
+
+    // 77 = 9 full 8-lane blocks + a 5-point scalar tail.
+    auto queries = gaussian_points(77, 2);
+    queries[10] = { 6.0f, -6.0f, 6.0f, -6.0f, 6.0f };   // obvious outlier
+    queries[76][2] = std::numeric_limits<float>::quiet_NaN();
+
+    std::vector<double> batch(queries.size());
+    forest.score_batch(queries.data(), queries.size(), batch.data());
+    for (std::size_t i = 0; i < queries.size(); ++i) {
+        EXPECT_EQ(batch[i], forest.anomaly_score(queries[i])) << "point " << i;
+    }
+    EXPECT_GT(batch[10], 0.6);
+}
+
+// Test 2: FlatLayout_MatchesTreeWalk
+TEST(IsolationForestTest, FlatLayout_MatchesTreeWalk) {
+    std::mt19937 rng(9);
+    auto train = gaussian_points(512, 4);
+    std::vector<IsolationTree<5>> trees(10);
+    for (auto& t : trees) t.build(train, 8, rng);
+    const double c_psi = IsolationTree<5>::c_factor(512);
+
+    FlatForest<5> flat;
+    flat.build(trees, c_psi);
+    auto queries = gaussian_points(64, 5);
+    std::vector<double> out(queries.size());
+    flat.score_batch(queries.data(), queries.size(), out.data());
+    for (std::size_t i = 0; i < queries.size(); ++i) {
+        EXPECT_EQ(out[i], reference_score(trees, c_psi, queries[i]));
+    }
+}
+
+// Test 3: SaveLoad_PreservesScores
+TEST(IsolationForestTest, SaveLoad_PreservesScores) {
+    Forest forest(20, 64, 11);
+    forest.fit(gaussian_points(500, 6));
+    std::stringstream buf;
+    forest.save(buf);
+
+    Forest loaded(0, 0);
+    loaded.load(buf);
+    auto queries = gaussian_points(32, 7);
+    std::vector<double> a(32), b(32);
+    forest.score_batch(queries.data(), 32, a.data());
+    loaded.score_batch(queries.data(), 32, b.data());
+    EXPECT_EQ(a, b);
+}
+
+// Test 4: ScoreMax_ExactWithoutThreshold
+TEST(IsolationForestTest, ScoreMax_ExactWithoutThreshold) {
+    Forest forest(100, 256, 5);
+    forest.fit(gaussian_points(4000, 8));
+
+    std::vector<double>        sums(256);
+    std::vector<std::uint32_t> live(256);
+    std::uint64_t skipped = 0;
+    for (std::uint32_t seed = 0; seed < 20; ++seed) {
+        const std::size_t n = 13 + 11 * seed;
+        auto pts = gaussian_points(n, 100 + seed);
+        if (seed % 3 == 0) pts[n / 2] = { 5.0f, 5.0f, -5.0f, 5.0f, 5.0f };
+        if (seed % 4 == 1) pts[n - 1] = pts[0];   // exact tie: first index wins
+
+        std::vector<double> full(n);
+        forest.score_batch(pts.data(), n, full.data());
+        double best = -1.0;
+        std::uint32_t best_idx = 0;
+        for (std::uint32_t i = 0; i < n; ++i)
+            if (full[i] > best) { best = full[i]; best_idx = i; }
+
+        auto r = forest.score_max(pts.data(), n, 0.0, sums.data(), live.data());
+        EXPECT_EQ(r.score, best) << "seed " << seed;
+        EXPECT_EQ(r.index, best_idx) << "seed " << seed;
+        skipped += r.trees_skipped;
+    }
+    EXPECT_GT(skipped, 0u);
+}
+
+// Test 5: ScoreMax_ThresholdDecidesAlertExactly
+TEST(IsolationForestTest, ScoreMax_ThresholdDecidesAlertExactly) {
+    Forest forest(100, 256, 5);
+    forest.fit(gaussian_points(4000, 9));
+    constexpr double THR = 0.6;
+
+    std::vector<double>        sums(128);
+    std::vector<std::uint32_t> live(128);
+    std::uint64_t skipped = 0, total = 0;
+    int alerts = 0;
+    for (std::uint32_t seed = 0; seed < 30; ++seed) {
+        auto pts = gaussian_points(128, 200 + seed);
+        if (seed % 5 == 0) pts[seed] = { 7.0f, -7.0f, 7.0f, 7.0f, -7.0f };
+
+        std::vector<double> full(pts.size());
+        forest.score_batch(pts.data(), pts.size(), full.data());
+        double best = -1.0;
+        std::uint32_t best_idx = 0;
+        for (std::uint32_t i = 0; i < pts.size(); ++i)
+            if (full[i] > best) { best = full[i]; best_idx = i; }
+
+        auto r = forest.score_max(pts.data(), pts.size(), THR, sums.data(), live.data());
+        EXPECT_EQ(r.score >= THR, best >= THR) << "seed " << seed;
+        if (best >= THR) {
+            ++alerts;
+            EXPECT_EQ(r.score, best);
+            EXPECT_EQ(r.index, best_idx);
+        } else {
+            EXPECT_GE(r.score, best);   // an upper bound, never an under-report
+        }
+        skipped += r.trees_skipped;
+        total   += pts.size() * forest.n_trees();
+    }
+    EXPECT_GE(alerts, 6);            // every injected outlier, plus any tail windows
+    EXPECT_LT(alerts, 30);
+    EXPECT_GT(skipped, total / 4);   // calm windows are mostly cut short
+}
+
+// Test 6: FlatFile_RoundTripAndMap
+TEST(IsolationForestTest, FlatFile_RoundTripAndMap) {
+    Forest forest(30, 128, 13);
+    forest.fit(gaussian_points(1000, 10));
+    auto queries = gaussian_points(40, 11);
+
+    std::stringstream buf;
+    forest.save_flat(buf);
+    Forest loaded(0, 0);
+    loaded.load_flat(buf);
+
+    const std::string path = ::testing::TempDir() + "klstream_flat_forest.bin";
+    {
+        std::ofstream out(path, std::ios::binary);
+        forest.save_flat(out);
+    }
+    Forest mapped(0, 0);
+    mapped.map_flat(path);
+    EXPECT_EQ(mapped.n_trees(), 30u);
+
+    for (const auto& q : queries) {
+        EXPECT_EQ(loaded.anomaly_score(q), forest.anomaly_score(q));
+        EXPECT_EQ(mapped.anomaly_score(q), forest.anomaly_score(q));
+    }
+    std::stringstream legacy;
+    EXPECT_THROW(mapped.save(legacy), std::logic_error);
+    std::remove(path.c_str());
+}
+
+// Test 7: FlatFile_RejectsCorruption
+TEST(IsolationForestTest, FlatFile_RejectsCorruption) {
+    Forest forest(5, 32, 2);
+    forest.fit(gaussian_points(200, 12));
+    std::stringstream buf;
+    forest.save_flat(buf);
+    const std::string good = buf.str();
+
+    auto load = [](std::string bytes) {
+        std::stringstream in(bytes);
+        Forest f(0, 0);
+        f.load_flat(in);
+    };
+    EXPECT_NO_THROW(load(good));
+    EXPECT_THROW(load(good.substr(0, good.size() - 1)), std::runtime_error);   // truncated
+
+    std::string bad_version = good;
+    bad_version[8] = 9;
+    EXPECT_THROW(load(bad_version), std::runtime_error);
+
+    // Point the root's left child of tree 0 back at itself: must be caught
+    // at load time, not loop forever while scoring.
+    FlatForestHeader h;
+    std::memcpy(&h, good.data(), sizeof(h));
+    std::string cycle = good;
+    cycle[h.offset[FlatForestHeader::CHILD]]     = 0;
+    cycle[h.offset[FlatForestHeader::CHILD] + 1] = 0;
+    EXPECT_THROW(load(cycle), std::runtime_error);
+}
+
+// Test 8: Fit_DeterministicAcrossThreadCounts
+TEST(IsolationForestTest, Fit_DeterministicAcrossThreadCounts) {
+    const auto train = gaussian_points(20000, 14);
+    Forest serial(40, 256, 77), parallel(40, 256, 77), other_seed(40, 256, 78);
+    serial.fit(train, 1);
+    parallel.fit(train, 4);
+    other_seed.fit(train, 4);
+
+    std::stringstream a, b;
+    serial.save_flat(a);
+    parallel.save_flat(b);
+    EXPECT_EQ(a.str(), b.str());   // byte-identical forests
+
+    auto queries = gaussian_points(32, 15);
+    int differ = 0;
+    for (const auto& q : queries) differ += serial.anomaly_score(q) != other_seed.anomaly_score(q);
+    EXPECT_GT(differ, 0);
+
+    // Still a working detector after the sampler/partitioner rewrite.
+    const Point outlier{ 6.0f, -6.0f, 6.0f, -6.0f, 6.0f };
+    EXPECT_GT(parallel.anomaly_score(outlier), 0.65);
+    EXPECT_LT(parallel.anomaly_score(Point{}), 0.5);
+}
@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+#include "klstream/core/keyed_state.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace klstream;
+
+// Test 1: InsertFindAndInsertionOrder
+TEST(KeyedStateTest, InsertFindAndInsertionOrder) {
+    KeyedStateStore<uint64_t> s;
+    EXPECT_TRUE(s.empty());
+    EXPECT_EQ(s.find(7), nullptr);
+
+    const uint64_t keys[] = { 42, 7, 1ULL << 40, 0, 7, 42, 42 };
+    for (uint64_t k : keys) s[k] += 1;
+    EXPECT_EQ(s.size(), 4u);
+    EXPECT_EQ(*s.find(42), 3u);
+    EXPECT_EQ(*s.find(7), 2u);
+    EXPECT_TRUE(s.contains(0));
+    EXPECT_FALSE(s.contains(1));
+    EXPECT_EQ(s.get_or_insert(9, 100), 100u);
+    EXPECT_EQ(s.get_or_insert(9, 5), 100u);   // init only used on insert
+
+    std::vector<uint64_t> order;
+    for (const auto& e : s) order.push_back(e.key);
+    EXPECT_EQ(order, (std::vector<uint64_t>{ 42, 7, 1ULL << 40, 0, 9 }));
+}
+
+// Test 2: GrowsAndKeepsEveryKey
+TEST(KeyedStateTest, GrowsAndKeepsEveryKey) {
+    KeyedStateStore<std::string> s(4);
+    const std::size_t slots0 = s.slot_count();
+    constexpr uint64_t N = 10000;
+    for (uint64_t k = 0; k < N; ++k) s.get_or_insert(k * 1000003, std::to_string(k));
+    EXPECT_EQ(s.size(), N);
+    EXPECT_GT(s.slot_count(), slots0);
+    EXPECT_LE(s.size() * 4, s.slot_count() * 3);   // load factor bound
+    EXPECT_EQ((s.slot_count() & (s.slot_count() - 1)), 0u);
+    for (uint64_t k = 0; k < N; ++k) {
+        const std::string* v = s.find(k * 1000003);
+        ASSERT_NE(v, nullptr);
+        EXPECT_EQ(*v, std::to_string(k));
+    }
+    EXPECT_EQ(s.find(1), nullptr);
+}
+
+// Test 3: ClearReusesStorage
+TEST(KeyedStateTest, ClearReusesStorage) {
+    KeyedStateStore<uint64_t> s;
+    s.reserve(100);
+    const std::size_t slots = s.slot_count();
+    for (int window = 0; window < 5; ++window) {
+        for (uint64_t k = 0; k < 100; ++k) s[k % 37] += k;
+        EXPECT_EQ(s.size(), 37u);
+        const uint64_t* first = &s.begin()->value;
+        s.clear();
+        EXPECT_TRUE(s.empty());
+        EXPECT_EQ(s.find(3), nullptr);
+        s[5] = 1;
+        EXPECT_EQ(&s.begin()->value, first);   // same arena, no reallocation
+        EXPECT_EQ(*s.find(5), 1u);
+        s.clear();
+    }
+    EXPECT_EQ(s.slot_count(), slots);
+}
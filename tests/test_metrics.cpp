@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+#include "klstream/core/metrics.hpp"
+#include "klstream/core/metrics_export.hpp"
+#include "klstream/core/spsc_queue.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+
+using namespace klstream;
+
+// Test 1: LocalCounterPublishesEveryUpdateToReaders
+TEST(MetricsTest, LocalCounterPublishesEveryUpdateToReaders) {
+    constexpr std::uint64_t N = 1'000'000;
+    OperatorMetrics m("op");
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(&m) % CACHE_LINE_SIZE, 0u);
+
+    std::atomic<bool> done{false};
+    std::thread writer([&] {
+        for (std::uint64_t i = 0; i < N; ++i) m.events_processed.increment();
+        m.events_idle.add(5);
+        done.store(true, std::memory_order_release);
+    });
+    std::uint64_t last = 0;
+    while (!done.load(std::memory_order_acquire)) {
+        const std::uint64_t v = m.events_processed.load();
+        ASSERT_GE(v, last);                                 // never torn or going back
+        last = v;
+    }
+    writer.join();
+    EXPECT_EQ(m.events_processed.load(), N);
+    EXPECT_EQ(m.events_idle.load(), 5u);
+    EXPECT_EQ(m.events_blocked.load(), 0u);
+}
+
+// Test 2: ReporterRatesComeFromDeltasWithoutResetting
+TEST(MetricsTest, ReporterRatesComeFromDeltasWithoutResetting) {
+    OperatorMetrics a("a"), b("b");
+    a.events_processed.add(1000);                           // before add(): not counted
+    MetricsReporter r;
+    r.add(&a);
+    r.add(&b);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    a.events_processed.add(500);
+    b.events_blocked.add(7);
+    auto s1 = r.sample();
+    ASSERT_EQ(s1.size(), 2u);
+    EXPECT_EQ(s1[0].metrics, &a);
+    EXPECT_EQ(s1[0].processed_total, 1500u);
+    EXPECT_GT(s1[0].processed_per_sec, 0.0);
+    EXPECT_LT(s1[0].processed_per_sec, 500.0 / 0.020 * 1.01);
+    EXPECT_GT(s1[1].blocked_per_sec, 0.0);
+    EXPECT_EQ(s1[1].processed_per_sec, 0.0);
+
+    auto s2 = r.sample();                                   // nothing since s1
+    EXPECT_EQ(s2[0].processed_per_sec, 0.0);
+    EXPECT_EQ(s2[1].blocked_per_sec, 0.0);
+    EXPECT_EQ(a.events_processed.load(), 1500u);            // counters untouched
+    EXPECT_EQ(b.events_blocked.load(), 7u);
+}
+
+// Test 3: SnapshotCoversQueuesHistogramsAndWorkers
+TEST(MetricsTest, SnapshotCoversQueuesHistogramsAndWorkers) {
+    OperatorMetrics  op("map \"sq\"");
+    SPSCQueue<int>   q(64);
+    LatencyHistogram h;
+    WorkerStats      w;
+    MetricsReporter  r;
+    r.add(&op);
+    r.add_queue("src->map", &q);
+    r.add_histogram("e2e", &h);
+    r.add_worker(&w);
+
+    for (int i = 0; i < 16; ++i) ASSERT_TRUE(q.try_push(i));
+    for (int i = 1; i <= 100; ++i) h.record(static_cast<std::uint64_t>(i) * 1000);
+    h.record(20'000'000);                                   // one 20 ms outlier
+    op.events_processed.add(42);
+    op.events_shed.add(7);
+    w.busy_ns.add(300);
+    w.idle_ns.add(100);
+
+    const MetricsSnapshot s = r.snapshot();
+    ASSERT_EQ(s.queues.size(), 1u);
+    EXPECT_EQ(s.queues[0].depth, 16u);
+    EXPECT_EQ(s.queues[0].capacity, 64u);
+    EXPECT_DOUBLE_EQ(s.queues[0].occupancy, 0.25);
+    ASSERT_EQ(s.histograms.size(), 1u);
+    EXPECT_EQ(s.histograms[0].count, 101u);
+    EXPECT_NEAR(static_cast<double>(s.histograms[0].p50_ns), 51'000.0, 51'000.0 * 0.02);
+    EXPECT_EQ(s.histograms[0].max_ns, 20'000'000u);
+    ASSERT_EQ(s.workers.size(), 1u);
+    EXPECT_DOUBLE_EQ(s.workers[0].busy_ratio, 0.75);
+    EXPECT_DOUBLE_EQ(s.workers[0].idle_ratio, 0.25);
+
+    const std::string prom = render_prometheus(s);
+    EXPECT_NE(prom.find("# TYPE klstream_queue_depth gauge"), std::string::npos);
+    EXPECT_NE(prom.find("klstream_queue_depth{queue=\"src->map\"} 16\n"), std::string::npos);
+    EXPECT_NE(prom.find("klstream_operator_events_processed_total{op=\"map \\\"sq\\\"\"} 42\n"), std::string::npos);
+    EXPECT_NE(prom.find("klstream_operator_shed_total{op=\"map \\\"sq\\\"\"} 7\n"), std::string::npos);
+    EXPECT_NE(prom.find("klstream_latency_seconds{histogram=\"e2e\",quantile=\"1\"} 0.02"), std::string::npos);
+    EXPECT_NE(prom.find("klstream_latency_seconds_count{histogram=\"e2e\"} 101\n"), std::string::npos);
+    EXPECT_NE(prom.find("klstream_worker_busy_ratio{worker=\"0\"} 0.75\n"), std::string::npos);
+
+    const std::string json = render_json(s);
+    EXPECT_EQ(json.find('\n'), std::string::npos);
+    EXPECT_NE(json.find("\"name\":\"map \\\"sq\\\"\""), std::string::npos);
+    EXPECT_NE(json.find("\"queues\":[{\"name\":\"src->map\",\"depth\":16,\"capacity\":64,\"occupancy\":0.25}]"),
+              std::string::npos);
+    EXPECT_NE(json.find("\"max_ns\":20000000"), std::string::npos);
+    EXPECT_NE(json.find("\"shed_total\":7"), std::string::npos);
+}
+
+// Test 4: ExportersPublishOnStopAndServeOverHttp
+TEST(MetricsTest, ExportersPublishOnStopAndServeOverHttp) {
+    OperatorMetrics op("flt");
+    const std::string path = ::testing::TempDir() + "klstream_metrics.jsonl";
+    std::remove(path.c_str());
+
+    auto prom_owned = std::make_unique<PrometheusExporter>(0);
+    PrometheusExporter* prom = prom_owned.get();
+    ASSERT_NE(prom->port(), 0);
+    {
+        MetricsReporter r;
+        r.add(&op);
+        r.add_exporter(std::make_unique<JsonLinesExporter>(path));
+        r.add_exporter(std::move(prom_owned));
+        r.start();
+        op.events_processed.add(7);
+        r.stop();                                           // final snapshot, < 1 s in
+
+        std::ifstream in(path);
+        std::string line;
+        ASSERT_TRUE(std::getline(in, line));
+        EXPECT_NE(line.find("\"processed_total\":7"), std::string::npos);
+        EXPECT_FALSE(std::getline(in, line));
+
+        const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        ASSERT_GE(fd, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port   = htons(prom->port());
+        ::inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+        ASSERT_EQ(::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)), 0);
+        const std::string get = "GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n";
+        ASSERT_EQ(::send(fd, get.data(), get.size(), 0), static_cast<ssize_t>(get.size()));
+        std::string resp;
+        char buf[4096];
+        for (ssize_t n; (n = ::recv(fd, buf, sizeof(buf), 0)) > 0;) resp.append(buf, static_cast<std::size_t>(n));
+        ::close(fd);
+        EXPECT_EQ(resp.rfind("HTTP/1.1 200 OK\r\n", 0), 0u);
+        EXPECT_NE(resp.find("klstream_operator_events_processed_total{op=\"flt\"} 7\n"), std::string::npos);
+    }
+    std::remove(path.c_str());
+}
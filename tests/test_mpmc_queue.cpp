@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include "klstream/core/mpmc_queue.hpp"
+#include <cstdint>
 #include <thread>
 #include <vector>
 #include <atomic>
@@ -68,3 +69,115 @@ TEST(MPMCQueueTest, ConcurrentProducerConsumer) {
     EXPECT_EQ(push_count.load(), num_items * num_threads);
     EXPECT_EQ(pop_count.load(), num_items * num_threads);
 }
+
+// Test 4: BatchPushPop
+TEST(MPMCQueueTest, BatchPushPop) {
+    MPMCQueue<int> q(8);
+    int in[10];
+    for (int i = 0; i < 10; ++i) in[i] = i;
+
+    EXPECT_EQ(q.try_push_n(in, 10), 8u); // partial: capacity 8
+    EXPECT_EQ(q.try_push_n(in, 1), 0u);
+
+    int out[16];
+    EXPECT_EQ(q.try_pop_n(out, 3), 3u);
+    EXPECT_EQ(q.try_push_n(in, 10), 3u); // wraps around
+    EXPECT_EQ(q.try_pop_n(out + 3, 13), 8u);
+    const int expected[] = {0, 1, 2, 3, 4, 5, 6, 7, 0, 1, 2};
+    for (int i = 0; i < 11; ++i) EXPECT_EQ(out[i], expected[i]);
+}
+
+// Test 5: ConcurrentBatchNoLoss
+TEST(MPMCQueueTest, ConcurrentBatchNoLoss) {
+    MPMCQueue<int> q(1024);
+    const int per_producer = 100'000;
+    const int num_threads = 4;
+    std::atomic<long long> popped_sum{0};
+    std::atomic<int> popped{0};
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&]() {
+            int buf[16];
+            for (int i = 0; i < per_producer; i += 16) {
+                for (int k = 0; k < 16; ++k) buf[k] = i + k;
+                std::size_t done = 0;
+                while (done < 16) done += q.try_push_n(buf + done, 16 - done);
+            }
+        });
+        threads.emplace_back([&]() {
+            int buf[16];
+            while (popped.load() < per_producer * num_threads) {
+                std::size_t n = q.try_pop_n(buf, 16);
+                long long s = 0;
+                for (std::size_t k = 0; k < n; ++k) s += buf[k];
+                popped_sum += s;
+                popped += static_cast<int>(n);
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    const long long per = static_cast<long long>(per_producer) * (per_producer - 1) / 2;
+    EXPECT_EQ(popped.load(), per_producer * num_threads);
+    EXPECT_EQ(popped_sum.load(), per * num_threads);
+}
+
+// Test 6: Compact_PacksSlotsAndKeepsFifo
+// Small payloads share cache lines; the scrambled index still gives FIFO
+// order through many laps, with batches crossing the wrap.
+TEST(MPMCQueueTest, Compact_PacksSlotsAndKeepsFifo) {
+    using Q = MPMCQueue<std::uint32_t, MPMCSlotLayout::Compact>;
+    static_assert(Q::SLOTS_PER_LINE == CACHE_LINE_SIZE / 16);
+    static_assert(MPMCQueue<std::uint32_t>::SLOTS_PER_LINE == 1);
+    Q q(64);
+    std::uint32_t next_in = 0, next_out = 0, buf[13];
+    for (int round = 0; round < 200; ++round) {
+        for (std::uint32_t k = 0; k < 13; ++k) buf[k] = next_in + k;
+        next_in += static_cast<std::uint32_t>(q.try_push_n(buf, 13));
+        std::uint32_t v;
+        if (round % 3 == 0 && q.try_pop(&v)) {
+            EXPECT_EQ(v, next_out++);
+        }
+        const std::size_t n = q.try_pop_n(buf, 9);
+        for (std::size_t k = 0; k < n; ++k) EXPECT_EQ(buf[k], next_out++);
+    }
+    std::uint32_t v;
+    while (q.try_pop(&v)) EXPECT_EQ(v, next_out++);
+    EXPECT_EQ(next_out, next_in);
+
+    // Capacity is still exact: all 64 slots usable, then full.
+    for (std::uint32_t i = 0; i < 64; ++i) EXPECT_TRUE(q.try_push(i));
+    EXPECT_FALSE(q.try_push(99));
+}
+
+// Test 7: Compact_ConcurrentFanInNoLoss
+// Four producers into one compact queue (a fan-in edge), one consumer:
+// every value arrives exactly once.
+TEST(MPMCQueueTest, Compact_ConcurrentFanInNoLoss) {
+    MPMCQueue<std::uint64_t, MPMCSlotLayout::Compact> q(256);
+    constexpr std::uint64_t PER = 50'000;
+    constexpr int P = 4;
+    std::vector<std::thread> producers;
+    for (int p = 0; p < P; ++p) {
+        producers.emplace_back([&, p] {
+            for (std::uint64_t i = 0; i < PER; ++i)
+                while (!q.try_push(static_cast<std::uint64_t>(p) * PER + i)) std::this_thread::yield();
+        });
+    }
+    std::vector<std::uint8_t> seen(P * PER, 0);
+    std::vector<std::uint64_t> last(P, 0);
+    std::uint64_t got = 0, v;
+    while (got < P * PER) {
+        if (!q.try_pop(&v)) { std::this_thread::yield(); continue; }
+        ASSERT_LT(v, P * PER);
+        ASSERT_EQ(seen[v]++, 0);
+        // Per-producer order is preserved.
+        const std::size_t p = v / PER;
+        ASSERT_TRUE(last[p] == 0 ? true : v > last[p]);
+        last[p] = v;
+        ++got;
+    }
+    for (auto& t : producers) t.join();
+    EXPECT_EQ(got, P * PER);
+}
@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+#include "klstream/window/network_tick_source.hpp"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace klstream;
+
+namespace {
+
+TickWireMessage message(std::uint64_t i) {
+    return TickWireMessage{ symbol_key("AAPL"), i, 1'000'000 + i,
+                            BookTop{ 100.0 + 0.01 * static_cast<double>(i), 100.02 + 0.01 * static_cast<double>(i),
+                                     static_cast<std::uint32_t>(100 + i), static_cast<std::uint32_t>(200 + i) } };
+}
+
+sockaddr_in loopback(std::uint16_t port) {
+    sockaddr_in a{};
+    a.sin_family      = AF_INET;
+    a.sin_port        = htons(port);
+    a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    return a;
+}
+
+// Ticks src until `want` events are out or two seconds have passed.
+std::vector<Event<BookTop>> drain(NetworkTickSource& src, SPSCQueue<Event<BookTop>>& q, std::size_t want) {
+    std::vector<Event<BookTop>> got;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (got.size() < want && std::chrono::steady_clock::now() < deadline) {
+        src.tick();
+        Event<BookTop> e;
+        while (q.try_pop(&e)) got.push_back(e);
+    }
+    return got;
+}
+
+void expect_message(const Event<BookTop>& e, std::uint64_t i) {
+    const TickWireMessage m = message(i);
+    EXPECT_EQ(e.key, m.symbol);
+    EXPECT_EQ(e.seq, m.seq);
+    EXPECT_EQ(e.event_ts_ns, m.event_ts_ns);
+    EXPECT_DOUBLE_EQ(e.data.bid_px, m.book.bid_px);
+    EXPECT_DOUBLE_EQ(e.data.ask_px, m.book.ask_px);
+    EXPECT_EQ(e.data.bid_sz, m.book.bid_sz);
+    EXPECT_EQ(e.data.ask_sz, m.book.ask_sz);
+}
+
+} // namespace
+
+// Test 1: Udp_DecodesDatagramsIntoSlots
+// Datagrams sent to a loopback-bound source come out as events, in order,
+// stamped on the Clock timeline; a short datagram is dropped and counted.
+TEST(NetworkSourceTest, Udp_DecodesDatagramsIntoSlots) {
+    SPSCQueue<Event<BookTop>> q(256);
+    FeedEndpoint ep;
+    ep.address = "127.0.0.1";
+    NetworkTickSource src("net", &q, ep, 16);
+    ASSERT_NE(src.port(), 0);
+
+    const int tx = ::socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_GE(tx, 0);
+    const sockaddr_in to = loopback(src.port());
+    const std::uint64_t before = Clock::now_ns();
+    constexpr std::size_t N = 100;
+    for (std::size_t i = 0; i < N; ++i) {
+        const TickWireMessage m = message(i);
+        ASSERT_EQ(::sendto(tx, &m, sizeof(m), 0, reinterpret_cast<const sockaddr*>(&to), sizeof(to)),
+                  static_cast<ssize_t>(sizeof(m)));
+        if (i == N / 2) {
+            const char junk[10] = {};
+            ::sendto(tx, junk, sizeof(junk), 0, reinterpret_cast<const sockaddr*>(&to), sizeof(to));
+        }
+    }
+    ::close(tx);
+
+    const auto got = drain(src, q, N);
+    const std::uint64_t after = Clock::now_ns();
+    ASSERT_EQ(got.size(), N);
+    for (std::size_t i = 0; i < N; ++i) {
+        expect_message(got[i], i);
+        EXPECT_GE(got[i].timestamp_ns, before);
+        EXPECT_LE(got[i].timestamp_ns, after);
+    }
+    EXPECT_EQ(src.received(), N);
+    EXPECT_EQ(src.malformed(), 1u);
+}
+
+// Test 2: Tcp_ReassemblesMessagesSplitAcrossReads
+// A TCP feed written in chunks that split messages anywhere still decodes
+// every message exactly once; the feed closing ends the stream.
+TEST(NetworkSourceTest, Tcp_ReassemblesMessagesSplitAcrossReads) {
+    const int listener = ::socket(AF_INET, SOCK_STREAM, 0);
+    ASSERT_GE(listener, 0);
+    sockaddr_in addr = loopback(0);
+    ASSERT_EQ(::bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)), 0);
+    ASSERT_EQ(::listen(listener, 1), 0);
+    socklen_t len = sizeof(addr);
+    ::getsockname(listener, reinterpret_cast<sockaddr*>(&addr), &len);
+
+    SPSCQueue<Event<BookTop>> q(64);   // smaller than the feed: slots wrap and refill
+    FeedEndpoint ep;
+    ep.transport = FeedTransport::Tcp;
+    ep.address   = "127.0.0.1";
+    ep.port      = ntohs(addr.sin_port);
+    NetworkTickSource src("net", &q, ep, 8);
+    const int conn = ::accept(listener, nullptr, nullptr);
+    ASSERT_GE(conn, 0);
+
+    constexpr std::size_t N = 500;
+    std::vector<TickWireMessage> feed;
+    for (std::size_t i = 0; i < N; ++i) feed.push_back(message(i));
+    std::thread writer([&] {
+        const char* p = reinterpret_cast<const char*>(feed.data());
+        const std::size_t total = feed.size() * sizeof(TickWireMessage);
+        std::size_t off = 0, chunk = 1;
+        while (off < total) {
+            const std::size_t n = std::min(chunk, total - off);
+            ASSERT_EQ(::send(conn, p + off, n, 0), static_cast<ssize_t>(n));
+            off += n;
+            chunk = chunk * 7 % 113 + 1;   // 1..113 bytes: splits at every offset
+            if (off % 5 == 0) std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+        ::close(conn);
+    });
+
+    const auto got = drain(src, q, N);
+    writer.join();
+    ASSERT_EQ(got.size(), N);
+    for (std::size_t i = 0; i < N; ++i) expect_message(got[i], i);
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (!src.closed() && std::chrono::steady_clock::now() < deadline) src.tick();
+    EXPECT_TRUE(src.closed());
+    EXPECT_FALSE(src.error().empty());
+    ::close(listener);
+}
+
+// Test 3: Constructor_BadAddressThrows
+TEST(NetworkSourceTest, Constructor_BadAddressThrows) {
+    SPSCQueue<Event<BookTop>> q(16);
+    FeedEndpoint ep;
+    ep.address = "not-an-address";
+    EXPECT_THROW(NetworkTickSource("net", &q, ep), std::runtime_error);
+}
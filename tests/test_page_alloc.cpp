@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+#include "klstream/core/page_alloc.hpp"
+#include "klstream/core/spsc_queue.hpp"
+#include "klstream/core/event.hpp"
+#include <cstdint>
+#include <cstring>
+
+using namespace klstream;
+
+// Test 1: Default_IsAlignedOperatorNew
+// The default policy maps nothing: same allocation as before the allocator.
+TEST(PageAllocTest, Default_IsAlignedOperatorNew) {
+    auto& a = PageAllocator::instance();
+    const auto before = a.stats();
+    void* p = a.allocate(1000, CACHE_LINE_SIZE, MemoryPolicy{});
+    ASSERT_NE(p, nullptr);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(p) % CACHE_LINE_SIZE, 0u);
+    EXPECT_EQ(a.stats().mapped_bytes, before.mapped_bytes);
+    a.deallocate(p, 1000, CACHE_LINE_SIZE);
+}
+
+// Test 2: SmallBuffers_ShareOneChunk
+// Buffers under a chunk with the same policy are packed into one 2 MB
+// mapping, aligned as asked; it is unmapped with the last of them.
+TEST(PageAllocTest, SmallBuffers_ShareOneChunk) {
+    auto& a = PageAllocator::instance();
+    MemoryPolicy pol;
+    pol.pages    = MemoryPolicy::Pages::Transparent;
+    pol.prefault = true;
+    const auto before = a.stats();
+
+    char* p = static_cast<char*>(a.allocate(300 << 10, CACHE_LINE_SIZE, pol));
+    char* q = static_cast<char*>(a.allocate(300 << 10, CACHE_LINE_SIZE, pol));
+    ASSERT_NE(p, nullptr);
+    ASSERT_NE(q, nullptr);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(p) % PageAllocator::CHUNK_BYTES, 0u);   // THP wants 2 MB alignment
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(q) % CACHE_LINE_SIZE, 0u);
+    EXPECT_GE(q, p + (300 << 10));
+    EXPECT_LT(q, p + PageAllocator::CHUNK_BYTES);
+    std::memset(p, 1, 300 << 10);
+    std::memset(q, 2, 300 << 10);
+    EXPECT_EQ(p[0], 1);
+
+    const auto mid = a.stats();
+    EXPECT_EQ(mid.chunks, before.chunks + 1);
+    EXPECT_EQ(mid.mapped_bytes, before.mapped_bytes + PageAllocator::CHUNK_BYTES);
+    EXPECT_EQ(mid.prefaulted_bytes, before.prefaulted_bytes + PageAllocator::CHUNK_BYTES);
+
+    a.deallocate(p, 300 << 10, CACHE_LINE_SIZE);
+    EXPECT_EQ(a.stats().chunks, before.chunks + 1);
+    a.deallocate(q, 300 << 10, CACHE_LINE_SIZE);
+    EXPECT_EQ(a.stats().chunks, before.chunks);
+    EXPECT_EQ(a.stats().mapped_bytes, before.mapped_bytes);
+}
+
+// Test 3: HugeAndLock_DegradeWithoutFailing
+// MAP_HUGETLB needs a reserved pool and mlock a large enough limit; when
+// either is missing the buffer is still served, and the shortfall counted.
+TEST(PageAllocTest, HugeAndLock_DegradeWithoutFailing) {
+    auto& a = PageAllocator::instance();
+    MemoryPolicy pol;
+    pol.pages = MemoryPolicy::Pages::Huge;
+    pol.lock  = true;
+    const auto before = a.stats();
+    const std::size_t n = 3 * PageAllocator::CHUNK_BYTES + 1;   // own mapping, rounded to 4 chunks
+    char* p = static_cast<char*>(a.allocate(n, CACHE_LINE_SIZE, pol));
+    ASSERT_NE(p, nullptr);
+    std::memset(p, 7, n);
+    const auto st = a.stats();
+    EXPECT_EQ(st.mapped_bytes, before.mapped_bytes + 4 * PageAllocator::CHUNK_BYTES);
+    EXPECT_EQ(st.hugetlb_bytes - before.hugetlb_bytes + (st.hugetlb_fallbacks - before.hugetlb_fallbacks) * 4 * PageAllocator::CHUNK_BYTES,
+              4 * PageAllocator::CHUNK_BYTES);
+    EXPECT_EQ(st.locked_bytes - before.locked_bytes + (st.lock_failures - before.lock_failures) * 4 * PageAllocator::CHUNK_BYTES,
+              4 * PageAllocator::CHUNK_BYTES);
+    a.deallocate(p, n, CACHE_LINE_SIZE);
+    EXPECT_EQ(a.stats().mapped_bytes, before.mapped_bytes);
+    EXPECT_EQ(a.stats().locked_bytes, before.locked_bytes);
+}
+
+// Test 4: SpscQueue_RingFollowsPolicy
+// A queue built with a policy gets its ring from a chunk and works as any
+// other; the chunk goes away with the queue.
+TEST(PageAllocTest, SpscQueue_RingFollowsPolicy) {
+    auto& a = PageAllocator::instance();
+    MemoryPolicy pol;
+    pol.prefault = true;
+    const auto before = a.stats();
+    {
+        SPSCQueue<Event<std::uint64_t>> q(1024, pol);
+        EXPECT_EQ(a.stats().chunks, before.chunks + 1);
+        for (std::uint64_t i = 0; i < 5000; ++i) {
+            ASSERT_TRUE(q.try_push(Event<std::uint64_t>::make(i, 0, i)));
+            Event<std::uint64_t> e;
+            ASSERT_TRUE(q.try_pop(&e));
+            ASSERT_EQ(e.data, i);
+        }
+    }
+    EXPECT_EQ(a.stats().chunks, before.chunks);
+}
@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+#include "klstream/core/perf_counters.hpp"
+#include "klstream/core/metrics_export.hpp"
+#include "klstream/operators/graph.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+using namespace klstream;
+using namespace std::chrono;
+
+// Test 1: Group_CountsWorkOrFailsCleanly
+TEST(PerfCountersTest, Group_CountsWorkOrFailsCleanly) {
+    PerfCounterGroup g;
+    const bool ok = g.open();
+    EXPECT_EQ(ok, g.available());
+    PerfCounts a, b;
+    if (!ok) {
+        EXPECT_FALSE(g.read(a));                 // no PMU here: every read fails, nothing throws
+        g.close();
+        GTEST_SKIP() << "perf events unavailable on this machine";
+    }
+    ASSERT_TRUE(g.read(a));
+    volatile std::uint64_t x = 0;
+    for (int i = 0; i < 1'000'000; ++i) x = x + static_cast<std::uint64_t>(i);
+    ASSERT_TRUE(g.read(b));
+    const PerfCounts d = b - a;
+    EXPECT_GT(d.cycles, 0u);
+    EXPECT_GT(d.instructions, 1'000'000u);       // at least one per iteration
+    g.close();
+    EXPECT_FALSE(g.read(a));
+}
+
+// Test 2: ProfiledGraph_AttributesCountersPerOperator
+TEST(PerfCountersTest, ProfiledGraph_AttributesCountersPerOperator) {
+    constexpr uint64_t N = 50000;
+    StreamGraphBuilder g;
+    uint64_t next = 1;
+    std::atomic<uint64_t> received{0};
+    g.source<uint64_t>("src", [&next](Event<uint64_t>& out, uint64_t) {
+         if (next > N) return false;
+         out = Event<uint64_t>::make(next++);
+         return true;
+     })
+     .map<uint64_t>("map", [](uint64_t x) { return x * 3; })
+     .sink("snk", [&](const Event<uint64_t>&) { received++; });
+
+    PlanOptions o;
+    o.workers = 1;
+    Runtime rt;
+    auto graph = g.build(rt, g.plan(o));
+    graph->profile();
+    rt.start();
+    const auto deadline = steady_clock::now() + seconds(20);
+    while (received.load() < N && steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(milliseconds(5));
+    }
+    rt.stop();
+    ASSERT_EQ(received.load(), N);
+
+    const auto snap = rt.metrics().snapshot();
+    const std::string json = render_json(snap);
+    const std::string prom = render_prometheus(snap);
+    ASSERT_EQ(snap.operators.size(), 3u);
+    if (!rt.worker(0).perf_counters_active()) {
+        for (const auto& r : snap.operators) EXPECT_EQ(r.metrics->perf.ticks.load(), 0u);
+        EXPECT_EQ(json.find("\"perf\""), std::string::npos);
+        EXPECT_EQ(prom.find("klstream_operator_cycles_total"), std::string::npos);
+        GTEST_SKIP() << "perf events unavailable on this machine";
+    }
+    for (const auto& r : snap.operators) {
+        const PerfMetrics& pm = r.metrics->perf;
+        EXPECT_GT(pm.ticks.load(), 0u) << r.metrics->op_name;
+        EXPECT_GT(pm.instructions.load(), 0u) << r.metrics->op_name;
+        EXPECT_GT(pm.ipc(), 0.0) << r.metrics->op_name;
+    }
+    EXPECT_NE(json.find("\"perf\":{\"ticks\":"), std::string::npos);
+    EXPECT_NE(prom.find("klstream_operator_cycles_total{op=\"map\"}"), std::string::npos);
+}
@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+#include "klstream/core/pinning.hpp"
+#include "klstream/core/runtime.hpp"
+#include "klstream/core/spsc_queue.hpp"
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#  include <sched.h>
+#endif
+
+using namespace klstream;
+namespace fs = std::filesystem;
+
+namespace {
+
+void put(const fs::path& p, const std::string& text) {
+    fs::create_directories(p.parent_path());
+    std::ofstream(p) << text << "\n";
+}
+
+// A fake /sys/devices: 2 nodes x 2 cores x 2 SMT threads (cpus 0-7, with
+// siblings n and n+4), optionally with cpus 6-7 reported as Intel E-cores.
+fs::path fake_sysfs(const std::string& name, bool hybrid) {
+    const fs::path root = fs::path(::testing::TempDir()) / name;
+    fs::remove_all(root);
+    put(root / "system/cpu/online", "0-7");
+    for (int c = 0; c < 8; ++c) {
+        const fs::path topo = root / "system/cpu" / ("cpu" + std::to_string(c)) / "topology";
+        const int core = c % 4;
+        put(topo / "core_id", std::to_string(core % 2));
+        put(topo / "physical_package_id", std::to_string(core / 2));
+        put(topo / "thread_siblings_list", std::to_string(core) + "," + std::to_string(core + 4));
+    }
+    put(root / "system/node/online", "0-1");
+    put(root / "system/node/node0/cpulist", "0-1,4-5");
+    put(root / "system/node/node1/cpulist", "2-3,6-7");
+    if (hybrid) put(root / "cpu_atom/cpus", "6-7");
+    return root;
+}
+
+} // namespace
+
+// Test 1: ParseCpuList_RangesAndSingles
+TEST(PinningTest, ParseCpuList_RangesAndSingles) {
+    EXPECT_EQ(parse_cpu_list("0-3,8,10-11\n"), (std::vector<int>{ 0, 1, 2, 3, 8, 10, 11 }));
+    EXPECT_EQ(parse_cpu_list("5"), (std::vector<int>{ 5 }));
+    EXPECT_TRUE(parse_cpu_list("").empty());
+}
+
+// Test 2: Topology_SmtAndNumaFromSysfs
+TEST(PinningTest, Topology_SmtAndNumaFromSysfs) {
+    const auto t = CpuTopology::from_sysfs(fake_sysfs("klstream_sysfs_smt", false).string());
+    ASSERT_EQ(t.cpus().size(), 8u);
+    EXPECT_EQ(t.n_nodes(), 2);
+    EXPECT_FALSE(t.hybrid());
+    EXPECT_EQ(t.node_of(6), 1);
+    EXPECT_EQ(t.node_of(42), -1);
+    EXPECT_EQ(t.cpus_on_node(0), (std::vector<int>{ 0, 1, 4, 5 }));
+
+    // One thread per physical core; the siblings are what is left.
+    EXPECT_EQ(t.cpus_for(CoreAffinity::Performance), (std::vector<int>{ 0, 1, 2, 3 }));
+    EXPECT_EQ(t.cpus_for(CoreAffinity::Efficiency),  (std::vector<int>{ 4, 5, 6, 7 }));
+    EXPECT_EQ(t.cpus_for(CoreAffinity::Any).size(), 8u);
+}
+
+// Test 3: Topology_HybridEfficiencyCores
+TEST(PinningTest, Topology_HybridEfficiencyCores) {
+    const auto t = CpuTopology::from_sysfs(fake_sysfs("klstream_sysfs_hybrid", true).string());
+    EXPECT_TRUE(t.hybrid());
+    EXPECT_EQ(t.cpus_for(CoreAffinity::Efficiency),  (std::vector<int>{ 6, 7 }));
+    EXPECT_EQ(t.cpus_for(CoreAffinity::Performance), (std::vector<int>{ 0, 1, 2, 3 }));
+
+    // No sysfs at all: a flat single-node host, every hint is "all CPUs".
+    const auto none = CpuTopology::from_sysfs((fs::path(::testing::TempDir()) / "klstream_no_sysfs").string());
+    EXPECT_TRUE(none.cpus().empty());
+    const auto flat = CpuTopology::flat(3);
+    EXPECT_EQ(flat.cpus_for(CoreAffinity::Efficiency).size(), 3u);
+}
+
+#if defined(__linux__)
+// Test 4: Worker_PinnedToExplicitCpu
+TEST(PinningTest, Worker_PinnedToExplicitCpu) {
+    cpu_set_t allowed;
+    ASSERT_EQ(sched_getaffinity(0, sizeof(allowed), &allowed), 0);
+    int cpu = 0;
+    while (!CPU_ISSET(cpu, &allowed)) ++cpu;
+
+    struct Probe : IOperator {
+        Probe() : IOperator("probe") {}
+        void init() override {
+            cpu_set_t s;
+            sched_getaffinity(0, sizeof(s), &s);
+            count.store(CPU_COUNT(&s));
+            on.store(sched_getcpu());
+        }
+        OpStatus tick() override { return OpStatus::Idle; }
+        std::atomic<int> count{-1}, on{-1};
+    } probe;
+
+    Runtime rt;
+    const int w = rt.add_worker(WorkerPlacement{ CoreAffinity::Any, { cpu }, -1 });
+    rt.register_op(&probe, w);
+    EXPECT_EQ(rt.worker_numa_node(w), CpuTopology::system().node_of(cpu));
+    rt.start();
+    while (probe.count.load() < 0) std::this_thread::yield();
+    rt.stop();
+    EXPECT_TRUE(rt.worker(w).placement_applied());
+    EXPECT_EQ(probe.count.load(), 1);
+    EXPECT_EQ(probe.on.load(), cpu);
+
+    // Best effort: may be refused in a sandbox, must never break the queue.
+    SPSCQueue<int> q(64);
+    (void)q.bind_to_numa_node(0);
+    ASSERT_TRUE(q.try_push(7));
+    int v = 0;
+    ASSERT_TRUE(q.try_pop(&v));
+    EXPECT_EQ(v, 7);
+}
+#endif
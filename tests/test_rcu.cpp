@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+#include "klstream/core/rcu.hpp"
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace klstream;
+
+namespace {
+
+// Counts live instances and poisons itself on destruction so a reader that
+// touches a reclaimed object trips the canary check.
+struct Model {
+    static inline std::atomic<int> live{0};
+    explicit Model(int v) : value(v) { live.fetch_add(1); }
+    ~Model() { canary = 0; live.fetch_sub(1); }
+    int value;
+    std::uint32_t canary = 0xC0FFEE;
+};
+
+} // namespace
+
+// Test 1: Publish_RetiresUntilAllReadersQuiescent
+TEST(RcuTest, Publish_RetiresUntilAllReadersQuiescent) {
+    {
+        RcuCell<Model> cell(std::make_unique<const Model>(1));
+        auto& a = cell.make_reader();
+        auto& b = cell.make_reader();
+
+        const Model* held = a.get();
+        EXPECT_EQ(held->value, 1);
+        EXPECT_EQ(cell.publish(std::make_unique<const Model>(2)), 1u);
+        EXPECT_EQ(a.get()->value, 2);
+        EXPECT_EQ(Model::live.load(), 2);    // 1 is retired, not freed
+        EXPECT_EQ(held->canary, 0xC0FFEEu);
+
+        a.quiescent();
+        EXPECT_EQ(cell.reclaim(), 1u);       // b has not moved on yet
+        b.quiescent();
+        EXPECT_EQ(cell.reclaim(), 0u);
+        EXPECT_EQ(Model::live.load(), 1);
+
+        // An offline reader never holds anything back.
+        b.offline();
+        cell.publish(std::make_unique<const Model>(3));
+        a.quiescent();
+        EXPECT_EQ(cell.reclaim(), 0u);
+        EXPECT_EQ(cell.version(), 2u);
+    }
+    EXPECT_EQ(Model::live.load(), 0);
+}
+
+// Test 2: ConcurrentPublish_ReadersNeverSeeFreed
+TEST(RcuTest, ConcurrentPublish_ReadersNeverSeeFreed) {
+    {
+        RcuCell<Model> cell(std::make_unique<const Model>(0));
+        constexpr int N_READERS = 3;
+        constexpr int N_PUBLISH = 2000;
+        std::vector<RcuCell<Model>::Reader*> readers;
+        for (int r = 0; r < N_READERS; ++r) readers.push_back(&cell.make_reader());
+
+        std::atomic<bool> done{false};
+        std::atomic<int>  bad{0};
+        std::vector<std::thread> threads;
+        for (int r = 0; r < N_READERS; ++r) {
+            threads.emplace_back([&, r] {
+                auto* rd = readers[r];
+                int last = 0;
+                while (!done.load(std::memory_order_acquire)) {
+                    const Model* m = rd->get();
+                    for (int k = 0; k < 16; ++k) {
+                        if (m->canary != 0xC0FFEEu) bad.fetch_add(1);
+                    }
+                    if (m->value < last) bad.fetch_add(1);   // versions never go back
+                    last = m->value;
+                    rd->quiescent();
+                }
+                rd->offline();
+            });
+        }
+        for (int v = 1; v <= N_PUBLISH; ++v) {
+            cell.publish(std::make_unique<const Model>(v));
+        }
+        done.store(true, std::memory_order_release);
+        for (auto& t : threads) t.join();
+
+        EXPECT_EQ(bad.load(), 0);
+        EXPECT_EQ(cell.reclaim(), 0u);
+        EXPECT_EQ(Model::live.load(), 1);
+    }
+    EXPECT_EQ(Model::live.load(), 0);
+}
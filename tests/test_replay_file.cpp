@@ -0,0 +1,249 @@
+#include <gtest/gtest.h>
+#include "klstream/window/replay_file.hpp"
+#include "klstream/window/financial_tick_source.hpp"
+#include "klstream/window/streaming_replay_source.hpp"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace klstream;
+
+namespace {
+
+// n rows, 0.25 s apart, with a 3 s gap after row n/2 so some index buckets
+// are empty.
+std::vector<TickRow> make_rows(std::size_t n) {
+    std::vector<TickRow> rows;
+    std::uint64_t ts = 34'200'000'000'000ULL;
+    for (std::size_t i = 0; i < n; ++i) {
+        const float f = static_cast<float>(i);
+        rows.push_back(TickRow{ i, ts, 0.001f * f, 0.5f + f, -0.25f * f, 3.0f, 0.1f * f,
+                                static_cast<std::uint8_t>(i % 3),
+                                static_cast<std::uint8_t>(i % 7 == 0) });
+        ts += 250'000'000ULL + (i == n / 2 ? 3'000'000'000ULL : 0);
+    }
+    return rows;
+}
+
+std::string temp_path(const char* name) { return ::testing::TempDir() + name; }
+
+std::string read_all(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), {});
+}
+
+void write_all(const std::string& path, const std::string& bytes) {
+    std::ofstream out(path, std::ios::binary);
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+} // namespace
+
+// Test 1: RoundTrip_ColumnsMatchRows
+TEST(ReplayFileTest, RoundTrip_ColumnsMatchRows) {
+    const auto rows = make_rows(1000);
+    const auto path = temp_path("klstream_replay_roundtrip.klsr");
+    write_replay_file(rows, path);
+    EXPECT_TRUE(is_replay_file(path));
+
+    ReplayFile file(path);
+    ASSERT_EQ(file.size(), rows.size());
+    EXPECT_TRUE(file.has_index());
+    for (std::size_t i = 0; i < rows.size(); ++i) {
+        const TickRow r = file.columns().row(i);
+        ASSERT_EQ(r.seq, rows[i].seq);
+        ASSERT_EQ(r.timestamp_ns, rows[i].timestamp_ns);
+        ASSERT_EQ(r.log_return, rows[i].log_return);
+        ASSERT_EQ(r.order_imbalance, rows[i].order_imbalance);
+        ASSERT_EQ(r.volume, rows[i].volume);
+        ASSERT_EQ(r.label, rows[i].label);
+        ASSERT_EQ(r.is_burst_period, rows[i].is_burst_period);
+    }
+    std::remove(path.c_str());
+}
+
+// Test 2: SeekTime_MatchesLowerBound
+TEST(ReplayFileTest, SeekTime_MatchesLowerBound) {
+    const auto rows = make_rows(500);
+    const auto indexed = temp_path("klstream_replay_indexed.klsr");
+    const auto flat    = temp_path("klstream_replay_noindex.klsr");
+    write_replay_file(rows, indexed, 1'000'000'000ULL);
+    write_replay_file(rows, flat, 0);
+    ReplayFile a(indexed), b(flat);
+    EXPECT_FALSE(b.has_index());
+
+    auto expected = [&](std::uint64_t ts) {
+        std::size_t i = 0;
+        while (i < rows.size() && rows[i].timestamp_ns < ts) ++i;
+        return i;
+    };
+    const std::uint64_t first = rows.front().timestamp_ns, last = rows.back().timestamp_ns;
+    for (std::uint64_t ts = first - 1'000'000'000ULL; ts <= last + 1'000'000'000ULL;
+         ts += 77'000'000ULL) {
+        ASSERT_EQ(a.seek_time(ts), expected(ts)) << ts;
+        ASSERT_EQ(b.seek_time(ts), expected(ts)) << ts;
+    }
+    EXPECT_EQ(a.seek_time(last + 1), rows.size());
+    std::remove(indexed.c_str());
+    std::remove(flat.c_str());
+}
+
+// Test 3: Open_RejectsCorruption
+TEST(ReplayFileTest, Open_RejectsCorruption) {
+    const auto path = temp_path("klstream_replay_corrupt.klsr");
+    write_replay_file(make_rows(300), path);
+    const std::string good = read_all(path);
+
+    auto opens = [&](const std::string& bytes) {
+        write_all(path, bytes);
+        ReplayFile f(path);
+    };
+    EXPECT_NO_THROW(opens(good));
+    EXPECT_THROW(opens(good.substr(0, good.size() - 1)), std::runtime_error);   // truncated
+
+    std::string bad_magic = good;
+    bad_magic[0] = 'X';
+    EXPECT_THROW(opens(bad_magic), std::runtime_error);
+    EXPECT_FALSE(is_replay_file(path));
+
+    std::string bad_version = good;
+    bad_version[8] = 9;
+    EXPECT_THROW(opens(bad_version), std::runtime_error);
+
+    // An index entry past the end of the rows would send seek_time() out of
+    // bounds: must be caught at open.
+    ReplayFileHeader h;
+    std::memcpy(&h, good.data(), sizeof(h));
+    std::string bad_index = good;
+    const std::uint64_t past_end = h.n_rows + 1;
+    std::memcpy(&bad_index[h.offset[ReplayFileHeader::INDEX] + 8], &past_end, sizeof(past_end));
+    EXPECT_THROW(opens(bad_index), std::runtime_error);
+    std::remove(path.c_str());
+}
+
+// Test 4: TickSource_SameEventsFromRowsAndFile
+TEST(ReplayFileTest, TickSource_SameEventsFromRowsAndFile) {
+    const auto rows = make_rows(200);
+    const auto path = temp_path("klstream_replay_source.klsr");
+    write_replay_file(rows, path);
+
+    FinancialTickSource from_rows(rows, ReplayMode::MaxRate);
+    FinancialTickSource from_file(std::make_shared<const ReplayFile>(path), ReplayMode::MaxRate);
+    // Two passes: the wrap-around must continue seq numbering and event
+    // time the same way.
+    std::uint64_t last_ts = 0;
+    for (std::size_t i = 0; i < 2 * rows.size(); ++i) {
+        Event<FeatureVector> a{}, b{};
+        ASSERT_TRUE(from_rows(a, i));
+        ASSERT_TRUE(from_file(b, i));
+        ASSERT_EQ(a.seq, b.seq);
+        ASSERT_EQ(a.event_ts_ns, b.event_ts_ns);
+        if (i < rows.size()) { ASSERT_EQ(a.event_ts_ns, rows[i].timestamp_ns); }   // original tick time
+        if (i > 0) { ASSERT_GT(a.event_ts_ns, last_ts); }                          // and monotonic across the wrap
+        last_ts = a.event_ts_ns;
+        ASSERT_EQ(a.data.log_return, b.data.log_return);
+        ASSERT_EQ(a.data.volume, b.data.volume);
+        ASSERT_EQ(from_rows.last_label(), from_file.last_label());
+    }
+    EXPECT_EQ(from_file.remaining(), 0u);
+    std::remove(path.c_str());
+}
+
+// Test 5: Streaming_MatchesFilesBackToBack
+TEST(ReplayFileTest, Streaming_MatchesFilesBackToBack) {
+    const auto day1 = make_rows(1000), day2 = make_rows(333);
+    const auto p1 = temp_path("klstream_replay_day1.klsr"), p2 = temp_path("klstream_replay_day2.klsr");
+    write_replay_file(day1, p1);
+    write_replay_file(day2, p2);
+
+    // Small blocks and ring: many wrap-arounds, and the reader is forced to
+    // wait on the generator.
+    StreamingReplaySource src({ p1, p2 }, ReplayMode::MaxRate, 1.0, /*loop=*/false, 64, 3);
+    EXPECT_EQ(src.ring_bytes(), 3 * 64 * sizeof(TickRow));
+
+    std::vector<TickRow> expected = day1;
+    for (auto r : day2) { r.seq += day1.back().seq + 1; expected.push_back(r); }
+
+    std::size_t got = 0;
+    Event<FeatureVector> ev{};
+    while (!src.finished()) {
+        if (!src(ev, got)) { std::this_thread::yield(); continue; }
+        ASSERT_LT(got, expected.size());
+        ASSERT_EQ(ev.seq, expected[got].seq);
+        ASSERT_EQ(ev.data.rolling_vol, expected[got].rolling_vol);
+        ASSERT_EQ(src.last_label(), expected[got].label);
+        ++got;
+    }
+    EXPECT_EQ(got, expected.size());
+    EXPECT_EQ(src.blocks_read(), (1000 + 63) / 64 + (333 + 63) / 64);
+    EXPECT_FALSE(src(ev, got));   // stays exhausted
+    EXPECT_TRUE(src.error().empty());
+    std::remove(p1.c_str());
+    std::remove(p2.c_str());
+}
+
+// Test 6: Streaming_LoopsWithMonotonicSeq
+TEST(ReplayFileTest, Streaming_LoopsWithMonotonicSeq) {
+    const auto rows = make_rows(100);
+    const auto path = temp_path("klstream_replay_loop.klsr");
+    write_replay_file(rows, path);
+
+    FinancialTickSource  in_memory(rows, ReplayMode::MaxRate);
+    StreamingReplaySource streamed({ path }, ReplayMode::MaxRate, 1.0, /*loop=*/true, 32, 2);
+    for (std::size_t i = 0; i < 5 * rows.size();) {
+        Event<FeatureVector> a{}, b{};
+        if (!streamed(b, i)) { std::this_thread::yield(); continue; }
+        ASSERT_TRUE(in_memory(a, i));
+        ASSERT_EQ(a.seq, b.seq);
+        ASSERT_EQ(a.event_ts_ns, b.event_ts_ns);
+        ASSERT_EQ(a.data.spread_bps, b.data.spread_bps);
+        ++i;
+    }
+    EXPECT_FALSE(streamed.finished());
+    std::remove(path.c_str());
+}
+
+// Test 7: Streaming_RejectsBadPathUpFront
+TEST(ReplayFileTest, Streaming_RejectsBadPathUpFront) {
+    EXPECT_THROW(StreamingReplaySource({ temp_path("klstream_no_such_replay.klsr") },
+                                       ReplayMode::MaxRate),
+                 std::runtime_error);
+    EXPECT_THROW(StreamingReplaySource({}, ReplayMode::MaxRate), std::runtime_error);
+}
+
+// Test 8: MultiSymbol_MergesByTimestampAndTagsSymbol
+// Two symbols, offset by half a row gap: the merged stream alternates,
+// keeps each file's own seq, and starts the next pass only once both
+// symbols have finished the day.
+TEST(ReplayFileTest, MultiSymbol_MergesByTimestampAndTagsSymbol) {
+    auto a_rows = make_rows(10), b_rows = make_rows(10);
+    for (auto& r : b_rows) r.timestamp_ns += 125'000'000ULL;
+    std::vector<FinancialTickSource> per_symbol;
+    per_symbol.emplace_back(b_rows, ReplayMode::MaxRate);
+    per_symbol.back().set_symbol(symbol_key("MSFT"));
+    per_symbol.emplace_back(a_rows, ReplayMode::MaxRate);
+    per_symbol.back().set_symbol(symbol_key("AAPL"));
+    MultiSymbolTickSource src(std::move(per_symbol), ReplayMode::MaxRate);
+    ASSERT_EQ(src.symbols(), 2u);
+
+    EXPECT_EQ(symbol_name(symbol_key("AAPL")), "AAPL");
+    EXPECT_NE(symbol_key("AAPL"), symbol_key("AAP"));
+
+    Event<FeatureVector> ev;
+    std::uint64_t last_event_ts = 0;
+    for (std::uint64_t i = 0; i < 40; ++i) {
+        ASSERT_TRUE(src(ev, i));
+        const bool aapl = i % 2 == 0;   // AAPL's rows come first within each pair
+        EXPECT_EQ(ev.key, symbol_key(aapl ? "AAPL" : "MSFT")) << "event " << i;
+        EXPECT_EQ(ev.seq, i / 2) << "event " << i;   // per-symbol seq, continuing across passes
+        if (aapl) {
+            EXPECT_GT(ev.event_ts_ns, last_event_ts);
+            last_event_ts = ev.event_ts_ns;
+        }
+    }
+    EXPECT_THROW(MultiSymbolTickSource({}, ReplayMode::MaxRate), std::runtime_error);
+}
@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+#include "klstream/window/result_log.hpp"
+#include "klstream/window/result_sink.hpp"
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace klstream;
+
+namespace {
+
+std::string temp_path(const char* name) { return ::testing::TempDir() + name; }
+
+Event<DetectionResult> result(std::uint64_t i, std::uint64_t key = 0) {
+    DetectionResult r{ 0.5 + 1e-3 * static_cast<double>(i), 64, i * 64, i * 64 + 63, i * 64 + 7, 0.25f };
+    return Event<DetectionResult>::make(r, key, i);
+}
+
+} // namespace
+
+// Test 1: Sink_RecordsRoundTripThroughLog
+// BinaryResultSink in batch mode; every field a CSV row carries comes back
+// from the log, in order.
+TEST(ResultLogTest, Sink_RecordsRoundTripThroughLog) {
+    const std::string path = temp_path("klstream_results.klres");
+    SPSCQueue<Event<DetectionResult>> in(256);
+    std::vector<Event<DetectionResult>> sent;
+    for (std::uint64_t i = 0; i < 200; ++i) {
+        sent.push_back(result(i, symbol_key("AAPL")));
+        ASSERT_TRUE(in.try_push(sent.back()));
+    }
+    {
+        BinaryResultSink sink("sink", &in, path);
+        sink.set_batch_size(32);
+        OperatorMetrics m("sink");
+        sink.attach_metrics(&m);
+        LatencyHistogram latency;
+        sink.attach_latency(&latency);
+        while (sink.ready()) (void)sink.tick();
+        EXPECT_EQ(sink.tick(), OpStatus::Idle);
+        sink.shutdown();
+        EXPECT_EQ(m.events_processed.load(), 200u);
+        EXPECT_EQ(latency.count(), 200u);
+        EXPECT_EQ(sink.log().written(), 200u);
+        EXPECT_TRUE(sink.log().error().empty());
+    }
+
+    const auto got = read_result_log(path);
+    ASSERT_EQ(got.size(), sent.size());
+    for (std::size_t i = 0; i < got.size(); ++i) {
+        const auto& e = sent[i];
+        EXPECT_EQ(got[i].seq, e.seq);
+        EXPECT_EQ(got[i].detect_timestamp_ns, e.timestamp_ns);
+        EXPECT_EQ(got[i].max_score, e.data.max_score);
+        EXPECT_EQ(got[i].window_size_used, e.data.window_size_used);
+        EXPECT_EQ(got[i].first_seq, e.data.first_seq);
+        EXPECT_EQ(got[i].last_seq, e.data.last_seq);
+        EXPECT_EQ(got[i].flagged_seq, e.data.flagged_seq);
+        EXPECT_EQ(got[i].occupancy_at_decision, e.data.occupancy_at_decision);
+        EXPECT_EQ(got[i].symbol, symbol_key("AAPL"));
+    }
+
+    // Converted offline, a record is the row ResultSink writes.
+    std::ostringstream csv;
+    write_result_csv_row(csv, got[3]);
+    std::ostringstream expect;
+    expect << "3," << sent[3].timestamp_ns << ',' << got[3].latency_ns << ",0.503,64,192,255,199,0.25,AAPL\n";
+    EXPECT_EQ(csv.str(), expect.str());
+}
+
+// Test 2: Writer_SmallRingLosesNothing
+// One-record blocks and a two-block ring: append() refuses while both are
+// with the writer, a retry succeeds once one comes back, and every record
+// accepted reaches the file in order.
+TEST(ResultLogTest, Writer_SmallRingLosesNothing) {
+    const std::string path = temp_path("klstream_results_small.klres");
+    constexpr std::uint64_t N = 2000;
+    {
+        ResultLogWriter w(path, sizeof(ResultRecord), 2);
+        for (std::uint64_t i = 0; i < N; ++i) {
+            const ResultRecord r = make_result_record(result(i), i);
+            while (!w.append(r)) std::this_thread::yield();
+        }
+        EXPECT_EQ(w.appended(), N);
+        w.close();
+        EXPECT_EQ(w.written(), N);
+        EXPECT_EQ(w.blocks_written(), N);
+    }
+    const auto got = read_result_log(path);
+    ASSERT_EQ(got.size(), N);
+    for (std::uint64_t i = 0; i < N; ++i) ASSERT_EQ(got[i].seq, i);
+}
+
+// Test 3: Writer_StaleBlockReachesDiskBeforeClose
+TEST(ResultLogTest, Writer_StaleBlockReachesDiskBeforeClose) {
+    const std::string path = temp_path("klstream_results_stale.klres");
+    ResultLogWriter w(path, ResultLogWriter::DEFAULT_BLOCK_BYTES, 2, /*max_delay_ns=*/5'000'000);
+    ASSERT_TRUE(w.append(make_result_record(result(1), 10)));
+    w.flush_if_stale(Clock::coarse_ns());   // fresh: stays with the sink
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(w.written(), 0u);
+
+    w.flush_if_stale(Clock::coarse_ns() + 10'000'000);
+    for (int i = 0; i < 2000 && w.written() == 0; ++i) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    EXPECT_EQ(w.written(), 1u);
+    EXPECT_EQ(read_result_log(path).size(), 1u);
+    w.close();
+    w.close();   // idempotent
+}
+
+// Test 4: Read_RejectsForeignFiles
+TEST(ResultLogTest, Read_RejectsForeignFiles) {
+    const std::string path = temp_path("klstream_not_results.klres");
+    { std::ofstream(path) << "seq,detect_timestamp_ns\n1,2\n"; }
+    EXPECT_THROW(read_result_log(path), std::runtime_error);
+    EXPECT_THROW(read_result_log(temp_path("klstream_no_such_results.klres")), std::runtime_error);
+}
+
+// Test 5: Sink_ShutdownWritesHeldBatch
+// A batch held behind a full ring at stop time is appended by shutdown(),
+// not dropped.
+TEST(ResultLogTest, Sink_ShutdownWritesHeldBatch) {
+    const std::string path = temp_path("klstream_results_held.klres");
+    SPSCQueue<Event<DetectionResult>> in(64);
+    for (std::uint64_t i = 0; i < 32; ++i) ASSERT_TRUE(in.try_push(result(i)));
+    {
+        BinaryResultSink sink("sink", &in, path, sizeof(ResultRecord), 2);   // one-record blocks
+        sink.set_batch_size(32);
+        (void)sink.tick();   // pops all 32; the ring takes only the first few
+        sink.shutdown();
+        EXPECT_EQ(sink.log().written(), 32u);
+    }
+    const auto got = read_result_log(path);
+    ASSERT_EQ(got.size(), 32u);
+    for (std::uint64_t i = 0; i < got.size(); ++i) ASSERT_EQ(got[i].seq, i);
+}
@@ -0,0 +1,200 @@
+#include <gtest/gtest.h>
+#include "klstream/core/shm_queue.hpp"
+#include "klstream/operators/shm_bridge.hpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace klstream;
+
+namespace {
+
+std::string shm_name(const char* tag) {
+    return "/klstream_test_" + std::to_string(::getpid()) + "_" + tag;
+}
+
+// Runs fn in a child process; returns its exit status (0 = success).
+template <typename Fn>
+int in_child(Fn fn) {
+    const pid_t pid = ::fork();
+    if (pid == 0) ::_exit(fn());
+    int status = 0;
+    ::waitpid(pid, &status, 0);
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 255;
+}
+
+} // namespace
+
+// Test 1: Spsc_ProducerProcessToConsumerProcess
+// A forked producer attaches by name and pushes in batches; the parent
+// consumes everything, in order, across many wraps of the ring.
+TEST(ShmQueueTest, Spsc_ProducerProcessToConsumerProcess) {
+    const std::string name = shm_name("spsc");
+    auto q = ShmSPSCQueue<std::uint64_t>::create(name, 64, ShmRole::Consumer, 42);
+    constexpr std::uint64_t N = 20'000;
+
+    std::thread child([&] {
+        const int rc = in_child([&] {
+            auto p = ShmSPSCQueue<std::uint64_t>::attach(name, ShmRole::Producer, 42);
+            std::uint64_t vals[7], next = 0;
+            while (next < N) {
+                std::size_t n = 0;
+                for (; n < 7 && next + n < N; ++n) vals[n] = next + n;
+                std::size_t done = 0;
+                while (done < n) {
+                    const std::size_t k = p.try_push_n(vals + done, n - done);
+                    if (k == 0) std::this_thread::yield();
+                    done += k;
+                }
+                next += n;
+            }
+            return 0;
+        });
+        EXPECT_EQ(rc, 0);
+    });
+
+    std::uint64_t expected = 0, buf[16];
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(20);
+    while (expected < N && std::chrono::steady_clock::now() < deadline) {
+        const std::size_t n = q.try_pop_n(buf, 16);
+        if (n == 0) std::this_thread::yield();
+        for (std::size_t i = 0; i < n; ++i) ASSERT_EQ(buf[i], expected++);
+    }
+    child.join();
+    EXPECT_EQ(expected, N);
+    EXPECT_TRUE(q.empty());
+}
+
+// Test 2: Attach_RejectsMismatchedLayout
+// Element size, type tag and queue kind are all checked before attaching.
+TEST(ShmQueueTest, Attach_RejectsMismatchedLayout) {
+    const std::string name = shm_name("layout");
+    auto q = ShmSPSCQueue<std::uint64_t>::create(name, 16, ShmRole::Consumer, 7);
+    EXPECT_THROW(ShmSPSCQueue<std::uint32_t>::attach(name, ShmRole::Producer, 7), std::runtime_error);
+    EXPECT_THROW(ShmSPSCQueue<std::uint64_t>::attach(name, ShmRole::Producer, 8), std::runtime_error);
+    EXPECT_THROW(ShmMPMCQueue<std::uint64_t>::attach(name, 7), std::runtime_error);
+    EXPECT_THROW(ShmSPSCQueue<std::uint64_t>::attach("/klstream_test_missing", ShmRole::Producer, 0,
+                                                     std::chrono::milliseconds(20)), std::runtime_error);
+    EXPECT_NO_THROW(ShmSPSCQueue<std::uint64_t>::attach(name, ShmRole::Producer, 7));
+}
+
+// Test 3: Spsc_OneLiveProducerPerQueue
+// A second producer is refused while the first is attached; once it
+// detaches — or its process dies — the role can be taken again.
+TEST(ShmQueueTest, Spsc_OneLiveProducerPerQueue) {
+    const std::string name = shm_name("roles");
+    auto q = ShmSPSCQueue<std::uint64_t>::create(name, 16, ShmRole::Consumer);
+    {
+        auto p = ShmSPSCQueue<std::uint64_t>::attach(name, ShmRole::Producer);
+        EXPECT_THROW(ShmSPSCQueue<std::uint64_t>::attach(name, ShmRole::Producer), std::runtime_error);
+        EXPECT_THROW(ShmSPSCQueue<std::uint64_t>::attach(name, ShmRole::Consumer), std::runtime_error);
+    }
+    // A child that attaches and exits without detaching leaves a dead pid.
+    EXPECT_EQ(in_child([&] {
+        auto* leaked = new ShmSPSCQueue<std::uint64_t>(ShmSPSCQueue<std::uint64_t>::attach(name, ShmRole::Producer));
+        (void)leaked;
+        return 0;
+    }), 0);
+    EXPECT_NO_THROW(ShmSPSCQueue<std::uint64_t>::attach(name, ShmRole::Producer));
+}
+
+// Test 4: Mpmc_TwoProducerProcesses
+// Two forked producers share an anonymous (memfd) MPMC queue with the
+// parent; every value arrives exactly once.
+TEST(ShmQueueTest, Mpmc_TwoProducerProcesses) {
+    auto q = ShmMPMCQueue<std::uint64_t>::create("", 128);
+    constexpr std::uint64_t PER = 20'000;
+    std::vector<std::thread> children;
+    for (std::uint64_t c = 0; c < 2; ++c) {
+        children.emplace_back([&, c] {
+            EXPECT_EQ(in_child([&] {
+                // fork() shares the mapping; push through the inherited handle.
+                for (std::uint64_t i = 0; i < PER; ++i)
+                    while (!q.try_push(c * PER + i)) std::this_thread::yield();
+                return 0;
+            }), 0);
+        });
+    }
+    std::vector<int> seen(2 * PER, 0);
+    std::uint64_t got = 0, v;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(20);
+    while (got < 2 * PER && std::chrono::steady_clock::now() < deadline) {
+        if (q.try_pop(&v)) {
+            ASSERT_LT(v, 2 * PER);
+            ++seen[v];
+            ++got;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    for (auto& t : children) t.join();
+    EXPECT_EQ(got, 2 * PER);
+    for (int s : seen) ASSERT_EQ(s, 1);
+}
+
+// Test 5: Bridge_CarriesEventsThroughSharedMemory
+// SPSCQueue -> ShmPublishOperator -> shared memory -> ShmSubscribeOperator
+// -> SPSCQueue, with every Event field intact.
+TEST(ShmQueueTest, Bridge_CarriesEventsThroughSharedMemory) {
+    const std::string name = shm_name("bridge");
+    auto shm_in  = ShmSPSCQueue<Event<double>>::create(name, 32, ShmRole::Consumer);
+    auto shm_out = ShmSPSCQueue<Event<double>>::attach(name, ShmRole::Producer);
+    SPSCQueue<Event<double>> src(256), dst(256);
+    ShmPublishOperator<double>   pub("pub", &src, &shm_out);
+    ShmSubscribeOperator<double> sub("sub", &shm_in, &dst);
+    pub.set_batch_size(8);
+
+    for (std::uint64_t i = 0; i < 200; ++i) {
+        auto e = Event<double>::make_at(0.5 * static_cast<double>(i), 1000 + i, i % 3, i);
+        while (!src.try_push(e)) { pub.tick(); sub.tick(); }
+    }
+    std::vector<Event<double>> out;
+    for (int round = 0; round < 1000 && out.size() < 200; ++round) {
+        pub.tick();
+        sub.tick();
+        Event<double> e;
+        while (dst.try_pop(&e)) out.push_back(e);
+    }
+    ASSERT_EQ(out.size(), 200u);
+    for (std::uint64_t i = 0; i < 200; ++i) {
+        EXPECT_EQ(out[i].seq, i);
+        EXPECT_EQ(out[i].key, i % 3);
+        EXPECT_EQ(out[i].event_ts_ns, 1000 + i);
+        EXPECT_DOUBLE_EQ(out[i].data, 0.5 * static_cast<double>(i));
+    }
+}
+
+// Test 6: Attach_WaitsForALateCreator
+// An attacher that arrives before the segment exists, or before its
+// creator has sized it, waits out its timeout instead of failing at once.
+TEST(ShmQueueTest, Attach_WaitsForALateCreator) {
+    const std::string name = shm_name("late");
+    std::thread creator([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        auto q = ShmSPSCQueue<std::uint64_t>::create(name, 16, ShmRole::Producer, 3);
+        EXPECT_TRUE(q.try_push(99));
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));   // keep the name until attached
+    });
+    auto c = ShmSPSCQueue<std::uint64_t>::attach(name, ShmRole::Consumer, 3, std::chrono::seconds(5));
+    std::uint64_t v = 0;
+    for (int i = 0; i < 1000 && !c.try_pop(&v); ++i) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    EXPECT_EQ(v, 99u);
+    creator.join();
+
+    // Created but never sized (the window between shm_open and ftruncate).
+    const std::string unsized = shm_name("unsized");
+    const int fd = ::shm_open(unsized.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    ASSERT_GE(fd, 0);
+    const auto t0 = std::chrono::steady_clock::now();
+    EXPECT_THROW(ShmSPSCQueue<std::uint64_t>::attach(unsized, ShmRole::Consumer, 0, std::chrono::milliseconds(50)),
+                 std::runtime_error);
+    EXPECT_GE(std::chrono::steady_clock::now() - t0, std::chrono::milliseconds(50));
+    ::close(fd);
+    ShmSegment::remove(unsized);
+}
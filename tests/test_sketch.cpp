@@ -0,0 +1,205 @@
+#include <gtest/gtest.h>
+#include "klstream/core/sketch.hpp"
+#include "klstream/operators/sketch_window.hpp"
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+using namespace klstream;
+
+// Zipf-ish stream over `keys` keys: key k drawn with weight 1 / (k + 1).
+static std::vector<uint64_t> skewed_stream(std::size_t n, std::size_t keys, uint32_t seed) {
+    std::vector<double> w(keys);
+    for (std::size_t k = 0; k < keys; ++k) w[k] = 1.0 / static_cast<double>(k + 1);
+    std::discrete_distribution<uint64_t> pick(w.begin(), w.end());
+    std::mt19937 rng(seed);
+    std::vector<uint64_t> out(n);
+    for (auto& k : out) k = pick(rng) * 7919 + 13;   // sparse key values
+    return out;
+}
+
+// Test 1: CountMin_NeverUnderAndWithinBound
+TEST(SketchTest, CountMin_NeverUnderAndWithinBound) {
+    const auto stream = skewed_stream(100000, 5000, 1);
+    CountMinSketch cms(1024, 4);
+    cms.add_n(stream.data(), stream.size());
+    EXPECT_EQ(cms.total(), stream.size());
+    EXPECT_EQ(cms.memory_bytes(), 1024u * 4u * sizeof(uint64_t));
+
+    std::unordered_map<uint64_t, uint64_t> exact;
+    for (uint64_t k : stream) ++exact[k];
+    const double bound = std::exp(1.0) / 1024.0 * static_cast<double>(stream.size());
+    std::size_t over = 0;
+    for (const auto& [k, c] : exact) {
+        const uint64_t e = cms.estimate(k);
+        ASSERT_GE(e, c);
+        over += static_cast<double>(e - c) > bound;
+    }
+    EXPECT_LE(over, exact.size() / 20);   // far inside e^-4 ≈ 1.8%
+}
+
+// Test 2: CountMin_BatchMatchesSingleAndMergeMatchesUnion
+TEST(SketchTest, CountMin_BatchMatchesSingleAndMergeMatchesUnion) {
+    const auto stream = skewed_stream(20000, 2000, 2);
+    CountMinSketch one(256, 3), batched(256, 3), left(256, 3), right(256, 3);
+    for (uint64_t k : stream) one.add(k);
+    batched.add_n(stream.data(), stream.size());
+    left.add_n(stream.data(), stream.size() / 2);
+    right.add_n(stream.data() + stream.size() / 2, stream.size() - stream.size() / 2);
+    left.merge(right);
+    for (uint64_t k = 0; k < 2000; ++k) {
+        const uint64_t key = k * 7919 + 13;
+        ASSERT_EQ(batched.estimate(key), one.estimate(key));
+        ASSERT_EQ(left.estimate(key), one.estimate(key));
+    }
+    EXPECT_EQ(left.total(), one.total());
+    EXPECT_THROW(left.merge(CountMinSketch(512, 3)), std::invalid_argument);
+}
+
+// Test 3: HyperLogLog_EstimatesDistinctAndMergesExactly
+TEST(SketchTest, HyperLogLog_EstimatesDistinctAndMergesExactly) {
+    for (const uint64_t distinct : { 10ULL, 1000ULL, 200000ULL }) {
+        HyperLogLog h(12), a(12), b(12);
+        std::vector<uint64_t> keys;
+        for (uint64_t i = 0; i < distinct; ++i) keys.push_back(i * 3);
+        for (int rep = 0; rep < 2; ++rep) h.add_n(keys.data(), keys.size());   // duplicates don't count
+        for (uint64_t k : keys) (k % 2 ? a : b).add(k);
+        a.merge(b);
+        EXPECT_NEAR(h.estimate(), static_cast<double>(distinct), 0.05 * static_cast<double>(distinct) + 1.0);
+        EXPECT_DOUBLE_EQ(a.estimate(), h.estimate());
+    }
+    EXPECT_THROW(HyperLogLog(3), std::invalid_argument);
+    EXPECT_EQ(HyperLogLog(12).memory_bytes(), 4096u);
+}
+
+// Test 4: SpaceSaving_FindsHeavyHittersInFixedCapacity
+TEST(SketchTest, SpaceSaving_FindsHeavyHittersInFixedCapacity) {
+    const auto stream = skewed_stream(100000, 5000, 3);
+    std::unordered_map<uint64_t, uint64_t> exact;
+    for (uint64_t k : stream) ++exact[k];
+
+    SpaceSaving ss(64);
+    ss.add_n(stream.data(), stream.size());
+    EXPECT_EQ(ss.size(), 64u);
+    const auto top = ss.top(5);
+    ASSERT_EQ(top.size(), 5u);
+    for (std::size_t i = 0; i < top.size(); ++i) {
+        EXPECT_EQ(top[i].key, i * 7919 + 13);   // the five heaviest, in order
+        EXPECT_GE(top[i].count, exact[top[i].key]);
+        EXPECT_LE(top[i].count - top[i].error, exact[top[i].key]);
+    }
+
+    // Merging two halves keeps the heaviest and the bounds.
+    SpaceSaving left(64), right(64);
+    left.add_n(stream.data(), stream.size() / 2);
+    right.add_n(stream.data() + stream.size() / 2, stream.size() - stream.size() / 2);
+    left.merge(right);
+    EXPECT_EQ(left.size(), 64u);
+    EXPECT_EQ(left.total(), stream.size());
+    const auto merged = left.top(3);
+    for (std::size_t i = 0; i < merged.size(); ++i) {
+        EXPECT_EQ(merged[i].key, i * 7919 + 13);
+        EXPECT_GE(merged[i].count, exact[merged[i].key]);
+        EXPECT_LE(merged[i].count - merged[i].error, exact[merged[i].key]);
+    }
+}
+
+// Test 5: SketchCountWindow_FoldsKeysAcrossTicks
+TEST(SketchTest, SketchCountWindow_FoldsKeysAcrossTicks) {
+    SPSCQueue<Event<uint64_t>> q_in(64), q_out(16);
+    SketchCountWindow<uint64_t, SpaceSaving, uint64_t> win("top", &q_in, &q_out, 10, SpaceSaving(4),
+        [](const SpaceSaving& s) { return s.top(1).front().key; },
+        [](const Event<uint64_t>& e) { return e.data; });   // key from the data
+    win.set_batch_size(4);   // windows straddle ticks
+
+    // Window 1: 7 is heaviest; window 2: 3 is. Event::key is ignored.
+    const uint64_t keys[] = { 7, 1, 7, 2, 7, 7, 1, 7, 3, 7,
+                              3, 3, 9, 3, 1, 3, 3, 9, 3, 2, 5, 5 };
+    uint64_t seq = 0;
+    for (uint64_t k : keys) ASSERT_TRUE(q_in.try_push(Event<uint64_t>::make(k, 100, seq++)));
+    while (win.tick() == OpStatus::Processed) {}
+    EXPECT_EQ(win.open_count(), 2u);
+    EXPECT_EQ(win.sketch().total(), 2u);
+
+    auto a = q_out.pop();
+    auto b = q_out.pop();
+    ASSERT_TRUE(a.has_value() && b.has_value());
+    EXPECT_EQ(a->data, 7u);
+    EXPECT_EQ(a->seq, 9u);
+    EXPECT_EQ(b->data, 3u);
+    EXPECT_EQ(b->seq, 19u);
+    EXPECT_FALSE(q_out.pop().has_value());
+}
+
+// Test 6: SketchStates_RoundTripAndMergeLikeSketches
+TEST(SketchTest, SketchStates_RoundTripAndMergeLikeSketches) {
+    const auto stream = skewed_stream(20000, 2000, 4);
+    const std::size_t half = stream.size() / 2;
+
+    CountMinSketch cm_left(256, 2), cm_right(256, 2), cm_from_state(256, 2);
+    cm_left.add_n(stream.data(), half);
+    cm_right.add_n(stream.data() + half, stream.size() - half);
+    cm_from_state.merge(cm_left.state<256, 2>());
+    cm_from_state.merge(cm_right.state<256, 2>());
+    cm_left.merge(cm_right);
+    for (uint64_t k = 0; k < 2000; ++k) ASSERT_EQ(cm_from_state.estimate(k * 7919 + 13), cm_left.estimate(k * 7919 + 13));
+    EXPECT_EQ(cm_from_state.total(), stream.size());
+    EXPECT_THROW(((void)cm_left.state<512, 2>()), std::invalid_argument);
+
+    SpaceSaving ss_left(16), ss_right(16);
+    ss_left.add_n(stream.data(), half);
+    ss_right.add_n(stream.data() + half, stream.size() - half);
+    SpaceSaving ss_from_state(ss_left.state<16>());
+    ss_from_state.merge(ss_right.state<16>());
+    ss_left.merge(ss_right);
+    const auto want = ss_left.top(16), got = ss_from_state.top(16);
+    ASSERT_EQ(got.size(), want.size());
+    for (std::size_t i = 0; i < got.size(); ++i) {
+        EXPECT_EQ(got[i].key, want[i].key);
+        EXPECT_EQ(got[i].count, want[i].count);
+        EXPECT_EQ(got[i].error, want[i].error);
+    }
+    EXPECT_EQ(ss_from_state.total(), stream.size());
+    EXPECT_THROW(ss_left.merge(SpaceSaving(8).state<8>()), std::invalid_argument);
+}
+
+// Test 7: SketchCountWindow_ReplicaStatesMergeDownstream
+// Two keyed replicas each emit their windows' HyperLogLogState through a
+// queue; merging them downstream gives exactly the sketch of all keys.
+TEST(SketchTest, SketchCountWindow_ReplicaStatesMergeDownstream) {
+    using State = HyperLogLogState<8>;
+    using Win   = SketchCountWindow<uint64_t, HyperLogLog, State>;
+    static_assert(std::is_trivially_copyable_v<Event<State>>);
+
+    SPSCQueue<Event<uint64_t>> in_a(256), in_b(256);
+    SPSCQueue<Event<State>>    out_a(8), out_b(8);
+    const auto extract = [](const HyperLogLog& h) { return h.state<8>(); };
+    Win a("distinct_a", &in_a, &out_a, 50, HyperLogLog(8), extract);
+    Win b("distinct_b", &in_b, &out_b, 50, HyperLogLog(8), extract);
+    a.set_batch_size(16);
+    b.set_batch_size(16);
+
+    HyperLogLog all(8);
+    for (uint64_t i = 0; i < 200; ++i) {
+        const uint64_t key = i * 31 % 97;   // repeats across and within replicas
+        all.add(key);
+        ASSERT_TRUE((i % 2 ? in_a : in_b).try_push(Event<uint64_t>::make(i, key, i)));
+    }
+    while (a.tick() == OpStatus::Processed) {}
+    while (b.tick() == OpStatus::Processed) {}
+
+    HyperLogLog merged(8);
+    std::size_t windows = 0;
+    for (auto* q : { &out_a, &out_b }) {
+        while (auto ev = q->pop()) {
+            merged.merge(ev->data);
+            ++windows;
+        }
+    }
+    EXPECT_EQ(windows, 4u);   // 100 keys per replica, two windows each
+    EXPECT_DOUBLE_EQ(merged.estimate(), all.estimate());
+    EXPECT_THROW(merged.merge(HyperLogLog(9).state<9>()), std::invalid_argument);
+}
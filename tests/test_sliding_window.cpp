@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+#include "klstream/core/clock.hpp"
+#include "klstream/operators/sliding_window.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Built with KLSTREAM_VIRTUAL_CLOCK (tests/CMakeLists.txt): the test moves
+// processing time itself, so a gap of many panes takes no wall time.
+
+using namespace klstream;
+
+namespace {
+
+constexpr std::uint64_t MS   = 1'000'000;
+constexpr std::uint64_t BASE = 1'000 * MS;   // construction time, clear of 0
+
+WindowAggregate<uint64_t, uint64_t, uint64_t> sum_agg() {
+    return { 0,
+             [](uint64_t& a, const uint64_t& x) { a += x; },
+             [](uint64_t& a, const uint64_t& b) { a += b; },
+             [](const uint64_t& a) { return a; } };
+}
+
+struct Window {
+    std::uint64_t start_ns, seq, sum;
+};
+
+// Events (time, value) into a SlidingTimeWindow built at BASE, ticked
+// after each event and again at `end`.
+std::vector<Window> run(std::uint64_t size_ms, std::uint64_t slide_ms,
+                        const std::vector<std::pair<std::uint64_t, uint64_t>>& events,
+                        std::uint64_t end) {
+    SPSCQueue<Event<uint64_t>> q_in(64), q_out(4096);
+    Clock::set_virtual_ns(BASE);
+    SlidingTimeWindow<uint64_t, uint64_t, uint64_t> win(
+        "win", &q_in, &q_out, std::chrono::milliseconds(size_ms), std::chrono::milliseconds(slide_ms), sum_agg());
+    win.set_batch_size(4);
+    const auto drain = [&win] { while (win.tick() != OpStatus::Idle) {} };
+    for (const auto& [t, v] : events) {
+        Clock::set_virtual_ns(t);
+        drain();   // close the panes before t first
+        EXPECT_TRUE(q_in.try_push(Event<uint64_t>::make(v)));
+        drain();
+    }
+    Clock::set_virtual_ns(end);
+    drain();
+    std::vector<Window> out;
+    while (auto ev = q_out.pop()) out.push_back(Window{ ev->timestamp_ns, ev->seq, ev->data });
+    return out;
+}
+
+// Window k ends at BASE + (k + 1) * slide and covers the `size` before it;
+// the nonempty ones that ended by `end`.
+std::vector<Window> expect(std::uint64_t size_ms, std::uint64_t slide_ms,
+                           const std::vector<std::pair<std::uint64_t, uint64_t>>& events,
+                           std::uint64_t end) {
+    std::vector<Window> out;
+    for (std::uint64_t k = 0; BASE + (k + 1) * slide_ms * MS <= end; ++k) {
+        const std::uint64_t hi = BASE + (k + 1) * slide_ms * MS;
+        const std::uint64_t lo = hi - size_ms * MS;
+        std::uint64_t sum = 0;
+        bool any = false;
+        for (const auto& [t, v] : events) {
+            if (t >= lo && t < hi) { sum += v; any = true; }
+        }
+        if (any) out.push_back(Window{ lo, k, sum });
+    }
+    return out;
+}
+
+} // namespace
+
+// Test 1: SlidingTimeWindow_LongGapEmitsOnlyNonemptyWindows
+// An idle gap of ~1000 panes between two events: only the windows that
+// hold one are emitted, with the seqs and start times a pane-by-pane run
+// would give them.
+TEST(SlidingWindowTest, SlidingTimeWindow_LongGapEmitsOnlyNonemptyWindows) {
+    struct Shape { std::uint64_t size_ms, slide_ms; };
+    for (const Shape s : { Shape{ 30, 10 }, Shape{ 30, 20 }, Shape{ 20, 30 } }) {
+        const std::vector<std::pair<std::uint64_t, uint64_t>> events = {
+            { BASE + 5 * MS,      1 },
+            { BASE + 10'003 * MS, 10 },   // ~10 s later, mid-pane
+            { BASE + 10'021 * MS, 100 },
+        };
+        const std::uint64_t end = BASE + 10'500 * MS;
+        SCOPED_TRACE(::testing::Message() << "size " << s.size_ms << " slide " << s.slide_ms);
+        const auto got  = run(s.size_ms, s.slide_ms, events, end);
+        const auto want = expect(s.size_ms, s.slide_ms, events, end);
+        ASSERT_FALSE(want.empty());
+        EXPECT_EQ(got.size(), want.size());
+        for (std::size_t i = 0; i < std::min(got.size(), want.size()); ++i) {
+            EXPECT_EQ(got[i].start_ns, want[i].start_ns) << "window " << i;
+            EXPECT_EQ(got[i].seq, want[i].seq) << "window " << i;
+            EXPECT_EQ(got[i].sum, want[i].sum) << "window " << i;
+        }
+    }
+}
@@ -1,5 +1,8 @@
 #include <gtest/gtest.h>
 #include "klstream/core/spsc_queue.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <thread>
 #include <vector>
 
@@ -64,7 +67,125 @@ TEST(SPSCQueueTest, OccupancyApproximate) {
     EXPECT_LE(occ, 0.55);
 }
 
-// Test 5: PowerOfTwoEnforced
+// Test 5: BatchPushPop_WrapsAround
+TEST(SPSCQueueTest, BatchPushPop_WrapsAround) {
+    SPSCQueue<int> q(8); // holds 7
+    int in[10];
+    for (int i = 0; i < 10; ++i) in[i] = i;
+
+    // Offset the indices so the next batch straddles the end of the ring.
+    EXPECT_EQ(q.try_push_n(in, 5), 5u);
+    int out[10];
+    EXPECT_EQ(q.try_pop_n(out, 5), 5u);
+
+    EXPECT_EQ(q.try_push_n(in, 10), 7u); // partial: only 7 slots free
+    EXPECT_EQ(q.try_push_n(in, 1), 0u);  // full
+    EXPECT_EQ(q.try_pop_n(out, 10), 7u);
+    for (int i = 0; i < 7; ++i) EXPECT_EQ(out[i], i);
+    EXPECT_EQ(q.try_pop_n(out, 10), 0u); // empty
+}
+
+// Test 6: ConcurrentBatchProducerConsumer
+TEST(SPSCQueueTest, ConcurrentBatchProducerConsumer) {
+    SPSCQueue<int> q(1024);
+    const int num_items = 1'000'000;
+    const std::size_t batch = 37; // deliberately not a divisor of capacity
+
+    std::thread producer([&]() {
+        int buf[batch];
+        int next = 0;
+        while (next < num_items) {
+            std::size_t want = std::min<std::size_t>(batch, num_items - next);
+            for (std::size_t i = 0; i < want; ++i) buf[i] = next + static_cast<int>(i);
+            std::size_t done = 0;
+            while (done < want) done += q.try_push_n(buf + done, want - done);
+            next += static_cast<int>(want);
+        }
+    });
+
+    int expected = 0;
+    bool in_order = true;
+    int buf[batch];
+    while (expected < num_items) {
+        std::size_t n = q.try_pop_n(buf, batch);
+        for (std::size_t i = 0; i < n; ++i) {
+            if (buf[i] != expected++) in_order = false;
+        }
+    }
+    producer.join();
+    EXPECT_TRUE(in_order);
+}
+
+// Test 7: PowerOfTwoEnforced
 TEST(SPSCQueueTest, PowerOfTwoEnforced) {
     // Assert is compiled out in Release builds (-DNDEBUG)
 }
+
+// Test 8: Waker_ParkedConsumerWokenByPush
+TEST(SPSCQueueTest, Waker_ParkedConsumerWokenByPush) {
+    using namespace std::chrono;
+    SPSCQueue<int> q(64);
+    Parker parker;
+    q.set_waker(&parker);
+
+    ASSERT_TRUE(q.try_push(1));            // nobody asleep: no wake issued
+    EXPECT_EQ(parker.wakes(), 0u);
+    int v = 0;
+    ASSERT_TRUE(q.try_pop(&v));
+
+    std::atomic<bool> asleep{false};
+    milliseconds waited{};
+    std::thread consumer([&] {
+        const auto t0 = steady_clock::now();
+        while (q.empty()) {
+            const auto key = parker.prepare();
+            if (!q.empty()) { parker.cancel(); break; }
+            asleep = true;
+            parker.wait(key, seconds(10));
+        }
+        waited = duration_cast<milliseconds>(steady_clock::now() - t0);
+    });
+    while (!asleep) std::this_thread::yield();
+    std::this_thread::sleep_for(milliseconds(20));
+    ASSERT_TRUE(q.try_push(2));
+    consumer.join();
+
+    EXPECT_EQ(parker.wakes(), 1u);
+    EXPECT_LT(waited.count(), 5000);       // woken, not timed out
+    ASSERT_TRUE(q.try_pop(&v));
+    EXPECT_EQ(v, 2);
+}
+
+// Test 9: ClaimPublish_InPlaceAcrossWrap
+// Slots written in place through claim() arrive like pushed ones; a claim
+// stops at the wrap point and never hands out unpublished-but-unread room.
+TEST(SPSCQueueTest, ClaimPublish_InPlaceAcrossWrap) {
+    SPSCQueue<int> q(8);
+    int v = 0;
+    for (int i = 0; i < 5; ++i) ASSERT_TRUE(q.try_push(i));
+    for (int i = 0; i < 5; ++i) ASSERT_TRUE(q.try_pop(&v));   // indices now at 5
+
+    std::size_t n = 0;
+    int* slots = q.claim(8, &n);
+    EXPECT_EQ(n, 3u);                         // 5, 6, 7 — up to the wrap
+    for (std::size_t i = 0; i < n; ++i) slots[i] = 100 + static_cast<int>(i);
+    EXPECT_TRUE(q.empty());                   // nothing visible until publish
+    q.publish(2);                             // the third slot is given back
+
+    slots = q.claim(8, &n);
+    EXPECT_EQ(n, 1u);
+    slots[0] = 102;
+    q.publish(1);
+    slots = q.claim(8, &n);
+    EXPECT_EQ(n, 4u);                         // 0..3: one slot stays empty
+    for (std::size_t i = 0; i < n; ++i) slots[i] = 103 + static_cast<int>(i);
+    q.publish(n);
+    (void)q.claim(1, &n);
+    EXPECT_EQ(n, 0u);                         // full
+
+    for (int i = 0; i < 7; ++i) {
+        ASSERT_TRUE(q.try_pop(&v));
+        EXPECT_EQ(v, 100 + i);
+    }
+    EXPECT_TRUE(q.empty());
+}
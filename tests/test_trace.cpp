@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+#include "klstream/core/trace.hpp"
+#include "klstream/core/spsc_queue.hpp"
+#include "klstream/core/event.hpp"
+#include "klstream/operators/graph.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace klstream;
+using namespace std::chrono;
+
+// Test 1: QueueTrace_SamplesEveryNthPositionAcrossBatches
+TEST(TraceTest, QueueTrace_SamplesEveryNthPositionAcrossBatches) {
+    SPSCQueue<Event<uint64_t>> q(64);
+    TraceRecorder tr(/*sample_every=*/4);
+    QueueTrace& qt = tr.trace_queue("q", q);
+
+    std::vector<Event<uint64_t>> batch(10);
+    for (uint64_t i = 0; i < 10; ++i) {
+        batch[i]     = Event<uint64_t>::make(i);
+        batch[i].seq = 100 + i;
+    }
+    ASSERT_TRUE(q.try_push(batch[0]));                      // position 0: sampled
+    ASSERT_EQ(q.try_push_n(batch.data() + 1, 9), 9u);       // 4 and 8 sampled
+    std::this_thread::sleep_for(milliseconds(2));
+
+    Event<uint64_t> one;
+    ASSERT_TRUE(q.try_pop(&one));
+    std::vector<Event<uint64_t>> out(9);
+    ASSERT_EQ(q.try_pop_n(out.data(), 9), 9u);
+
+    EXPECT_EQ(qt.dwell().count(), 3u);
+    EXPECT_GE(qt.dwell().value_at(0.0), 2'000'000u);        // waited at least the sleep
+    std::vector<uint64_t> seqs;
+    qt.spans().for_each([&](const TraceSpan& s) { seqs.push_back(s.seq); });
+    EXPECT_EQ(seqs, (std::vector<uint64_t>{ 100, 104, 108 }));
+
+    // Wrap-around: many more samples than stamp slots, one at a time.
+    for (int i = 0; i < 1000; ++i) {
+        ASSERT_TRUE(q.try_push(batch[0]));
+        ASSERT_TRUE(q.try_pop(&one));
+    }
+    EXPECT_EQ(qt.dwell().count(), 3u + 250u);
+    EXPECT_LT(qt.dwell().value_at(0.5), 1'000'000u);        // no stale stamps
+}
+
+// Test 2: OpTrace_KeepsSampleUntilTickMakesProgress
+TEST(TraceTest, OpTrace_KeepsSampleUntilTickMakesProgress) {
+    OpTrace ot("op", /*sample_every=*/3, /*max_spans=*/2);
+    EXPECT_FALSE(ot.sample());
+    EXPECT_FALSE(ot.sample());
+    EXPECT_TRUE(ot.sample());
+    ot.record(10, 20, /*progress=*/false);                  // idle: still due
+    EXPECT_TRUE(ot.sample());
+    ot.record(30, 45, /*progress=*/true);
+    EXPECT_FALSE(ot.sample());
+    EXPECT_EQ(ot.service().count(), 1u);
+    EXPECT_EQ(ot.service().value_at(1.0), 15u);
+
+    ot.record(50, 51, true);
+    ot.record(60, 62, true);                                // ring of 2: first span dropped
+    std::vector<uint64_t> starts;
+    ot.spans().for_each([&](const TraceSpan& s) { starts.push_back(s.start_ns); });
+    EXPECT_EQ(ot.spans().written(), 3u);
+    EXPECT_EQ(starts, (std::vector<uint64_t>{ 50, 60 }));
+}
+
+// Test 3: Graph_TracesEdgesAndNodesToChromeJson
+TEST(TraceTest, Graph_TracesEdgesAndNodesToChromeJson) {
+    constexpr uint64_t N = 20000;
+    StreamGraphBuilder g;
+    uint64_t next = 1;
+    std::atomic<uint64_t> received{0};
+    g.source<uint64_t>("src", [&next](Event<uint64_t>& out, uint64_t) {
+         if (next > N) return false;
+         out = Event<uint64_t>::make(next++);
+         return true;
+     })
+     .map<uint64_t>("map", [](uint64_t x) { return x + 1; })
+     .sink("snk", [&](const Event<uint64_t>&) { received++; });
+
+    PlanOptions o;
+    o.workers = 2;
+    Runtime rt;
+    auto graph = g.build(rt, g.plan(o), /*report=*/false);
+    TraceRecorder tr(/*sample_every=*/64);
+    graph->trace(tr);
+    tr.report_to(rt.metrics());
+    ASSERT_EQ(tr.queues().size(), 2u);
+    ASSERT_EQ(tr.operators().size(), 3u);
+    EXPECT_EQ(tr.queues()[0].name(), "src->map");
+
+    rt.start();
+    const auto deadline = steady_clock::now() + seconds(20);
+    while (received.load() < N && steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(milliseconds(5));
+    }
+    rt.stop();
+    ASSERT_EQ(received.load(), N);
+
+    for (const auto& q : tr.queues()) EXPECT_EQ(q.dwell().count(), (N + 63) / 64) << q.name();
+    for (const auto& op : tr.operators()) EXPECT_GT(op.service().count(), 0u) << op.name();
+    const auto snap = rt.metrics().snapshot();
+    EXPECT_EQ(snap.histograms.size(), 5u);
+
+    std::ostringstream json;
+    tr.write_chrome_trace(json);
+    const std::string s = json.str();
+    EXPECT_EQ(s.rfind("{\"displayTimeUnit\"", 0), 0u);
+    EXPECT_NE(s.find("\"args\":{\"name\":\"dwell src->map\"}"), std::string::npos);
+    EXPECT_NE(s.find("\"ph\":\"X\""), std::string::npos);
+    EXPECT_NE(s.find("\"cat\":\"service\""), std::string::npos);
+}
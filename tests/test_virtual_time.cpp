@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+#include "klstream/core/virtual_time.hpp"
+#include "klstream/core/histogram.hpp"
+#include "klstream/operators/source.hpp"
+#include "klstream/operators/map.hpp"
+#include "klstream/operators/sink.hpp"
+#include <thread>
+#include <vector>
+
+// Built with KLSTREAM_VIRTUAL_CLOCK (tests/CMakeLists.txt).
+
+using namespace klstream;
+
+namespace {
+
+struct ChainResult {
+    std::uint64_t end_ns   = 0;
+    std::uint64_t received = 0;
+    bool          in_order = true;
+    std::uint64_t latency_sum = 0;
+    std::uint64_t latency_max = 0;
+    std::uint64_t ticks    = 0;
+};
+
+// source (100 ns/event) -> map (300 ns/event) -> sink (50 ns/event).
+ChainResult run_chain(std::uint64_t n) {
+    SPSCQueue<Event<uint64_t>> q_src_map(64);
+    SPSCQueue<Event<uint64_t>> q_map_snk(64);
+    uint64_t next = 1;
+    SourceOperator<uint64_t> source("src", &q_src_map, [&](Event<uint64_t>& out, uint64_t) {
+        if (next > n) return false;
+        out = Event<uint64_t>::make(next++);
+        return true;
+    });
+    MapOperator<uint64_t, uint64_t> map_op("map", &q_src_map, &q_map_snk, [](uint64_t x) { return x + 1; });
+    ChainResult r;
+    uint64_t last = 1;
+    SinkOperator<uint64_t> sink("snk", &q_map_snk, [&](const Event<uint64_t>& ev) {
+        if (ev.data != last + 1) r.in_order = false;
+        last = ev.data;
+        const std::uint64_t l = ev.latency_ns();
+        r.latency_sum += l;
+        r.latency_max = std::max(r.latency_max, l);
+        ++r.received;
+    });
+    OperatorMetrics m_src("src"), m_map("map"), m_snk("snk");
+    source.attach_metrics(&m_src);
+    map_op.attach_metrics(&m_map);
+    sink.attach_metrics(&m_snk);
+
+    VirtualTimeRunner vt;
+    const auto s = vt.add(&source, [&] { return 100 * m_src.events_processed.load(); });
+    const auto m = vt.add(&map_op, [&] { return 300 * m_map.events_processed.load(); });
+    const auto k = vt.add(&sink, [&] { return 50 * m_snk.events_processed.load(); });
+    vt.feeds(s, m);
+    vt.feeds(m, k);
+    r.end_ns = vt.run();
+    r.ticks  = vt.ticks();
+    return r;
+}
+
+bool same(const ChainResult& a, const ChainResult& b) {
+    return a.end_ns == b.end_ns && a.received == b.received && a.latency_sum == b.latency_sum &&
+           a.latency_max == b.latency_max && a.ticks == b.ticks;
+}
+
+} // namespace
+
+// Test 1: Chain_RunsAtTheBottleneckStagesPrice
+TEST(VirtualTimeTest, Chain_RunsAtTheBottleneckStagesPrice) {
+    constexpr uint64_t N = 10000;
+    const ChainResult r = run_chain(N);
+    EXPECT_EQ(r.received, N);
+    EXPECT_TRUE(r.in_order);
+    // The map is the bottleneck: one event per 300 ns, after the first
+    // event's 100 ns at the source, plus the last one's 50 ns at the sink.
+    EXPECT_EQ(r.end_ns, 100 + N * 300 + 50);
+    // The source runs ahead until both queues are full; the events queued
+    // behind the map then wait about a queue's worth of its service time.
+    EXPECT_GT(r.latency_max, 60u * 300u);
+    EXPECT_LT(r.latency_max, 140u * 300u);
+    EXPECT_EQ(Clock::now_ns(), r.end_ns);
+}
+
+// Test 2: Repeated_RunsAreIdentical
+TEST(VirtualTimeTest, Repeated_RunsAreIdentical) {
+    const ChainResult a = run_chain(5000);
+    const ChainResult b = run_chain(5000);
+    EXPECT_TRUE(same(a, b));
+}
+
+// Test 3: ParallelRuns_DoNotShareTheClock
+TEST(VirtualTimeTest, ParallelRuns_DoNotShareTheClock) {
+    const ChainResult serial = run_chain(5000);
+    std::vector<ChainResult> par(3);
+    std::vector<std::thread> threads;
+    for (auto& r : par) threads.emplace_back([&r] { r = run_chain(5000); });
+    for (auto& t : threads) t.join();
+    for (const auto& r : par) EXPECT_TRUE(same(r, serial));
+}